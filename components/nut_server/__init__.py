@@ -2,12 +2,14 @@
 
 import esphome.codegen as cg
 import esphome.config_validation as cv
+from esphome.components.esp32 import add_idf_sdkconfig_option
 from esphome.const import (
     CONF_ID,
     CONF_PORT,
     CONF_USERNAME,
     CONF_PASSWORD,
 )
+from esphome.core import CORE
 
 DEPENDENCIES = ["esp32", "network", "ups_hid"]
 AUTO_LOAD = []
@@ -15,7 +17,24 @@ MULTI_CONF = False
 
 CONF_UPS_HID_ID = "ups_hid_id"
 CONF_MAX_CLIENTS = "max_clients"
+CONF_INSTRUMENTATION = "instrumentation"
 CONF_UPS_NAME = "ups_name"
+CONF_UPS = "ups"
+CONF_NAME = "name"
+CONF_TLS = "tls"
+CONF_CERTIFICATE = "certificate"
+CONF_PRIVATE_KEY = "private_key"
+CONF_SESSION_CACHE_SIZE = "session_cache_size"
+CONF_SESSION_TIMEOUT = "session_timeout"
+CONF_MAX_SESSIONS = "max_sessions"
+CONF_MIN_FREE_HEAP = "min_free_heap"
+CONF_TASK = "task"
+CONF_CORE = "core"
+CONF_PRIORITY = "priority"
+CONF_STACK_SIZE = "stack_size"
+
+MAX_UPS = 4
+MAX_CREDENTIAL_LENGTH = 63
 
 nut_server_ns = cg.esphome_ns.namespace("nut_server")
 NutServerComponent = nut_server_ns.class_("NutServerComponent", cg.Component)
@@ -24,15 +43,65 @@ NutServerComponent = nut_server_ns.class_("NutServerComponent", cg.Component)
 ups_hid_ns = cg.esphome_ns.namespace("ups_hid")
 UpsHidComponent = ups_hid_ns.class_("UpsHidComponent", cg.PollingComponent)
 
+
+def _pem(marker):
+    """PEM block whose header contains marker, e.g. CERTIFICATE or PRIVATE KEY."""
+    def validator(value):
+        value = cv.string_strict(value)
+        if "-----BEGIN " not in value or marker not in value:
+            raise cv.Invalid(f"Expected a PEM encoded {marker.lower()} (-----BEGIN ...{marker}-----)")
+        return value if value.endswith("\n") else value + "\n"
+    return validator
+
+
+# STARTTLS; each open session costs a few KB of mbedTLS buffers on the shared heap
+TLS_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_CERTIFICATE): _pem("CERTIFICATE"),
+        cv.Required(CONF_PRIVATE_KEY): _pem("PRIVATE KEY"),
+        # Session-ID cache entries for TLS 1.2 resumption; tickets are used as well
+        cv.Optional(CONF_SESSION_CACHE_SIZE, default=4): cv.int_range(min=0, max=16),
+        cv.Optional(CONF_SESSION_TIMEOUT, default="1h"): cv.All(
+            cv.positive_time_period_seconds, cv.Range(min=cv.TimePeriod(minutes=1))
+        ),
+        cv.Optional(CONF_MAX_SESSIONS, default=2): cv.int_range(min=1, max=10),
+        cv.Optional(CONF_MIN_FREE_HEAP, default=32768): cv.int_range(min=0),
+    }
+)
+
 CONFIG_SCHEMA = cv.Schema(
     {
         cv.GenerateID(): cv.declare_id(NutServerComponent),
-        cv.Required(CONF_UPS_HID_ID): cv.use_id(UpsHidComponent),
+        cv.Optional(CONF_UPS_HID_ID): cv.use_id(UpsHidComponent),
         cv.Optional(CONF_PORT, default=3493): cv.port,
-        cv.Optional(CONF_USERNAME, default="nutuser"): cv.string,
-        cv.Optional(CONF_PASSWORD, default=""): cv.string,
+        # Stored inline per client, up to MAX_CREDENTIAL_LENGTH
+        cv.Optional(CONF_USERNAME, default="nutuser"): cv.All(cv.string, cv.Length(max=MAX_CREDENTIAL_LENGTH)),
+        cv.Optional(CONF_PASSWORD, default=""): cv.All(cv.string, cv.Length(max=MAX_CREDENTIAL_LENGTH)),
         cv.Optional(CONF_MAX_CLIENTS, default=4): cv.int_range(min=1, max=10),
+        # Request counts and latency per NUT verb, served as server.requests.* / server.latency.*
+        cv.Optional(CONF_INSTRUMENTATION, default=False): cv.boolean,
         cv.Optional(CONF_UPS_NAME): cv.string,
+        # Several UPS devices behind one server, each under its own NUT name
+        cv.Optional(CONF_UPS): cv.All(
+            cv.ensure_list(
+                cv.Schema(
+                    {
+                        cv.Required(CONF_UPS_HID_ID): cv.use_id(UpsHidComponent),
+                        cv.Optional(CONF_NAME): cv.string,
+                    }
+                )
+            ),
+            cv.Length(min=1, max=MAX_UPS),
+        ),
+        cv.Optional(CONF_TLS): TLS_SCHEMA,
+        # Placement of the server task; stack_size defaults to 4096, or 10240 with tls
+        cv.Optional(CONF_TASK, default={}): cv.Schema(
+            {
+                cv.Optional(CONF_CORE): cv.int_range(min=0, max=1),
+                cv.Optional(CONF_PRIORITY, default=1): cv.int_range(min=1, max=22),
+                cv.Optional(CONF_STACK_SIZE): cv.int_range(min=2048, max=32768),
+            }
+        ),
     }
 ).extend(cv.COMPONENT_SCHEMA)
 
@@ -43,9 +112,35 @@ def validate_config(config):
     if config[CONF_PASSWORD] and not config[CONF_USERNAME]:
         raise cv.Invalid("Username is required when password is set")
     
+    # Exactly one of the single-UPS shorthand and the ups: list
+    if CONF_UPS in config:
+        if CONF_UPS_HID_ID in config or CONF_UPS_NAME in config:
+            raise cv.Invalid(
+                f"Use either '{CONF_UPS}' or '{CONF_UPS_HID_ID}'/'{CONF_UPS_NAME}', not both"
+            )
+        names = [_ups_name(entry[CONF_UPS_HID_ID], entry.get(CONF_NAME)) for entry in config[CONF_UPS]]
+        duplicates = sorted({name for name in names if names.count(name) > 1})
+        if duplicates:
+            raise cv.Invalid(f"Duplicate NUT UPS names: {', '.join(duplicates)}")
+    elif CONF_UPS_HID_ID not in config:
+        raise cv.Invalid(f"Either '{CONF_UPS_HID_ID}' or '{CONF_UPS}' is required")
+    
+    if CONF_TLS in config and config[CONF_TLS][CONF_MAX_SESSIONS] > config[CONF_MAX_CLIENTS]:
+        raise cv.Invalid(f"'{CONF_MAX_SESSIONS}' cannot exceed '{CONF_MAX_CLIENTS}'", path=[CONF_TLS, CONF_MAX_SESSIONS])
+    stack_size = config[CONF_TASK].get(CONF_STACK_SIZE)
+    if CONF_TLS in config and stack_size is not None and stack_size < 8192:
+        raise cv.Invalid(
+            f"'{CONF_STACK_SIZE}' must be at least 8192 with '{CONF_TLS}'", path=[CONF_TASK, CONF_STACK_SIZE]
+        )
+    
     return config
 
 
+def _ups_name(ups_hid_id, name):
+    """NUT name for a UPS - custom name if provided, otherwise the component ID."""
+    return name if name is not None else str(ups_hid_id)
+
+
 CONFIG_SCHEMA = CONFIG_SCHEMA.add_extra(validate_config)
 
 
@@ -54,9 +149,14 @@ async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
     await cg.register_component(var, config)
     
-    # Get reference to UPS HID component
-    ups_hid = await cg.get_variable(config[CONF_UPS_HID_ID])
-    cg.add(var.set_ups_hid(ups_hid))
+    # Register each UPS HID component under its NUT name
+    if CONF_UPS in config:
+        entries = [(entry[CONF_UPS_HID_ID], entry.get(CONF_NAME)) for entry in config[CONF_UPS]]
+    else:
+        entries = [(config[CONF_UPS_HID_ID], config.get(CONF_UPS_NAME))]
+    for ups_hid_id, name in entries:
+        ups_hid = await cg.get_variable(ups_hid_id)
+        cg.add(var.add_ups(ups_hid, _ups_name(ups_hid_id, name)))
     
     # Set port
     cg.add(var.set_port(config[CONF_PORT]))
@@ -66,12 +166,23 @@ async def to_code(config):
     if CONF_PASSWORD in config:
         cg.add(var.set_password(config[CONF_PASSWORD]))
     
-    # Set max clients
+    # Set max clients; the client table is sized at compile time
+    cg.add_define("NUT_SERVER_MAX_CLIENTS", config[CONF_MAX_CLIENTS])
     cg.add(var.set_max_clients(config[CONF_MAX_CLIENTS]))
+    cg.add(var.set_instrumentation(config[CONF_INSTRUMENTATION]))
+    task = config[CONF_TASK]
+    stack_size = task.get(CONF_STACK_SIZE, 10240 if CONF_TLS in config else 4096)
+    cg.add(var.set_task_config(task.get(CONF_CORE, -1), task[CONF_PRIORITY], stack_size))
     
-    # Set UPS name - use custom name if provided, otherwise use component ID
-    if CONF_UPS_NAME in config:
-        ups_name = config[CONF_UPS_NAME]
-    else:
-        ups_name = str(config[CONF_UPS_HID_ID])
-    cg.add(var.set_ups_name(ups_name))
\ No newline at end of file
+    if CONF_TLS in config:
+        tls = config[CONF_TLS]
+        cg.add_define("USE_NUT_SERVER_TLS")
+        cg.add(var.set_tls_certificate(tls[CONF_CERTIFICATE]))
+        cg.add(var.set_tls_private_key(tls[CONF_PRIVATE_KEY]))
+        cg.add(var.set_tls_session_cache(tls[CONF_SESSION_CACHE_SIZE], tls[CONF_SESSION_TIMEOUT].total_seconds))
+        cg.add(var.set_tls_max_sessions(tls[CONF_MAX_SESSIONS]))
+        cg.add(var.set_tls_min_free_heap(tls[CONF_MIN_FREE_HEAP]))
+        if CORE.using_esp_idf:
+            # Idle sessions give their record buffers back to the heap between commands
+            add_idf_sdkconfig_option("CONFIG_MBEDTLS_DYNAMIC_BUFFER", True)
+            add_idf_sdkconfig_option("CONFIG_MBEDTLS_SERVER_SSL_SESSION_TICKETS", True)
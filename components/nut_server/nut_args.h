@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace esphome {
+namespace nut_server {
+
+// Most words one request may carry: SUBSCRIBE <ups> followed by every variable
+static constexpr size_t NUT_MAX_ARGS = 24;
+
+/**
+ * Words of one NUT request line, as views into the client's receive buffer
+ *
+ * Words are separated by spaces or tabs; a word in double quotes may contain
+ * spaces and ends at the next quote. Nothing is copied, so the views are only
+ * valid while the line is, i.e. for the duration of the handler. A line with
+ * more than NUT_MAX_ARGS words sets overflow and keeps the first ones.
+ */
+struct NutArgs {
+  std::string_view words[NUT_MAX_ARGS];
+  size_t count{0};
+  bool overflow{false};
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  const std::string_view &operator[](size_t index) const { return words[index]; }
+};
+
+inline bool is_nut_space(char c) { return c == ' ' || c == '\t'; }
+
+inline NutArgs split_nut_args(std::string_view line) {
+  NutArgs args;
+  size_t i = 0;
+  while (i < line.size()) {
+    if (is_nut_space(line[i])) {
+      i++;
+      continue;
+    }
+    size_t start = i;
+    size_t end;
+    if (line[i] == '"') {
+      start = ++i;
+      while (i < line.size() && line[i] != '"') {
+        i++;
+      }
+      end = i;
+      if (i < line.size()) {
+        i++;  // Closing quote
+      }
+    } else {
+      while (i < line.size() && !is_nut_space(line[i])) {
+        i++;
+      }
+      end = i;
+    }
+    if (args.count == NUT_MAX_ARGS) {
+      args.overflow = true;
+      break;
+    }
+    args.words[args.count++] = line.substr(start, end - start);
+  }
+  return args;
+}
+
+// Splits off the first word: line is "<head> <rest>", rest keeps its inner spaces
+inline std::string_view split_nut_head(std::string_view line, std::string_view &rest) {
+  const size_t space = line.find(' ');
+  if (space == std::string_view::npos) {
+    rest = std::string_view();
+    return line;
+  }
+  rest = line.substr(space + 1);
+  return line.substr(0, space);
+}
+
+inline char nut_to_upper(char c) { return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c; }
+
+// ASCII case-insensitive comparison, for command keywords
+inline bool nut_iequals(std::string_view a, std::string_view b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (nut_to_upper(a[i]) != nut_to_upper(b[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Hex report ID as in driver.stats.report.input.0x0C; false unless the whole
+// word is an optional 0x prefix and one or two hex digits
+inline bool parse_nut_hex_byte(std::string_view word, uint8_t &value) {
+  if (word.size() > 2 && word[0] == '0' && (word[1] == 'x' || word[1] == 'X')) {
+    word.remove_prefix(2);
+  }
+  if (word.empty() || word.size() > 2) {
+    return false;
+  }
+  unsigned result = 0;
+  for (char c : word) {
+    unsigned digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      digit = c - 'A' + 10;
+    } else {
+      return false;
+    }
+    result = result * 16 + digit;
+  }
+  value = static_cast<uint8_t>(result);
+  return true;
+}
+
+}  // namespace nut_server
+}  // namespace esphome
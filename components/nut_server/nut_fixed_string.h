@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace esphome {
+namespace nut_server {
+
+/**
+ * String of at most N characters stored inline
+ *
+ * Used for per-client fields so that connecting and disconnecting a client
+ * never allocates. Values that do not fit are rejected rather than cut off,
+ * since a truncated username or password would compare as a different one.
+ */
+template<size_t N> class NutFixedString {
+  static_assert(N < 256, "length is stored in one byte");
+
+ public:
+  static constexpr size_t MAX_LENGTH = N;
+
+  // False, leaving the string empty, if value is longer than N
+  bool assign(const char *data, size_t length) {
+    if (length > N) {
+      clear();
+      return false;
+    }
+    memcpy(data_, data, length);
+    data_[length] = '\0';
+    length_ = static_cast<uint8_t>(length);
+    return true;
+  }
+  bool assign(const char *str) { return assign(str, strlen(str)); }
+  bool assign(std::string_view str) { return assign(str.data(), str.size()); }
+
+  void clear() {
+    data_[0] = '\0';
+    length_ = 0;
+  }
+  // clear() that also overwrites the old contents, for secrets
+  void wipe() {
+    memset(data_, 0, sizeof(data_));
+    length_ = 0;
+  }
+
+  const char *c_str() const { return data_; }
+  size_t size() const { return length_; }
+  bool empty() const { return length_ == 0; }
+
+  bool operator==(std::string_view other) const {
+    return other.size() == length_ && memcmp(other.data(), data_, length_) == 0;
+  }
+  bool operator!=(std::string_view other) const { return !(*this == other); }
+
+ private:
+  char data_[N + 1]{};
+  uint8_t length_{0};
+};
+
+}  // namespace nut_server
+}  // namespace esphome
@@ -0,0 +1,95 @@
+#include "nut_output_buffer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace esphome {
+namespace nut_server {
+
+NutOutputBuffer &NutOutputBuffer::append(const char *data, size_t length) {
+  if (overflow_) {
+    return *this;
+  }
+  if (CAPACITY - end_ < length) {
+    // Reclaim the space already sent before giving up
+    if (start_ > 0) {
+      memmove(buffer_, buffer_ + start_, end_ - start_);
+      end_ -= start_;
+      start_ = 0;
+    }
+    if (CAPACITY - end_ < length) {
+      overflow_ = true;
+      return *this;
+    }
+  }
+  memcpy(buffer_ + end_, data, length);
+  end_ += length;
+  return *this;
+}
+
+NutOutputBuffer &NutOutputBuffer::append_uint(uint32_t value) {
+  char digits[10];
+  size_t count = 0;
+  do {
+    digits[sizeof(digits) - 1 - count++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value > 0);
+  return append(digits + sizeof(digits) - count, count);
+}
+
+NutOutputBuffer &NutOutputBuffer::append_int(int32_t value) {
+  if (value < 0) {
+    append('-');
+    // Negate in unsigned arithmetic so INT32_MIN is representable
+    return append_uint(0u - static_cast<uint32_t>(value));
+  }
+  return append_uint(static_cast<uint32_t>(value));
+}
+
+NutOutputBuffer &NutOutputBuffer::append_fixed(float value, uint8_t decimals) {
+  if (std::isnan(value) || std::isinf(value)) {
+    return append("0");
+  }
+
+  decimals = std::min<uint8_t>(decimals, 6);
+  uint32_t scale = 1;
+  for (uint8_t i = 0; i < decimals; i++) {
+    scale *= 10;
+  }
+
+  // Single precision throughout; the ESP32 FPU has no double support
+  const bool negative = value < 0;
+  const float scaled = std::fabs(value) * static_cast<float>(scale) + 0.5f;
+  if (scaled >= 4.0e9f) {
+    // Far beyond anything a UPS reports; clamp rather than wrap
+    return append(negative ? "-4000000000" : "4000000000");
+  }
+  const uint32_t fixed = static_cast<uint32_t>(scaled);
+
+  if (negative && fixed > 0) {
+    append('-');
+  }
+  append_uint(fixed / scale);
+  if (decimals > 0) {
+    append('.');
+    uint32_t fraction = fixed % scale;
+    char digits[6];
+    for (int i = decimals - 1; i >= 0; i--) {
+      digits[i] = static_cast<char>('0' + fraction % 10);
+      fraction /= 10;
+    }
+    append(digits, decimals);
+  }
+  return *this;
+}
+
+void NutOutputBuffer::consume(size_t length) {
+  if (length >= pending()) {
+    start_ = 0;
+    end_ = 0;
+    return;
+  }
+  start_ += length;
+}
+
+}  // namespace nut_server
+}  // namespace esphome
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace esphome {
+namespace nut_server {
+
+// Per-client output capacity. Holds a full LIST VAR reply plus the replies of
+// further pipelined commands while the socket drains.
+static constexpr size_t NUT_OUTPUT_BUFFER_SIZE = 4096;
+
+/**
+ * Fixed-capacity output buffer for one NUT client
+ *
+ * Handlers append reply text directly; numbers are formatted in place, so
+ * building a reply never touches the heap. Bytes accepted by send() are
+ * consumed from the front, and a partially sent reply stays queued until the
+ * socket is writable again.
+ *
+ * An append that does not fit is dropped and latches overflow(); the server
+ * treats that as a client that stopped reading and disconnects it.
+ */
+class NutOutputBuffer {
+ public:
+  static constexpr size_t CAPACITY = NUT_OUTPUT_BUFFER_SIZE;
+
+  NutOutputBuffer &append(const char *data, size_t length);
+  NutOutputBuffer &append(const char *str) { return append(str, strlen(str)); }
+  NutOutputBuffer &append(std::string_view str) { return append(str.data(), str.size()); }
+  NutOutputBuffer &append(char c) { return append(&c, 1); }
+  NutOutputBuffer &append_uint(uint32_t value);
+  NutOutputBuffer &append_int(int32_t value);
+  // Fixed-point decimal, rounded half away from zero
+  NutOutputBuffer &append_fixed(float value, uint8_t decimals);
+
+  const char *pending_data() const { return buffer_ + start_; }
+  size_t pending() const { return end_ - start_; }
+  size_t available() const { return CAPACITY - pending(); }
+  bool empty() const { return start_ == end_; }
+  bool overflow() const { return overflow_; }
+
+  // Drop bytes the socket accepted
+  void consume(size_t length);
+  void clear() {
+    start_ = 0;
+    end_ = 0;
+    overflow_ = false;
+  }
+
+ private:
+  char buffer_[CAPACITY];
+  uint16_t start_{0};
+  uint16_t end_{0};
+  bool overflow_{false};
+};
+
+}  // namespace nut_server
+}  // namespace esphome
@@ -0,0 +1,285 @@
+#pragma once
+
+#include "nut_server.h"
+#include "../ups_hid/ups_hid.h"
+#include "../ups_hid/data_composite.h"
+#include "../ups_hid/data_hot.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace esphome {
+namespace nut_server {
+
+// How a variable's value is rendered on the wire
+enum class NutFormat : uint8_t {
+  TEXT,     // String accessor, sent as-is
+  INTEGER,  // Numeric accessor, truncated to an integer
+  DECIMAL   // Numeric accessor, one decimal place
+};
+
+// Variable metadata flags
+static constexpr uint8_t NUT_FLAG_RW = 0x01;  // Writable with SET VAR, listed by LIST RW
+
+struct NutVariableDef {
+  const char *name;
+  NutFormat format;
+  float (*number)(const ups_hid::UpsData &);       // NAN when unavailable (INTEGER/DECIMAL)
+  std::string (*text)(const ups_hid::UpsData &);   // Empty when unavailable (TEXT)
+  uint8_t flags;
+  const char *const *enum_values;                  // LIST ENUM values, enum_count entries
+  uint8_t enum_count;
+  float range_min;                                 // LIST RANGE bounds, NAN when none
+  float range_max;
+  // Numeric accessor over the UPS poll history instead of the snapshot (INTEGER/DECIMAL)
+  float (*summary)(const ups_hid::UpsHidComponent &);
+
+  bool is_rw() const { return flags & NUT_FLAG_RW; }
+  bool has_range() const { return !std::isnan(range_min) && !std::isnan(range_max); }
+};
+
+struct NutCommandDef {
+  const char *name;
+  ups_hid::UpsCommand command;
+};
+
+// ---------------------------------------------------------------------------
+// Compile-time perfect hash
+//
+// FNV-1a over the name, seeded; the seed is searched at compile time until
+// every entry of a table lands in its own slot. A lookup is one hash, one
+// slot read and one compare to reject names that are not in the table.
+// ---------------------------------------------------------------------------
+
+static constexpr uint8_t NUT_HASH_EMPTY = 0xFF;
+
+constexpr size_t nut_strlen(const char *str) {
+  size_t len = 0;
+  while (str[len] != '\0') len++;
+  return len;
+}
+
+constexpr uint32_t nut_hash(const char *str, size_t len, uint32_t seed) {
+  uint32_t hash = 2166136261u ^ seed;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= static_cast<uint8_t>(str[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+template<size_t SLOTS> struct NutHashIndex {
+  static_assert((SLOTS & (SLOTS - 1)) == 0, "slot count must be a power of two");
+  uint32_t seed{0};  // 0 = no collision-free seed found
+  uint8_t slots[SLOTS]{};
+};
+
+template<size_t SLOTS, typename Entry, size_t N>
+constexpr NutHashIndex<SLOTS> build_hash_index(const Entry (&entries)[N]) {
+  static_assert(N < NUT_HASH_EMPTY && N <= SLOTS, "too many entries for the hash index");
+  for (uint32_t seed = 1; seed < 4096; seed++) {
+    NutHashIndex<SLOTS> index{};
+    index.seed = seed;
+    for (size_t slot = 0; slot < SLOTS; slot++) {
+      index.slots[slot] = NUT_HASH_EMPTY;
+    }
+    bool collision = false;
+    for (size_t i = 0; i < N && !collision; i++) {
+      const size_t slot = nut_hash(entries[i].name, nut_strlen(entries[i].name), seed) & (SLOTS - 1);
+      if (index.slots[slot] != NUT_HASH_EMPTY) {
+        collision = true;
+      } else {
+        index.slots[slot] = static_cast<uint8_t>(i);
+      }
+    }
+    if (!collision) {
+      return index;
+    }
+  }
+  return NutHashIndex<SLOTS>{};
+}
+
+template<size_t SLOTS, typename Entry, size_t N>
+int find_in_hash_index(const NutHashIndex<SLOTS> &index, const Entry (&entries)[N],
+                       const char *name, size_t len) {
+  const uint8_t i = index.slots[nut_hash(name, len, index.seed) & (SLOTS - 1)];
+  if (i == NUT_HASH_EMPTY) {
+    return -1;
+  }
+  const char *candidate = entries[i].name;
+  if (strncmp(candidate, name, len) != 0 || candidate[len] != '\0') {
+    return -1;
+  }
+  return i;
+}
+
+// ---------------------------------------------------------------------------
+// Value sources
+// ---------------------------------------------------------------------------
+
+inline std::string nut_ups_manufacturer(const ups_hid::UpsData &data) {
+  return data.device.manufacturer.empty() ? "Unknown" : data.device.manufacturer;
+}
+
+inline std::string nut_ups_model(const ups_hid::UpsData &data) {
+  return data.device.model.empty() ? "Unknown UPS" : data.device.model;
+}
+
+struct NutStatusToken {
+  uint32_t flag;  // ups_hid::UPS_STATUS_* bit
+  const char *token;
+};
+
+// ups.status tokens in the order NUT clients print them
+static constexpr NutStatusToken NUT_STATUS_TOKENS[] = {
+  {ups_hid::UPS_STATUS_OL, "OL"},
+  {ups_hid::UPS_STATUS_OB, "OB"},
+  {ups_hid::UPS_STATUS_LB, "LB"},
+  {ups_hid::UPS_STATUS_CHRG, "CHRG"},
+  {ups_hid::UPS_STATUS_DISCHRG, "DISCHRG"},
+  {ups_hid::UPS_STATUS_OVER, "OVER"},
+  {ups_hid::UPS_STATUS_RB, "RB"},
+  {ups_hid::UPS_STATUS_FSD, "FSD"},
+  {ups_hid::UPS_STATUS_TRIM, "TRIM"},
+  {ups_hid::UPS_STATUS_BOOST, "BOOST"},
+};
+
+// Rendered from the status bits; only runs when the snapshot generation changes
+inline std::string nut_ups_status(const ups_hid::UpsData &data) {
+  const uint32_t flags = ups_hid::canonical_status(data);
+  std::string status;
+  for (const auto &entry : NUT_STATUS_TOKENS) {
+    if (flags & entry.flag) {
+      if (!status.empty()) status += " ";
+      status += entry.token;
+    }
+  }
+
+  if (data.has_fault()) {
+    if (!status.empty()) status += " ";
+    status += "ALARM";  // Alarm condition
+  }
+
+  return status;
+}
+
+constexpr NutVariableDef nut_text(const char *name, std::string (*text)(const ups_hid::UpsData &)) {
+  return {name, NutFormat::TEXT, nullptr, text, 0, nullptr, 0, NAN, NAN, nullptr};
+}
+
+constexpr NutVariableDef nut_number(const char *name, NutFormat format,
+                                    float (*number)(const ups_hid::UpsData &)) {
+  return {name, format, number, nullptr, 0, nullptr, 0, NAN, NAN, nullptr};
+}
+
+// Aggregate over the component's history_window; absent while the history is empty or disabled
+constexpr NutVariableDef nut_summary(const char *name, NutFormat format,
+                                     float (*summary)(const ups_hid::UpsHidComponent &)) {
+  return {name, format, nullptr, nullptr, 0, nullptr, 0, NAN, NAN, summary};
+}
+
+// ---------------------------------------------------------------------------
+// Registries
+//
+// Order is the LIST VAR / LIST CMD order. The UPS HID data is read-only, so
+// no variable currently carries RW, enum or range metadata.
+// ---------------------------------------------------------------------------
+
+inline constexpr NutVariableDef NUT_VARIABLE_DEFS[] = {
+  nut_text("ups.mfr", nut_ups_manufacturer),
+  nut_text("ups.model", nut_ups_model),
+  nut_text("ups.status", nut_ups_status),
+  nut_text("ups.serial", [](const ups_hid::UpsData &d) { return d.device.serial_number; }),
+  nut_text("ups.firmware", [](const ups_hid::UpsData &d) { return d.device.firmware_version; }),
+
+  nut_number("battery.charge", NutFormat::INTEGER, [](const ups_hid::UpsData &d) {
+    return d.battery.is_valid() && d.battery.level >= 0 ? d.battery.level : NAN;
+  }),
+  nut_number("battery.voltage", NutFormat::DECIMAL,
+             [](const ups_hid::UpsData &d) { return d.battery.voltage; }),
+  nut_number("battery.voltage.nominal", NutFormat::DECIMAL,
+             [](const ups_hid::UpsData &d) { return d.battery.voltage_nominal; }),
+  nut_number("battery.runtime", NutFormat::INTEGER, [](const ups_hid::UpsData &d) {
+    return d.battery.runtime_minutes > 0 ? d.battery.runtime_minutes * 60.0f : NAN;
+  }),
+
+  nut_number("input.voltage", NutFormat::DECIMAL, [](const ups_hid::UpsData &d) {
+    return d.power.input_voltage > 0 ? d.power.input_voltage : NAN;
+  }),
+  nut_number("input.voltage.nominal", NutFormat::DECIMAL,
+             [](const ups_hid::UpsData &d) { return d.power.input_voltage_nominal; }),
+  nut_number("input.frequency", NutFormat::DECIMAL,
+             [](const ups_hid::UpsData &d) { return d.power.frequency; }),
+  nut_number("input.transfer.low", NutFormat::DECIMAL,
+             [](const ups_hid::UpsData &d) { return d.power.input_transfer_low; }),
+  nut_number("input.transfer.high", NutFormat::DECIMAL,
+             [](const ups_hid::UpsData &d) { return d.power.input_transfer_high; }),
+
+  nut_number("output.voltage", NutFormat::DECIMAL, [](const ups_hid::UpsData &d) {
+    return d.power.output_voltage > 0 ? d.power.output_voltage : NAN;
+  }),
+  nut_number("output.voltage.nominal", NutFormat::DECIMAL,
+             [](const ups_hid::UpsData &d) { return d.power.output_voltage_nominal; }),
+
+  nut_number("ups.load", NutFormat::INTEGER, [](const ups_hid::UpsData &d) {
+    return d.power.load_percent >= 0 ? d.power.load_percent : NAN;
+  }),
+  nut_number("ups.realpower.nominal", NutFormat::INTEGER,
+             [](const ups_hid::UpsData &d) { return d.power.realpower_nominal; }),
+  nut_number("ups.power.nominal", NutFormat::INTEGER,
+             [](const ups_hid::UpsData &d) { return d.power.apparent_power_nominal; }),
+
+  // History summaries: the first two are standard NUT names, the load ones are extensions
+  nut_summary("input.voltage.minimum", NutFormat::DECIMAL, [](const ups_hid::UpsHidComponent &c) {
+    return c.get_history_stats(ups_hid::HistoryField::INPUT_VOLTAGE).min;
+  }),
+  nut_summary("input.voltage.maximum", NutFormat::DECIMAL, [](const ups_hid::UpsHidComponent &c) {
+    return c.get_history_stats(ups_hid::HistoryField::INPUT_VOLTAGE).max;
+  }),
+  nut_summary("ups.load.maximum", NutFormat::INTEGER, [](const ups_hid::UpsHidComponent &c) {
+    return c.get_history_stats(ups_hid::HistoryField::LOAD_PERCENT).max;
+  }),
+  nut_summary("ups.load.mean", NutFormat::DECIMAL, [](const ups_hid::UpsHidComponent &c) {
+    return c.get_history_stats(ups_hid::HistoryField::LOAD_PERCENT).mean;
+  }),
+};
+
+inline constexpr NutCommandDef NUT_COMMAND_DEFS[] = {
+  {"beeper.enable", ups_hid::UpsCommand::BEEPER_ENABLE},
+  {"beeper.disable", ups_hid::UpsCommand::BEEPER_DISABLE},
+  {"beeper.mute", ups_hid::UpsCommand::BEEPER_MUTE},
+  {"beeper.test", ups_hid::UpsCommand::BEEPER_TEST},
+  {"test.battery.start.quick", ups_hid::UpsCommand::BATTERY_TEST_QUICK},
+  {"test.battery.start.deep", ups_hid::UpsCommand::BATTERY_TEST_DEEP},
+  {"test.battery.stop", ups_hid::UpsCommand::BATTERY_TEST_STOP},
+  // Standard NUT command names for panel/UPS tests
+  {"test.panel.start", ups_hid::UpsCommand::UPS_TEST_START},
+  {"test.panel.stop", ups_hid::UpsCommand::UPS_TEST_STOP},
+  // Keep legacy names for compatibility
+  {"test.ups.start", ups_hid::UpsCommand::UPS_TEST_START},
+  {"test.ups.stop", ups_hid::UpsCommand::UPS_TEST_STOP},
+};
+
+static_assert(sizeof(NUT_VARIABLE_DEFS) / sizeof(NUT_VARIABLE_DEFS[0]) == NUT_VARIABLE_COUNT,
+              "NUT_VARIABLE_COUNT out of sync with NUT_VARIABLE_DEFS");
+
+inline constexpr auto NUT_VARIABLE_INDEX = build_hash_index<128>(NUT_VARIABLE_DEFS);
+inline constexpr auto NUT_COMMAND_INDEX = build_hash_index<32>(NUT_COMMAND_DEFS);
+static_assert(NUT_VARIABLE_INDEX.seed != 0, "no perfect hash seed for NUT variables");
+static_assert(NUT_COMMAND_INDEX.seed != 0, "no perfect hash seed for NUT commands");
+
+// Index into NUT_VARIABLE_DEFS, -1 if not a known variable
+inline int find_nut_variable(std::string_view name) {
+  return find_in_hash_index(NUT_VARIABLE_INDEX, NUT_VARIABLE_DEFS, name.data(), name.size());
+}
+
+inline const NutCommandDef *find_nut_command(std::string_view name) {
+  const int index = find_in_hash_index(NUT_COMMAND_INDEX, NUT_COMMAND_DEFS, name.data(), name.size());
+  return index < 0 ? nullptr : &NUT_COMMAND_DEFS[index];
+}
+
+}  // namespace nut_server
+}  // namespace esphome
@@ -1,25 +1,147 @@
 #include "nut_server.h"
+#include "nut_registry.h"
+#include "nut_args.h"
 #include "../ups_hid/ups_hid.h"
 #include "esphome/core/log.h"
 #include "esphome/core/util.h"
 #include "esphome/core/hal.h"
 #include <algorithm>
-#include <sstream>
-#include <iomanip>
 #include <cstring>
+#include <new>
 
 #ifdef USE_ESP32
 #include "lwip/err.h"
 #include "lwip/sys.h"
+#include "esp_vfs_eventfd.h"
 #include <fcntl.h>
 #include <errno.h>
+#include <unistd.h>
+#endif
+
+#ifdef USE_NUT_SERVER_TLS
+#include "esp_system.h"
+#include "mbedtls/net_sockets.h"
 #endif
 
 namespace esphome {
 namespace nut_server {
 
+// Served by GET VAR <ups> server.<name>; not part of LIST VAR
+struct NutServerStatDef {
+  const char *name;
+  std::atomic<uint32_t> NutServerStats::*counter;
+};
+
+static constexpr NutServerStatDef NUT_SERVER_STAT_DEFS[] = {
+    {"server.connections.accepted", &NutServerStats::connections_accepted},
+    {"server.connections.rejected", &NutServerStats::connections_rejected},
+    {"server.clients.peak", &NutServerStats::clients_peak},
+    {"server.clients.max", &NutServerStats::clients_max},
+    {"server.commands", &NutServerStats::commands},
+    {"server.errors", &NutServerStats::errors},
+    {"server.bytes.sent", &NutServerStats::bytes_sent},
+    {"server.memory.dynamic", &NutServerStats::memory_dynamic},
+    {"server.memory.peak", &NutServerStats::memory_peak},
+#ifdef USE_NUT_SERVER_TLS
+    {"server.tls.sessions", &NutServerStats::tls_sessions},
+    {"server.tls.handshakes", &NutServerStats::tls_handshakes},
+    {"server.tls.resumed", &NutServerStats::tls_resumed},
+    {"server.tls.failures", &NutServerStats::tls_failures},
+    {"server.tls.rejected", &NutServerStats::tls_rejected},
+    {"server.tls.handshake.last", &NutServerStats::tls_handshake_last_us},
+    {"server.tls.handshake.max", &NutServerStats::tls_handshake_max_us},
+    {"server.tls.session.heap.last", &NutServerStats::tls_session_heap_last},
+    {"server.tls.session.heap.max", &NutServerStats::tls_session_heap_max},
+#endif
+};
+
+// Lowercase names of the NutVerb values, as used in server.requests.<verb>
+static constexpr const char *NUT_VERB_NAMES[] = {
+    "list", "get", "set", "instcmd", "login", "logout", "username", "password", "subscribe",
+    "unsubscribe", "ver", "netver", "help", "upsdver", "starttls", "fsd", "other",
+};
+static_assert(sizeof(NUT_VERB_NAMES) / sizeof(NUT_VERB_NAMES[0]) == NUT_VERB_COUNT, "one name per NutVerb");
+
+// driver.stats.report.<type>.0x<id> names the HID report type in words
+static const char *report_type_name(uint8_t report_type) {
+  switch (report_type) {
+    case 0x01:
+      return "input";
+    case 0x02:
+      return "output";
+    case 0x03:
+      return "feature";
+  }
+  return "unknown";
+}
+
+static int report_type_from_name(std::string_view name) {
+  for (uint8_t report_type = 0x01; report_type <= 0x03; report_type++) {
+    if (name == report_type_name(report_type)) {
+      return report_type;
+    }
+  }
+  return -1;
+}
+
+static NutVerb nut_verb(std::string_view cmd) {
+  if (nut_iequals(cmd, "VERSION")) {
+    return NutVerb::VER;
+  }
+  for (size_t i = 0; i < NUT_VERB_COUNT - 1; i++) {
+    if (nut_iequals(cmd, NUT_VERB_NAMES[i])) {
+      return static_cast<NutVerb>(i);
+    }
+  }
+  return NutVerb::OTHER;
+}
+
+void NutClientDirectory::publish(size_t slot, const NutClientInfo &info) {
+  Slot &entry = slots_[slot];
+  const uint32_t sequence = entry.sequence.load(std::memory_order_relaxed);
+  entry.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  entry.remote_addr.store(info.remote_addr, std::memory_order_relaxed);
+  entry.connect_time.store(info.connect_time, std::memory_order_relaxed);
+  entry.flags.store(static_cast<uint32_t>(info.state) | (info.tls ? SLOT_TLS : 0), std::memory_order_relaxed);
+  entry.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool NutClientDirectory::read(size_t slot, NutClientInfo &info) const {
+  const Slot &entry = slots_[slot];
+  while (true) {
+    const uint32_t before = entry.sequence.load(std::memory_order_acquire);
+    if ((before & 1) == 0) {
+      info.remote_addr = entry.remote_addr.load(std::memory_order_relaxed);
+      info.connect_time = entry.connect_time.load(std::memory_order_relaxed);
+      const uint32_t flags = entry.flags.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (entry.sequence.load(std::memory_order_relaxed) == before) {
+        info.state = static_cast<ClientState>(flags & SLOT_STATE_MASK);
+        info.tls = (flags & SLOT_TLS) != 0;
+        return info.state != ClientState::DISCONNECTED;
+      }
+    }
+#ifdef USE_ESP32
+    // The server task is mid-publish; give it the CPU even if it runs at a lower priority
+    vTaskDelay(1);
+#endif
+  }
+}
+
 NutServerComponent::NutServerComponent() {
-  clients_.reserve(DEFAULT_MAX_CLIENTS);
+  ups_.reserve(MAX_NUT_UPS);
+}
+
+void NutServerComponent::add_ups(ups_hid::UpsHidComponent *ups_hid, const std::string &name) {
+  if (ups_.size() >= MAX_NUT_UPS) {
+    ESP_LOGE(TAG, "Only %zu UPS devices can be exported, ignoring '%s'", MAX_NUT_UPS, name.c_str());
+    return;
+  }
+  NutUps ups;
+  ups.name = name.empty() ? "ups" : name;
+  ups.ups_hid = ups_hid;
+  ups_.push_back(std::move(ups));
 }
 
 NutServerComponent::~NutServerComponent() {
@@ -29,45 +151,93 @@ NutServerComponent::~NutServerComponent() {
 void NutServerComponent::setup() {
   ESP_LOGCONFIG(TAG, "Setting up NUT Server...");
   
-  if (!ups_hid_) {
+  if (ups_.empty()) {
     ESP_LOGE(TAG, "No UPS HID component configured!");
     mark_failed();
     return;
   }
   
   // Initialize clients
-  clients_.resize(max_clients_);
+  stats_.clients_max.store(max_clients_, std::memory_order_relaxed);
   for (auto &client : clients_) {
     client.reset();
   }
   
+#ifdef USE_NUT_SERVER_TLS
+  if (!tls_context_.setup(tls_certificate_, tls_private_key_, tls_cache_size_, tls_session_timeout_s_)) {
+    ESP_LOGE(TAG, "TLS setup failed, STARTTLS disabled");
+  }
+  // mbedTLS keeps its own parsed copies
+  tls_certificate_ = std::string();
+  tls_private_key_ = std::string();
+#endif
+  
   if (!start_server()) {
     ESP_LOGE(TAG, "Failed to start NUT server!");
     mark_failed();
     return;
   }
   
+  for (auto &ups : ups_) {
+    ups.ups_hid->add_on_snapshot_change_callback([this](uint32_t changes) { this->on_ups_data_changed(changes); });
+  }
+  
   ESP_LOGCONFIG(TAG, "NUT Server started on port %d", port_);
 }
 
-void NutServerComponent::loop() {
-  // Main loop handles client cleanup
-  cleanup_inactive_clients();
-}
-
 void NutServerComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "NUT Server:");
   ESP_LOGCONFIG(TAG, "  Port: %d", port_);
   ESP_LOGCONFIG(TAG, "  Max Clients: %d", max_clients_);
-  ESP_LOGCONFIG(TAG, "  UPS Name: %s", get_ups_name().c_str());
+  ESP_LOGCONFIG(TAG, "  Task: core %d, priority %u, stack %u bytes (%u free)", task_config_.core,
+                task_config_.priority, task_config_.stack_size, get_task_stack_free());
+  const ups_hid::MemoryUsage memory = get_memory_usage();
+  ESP_LOGCONFIG(TAG, "  Memory: %zu bytes static (%zu client table), %zu bytes dynamic (peak %zu)",
+                memory.static_bytes, sizeof(clients_), memory.dynamic_bytes, memory.dynamic_peak);
   ESP_LOGCONFIG(TAG, "  Username: %s", username_.c_str());
   ESP_LOGCONFIG(TAG, "  Authentication: %s", password_.empty() ? "Disabled" : "Enabled");
+  ESP_LOGCONFIG(TAG, "  Connections: %u accepted, %u rejected, %u peak clients",
+                stats_.connections_accepted.load(std::memory_order_relaxed),
+                stats_.connections_rejected.load(std::memory_order_relaxed),
+                stats_.clients_peak.load(std::memory_order_relaxed));
+  ESP_LOGCONFIG(TAG, "  Commands: %u (%u errors), %u bytes sent", stats_.commands.load(std::memory_order_relaxed),
+                stats_.errors.load(std::memory_order_relaxed), stats_.bytes_sent.load(std::memory_order_relaxed));
+  NutClientInfo clients[NUT_CLIENT_SLOTS];
+  const size_t client_count = get_clients(clients, NUT_CLIENT_SLOTS);
+  for (size_t i = 0; i < client_count; i++) {
+    ESP_LOGCONFIG(TAG, "    Client %s: %s%s, %u s", clients[i].remote_ip().c_str(),
+                  clients[i].state == ClientState::AUTHENTICATED ? "authenticated" : "connected",
+                  clients[i].tls ? " (TLS)" : "", (millis() - clients[i].connect_time) / 1000);
+  }
+#ifdef USE_NUT_SERVER_TLS
+  ESP_LOGCONFIG(TAG, "  STARTTLS: %s, %u sessions, %u bytes free heap minimum, %u cached sessions",
+                tls_context_.is_ready() ? "Enabled" : "Failed", tls_max_sessions_, tls_min_free_heap_,
+                tls_cache_size_);
+  ESP_LOGCONFIG(TAG, "  TLS: %u handshakes (%u resumed, %u failed, %u rejected), max %u us CPU, max %u bytes heap",
+                stats_.tls_handshakes.load(std::memory_order_relaxed),
+                stats_.tls_resumed.load(std::memory_order_relaxed),
+                stats_.tls_failures.load(std::memory_order_relaxed),
+                stats_.tls_rejected.load(std::memory_order_relaxed),
+                stats_.tls_handshake_max_us.load(std::memory_order_relaxed),
+                stats_.tls_session_heap_max.load(std::memory_order_relaxed));
+#endif
+  if (instrumentation_enabled_) {
+    std::lock_guard<std::mutex> lock(verb_stats_mutex_);
+    for (size_t i = 0; i < NUT_VERB_COUNT; i++) {
+      const NutVerbStats &verb = verb_stats_[i];
+      if (verb.requests > 0) {
+        ESP_LOGCONFIG(TAG, "    %s: %u requests, mean %u us, max %u us", NUT_VERB_NAMES[i], verb.requests,
+                      static_cast<uint32_t>(verb.total_us / verb.requests), verb.max_us);
+      }
+    }
+  }
   
-  if (ups_hid_) {
-    ESP_LOGCONFIG(TAG, "  UPS HID Component: Connected");
-  } else {
+  if (ups_.empty()) {
     ESP_LOGCONFIG(TAG, "  UPS HID Component: Not configured!");
   }
+  for (const auto &ups : ups_) {
+    ESP_LOGCONFIG(TAG, "  UPS: %s (%s)", ups.name.c_str(), has_ups_data(ups) ? "connected" : "waiting for device");
+  }
 }
 
 bool NutServerComponent::start_server() {
@@ -113,9 +283,24 @@ bool NutServerComponent::start_server() {
     return false;
   }
   
+  // Change notifications need a descriptor the polling context can signal into select()
+  esp_vfs_eventfd_config_t eventfd_config = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+  esp_err_t err = esp_vfs_eventfd_register(&eventfd_config);
+  if (err == ESP_OK || err == ESP_ERR_INVALID_STATE) {  // Already registered elsewhere
+    wake_fd_ = eventfd(0, 0);
+  }
+  if (wake_fd_ < 0) {
+    ESP_LOGW(TAG, "eventfd unavailable, SUBSCRIBE disabled");
+  }
+  
   // Create server task
   server_running_ = true;
-  xTaskCreate(server_task, "nut_server", 4096, this, 1, &server_task_handle_);
+  if (ups_hid::create_task(server_task, task_config_, this, &server_task_handle_) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create server task (stack %u bytes)", task_config_.stack_size);
+    server_task_handle_ = nullptr;
+    stop_server();
+    return false;
+  }
   
   return true;
 #else
@@ -129,27 +314,73 @@ void NutServerComponent::stop_server() {
   shutdown_requested_ = true;
   server_running_ = false;
   
-  // Close all client connections
-  {
-    std::lock_guard<std::mutex> lock(clients_mutex_);
-    for (auto &client : clients_) {
-      if (client.is_active()) {
-        disconnect_client(client);
+  // The server task owns the clients; let it close them on its way out. It
+  // is never deleted from here: lwIP keeps a task blocked in select() on a
+  // list through its stack, so the task has to return from select() itself.
+  if (server_task_handle_ != nullptr) {
+    if (wake_fd_ >= 0) {
+      const uint64_t signal = 1;
+      write(wake_fd_, &signal, sizeof(signal));
+    }
+    // Makes the listening socket readable; without an eventfd the bounded
+    // select() timeout is the fallback
+    shutdown(server_socket_, SHUT_RDWR);
+    uint32_t waited_ms = 0;
+    while (!server_task_exited_) {
+      vTaskDelay(pdMS_TO_TICKS(10));
+      waited_ms += 10;
+      if (waited_ms == SERVER_STOP_TIMEOUT_MS) {
+        ESP_LOGW(TAG, "Server task slow to stop, still waiting");
       }
     }
   }
+  server_task_handle_ = nullptr;
+  // Safe from here on: the task no longer runs
+  for (auto &client : clients_) {
+    if (client.is_active()) {
+      disconnect_client(client);
+    }
+  }
   
   // Close server socket
   if (server_socket_ >= 0) {
     close(server_socket_);
     server_socket_ = -1;
   }
-  
-  // Wait for server task to finish
-  if (server_task_handle_) {
-    vTaskDelete(server_task_handle_);
-    server_task_handle_ = nullptr;
+  if (wake_fd_ >= 0) {
+    close(wake_fd_);
+    wake_fd_ = -1;
+  }
+#endif
+}
+
+// Heap the server holds besides its object: the UPS tables with their rendered
+// replies, TLS session objects (mbedTLS buffers are in server.tls.session.heap.*)
+// and configuration strings. The client table is part of the object.
+void NutServerComponent::update_memory_usage() {
+  size_t bytes = ups_hid::heap_bytes(ups_) + ups_hid::heap_bytes(username_) + ups_hid::heap_bytes(password_);
+  for (const auto &ups : ups_) {
+    bytes += ups_hid::heap_bytes(ups.name) + ups_hid::heap_bytes(ups.table.list_var) +
+             ups_hid::heap_bytes(ups.table.render_buffer) + ups_hid::heap_bytes(ups.table.list_ups);
+  }
+#ifdef USE_NUT_SERVER_TLS
+  for (const auto &client : clients_) {
+    if (client.tls) {
+      bytes += sizeof(NutTlsSession);
+    }
   }
+#endif
+  stats_.memory_dynamic.store(bytes, std::memory_order_relaxed);
+  if (bytes > stats_.memory_peak.load(std::memory_order_relaxed)) {
+    stats_.memory_peak.store(bytes, std::memory_order_relaxed);
+  }
+}
+
+uint32_t NutServerComponent::get_task_stack_free() const {
+#ifdef USE_ESP32
+  return server_running_ ? ups_hid::task_stack_free(server_task_handle_) : 0;
+#else
+  return 0;
 #endif
 }
 
@@ -158,25 +389,114 @@ void NutServerComponent::server_task(void *param) {
   NutServerComponent *server = static_cast<NutServerComponent *>(param);
   
   while (server->server_running_) {
-    server->accept_clients();
+    fd_set read_fds;
+    fd_set write_fds;
+    int ready = server->wait_for_activity(read_fds, write_fds);
+    if (!server->server_running_) {
+      break;
+    }
     
-    // Handle all connected clients
-    {
-      std::lock_guard<std::mutex> lock(server->clients_mutex_);
+    if (ready < 0) {
+      if (errno != EINTR) {
+        ESP_LOGW(TAG, "select() failed: %d", errno);
+        vTaskDelay(pdMS_TO_TICKS(SELECT_ERROR_BACKOFF_MS));
+      }
+      continue;
+    }
+    
+    if (ready > 0) {
+      if (FD_ISSET(server->server_socket_, &read_fds)) {
+        server->accept_clients();
+      }
+      
+      if (server->wake_fd_ >= 0 && FD_ISSET(server->wake_fd_, &read_fds)) {
+        uint64_t signals;
+        read(server->wake_fd_, &signals, sizeof(signals));
+        if (server->pending_changes_.exchange(0) != 0) {
+          server->notify_subscribers();
+        }
+      }
+      
+      // Only clients with pending data (or a pending close) are serviced; the
+      // client table belongs to this task, so no lock is taken for any of it
       for (auto &client : server->clients_) {
-        if (client.is_active()) {
+        if (client.is_active() && FD_ISSET(client.socket_fd, &write_fds)) {
+          server->resume_client(client);
+        }
+        if (client.is_active() && FD_ISSET(client.socket_fd, &read_fds)) {
           server->handle_client(client);
         }
       }
     }
     
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    // The select() timeout is sized so this runs when the oldest client expires
+    server->cleanup_inactive_clients();
+    server->update_memory_usage();
   }
   
+  for (auto &client : server->clients_) {
+    if (client.is_active()) {
+      server->disconnect_client(client);
+    }
+  }
+  server->server_task_exited_ = true;
   vTaskDelete(nullptr);
 #endif
 }
 
+#ifdef USE_ESP32
+int NutServerComponent::wait_for_activity(fd_set &read_fds, fd_set &write_fds) {
+  FD_ZERO(&read_fds);
+  FD_ZERO(&write_fds);
+  FD_SET(server_socket_, &read_fds);
+  int max_fd = server_socket_;
+  if (wake_fd_ >= 0) {
+    FD_SET(wake_fd_, &read_fds);
+    max_fd = std::max(max_fd, wake_fd_);
+  }
+  
+  // Sleep until a socket is readable or the next client would time out;
+  // with no clients there is nothing to expire, so block indefinitely unless
+  // there is no eventfd to interrupt the wait
+  bool has_clients = false;
+  uint32_t next_timeout_ms = CLIENT_TIMEOUT_MS;
+  {
+    const uint32_t now = millis();
+    for (const auto &client : clients_) {
+      if (!client.is_active()) {
+        continue;
+      }
+      // A client with a backlog is only watched for writability until it drains
+      if (client.wants_write()) {
+        FD_SET(client.socket_fd, &write_fds);
+      }
+      if (!client.output_blocked()) {
+        FD_SET(client.socket_fd, &read_fds);
+      }
+      max_fd = std::max(max_fd, client.socket_fd);
+      has_clients = true;
+      
+      const uint32_t idle_ms = now - client.last_activity;
+      const uint32_t remaining_ms = idle_ms < CLIENT_TIMEOUT_MS ? CLIENT_TIMEOUT_MS - idle_ms : 0;
+      next_timeout_ms = std::min(next_timeout_ms, remaining_ms);
+    }
+  }
+  
+  // cleanup_inactive_clients() uses a strict comparison, so wake just past the deadline
+  next_timeout_ms += 1;
+  // Without an eventfd, stop_server() is only noticed when select() returns
+  const bool bounded = has_clients || wake_fd_ < 0;
+  if (wake_fd_ < 0) {
+    next_timeout_ms = std::min(next_timeout_ms, SERVER_IDLE_WAKE_MS);
+  }
+  struct timeval timeout;
+  timeout.tv_sec = next_timeout_ms / 1000;
+  timeout.tv_usec = (next_timeout_ms % 1000) * 1000;
+  
+  return select(max_fd + 1, &read_fds, &write_fds, nullptr, bounded ? &timeout : nullptr);
+}
+#endif
+
 void NutServerComponent::accept_clients() {
 #ifdef USE_ESP32
   struct sockaddr_in client_addr;
@@ -195,18 +515,27 @@ void NutServerComponent::accept_clients() {
   fcntl(client_socket, F_SETFL, flags | O_NONBLOCK);
   
   // Find available client slot
-  std::lock_guard<std::mutex> lock(clients_mutex_);
-  for (auto &client : clients_) {
+  uint32_t active = 1;
+  for (const auto &client : clients_) {
+    active += client.is_active() ? 1 : 0;
+  }
+  for (size_t i = 0; i < max_clients_; i++) {
+    NutClient &client = clients_[i];
     if (!client.is_active()) {
+      stats_.connections_accepted.fetch_add(1, std::memory_order_relaxed);
+      if (active > stats_.clients_peak.load(std::memory_order_relaxed)) {
+        stats_.clients_peak.store(active, std::memory_order_relaxed);
+      }
       client.socket_fd = client_socket;
       client.state = ClientState::CONNECTED;
       uint32_t now = millis();
       client.last_activity = now;
       client.connect_time = now;
       client.login_attempts = 0;
-      client.remote_ip = std::string(inet_ntoa(client_addr.sin_addr));
+      client.remote_addr = client_addr.sin_addr.s_addr;
+      publish_client(client);
       
-      ESP_LOGD(TAG, "Client connected from %s", client.remote_ip.c_str());
+      ESP_LOGD(TAG, "Client connected from %s", client.remote_ip().c_str());
       
       // NUT protocol: No initial greeting - wait for client commands
       return;
@@ -215,37 +544,43 @@ void NutServerComponent::accept_clients() {
   
   // No available slots
   ESP_LOGW(TAG, "Maximum clients reached, rejecting connection");
+  stats_.connections_rejected.fetch_add(1, std::memory_order_relaxed);
   const char *msg = "ERR MAX-CLIENTS Maximum number of clients reached\n";
-  send(client_socket, msg, strlen(msg), 0);
+  send(client_socket, msg, strlen(msg), MSG_DONTWAIT);
   close(client_socket);
 #endif
 }
 
 void NutServerComponent::handle_client(NutClient &client) {
 #ifdef USE_ESP32
-  char buffer[MAX_COMMAND_LENGTH];
-  int bytes_received = recv(client.socket_fd, buffer, sizeof(buffer) - 1, 0);
-  
-  if (bytes_received > 0) {
-    buffer[bytes_received] = '\0';
-    
-    // Remove trailing newline
-    char *newline = strchr(buffer, '\n');
-    if (newline) *newline = '\0';
-    newline = strchr(buffer, '\r');
-    if (newline) *newline = '\0';
-    
-    client.last_activity = millis();
-    
-    ESP_LOGV(TAG, "Received command: %s", buffer);
-    process_command(client, std::string(buffer));
+#ifdef USE_NUT_SERVER_TLS
+  if (client.tls) {
+    handle_tls_client(client);
+    return;
+  }
+#endif
+  // Drain everything the socket has so pipelined commands are answered in one pass,
+  // unless replies are backing up; after STARTTLS the rest belongs to the handshake
+  while (client.is_active() && !client.output_blocked() && !client.starttls_pending) {
+    const size_t space = sizeof(client.rx_buffer) - client.rx_length;
+    int bytes_received = recv(client.socket_fd, client.rx_buffer + client.rx_length, space, 0);
     
-  } else if (bytes_received == 0) {
-    // Client disconnected
-    ESP_LOGD(TAG, "Client disconnected");
-    disconnect_client(client);
-  } else {
-    if (errno != EWOULDBLOCK && errno != EAGAIN) {
+    if (bytes_received > 0) {
+      client.rx_length += bytes_received;
+      client.last_activity = millis();
+      process_received_lines(client);
+      if (static_cast<size_t>(bytes_received) < space) {
+        break;
+      }
+    } else if (bytes_received == 0) {
+      // Client disconnected
+      ESP_LOGD(TAG, "Client disconnected");
+      disconnect_client(client);
+      return;
+    } else {
+      if (errno == EWOULDBLOCK || errno == EAGAIN) {
+        break;
+      }
       if (errno == ECONNRESET || errno == EPIPE) {
         // Client abruptly disconnected - this is normal, log at debug level
         ESP_LOGD(TAG, "Client connection reset (error %d)", errno);
@@ -254,24 +589,156 @@ void NutServerComponent::handle_client(NutClient &client) {
         ESP_LOGW(TAG, "Receive error: %d", errno);
       }
       disconnect_client(client);
+      return;
     }
   }
+  
+  if (client.is_active() && !flush_client(client)) {
+    disconnect_client(client);
+    return;
+  }
+#ifdef USE_NUT_SERVER_TLS
+  if (client.is_active() && client.starttls_pending && client.tx.empty() && !start_tls(client)) {
+    disconnect_client(client);
+  }
+#endif
 #endif
 }
 
+void NutServerComponent::resume_client(NutClient &client) {
+#ifdef USE_NUT_SERVER_TLS
+  if (client.tls) {
+    if (!client.tls->established) {
+      if (!continue_tls_handshake(client)) {
+        disconnect_client(client);
+      }
+      return;
+    }
+    if (!flush_client(client)) {
+      disconnect_client(client);
+      return;
+    }
+    // Records mbedTLS decrypted but held back while the output was blocked
+    if (!client.output_blocked()) {
+      handle_tls_client(client);
+    }
+    return;
+  }
+#endif
+  if (!flush_client(client)) {
+    disconnect_client(client);
+    return;
+  }
+#ifdef USE_NUT_SERVER_TLS
+  if (client.starttls_pending) {
+    if (client.tx.empty() && !start_tls(client)) {
+      disconnect_client(client);
+    }
+    return;
+  }
+#endif
+  // Commands held back while the output was blocked
+  if (!client.output_blocked() && client.rx_length > 0) {
+    process_received_lines(client);
+    if (client.is_active() && !flush_client(client)) {
+      disconnect_client(client);
+    }
+  }
+}
+
+void NutServerComponent::process_received_lines(NutClient &client) {
+  size_t line_start = 0;
+  
+  while (client.is_active() && !client.output_blocked() && !client.starttls_pending) {
+    char *begin = client.rx_buffer + line_start;
+    char *newline = static_cast<char *>(memchr(begin, '\n', client.rx_length - line_start));
+    if (!newline) {
+      break;
+    }
+    
+    size_t line_length = newline - begin;
+    if (line_length > 0 && begin[line_length - 1] == '\r') {
+      line_length--;
+    }
+    line_start = (newline - client.rx_buffer) + 1;
+    
+    if (client.rx_discarding) {
+      // Tail of an overlong line; already answered with an error
+      client.rx_discarding = false;
+      continue;
+    }
+    
+    // Parsed in place; the views into rx_buffer live until the memmove below
+    ESP_LOGV(TAG, "Received command: %.*s", static_cast<int>(line_length), begin);
+    process_command(client, std::string_view(begin, line_length));
+  }
+  
+  // process_command() may have disconnected the client and reset its buffer
+  if (!client.is_active()) {
+    return;
+  }
+  
+  // Keep the unterminated remainder for the next segment
+  client.rx_length -= line_start;
+  if (line_start > 0 && client.rx_length > 0) {
+    memmove(client.rx_buffer, client.rx_buffer + line_start, client.rx_length);
+  }
+  
+  // Behind STARTTLS the remainder is the start of the handshake, not a command
+  if (client.rx_length == sizeof(client.rx_buffer) && !client.output_blocked() && !client.starttls_pending) {
+    ESP_LOGW(TAG, "Command from %s exceeds %zu bytes, discarding", client.remote_ip().c_str(),
+             sizeof(client.rx_buffer));
+    if (!client.rx_discarding) {
+      send_error(client, "INVALID-ARGUMENT");
+    }
+    client.rx_length = 0;
+    client.rx_discarding = true;
+  }
+}
+
 void NutServerComponent::disconnect_client(NutClient &client) {
 #ifdef USE_ESP32
   if (client.socket_fd >= 0) {
+    // Deliver queued replies (e.g. "OK Goodbye") before closing
+    flush_client(client);
+#ifdef USE_NUT_SERVER_TLS
+    if (client.tls && client.tls->established) {
+      mbedtls_ssl_close_notify(&client.tls->ssl);  // Best effort, the socket is non-blocking
+    }
+    if (client.tls || client.starttls_pending) {
+      stats_.tls_sessions.fetch_sub(1, std::memory_order_relaxed);
+    }
+#endif
     close(client.socket_fd);
   }
   client.reset();
+  publish_client(client);
 #endif
 }
 
+void NutServerComponent::publish_client(const NutClient &client) {
+  NutClientInfo info;
+  info.remote_addr = client.remote_addr;
+  info.connect_time = client.connect_time;
+  info.state = client.state;
+#ifdef USE_NUT_SERVER_TLS
+  info.tls = client.tls && client.tls->established;
+#endif
+  client_directory_.publish(&client - clients_.data(), info);
+}
+
+size_t NutServerComponent::get_clients(NutClientInfo *clients, size_t max_count) const {
+  size_t count = 0;
+  for (size_t slot = 0; slot < NUT_CLIENT_SLOTS && count < max_count; slot++) {
+    if (client_directory_.read(slot, clients[count])) {
+      count++;
+    }
+  }
+  return count;
+}
+
 void NutServerComponent::cleanup_inactive_clients() {
   uint32_t now = millis();
-  std::lock_guard<std::mutex> lock(clients_mutex_);
-  
   for (auto &client : clients_) {
     if (client.is_active() && (now - client.last_activity) > CLIENT_TIMEOUT_MS) {
       ESP_LOGD(TAG, "Client timeout, disconnecting");
@@ -280,42 +747,53 @@ void NutServerComponent::cleanup_inactive_clients() {
   }
 }
 
-void NutServerComponent::process_command(NutClient &client, const std::string &command) {
+void NutServerComponent::process_command(NutClient &client, std::string_view command) {
   if (command.empty()) {
     return;
   }
+  stats_.commands.fetch_add(1, std::memory_order_relaxed);
   
   // Parse command and arguments
-  size_t space_pos = command.find(' ');
-  std::string cmd = (space_pos != std::string::npos) ? 
-                     command.substr(0, space_pos) : command;
-  std::string args = (space_pos != std::string::npos) ? 
-                      command.substr(space_pos + 1) : "";
+  std::string_view args;
+  const std::string_view cmd = split_nut_head(command, args);
   
   // Debug: Log all received commands
-  ESP_LOGD(TAG, "Received command: '%s' args: '%s'", cmd.c_str(), args.c_str());
-  
-  // Convert command to uppercase for comparison
-  std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::toupper);
+  ESP_LOGD(TAG, "Received command: '%.*s' args: '%.*s'", static_cast<int>(cmd.size()), cmd.data(),
+           static_cast<int>(args.size()), args.data());
   
+  if (!instrumentation_enabled_) {
+    dispatch_command(client, cmd, args);
+    return;
+  }
+  const uint32_t started = micros();
+  dispatch_command(client, cmd, args);
+  const uint32_t elapsed_us = micros() - started;
+  std::lock_guard<std::mutex> lock(verb_stats_mutex_);
+  NutVerbStats &verb = verb_stats_[static_cast<size_t>(nut_verb(cmd))];
+  verb.requests++;
+  verb.max_us = std::max(verb.max_us, elapsed_us);
+  verb.total_us += elapsed_us;
+}
+
+void NutServerComponent::dispatch_command(NutClient &client, std::string_view cmd, std::string_view args) {
   // Commands that don't require authentication
-  if (cmd == "HELP") {
+  if (nut_iequals(cmd, "HELP")) {
     handle_help(client);
-  } else if (cmd == "VER" || cmd == "VERSION") {
+  } else if (nut_iequals(cmd, "VER") || nut_iequals(cmd, "VERSION")) {
     handle_version(client);
-  } else if (cmd == "NETVER") {
+  } else if (nut_iequals(cmd, "NETVER")) {
     handle_netver(client);
-  } else if (cmd == "STARTTLS") {
+  } else if (nut_iequals(cmd, "STARTTLS")) {
     handle_starttls(client);
-  } else if (cmd == "USERNAME") {
+  } else if (nut_iequals(cmd, "USERNAME")) {
     handle_username(client, args);
-  } else if (cmd == "PASSWORD") {
+  } else if (nut_iequals(cmd, "PASSWORD")) {
     handle_password(client, args);
-  } else if (cmd == "LOGIN") {
+  } else if (nut_iequals(cmd, "LOGIN")) {
     handle_login(client, args);
-  } else if (cmd == "LOGOUT") {
+  } else if (nut_iequals(cmd, "LOGOUT")) {
     handle_logout(client);
-  } else if (cmd == "UPSDVER") {
+  } else if (nut_iequals(cmd, "UPSDVER")) {
     handle_upsdver(client);
   }
   // Commands requiring authentication
@@ -323,80 +801,70 @@ void NutServerComponent::process_command(NutClient &client, const std::string &c
     send_error(client, "ACCESS-DENIED");
   } else {
     // Authenticated commands
-    if (cmd == "LIST") {
+    if (nut_iequals(cmd, "LIST")) {
       // Parse LIST subcommand
-      size_t sub_pos = args.find(' ');
-      std::string subcmd = (sub_pos != std::string::npos) ? 
-                           args.substr(0, sub_pos) : args;
-      std::string subargs = (sub_pos != std::string::npos) ? 
-                            args.substr(sub_pos + 1) : "";
-      
-      std::transform(subcmd.begin(), subcmd.end(), subcmd.begin(), ::toupper);
+      std::string_view subargs;
+      const std::string_view subcmd = split_nut_head(args, subargs);
       
-      if (subcmd == "UPS") {
+      if (nut_iequals(subcmd, "UPS")) {
         handle_list_ups(client);
-      } else if (subcmd == "VAR") {
+      } else if (nut_iequals(subcmd, "VAR")) {
         handle_list_var(client, subargs);
-      } else if (subcmd == "CMD") {
+      } else if (nut_iequals(subcmd, "CMD")) {
         handle_list_cmd(client, subargs);
-      } else if (subcmd == "CLIENTS") {
+      } else if (nut_iequals(subcmd, "CLIENTS")) {
         handle_list_clients(client);
-      } else if (subcmd == "RW") {
+      } else if (nut_iequals(subcmd, "RW")) {
         handle_list_rwvar(client, subargs);
-      } else if (subcmd == "ENUM") {
+      } else if (nut_iequals(subcmd, "ENUM")) {
         handle_list_enum(client, subargs);
-      } else if (subcmd == "RANGE") {
+      } else if (nut_iequals(subcmd, "RANGE")) {
         handle_list_range(client, subargs);
       } else {
         send_error(client, "INVALID-ARGUMENT");
       }
-    } else if (cmd == "GET") {
+    } else if (nut_iequals(cmd, "GET")) {
       // Parse GET subcommand
-      size_t sub_pos = args.find(' ');
-      std::string subcmd = (sub_pos != std::string::npos) ? 
-                           args.substr(0, sub_pos) : args;
-      std::string subargs = (sub_pos != std::string::npos) ? 
-                            args.substr(sub_pos + 1) : "";
-      
-      std::transform(subcmd.begin(), subcmd.end(), subcmd.begin(), ::toupper);
+      std::string_view subargs;
+      const std::string_view subcmd = split_nut_head(args, subargs);
       
-      if (subcmd == "VAR") {
+      if (nut_iequals(subcmd, "VAR")) {
         handle_get_var(client, subargs);
       } else {
         send_error(client, "INVALID-ARGUMENT");
       }
-    } else if (cmd == "SET") {
+    } else if (nut_iequals(cmd, "SET")) {
       // Parse SET subcommand
-      size_t sub_pos = args.find(' ');
-      std::string subcmd = (sub_pos != std::string::npos) ? 
-                           args.substr(0, sub_pos) : args;
-      std::string subargs = (sub_pos != std::string::npos) ? 
-                            args.substr(sub_pos + 1) : "";
+      std::string_view subargs;
+      const std::string_view subcmd = split_nut_head(args, subargs);
       
-      std::transform(subcmd.begin(), subcmd.end(), subcmd.begin(), ::toupper);
-      
-      if (subcmd == "VAR") {
+      if (nut_iequals(subcmd, "VAR")) {
         handle_set_var(client, subargs);
       } else {
         send_error(client, "INVALID-ARGUMENT");
       }
-    } else if (cmd == "INSTCMD") {
+    } else if (nut_iequals(cmd, "SUBSCRIBE")) {
+      handle_subscribe(client, args);
+    } else if (nut_iequals(cmd, "UNSUBSCRIBE")) {
+      handle_unsubscribe(client, args);
+    } else if (nut_iequals(cmd, "INSTCMD")) {
       handle_instcmd(client, args);
-    } else if (cmd == "FSD") {
+    } else if (nut_iequals(cmd, "FSD")) {
       handle_fsd(client, args);
-    } else if (cmd == get_ups_name()) {
+    } else if (find_ups(cmd)) {
       // Legacy upsc -l format: sends UPS name directly as command
       // This is for old-style variable name support
       handle_legacy_list_vars(client, cmd);
     } else {
-      ESP_LOGW(TAG, "Unknown command received: '%s' with args: '%s'", cmd.c_str(), args.c_str());
+      ESP_LOGW(TAG, "Unknown command received: '%.*s' with args: '%.*s'", static_cast<int>(cmd.size()), cmd.data(),
+               static_cast<int>(args.size()), args.data());
       send_error(client, "UNKNOWN-COMMAND");
     }
   }
 }
 
-void NutServerComponent::handle_login(NutClient &client, const std::string &args) {
-  auto parts = split_args(args);
+void NutServerComponent::handle_login(NutClient &client, std::string_view args) {
+  const NutArgs parts = split_nut_args(args);
   // client could already submitted login information through its correspondening commands
   if (client.state == ClientState::AUTHENTICATED)
   {
@@ -421,9 +889,10 @@ void NutServerComponent::handle_login(NutClient &client, const std::string &args
 
   if (authenticate(parts[0], parts[1])) {
     client.state = ClientState::AUTHENTICATED;
-    client.username = parts[0];
+    client.username.assign(parts[0]);
+    publish_client(client);
     send_response(client, "OK\n");
-    ESP_LOGD(TAG, "Client authenticated as %s", parts[0].c_str());
+    ESP_LOGD(TAG, "Client authenticated as %s", client.username.c_str());
   } else {
     client.login_attempts++;
     if (client.login_attempts >= MAX_LOGIN_ATTEMPTS) {
@@ -442,116 +911,235 @@ void NutServerComponent::handle_logout(NutClient &client) {
 }
 
 void NutServerComponent::handle_list_ups(NutClient &client) {
-  std::string ups_name = get_ups_name();
-  std::string ups_description = get_ups_description();
-  
-  std::string response = "BEGIN LIST UPS\n";
-  response += "UPS " + ups_name + " \"" + ups_description + "\"\n";
-  response += "END LIST UPS\n";
-  send_response(client, response);
+  client.tx.append("BEGIN LIST UPS\n");
+  for (auto &ups : ups_) {
+    client.tx.append(get_variable_table(ups).list_ups);
+  }
+  client.tx.append("END LIST UPS\n");
 }
 
-void NutServerComponent::handle_list_var(NutClient &client, const std::string &args) {
-  if (args != get_ups_name()) {
+void NutServerComponent::handle_list_var(NutClient &client, std::string_view args) {
+  NutUps *ups = find_ups(args);
+  if (!ups) {
     send_error(client, "UNKNOWN-UPS");
     return;
   }
   
-  if (!has_ups_data()) {
+  const NutVariableTable &table = get_variable_table(*ups);
+  if (!table.connected) {
     send_error(client, "DATA-STALE");
     return;
   }
   
-  std::string ups_name = get_ups_name();
-  std::string response = "BEGIN LIST VAR " + ups_name + "\n";
+  send_response(client, table.list_var.data(), table.list_var.size());
+}
+
+void NutServerComponent::handle_get_var(NutClient &client, std::string_view args) {
+  const NutArgs parts = split_nut_args(args);
+  if (parts.size() != 2) {
+    send_error(client, "INVALID-ARGUMENT");
+    return;
+  }
+  
+  NutUps *ups = find_ups(parts[0]);
+  if (!ups) {
+    send_error(client, "UNKNOWN-UPS");
+    return;
+  }
   
-  // Standard NUT variables mapping to actual UPS data
-  std::vector<std::string> variables = {
-    "ups.mfr", "ups.model", "ups.status", "ups.serial", "ups.firmware",
-    "battery.charge", "battery.voltage", "battery.voltage.nominal", "battery.runtime",
-    "input.voltage", "input.voltage.nominal", "input.frequency", 
-    "input.transfer.low", "input.transfer.high",
-    "output.voltage", "output.voltage.nominal", 
-    "ups.load", "ups.realpower.nominal", "ups.power.nominal"
-  };
+  if (parts[1].substr(0, 7) == "server.") {
+    handle_get_server_var(client, *ups, parts[1]);
+    return;
+  }
+  if (parts[1].substr(0, 13) == "driver.stats.") {
+    handle_get_driver_stat(client, *ups, parts[1]);
+    return;
+  }
   
-  for (const auto &var : variables) {
-    std::string value = get_ups_var(var);
-    if (!value.empty()) {
-      response += "VAR " + ups_name + " " + var + " \"" + value + "\"\n";
-    }
+  const int index = find_nut_variable(parts[1]);
+  const NutVariableTable &table = get_variable_table(*ups);
+  if (index < 0 || table.lines[index].length == 0) {
+    send_error(client, "VAR-NOT-SUPPORTED");
+    return;
   }
   
-  response += "END LIST VAR " + ups_name + "\n";
-  send_response(client, response);
+  const NutVariableTable::Slice &line = table.lines[index];
+  send_response(client, table.list_var.data() + line.offset, line.length);
 }
 
-void NutServerComponent::handle_get_var(NutClient &client, const std::string &args) {
-  auto parts = split_args(args);
-  if (parts.size() != 2) {
-    send_error(client, "INVALID-ARGUMENT");
+void NutServerComponent::handle_get_server_var(NutClient &client, const NutUps &ups, std::string_view name) {
+  for (const auto &def : NUT_SERVER_STAT_DEFS) {
+    if (name == def.name) {
+      client.tx.append("VAR ").append(ups.name).append(' ').append(def.name).append(" \"")
+          .append_uint((stats_.*def.counter).load(std::memory_order_relaxed)).append("\"\n");
+      return;
+    }
+  }
+  // Not counters, so outside NUT_SERVER_STAT_DEFS
+  if (name == "server.memory.static" || name == "server.stack.free") {
+    const uint32_t value = name == "server.stack.free" ? get_task_stack_free() : sizeof(*this);
+    client.tx.append("VAR ").append(ups.name).append(' ').append(name).append(" \"").append_uint(value)
+        .append("\"\n");
     return;
   }
   
-  if (parts[0] != get_ups_name()) {
-    send_error(client, "UNKNOWN-UPS");
+  // server.requests.<verb>, server.latency.<verb>.mean and server.latency.<verb>.max (microseconds)
+  static constexpr std::string_view REQUESTS_PREFIX = "server.requests.";
+  static constexpr std::string_view LATENCY_PREFIX = "server.latency.";
+  if (instrumentation_enabled_) {
+    std::string_view verb_name;
+    std::string_view field;  // Empty for server.requests.<verb>
+    if (name.substr(0, REQUESTS_PREFIX.size()) == REQUESTS_PREFIX) {
+      verb_name = name.substr(REQUESTS_PREFIX.size());
+    } else if (name.substr(0, LATENCY_PREFIX.size()) == LATENCY_PREFIX) {
+      const std::string_view rest = name.substr(LATENCY_PREFIX.size());
+      const size_t dot = rest.rfind('.');
+      if (dot != std::string_view::npos && dot + 1 < rest.size()) {
+        verb_name = rest.substr(0, dot);
+        field = rest.substr(dot + 1);
+      }
+    }
+    for (size_t i = 0; i < NUT_VERB_COUNT && !verb_name.empty(); i++) {
+      if (verb_name != NUT_VERB_NAMES[i]) {
+        continue;
+      }
+      const NutVerbStats &verb = verb_stats_[i];
+      uint32_t value;
+      if (field.empty()) {
+        value = verb.requests;
+      } else if (field == "mean") {
+        value = verb.requests > 0 ? static_cast<uint32_t>(verb.total_us / verb.requests) : 0;
+      } else if (field == "max") {
+        value = verb.max_us;
+      } else {
+        break;
+      }
+      client.tx.append("VAR ").append(ups.name).append(' ').append(name).append(" \"").append_uint(value)
+          .append("\"\n");
+      return;
+    }
+  }
+  send_error(client, "VAR-NOT-SUPPORTED");
+}
+
+// driver.stats.*: instrumentation of the UPS behind this NUT name (ups_hid instrumentation)
+void NutServerComponent::handle_get_driver_stat(NutClient &client, const NutUps &ups, std::string_view name) {
+  const ups_hid::UpsHidComponent &hid = *ups.ups_hid;
+  if (!hid.is_instrumentation_enabled()) {
+    send_error(client, "VAR-NOT-SUPPORTED");
     return;
   }
   
-  std::string value = get_ups_var(parts[1]);
-  if (!value.empty()) {
-    std::string response = "VAR " + get_ups_name() + " " + parts[1] + " \"" + value + "\"\n";
-    send_response(client, response);
+  const std::string_view stat = name.substr(13);
+  const ups_hid::PollTimingStats timing = hid.get_poll_timing();
+  const ups_hid::TransferTotals totals = hid.get_transfer_totals();
+  char value[96];
+  if (stat == "polls") {
+    snprintf(value, sizeof(value), "%u", timing.polls);
+  } else if (stat == "poll.last") {
+    snprintf(value, sizeof(value), "%.1f", timing.last_us / 1000.0f);
+  } else if (stat == "poll.max") {
+    snprintf(value, sizeof(value), "%.1f", timing.max_us / 1000.0f);
+  } else if (stat == "poll.mean") {
+    snprintf(value, sizeof(value), "%.1f", timing.polls > 0 ? timing.total_us / 1000.0f / timing.polls : 0.0f);
+  } else if (stat == "lock.wait.max") {
+    snprintf(value, sizeof(value), "%.2f", timing.lock_wait_max_us / 1000.0f);
+  } else if (stat == "lock.wait.mean") {
+    snprintf(value, sizeof(value), "%.2f",
+             timing.lock_waits > 0 ? timing.lock_wait_total_us / 1000.0f / timing.lock_waits : 0.0f);
+  } else if (stat == "wake.max") {
+    snprintf(value, sizeof(value), "%.3f", timing.wake_max_us / 1000.0f);
+  } else if (stat == "wake.mean") {
+    snprintf(value, sizeof(value), "%.3f", timing.wakes > 0 ? timing.wake_total_us / 1000.0f / timing.wakes : 0.0f);
+  } else if (stat == "transfers") {
+    snprintf(value, sizeof(value), "%u", totals.transfers);
+  } else if (stat == "timeouts") {
+    snprintf(value, sizeof(value), "%u", totals.timeouts);
+  } else if (stat == "errors") {
+    snprintf(value, sizeof(value), "%u", totals.errors);
+  } else if (stat == "bytes") {
+    snprintf(value, sizeof(value), "%u", totals.bytes);
+  } else if (stat == "reports") {
+    // Tracked reports as <type>.<id>, the suffixes of driver.stats.report.*
+    ups_hid::ReportTransferStats reports[ups_hid::limits::INSTRUMENTED_REPORTS];
+    const size_t count = hid.get_report_transfer_stats(reports, ups_hid::limits::INSTRUMENTED_REPORTS);
+    client.tx.append("VAR ").append(ups.name).append(' ').append(name).append(" \"");
+    for (size_t i = 0; i < count; i++) {
+      char key[16];
+      snprintf(key, sizeof(key), "%s%s.0x%02X", i > 0 ? " " : "", report_type_name(reports[i].report_type),
+               reports[i].report_id);
+      client.tx.append(key);
+    }
+    client.tx.append("\"\n");
+    return;
+  } else if (stat.substr(0, 7) == "report.") {
+    // report.<input|output|feature>.0x<id>
+    const size_t dot = stat.find('.', 7);
+    const int report_type = dot != std::string_view::npos ? report_type_from_name(stat.substr(7, dot - 7)) : -1;
+    uint8_t report_id = 0;
+    ups_hid::ReportTransferStats report;
+    if (report_type < 0 || !parse_nut_hex_byte(stat.substr(dot + 1), report_id) ||
+        !hid.get_report_transfer_stats(static_cast<uint8_t>(report_type), report_id, report)) {
+      send_error(client, "VAR-NOT-SUPPORTED");
+      return;
+    }
+    snprintf(value, sizeof(value), "transfers=%u timeouts=%u errors=%u p50=%ums p99=%ums max=%uus", report.transfers,
+             report.timeouts, report.errors, report.latency.percentile_ms(0.5f), report.latency.percentile_ms(0.99f),
+             report.latency.max_us);
   } else {
     send_error(client, "VAR-NOT-SUPPORTED");
+    return;
   }
+  client.tx.append("VAR ").append(ups.name).append(' ').append(name).append(" \"").append(value).append("\"\n");
 }
 
-void NutServerComponent::handle_list_cmd(NutClient &client, const std::string &args) {
-  if (args != get_ups_name()) {
+void NutServerComponent::handle_list_cmd(NutClient &client, std::string_view args) {
+  NutUps *ups = find_ups(args);
+  if (!ups) {
     send_error(client, "UNKNOWN-UPS");
     return;
   }
   
-  std::string response = "BEGIN LIST CMD " + get_ups_name() + "\n";
+  NutOutputBuffer &out = client.tx;
+  out.append("BEGIN LIST CMD ").append(ups->name).append('\n');
   
-  auto commands = get_available_commands();
-  for (const auto &cmd : commands) {
-    response += "CMD " + get_ups_name() + " " + cmd + "\n";
+  if (has_ups_data(*ups)) {
+    for (const auto &cmd : NUT_COMMAND_DEFS) {
+      out.append("CMD ").append(ups->name).append(' ').append(cmd.name).append('\n');
+    }
   }
   
-  response += "END LIST CMD " + get_ups_name() + "\n";
-  send_response(client, response);
+  out.append("END LIST CMD ").append(ups->name).append('\n');
 }
 
 void NutServerComponent::handle_list_clients(NutClient &client) {
-  std::string response = "BEGIN LIST CLIENT\n";
+  NutOutputBuffer &out = client.tx;
+  out.append("BEGIN LIST CLIENT\n");
   
   uint32_t now = millis();
-  // Note: clients_mutex_ is already held by the calling context (server loop)
-  
-  for (size_t i = 0; i < clients_.size(); ++i) {
-    const auto &c = clients_[i];
-    if (c.is_active()) {
-      // Format: CLIENT <ip> <connected_time> <status>
-      std::string status = c.is_authenticated() ? "authenticated" : "connected";
-      uint32_t connected_time = (now - c.connect_time) / 1000; // seconds
-      
-      response += "CLIENT " + c.remote_ip + " " + std::to_string(connected_time) + " " + status + "\n";
-    }
+  // Served from the published directory, the same copy other tasks read
+  NutClientInfo clients[NUT_CLIENT_SLOTS];
+  const size_t count = get_clients(clients, NUT_CLIENT_SLOTS);
+  for (size_t i = 0; i < count; ++i) {
+    const NutClientInfo &c = clients[i];
+    // Format: CLIENT <ip> <connected_time> <status>
+    const char *status = c.state == ClientState::AUTHENTICATED ? "authenticated" : "connected";
+    uint32_t connected_time = (now - c.connect_time) / 1000; // seconds
+    
+    out.append("CLIENT ").append(c.remote_ip().c_str()).append(' ').append_uint(connected_time)
+        .append(' ').append(status).append('\n');
   }
   
-  response += "END LIST CLIENT\n";
-  send_response(client, response);
+  out.append("END LIST CLIENT\n");
 }
 
-void NutServerComponent::handle_instcmd(NutClient &client, const std::string &args) {
-  ESP_LOGD(TAG, "INSTCMD received with args: '%s'", args.c_str());
+void NutServerComponent::handle_instcmd(NutClient &client, std::string_view args) {
+  ESP_LOGD(TAG, "INSTCMD received with args: '%.*s'", static_cast<int>(args.size()), args.data());
   
-  auto parts = split_args(args);
+  const NutArgs parts = split_nut_args(args);
   ESP_LOGD(TAG, "INSTCMD parsed into %zu parts", parts.size());
   for (size_t i = 0; i < parts.size(); ++i) {
-    ESP_LOGD(TAG, "  Part %zu: '%s'", i, parts[i].c_str());
+    ESP_LOGD(TAG, "  Part %zu: '%.*s'", i, static_cast<int>(parts[i].size()), parts[i].data());
   }
   
   if (parts.size() != 2) {
@@ -560,28 +1148,28 @@ void NutServerComponent::handle_instcmd(NutClient &client, const std::string &ar
     return;
   }
   
-  ESP_LOGD(TAG, "UPS name comparison: received='%s', expected='%s'", parts[0].c_str(), get_ups_name().c_str());
-  if (parts[0] != get_ups_name()) {
-    ESP_LOGW(TAG, "INSTCMD unknown UPS: '%s'", parts[0].c_str());
+  NutUps *ups = find_ups(parts[0]);
+  if (!ups) {
+    ESP_LOGW(TAG, "INSTCMD unknown UPS: '%.*s'", static_cast<int>(parts[0].size()), parts[0].data());
     send_error(client, "UNKNOWN-UPS");
     return;
   }
   
-  ESP_LOGD(TAG, "Executing command: '%s'", parts[1].c_str());
-  bool cmd_result = execute_command(parts[1]);
-  ESP_LOGD(TAG, "Command execution result: %s", cmd_result ? "SUCCESS" : "FAILED");
-  
-  if (cmd_result) {
+  ESP_LOGD(TAG, "Executing command on %s: '%.*s'", ups->name.c_str(), static_cast<int>(parts[1].size()),
+           parts[1].data());
+  // Like upsd, OK means the command was handed to the driver; the UPS
+  // acknowledges it later, on the acquisition side
+  const char *error = execute_command(*ups, parts[1]);
+  if (error == nullptr) {
     send_response(client, "OK\n");
   } else {
-    ESP_LOGW(TAG, "Command failed or not supported: %s", parts[1].c_str());
-    send_error(client, "CMD-NOT-SUPPORTED");
+    ESP_LOGW(TAG, "Command %.*s not queued: %s", static_cast<int>(parts[1].size()), parts[1].data(), error);
+    send_error(client, error);
   }
 }
 
 void NutServerComponent::handle_version(NutClient &client) {
-  std::string response = "VERSION \"" + std::string(NUT_VERSION) + "\"\n";
-  send_response(client, response);
+  client.tx.append("VERSION \"").append(NUT_VERSION).append("\"\n");
 }
 
 void NutServerComponent::handle_netver(NutClient &client) {
@@ -591,44 +1179,73 @@ void NutServerComponent::handle_netver(NutClient &client) {
 }
 
 void NutServerComponent::handle_help(NutClient &client) {
-  std::string response = "Commands: HELP VERSION NETVER STARTTLS USERNAME PASSWORD LOGIN LOGOUT LIST GET SET INSTCMD FSD UPSDVER\n";
-  send_response(client, response);
+  send_response(client, "Commands: HELP VERSION NETVER STARTTLS USERNAME PASSWORD LOGIN LOGOUT LIST GET SET INSTCMD FSD UPSDVER SUBSCRIBE UNSUBSCRIBE\n");
 }
 
 void NutServerComponent::handle_upsdver(NutClient &client) {
-  std::string response = std::string(UPSD_VERSION) + "\n";
-  send_response(client, response);
+  client.tx.append(UPSD_VERSION).append('\n');
 }
 
 void NutServerComponent::handle_starttls(NutClient &client) {
-  // STARTTLS is not supported (we don't have TLS/SSL)
+#ifdef USE_NUT_SERVER_TLS
+  if (client.tls || client.starttls_pending) {
+    send_error(client, "ALREADY-SSL-MODE");
+    return;
+  }
+  if (!tls_context_.is_ready()) {
+    send_error(client, "FEATURE-NOT-CONFIGURED");
+    return;
+  }
+  // Each session holds mbedTLS record buffers on the heap the USB host shares;
+  // past the budget the client is told TLS is unavailable and may carry on in plaintext
+  const uint32_t free_heap = esp_get_free_heap_size();
+  if (stats_.tls_sessions.load(std::memory_order_relaxed) >= tls_max_sessions_ || free_heap < tls_min_free_heap_) {
+    ESP_LOGW(TAG, "STARTTLS from %s refused: %u sessions open, %u bytes free", client.remote_ip().c_str(),
+             stats_.tls_sessions.load(std::memory_order_relaxed), free_heap);
+    stats_.tls_rejected.fetch_add(1, std::memory_order_relaxed);
+    send_error(client, "FEATURE-NOT-CONFIGURED");
+    return;
+  }
+  client.tx.append("OK STARTTLS\n");
+  client.starttls_pending = true;
+  stats_.tls_sessions.fetch_add(1, std::memory_order_relaxed);  // Released by disconnect_client()
+#else
+  // Built without a tls: block
   send_error(client, "FEATURE-NOT-SUPPORTED");
+#endif
 }
 
-void NutServerComponent::handle_username(NutClient &client, const std::string &args) {
+void NutServerComponent::handle_username(NutClient &client, std::string_view args) {
   if (args.empty()) {
     send_error(client, "INVALID-ARGUMENT");
     return;
   }
   
-  client.temp_username = args;
-  ESP_LOGD(TAG, "Received username: %s", args.c_str());
+  if (!client.temp_username.assign(args)) {
+    send_error(client, "INVALID-ARGUMENT");
+    return;
+  }
+  ESP_LOGD(TAG, "Received username: %s", client.temp_username.c_str());
   send_response(client, "OK\n");
 }
 
-void NutServerComponent::handle_password(NutClient &client, const std::string &args) {
+void NutServerComponent::handle_password(NutClient &client, std::string_view args) {
   if (args.empty()) {
     send_error(client, "INVALID-ARGUMENT");
     return;
   }
   
-  client.temp_password = args;
+  if (!client.temp_password.assign(args)) {
+    send_error(client, "INVALID-ARGUMENT");
+    return;
+  }
   ESP_LOGD(TAG, "Received password (authentication attempt)");
   
   // Attempt authentication with stored credentials
-  if (authenticate(client.temp_username, client.temp_password)) {
+  if (authenticate(client.temp_username.c_str(), client.temp_password.c_str())) {
     client.state = ClientState::AUTHENTICATED;
     client.username = client.temp_username;
+    publish_client(client);
     client.login_attempts = 0;
     ESP_LOGI(TAG, "Client authenticated successfully: %s", client.username.c_str());
     send_response(client, "OK\n");
@@ -644,361 +1261,573 @@ void NutServerComponent::handle_password(NutClient &client, const std::string &a
   
   // Clear temporary credentials
   client.temp_username.clear();
-  client.temp_password.clear();
+  client.temp_password.wipe();
 }
 
-void NutServerComponent::handle_fsd(NutClient &client, const std::string &args) {
+void NutServerComponent::handle_fsd(NutClient &client, std::string_view args) {
   // FSD (Forced Shutdown) - this is a critical command
   // For now, just acknowledge but don't actually shutdown
   ESP_LOGW(TAG, "FSD (Forced Shutdown) command received from client");
   send_response(client, "OK FSD-SET\n");
 }
 
-void NutServerComponent::handle_set_var(NutClient &client, const std::string &args) {
+void NutServerComponent::handle_set_var(NutClient &client, std::string_view args) {
   // SET VAR is not supported in this implementation
   send_error(client, "CMD-NOT-SUPPORTED");
 }
 
-void NutServerComponent::handle_list_rwvar(NutClient &client, const std::string &args) {
-  // No read-write variables supported
-  if (args != get_ups_name()) {
+void NutServerComponent::handle_list_rwvar(NutClient &client, std::string_view args) {
+  NutUps *ups = find_ups(args);
+  if (!ups) {
     send_error(client, "UNKNOWN-UPS");
     return;
   }
   
-  std::string response = "BEGIN LIST RW " + get_ups_name() + "\n";
-  response += "END LIST RW " + get_ups_name() + "\n";
-  send_response(client, response);
+  const NutVariableTable &table = get_variable_table(*ups);
+  NutOutputBuffer &out = client.tx;
+  out.append("BEGIN LIST RW ").append(ups->name).append('\n');
+  for (size_t i = 0; i < NUT_VARIABLE_COUNT; i++) {
+    const NutVariableTable::Slice &line = table.lines[i];
+    if (NUT_VARIABLE_DEFS[i].is_rw() && line.length > 0) {
+      // Same line as LIST VAR with the "VAR" keyword replaced by "RW"
+      out.append("RW").append(table.list_var.data() + line.offset + 3, line.length - 3);
+    }
+  }
+  out.append("END LIST RW ").append(ups->name).append('\n');
 }
 
-void NutServerComponent::handle_list_enum(NutClient &client, const std::string &args) {
-  // No enum variables supported
-  auto parts = split_args(args);
-  if (parts.size() != 2 || parts[0] != get_ups_name()) {
+void NutServerComponent::handle_list_enum(NutClient &client, std::string_view args) {
+  const NutArgs parts = split_nut_args(args);
+  NutUps *ups = parts.size() == 2 ? find_ups(parts[0]) : nullptr;
+  if (!ups) {
     send_error(client, "INVALID-ARGUMENT");
     return;
   }
   
-  std::string response = "BEGIN LIST ENUM " + get_ups_name() + " " + parts[1] + "\n";
-  response += "END LIST ENUM " + get_ups_name() + " " + parts[1] + "\n";
-  send_response(client, response);
+  const int index = find_nut_variable(parts[1]);
+  if (index < 0) {
+    send_error(client, "VAR-NOT-SUPPORTED");
+    return;
+  }
+  
+  const NutVariableDef &def = NUT_VARIABLE_DEFS[index];
+  NutOutputBuffer &out = client.tx;
+  out.append("BEGIN LIST ENUM ").append(ups->name).append(' ').append(def.name).append('\n');
+  for (uint8_t i = 0; i < def.enum_count; i++) {
+    out.append("ENUM ").append(ups->name).append(' ').append(def.name)
+        .append(" \"").append(def.enum_values[i]).append("\"\n");
+  }
+  out.append("END LIST ENUM ").append(ups->name).append(' ').append(def.name).append('\n');
 }
 
-void NutServerComponent::handle_list_range(NutClient &client, const std::string &args) {
-  // No range variables supported
-  auto parts = split_args(args);
-  if (parts.size() != 2 || parts[0] != get_ups_name()) {
+void NutServerComponent::handle_list_range(NutClient &client, std::string_view args) {
+  const NutArgs parts = split_nut_args(args);
+  NutUps *ups = parts.size() == 2 ? find_ups(parts[0]) : nullptr;
+  if (!ups) {
     send_error(client, "INVALID-ARGUMENT");
     return;
   }
   
-  std::string response = "BEGIN LIST RANGE " + get_ups_name() + " " + parts[1] + "\n";
-  response += "END LIST RANGE " + get_ups_name() + " " + parts[1] + "\n";
-  send_response(client, response);
+  const int index = find_nut_variable(parts[1]);
+  if (index < 0) {
+    send_error(client, "VAR-NOT-SUPPORTED");
+    return;
+  }
+  
+  const NutVariableDef &def = NUT_VARIABLE_DEFS[index];
+  NutOutputBuffer &out = client.tx;
+  out.append("BEGIN LIST RANGE ").append(ups->name).append(' ').append(def.name).append('\n');
+  if (def.has_range()) {
+    // Integer ranges only, matching NUT's RANGE semantics
+    out.append("RANGE ").append(ups->name).append(' ').append(def.name)
+        .append(" \"").append_int(static_cast<int32_t>(def.range_min))
+        .append("\" \"").append_int(static_cast<int32_t>(def.range_max)).append("\"\n");
+  }
+  out.append("END LIST RANGE ").append(ups->name).append(' ').append(def.name).append('\n');
 }
 
-void NutServerComponent::handle_legacy_list_vars(NutClient &client, const std::string &ups_name) {
+void NutServerComponent::handle_legacy_list_vars(NutClient &client, std::string_view ups_name) {
   // Legacy format for upsc -l: return simple variable names without quotes
-  if (!has_ups_data()) {
+  NutUps *ups = find_ups(ups_name);
+  if (!ups || !has_ups_data(*ups)) {
     send_error(client, "DATA-STALE");
     return;
   }
   
-  std::string response = "";
+  static constexpr char LEGACY_VAR_LIST[] =
+      "ups.mfr\n"
+      "ups.model\n"
+      "battery.charge\n"
+      "input.voltage\n"
+      "output.voltage\n"
+      "ups.load\n"
+      "battery.runtime\n"
+      "ups.status\n";
+  send_response(client, LEGACY_VAR_LIST, sizeof(LEGACY_VAR_LIST) - 1);
+}
+
+void NutServerComponent::handle_subscribe(NutClient &client, std::string_view args) {
+  // Extension: SUBSCRIBE <ups> [<var> ...], defaults to ups.status.
+  // Changes are pushed as NOTIFY VAR <ups> <var> "<value>" lines, with an
+  // empty value when the variable became unavailable.
+  if (wake_fd_ < 0) {
+    send_error(client, "FEATURE-NOT-SUPPORTED");
+    return;
+  }
+  
+  const NutArgs parts = split_nut_args(args);
+  if (parts.empty() || parts.overflow) {
+    send_error(client, "INVALID-ARGUMENT");
+    return;
+  }
+  NutUps *ups = find_ups(parts[0]);
+  if (!ups) {
+    send_error(client, "UNKNOWN-UPS");
+    return;
+  }
+  const size_t slot = ups - ups_.data();
+  
+  uint32_t mask = 0;
+  if (parts.size() == 1) {
+    mask = 1u << find_nut_variable("ups.status");
+  }
+  for (size_t i = 1; i < parts.size(); i++) {
+    const int index = find_nut_variable(parts[i]);
+    if (index < 0) {
+      send_error(client, "VAR-NOT-SUPPORTED");
+      return;
+    }
+    mask |= 1u << index;
+  }
   
-  // Simple list format for legacy upsc -l support
-  response += "ups.mfr\n";
-  response += "ups.model\n";
-  response += "battery.charge\n";
-  response += "input.voltage\n";
-  response += "output.voltage\n";
-  response += "ups.load\n";
-  response += "battery.runtime\n";
-  response += "ups.status\n";
+  // Changes still owed to the other subscribers go out first; what is left
+  // unnotified afterwards is the baseline, so the first notification is a real change
+  queue_notifications();
   
-  send_response(client, response);
+  client.subscriptions[slot] |= mask;
+  has_subscribers_ = true;
+  ESP_LOGD(TAG, "Client %s subscribed to %s (mask 0x%08X)", client.remote_ip().c_str(), ups->name.c_str(),
+           client.subscriptions[slot]);
+  send_response(client, "OK\n");
+}
+
+void NutServerComponent::handle_unsubscribe(NutClient &client, std::string_view args) {
+  NutUps *ups = find_ups(args);
+  if (!ups) {
+    send_error(client, "UNKNOWN-UPS");
+    return;
+  }
+  client.subscriptions[ups - ups_.data()] = 0;
+  send_response(client, "OK\n");
 }
 
-bool NutServerComponent::send_response(NutClient &client, const std::string &response) {
+void NutServerComponent::on_ups_data_changed(uint32_t changes) {
 #ifdef USE_ESP32
-  int bytes_sent = send(client.socket_fd, response.c_str(), response.length(), 0);
-  if (bytes_sent < 0) {
+  if (!has_subscribers_ || wake_fd_ < 0) {
+    return;
+  }
+  pending_changes_.fetch_or(changes);
+  const uint64_t signal = 1;
+  write(wake_fd_, &signal, sizeof(signal));
+#endif
+}
+
+void NutServerComponent::notify_subscribers() {
+  queue_notifications();
+  for (auto &client : clients_) {
+    if (client.is_active() && !client.tx.empty() && !flush_client(client)) {
+      disconnect_client(client);
+    }
+  }
+}
+
+void NutServerComponent::queue_notifications() {
+  bool any_subscribed = false;
+  for (size_t slot = 0; slot < ups_.size(); slot++) {
+    NutUps &ups = ups_[slot];
+    const NutVariableTable &table = get_variable_table(ups);
+    const uint32_t changed = table.unnotified;
+    const bool went_stale = ups.notified_connected && !table.connected;
+    ups.notified_connected = table.connected;
+    ups.table.unnotified = 0;
+    
+    for (auto &client : clients_) {
+      const uint32_t subscribed = client.subscriptions[slot];
+      if (!client.is_active() || subscribed == 0) {
+        continue;
+      }
+      any_subscribed = true;
+      
+      if (went_stale) {
+        client.tx.append("NOTIFY DATA-STALE ").append(ups.name).append('\n');
+      }
+      const uint32_t pushed = subscribed & changed;
+      for (size_t i = 0; i < NUT_VARIABLE_COUNT; i++) {
+        if (!(pushed & (1u << i))) {
+          continue;
+        }
+        const NutVariableTable::Slice &line = table.lines[i];
+        if (line.length > 0) {
+          client.tx.append("NOTIFY ").append(table.list_var.data() + line.offset, line.length);
+        } else if (table.connected) {
+          // The value became unavailable; DATA-STALE already covers a lost UPS
+          client.tx.append("NOTIFY VAR ").append(ups.name).append(' ')
+              .append(NUT_VARIABLE_DEFS[i].name).append(" \"\"\n");
+        }
+      }
+    }
+  }
+  has_subscribers_ = any_subscribed;
+}
+
+bool NutServerComponent::send_response(NutClient &client, std::string_view response) {
+  return send_response(client, response.data(), response.size());
+}
+
+bool NutServerComponent::send_response(NutClient &client, const char *data, size_t length) {
+  // Queued and sent by handle_client() once every buffered command is processed,
+  // so a pipelined batch costs one send()
+  return !client.tx.append(data, length).overflow();
+}
+
+bool NutServerComponent::flush_client(NutClient &client) {
+#ifdef USE_ESP32
+  if (client.tx.overflow()) {
+    ESP_LOGW(TAG, "Client %s is not reading its replies, disconnecting", client.remote_ip().c_str());
+    return false;
+  }
+#ifdef USE_NUT_SERVER_TLS
+  if (client.tls) {
+    return flush_tls_client(client);
+  }
+#endif
+  while (!client.tx.empty() && client.socket_fd >= 0) {
+    int bytes_sent = send(client.socket_fd, client.tx.pending_data(), client.tx.pending(), MSG_DONTWAIT);
+    if (bytes_sent > 0) {
+      stats_.bytes_sent.fetch_add(bytes_sent, std::memory_order_relaxed);
+      client.tx.consume(bytes_sent);
+      continue;
+    }
+    if (bytes_sent < 0 && (errno == EWOULDBLOCK || errno == EAGAIN)) {
+      // Socket send buffer full; the rest goes out when select() reports it writable
+      break;
+    }
     if (errno == ECONNRESET || errno == EPIPE || errno == ENOTCONN) {
       ESP_LOGD(TAG, "Client connection reset (error %d)", errno);
     } else {
       ESP_LOGW(TAG, "Send error: %d", errno);
     }
+    client.tx.clear();
     return false;
   }
-  return bytes_sent == (int)response.length();
+  return true;
 #else
+  client.tx.clear();
   return false;
 #endif
 }
 
-bool NutServerComponent::send_error(NutClient &client, const std::string &error) {
-  std::string response = "ERR " + error + "\n";
-  return send_response(client, response);
+#ifdef USE_NUT_SERVER_TLS
+bool NutServerComponent::start_tls(NutClient &client) {
+  const uint32_t heap_before = esp_get_free_heap_size();
+  client.tls.reset(new (std::nothrow) NutTlsSession());
+  client.starttls_pending = false;
+  if (!client.tls || !client.tls->setup(tls_context_, &client, tls_send, tls_recv)) {
+    ESP_LOGW(TAG, "Could not start TLS with %s", client.remote_ip().c_str());
+    stats_.tls_failures.fetch_add(1, std::memory_order_relaxed);
+    if (!client.tls) {
+      stats_.tls_sessions.fetch_sub(1, std::memory_order_relaxed);  // disconnect_client() no longer sees it
+    }
+    return false;
+  }
+  client.tls->heap_before = heap_before;
+  // The ClientHello may already sit behind the STARTTLS line
+  client.tls->preload(client.rx_buffer, client.rx_length);
+  client.rx_length = 0;
+  return continue_tls_handshake(client);
 }
 
-bool NutServerComponent::authenticate(const std::string &username, const std::string &password) {
-  if (password_.empty()) {
-    // No authentication required
+bool NutServerComponent::continue_tls_handshake(NutClient &client) {
+  NutTlsSession &tls = *client.tls;
+  const int ret = tls_context_.handshake(tls);
+  tls.want_write = ret == MBEDTLS_ERR_SSL_WANT_WRITE;
+  if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
     return true;
   }
-  return (username == username_ && password == password_);
+  if (ret != 0) {
+    ESP_LOGW(TAG, "TLS handshake with %s failed: -0x%04X", client.remote_ip().c_str(), -ret);
+    stats_.tls_failures.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  
+  // mbedTLS has released the handshake state; what is still allocated stays for the session
+  const uint32_t heap_after = esp_get_free_heap_size();
+  const uint32_t session_heap = tls.heap_before > heap_after ? tls.heap_before - heap_after : 0;
+  tls.established = true;
+  client.last_activity = millis();
+  publish_client(client);
+  stats_.tls_handshakes.fetch_add(1, std::memory_order_relaxed);
+  if (tls.resumed) {
+    stats_.tls_resumed.fetch_add(1, std::memory_order_relaxed);
+  }
+  stats_.tls_handshake_last_us.store(tls.handshake_us, std::memory_order_relaxed);
+  if (tls.handshake_us > stats_.tls_handshake_max_us.load(std::memory_order_relaxed)) {
+    stats_.tls_handshake_max_us.store(tls.handshake_us, std::memory_order_relaxed);
+  }
+  stats_.tls_session_heap_last.store(session_heap, std::memory_order_relaxed);
+  if (session_heap > stats_.tls_session_heap_max.load(std::memory_order_relaxed)) {
+    stats_.tls_session_heap_max.store(session_heap, std::memory_order_relaxed);
+  }
+  ESP_LOGD(TAG, "TLS with %s: %s %s, %s, %u us CPU, %u bytes heap", client.remote_ip().c_str(),
+           mbedtls_ssl_get_version(&tls.ssl), mbedtls_ssl_get_ciphersuite(&tls.ssl),
+           tls.resumed ? "resumed" : "full handshake", tls.handshake_us, session_heap);
+  // Commands may have been sent along with the final handshake flight
+  handle_tls_client(client);
+  return true;
 }
 
-std::string NutServerComponent::get_ups_var(const std::string &var_name) {
-  if (!has_ups_data()) {
-    return "";
+void NutServerComponent::handle_tls_client(NutClient &client) {
+  NutTlsSession &tls = *client.tls;
+  if (!tls.established) {
+    if (!continue_tls_handshake(client)) {
+      disconnect_client(client);
+    }
+    return;
   }
   
-  // Map variable names to data using data provider pattern
-  if (var_name == "ups.mfr") return get_ups_manufacturer();
-  if (var_name == "ups.model") return get_ups_model();
-  
-  if (ups_hid_) {
-    auto ups_data = ups_hid_->get_ups_data();
-    
-    // Device information variables
-    if (var_name == "ups.serial" && !ups_data.device.serial_number.empty()) {
-      return ups_data.device.serial_number;
-    }
-    if (var_name == "ups.firmware" && !ups_data.device.firmware_version.empty()) {
-      return ups_data.device.firmware_version;
-    }
-    
-    // Battery variables
-    if (var_name == "battery.charge") {
-      float battery_level = ups_hid_->get_battery_level();
-      if (battery_level >= 0) return std::to_string(static_cast<int>(battery_level));
-    }
-    if (var_name == "battery.voltage" && !std::isnan(ups_data.battery.voltage)) {
-      return format_nut_value(std::to_string(ups_data.battery.voltage));
-    }
-    if (var_name == "battery.voltage.nominal" && !std::isnan(ups_data.battery.voltage_nominal)) {
-      return format_nut_value(std::to_string(ups_data.battery.voltage_nominal));
-    }
-    if (var_name == "battery.runtime") {
-      float runtime_minutes = ups_hid_->get_runtime_minutes();
-      if (runtime_minutes > 0) return std::to_string(static_cast<int>(runtime_minutes * 60));
-    }
-    
-    // Input power variables
-    if (var_name == "input.voltage") {
-      float input_voltage = ups_hid_->get_input_voltage();
-      if (input_voltage > 0) return format_nut_value(std::to_string(input_voltage));
-    }
-    if (var_name == "input.voltage.nominal" && !std::isnan(ups_data.power.input_voltage_nominal)) {
-      return format_nut_value(std::to_string(ups_data.power.input_voltage_nominal));
-    }
-    if (var_name == "input.frequency" && !std::isnan(ups_data.power.frequency)) {
-      return format_nut_value(std::to_string(ups_data.power.frequency));
-    }
-    if (var_name == "input.transfer.low" && !std::isnan(ups_data.power.input_transfer_low)) {
-      return format_nut_value(std::to_string(ups_data.power.input_transfer_low));
+  // Same draining as handle_client(); mbedTLS may hold decrypted bytes the socket no
+  // longer signals, so keep reading until it has nothing left
+  while (client.is_active() && !client.output_blocked()) {
+    const size_t space = sizeof(client.rx_buffer) - client.rx_length;
+    if (space == 0) {
+      break;
     }
-    if (var_name == "input.transfer.high" && !std::isnan(ups_data.power.input_transfer_high)) {
-      return format_nut_value(std::to_string(ups_data.power.input_transfer_high));
-    }
-    
-    // Output power variables
-    if (var_name == "output.voltage") {
-      float output_voltage = ups_hid_->get_output_voltage();
-      if (output_voltage > 0) return format_nut_value(std::to_string(output_voltage));
-    }
-    if (var_name == "output.voltage.nominal" && !std::isnan(ups_data.power.output_voltage_nominal)) {
-      return format_nut_value(std::to_string(ups_data.power.output_voltage_nominal));
-    }
-    
-    // Load and power variables
-    if (var_name == "ups.load") {
-      float load_percent = ups_hid_->get_load_percent();
-      if (load_percent >= 0) return std::to_string(static_cast<int>(load_percent));
+    int ret = mbedtls_ssl_read(&tls.ssl, reinterpret_cast<unsigned char *>(client.rx_buffer + client.rx_length),
+                               space);
+    if (ret > 0) {
+      client.rx_length += ret;
+      client.last_activity = millis();
+      process_received_lines(client);
+      if (static_cast<size_t>(ret) < space && mbedtls_ssl_get_bytes_avail(&tls.ssl) == 0) {
+        break;
+      }
+      continue;
     }
-    if (var_name == "ups.realpower.nominal" && !std::isnan(ups_data.power.realpower_nominal)) {
-      return std::to_string(static_cast<int>(ups_data.power.realpower_nominal));
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+      break;
     }
-    if (var_name == "ups.power.nominal" && !std::isnan(ups_data.power.apparent_power_nominal)) {
-      return std::to_string(static_cast<int>(ups_data.power.apparent_power_nominal));
+    if (ret == 0 || ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY || ret == MBEDTLS_ERR_SSL_CONN_EOF ||
+        ret == MBEDTLS_ERR_NET_CONN_RESET) {
+      ESP_LOGD(TAG, "TLS client disconnected");
+    } else {
+      ESP_LOGW(TAG, "TLS receive error: -0x%04X", -ret);
     }
+    disconnect_client(client);
+    return;
   }
   
-  if (var_name == "ups.status") {
-    return get_ups_status();
+  if (client.is_active() && !flush_client(client)) {
+    disconnect_client(client);
   }
-  
-  return "";
 }
 
-std::string NutServerComponent::get_ups_name() {
-  // Return a consistent UPS name
-  // This will be set during component configuration
-  return ups_name_.empty() ? "ups" : ups_name_;
+bool NutServerComponent::flush_tls_client(NutClient &client) {
+  NutTlsSession &tls = *client.tls;
+  while (tls.established && !client.tx.empty()) {
+    // After WANT_WRITE mbedTLS must be called again with the same data, which tx still holds
+    int ret = mbedtls_ssl_write(&tls.ssl, reinterpret_cast<const unsigned char *>(client.tx.pending_data()),
+                                client.tx.pending());
+    if (ret > 0) {
+      stats_.bytes_sent.fetch_add(ret, std::memory_order_relaxed);
+      client.tx.consume(ret);
+      continue;
+    }
+    if (ret == MBEDTLS_ERR_SSL_WANT_WRITE || ret == MBEDTLS_ERR_SSL_WANT_READ) {
+      break;
+    }
+    ESP_LOGD(TAG, "TLS send error: -0x%04X", -ret);
+    client.tx.clear();
+    return false;
+  }
+  return true;
+}
+
+int NutServerComponent::tls_send(void *ctx, const unsigned char *buf, size_t len) {
+  auto *client = static_cast<NutClient *>(ctx);
+  int sent = send(client->socket_fd, buf, len, MSG_DONTWAIT);
+  if (sent >= 0) {
+    return sent;
+  }
+  if (errno == EWOULDBLOCK || errno == EAGAIN) {
+    return MBEDTLS_ERR_SSL_WANT_WRITE;
+  }
+  return errno == ECONNRESET || errno == EPIPE ? MBEDTLS_ERR_NET_CONN_RESET : MBEDTLS_ERR_NET_SEND_FAILED;
 }
 
-std::string NutServerComponent::get_ups_description() {
-  if (!has_ups_data()) {
-    return "ESPHome UPS";
+int NutServerComponent::tls_recv(void *ctx, unsigned char *buf, size_t len) {
+  auto *client = static_cast<NutClient *>(ctx);
+  const size_t preloaded = client->tls->read_preloaded(buf, len);
+  if (preloaded > 0) {
+    return preloaded;
   }
-  
-  std::string manufacturer = get_ups_manufacturer();
-  std::string model = get_ups_model();
-  
-  std::string desc = manufacturer;
-  if (!desc.empty() && !model.empty()) {
-    desc += " " + model;
-  } else if (desc.empty()) {
-    desc = "ESPHome UPS";
+  int received = recv(client->socket_fd, buf, len, 0);
+  if (received >= 0) {
+    return received;  // 0 is end of stream
   }
-  return desc;
+  if (errno == EWOULDBLOCK || errno == EAGAIN) {
+    return MBEDTLS_ERR_SSL_WANT_READ;
+  }
+  return errno == ECONNRESET ? MBEDTLS_ERR_NET_CONN_RESET : MBEDTLS_ERR_NET_RECV_FAILED;
 }
+#endif
 
-std::vector<std::string> NutServerComponent::get_available_commands() {
-  std::vector<std::string> commands;
-  
-  if (ups_hid_ && ups_hid_->is_connected()) {
-    // Standard UPS HID commands that are always available
-    commands.push_back("beeper.enable");
-    commands.push_back("beeper.disable"); 
-    commands.push_back("beeper.mute");
-    commands.push_back("beeper.test");
-    commands.push_back("test.battery.start.quick");
-    commands.push_back("test.battery.start.deep");
-    commands.push_back("test.battery.stop");
-    // Standard NUT command names for panel/UPS tests
-    commands.push_back("test.panel.start");
-    commands.push_back("test.panel.stop");
-    // Keep legacy names for compatibility
-    commands.push_back("test.ups.start");
-    commands.push_back("test.ups.stop");
+bool NutServerComponent::send_error(NutClient &client, const char *error) {
+  stats_.errors.fetch_add(1, std::memory_order_relaxed);
+  return !client.tx.append("ERR ").append(error).append('\n').overflow();
+}
+
+bool NutServerComponent::authenticate(std::string_view username, std::string_view password) {
+  if (password_.empty()) {
+    // No authentication required
+    return true;
   }
-  
-  return commands;
+  return username_ == username && password_ == password;
 }
 
-bool NutServerComponent::execute_command(const std::string &command) {
-  if (!ups_hid_) {
-    return false;
+std::string NutServerComponent::get_ups_var(size_t index, const NutUps &ups, const ups_hid::UpsData &ups_data) {
+  const NutVariableDef &def = NUT_VARIABLE_DEFS[index];
+  if (def.format == NutFormat::TEXT) {
+    return def.text(ups_data);
   }
   
-  // Map NUT commands to specific UPS HID methods
-  if (command == "beeper.enable") {
-    return ups_hid_->beeper_enable();
-  } else if (command == "beeper.disable") {
-    return ups_hid_->beeper_disable();
-  } else if (command == "beeper.mute") {
-    return ups_hid_->beeper_mute();
-  } else if (command == "beeper.test") {
-    return ups_hid_->beeper_test();
-  } else if (command == "test.battery.start.quick") {
-    return ups_hid_->start_battery_test_quick();
-  } else if (command == "test.battery.start.deep") {
-    return ups_hid_->start_battery_test_deep();
-  } else if (command == "test.battery.stop") {
-    return ups_hid_->stop_battery_test();
-  } else if (command == "test.panel.start" || command == "test.ups.start") {
-    return ups_hid_->start_ups_test();
-  } else if (command == "test.panel.stop" || command == "test.ups.stop") {
-    return ups_hid_->stop_ups_test();
+  const float value = def.summary != nullptr ? def.summary(*ups.ups_hid) : def.number(ups_data);
+  if (std::isnan(value)) {
+    return "";
   }
-  
-  return false;
+  char formatted[32];
+  if (def.format == NutFormat::INTEGER) {
+    snprintf(formatted, sizeof(formatted), "%d", static_cast<int>(value));
+  } else {
+    snprintf(formatted, sizeof(formatted), "%.1f", value);
+  }
+  return formatted;
 }
 
-std::string NutServerComponent::format_nut_value(const std::string &value) {
-  // Format floating point values to 1 decimal place
-  // Simple approach without exceptions
-  char* endptr;
-  float f = std::strtof(value.c_str(), &endptr);
-  if (endptr != value.c_str() && *endptr == '\0') {
-    // Valid float conversion
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(1) << f;
-    return oss.str();
-  }
-  return value;
-}
-
-std::vector<std::string> NutServerComponent::split_args(const std::string &args) {
-  std::vector<std::string> result;
-  std::istringstream iss(args);
-  std::string token;
-  
-  while (iss >> token) {
-    // Handle quoted strings
-    if (token.front() == '"') {
-      std::string quoted = token.substr(1);
-      if (quoted.back() != '"') {
-        std::string rest;
-        std::getline(iss, rest, '"');
-        quoted += rest;
-      } else {
-        quoted.pop_back();
-      }
-      result.push_back(quoted);
-    } else {
-      result.push_back(token);
+NutUps *NutServerComponent::find_ups(std::string_view name) {
+  for (auto &ups : ups_) {
+    if (ups.name == name) {
+      return &ups;
     }
   }
-  
-  return result;
+  return nullptr;
 }
 
-bool NutServerComponent::has_ups_data() const {
-  return ups_hid_ && ups_hid_->is_connected();
-}
-
-std::string NutServerComponent::get_ups_status() const {
-  if (!ups_hid_ || !ups_hid_->is_connected()) {
-    return "";
+const NutVariableTable &NutServerComponent::get_variable_table(NutUps &ups) {
+  NutVariableTable &table = ups.table;
+  const uint32_t generation = ups.ups_hid->get_snapshot_generation();
+  const bool connected = has_ups_data(ups);
+  if (table.valid && table.generation == generation && table.connected == connected) {
+    return table;
   }
   
-  std::string status;
-  if (ups_hid_->is_online()) {
-    status = "OL";  // Online
-  } else if (ups_hid_->is_on_battery()) {
-    status = "OB";  // On Battery
+  auto snapshot = get_ups_snapshot(ups);
+  const std::string &ups_name = ups.name;
+  
+  std::string &next = table.render_buffer;
+  NutVariableTable::Slice next_lines[NUT_VARIABLE_COUNT];
+  next.clear();
+  next.reserve(MAX_RESPONSE_LENGTH);
+  next.append("BEGIN LIST VAR ").append(ups_name).append("\n");
+  for (size_t i = 0; i < NUT_VARIABLE_COUNT; i++) {
+    next_lines[i] = {};
+    if (!connected) {
+      continue;
+    }
+    std::string value = get_ups_var(i, ups, *snapshot);
+    if (value.empty()) {
+      continue;
+    }
+    const size_t offset = next.size();
+    next.append("VAR ").append(ups_name).append(" ").append(NUT_VARIABLE_DEFS[i].name)
+        .append(" \"").append(value).append("\"\n");
+    next_lines[i].offset = static_cast<uint16_t>(offset);
+    next_lines[i].length = static_cast<uint16_t>(next.size() - offset);
   }
-  
-  if (ups_hid_->is_low_battery()) {
-    if (!status.empty()) status += " ";
-    status += "LB";  // Low Battery
+  next.append("END LIST VAR ").append(ups_name).append("\n");
+  
+  // LIST UPS line, rendered with the same snapshot
+  table.list_ups.clear();
+  table.list_ups.append("UPS ").append(ups_name).append(" \"");
+  append_ups_description(ups, *snapshot, table.list_ups);
+  table.list_ups.append("\"\n");
+  
+  // Remember which lines changed for subscribers
+  for (size_t i = 0; i < NUT_VARIABLE_COUNT; i++) {
+    const NutVariableTable::Slice &before = table.lines[i];
+    const NutVariableTable::Slice &after = next_lines[i];
+    if (before.length != after.length ||
+        memcmp(table.list_var.data() + before.offset, next.data() + after.offset, after.length) != 0) {
+      table.unnotified |= 1u << i;
+    }
+    table.lines[i] = after;
   }
+  table.list_var.swap(next);
   
-  if (ups_hid_->is_charging()) {
-    if (!status.empty()) status += " ";
-    status += "CHRG";  // Charging
+  table.generation = generation;
+  table.connected = connected;
+  table.valid = true;
+  ESP_LOGV(TAG, "Rendered variable table for generation %u (%zu bytes)", generation, table.list_var.size());
+  return table;
+}
+
+void NutServerComponent::append_ups_description(const NutUps &ups, const ups_hid::UpsData &data, std::string &out) {
+  if (!has_ups_data(ups)) {
+    out.append("ESPHome UPS");
+    return;
   }
   
-  if (ups_hid_->has_fault()) {
-    if (!status.empty()) status += " ";
-    status += "ALARM";  // Alarm condition
+  const std::string manufacturer = get_ups_manufacturer(data);
+  if (manufacturer.empty()) {
+    out.append("ESPHome UPS");
+    return;
+  }
+  out.append(manufacturer);
+  const std::string model = get_ups_model(data);
+  if (!model.empty()) {
+    out.append(" ").append(model);
   }
-  
-  return status;
 }
 
-std::string NutServerComponent::get_ups_manufacturer() const {
-  if (ups_hid_) {
-    auto ups_data = ups_hid_->get_ups_data();
-    if (!ups_data.device.manufacturer.empty()) {
-      return ups_data.device.manufacturer;
-    }
+const char *NutServerComponent::execute_command(NutUps &ups, std::string_view command) {
+  const NutCommandDef *def = find_nut_command(command);
+  if (!def) {
+    return "CMD-NOT-SUPPORTED";
+  }
+  if (!ups.ups_hid->submit_command(def->command)) {
+    return "INSTCMD-FAILED";
   }
-  return "Unknown";
+  return nullptr;
 }
 
-std::string NutServerComponent::get_ups_model() const {
-  if (ups_hid_) {
-    auto ups_data = ups_hid_->get_ups_data();
-    if (!ups_data.device.model.empty()) {
-      return ups_data.device.model;
-    }
+bool NutServerComponent::has_ups_data(const NutUps &ups) const {
+  return ups.ups_hid && ups.ups_hid->is_connected();
+}
+
+ups_hid::UpsDataSnapshot NutServerComponent::get_ups_snapshot(const NutUps &ups) const {
+  if (ups.ups_hid) {
+    return ups.ups_hid->get_ups_snapshot();
   }
-  return "Unknown UPS";
+  static const ups_hid::UpsDataSnapshot empty = std::make_shared<const ups_hid::UpsData>();
+  return empty;
+}
+
+std::string NutServerComponent::get_ups_manufacturer(const ups_hid::UpsData &data) const {
+  return nut_ups_manufacturer(data);
+}
+
+std::string NutServerComponent::get_ups_model(const ups_hid::UpsData &data) const {
+  return nut_ups_model(data);
 }
 
 }  // namespace nut_server
-}  // namespace esphome
\ No newline at end of file
+}  // namespace esphome
@@ -2,11 +2,21 @@
 
 #include "esphome/core/component.h"
 #include "esphome/core/log.h"
+#include "../ups_hid/data_composite.h"
+#include "../ups_hid/task_config.h"
+#include "../ups_hid/memory_usage.h"
+#include "nut_output_buffer.h"
+#include "nut_fixed_string.h"
+#include "nut_tls.h"
+#include <array>
+#include <cstdio>
 #include <memory>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <mutex>
 #include <optional>
+#include <atomic>
 
 #ifdef USE_ESP32
 #include "lwip/sockets.h"
@@ -29,15 +39,68 @@ static const char *const TAG = "nut_server";
 // NUT protocol constants
 static constexpr uint16_t DEFAULT_NUT_PORT = 3493;
 static constexpr size_t MAX_COMMAND_LENGTH = 256;
-static constexpr size_t MAX_RESPONSE_LENGTH = 2048;
-static constexpr uint8_t DEFAULT_MAX_CLIENTS = 4;
+static constexpr size_t MAX_RESPONSE_LENGTH = 2048;  // Largest single reply (LIST VAR)
+static constexpr uint8_t MAX_CLIENTS_LIMIT = 10;  // Each client holds an lwIP socket of the shared pool
+static constexpr size_t MAX_CREDENTIAL_LENGTH = 63;  // USERNAME / PASSWORD / LOGIN arguments
+
+// Client slots compiled into the server; codegen sets this to max_clients
+#ifndef NUT_SERVER_MAX_CLIENTS
+#define NUT_SERVER_MAX_CLIENTS 4
+#endif
+static constexpr uint8_t NUT_CLIENT_SLOTS = NUT_SERVER_MAX_CLIENTS;
+static_assert(NUT_CLIENT_SLOTS >= 1 && NUT_CLIENT_SLOTS <= MAX_CLIENTS_LIMIT, "max_clients is 1-10");
 static constexpr uint8_t MAX_LOGIN_ATTEMPTS = 3;
 static constexpr uint32_t CLIENT_TIMEOUT_MS = 60000;  // 60 seconds
+static constexpr uint32_t SELECT_ERROR_BACKOFF_MS = 100;  // Avoid spinning if select() keeps failing
+static constexpr uint32_t SERVER_STOP_TIMEOUT_MS = 500;   // Warn if the server task takes longer to stop
+static constexpr uint32_t SERVER_IDLE_WAKE_MS = 1000;    // Longest select() wait without an eventfd
+static constexpr uint32_t SERVER_TASK_STACK_SIZE = 4096;
+static constexpr uint32_t SERVER_TASK_STACK_SIZE_TLS = 10240;  // mbedTLS handshakes run on the server task
+static constexpr uint8_t SERVER_TASK_PRIORITY = 1;
+#ifdef USE_NUT_SERVER_TLS
+static constexpr uint32_t DEFAULT_SERVER_TASK_STACK_SIZE = SERVER_TASK_STACK_SIZE_TLS;
+#else
+static constexpr uint32_t DEFAULT_SERVER_TASK_STACK_SIZE = SERVER_TASK_STACK_SIZE;
+#endif
 
 // NUT protocol version
 static constexpr const char* NUT_VERSION = "2.8.0";
 static constexpr const char* UPSD_VERSION = "upsd 2.8.0 ESPHome";
 
+// UpsHidComponents one server can export
+static constexpr size_t MAX_NUT_UPS = 4;
+
+// Variables served by LIST VAR / GET VAR
+static constexpr size_t NUT_VARIABLE_COUNT = 23;
+
+// LIST VAR reply rendered once per UPS snapshot; GET VAR serves slices of it
+struct NutVariableTable {
+  struct Slice {
+    uint16_t offset{0};
+    uint16_t length{0};  // 0 when the variable has no value
+  };
+  
+  uint32_t generation{0};
+  bool connected{false};
+  bool valid{false};
+  std::string list_var;                 // Complete "BEGIN LIST VAR" ... "END LIST VAR" reply
+  Slice lines[NUT_VARIABLE_COUNT];      // "VAR <ups> <name> \"<value>\"\n" lines within list_var
+  uint32_t unnotified{0};               // Variables whose line changed since subscribers were told
+  std::string render_buffer;            // Next list_var, swapped in after the diff
+  std::string list_ups;                 // "UPS <ups> \"<description>\"\n" line of LIST UPS
+};
+static_assert(NUT_VARIABLE_COUNT <= 32, "subscription masks hold one bit per variable");
+
+// One UpsHidComponent exported under its NUT name
+struct NutUps {
+  std::string name;
+  ups_hid::UpsHidComponent *ups_hid{nullptr};
+  
+  // Only touched from the server task
+  NutVariableTable table;
+  bool notified_connected{false};
+};
+
 // Client states
 enum class ClientState {
   CONNECTED,
@@ -45,33 +108,181 @@ enum class ClientState {
   DISCONNECTED
 };
 
-// NUT client connection
+using NutCredential = NutFixedString<MAX_CREDENTIAL_LENGTH>;
+using NutAddressText = NutFixedString<15>;  // Dotted-quad IPv4
+
+// addr in network byte order
+inline NutAddressText format_ipv4(uint32_t addr) {
+  const auto *octets = reinterpret_cast<const uint8_t *>(&addr);
+  char text[NutAddressText::MAX_LENGTH + 1];
+  int length = snprintf(text, sizeof(text), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+  NutAddressText result;
+  result.assign(text, static_cast<size_t>(length));
+  return result;
+}
+
+// NUT client connection; one slot of a fixed table, so connection churn never
+// touches the heap (the optional TLS session aside)
 struct NutClient {
   int socket_fd{-1};
   ClientState state{ClientState::DISCONNECTED};
   uint8_t login_attempts{0};
   uint32_t last_activity{0};
   uint32_t connect_time{0};
-  std::string username;
-  std::string remote_ip;
-  std::string temp_username;  // For USERNAME/PASSWORD flow
-  std::string temp_password;  // For USERNAME/PASSWORD flow
+  uint32_t subscriptions[MAX_NUT_UPS]{};  // Per UPS, bit per NUT_VARIABLE_DEFS entry pushed to this client
+  uint32_t remote_addr{0};        // IPv4, network byte order
+  NutCredential username;
+  NutCredential temp_username;  // For USERNAME/PASSWORD flow
+  NutCredential temp_password;  // For USERNAME/PASSWORD flow
+  
+  // Bytes received but not yet terminated by a newline
+  char rx_buffer[MAX_COMMAND_LENGTH];
+  size_t rx_length{0};
+  bool rx_discarding{false};  // Dropping the rest of an overlong line
+  
+  // Replies not yet accepted by the socket
+  NutOutputBuffer tx;
   
+  // STARTTLS accepted: no further plaintext is parsed, the TLS handshake
+  // starts once "OK STARTTLS" is on the wire
+  bool starttls_pending{false};
+#ifdef USE_NUT_SERVER_TLS
+  std::unique_ptr<NutTlsSession> tls;
+#endif
+  
+  // Formatted on demand, for logs and LIST CLIENT
+  NutAddressText remote_ip() const { return format_ipv4(remote_addr); }
   bool is_authenticated() const { return state == ClientState::AUTHENTICATED; }
   bool is_active() const { return socket_fd >= 0 && state != ClientState::DISCONNECTED; }
+  // Stop reading commands until the socket drains enough for another full reply
+  bool output_blocked() const { return tx.available() < MAX_RESPONSE_LENGTH; }
+  bool wants_write() const {
+#ifdef USE_NUT_SERVER_TLS
+    if (tls && tls->want_write) {
+      return true;
+    }
+#endif
+    return !tx.empty();
+  }
   void reset() {
     socket_fd = -1;
     state = ClientState::DISCONNECTED;
     login_attempts = 0;
     last_activity = 0;
     connect_time = 0;
+    for (auto &mask : subscriptions) {
+      mask = 0;
+    }
+    remote_addr = 0;
     username.clear();
-    remote_ip.clear();
     temp_username.clear();
-    temp_password.clear();
+    temp_password.wipe();
+    rx_length = 0;
+    rx_discarding = false;
+    tx.clear();
+    starttls_pending = false;
+#ifdef USE_NUT_SERVER_TLS
+    tls.reset();
+#endif
   }
 };
 
+#ifdef USE_NUT_SERVER_TLS
+static_assert(TLS_PRELOAD_CAPACITY >= MAX_COMMAND_LENGTH, "a TLS session takes over the whole receive buffer");
+#endif
+
+// What tasks other than the server task may know about a connected client
+struct NutClientInfo {
+  uint32_t remote_addr{0};  // IPv4, network byte order
+  uint32_t connect_time{0};
+  ClientState state{ClientState::DISCONNECTED};
+  bool tls{false};
+  
+  NutAddressText remote_ip() const { return format_ipv4(remote_addr); }
+};
+
+/**
+ * Client slots as last published by the server task
+ *
+ * NutClient is owned by the server task and never locked. The task publishes
+ * a summary of a slot whenever it connects, logs in, finishes STARTTLS or
+ * disconnects; LIST CLIENT and readers on other tasks copy it out without a
+ * lock. Each slot is a seqlock: a copy torn by a concurrent publish is
+ * detected by its sequence number and retried.
+ */
+class NutClientDirectory {
+ public:
+  // Server task only
+  void publish(size_t slot, const NutClientInfo &info);
+  // False if the slot is free
+  bool read(size_t slot, NutClientInfo &info) const;
+  
+ private:
+  struct Slot {
+    std::atomic<uint32_t> sequence{0};  // Odd while a publish is in progress
+    std::atomic<uint32_t> remote_addr{0};
+    std::atomic<uint32_t> connect_time{0};
+    std::atomic<uint32_t> flags{static_cast<uint32_t>(ClientState::DISCONNECTED)};  // ClientState, plus SLOT_TLS
+  };
+  static constexpr uint32_t SLOT_STATE_MASK = 0x03;
+  static constexpr uint32_t SLOT_TLS = 0x04;
+  
+  Slot slots_[NUT_CLIENT_SLOTS];
+};
+
+// Server-wide counters, written by the server task and served as
+// GET VAR <ups> server.<name> (see NUT_SERVER_STAT_DEFS)
+struct NutServerStats {
+  std::atomic<uint32_t> connections_accepted{0};
+  std::atomic<uint32_t> connections_rejected{0};  // Answered with ERR MAX-CLIENTS
+  std::atomic<uint32_t> clients_peak{0};
+  std::atomic<uint32_t> clients_max{0};
+  std::atomic<uint32_t> commands{0};
+  std::atomic<uint32_t> errors{0};  // ERR replies
+  std::atomic<uint32_t> bytes_sent{0};
+  // STARTTLS; handshake CPU time in us, session heap in bytes
+  std::atomic<uint32_t> tls_sessions{0};  // Currently open
+  std::atomic<uint32_t> tls_handshakes{0};
+  std::atomic<uint32_t> tls_resumed{0};   // Handshakes that reused a cached session or ticket
+  std::atomic<uint32_t> tls_failures{0};
+  std::atomic<uint32_t> tls_rejected{0};  // Refused by max_sessions or min_free_heap
+  std::atomic<uint32_t> tls_handshake_last_us{0};
+  std::atomic<uint32_t> tls_handshake_max_us{0};
+  std::atomic<uint32_t> tls_session_heap_last{0};
+  std::atomic<uint32_t> tls_session_heap_max{0};
+  // Heap held by the server beyond its own object, refreshed by the server task
+  std::atomic<uint32_t> memory_dynamic{0};
+  std::atomic<uint32_t> memory_peak{0};
+};
+
+// Command verbs counted by the instrumentation, in NUT_VERB_DEFS order
+enum class NutVerb : uint8_t {
+  LIST = 0,
+  GET,
+  SET,
+  INSTCMD,
+  LOGIN,
+  LOGOUT,
+  USERNAME,
+  PASSWORD,
+  SUBSCRIBE,
+  UNSUBSCRIBE,
+  VER,
+  NETVER,
+  HELP,
+  UPSDVER,
+  STARTTLS,
+  FSD,
+  OTHER,  // Unknown commands and legacy "<ups>" listings
+};
+static constexpr size_t NUT_VERB_COUNT = static_cast<size_t>(NutVerb::OTHER) + 1;
+
+struct NutVerbStats {
+  uint32_t requests{0};
+  uint32_t max_us{0};
+  uint64_t total_us{0};
+};
+
 // NUT Server Component
 class NutServerComponent : public Component {
 public:
@@ -80,19 +291,42 @@ public:
 
   // ESPHome component lifecycle
   void setup() override;
-  void loop() override;
   void dump_config() override;
   float get_setup_priority() const override { return setup_priority::AFTER_CONNECTION; }
 
   // Configuration setters
-  void set_ups_hid(ups_hid::UpsHidComponent *ups_hid) { ups_hid_ = ups_hid; }
+  // Export a UPS under a NUT name; up to MAX_NUT_UPS
+  void add_ups(ups_hid::UpsHidComponent *ups_hid, const std::string &name);
   void set_port(uint16_t port) { port_ = port; }
   void set_username(const std::string &username) { username_ = username; }
   void set_password(const std::string &password) { password_ = password; }
-  void set_max_clients(uint8_t max_clients) { 
-    max_clients_ = std::min(max_clients, static_cast<uint8_t>(10)); 
+  // Capped at the NUT_CLIENT_SLOTS compiled in
+  void set_max_clients(uint8_t max_clients) { max_clients_ = std::min(max_clients, NUT_CLIENT_SLOTS); }
+  void set_instrumentation(bool enabled) { instrumentation_enabled_ = enabled; }
+  // Core (-1 for none), priority and stack of the server task
+  void set_task_config(int8_t core, uint8_t priority, uint32_t stack_size) {
+    task_config_ = {"nut_server", stack_size, priority, core};
+  }
+  
+  // Copies the connected clients, in slot order; safe from any task
+  size_t get_clients(NutClientInfo *clients, size_t max_count) const;
+  // Object (client table included) and heap footprint; safe from any task
+  ups_hid::MemoryUsage get_memory_usage() const {
+    return {sizeof(*this), stats_.memory_dynamic.load(std::memory_order_relaxed),
+            stats_.memory_peak.load(std::memory_order_relaxed)};
   }
-  void set_ups_name(const std::string &ups_name) { ups_name_ = ups_name; }
+  // Least stack the server task has had left, in bytes; 0 while it is not running
+  uint32_t get_task_stack_free() const;
+#ifdef USE_NUT_SERVER_TLS
+  void set_tls_certificate(const std::string &certificate) { tls_certificate_ = certificate; }
+  void set_tls_private_key(const std::string &private_key) { tls_private_key_ = private_key; }
+  void set_tls_session_cache(uint8_t size, uint32_t timeout_s) {
+    tls_cache_size_ = size;
+    tls_session_timeout_s_ = timeout_s;
+  }
+  void set_tls_max_sessions(uint8_t max_sessions) { tls_max_sessions_ = max_sessions; }
+  void set_tls_min_free_heap(uint32_t bytes) { tls_min_free_heap_ = bytes; }
+#endif
 
 protected:
   // TCP server management
@@ -100,77 +334,132 @@ protected:
   void stop_server();
   void accept_clients();
   void handle_client(NutClient &client);
+  void resume_client(NutClient &client);  // Socket writable again
+  void process_received_lines(NutClient &client);
+  bool flush_client(NutClient &client);
   void disconnect_client(NutClient &client);
   void cleanup_inactive_clients();
+  void publish_client(const NutClient &client);
+#ifdef USE_NUT_SERVER_TLS
+  bool start_tls(NutClient &client);
+  bool continue_tls_handshake(NutClient &client);
+  void handle_tls_client(NutClient &client);
+  bool flush_tls_client(NutClient &client);
+  // mbedTLS BIO callbacks, ctx is the NutClient
+  static int tls_send(void *ctx, const unsigned char *buf, size_t len);
+  static int tls_recv(void *ctx, unsigned char *buf, size_t len);
+#endif
   
   // NUT protocol handlers
-  void process_command(NutClient &client, const std::string &command);
-  void handle_login(NutClient &client, const std::string &args);
+  void process_command(NutClient &client, std::string_view command);
+  void dispatch_command(NutClient &client, std::string_view cmd, std::string_view args);
+  void handle_login(NutClient &client, std::string_view args);
   void handle_list_ups(NutClient &client);
-  void handle_list_var(NutClient &client, const std::string &args);
-  void handle_get_var(NutClient &client, const std::string &args);
-  void handle_list_cmd(NutClient &client, const std::string &args);
+  void handle_list_var(NutClient &client, std::string_view args);
+  void handle_get_var(NutClient &client, std::string_view args);
+  void handle_get_server_var(NutClient &client, const NutUps &ups, std::string_view name);
+  void update_memory_usage();  // Server task
+  void handle_get_driver_stat(NutClient &client, const NutUps &ups, std::string_view name);
+  void handle_list_cmd(NutClient &client, std::string_view args);
   void handle_list_clients(NutClient &client);
-  void handle_instcmd(NutClient &client, const std::string &args);
+  void handle_instcmd(NutClient &client, std::string_view args);
   void handle_version(NutClient &client);
   void handle_netver(NutClient &client);
   void handle_help(NutClient &client);
   void handle_upsdver(NutClient &client);
   void handle_logout(NutClient &client);
   void handle_starttls(NutClient &client);
-  void handle_username(NutClient &client, const std::string &args);
-  void handle_password(NutClient &client, const std::string &args);
-  void handle_fsd(NutClient &client, const std::string &args);
-  void handle_set_var(NutClient &client, const std::string &args);
-  void handle_list_rwvar(NutClient &client, const std::string &args);
-  void handle_list_enum(NutClient &client, const std::string &args);
-  void handle_list_range(NutClient &client, const std::string &args);
-  void handle_legacy_list_vars(NutClient &client, const std::string &ups_name);
+  void handle_username(NutClient &client, std::string_view args);
+  void handle_password(NutClient &client, std::string_view args);
+  void handle_fsd(NutClient &client, std::string_view args);
+  void handle_set_var(NutClient &client, std::string_view args);
+  void handle_list_rwvar(NutClient &client, std::string_view args);
+  void handle_list_enum(NutClient &client, std::string_view args);
+  void handle_list_range(NutClient &client, std::string_view args);
+  void handle_legacy_list_vars(NutClient &client, std::string_view ups_name);
+  void handle_subscribe(NutClient &client, std::string_view args);
+  void handle_unsubscribe(NutClient &client, std::string_view args);
+  
+  // Change notifications
+  void on_ups_data_changed(uint32_t changes);  // Polling context
+  void notify_subscribers();                   // Server task
+  // Appends NOTIFY lines for every unnotified change to the subscribers' tx
+  // buffers and clears the changes; flushed by the caller or the select loop
+  void queue_notifications();                  // Server task
   
   // Helper methods
-  bool send_response(NutClient &client, const std::string &response);
-  bool send_error(NutClient &client, const std::string &error);
-  bool authenticate(const std::string &username, const std::string &password);
-  std::string get_ups_var(const std::string &var_name);
-  std::string get_ups_description();
-  std::string get_ups_name();  // Dynamic UPS name from component
-  std::vector<std::string> get_available_commands();
-  bool execute_command(const std::string &command);
-  std::string format_nut_value(const std::string &value);
-  std::vector<std::string> split_args(const std::string &args);
+  bool send_response(NutClient &client, std::string_view response);
+  bool send_response(NutClient &client, const char *data, size_t length);
+  bool send_error(NutClient &client, const char *error);
+  bool authenticate(std::string_view username, std::string_view password);
+  // index into NUT_VARIABLE_DEFS
+  std::string get_ups_var(size_t index, const NutUps &ups, const ups_hid::UpsData &data);
+  const NutVariableTable &get_variable_table(NutUps &ups);
+  NutUps *find_ups(std::string_view name);
+  void append_ups_description(const NutUps &ups, const ups_hid::UpsData &data, std::string &out);
+  // Queues the command on the UPS; nullptr once queued, otherwise the NUT error
+  const char *execute_command(NutUps &ups, std::string_view command);
   
   // Data access using provider pattern (like status LED component)
-  bool has_ups_data() const;
-  std::string get_ups_status() const;
-  std::string get_ups_manufacturer() const;
-  std::string get_ups_model() const;
+  // Handlers take one snapshot per request and pass it down, so multi-line
+  // responses are consistent and never block on the USB poller
+  bool has_ups_data(const NutUps &ups) const;
+  ups_hid::UpsDataSnapshot get_ups_snapshot(const NutUps &ups) const;
+  std::string get_ups_manufacturer(const ups_hid::UpsData &data) const;
+  std::string get_ups_model(const ups_hid::UpsData &data) const;
 
 private:
   // Server task management
   static void server_task(void *param);
+#ifdef USE_ESP32
+  int wait_for_activity(fd_set &read_fds, fd_set &write_fds);
   TaskHandle_t server_task_handle_{nullptr};
-  bool server_running_{false};
+#endif
+  ups_hid::TaskConfig task_config_{"nut_server", DEFAULT_SERVER_TASK_STACK_SIZE, SERVER_TASK_PRIORITY};
+  std::atomic<bool> server_running_{false};
+  std::atomic<bool> server_task_exited_{false};
   
   // Network resources
   int server_socket_{-1};
+  int wake_fd_{-1};  // eventfd, wakes select() when subscribed data changed
   uint16_t port_{DEFAULT_NUT_PORT};
   
   // Client management
-  std::vector<NutClient> clients_;
-  uint8_t max_clients_{DEFAULT_MAX_CLIENTS};
-  mutable std::mutex clients_mutex_;
+  // Owned by the server task; only the first max_clients_ slots are handed out
+  std::array<NutClient, NUT_CLIENT_SLOTS> clients_;
+  uint8_t max_clients_{NUT_CLIENT_SLOTS};
+  NutClientDirectory client_directory_;  // Published copy for LIST CLIENT and other tasks
+  NutServerStats stats_;
+  bool instrumentation_enabled_{false};
+  // Written by the server task under the mutex, read unlocked by it and locked by dump_config()
+  mutable std::mutex verb_stats_mutex_;
+  NutVerbStats verb_stats_[NUT_VERB_COUNT];
+  
+#ifdef USE_NUT_SERVER_TLS
+  // PEM strings are released once parsed into tls_context_
+  NutTlsContext tls_context_;
+  std::string tls_certificate_;
+  std::string tls_private_key_;
+  uint8_t tls_cache_size_{DEFAULT_TLS_SESSION_CACHE_SIZE};
+  uint32_t tls_session_timeout_s_{DEFAULT_TLS_SESSION_TIMEOUT_S};
+  uint8_t tls_max_sessions_{DEFAULT_TLS_MAX_SESSIONS};
+  uint32_t tls_min_free_heap_{DEFAULT_TLS_MIN_FREE_HEAP};
+#endif
   
   // Authentication
   std::string username_{"nutuser"};
   std::string password_{"nutpass"};
   
-  // UPS configuration
-  std::string ups_name_{"ups"};
-  ups_hid::UpsHidComponent *ups_hid_{nullptr};
+  // Exported UPSes, in LIST UPS order; never resized after setup
+  std::vector<NutUps> ups_;
   
   // Server state
   mutable std::mutex server_mutex_;
   bool shutdown_requested_{false};
+  
+  // Set by the polling context, consumed by the server task
+  std::atomic<uint32_t> pending_changes_{0};
+  std::atomic<bool> has_subscribers_{false};
 };
 
 }  // namespace nut_server
@@ -0,0 +1,181 @@
+#include "nut_tls.h"
+
+#ifdef USE_NUT_SERVER_TLS
+
+#include "esphome/core/log.h"
+#include "esphome/core/hal.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef MBEDTLS_ERROR_C
+#include "mbedtls/error.h"
+#endif
+
+namespace esphome {
+namespace nut_server {
+
+static const char *const TLS_TAG = "nut_server.tls";
+
+static bool log_tls_error(const char *step, int ret) {
+#ifdef MBEDTLS_ERROR_C
+  char message[96];
+  mbedtls_strerror(ret, message, sizeof(message));
+  ESP_LOGE(TLS_TAG, "%s failed: -0x%04X %s", step, -ret, message);
+#else
+  ESP_LOGE(TLS_TAG, "%s failed: -0x%04X", step, -ret);
+#endif
+  return false;
+}
+
+NutTlsContext::NutTlsContext() {
+  mbedtls_entropy_init(&entropy_);
+  mbedtls_ctr_drbg_init(&ctr_drbg_);
+  mbedtls_x509_crt_init(&certificate_);
+  mbedtls_pk_init(&private_key_);
+  mbedtls_ssl_config_init(&config_);
+#ifdef MBEDTLS_SSL_CACHE_C
+  mbedtls_ssl_cache_init(&cache_);
+#endif
+#ifdef MBEDTLS_SSL_TICKET_C
+  mbedtls_ssl_ticket_init(&ticket_);
+#endif
+}
+
+NutTlsContext::~NutTlsContext() {
+#ifdef MBEDTLS_SSL_TICKET_C
+  mbedtls_ssl_ticket_free(&ticket_);
+#endif
+#ifdef MBEDTLS_SSL_CACHE_C
+  mbedtls_ssl_cache_free(&cache_);
+#endif
+  mbedtls_ssl_config_free(&config_);
+  mbedtls_pk_free(&private_key_);
+  mbedtls_x509_crt_free(&certificate_);
+  mbedtls_ctr_drbg_free(&ctr_drbg_);
+  mbedtls_entropy_free(&entropy_);
+}
+
+bool NutTlsContext::setup(const std::string &certificate, const std::string &private_key, uint8_t cache_size,
+                          uint32_t session_timeout_s) {
+  static const char PERSONALIZATION[] = "nut_server";
+  int ret = mbedtls_ctr_drbg_seed(&ctr_drbg_, mbedtls_entropy_func, &entropy_,
+                                  reinterpret_cast<const unsigned char *>(PERSONALIZATION),
+                                  sizeof(PERSONALIZATION) - 1);
+  if (ret != 0) {
+    return log_tls_error("Seeding the RNG", ret);
+  }
+
+  // The PEM parsers expect the terminating NUL to be part of the length
+  ret = mbedtls_x509_crt_parse(&certificate_, reinterpret_cast<const unsigned char *>(certificate.c_str()),
+                               certificate.size() + 1);
+  if (ret != 0) {
+    return log_tls_error("Parsing the certificate", ret);
+  }
+  ret = mbedtls_pk_parse_key(&private_key_, reinterpret_cast<const unsigned char *>(private_key.c_str()),
+                             private_key.size() + 1, nullptr, 0, mbedtls_ctr_drbg_random, &ctr_drbg_);
+  if (ret != 0) {
+    return log_tls_error("Parsing the private key", ret);
+  }
+
+  ret = mbedtls_ssl_config_defaults(&config_, MBEDTLS_SSL_IS_SERVER, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                    MBEDTLS_SSL_PRESET_DEFAULT);
+  if (ret != 0) {
+    return log_tls_error("Configuring TLS", ret);
+  }
+  mbedtls_ssl_conf_rng(&config_, mbedtls_ctr_drbg_random, &ctr_drbg_);
+  ret = mbedtls_ssl_conf_own_cert(&config_, &certificate_, &private_key_);
+  if (ret != 0) {
+    return log_tls_error("Loading the certificate", ret);
+  }
+
+#ifdef MBEDTLS_SSL_CACHE_C
+  if (cache_size > 0) {
+    mbedtls_ssl_cache_set_max_entries(&cache_, cache_size);
+    mbedtls_ssl_cache_set_timeout(&cache_, session_timeout_s);
+    mbedtls_ssl_conf_session_cache(&config_, this, cache_get, cache_set);
+  }
+#endif
+#ifdef MBEDTLS_SSL_TICKET_C
+  ret = mbedtls_ssl_ticket_setup(&ticket_, mbedtls_ctr_drbg_random, &ctr_drbg_, MBEDTLS_CIPHER_AES_256_GCM,
+                                 session_timeout_s);
+  if (ret != 0) {
+    return log_tls_error("Setting up session tickets", ret);
+  }
+  mbedtls_ssl_conf_session_tickets_cb(&config_, ticket_write, ticket_parse, this);
+#endif
+
+  ready_ = true;
+  return true;
+}
+
+int NutTlsContext::handshake(NutTlsSession &session) {
+  handshaking_ = &session;
+  const uint32_t started = micros();
+  const int ret = mbedtls_ssl_handshake(&session.ssl);
+  session.handshake_us += micros() - started;
+  handshaking_ = nullptr;
+  return ret;
+}
+
+#ifdef MBEDTLS_SSL_CACHE_C
+int NutTlsContext::cache_get(void *data, unsigned char const *session_id, size_t session_id_len,
+                             mbedtls_ssl_session *session) {
+  auto *context = static_cast<NutTlsContext *>(data);
+  const int ret = mbedtls_ssl_cache_get(&context->cache_, session_id, session_id_len, session);
+  if (ret == 0 && context->handshaking_ != nullptr) {
+    context->handshaking_->resumed = true;
+  }
+  return ret;
+}
+
+int NutTlsContext::cache_set(void *data, unsigned char const *session_id, size_t session_id_len,
+                             const mbedtls_ssl_session *session) {
+  auto *context = static_cast<NutTlsContext *>(data);
+  return mbedtls_ssl_cache_set(&context->cache_, session_id, session_id_len, session);
+}
+#endif
+
+#ifdef MBEDTLS_SSL_TICKET_C
+int NutTlsContext::ticket_write(void *data, const mbedtls_ssl_session *session, unsigned char *start,
+                                const unsigned char *end, size_t *length, uint32_t *lifetime) {
+  auto *context = static_cast<NutTlsContext *>(data);
+  return mbedtls_ssl_ticket_write(&context->ticket_, session, start, end, length, lifetime);
+}
+
+int NutTlsContext::ticket_parse(void *data, mbedtls_ssl_session *session, unsigned char *buf, size_t length) {
+  auto *context = static_cast<NutTlsContext *>(data);
+  const int ret = mbedtls_ssl_ticket_parse(&context->ticket_, session, buf, length);
+  if (ret == 0 && context->handshaking_ != nullptr) {
+    context->handshaking_->resumed = true;
+  }
+  return ret;
+}
+#endif
+
+bool NutTlsSession::setup(const NutTlsContext &context, void *bio, mbedtls_ssl_send_t *send,
+                          mbedtls_ssl_recv_t *recv) {
+  const int ret = mbedtls_ssl_setup(&ssl, context.config());
+  if (ret != 0) {
+    return log_tls_error("Creating the TLS session", ret);
+  }
+  mbedtls_ssl_set_bio(&ssl, bio, send, recv, nullptr);
+  return true;
+}
+
+void NutTlsSession::preload(const char *data, size_t length) {
+  preloaded_length_ = std::min(length, sizeof(preloaded_));
+  preloaded_offset_ = 0;
+  memcpy(preloaded_, data, preloaded_length_);
+}
+
+size_t NutTlsSession::read_preloaded(unsigned char *buf, size_t length) {
+  const size_t count = std::min(length, preloaded_length_ - preloaded_offset_);
+  memcpy(buf, preloaded_ + preloaded_offset_, count);
+  preloaded_offset_ += count;
+  return count;
+}
+
+}  // namespace nut_server
+}  // namespace esphome
+
+#endif  // USE_NUT_SERVER_TLS
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+
+#ifdef USE_NUT_SERVER_TLS
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "mbedtls/version.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/x509_crt.h"
+#include "mbedtls/pk.h"
+#ifdef MBEDTLS_SSL_CACHE_C
+#include "mbedtls/ssl_cache.h"
+#endif
+#ifdef MBEDTLS_SSL_TICKET_C
+#include "mbedtls/ssl_ticket.h"
+#endif
+
+#if MBEDTLS_VERSION_NUMBER < 0x03000000
+#error "nut_server STARTTLS needs mbedTLS 3.x (ESP-IDF 5 or newer)"
+#endif
+
+namespace esphome {
+namespace nut_server {
+
+static constexpr uint8_t DEFAULT_TLS_SESSION_CACHE_SIZE = 4;
+static constexpr uint32_t DEFAULT_TLS_SESSION_TIMEOUT_S = 3600;
+static constexpr uint8_t DEFAULT_TLS_MAX_SESSIONS = 2;
+static constexpr uint32_t DEFAULT_TLS_MIN_FREE_HEAP = 32768;
+// Leftover plaintext a session can take over; the size of the client receive buffer
+static constexpr size_t TLS_PRELOAD_CAPACITY = 256;
+
+class NutTlsSession;
+
+/**
+ * Server-wide TLS state shared by every STARTTLS connection
+ *
+ * Holds the certificate, key, RNG and mbedTLS configuration, plus the two
+ * ways a returning client skips the full handshake: a session-ID cache of
+ * cache_size entries (TLS 1.2) and stateless session tickets (TLS 1.2 and
+ * 1.3). Either is only used when the mbedTLS build includes it.
+ *
+ * Only touched from the server task.
+ */
+class NutTlsContext {
+ public:
+  NutTlsContext();
+  ~NutTlsContext();
+  NutTlsContext(const NutTlsContext &) = delete;
+  NutTlsContext &operator=(const NutTlsContext &) = delete;
+
+  // PEM strings; false (with the mbedTLS error logged) if any step fails
+  bool setup(const std::string &certificate, const std::string &private_key, uint8_t cache_size,
+             uint32_t session_timeout_s);
+  bool is_ready() const { return ready_; }
+  const mbedtls_ssl_config *config() const { return &config_; }
+
+  // Advances the handshake of one session, crediting a resumption to it
+  int handshake(NutTlsSession &session);
+
+ protected:
+  // Wrap the mbedTLS cache and ticket callbacks to see which handshakes resume
+#ifdef MBEDTLS_SSL_CACHE_C
+  static int cache_get(void *data, unsigned char const *session_id, size_t session_id_len,
+                       mbedtls_ssl_session *session);
+  static int cache_set(void *data, unsigned char const *session_id, size_t session_id_len,
+                       const mbedtls_ssl_session *session);
+#endif
+#ifdef MBEDTLS_SSL_TICKET_C
+  static int ticket_write(void *data, const mbedtls_ssl_session *session, unsigned char *start,
+                          const unsigned char *end, size_t *length, uint32_t *lifetime);
+  static int ticket_parse(void *data, mbedtls_ssl_session *session, unsigned char *buf, size_t length);
+#endif
+
+  mbedtls_entropy_context entropy_;
+  mbedtls_ctr_drbg_context ctr_drbg_;
+  mbedtls_x509_crt certificate_;
+  mbedtls_pk_context private_key_;
+  mbedtls_ssl_config config_;
+#ifdef MBEDTLS_SSL_CACHE_C
+  mbedtls_ssl_cache_context cache_;
+#endif
+#ifdef MBEDTLS_SSL_TICKET_C
+  mbedtls_ssl_ticket_context ticket_;
+#endif
+  NutTlsSession *handshaking_{nullptr};  // Session inside handshake(), for the callbacks
+  bool ready_{false};
+};
+
+/**
+ * TLS state of one client connection after STARTTLS
+ *
+ * The socket I/O is supplied by the server through setup(). Bytes the
+ * client sent right behind the STARTTLS line were already read as plaintext;
+ * they are handed over with preload() and fed to mbedTLS before the socket.
+ */
+class NutTlsSession {
+ public:
+  NutTlsSession() { mbedtls_ssl_init(&ssl); }
+  ~NutTlsSession() { mbedtls_ssl_free(&ssl); }
+  NutTlsSession(const NutTlsSession &) = delete;
+  NutTlsSession &operator=(const NutTlsSession &) = delete;
+
+  bool setup(const NutTlsContext &context, void *bio, mbedtls_ssl_send_t *send, mbedtls_ssl_recv_t *recv);
+  void preload(const char *data, size_t length);
+  // Serves preloaded bytes; 0 once they are used up
+  size_t read_preloaded(unsigned char *buf, size_t length);
+
+  mbedtls_ssl_context ssl;
+  bool established{false};
+  bool resumed{false};
+  bool want_write{false};      // Handshake waits for the socket to become writable
+  uint32_t handshake_us{0};    // CPU time spent in mbedtls_ssl_handshake()
+  uint32_t heap_before{0};     // Free heap just before the session was created
+
+ protected:
+  unsigned char preloaded_[TLS_PRELOAD_CAPACITY];
+  size_t preloaded_length_{0};
+  size_t preloaded_offset_{0};
+};
+
+}  // namespace nut_server
+}  // namespace esphome
+
+#endif  // USE_NUT_SERVER_TLS
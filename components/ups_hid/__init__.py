@@ -1,12 +1,20 @@
 """UPS HID Component for ESPHome - Enhanced validation and configuration."""
 
+import logging
+import struct
+
 import esphome.codegen as cg
 import esphome.config_validation as cv
+from esphome.components import web_server_base
+from esphome.components.web_server_base import CONF_WEB_SERVER_BASE_ID
+from esphome.core import CORE
 from esphome.const import (
     CONF_ID,
     CONF_UPDATE_INTERVAL,
 )
 
+_LOGGER = logging.getLogger(__name__)
+
 DEPENDENCIES = ["esp32"]
 MULTI_CONF = True
 
@@ -16,7 +24,48 @@ CONF_USB_PRODUCT_ID = "usb_product_id"
 CONF_PROTOCOL_TIMEOUT = "protocol_timeout"
 CONF_PROTOCOL = "protocol"
 CONF_FALLBACK_NOMINAL_VOLTAGE = "fallback_nominal_voltage"
+CONF_ACQUISITION_TASK = "acquisition_task"
+CONF_INTERRUPT_STREAMING = "interrupt_streaming"
+CONF_IDLE_UPDATE_INTERVAL = "idle_update_interval"
+CONF_CRITICAL_UPDATE_INTERVAL = "critical_update_interval"
+CONF_REPORT_CACHE_TTL = "report_cache_ttl"
+CONF_REPORT_CACHE_OVERRIDES = "report_cache_overrides"
+CONF_HISTORY_SIZE = "history_size"
+CONF_HISTORY_WINDOW = "history_window"
+CONF_DISCOVERY_CACHE = "discovery_cache"
+CONF_RECONNECT_WINDOW = "reconnect_window"
+CONF_INSTRUMENTATION = "instrumentation"
+CONF_DEBUG_LEVEL = "debug_level"
+CONF_SIMULATION = "simulation"
+CONF_VENDOR = "vendor"
+CONF_SEED = "seed"
+CONF_LATENCY = "latency"
+CONF_LATENCY_JITTER = "latency_jitter"
+CONF_STALL_RATE = "stall_rate"
+CONF_TIMEOUT_RATE = "timeout_rate"
+CONF_UNRESPONSIVE_REPORTS = "unresponsive_reports"
+CONF_OUTAGE_INTERVAL = "outage_interval"
+CONF_OUTAGE_DURATION = "outage_duration"
+CONF_TRACE = "trace"
+CONF_TRACE_PERIOD = "trace_period"
+CONF_TRACE_SPEED = "trace_speed"
+CONF_REPLAY_FILE = "replay_file"
+CONF_CAPTURE = "capture"
+CONF_BUFFER_SIZE = "buffer_size"
+CONF_PATH = "path"
+CONF_AT = "at"
+CONF_DATA = "data"
+CONF_REPORT_ID = "report_id"
+CONF_REPORT_TYPE = "report_type"
+CONF_TTL = "ttl"
 CONF_UPS_HID_ID = "ups_hid_id"
+CONF_TASKS = "tasks"
+CONF_USB_HOST = "usb_host"
+CONF_USB_CLIENT = "usb_client"
+CONF_ACQUISITION = "acquisition"
+CONF_CORE = "core"
+CONF_PRIORITY = "priority"
+CONF_STACK_SIZE = "stack_size"
 
 # Known UPS vendor IDs for validation
 KNOWN_VENDOR_IDS = {
@@ -36,12 +85,205 @@ KNOWN_VENDOR_IDS = {
     0x09D6: "KSTAR",
 }
 
+# Log ceilings of debug_level; lower levels compile debug and verbose logging
+# of the component out, including hex dumps and the strings built for them
+DEBUG_LEVELS = {
+    "info": "ESPHOME_LOG_LEVEL_INFO",
+    "debug": "ESPHOME_LOG_LEVEL_DEBUG",
+    "verbose": "ESPHOME_LOG_LEVEL_VERBOSE",
+}
+
+# HID report types (HID 1.11, GET_REPORT wValue high byte)
+HID_REPORT_TYPES = {
+    "input": 0x01,
+    "output": 0x02,
+    "feature": 0x03,
+}
+
+REPORT_CACHE_OVERRIDE_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_REPORT_ID): cv.hex_uint8_t,
+        cv.Optional(CONF_REPORT_TYPE, default="feature"): cv.one_of(*HID_REPORT_TYPES, lower=True),
+        cv.Required(CONF_TTL): cv.positive_time_period_milliseconds,
+    }
+)
+
 ups_hid_ns = cg.esphome_ns.namespace("ups_hid")
 UpsHidComponent = ups_hid_ns.class_("UpsHidComponent", cg.PollingComponent)
+SimulationVendor = ups_hid_ns.enum("SimulationVendor", is_class=True)
+
+SIMULATION_VENDORS = {
+    "apc": SimulationVendor.APC,
+    "cyberpower": SimulationVendor.CYBERPOWER,
+    "eaton": SimulationVendor.EATON,
+}
+
+
+def validate_report_bytes(value):
+    """Parse a report as hex bytes, e.g. "0C 64 8C 0A", report ID first."""
+    value = cv.string_strict(value)
+    digits = value.replace(" ", "").replace(":", "")
+    if not digits or len(digits) % 2 != 0:
+        raise cv.Invalid("Report data must be an even number of hex digits")
+    try:
+        data = list(bytes.fromhex(digits))
+    except ValueError as err:
+        raise cv.Invalid(f"Invalid report data: {err}") from err
+    if len(data) > 64:
+        raise cv.Invalid("Report data must be at most 64 bytes")
+    return data
+
+
+SIMULATION_TRACE_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_AT): cv.positive_time_period_milliseconds,
+        cv.Required(CONF_REPORT_ID): cv.hex_uint8_t,
+        # "any" serves the frame whichever report type the protocol asks for
+        cv.Optional(CONF_REPORT_TYPE, default="any"): cv.one_of("any", *HID_REPORT_TYPES, lower=True),
+        cv.Required(CONF_DATA): validate_report_bytes,
+    }
+)
+
+
+def validate_simulation_trace(config):
+    """Replay needs the frames in time order."""
+    trace = config[CONF_TRACE]
+    if any(a[CONF_AT] > b[CONF_AT] for a, b in zip(trace, trace[1:])):
+        raise cv.Invalid("Simulation trace frames must be in time order")
+    if trace and CONF_REPLAY_FILE in config:
+        raise cv.Invalid(f"Use either {CONF_TRACE} or {CONF_REPLAY_FILE}, not both")
+    return config
+
+
+# Report trace format written by ReportTrace::snapshot() (transport_tracing.h)
+TRACE_MAGIC = b"UHTR"
+TRACE_VERSION = 1
+TRACE_HEADER = struct.Struct("<4sBBHHHIIB3x")
+TRACE_RECORD = struct.Struct("<IBBBBB")
+TRACE_FLAG_DROPPED = 0x01
+TRACE_GET_REPORT = 1
+TRACE_INPUT_REPORT = 3
+TRACE_STRING = 4
+TRACE_STATUS_OK = 0
+
+
+def load_report_trace(path):
+    """Parse a downloaded capture into what the simulated transport replays.
+
+    Answered GET_REPORTs and interrupt reports become trace frames, timed
+    from the first record; a frame repeating the previous one of its report
+    is dropped, since a frame applies until the next one anyway.
+    """
+    with open(CORE.relative_config_path(path), "rb") as file:
+        blob = file.read()
+    if len(blob) < TRACE_HEADER.size:
+        raise cv.Invalid(f"{path} is too short for a report trace")
+    (magic, version, flags, vendor_id, product_id, descriptor_length, _captured_ms, dropped,
+     serial_index) = TRACE_HEADER.unpack_from(blob)
+    if magic != TRACE_MAGIC:
+        raise cv.Invalid(f"{path} is not a ups_hid report trace")
+    if version != TRACE_VERSION:
+        raise cv.Invalid(f"{path} has trace format version {version}, expected {TRACE_VERSION}")
+    offset = TRACE_HEADER.size + descriptor_length
+    if offset > len(blob):
+        raise cv.Invalid(f"{path} is truncated in the report descriptor")
+
+    trace = {
+        "vendor_id": vendor_id,
+        "product_id": product_id,
+        "serial_index": serial_index,
+        "descriptor": list(blob[TRACE_HEADER.size:offset]),
+        "strings": {},
+        "frames": [],
+        "dropped": dropped if flags & TRACE_FLAG_DROPPED else 0,
+    }
+    start_ms = None
+    latest = {}
+    while offset < len(blob):
+        if offset + TRACE_RECORD.size > len(blob):
+            raise cv.Invalid(f"{path} is truncated at byte {offset}")
+        at_ms, kind, report_type, report_id, status, length = TRACE_RECORD.unpack_from(blob, offset)
+        offset += TRACE_RECORD.size
+        data = blob[offset:offset + length]
+        if len(data) != length:
+            raise cv.Invalid(f"{path} is truncated at byte {offset}")
+        offset += length
+
+        if start_ms is None:
+            start_ms = at_ms
+        if status != TRACE_STATUS_OK:
+            continue
+        if kind == TRACE_STRING:
+            trace["strings"][report_type] = data.decode("utf-8", errors="replace")
+        elif kind in (TRACE_GET_REPORT, TRACE_INPUT_REPORT) and data:
+            if kind == TRACE_INPUT_REPORT:
+                report_type = HID_REPORT_TYPES["input"]
+            if latest.get((report_type, report_id)) == data:
+                continue
+            latest[(report_type, report_id)] = data
+            trace["frames"].append(((at_ms - start_ms) & 0xFFFFFFFF, report_type, report_id, list(data)))
+    return trace
+
+
+def validate_replay_file(value):
+    """A capture downloaded from capture: path, checked by parsing it."""
+    value = cv.file_(value)
+    load_report_trace(value)
+    return value
+
+
+SIMULATION_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.Optional(CONF_VENDOR, default="apc"): cv.one_of(*SIMULATION_VENDORS, lower=True),
+            cv.Optional(CONF_SEED, default=1): cv.uint32_t,
+            cv.Optional(CONF_LATENCY, default="0ms"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_LATENCY_JITTER, default="0ms"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_STALL_RATE, default=0): cv.percentage,
+            cv.Optional(CONF_TIMEOUT_RATE, default=0): cv.percentage,
+            cv.Optional(CONF_UNRESPONSIVE_REPORTS, default=[]): cv.ensure_list(cv.hex_uint8_t),
+            # Mains lost for outage_duration at the start of every outage_interval (0s disables)
+            cv.Optional(CONF_OUTAGE_INTERVAL, default="5min"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_OUTAGE_DURATION, default="30s"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_TRACE, default=[]): cv.ensure_list(SIMULATION_TRACE_SCHEMA),
+            # Replay the trace in a loop of this length (0s plays it once)
+            cv.Optional(CONF_TRACE_PERIOD, default="0s"): cv.positive_time_period_milliseconds,
+            # Trace time per real time; above 1 replays faster than captured
+            cv.Optional(CONF_TRACE_SPEED, default=1.0): cv.float_range(min=0.01, max=1000.0),
+            # Capture downloaded from a device with capture: enabled; replaces
+            # the emulated device with the captured one
+            cv.Optional(CONF_REPLAY_FILE): validate_replay_file,
+        }
+    ),
+    validate_simulation_trace,
+)
+
+
+def validate_capture_path(value):
+    value = cv.string_strict(value)
+    if not value.startswith("/"):
+        raise cv.Invalid("Capture download path must start with /")
+    return value
+
+
+CAPTURE_SCHEMA = cv.Schema(
+    {
+        # Downloads are served by the web_server (or any component running web_server_base)
+        cv.GenerateID(CONF_WEB_SERVER_BASE_ID): cv.use_id(web_server_base.WebServerBase),
+        # Ring of raw report exchanges, in PSRAM when the board has it
+        cv.Optional(CONF_BUFFER_SIZE, default=65536): cv.int_range(min=4096, max=4 * 1024 * 1024),
+        # Default: /ups_hid/<id>/trace.bin
+        cv.Optional(CONF_PATH): validate_capture_path,
+    }
+)
 
 
 def validate_usb_config(config):
-    """Validate USB configuration. Manual IDs are now troubleshooting fallbacks only."""
+    """Validate USB configuration.
+
+    Manual IDs override protocol auto-detection, and select which device an
+    instance binds when several UPSes share the USB host.
+    """
     vendor_id = config.get(CONF_USB_VENDOR_ID)
     product_id = config.get(CONF_USB_PRODUCT_ID)
 
@@ -66,6 +308,30 @@ def validate_usb_config(config):
     return config
 
 
+def validate_poll_rates(config):
+    """Order the adaptive poll intervals around update_interval.
+
+    update_interval is the active rate (on battery, charging, tests). The idle
+    rate defaults to 60s but never polls faster than update_interval, and the
+    countdown rate defaults to 2s but never polls slower.
+    """
+    active = config[CONF_UPDATE_INTERVAL]
+
+    if CONF_IDLE_UPDATE_INTERVAL not in config:
+        idle = cv.positive_time_period_milliseconds("60s")
+        config[CONF_IDLE_UPDATE_INTERVAL] = max(idle, active, key=lambda t: t.total_milliseconds)
+    elif config[CONF_IDLE_UPDATE_INTERVAL].total_milliseconds < active.total_milliseconds:
+        raise cv.Invalid(f"{CONF_IDLE_UPDATE_INTERVAL} must not be shorter than {CONF_UPDATE_INTERVAL}")
+
+    if CONF_CRITICAL_UPDATE_INTERVAL not in config:
+        critical = cv.positive_time_period_milliseconds("2s")
+        config[CONF_CRITICAL_UPDATE_INTERVAL] = min(critical, active, key=lambda t: t.total_milliseconds)
+    elif config[CONF_CRITICAL_UPDATE_INTERVAL].total_milliseconds > active.total_milliseconds:
+        raise cv.Invalid(f"{CONF_CRITICAL_UPDATE_INTERVAL} must not be longer than {CONF_UPDATE_INTERVAL}")
+
+    return config
+
+
 def validate_protocol_timeout(value):
     """Validate protocol timeout with reasonable bounds."""
     value = cv.positive_time_period_milliseconds(value)
@@ -109,11 +375,35 @@ def validate_fallback_nominal_voltage(value):
     return value
 
 
+def task_schema(priority, stack_size):
+    """Placement of one FreeRTOS task; defaults match usb_tasks/acquisition in constants_ups.h."""
+    return cv.Schema(
+        {
+            # Pin to a core (default: no affinity); on single-core chips this is ignored
+            cv.Optional(CONF_CORE): cv.int_range(min=0, max=1),
+            cv.Optional(CONF_PRIORITY, default=priority): cv.int_range(min=1, max=22),
+            cv.Optional(CONF_STACK_SIZE, default=stack_size): cv.int_range(min=2048, max=32768),
+        }
+    )
+
+
+TASKS_SCHEMA = cv.Schema(
+    {
+        # Shared USB Host Library task; the first ups_hid instance to start creates it
+        cv.Optional(CONF_USB_HOST, default={}): task_schema(2, 4096),
+        cv.Optional(CONF_USB_CLIENT, default={}): task_schema(3, 6144),
+        cv.Optional(CONF_ACQUISITION, default={}): task_schema(2, 8192),
+    }
+)
+
+
 CONFIG_SCHEMA = cv.All(
     cv.Schema(
         {
             cv.GenerateID(): cv.declare_id(UpsHidComponent),
             cv.Optional(CONF_SIMULATION_MODE, default=False): cv.boolean,
+            # Emulated device, latencies and faults used when simulation_mode is on
+            cv.Optional(CONF_SIMULATION): SIMULATION_SCHEMA,
             # Manual USB IDs are now primarily for troubleshooting when auto-detection fails
             cv.Optional(CONF_USB_VENDOR_ID): cv.hex_uint16_t,
             cv.Optional(CONF_USB_PRODUCT_ID): cv.hex_uint16_t,
@@ -126,10 +416,38 @@ CONFIG_SCHEMA = cv.All(
             ),
             # Fallback nominal voltage (European 230V default for international compatibility)
             cv.Optional(CONF_FALLBACK_NOMINAL_VOLTAGE, default="230V"): validate_fallback_nominal_voltage,
+            # Run USB reads in a dedicated FreeRTOS task instead of the main loop
+            # (defaults to on when several ups_hid instances are configured)
+            cv.Optional(CONF_ACQUISITION_TASK): cv.boolean,
+            cv.Optional(CONF_INTERRUPT_STREAMING, default=False): cv.boolean,
+            # Core, priority and stack of the USB and acquisition tasks
+            cv.Optional(CONF_TASKS, default={}): TASKS_SCHEMA,
+            # Adaptive polling: update_interval applies while on battery, charging or testing
+            cv.Optional(CONF_IDLE_UPDATE_INTERVAL): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_CRITICAL_UPDATE_INTERVAL): cv.positive_time_period_milliseconds,
+            # Serve repeated GET_REPORT reads within one cycle from memory (0s disables)
+            cv.Optional(CONF_REPORT_CACHE_TTL, default="1s"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_REPORT_CACHE_OVERRIDES, default=[]): cv.ensure_list(REPORT_CACHE_OVERRIDE_SCHEMA),
+            # Ring buffer of per-poll samples (18 bytes each, 0 disables) and the
+            # window of the summaries exported to NUT
+            cv.Optional(CONF_HISTORY_SIZE, default=0): cv.int_range(min=0, max=4096),
+            cv.Optional(CONF_HISTORY_WINDOW, default="10min"): cv.positive_time_period_milliseconds,
+            # Persist the detected protocol and report map in NVS to skip probing on reconnect
+            cv.Optional(CONF_DISCOVERY_CACHE, default=True): cv.boolean,
+            # Keep the protocol when the same unit reappears on USB within this long (0s disables)
+            cv.Optional(CONF_RECONNECT_WINDOW, default="5min"): cv.positive_time_period_milliseconds,
+            # Transfer counters, per-report latency histograms and poll timing
+            # (also enabled by any diagnostic sensor)
+            cv.Optional(CONF_INSTRUMENTATION, default=False): cv.boolean,
+            # Record raw report exchanges for download and offline replay
+            cv.Optional(CONF_CAPTURE): CAPTURE_SCHEMA,
+            # Cap the component's logging below the logger level (default: logger level)
+            cv.Optional(CONF_DEBUG_LEVEL): cv.one_of(*DEBUG_LEVELS, lower=True),
         }
     ).extend(cv.polling_component_schema("30s"))
      .extend(cv.COMPONENT_SCHEMA),
     validate_usb_config,
+    validate_poll_rates,
 )
 
 
@@ -138,6 +456,37 @@ async def to_code(config):
     await cg.register_component(var, config)
 
     cg.add(var.set_simulation_mode(config[CONF_SIMULATION_MODE]))
+    if simulation := config.get(CONF_SIMULATION):
+        cg.add(var.set_simulation_vendor(SIMULATION_VENDORS[simulation[CONF_VENDOR]]))
+        cg.add(var.set_simulation_seed(simulation[CONF_SEED]))
+        cg.add(var.set_simulation_latency(simulation[CONF_LATENCY], simulation[CONF_LATENCY_JITTER]))
+        cg.add(var.set_simulation_fault_rates(simulation[CONF_STALL_RATE], simulation[CONF_TIMEOUT_RATE]))
+        for report_id in simulation[CONF_UNRESPONSIVE_REPORTS]:
+            cg.add(var.add_simulation_unresponsive_report(report_id))
+        cg.add(var.set_simulation_outage(simulation[CONF_OUTAGE_INTERVAL], simulation[CONF_OUTAGE_DURATION]))
+        for frame in simulation[CONF_TRACE]:
+            report_type = HID_REPORT_TYPES.get(frame[CONF_REPORT_TYPE], 0)
+            cg.add(
+                var.add_simulation_trace_frame(
+                    frame[CONF_AT], report_type, frame[CONF_REPORT_ID], frame[CONF_DATA]
+                )
+            )
+        if replay_file := simulation.get(CONF_REPLAY_FILE):
+            trace = load_report_trace(replay_file)
+            if trace["dropped"]:
+                _LOGGER.warning(
+                    "%s lost its oldest %d records to the capture ring; detection traffic may be missing",
+                    replay_file, trace["dropped"],
+                )
+            cg.add(var.set_simulation_replay(trace["vendor_id"], trace["product_id"], trace["serial_index"]))
+            for index, value in trace["strings"].items():
+                cg.add(var.add_simulation_string(index, value))
+            if trace["descriptor"]:
+                cg.add(var.set_simulation_report_descriptor(trace["descriptor"]))
+            for at_ms, report_type, report_id, data in trace["frames"]:
+                cg.add(var.add_simulation_trace_frame(at_ms, report_type, report_id, data))
+        cg.add(var.set_simulation_trace_period(simulation[CONF_TRACE_PERIOD]))
+        cg.add(var.set_simulation_trace_speed(simulation[CONF_TRACE_SPEED]))
     
     # USB IDs are now optional - only set if provided for troubleshooting
     if CONF_USB_VENDOR_ID in config:
@@ -148,3 +497,47 @@ async def to_code(config):
     cg.add(var.set_protocol_timeout(config[CONF_PROTOCOL_TIMEOUT]))
     cg.add(var.set_protocol_selection(config[CONF_PROTOCOL]))
     cg.add(var.set_fallback_nominal_voltage(config[CONF_FALLBACK_NOMINAL_VOLTAGE]))
+    # With several UPSes each polls on its own task, so one slow device does
+    # not hold up the others
+    acquisition_task = config.get(CONF_ACQUISITION_TASK)
+    if acquisition_task is None:
+        acquisition_task = len(CORE.config.get("ups_hid", [])) > 1
+    cg.add(var.set_acquisition_task(acquisition_task))
+    tasks = config[CONF_TASKS]
+    for key, setter in (
+        (CONF_USB_HOST, var.set_usb_host_task_config),
+        (CONF_USB_CLIENT, var.set_usb_client_task_config),
+        (CONF_ACQUISITION, var.set_acquisition_task_config),
+    ):
+        task = tasks[key]
+        cg.add(setter(task.get(CONF_CORE, -1), task[CONF_PRIORITY], task[CONF_STACK_SIZE]))
+    cg.add(var.set_interrupt_streaming(config[CONF_INTERRUPT_STREAMING]))
+    cg.add(var.set_idle_update_interval(config[CONF_IDLE_UPDATE_INTERVAL]))
+    cg.add(var.set_critical_update_interval(config[CONF_CRITICAL_UPDATE_INTERVAL]))
+    cg.add(var.set_report_cache_ttl(config[CONF_REPORT_CACHE_TTL]))
+    cg.add(var.set_history_size(config[CONF_HISTORY_SIZE]))
+    cg.add(var.set_history_window(config[CONF_HISTORY_WINDOW]))
+    cg.add(var.set_discovery_cache(config[CONF_DISCOVERY_CACHE]))
+    cg.add(var.set_reconnect_window(config[CONF_RECONNECT_WINDOW]))
+    if config[CONF_INSTRUMENTATION]:
+        cg.add(var.set_instrumentation(True))
+    if capture := config.get(CONF_CAPTURE):
+        cg.add_define("USE_UPS_HID_CAPTURE")
+        cg.add(var.set_capture_buffer_size(capture[CONF_BUFFER_SIZE]))
+        web_server = await cg.get_variable(capture[CONF_WEB_SERVER_BASE_ID])
+        path = capture.get(CONF_PATH, f"/ups_hid/{config[CONF_ID].id}/trace.bin")
+        cg.add(var.set_capture_download(web_server, path))
+    # One ceiling for every instance: the most verbose one that is configured.
+    # Instances without debug_level leave the component at the logger level
+    debug_levels = [conf.get(CONF_DEBUG_LEVEL) for conf in CORE.config.get("ups_hid", [config])]
+    if all(debug_levels):
+        level = max(debug_levels, key=list(DEBUG_LEVELS).index)
+        cg.add_define("UPS_HID_LOG_LEVEL", DEBUG_LEVELS[level])
+    for override in config[CONF_REPORT_CACHE_OVERRIDES]:
+        cg.add(
+            var.add_report_cache_override(
+                HID_REPORT_TYPES[override[CONF_REPORT_TYPE]],
+                override[CONF_REPORT_ID],
+                override[CONF_TTL],
+            )
+        )
@@ -23,6 +23,10 @@
 #define HID_REPORT_TYPE_OUTPUT          0x02  
 #define HID_REPORT_TYPE_FEATURE         0x03
 
+// Class descriptor types (HID 1.11 section 7.1)
+#define HID_DESCRIPTOR_TYPE_HID         0x21
+#define HID_DESCRIPTOR_TYPE_REPORT      0x22
+
 // =============================================================================
 // HID Usage Pages (USB HID Usage Tables v1.12)
 // =============================================================================
@@ -84,6 +88,8 @@
 #define HID_USAGE_POW_OVER_CHARGED              0x0066
 #define HID_USAGE_POW_SHUTDOWN_REQUESTED        0x0068
 #define HID_USAGE_POW_SHUTDOWN_IMMINENT         0x0069
+#define HID_USAGE_POW_BOOST                     0x006E
+#define HID_USAGE_POW_BUCK                      0x006F
 
 // Device Information
 #define HID_USAGE_POW_I_MANUFACTURER            0x00FD
@@ -95,6 +101,9 @@
 // =============================================================================
 
 // Battery Status
+#define HID_USAGE_BAT_REMAINING_CAPACITY_LIMIT  0x0029
+#define HID_USAGE_BAT_REMAINING_TIME_LIMIT      0x002A
+#define HID_USAGE_BAT_BELOW_CAPACITY_LIMIT      0x0042
 #define HID_USAGE_BAT_CHARGING                  0x0044
 #define HID_USAGE_BAT_DISCHARGING               0x0045
 #define HID_USAGE_BAT_FULLY_CHARGED             0x0046
@@ -116,6 +125,10 @@
 #define HID_USAGE_BAT_I_DEVICE_NAME             0x0088
 #define HID_USAGE_BAT_I_DEVICE_CHEMISTRY        0x0089
 
+// Battery Presence
+#define HID_USAGE_BAT_AC_PRESENT                0x00D0
+#define HID_USAGE_BAT_BATTERY_PRESENT           0x00D1
+
 // =============================================================================
 // Regional Voltage Standards (IEC 60038)
 // =============================================================================
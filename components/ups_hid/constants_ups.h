@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace esphome {
@@ -23,7 +24,53 @@ namespace timing {
     // USB operation timeouts
     static constexpr uint32_t USB_CONTROL_TRANSFER_TIMEOUT_MS = 1000;  // 1 second
     static constexpr uint32_t USB_SEMAPHORE_TIMEOUT_MS = 1000;         // 1 second  
-    static constexpr uint32_t USB_CLIENT_EVENT_TIMEOUT_MS = 100;       // 100ms for event polling
+    
+    // Streamed input reports are pushed on change, so a cached copy stays valid
+    // for a while; past this age GET_REPORT polling refreshes it
+    static constexpr uint32_t INPUT_REPORT_CACHE_MAX_AGE_MS = 60000;  // 1 minute
+    
+    // Without the acquisition task, streamed reports trigger polls on the main
+    // loop; those still issue feature GET_REPORTs, so bursts are folded into one
+    static constexpr uint32_t INPUT_REPORT_POLL_MIN_INTERVAL_MS = 2000;
+    
+    // Refresh period of the slow report group (nominal ratings, thresholds, configuration)
+    static constexpr uint32_t SLOW_REPORT_GROUP_INTERVAL_MS = 300000;  // 5 minutes
+    
+    // Adaptive poll rates; the active rate is the configured update_interval
+    static constexpr uint32_t DEFAULT_IDLE_POLL_INTERVAL_MS = 60000;     // Online, battery full
+    static constexpr uint32_t DEFAULT_CRITICAL_POLL_INTERVAL_MS = 2000;  // Shutdown/start/reboot countdown
+    
+    // A unit that comes back on USB within this long keeps its protocol and report map
+    static constexpr uint32_t DEFAULT_RECONNECT_WINDOW_MS = 300000;  // 5 minutes
+    
+    // Window of the history summaries exported to NUT
+    static constexpr uint32_t DEFAULT_HISTORY_WINDOW_MS = 600000;  // 10 minutes
+    
+    // Quarantine of report IDs that keep timing out, doubled on every re-trip
+    static constexpr uint32_t REPORT_BREAKER_BASE_BACKOFF_MS = 60000;   // 1 minute
+    static constexpr uint32_t REPORT_BREAKER_MAX_BACKOFF_MS = 3600000;  // 1 hour
+}
+
+// ==================== Acquisition Task ====================
+namespace acquisition {
+    static constexpr const char* TASK_NAME = "ups_acquire";
+    static constexpr uint32_t TASK_STACK_SIZE = 8192;             // Parsers log and build strings; batched polls hold their reports
+    static constexpr uint32_t TASK_PRIORITY = 2;                  // Below usb_client_task so completions are serviced
+    static constexpr uint32_t STOP_TIMEOUT_MS = 3000;             // Upper bound for an in-flight poll to finish at shutdown
+}
+
+// ==================== USB Host Tasks ====================
+namespace usb_tasks {
+    static constexpr const char* HOST_TASK_NAME = "usb_lib_task";
+    static constexpr uint32_t HOST_TASK_STACK_SIZE = 4096;
+    static constexpr uint32_t HOST_TASK_PRIORITY = 2;
+    static constexpr const char* CLIENT_TASK_NAME = "usb_client_task";
+    static constexpr uint32_t CLIENT_TASK_STACK_SIZE = 6144;
+    static constexpr uint32_t CLIENT_TASK_PRIORITY = 3;           // Above the acquisition task, which waits on its completions
+    static constexpr uint32_t CLIENT_STOP_TIMEOUT_MS = 500;       // For the client task to leave usb_host_client_handle_events()
+    static constexpr uint32_t CLIENT_STOP_POLL_INTERVAL_MS = 10;
+    static constexpr uint32_t TRANSFER_DRAIN_TIMEOUT_MS = 2000;   // For in-flight transfers to complete or time out at teardown
+    static constexpr uint32_t HOST_INSTALL_TIMEOUT_MS = 1000;     // For usb_lib_task to report usb_host_install()
 }
 
 // ==================== Protocol Limits ====================
@@ -36,6 +83,47 @@ namespace limits {
     static constexpr size_t MAX_HID_REPORT_SIZE = 64;
     static constexpr size_t MIN_HID_REPORT_SIZE = 8;
     static constexpr size_t USB_STRING_DESCRIPTOR_MAX_LENGTH = 256;
+    static constexpr size_t USB_STRING_DESCRIPTOR_REQUEST_LENGTH = 255;  // wLength is a byte for string requests
+    
+    // Preallocated control transfers, which is also the per-device request
+    // queue depth. More than one so a timed-out transfer still owned by the
+    // host stack does not block the next request, and so a poll's report
+    // reads are queued on EP0 back-to-back.
+    static constexpr size_t CONTROL_TRANSFER_POOL_SIZE = 4;
+    
+    // Reports in one hid_get_reports() batch; a protocol's fast poll fits in one
+    static constexpr size_t MAX_REPORT_BATCH = 16;
+    
+    // Distinct input report IDs cached from the interrupt endpoint
+    static constexpr size_t INPUT_REPORT_CACHE_SIZE = 16;
+    
+    // GET_REPORT results held by the caching transport (report type + ID pairs)
+    static constexpr size_t REPORT_CACHE_SIZE = 32;
+    
+    // Reports with their own latency histogram when instrumentation is enabled
+    static constexpr size_t INSTRUMENTED_REPORTS = 24;
+    
+    // Poll history ring buffer, 18 bytes per sample
+    static constexpr size_t MAX_HISTORY_SIZE = 4096;
+    
+    // HID report descriptor bounds; power devices are typically 500-1500 bytes
+    static constexpr size_t MAX_REPORT_DESCRIPTOR_SIZE = 2048;
+    static constexpr size_t MAX_HID_DESCRIPTOR_FIELDS = 512;
+    static constexpr size_t MAX_HID_COLLECTION_DEPTH = 16;
+    
+    // Report IDs tracked by the circuit breaker, and the consecutive timeouts that open it
+    static constexpr size_t REPORT_BREAKER_SIZE = 32;
+    static constexpr uint8_t REPORT_BREAKER_THRESHOLD = 3;
+    
+    // Probed report sizes kept in the discovery cache
+    static constexpr size_t MAX_CACHED_REPORT_SIZES = 32;
+    
+    // Control commands waiting for the polling context
+    static constexpr size_t COMMAND_QUEUE_SIZE = 8;
+    
+    // Report trace ring of capture:, in bytes, placed in PSRAM when present
+    static constexpr size_t MIN_CAPTURE_BUFFER_SIZE = 4096;
+    static constexpr size_t MAX_CAPTURE_BUFFER_SIZE = 4 * 1024 * 1024;
 }
 
 // ==================== Battery Constants ====================
@@ -193,6 +281,22 @@ namespace sensor_type {
     static constexpr const char* UPS_TIMER_REBOOT = "ups_timer_reboot";
     static constexpr const char* UPS_TIMER_SHUTDOWN = "ups_timer_shutdown";
     static constexpr const char* UPS_TIMER_START = "ups_timer_start";
+    static constexpr const char* BATTERY_CHARGE_LOW = "battery_charge_low";
+    static constexpr const char* BATTERY_CHARGE_WARNING = "battery_charge_warning";
+    
+    // Diagnostics, published only with instrumentation
+    static constexpr const char* POLL_DURATION = "poll_duration";
+    static constexpr const char* POLL_DURATION_MAX = "poll_duration_max";
+    static constexpr const char* PROTOCOL_LOCK_WAIT = "protocol_lock_wait";
+    static constexpr const char* ACQUISITION_WAKE_LATENCY = "acquisition_wake_latency";
+    static constexpr const char* USB_TRANSFERS = "usb_transfers";
+    static constexpr const char* USB_TIMEOUTS = "usb_timeouts";
+    static constexpr const char* USB_ERRORS = "usb_errors";
+    static constexpr const char* USB_BYTES = "usb_bytes";
+    static constexpr const char* MEMORY_USAGE = "memory_usage";
+    static constexpr const char* MEMORY_USAGE_PEAK = "memory_usage_peak";
+    static constexpr const char* ACQUISITION_STACK_FREE = "acquisition_stack_free";
+    static constexpr const char* USB_STACK_FREE = "usb_stack_free";
 }
 
 // ==================== Binary Sensor Type Identifiers ====================
@@ -200,6 +304,7 @@ namespace binary_sensor_type {
     static constexpr const char* ONLINE = "online";
     static constexpr const char* ON_BATTERY = "on_battery";
     static constexpr const char* LOW_BATTERY = "low_battery";
+    static constexpr const char* FAULT = "fault";
     static constexpr const char* OVERLOAD = "overload";
     static constexpr const char* BUCK = "buck";
     static constexpr const char* BOOST = "boost";
@@ -269,6 +374,18 @@ namespace log_messages {
     static constexpr const char* READ_FAILED = "Failed to read UPS data (failure #%u)";
     static constexpr const char* RESETTING_PROTOCOL = "Too many consecutive read failures - resetting protocol to retry detection";
     static constexpr const char* NO_PARENT_COMPONENT = "No UPS HID parent component set";
+    static constexpr const char* ACQUISITION_TASK_FAILED = "Failed to start acquisition task - falling back to main loop polling";
+    static constexpr const char* INTERRUPT_STREAMING_UNAVAILABLE = "Interrupt streaming unavailable (%s), using GET_REPORT polling only";
+    static constexpr const char* HISTORY_ALLOCATION_FAILED = "Could not allocate %zu history samples, history disabled";
+    static constexpr const char* CAPTURE_ALLOCATION_FAILED = "Could not allocate the %zu byte capture buffer, capture disabled";
+    static constexpr const char* CAPTURE_IN_INTERNAL_RAM = "No PSRAM for the capture buffer, %zu bytes taken from internal RAM";
+    static constexpr const char* DISCOVERY_RESTORED = "Restored %s discovery from cache (%s), skipping probing";
+    static constexpr const char* DISCOVERY_CACHE_DROPPED = "Cached discovery for %s no longer matches the device - discarding";
+    static constexpr const char* FAST_RECONNECT = "Same device back after %u ms - keeping %s protocol";
+    static constexpr const char* DEVICE_CHANGED = "Different device or reconnect window exceeded (%u ms offline) - detecting protocol again";
+    static constexpr const char* DATA_RESUMED = "Data resumed %u ms after reconnect";
+    static constexpr const char* COMMAND_QUEUE_FULL = "Command queue full, dropping %s";
+    static constexpr const char* COMMAND_FAILED = "Command %s failed";
 }
 
 }  // namespace ups_hid
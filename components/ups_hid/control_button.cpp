@@ -32,67 +32,55 @@ void UpsHidButton::press_action() {
   }
 
   // Get the current protocol from the parent component
-  UpsData ups_data = parent_->get_ups_data();
-  if (ups_data.device.detected_protocol == DeviceInfo::PROTOCOL_UNKNOWN) {
+  UpsDataSnapshot ups_data = parent_->get_ups_snapshot();
+  if (ups_data->device.detected_protocol == DeviceInfo::PROTOCOL_UNKNOWN) {
     ESP_LOGW(BUTTON_TAG, "UPS protocol not detected, cannot execute button action");
     return;
   }
 
-  // Get the active protocol
-  auto active_protocol = parent_->get_active_protocol();
-  if (!active_protocol) {
-    ESP_LOGE(BUTTON_TAG, "No active protocol available");
-    return;
-  }
-
-  bool success = false;
+  // Queued to the polling context so the press never blocks on USB
+  UpsCommand command;
+  const std::string &action = button_type_ == BUTTON_TYPE_BEEPER ? beeper_action_ : test_action_;
   
   if (button_type_ == BUTTON_TYPE_BEEPER) {
-    ESP_LOGI(BUTTON_TAG, "Executing beeper action: %s", beeper_action_.c_str());
-    
     if (beeper_action_ == beeper::ACTION_ENABLE) {
-      success = active_protocol->beeper_enable();
+      command = UpsCommand::BEEPER_ENABLE;
     } else if (beeper_action_ == beeper::ACTION_DISABLE) {
-      success = active_protocol->beeper_disable();
+      command = UpsCommand::BEEPER_DISABLE;
     } else if (beeper_action_ == beeper::ACTION_MUTE) {
-      success = active_protocol->beeper_mute();
+      command = UpsCommand::BEEPER_MUTE;
     } else if (beeper_action_ == beeper::ACTION_TEST) {
-      success = active_protocol->beeper_test();
+      command = UpsCommand::BEEPER_TEST;
     } else {
       ESP_LOGE(BUTTON_TAG, "Unknown beeper action: %s", beeper_action_.c_str());
       return;
     }
-
-    if (success) {
-      ESP_LOGI(BUTTON_TAG, "Beeper action '%s' executed successfully", beeper_action_.c_str());
-    } else {
-      ESP_LOGW(BUTTON_TAG, "Failed to execute beeper action: %s", beeper_action_.c_str());
-    }
-  } 
-  else if (button_type_ == BUTTON_TYPE_TEST) {
-    ESP_LOGI(BUTTON_TAG, "Executing test action: %s", test_action_.c_str());
-    
+  } else {
     if (test_action_ == test::ACTION_BATTERY_QUICK) {
-      success = active_protocol->start_battery_test_quick();
+      command = UpsCommand::BATTERY_TEST_QUICK;
     } else if (test_action_ == test::ACTION_BATTERY_DEEP) {
-      success = active_protocol->start_battery_test_deep();
+      command = UpsCommand::BATTERY_TEST_DEEP;
     } else if (test_action_ == test::ACTION_BATTERY_STOP) {
-      success = active_protocol->stop_battery_test();
+      command = UpsCommand::BATTERY_TEST_STOP;
     } else if (test_action_ == test::ACTION_UPS_TEST) {
-      success = active_protocol->start_ups_test();
+      command = UpsCommand::UPS_TEST_START;
     } else if (test_action_ == test::ACTION_UPS_STOP) {
-      success = active_protocol->stop_ups_test();
+      command = UpsCommand::UPS_TEST_STOP;
     } else {
       ESP_LOGE(BUTTON_TAG, "Unknown test action: %s", test_action_.c_str());
       return;
     }
-
+  }
+  
+  const char *kind = button_type_ == BUTTON_TYPE_BEEPER ? "beeper" : "test";
+  ESP_LOGI(BUTTON_TAG, "Queueing %s action: %s", kind, action.c_str());
+  parent_->submit_command(command, 0, [kind, &action](bool success) {
     if (success) {
-      ESP_LOGI(BUTTON_TAG, "Test action '%s' executed successfully", test_action_.c_str());
+      ESP_LOGI(BUTTON_TAG, "Executed %s action '%s'", kind, action.c_str());
     } else {
-      ESP_LOGW(BUTTON_TAG, "Failed to execute test action: %s", test_action_.c_str());
+      ESP_LOGW(BUTTON_TAG, "Failed to execute %s action: %s", kind, action.c_str());
     }
-  }
+  });
 }
 
 }  // namespace ups_hid
@@ -1,5 +1,5 @@
 #include "control_number.h"
-#include "esphome/core/log.h"
+#include "log_ups.h"
 
 namespace esphome {
 namespace ups_hid {
@@ -7,7 +7,7 @@ namespace ups_hid {
 static const char *const TAG_NUMBER = "ups_hid.number";
 
 void UpsDelayNumber::setup() {
-  ESP_LOGD(TAG_NUMBER, "Setting up UPS delay number '%s' for %s", 
+  UPS_HID_LOGD(TAG_NUMBER, "Setting up UPS delay number '%s' for %s", 
            this->get_name().c_str(), this->delay_type_to_string());
 }
 
@@ -24,30 +24,29 @@ void UpsDelayNumber::control(float value) {
     return;
   }
   
-  // Call parent to set the delay value via USB HID
-  bool success = false;
+  // Queued to the polling context; the entity follows once the write has completed
+  UpsCommand command = UpsCommand::SET_SHUTDOWN_DELAY;
   switch (this->delay_type_) {
     case DELAY_SHUTDOWN:
-      success = this->parent_->set_shutdown_delay(static_cast<int>(value));
+      command = UpsCommand::SET_SHUTDOWN_DELAY;
       break;
     case DELAY_START:
-      success = this->parent_->set_start_delay(static_cast<int>(value));
+      command = UpsCommand::SET_START_DELAY;
       break;
     case DELAY_REBOOT:
-      success = this->parent_->set_reboot_delay(static_cast<int>(value));
+      command = UpsCommand::SET_REBOOT_DELAY;
       break;
   }
   
-  if (success) {
-    // Update displayed value if write succeeded
-    this->publish_state(value);
-    ESP_LOGI(TAG_NUMBER, "%s delay set successfully to %.0f seconds", 
-             this->delay_type_to_string(), value);
-  } else {
-    ESP_LOGW(TAG_NUMBER, "Failed to set %s delay", this->delay_type_to_string());
-    // Optionally refresh from device to show actual value
-    this->parent_->request_delay_refresh();
-  }
+  this->parent_->submit_command(command, static_cast<int>(value), [this, value](bool success) {
+    if (success) {
+      // Update displayed value if write succeeded; the read-back poll confirms it
+      this->publish_state(value);
+      ESP_LOGI(TAG_NUMBER, "%s delay set successfully to %.0f seconds", this->delay_type_to_string(), value);
+    } else {
+      ESP_LOGW(TAG_NUMBER, "Failed to set %s delay", this->delay_type_to_string());
+    }
+  });
 }
 
 void UpsDelayNumber::update_value(float value) {
@@ -7,6 +7,8 @@
 #include "data_config.h"
 #include <cstdint>
 #include <cstring>  // For memcmp
+#include <cmath>
+#include <memory>
 
 namespace esphome {
 namespace ups_hid {
@@ -35,6 +37,27 @@ struct UpsCompositeData {
     return battery.is_valid() && power.is_valid();
   }
   
+  // Derived UPS state (shared by lambda getters, NUT server and status LED).
+  // Bit tests on the reported status; the voltage/level heuristics only cover
+  // protocols that have not parsed a present-status report.
+  bool is_online() const {
+    return power.has_status_flags() ? power.has_status(UPS_STATUS_OL) : power.input_voltage_valid();
+  }
+  bool is_on_battery() const {
+    return power.has_status_flags() ? power.has_status(UPS_STATUS_OB) : !power.input_voltage_valid();
+  }
+  bool is_low_battery() const { return power.has_status(UPS_STATUS_LB) || battery.is_low(); }
+  bool is_charging() const {
+    if (power.has_status_flags()) {
+      return power.has_status(UPS_STATUS_CHRG);
+    }
+    return power.input_voltage_valid() && battery.is_valid() &&
+           !std::isnan(battery.level) && battery.level < 100.0f;
+  }
+  bool has_fault() const {
+    return power.is_input_out_of_range() || (!power.is_valid() && !battery.is_valid());
+  }
+  
   // Clean reset without legacy flags
   void reset() {
     battery.reset();
@@ -44,6 +67,22 @@ struct UpsCompositeData {
     config.reset();
   }
   
+  // Unset the values the fast report group writes, so a report that stops
+  // answering reads as unavailable instead of repeating its last value.
+  // Identity, ratings, thresholds and configuration are kept.
+  void reset_fast_values() {
+    battery.level = NAN;
+    battery.voltage = NAN;
+    battery.runtime_minutes = NAN;
+    battery.status.clear();
+    power.input_voltage = NAN;
+    power.output_voltage = NAN;
+    power.load_percent = NAN;
+    power.frequency = NAN;
+    power.status_flags = 0;
+    test.ups_test_result.clear();
+  }
+  
   // Copy constructor and assignment for safe copying
   UpsCompositeData() = default;
   UpsCompositeData(const UpsCompositeData&) = default;
@@ -55,5 +94,63 @@ struct UpsCompositeData {
 // Type alias for cleaner naming
 using UpsData = UpsCompositeData;
 
+// Sections that differ between two consecutive snapshots
+enum UpsDataChange : uint32_t {
+  UPS_CHANGE_STATUS = 1 << 0,   // Status bits (ups.status) and the state derived from them
+  UPS_CHANGE_BATTERY = 1 << 1,  // Charge, voltages, runtime
+  UPS_CHANGE_POWER = 1 << 2,    // Input/output voltages, frequency, load, ratings
+  UPS_CHANGE_DEVICE = 1 << 3,   // Identity strings
+  UPS_CHANGE_HISTORY = 1 << 4,  // A sample joined the poll history; its min/max/mean may have moved
+};
+
+namespace detail {
+// NAN means "not reported", so two missing values are equal
+inline bool same_value(float a, float b) { return a == b || (std::isnan(a) && std::isnan(b)); }
+}  // namespace detail
+
+// UPS_CHANGE_* bits for the sections that differ; 0 when nothing consumers see changed
+inline uint32_t diff_ups_data(const UpsData &before, const UpsData &after) {
+  using detail::same_value;
+  uint32_t changes = 0;
+
+  if (before.is_online() != after.is_online() || before.is_on_battery() != after.is_on_battery() ||
+      before.is_low_battery() != after.is_low_battery() || before.is_charging() != after.is_charging() ||
+      before.has_fault() != after.has_fault() || before.power.is_overloaded() != after.power.is_overloaded() ||
+      before.power.status_flags != after.power.status_flags) {
+    changes |= UPS_CHANGE_STATUS;
+  }
+
+  const BatteryData &b0 = before.battery, &b1 = after.battery;
+  if (!same_value(b0.level, b1.level) || !same_value(b0.voltage, b1.voltage) ||
+      !same_value(b0.voltage_nominal, b1.voltage_nominal) ||
+      !same_value(b0.runtime_minutes, b1.runtime_minutes)) {
+    changes |= UPS_CHANGE_BATTERY;
+  }
+
+  const PowerData &p0 = before.power, &p1 = after.power;
+  if (!same_value(p0.input_voltage, p1.input_voltage) ||
+      !same_value(p0.input_voltage_nominal, p1.input_voltage_nominal) ||
+      !same_value(p0.input_transfer_low, p1.input_transfer_low) ||
+      !same_value(p0.input_transfer_high, p1.input_transfer_high) ||
+      !same_value(p0.frequency, p1.frequency) || !same_value(p0.output_voltage, p1.output_voltage) ||
+      !same_value(p0.output_voltage_nominal, p1.output_voltage_nominal) ||
+      !same_value(p0.load_percent, p1.load_percent) ||
+      !same_value(p0.realpower_nominal, p1.realpower_nominal) ||
+      !same_value(p0.apparent_power_nominal, p1.apparent_power_nominal)) {
+    changes |= UPS_CHANGE_POWER;
+  }
+
+  const DeviceInfo &d0 = before.device, &d1 = after.device;
+  if (d0.manufacturer != d1.manufacturer || d0.model != d1.model ||
+      d0.serial_number != d1.serial_number || d0.firmware_version != d1.firmware_version) {
+    changes |= UPS_CHANGE_DEVICE;
+  }
+
+  return changes;
+}
+
+// Immutable published snapshot; holders keep it alive for the duration of a request
+using UpsDataSnapshot = std::shared_ptr<const UpsData>;
+
 }  // namespace ups_hid
 }  // namespace esphome
\ No newline at end of file
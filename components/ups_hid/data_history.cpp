@@ -0,0 +1,144 @@
+#include "data_history.h"
+#include <algorithm>
+#include <new>
+
+namespace esphome {
+namespace ups_hid {
+
+// Quantization step per field: stored value = reading * scale
+static constexpr float HISTORY_FIELD_SCALE[HISTORY_FIELD_COUNT] = {
+  10.0f,   // BATTERY_LEVEL
+  100.0f,  // BATTERY_VOLTAGE
+  1.0f,    // RUNTIME
+  10.0f,   // INPUT_VOLTAGE
+  10.0f,   // OUTPUT_VOLTAGE
+  10.0f,   // LOAD_PERCENT
+  100.0f,  // FREQUENCY
+};
+
+static float history_field_value(HistoryField field, const UpsData &data) {
+  switch (field) {
+    case HistoryField::BATTERY_LEVEL:
+      return data.battery.level;
+    case HistoryField::BATTERY_VOLTAGE:
+      return data.battery.voltage;
+    case HistoryField::RUNTIME:
+      return data.battery.runtime_minutes;
+    case HistoryField::INPUT_VOLTAGE:
+      return data.power.input_voltage;
+    case HistoryField::OUTPUT_VOLTAGE:
+      return data.power.output_voltage;
+    case HistoryField::LOAD_PERCENT:
+      return data.power.load_percent;
+    case HistoryField::FREQUENCY:
+      return data.power.frequency;
+  }
+  return NAN;
+}
+
+static int16_t quantize(float value, float scale) {
+  if (std::isnan(value) || std::isinf(value)) {
+    return INT16_MIN;
+  }
+  // Clamp one step inside the range so a reading never collides with the gap marker
+  const float scaled = std::round(value * scale);
+  return static_cast<int16_t>(std::max(-32767.0f, std::min(32767.0f, scaled)));
+}
+
+bool UpsHistory::allocate(size_t capacity) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  values_.reset();
+  timestamps_.reset();
+  capacity_ = 0;
+  head_ = 0;
+  count_ = 0;
+  if (capacity == 0) {
+    return true;
+  }
+
+  values_.reset(new (std::nothrow) int16_t[capacity * HISTORY_FIELD_COUNT]);
+  timestamps_.reset(new (std::nothrow) uint32_t[capacity]);
+  if (!values_ || !timestamps_) {
+    values_.reset();
+    timestamps_.reset();
+    return false;
+  }
+  capacity_ = capacity;
+  return true;
+}
+
+void UpsHistory::record(uint32_t timestamp_ms, const UpsData &data) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (capacity_ == 0) {
+    return;
+  }
+  for (size_t f = 0; f < HISTORY_FIELD_COUNT; f++) {
+    const auto field = static_cast<HistoryField>(f);
+    column(field)[head_] = quantize(history_field_value(field, data), HISTORY_FIELD_SCALE[f]);
+  }
+  timestamps_[head_] = timestamp_ms;
+  head_ = (head_ + 1) % capacity_;
+  count_ = std::min(count_ + 1, capacity_);
+}
+
+void UpsHistory::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  head_ = 0;
+  count_ = 0;
+}
+
+size_t UpsHistory::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return count_;
+}
+
+UpsHistoryStats UpsHistory::stats(HistoryField field, uint32_t window_ms, uint32_t now_ms) const {
+  UpsHistoryStats result;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (count_ == 0) {
+    return result;
+  }
+
+  // Integer accumulation over the quantized column, newest first
+  const int16_t *values = column(field);
+  int16_t lo = INT16_MAX;
+  int16_t hi = INT16_MIN;
+  int32_t sum = 0;
+  size_t count = 0;
+  for (size_t age = 0; age < count_; age++) {
+    const size_t i = slot(age);
+    if (window_ms > 0 && now_ms - timestamps_[i] > window_ms) {
+      break;
+    }
+    const int16_t value = values[i];
+    if (value == GAP) {
+      continue;
+    }
+    lo = std::min(lo, value);
+    hi = std::max(hi, value);
+    sum += value;
+    count++;
+  }
+  if (count == 0) {
+    return result;
+  }
+
+  const float scale = HISTORY_FIELD_SCALE[static_cast<size_t>(field)];
+  result.min = lo / scale;
+  result.max = hi / scale;
+  result.mean = static_cast<float>(sum) / static_cast<float>(count) / scale;
+  result.count = count;
+  return result;
+}
+
+float UpsHistory::value_at(HistoryField field, size_t age) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (age >= count_) {
+    return NAN;
+  }
+  const int16_t value = column(field)[slot(age)];
+  return value == GAP ? NAN : value / HISTORY_FIELD_SCALE[static_cast<size_t>(field)];
+}
+
+}  // namespace ups_hid
+}  // namespace esphome
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "data_composite.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace esphome {
+namespace ups_hid {
+
+// Numeric fields kept in the poll history
+enum class HistoryField : uint8_t {
+  BATTERY_LEVEL = 0,  // %, 0.1 resolution
+  BATTERY_VOLTAGE,    // V, 0.01 resolution
+  RUNTIME,            // minutes, 1 resolution
+  INPUT_VOLTAGE,      // V, 0.1 resolution
+  OUTPUT_VOLTAGE,     // V, 0.1 resolution
+  LOAD_PERCENT,       // %, 0.1 resolution
+  FREQUENCY,          // Hz, 0.01 resolution
+};
+static constexpr size_t HISTORY_FIELD_COUNT = 7;
+
+// Aggregate over the samples of one field within a window; NAN/0 when none
+struct UpsHistoryStats {
+  float min{NAN};
+  float max{NAN};
+  float mean{NAN};
+  size_t count{0};
+};
+
+/**
+ * Fixed-size ring buffer of per-poll samples
+ *
+ * Values are quantized to int16 and stored one array per field (struct of
+ * arrays), so an aggregate over one field walks contiguous memory. The buffer
+ * is allocated once; when full, the oldest sample is overwritten. A field the
+ * UPS does not report is stored as a gap and skipped by the aggregates.
+ *
+ * record() is called from the polling context; readers may run on any task.
+ */
+class UpsHistory {
+ public:
+  // Allocates capacity samples; 0 frees the buffer. Returns false if out of memory.
+  bool allocate(size_t capacity);
+
+  void record(uint32_t timestamp_ms, const UpsData &data);
+  void clear();
+
+  // Samples of field recorded within the last window_ms before now_ms (0 = whole buffer)
+  UpsHistoryStats stats(HistoryField field, uint32_t window_ms, uint32_t now_ms) const;
+  // Value of the sample age polls back (0 = newest); NAN if missing or out of range
+  float value_at(HistoryField field, size_t age) const;
+
+  size_t capacity() const { return capacity_; }
+  size_t size() const;
+  // Bytes held by the sample arrays
+  size_t memory_usage() const { return capacity_ * (sizeof(uint32_t) + HISTORY_FIELD_COUNT * sizeof(int16_t)); }
+
+ protected:
+  static constexpr int16_t GAP = INT16_MIN;
+
+  size_t slot(size_t age) const { return (head_ + capacity_ - 1 - age) % capacity_; }
+  int16_t *column(HistoryField field) { return values_.get() + static_cast<size_t>(field) * capacity_; }
+  const int16_t *column(HistoryField field) const {
+    return values_.get() + static_cast<size_t>(field) * capacity_;
+  }
+
+  mutable std::mutex mutex_;
+  std::unique_ptr<int16_t[]> values_;      // HISTORY_FIELD_COUNT columns of capacity_ samples
+  std::unique_ptr<uint32_t[]> timestamps_;  // millis() of each sample
+  size_t capacity_{0};
+  size_t head_{0};   // Next slot to write
+  size_t count_{0};  // Valid samples, up to capacity_
+};
+
+}  // namespace ups_hid
+}  // namespace esphome
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "constants_ups.h"
+#include "data_composite.h"
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+namespace esphome {
+namespace ups_hid {
+
+// Derived UPS state, one bit each
+enum UpsStateFlag : uint32_t {
+  UPS_STATE_ONLINE = 1 << 0,
+  UPS_STATE_ON_BATTERY = 1 << 1,
+  UPS_STATE_LOW_BATTERY = 1 << 2,
+  UPS_STATE_CHARGING = 1 << 3,
+  UPS_STATE_FAULT = 1 << 4,
+  UPS_STATE_OVERLOAD = 1 << 5,
+  UPS_STATE_TEST_RUNNING = 1 << 6,
+  UPS_STATE_TIMER_ACTIVE = 1 << 7,  // Shutdown, start or reboot countdown
+};
+
+/**
+ * Compact per-poll view of UpsData
+ *
+ * The values that change from poll to poll plus the derived state flags,
+ * without any of the identity, configuration or test-result strings. It is
+ * trivially copyable and fits one 64-byte line, so it can be published and
+ * read without allocation or string copies; consumers that only need the
+ * state (NUT ups.status, status LED, binary sensors) use it instead of the
+ * full snapshot. The strings change once per connection and are versioned by
+ * UpsHidComponent::get_device_generation().
+ */
+struct UpsHotData {
+  float battery_level{NAN};
+  float battery_voltage{NAN};
+  float runtime_minutes{NAN};
+  float input_voltage{NAN};
+  float output_voltage{NAN};
+  float load_percent{NAN};
+  float frequency{NAN};
+  int16_t timer_shutdown{-1};
+  int16_t timer_start{-1};
+  int16_t timer_reboot{-1};
+  uint32_t flags{0};       // UPS_STATE_* bits
+  uint32_t status{0};      // UPS_STATUS_* bits (canonical_status())
+  uint32_t generation{0};  // Snapshot generation this view was taken from
+
+  bool has(uint32_t flag) const { return (flags & flag) != 0; }
+  bool has_status(uint32_t flag) const { return (status & flag) != 0; }
+  bool is_online() const { return has(UPS_STATE_ONLINE); }
+  bool is_on_battery() const { return has(UPS_STATE_ON_BATTERY); }
+  bool is_low_battery() const { return has(UPS_STATE_LOW_BATTERY); }
+  bool is_charging() const { return has(UPS_STATE_CHARGING); }
+  bool has_fault() const { return has(UPS_STATE_FAULT); }
+  bool is_overloaded() const { return has(UPS_STATE_OVERLOAD); }
+  bool is_test_running() const { return has(UPS_STATE_TEST_RUNNING); }
+  bool has_active_timers() const { return has(UPS_STATE_TIMER_ACTIVE); }
+};
+
+static_assert(std::is_trivially_copyable<UpsHotData>::value, "UpsHotData is copied as plain bytes");
+static_assert(sizeof(UpsHotData) <= 64, "UpsHotData should fit one cache line");
+
+inline uint32_t derive_state_flags(const UpsData &data) {
+  uint32_t flags = 0;
+  if (data.is_online()) flags |= UPS_STATE_ONLINE;
+  if (data.is_on_battery()) flags |= UPS_STATE_ON_BATTERY;
+  if (data.is_low_battery()) flags |= UPS_STATE_LOW_BATTERY;
+  if (data.is_charging()) flags |= UPS_STATE_CHARGING;
+  if (data.has_fault()) flags |= UPS_STATE_FAULT;
+  if (data.power.is_overloaded()) flags |= UPS_STATE_OVERLOAD;
+  if (data.test.is_test_running() || data.test.ups_test_result == test::RESULT_IN_PROGRESS) {
+    flags |= UPS_STATE_TEST_RUNNING;
+  }
+  if (data.test.timer_shutdown > 0 || data.test.timer_start > 0 || data.test.timer_reboot > 0) {
+    flags |= UPS_STATE_TIMER_ACTIVE;
+  }
+  return flags;
+}
+
+// UPS_STATUS_* bits as reported, or synthesized from the derived state for
+// protocols that never parsed a present-status report
+inline uint32_t canonical_status(const UpsData &data) {
+  if (data.power.has_status_flags()) {
+    return data.power.status_flags | (data.is_low_battery() ? UPS_STATUS_LB : 0) |
+           (data.power.is_overloaded() ? UPS_STATUS_OVER : 0);
+  }
+  uint32_t status = data.power.status_flags;
+  if (data.is_online()) status |= UPS_STATUS_OL;
+  if (data.is_on_battery()) status |= UPS_STATUS_OB | UPS_STATUS_DISCHRG;
+  if (data.is_low_battery()) status |= UPS_STATUS_LB;
+  if (data.is_charging()) status |= UPS_STATUS_CHRG;
+  if (data.power.is_overloaded()) status |= UPS_STATUS_OVER;
+  return status;
+}
+
+inline UpsHotData make_hot_data(const UpsData &data, uint32_t generation) {
+  UpsHotData hot;
+  hot.battery_level = data.battery.level;
+  hot.battery_voltage = data.battery.voltage;
+  hot.runtime_minutes = data.battery.runtime_minutes;
+  hot.input_voltage = data.power.input_voltage;
+  hot.output_voltage = data.power.output_voltage;
+  hot.load_percent = data.power.load_percent;
+  hot.frequency = data.power.frequency;
+  hot.timer_shutdown = data.test.timer_shutdown;
+  hot.timer_start = data.test.timer_start;
+  hot.timer_reboot = data.test.timer_reboot;
+  hot.flags = derive_state_flags(data);
+  hot.status = canonical_status(data);
+  hot.generation = generation;
+  return hot;
+}
+
+}  // namespace ups_hid
+}  // namespace esphome
@@ -7,6 +7,22 @@
 namespace esphome {
 namespace ups_hid {
 
+// Canonical UPS status, one bit per NUT ups.status token. Set directly by the
+// protocols' present-status parsers; text is only rendered when asked for.
+enum UpsStatusFlag : uint32_t {
+  UPS_STATUS_OL = 1 << 0,       // Online (mains present)
+  UPS_STATUS_OB = 1 << 1,       // On battery
+  UPS_STATUS_LB = 1 << 2,       // Low battery (incl. shutdown imminent, runtime limit expired)
+  UPS_STATUS_CHRG = 1 << 3,     // Charging
+  UPS_STATUS_DISCHRG = 1 << 4,  // Discharging
+  UPS_STATUS_OVER = 1 << 5,     // Overload
+  UPS_STATUS_RB = 1 << 6,       // Replace battery
+  UPS_STATUS_FSD = 1 << 7,      // Forced shutdown
+  UPS_STATUS_TRIM = 1 << 8,     // Reducing (buck) high input voltage
+  UPS_STATUS_BOOST = 1 << 9,    // Boosting low input voltage
+};
+static constexpr uint32_t UPS_STATUS_POWER_SOURCE = UPS_STATUS_OL | UPS_STATUS_OB;
+
 struct PowerData {
   // Input power metrics
   float input_voltage{NAN};            // Current input voltage (V)
@@ -24,8 +40,28 @@ struct PowerData {
   float realpower_nominal{NAN};        // Nominal real power rating (W)
   float apparent_power_nominal{NAN};   // Nominal apparent power rating (VA)
   
-  // Power status information
-  std::string status{};                // Power status text (Online, On Battery, etc.)
+  // Power status: UPS_STATUS_* bits, 0 until a protocol has parsed a present-status report
+  uint32_t status_flags{0};
+  
+  bool has_status_flags() const { return (status_flags & UPS_STATUS_POWER_SOURCE) != 0; }
+  bool has_status(uint32_t flag) const { return (status_flags & flag) != 0; }
+  // Replace the bits in mask with those in flags, keeping the rest
+  void set_status(uint32_t mask, uint32_t flags) { status_flags = (status_flags & ~mask) | (flags & mask); }
+  // "Online", "On Battery", with " - Overload" appended; empty before the first status report
+  std::string status_text() const {
+    std::string text;
+    if (has_status(UPS_STATUS_OL)) {
+      text = "Online";
+    } else if (has_status(UPS_STATUS_OB)) {
+      text = "On Battery";
+    } else {
+      return text;
+    }
+    if (has_status(UPS_STATUS_OVER)) {
+      text += " - Overload";
+    }
+    return text;
+  }
   
   // Power quality indicators
   bool input_voltage_valid() const {
@@ -47,7 +83,7 @@ struct PowerData {
   }
   
   bool is_overloaded() const {
-    return !std::isnan(load_percent) && load_percent > 95.0f;
+    return has_status(UPS_STATUS_OVER) || (!std::isnan(load_percent) && load_percent > 95.0f);
   }
   
   bool has_load_info() const {
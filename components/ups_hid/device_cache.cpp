@@ -0,0 +1,83 @@
+#include "device_cache.h"
+#include "esphome/core/helpers.h"
+#include "log_ups.h"
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#ifdef USE_ESP32
+#include <nvs.h>
+#endif
+
+namespace esphome {
+namespace ups_hid {
+
+static const char *const CACHE_TAG = "ups_hid.cache";
+static const char *const CACHE_NAMESPACE = "ups_hid";
+
+void DeviceCache::select(uint16_t vendor_id, uint16_t product_id, const std::string &serial) {
+  char identity[80];
+  snprintf(identity, sizeof(identity), "%04X:%04X:%s", vendor_id, product_id, serial.c_str());
+  snprintf(key_, sizeof(key_), "d%08" PRIX32, fnv1_hash(identity));
+  UPS_HID_LOGD(CACHE_TAG, "Device %s uses cache record %s", identity, key_);
+}
+
+#ifdef USE_ESP32
+bool DeviceCache::load(DeviceCacheRecord &record) const {
+  if (!selected()) {
+    return false;
+  }
+  nvs_handle_t handle;
+  if (nvs_open(CACHE_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+    return false;  // Namespace does not exist until the first store
+  }
+  size_t length = sizeof(record);
+  esp_err_t err = nvs_get_blob(handle, key_, &record, &length);
+  nvs_close(handle);
+  if (err != ESP_OK || length != sizeof(record) || record.version != DeviceCacheRecord::VERSION) {
+    UPS_HID_LOGD(CACHE_TAG, "No usable cache record %s (%s)", key_, esp_err_to_name(err));
+    return false;
+  }
+  return true;
+}
+
+bool DeviceCache::store(const DeviceCacheRecord &record) {
+  if (!selected()) {
+    return false;
+  }
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(CACHE_NAMESPACE, NVS_READWRITE, &handle);
+  if (err == ESP_OK) {
+    err = nvs_set_blob(handle, key_, &record, sizeof(record));
+    if (err == ESP_OK) {
+      err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+  }
+  if (err != ESP_OK) {
+    ESP_LOGW(CACHE_TAG, "Failed to store cache record %s: %s", key_, esp_err_to_name(err));
+    return false;
+  }
+  ESP_LOGI(CACHE_TAG, "Stored discovery cache record %s (%zu bytes)", key_, sizeof(record));
+  return true;
+}
+
+void DeviceCache::erase() {
+  if (!selected()) {
+    return;
+  }
+  nvs_handle_t handle;
+  if (nvs_open(CACHE_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK) {
+    if (nvs_erase_key(handle, key_) == ESP_OK) {
+      nvs_commit(handle);
+    }
+    nvs_close(handle);
+  }
+}
+#else
+bool DeviceCache::load(DeviceCacheRecord &record) const { return false; }
+bool DeviceCache::store(const DeviceCacheRecord &record) { return false; }
+void DeviceCache::erase() {}
+#endif
+
+}  // namespace ups_hid
+}  // namespace esphome
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "constants_ups.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace esphome {
+namespace ups_hid {
+
+// What a protocol learned while probing, restored instead of probing again
+struct ProtocolDiscovery {
+  struct ReportSize {
+    uint8_t report_id;
+    uint8_t size;
+  };
+
+  uint32_t input_reports[8];    // Bitset of report IDs answering as Input
+  uint32_t feature_reports[8];  // Bitset of report IDs answering as Feature
+  ReportSize report_sizes[limits::MAX_CACHED_REPORT_SIZES];
+  uint8_t report_size_count;
+  float battery_voltage_scale;  // 0 until the protocol has checked it
+
+  static bool test(const uint32_t *bits, uint8_t id) { return (bits[id >> 5] >> (id & 31)) & 1u; }
+  static void set(uint32_t *bits, uint8_t id) { bits[id >> 5] |= 1u << (id & 31); }
+};
+
+// One NVS record per physical unit
+struct DeviceCacheRecord {
+  static constexpr uint16_t VERSION = 1;
+
+  uint16_t version;
+  uint16_t vendor_id;
+  uint16_t product_id;
+  uint8_t protocol;  // DeviceInfo::DetectedProtocol
+  char protocol_name[24];
+  ProtocolDiscovery discovery;
+  // Nominal ratings, so the first snapshot after a reconnect already has them
+  float input_voltage_nominal;
+  float output_voltage_nominal;
+  float battery_voltage_nominal;
+  float realpower_nominal;
+  float apparent_power_nominal;
+};
+
+static_assert(std::is_trivially_copyable<DeviceCacheRecord>::value, "DeviceCacheRecord is stored as a blob");
+
+/**
+ * Discovery results persisted in NVS, keyed by VID/PID/serial
+ *
+ * After a USB reset or re-plug the component restores the protocol and its
+ * probed report map from here instead of running detection again. Records
+ * are cleared (all bytes zero) before being filled so they compare with
+ * memcmp, and a record is only rewritten when it changed. Stores are
+ * no-ops outside ESP32.
+ */
+class DeviceCache {
+ public:
+  // Selects the record for one unit; serial may be empty
+  void select(uint16_t vendor_id, uint16_t product_id, const std::string &serial);
+  bool selected() const { return key_[0] != '\0'; }
+  const char *key() const { return key_; }
+
+  bool load(DeviceCacheRecord &record) const;
+  bool store(const DeviceCacheRecord &record);
+  void erase();
+
+ protected:
+  char key_[16]{};  // NVS keys are at most 15 characters
+};
+
+}  // namespace ups_hid
+}  // namespace esphome
@@ -0,0 +1,398 @@
+#include "hid_descriptor.h"
+#include "constants_hid.h"
+#include "constants_ups.h"
+#include "log_ups.h"
+#include <algorithm>
+#include <cmath>
+
+namespace esphome {
+namespace ups_hid {
+
+static const char *const HID_DESC_TAG = "ups_hid.descriptor";
+
+// Item types and tags (HID 1.11 section 6.2.2.4 - 6.2.2.8)
+static constexpr uint8_t ITEM_TYPE_MAIN = 0;
+static constexpr uint8_t ITEM_TYPE_GLOBAL = 1;
+static constexpr uint8_t ITEM_TYPE_LOCAL = 2;
+static constexpr uint8_t ITEM_LONG_PREFIX = 0xFE;
+
+static constexpr uint8_t MAIN_INPUT = 0x8;
+static constexpr uint8_t MAIN_OUTPUT = 0x9;
+static constexpr uint8_t MAIN_COLLECTION = 0xA;
+static constexpr uint8_t MAIN_FEATURE = 0xB;
+static constexpr uint8_t MAIN_END_COLLECTION = 0xC;
+
+static constexpr uint8_t GLOBAL_USAGE_PAGE = 0x0;
+static constexpr uint8_t GLOBAL_LOGICAL_MIN = 0x1;
+static constexpr uint8_t GLOBAL_LOGICAL_MAX = 0x2;
+static constexpr uint8_t GLOBAL_PHYSICAL_MIN = 0x3;
+static constexpr uint8_t GLOBAL_PHYSICAL_MAX = 0x4;
+static constexpr uint8_t GLOBAL_UNIT_EXPONENT = 0x5;
+static constexpr uint8_t GLOBAL_UNIT = 0x6;
+static constexpr uint8_t GLOBAL_REPORT_SIZE = 0x7;
+static constexpr uint8_t GLOBAL_REPORT_ID = 0x8;
+static constexpr uint8_t GLOBAL_REPORT_COUNT = 0x9;
+static constexpr uint8_t GLOBAL_PUSH = 0xA;
+static constexpr uint8_t GLOBAL_POP = 0xB;
+
+static constexpr uint8_t LOCAL_USAGE = 0x0;
+static constexpr uint8_t LOCAL_USAGE_MIN = 0x1;
+static constexpr uint8_t LOCAL_USAGE_MAX = 0x2;
+
+// Main item data bits
+static constexpr uint32_t MAIN_FLAG_CONSTANT = 0x01;
+static constexpr uint32_t MAIN_FLAG_VARIABLE = 0x02;
+
+// Unit system nibble for SI linear (HID 1.11 section 6.2.2.7)
+static constexpr uint32_t UNIT_SYSTEM_SI_LINEAR = 0x1;
+
+namespace {
+
+struct GlobalState {
+    uint16_t usage_page{0};
+    int32_t logical_min{0};
+    int32_t logical_max{0};
+    int32_t physical_min{0};
+    int32_t physical_max{0};
+    int8_t unit_exponent{0};
+    uint32_t unit{0};
+    uint32_t report_size{0};
+    uint8_t report_id{0};
+    uint32_t report_count{0};
+};
+
+struct ReportCursor {
+    uint8_t report_type;
+    uint8_t report_id;
+    uint32_t bits;
+};
+
+int32_t sign_extend(uint32_t value, uint8_t size) {
+    switch (size) {
+        case 1: return static_cast<int8_t>(value);
+        case 2: return static_cast<int16_t>(value);
+        default: return static_cast<int32_t>(value);
+    }
+}
+
+int8_t nibble_to_signed(uint32_t nibble) {
+    nibble &= 0xF;
+    return static_cast<int8_t>(nibble > 7 ? static_cast<int>(nibble) - 16 : static_cast<int>(nibble));
+}
+
+} // namespace
+
+void HidReportDescriptor::clear() {
+    fields_.clear();
+    reports_.clear();
+    collections_.clear();
+    uses_report_ids_ = false;
+}
+
+bool HidReportDescriptor::parse(const uint8_t* data, size_t len) {
+    clear();
+    if (!data || len == 0 || len > limits::MAX_REPORT_DESCRIPTOR_SIZE) {
+        ESP_LOGW(HID_DESC_TAG, "Invalid report descriptor length: %zu", len);
+        return false;
+    }
+
+    GlobalState global;
+    GlobalState global_stack[4];
+    size_t global_depth = 0;
+
+    std::vector<uint32_t> usages;
+    uint32_t usage_min = 0;
+    uint32_t usage_max = 0;
+    bool has_usage_range = false;
+
+    int16_t collection_stack[limits::MAX_HID_COLLECTION_DEPTH];
+    size_t collection_depth = 0;
+
+    std::vector<ReportCursor> cursors;
+    bool truncated = false;
+
+    auto extended_usage = [&](uint32_t value, uint8_t size) -> uint32_t {
+        return size == 4 ? value : HID_USAGE(global.usage_page, value & 0xFFFF);
+    };
+
+    auto cursor_for = [&](uint8_t report_type, uint8_t report_id) -> uint32_t& {
+        for (auto &cursor : cursors) {
+            if (cursor.report_type == report_type && cursor.report_id == report_id) {
+                return cursor.bits;
+            }
+        }
+        cursors.push_back({report_type, report_id, 0});
+        return cursors.back().bits;
+    };
+
+    size_t pos = 0;
+    while (pos < len) {
+        const uint8_t prefix = data[pos++];
+
+        if (prefix == ITEM_LONG_PREFIX) {
+            // Long items carry their own size and are unused by power devices
+            if (pos >= len) break;
+            pos += 2 + data[pos];
+            continue;
+        }
+
+        uint8_t size = prefix & 0x03;
+        if (size == 3) size = 4;
+        const uint8_t type = (prefix >> 2) & 0x03;
+        const uint8_t tag = prefix >> 4;
+
+        if (pos + size > len) {
+            ESP_LOGW(HID_DESC_TAG, "Report descriptor truncated at offset %zu", pos - 1);
+            break;
+        }
+
+        uint32_t value = 0;
+        for (uint8_t i = 0; i < size; i++) {
+            value |= static_cast<uint32_t>(data[pos + i]) << (8 * i);
+        }
+        pos += size;
+
+        if (type == ITEM_TYPE_MAIN) {
+            switch (tag) {
+                case MAIN_INPUT:
+                case MAIN_OUTPUT:
+                case MAIN_FEATURE: {
+                    const uint8_t report_type = tag == MAIN_INPUT ? HID_REPORT_TYPE_INPUT
+                                              : tag == MAIN_OUTPUT ? HID_REPORT_TYPE_OUTPUT
+                                              : HID_REPORT_TYPE_FEATURE;
+                    uint32_t &bits = cursor_for(report_type, global.report_id);
+                    const bool is_data_variable = !(value & MAIN_FLAG_CONSTANT) && (value & MAIN_FLAG_VARIABLE);
+                    const bool extractable = global.report_size > 0 && global.report_size <= 32;
+
+                    if (is_data_variable && extractable) {
+                        // If pmin and pmax are both zero the physical range equals the logical range
+                        const bool physical_defined = global.physical_min != 0 || global.physical_max != 0;
+                        for (uint32_t i = 0; i < global.report_count; i++) {
+                            uint32_t usage = 0;
+                            if (has_usage_range) {
+                                usage = std::min(usage_min + i, usage_max);
+                            } else if (!usages.empty()) {
+                                // Extra fields reuse the last usage (HID 1.11 section 6.2.2.8)
+                                usage = usages[std::min<size_t>(i, usages.size() - 1)];
+                            }
+
+                            if (fields_.size() >= limits::MAX_HID_DESCRIPTOR_FIELDS) {
+                                truncated = true;
+                                break;
+                            }
+
+                            HidField field;
+                            field.usage = usage;
+                            field.logical_min = global.logical_min;
+                            field.logical_max = global.logical_max;
+                            field.physical_min = physical_defined ? global.physical_min : global.logical_min;
+                            field.physical_max = physical_defined ? global.physical_max : global.logical_max;
+                            field.unit = global.unit;
+                            field.unit_exponent = global.unit_exponent;
+                            field.bit_offset = static_cast<uint16_t>(bits + i * global.report_size);
+                            field.bit_size = static_cast<uint8_t>(global.report_size);
+                            field.report_id = global.report_id;
+                            field.report_type = report_type;
+                            field.collection = collection_depth > 0 ? collection_stack[collection_depth - 1] : -1;
+                            fields_.push_back(field);
+                        }
+                    }
+                    // Padding, constants and arrays only occupy space in the report
+                    bits += global.report_size * global.report_count;
+                    break;
+                }
+
+                case MAIN_COLLECTION: {
+                    HidCollection collection;
+                    collection.usage = usages.empty() ? (has_usage_range ? usage_min : 0) : usages.front();
+                    collection.parent = collection_depth > 0 ? collection_stack[collection_depth - 1] : -1;
+                    collections_.push_back(collection);
+                    if (collection_depth < limits::MAX_HID_COLLECTION_DEPTH) {
+                        collection_stack[collection_depth++] = static_cast<int16_t>(collections_.size() - 1);
+                    } else {
+                        ESP_LOGW(HID_DESC_TAG, "Collection nesting exceeds %zu levels",
+                                 limits::MAX_HID_COLLECTION_DEPTH);
+                    }
+                    break;
+                }
+
+                case MAIN_END_COLLECTION:
+                    if (collection_depth > 0) collection_depth--;
+                    break;
+
+                default:
+                    break;
+            }
+
+            // Local items only apply to the next main item
+            usages.clear();
+            has_usage_range = false;
+            usage_min = usage_max = 0;
+
+        } else if (type == ITEM_TYPE_GLOBAL) {
+            switch (tag) {
+                case GLOBAL_USAGE_PAGE: global.usage_page = static_cast<uint16_t>(value); break;
+                case GLOBAL_LOGICAL_MIN: global.logical_min = sign_extend(value, size); break;
+                case GLOBAL_LOGICAL_MAX: global.logical_max = sign_extend(value, size); break;
+                case GLOBAL_PHYSICAL_MIN: global.physical_min = sign_extend(value, size); break;
+                case GLOBAL_PHYSICAL_MAX: global.physical_max = sign_extend(value, size); break;
+                case GLOBAL_UNIT_EXPONENT:
+                    // Encoded as a 4-bit two's complement nibble
+                    global.unit_exponent = value <= 0xF ? nibble_to_signed(value)
+                                                        : static_cast<int8_t>(sign_extend(value, size));
+                    break;
+                case GLOBAL_UNIT: global.unit = value; break;
+                case GLOBAL_REPORT_SIZE: global.report_size = value; break;
+                case GLOBAL_REPORT_ID:
+                    global.report_id = static_cast<uint8_t>(value);
+                    uses_report_ids_ = true;
+                    break;
+                case GLOBAL_REPORT_COUNT: global.report_count = value; break;
+                case GLOBAL_PUSH:
+                    if (global_depth < sizeof(global_stack) / sizeof(global_stack[0])) {
+                        global_stack[global_depth++] = global;
+                    }
+                    break;
+                case GLOBAL_POP:
+                    if (global_depth > 0) {
+                        global = global_stack[--global_depth];
+                    }
+                    break;
+                default:
+                    break;
+            }
+
+            // Descriptors commonly give an unsigned maximum with a one-byte item
+            // (e.g. 0xFF for 0..255); keep it unsigned when the minimum is not negative
+            if (tag == GLOBAL_LOGICAL_MAX && global.logical_min >= 0 && global.logical_max < 0) {
+                global.logical_max = static_cast<int32_t>(value);
+            }
+            if (tag == GLOBAL_PHYSICAL_MAX && global.physical_min >= 0 && global.physical_max < 0) {
+                global.physical_max = static_cast<int32_t>(value);
+            }
+
+        } else if (type == ITEM_TYPE_LOCAL) {
+            switch (tag) {
+                case LOCAL_USAGE: usages.push_back(extended_usage(value, size)); break;
+                case LOCAL_USAGE_MIN: usage_min = extended_usage(value, size); has_usage_range = true; break;
+                case LOCAL_USAGE_MAX: usage_max = extended_usage(value, size); has_usage_range = true; break;
+                default: break;
+            }
+        }
+    }
+
+    if (truncated) {
+        ESP_LOGW(HID_DESC_TAG, "Report descriptor has more than %zu fields, remainder ignored",
+                 limits::MAX_HID_DESCRIPTOR_FIELDS);
+    }
+
+    build_report_index();
+
+    UPS_HID_LOGD(HID_DESC_TAG, "Parsed report descriptor: %zu bytes, %zu fields, %zu reports, %zu collections",
+             len, fields_.size(), reports_.size(), collections_.size());
+    return !fields_.empty();
+}
+
+void HidReportDescriptor::build_report_index() {
+    // Group fields by report so a decode pass touches one contiguous run
+    std::stable_sort(fields_.begin(), fields_.end(), [](const HidField& a, const HidField& b) {
+        if (a.report_type != b.report_type) return a.report_type < b.report_type;
+        return a.report_id < b.report_id;
+    });
+
+    reports_.clear();
+    for (size_t i = 0; i < fields_.size(); i++) {
+        const HidField &field = fields_[i];
+        if (reports_.empty() || reports_.back().report_type != field.report_type ||
+            reports_.back().report_id != field.report_id) {
+            HidReportInfo info;
+            info.report_type = field.report_type;
+            info.report_id = field.report_id;
+            info.first_field = static_cast<uint16_t>(i);
+            reports_.push_back(info);
+        }
+        HidReportInfo &info = reports_.back();
+        info.field_count++;
+        info.bit_length = std::max<uint16_t>(info.bit_length, field.bit_offset + field.bit_size);
+    }
+}
+
+bool HidReportDescriptor::has_usage_page(uint16_t page) const {
+    for (const auto &collection : collections_) {
+        if ((collection.usage >> 16) == page) return true;
+    }
+    for (const auto &field : fields_) {
+        if ((field.usage >> 16) == page) return true;
+    }
+    return false;
+}
+
+const HidReportInfo* HidReportDescriptor::find_report(uint8_t report_type, uint8_t report_id) const {
+    for (const auto &info : reports_) {
+        if (info.report_type == report_type && info.report_id == report_id) {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+bool HidReportDescriptor::in_collection(const HidField& field, uint32_t collection_usage) const {
+    int32_t index = field.collection;
+    while (index >= 0 && static_cast<size_t>(index) < collections_.size()) {
+        if (collections_[index].usage == collection_usage) return true;
+        index = collections_[index].parent;
+    }
+    return false;
+}
+
+bool HidReportDescriptor::extract(const HidField& field, const uint8_t* report, size_t len,
+                                  bool has_report_id, int32_t& raw) {
+    if (!report || field.bit_size == 0) return false;
+
+    const size_t payload = has_report_id ? 1 : 0;
+    const size_t first_byte = payload + field.bit_offset / 8;
+    const uint8_t shift = field.bit_offset % 8;
+    const size_t byte_count = (shift + field.bit_size + 7) / 8;
+    if (first_byte + byte_count > len) return false;
+
+    // A field of up to 32 bits spans at most 5 bytes
+    uint64_t window = 0;
+    for (size_t i = 0; i < byte_count; i++) {
+        window |= static_cast<uint64_t>(report[first_byte + i]) << (8 * i);
+    }
+    uint32_t value = static_cast<uint32_t>(window >> shift);
+    if (field.bit_size < 32) {
+        value &= (1u << field.bit_size) - 1;
+        if (field.logical_min < 0 && (value & (1u << (field.bit_size - 1)))) {
+            value |= ~((1u << field.bit_size) - 1);
+        }
+    }
+    raw = static_cast<int32_t>(value);
+    return true;
+}
+
+float HidReportDescriptor::to_physical(const HidField& field, int32_t raw) {
+    float value = static_cast<float>(raw);
+    if (field.logical_max != field.logical_min &&
+        (field.physical_min != field.logical_min || field.physical_max != field.logical_max)) {
+        const float scale = static_cast<float>(field.physical_max - field.physical_min) /
+                            static_cast<float>(field.logical_max - field.logical_min);
+        value = field.physical_min + (value - field.logical_min) * scale;
+    }
+
+    int exponent = field.unit_exponent;
+    if ((field.unit & 0xF) == UNIT_SYSTEM_SI_LINEAR) {
+        // SI linear is defined in centimetres and grams; volts, watts and
+        // amperes therefore carry 10^-7 style corrections
+        const int length = nibble_to_signed(field.unit >> 4);
+        const int mass = nibble_to_signed(field.unit >> 8);
+        exponent -= 2 * length + 3 * mass;
+    }
+    if (exponent != 0) {
+        value *= std::pow(10.0f, static_cast<float>(exponent));
+    }
+    return value;
+}
+
+} // namespace ups_hid
+} // namespace esphome
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace ups_hid {
+
+/**
+ * One variable field of an Input, Output or Feature report, flattened from
+ * the report descriptor. Offsets are relative to the first payload byte,
+ * i.e. after the report ID prefix when the device uses report IDs.
+ */
+struct HidField {
+    uint32_t usage{0};          // Extended usage, see HID_USAGE()
+    int32_t logical_min{0};
+    int32_t logical_max{0};
+    int32_t physical_min{0};
+    int32_t physical_max{0};
+    uint32_t unit{0};
+    uint16_t bit_offset{0};
+    int16_t collection{-1};     // Innermost enclosing collection (index into collections())
+    uint8_t report_id{0};
+    uint8_t report_type{0};     // HID_REPORT_TYPE_INPUT / OUTPUT / FEATURE
+    uint8_t bit_size{0};
+    int8_t unit_exponent{0};
+};
+
+struct HidCollection {
+    uint32_t usage{0};
+    int16_t parent{-1};
+};
+
+// Contiguous run of fields belonging to one (report_type, report_id)
+struct HidReportInfo {
+    uint8_t report_type{0};
+    uint8_t report_id{0};
+    uint16_t first_field{0};
+    uint16_t field_count{0};
+    uint16_t bit_length{0};
+};
+
+/**
+ * HID Report Descriptor
+ *
+ * Parses a raw report descriptor (HID 1.11 section 6.2.2) once into flat
+ * field and report tables. Decoding a report is then a table walk with one
+ * bit extraction per field; no vendor knowledge is involved.
+ *
+ * Array fields and constant (padding) fields are skipped; UPS power device
+ * values are always variables.
+ */
+class HidReportDescriptor {
+public:
+    bool parse(const uint8_t* data, size_t len);
+    void clear();
+
+    bool empty() const { return fields_.empty(); }
+    bool uses_report_ids() const { return uses_report_ids_; }
+    bool has_usage_page(uint16_t page) const;
+
+    const std::vector<HidField>& fields() const { return fields_; }
+    const std::vector<HidReportInfo>& reports() const { return reports_; }
+    const std::vector<HidCollection>& collections() const { return collections_; }
+
+    const HidReportInfo* find_report(uint8_t report_type, uint8_t report_id) const;
+    
+    // Heap held by the parsed tables
+    size_t memory_usage() const {
+        return fields_.capacity() * sizeof(HidField) + reports_.capacity() * sizeof(HidReportInfo) +
+               collections_.capacity() * sizeof(HidCollection);
+    }
+
+    // True if the field sits anywhere inside a collection with this usage
+    bool in_collection(const HidField& field, uint32_t collection_usage) const;
+
+    // Raw logical value of a field from a report buffer as returned by GET_REPORT;
+    // has_report_id skips the leading report ID byte
+    static bool extract(const HidField& field, const uint8_t* report, size_t len,
+                        bool has_report_id, int32_t& raw);
+
+    // Logical value converted to physical units, with unit exponent applied and
+    // HID's CGS-based SI units (cm, g) normalised to metres and kilograms
+    static float to_physical(const HidField& field, int32_t raw);
+
+private:
+    std::vector<HidField> fields_;
+    std::vector<HidReportInfo> reports_;
+    std::vector<HidCollection> collections_;
+    bool uses_report_ids_{false};
+
+    void build_report_index();
+};
+
+} // namespace ups_hid
+} // namespace esphome
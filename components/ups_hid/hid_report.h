@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <bitset>
+#include "constants_hid.h"
+#include "constants_ups.h"
+
+namespace esphome {
+namespace ups_hid {
+
+// Read-only view over report bytes, report ID in byte 0 as returned by GET_REPORT
+class HidReportView {
+ public:
+  constexpr HidReportView() = default;
+  constexpr HidReportView(const uint8_t *data, size_t size) : data_(data), size_(size) {}
+
+  const uint8_t *data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  uint8_t operator[](size_t index) const { return data_[index]; }
+  const uint8_t *begin() const { return data_; }
+  const uint8_t *end() const { return data_ + size_; }
+
+ private:
+  const uint8_t *data_{nullptr};
+  size_t size_{0};
+};
+
+// Fixed-capacity inline report storage sized for a full-speed HID report.
+// Mirrors the parts of std::vector the parsers use, without heap allocation.
+class HidReportBuffer {
+ public:
+  static constexpr size_t CAPACITY = limits::MAX_HID_REPORT_SIZE;
+
+  uint8_t *data() { return bytes_; }
+  const uint8_t *data() const { return bytes_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  static constexpr size_t capacity() { return CAPACITY; }
+
+  uint8_t &operator[](size_t index) { return bytes_[index]; }
+  uint8_t operator[](size_t index) const { return bytes_[index]; }
+  const uint8_t *begin() const { return bytes_; }
+  const uint8_t *end() const { return bytes_ + size_; }
+
+  void clear() { size_ = 0; }
+  // Growing zero-fills; sizes beyond CAPACITY are clamped
+  void resize(size_t size) {
+    size = std::min(size, CAPACITY);
+    if (size > size_) {
+      memset(bytes_ + size_, 0, size - size_);
+    }
+    size_ = static_cast<uint8_t>(size);
+  }
+  // Commit the length after filling data() in place (e.g. by hid_get_report)
+  void set_size(size_t size) { size_ = static_cast<uint8_t>(std::min(size, CAPACITY)); }
+  void assign(const uint8_t *first, const uint8_t *last) {
+    size_ = static_cast<uint8_t>(std::min(static_cast<size_t>(last - first), CAPACITY));
+    memcpy(bytes_, first, size_);
+  }
+
+  HidReportView view() const { return HidReportView(bytes_, size_); }
+  operator HidReportView() const { return view(); }
+
+ private:
+  uint8_t bytes_[CAPACITY];
+  uint8_t size_{0};
+};
+
+struct HidReport {
+  uint8_t report_id{0};
+  HidReportBuffer data;
+
+  HidReportView view() const { return data.view(); }
+};
+
+// Answers collected by the shared detection round: which report IDs were
+// asked for, which answered as Input or Feature reports, and their lengths
+class ProbeResults {
+ public:
+  void record(uint8_t report_id, uint8_t report_type, size_t length) {
+    probed_.set(report_id);
+    (report_type == HID_REPORT_TYPE_INPUT ? input_ : feature_).set(report_id);
+    if (lengths_[report_id] == 0) {
+      lengths_[report_id] = static_cast<uint8_t>(std::min(length, limits::MAX_HID_REPORT_SIZE));
+    }
+  }
+  void mark_probed(uint8_t report_id) { probed_.set(report_id); }
+
+  bool probed(uint8_t report_id) const { return probed_[report_id]; }
+  bool answered(uint8_t report_id) const { return input_[report_id] || feature_[report_id]; }
+  bool answered_input(uint8_t report_id) const { return input_[report_id]; }
+  bool answered_feature(uint8_t report_id) const { return feature_[report_id]; }
+  size_t length(uint8_t report_id) const { return lengths_[report_id]; }
+  // Of the given IDs, how many answered
+  size_t count_answered(const uint8_t *report_ids, size_t count) const {
+    size_t answered_count = 0;
+    for (size_t i = 0; i < count; i++) {
+      answered_count += answered(report_ids[i]) ? 1 : 0;
+    }
+    return answered_count;
+  }
+
+ private:
+  std::bitset<256> probed_;
+  std::bitset<256> input_;
+  std::bitset<256> feature_;
+  uint8_t lengths_[256]{};
+};
+
+}  // namespace ups_hid
+}  // namespace esphome
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "esphome/core/log.h"
+
+// Log ceiling of the ups_hid component, set by the debug_level option.
+// UPS_HID_LOGD/UPS_HID_LOGV and code guarded by UPS_HID_LOG_DEBUG_ENABLED
+// compile out below it, even when the logger itself runs at DEBUG; without
+// the option the logger level applies as for ESP_LOGD/ESP_LOGV.
+#ifndef UPS_HID_LOG_LEVEL
+#define UPS_HID_LOG_LEVEL ESPHOME_LOG_LEVEL
+#endif
+
+#if UPS_HID_LOG_LEVEL >= ESPHOME_LOG_LEVEL_DEBUG && ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_DEBUG
+#define UPS_HID_LOG_DEBUG_ENABLED 1
+#define UPS_HID_LOGD(tag, ...) ESP_LOGD(tag, __VA_ARGS__)
+#else
+#define UPS_HID_LOG_DEBUG_ENABLED 0
+#define UPS_HID_LOGD(tag, ...) do {} while (0)
+#endif
+
+#if UPS_HID_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERBOSE && ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERBOSE
+#define UPS_HID_LOG_VERBOSE_ENABLED 1
+#define UPS_HID_LOGV(tag, ...) ESP_LOGV(tag, __VA_ARGS__)
+#else
+#define UPS_HID_LOG_VERBOSE_ENABLED 0
+#define UPS_HID_LOGV(tag, ...) do {} while (0)
+#endif
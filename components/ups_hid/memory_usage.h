@@ -0,0 +1,52 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#ifdef USE_ESP32
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+namespace esphome {
+namespace ups_hid {
+
+// Memory held by one component, as listed in dump_config() and the memory sensors
+struct MemoryUsage {
+    size_t static_bytes{0};   // The component object itself, allocated once at startup
+    size_t dynamic_bytes{0};  // Heap held now: protocol, transport buffers, containers
+    size_t dynamic_peak{0};   // Largest dynamic_bytes seen
+};
+
+// Heap taken by the standard containers, estimated from their sizes. Tree
+// nodes carry three pointers and a colour word besides the value.
+static constexpr size_t TREE_NODE_OVERHEAD = 4 * sizeof(void*);
+// Characters libstdc++ keeps inside the std::string object
+static constexpr size_t STRING_INLINE_CAPACITY = 15;
+
+template<typename T> size_t heap_bytes(const std::vector<T>& values) { return values.capacity() * sizeof(T); }
+template<typename K> size_t heap_bytes(const std::set<K>& values) {
+    return values.size() * (sizeof(K) + TREE_NODE_OVERHEAD);
+}
+template<typename K, typename V> size_t heap_bytes(const std::map<K, V>& values) {
+    return values.size() * (sizeof(std::pair<const K, V>) + TREE_NODE_OVERHEAD);
+}
+inline size_t heap_bytes(const std::string& value) {
+    return value.capacity() > STRING_INLINE_CAPACITY ? value.capacity() + 1 : 0;
+}
+
+#ifdef USE_ESP32
+// Smallest amount of stack the task has had left, in bytes; 0 without a task.
+// ESP-IDF counts stacks in bytes, so the high-water mark needs no scaling.
+inline uint32_t task_stack_free(TaskHandle_t task) {
+    return task != nullptr ? uxTaskGetStackHighWaterMark(task) * sizeof(StackType_t) : 0;
+}
+#endif
+
+} // namespace ups_hid
+} // namespace esphome
@@ -1,11 +1,12 @@
 #include "protocol_apc.h"
 #include "constants_hid.h"
 #include "constants_ups.h"
-#include "esphome/core/log.h"
+#include "log_ups.h"
 #include "esphome/core/helpers.h"
 #include <cstring>
-#include <regex>
+#include <cctype>
 #include <algorithm>
+#include <iterator>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/portmacro.h"
@@ -42,6 +43,67 @@ static const uint8_t APC_REPORT_ID_LOAD_PERCENT = 0x50;    // UPS.PowerConverter
 static const uint8_t APC_REPORT_ID_OUTPUT_VOLTAGE = 0x09;  // PowerSummary.Voltage (legacy)
 static const uint8_t APC_REPORT_ID_FREQUENCY = 0x0D;       // Frequency information
 
+// APC Back-UPS ES Series Power Ratings (based on model identification)
+// Reference: APC product specifications and actual device testing.
+// Matched in order as case-insensitive substrings of the USB product string;
+// a new model is one more entry here.
+struct ApcPowerRating {
+  const char *model;
+  float watts;
+};
+static constexpr ApcPowerRating APC_POWER_RATINGS[] = {
+  {"back-ups es 350", 200.0f},   // 350VA ≈ 200W
+  {"back-ups es 425", 255.0f},   // 425VA ≈ 255W
+  {"back-ups es 500", 300.0f},   // 500VA ≈ 300W
+  {"back-ups es 550", 330.0f},   // 550VA ≈ 330W
+  {"back-ups es 650", 390.0f},   // 650VA ≈ 390W
+  {"back-ups es 700", 405.0f},   // 700VA ≈ 405W (confirmed from config), also 700G
+  {"back-ups es 750", 450.0f},   // 750VA ≈ 450W
+  {"back-ups es 850", 510.0f},   // 850VA ≈ 510W
+  {"back-ups es 900", 540.0f},   // 900VA ≈ 540W
+  {"back-ups es 1000", 600.0f},  // 1000VA ≈ 600W
+  {"back-ups es 1200", 720.0f},  // 1200VA ≈ 720W
+  {"back-ups es 1400", 840.0f},  // 1400VA ≈ 840W
+};
+
+// Whether pattern (lowercase) occurs in text, ignoring the case of text
+static bool contains_ignore_case(const std::string &text, const char *pattern) {
+  const char *pattern_end = pattern + strlen(pattern);
+  return std::search(text.begin(), text.end(), pattern, pattern_end, [](char a, char b) {
+           return std::tolower(static_cast<unsigned char>(a)) == b;
+         }) != text.end();
+}
+
+static bool is_word_char(char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }
+
+// First standalone number of 3 or 4 digits (a whole word, as the VA rating
+// in "Back-UPS 1500"), or 0 if there is none
+static int find_va_rating(const std::string &model) {
+  size_t i = 0;
+  while (i < model.size()) {
+    if (!is_word_char(model[i])) {
+      i++;
+      continue;
+    }
+    size_t word_end = i;
+    bool digits = true;
+    while (word_end < model.size() && is_word_char(model[word_end])) {
+      digits = digits && std::isdigit(static_cast<unsigned char>(model[word_end]));
+      word_end++;
+    }
+    const size_t length = word_end - i;
+    if (digits && length >= 3 && length <= 4) {
+      int value = 0;
+      for (size_t j = i; j < word_end; j++) {
+        value = value * 10 + (model[j] - '0');
+      }
+      return value;
+    }
+    i = word_end;
+  }
+  return 0;
+}
+
 // Extended configuration report IDs
 static const uint8_t APC_REPORT_ID_BATTERY_RUNTIME_LOW = 0x24; // Battery runtime low threshold
 static const uint8_t APC_REPORT_ID_BATTERY_VOLTAGE_NOMINAL = 0x25; // Battery voltage nominal
@@ -64,6 +126,60 @@ static const uint8_t APC_REPORT_ID_INPUT_TRANSFER_HIGH = 0x33; // Input high vol
 static const uint8_t APC_REPORT_ID_PANEL_TEST = 0x79;      // Panel/UPS test control
 static const uint8_t APC_REPORT_ID_BATTERY_TEST = 0x52;    // Battery test control (same as test result)
 
+// Detection probes based on NUT analysis - these are the critical ones
+static constexpr uint8_t APC_PROBE_REPORT_IDS[] = {
+  APC_REPORT_ID_POWER_SUMMARY,   // CRITICAL: PowerSummary.RemainingCapacity + RunTimeToEmpty (NUT primary data)
+  APC_REPORT_ID_PRESENT_STATUS,  // CRITICAL: PowerSummary.PresentStatus bitmap (status flags) 
+  APC_REPORT_ID_BATTERY,         // PowerSummary.APCStatusFlag (basic status byte)
+  APC_REPORT_ID_STATUS,          // Legacy status check
+  APC_REPORT_ID_OUTPUT_VOLTAGE   // PowerSummary.Voltage
+};
+
+// Fast poll, read as one batch. Indices below follow this order; the
+// frequency candidates close the list in priority order.
+static constexpr uint8_t APC_FAST_POLL_REPORT_IDS[] = {
+  APC_REPORT_ID_POWER_SUMMARY,
+  APC_REPORT_ID_PRESENT_STATUS,
+  APC_REPORT_ID_BATTERY,
+  APC_REPORT_ID_INPUT_VOLTAGE,
+  APC_REPORT_ID_LOAD_PERCENT,
+  APC_REPORT_ID_OUTPUT_VOLTAGE,
+  APC_REPORT_ID_BATTERY_VOLTAGE,
+  APC_REPORT_ID_TEST_RESULT,
+  APC_REPORT_ID_FREQUENCY,     // APC-specific config report (apparent power and frequency) - PRIORITY
+  HID_USAGE_POW_FREQUENCY,     // Standard HID frequency usage
+  HID_USAGE_POW_VOLTAGE,       // Input measurements (may include frequency)
+  HID_USAGE_POW_CURRENT,       // Output measurements (may include frequency)
+  HID_USAGE_POW_OUTPUT,        // Output collection (might contain frequency)
+  HID_USAGE_POW_INPUT,         // Input collection (might contain frequency)
+};
+static constexpr size_t APC_FAST_POLL_FREQUENCY_FIRST = 8;
+static constexpr size_t APC_FAST_POLL_REPORT_COUNT = sizeof(APC_FAST_POLL_REPORT_IDS);
+static_assert(APC_FAST_POLL_REPORT_COUNT <= limits::MAX_REPORT_BATCH, "APC fast poll exceeds one report batch");
+
+// Slow-changing settings and thresholds, one batch each
+static constexpr uint8_t APC_CONFIGURATION_REPORT_IDS[] = {
+  APC_REPORT_ID_AUDIBLE_ALARM,
+  APC_REPORT_ID_SENSITIVITY,
+};
+
+static constexpr uint8_t APC_DYNAMIC_VALUE_REPORT_IDS[] = {
+  APC_REPORT_ID_BATTERY_VOLTAGE_NOMINAL,
+  APC_REPORT_ID_INPUT_VOLTAGE_NOMINAL,
+  APC_REPORT_ID_INPUT_TRANSFER_LOW,
+  APC_REPORT_ID_INPUT_TRANSFER_HIGH,
+  APC_REPORT_ID_BATTERY_RUNTIME_LOW,
+  APC_REPORT_ID_MFR_DATE_UPS,
+  APC_REPORT_ID_MFR_DATE_BATTERY,
+  APC_REPORT_ID_DELAY_SHUTDOWN,
+  APC_REPORT_ID_DELAY_REBOOT,
+  APC_REPORT_ID_CHARGE_WARNING,
+  APC_REPORT_ID_CHARGE_LOW,
+  battery_chemistry::REPORT_ID,
+};
+static_assert(sizeof(APC_DYNAMIC_VALUE_REPORT_IDS) <= limits::MAX_REPORT_BATCH,
+              "APC dynamic values exceed one report batch");
+
 // Status bit masks
 static const uint8_t APC_STATUS_AC_PRESENT = 0x01;        // Bit 0: AC present
 static const uint8_t APC_STATUS_CHARGING = 0x04;          // Bit 2: Charging
@@ -104,36 +220,27 @@ static std::string convert_apc_date(uint32_t apc_date) {
 ApcHidProtocol::ApcHidProtocol(UpsHidComponent *parent) : UpsProtocolBase(parent) {}
 
 bool ApcHidProtocol::detect() {
-  ESP_LOGD(APC_HID_TAG, "Detecting APC HID Protocol...");
+  UPS_HID_LOGD(APC_HID_TAG, "Detecting APC HID Protocol...");
   
   // Check device connection status first
   if (!parent_->is_device_connected()) {
-    ESP_LOGD(APC_HID_TAG, "Device not connected, skipping protocol detection");
+    UPS_HID_LOGD(APC_HID_TAG, "Device not connected, skipping protocol detection");
     return false;
   }
   
   // Give device time to initialize after connection
   vTaskDelay(pdMS_TO_TICKS(timing::USB_INITIALIZATION_DELAY_MS));
   
-  // Try key report IDs based on NUT analysis - these are the critical ones
-  const uint8_t test_report_ids[] = {
-    APC_REPORT_ID_POWER_SUMMARY,   // CRITICAL: PowerSummary.RemainingCapacity + RunTimeToEmpty (NUT primary data)
-    APC_REPORT_ID_PRESENT_STATUS,  // CRITICAL: PowerSummary.PresentStatus bitmap (status flags) 
-    APC_REPORT_ID_BATTERY,         // PowerSummary.APCStatusFlag (basic status byte)
-    APC_REPORT_ID_STATUS,          // Legacy status check
-    APC_REPORT_ID_OUTPUT_VOLTAGE   // PowerSummary.Voltage
-  };
-  
   HidReport test_report;
   
-  for (uint8_t report_id : test_report_ids) {
+  for (uint8_t report_id : APC_PROBE_REPORT_IDS) {
     // Check device connection before each report attempt
     if (!parent_->is_device_connected()) {
-      ESP_LOGD(APC_HID_TAG, "Device disconnected during protocol detection");
+      UPS_HID_LOGD(APC_HID_TAG, "Device disconnected during protocol detection");
       return false;
     }
     
-    ESP_LOGD(APC_HID_TAG, "Testing report ID 0x%02X...", report_id);
+    UPS_HID_LOGD(APC_HID_TAG, "Testing report ID 0x%02X...", report_id);
     
     if (read_hid_report(report_id, test_report)) {
       ESP_LOGI(APC_HID_TAG, "SUCCESS: APC HID Protocol detected with report ID 0x%02X (%zu bytes)", 
@@ -145,12 +252,17 @@ bool ApcHidProtocol::detect() {
     vTaskDelay(pdMS_TO_TICKS(timing::REPORT_RETRY_DELAY_MS));
   }
   
-  ESP_LOGD(APC_HID_TAG, "APC HID Protocol detection failed - no reports responded");
+  UPS_HID_LOGD(APC_HID_TAG, "APC HID Protocol detection failed - no reports responded");
   return false;
 }
 
+size_t ApcHidProtocol::get_probe_report_ids(const uint8_t **report_ids) const {
+  *report_ids = APC_PROBE_REPORT_IDS;
+  return sizeof(APC_PROBE_REPORT_IDS);
+}
+
 bool ApcHidProtocol::initialize() {
-  ESP_LOGD(APC_HID_TAG, "Initializing APC HID Protocol...");
+  UPS_HID_LOGD(APC_HID_TAG, "Initializing APC HID Protocol...");
   
   // Initialize HID communication
   if (!init_hid_communication()) {
@@ -166,124 +278,119 @@ bool ApcHidProtocol::initialize() {
 }
 
 bool ApcHidProtocol::read_data(UpsData &data) {
-  ESP_LOGV(APC_HID_TAG, "Reading APC HID UPS data...");
+  // Full read of every group; the component normally schedules them separately
+  if (!read_report_group(ReportGroup::FAST, data)) {
+    // Leave manufacturer and model unset when HID communication fails
+    data.device.manufacturer.clear();
+    data.device.model.clear();
+    return false;
+  }
+  read_report_group(ReportGroup::STATIC, data);
+  read_report_group(ReportGroup::SLOW, data);
+  return true;
+}
+
+bool ApcHidProtocol::read_report_group(ReportGroup group, UpsData &data) {
+  switch (group) {
+    case ReportGroup::FAST:
+      return read_status_reports(data);
+    case ReportGroup::SLOW:
+      read_configuration(data);
+      read_missing_dynamic_values(data);
+      return true;
+    case ReportGroup::STATIC:
+      return read_identity(data);
+  }
+  return false;
+}
+
+bool ApcHidProtocol::read_status_reports(UpsData &data) {
+  UPS_HID_LOGV(APC_HID_TAG, "Reading APC HID UPS data...");
+  
+  // Input reports carry the real-time data (as NUT reads them); IDs that only
+  // answer as Feature reports are learned on the first poll
+  HidReport reports[APC_FAST_POLL_REPORT_COUNT];
+  read_reports(APC_FAST_POLL_REPORT_IDS, reports, APC_FAST_POLL_REPORT_COUNT, HID_REPORT_TYPE_INPUT);
+  const HidReport &power_summary_report = reports[0];
+  const HidReport &present_status_report = reports[1];
+  const HidReport &apc_status_report = reports[2];
+  const HidReport &input_voltage_report = reports[3];
+  const HidReport &load_report = reports[4];
+  const HidReport &voltage_report = reports[5];
+  const HidReport &battery_voltage_report = reports[6];
+  const HidReport &test_result_report = reports[7];
   
   bool success = false;
   
-  // CRITICAL FIX: Read NUT-compatible reports in the correct order first
+  // CRITICAL FIX: Parse NUT-compatible reports in the correct order first
   // Device info will be read after successful HID communication
   
-  // 1. Read PowerSummary report (MOST IMPORTANT - battery % + runtime)
-  HidReport power_summary_report;
-  if (read_hid_report(APC_REPORT_ID_POWER_SUMMARY, power_summary_report)) {
+  // 1. PowerSummary report (MOST IMPORTANT - battery % + runtime)
+  if (!power_summary_report.data.empty()) {
     parse_power_summary_report(power_summary_report, data);
     success = true;
   } else {
-    ESP_LOGV(APC_HID_TAG, "Failed to read PowerSummary report");
+    UPS_HID_LOGV(APC_HID_TAG, "Failed to read PowerSummary report");
   }
   
-  // 2. Read PresentStatus report (status bitmap - AC, charging, discharging, etc.)
-  HidReport present_status_report;
-  if (read_hid_report(APC_REPORT_ID_PRESENT_STATUS, present_status_report)) {
+  // 2. PresentStatus report (status bitmap - AC, charging, discharging, etc.)
+  if (!present_status_report.data.empty()) {
     parse_present_status_report(present_status_report, data);
     success = true;
   } else {
-    ESP_LOGV(APC_HID_TAG, "Failed to read PresentStatus report");
+    UPS_HID_LOGV(APC_HID_TAG, "Failed to read PresentStatus report");
   }
   
-  // 3. Read APCStatusFlag report (legacy status byte)
-  HidReport apc_status_report;
-  if (read_hid_report(APC_REPORT_ID_BATTERY, apc_status_report)) {
+  // 3. APCStatusFlag report (legacy status byte)
+  if (!apc_status_report.data.empty()) {
     parse_apc_status_report(apc_status_report, data);
     success = true;
   } else {
-    ESP_LOGV(APC_HID_TAG, "Failed to read APCStatusFlag report");
+    UPS_HID_LOGV(APC_HID_TAG, "Failed to read APCStatusFlag report");
   }
   
-  // 4. Read input voltage report (NUT: UPS.Input.Voltage) 
-  HidReport input_voltage_report;
-  if (read_hid_report(APC_REPORT_ID_INPUT_VOLTAGE, input_voltage_report)) {
+  // 4. Input voltage report (NUT: UPS.Input.Voltage) 
+  if (!input_voltage_report.data.empty()) {
     parse_input_voltage_report(input_voltage_report, data);
     success = true;
   } else {
-    ESP_LOGV(APC_HID_TAG, "Failed to read input voltage report");
+    UPS_HID_LOGV(APC_HID_TAG, "Failed to read input voltage report");
   }
   
-  // 5. Read load percentage report (NUT: UPS.PowerConverter.PercentLoad)
-  HidReport load_report;
-  if (read_hid_report(APC_REPORT_ID_LOAD_PERCENT, load_report)) {
+  // 5. Load percentage report (NUT: UPS.PowerConverter.PercentLoad)
+  if (!load_report.data.empty()) {
     parse_load_report(load_report, data);
     success = true;
   } else {
-    ESP_LOGV(APC_HID_TAG, "Failed to read load report");
+    UPS_HID_LOGV(APC_HID_TAG, "Failed to read load report");
   }
   
-  // 6. Read output voltage report (legacy voltage reading)
-  HidReport voltage_report;
-  if (read_hid_report(APC_REPORT_ID_OUTPUT_VOLTAGE, voltage_report)) {
+  // 6. Output voltage report (legacy voltage reading)
+  if (!voltage_report.data.empty()) {
     parse_voltage_report(voltage_report, data);
     success = true;
   } else {
-    ESP_LOGV(APC_HID_TAG, "Failed to read voltage report");
+    UPS_HID_LOGV(APC_HID_TAG, "Failed to read voltage report");
   }
   
-  // Set frequency to NaN - not available in debug logs for this APC model
-  // Try to read frequency from HID reports
-  read_frequency_data(data);
-  ESP_LOGV(APC_HID_TAG, "Frequency: Not available on this UPS model");
-  
-  // TIMING FIX: Only read USB string descriptors after successful HID communication
-  // This ensures the device is ready and responsive before attempting descriptor access
-  if (success) {
-    ESP_LOGD(APC_HID_TAG, "APC HID data read successful, now reading device info...");
-    
-    // Read manufacturer from USB Manufacturer string descriptor (index 3)
-    // NUT shows: UPS.PowerSummary.iManufacturer, Value: 3 → Manufacturer: "APC"
-    std::string manufacturer_string;
-    esp_err_t mfr_ret = parent_->usb_get_string_descriptor(3, manufacturer_string);
-    
-    if (mfr_ret == ESP_OK && !manufacturer_string.empty()) {
-      data.device.manufacturer = manufacturer_string;
-      ESP_LOGI(APC_HID_TAG, "Successfully read manufacturer from USB descriptor: \"%s\"", data.device.manufacturer.c_str());
-    } else {
-      data.device.manufacturer.clear();  // Set to unset state instead of hardcoded fallback
-      ESP_LOGW(APC_HID_TAG, "Failed to read USB Manufacturer descriptor: %s, leaving unset", esp_err_to_name(mfr_ret));
-    }
-    
-    // Read model from USB Product string descriptor (index 1)
-    // NUT shows: Product: "Back-UPS ES 700G" but need to parse out firmware info
-    std::string product_string;
-    esp_err_t prod_ret = parent_->usb_get_string_descriptor(1, product_string);
-    
-    if (prod_ret == ESP_OK && !product_string.empty()) {
-      // Parse out just the model name, removing firmware info like "FW:841.H1 .D USB FW:H1"
-      std::string model_name = product_string;
-      size_t fw_pos = model_name.find(" FW:");
-      if (fw_pos != std::string::npos) {
-        model_name = model_name.substr(0, fw_pos);
-      }
-      data.device.model = model_name;
-      ESP_LOGI(APC_HID_TAG, "Successfully read APC model from USB Product descriptor: \"%s\"", data.device.model.c_str());
-      
-      // Detect and set nominal power rating based on model name
-      detect_nominal_power_rating(data.device.model, data);
-    } else {
-      data.device.model.clear();  // Set to unset state instead of hardcoded fallback
-      ESP_LOGW(APC_HID_TAG, "Failed to read USB Product descriptor: %s, leaving model unset", esp_err_to_name(prod_ret));
-    }
-    
-    // Read additional device information (serial, firmware, etc.)
-    read_device_information(data);
-    
-    // Read missing dynamic values identified from NUT analysis
-    read_missing_dynamic_values(data);
-    
-    ESP_LOGV(APC_HID_TAG, "Successfully read UPS data");
-  } else {
+  if (!success) {
     ESP_LOGW(APC_HID_TAG, "Failed to read any APC HID reports");
-    // Leave manufacturer and model unset when HID communication fails
-    data.device.manufacturer.clear();
-    data.device.model.clear();
+    return false;
+  }
+  
+  // 7. Battery voltage actual (Report APC_REPORT_ID_BATTERY_VOLTAGE)
+  if (!battery_voltage_report.data.empty()) {
+    parse_battery_voltage_actual_report(battery_voltage_report, data);
+  }
+  
+  // Frequency from the first candidate report that carries one
+  read_frequency_data(reports + APC_FAST_POLL_FREQUENCY_FIRST,
+                      APC_FAST_POLL_REPORT_COUNT - APC_FAST_POLL_FREQUENCY_FIRST, data);
+  
+  // 8. Test result (Report APC_REPORT_ID_TEST_RESULT - same as test command)
+  // Based on NUT: "UPS.Battery.Test" maps to test result
+  if (!test_result_report.data.empty()) {
+    parse_test_result_report(test_result_report, data);
   }
   
   // Set default test result
@@ -291,7 +398,84 @@ bool ApcHidProtocol::read_data(UpsData &data) {
     data.test.ups_test_result = test::RESULT_NO_TEST;
   }
   
-  return success;
+  update_battery_status(data);
+  update_idle_timers(data);
+  
+  UPS_HID_LOGV(APC_HID_TAG, "Successfully read UPS data");
+  return true;
+}
+
+bool ApcHidProtocol::read_identity(UpsData &data) {
+  UPS_HID_LOGD(APC_HID_TAG, "Reading APC device identity...");
+  
+  // Read manufacturer from USB Manufacturer string descriptor (index 3)
+  // NUT shows: UPS.PowerSummary.iManufacturer, Value: 3 → Manufacturer: "APC"
+  std::string manufacturer_string;
+  esp_err_t mfr_ret = parent_->usb_get_string_descriptor(3, manufacturer_string);
+  
+  if (mfr_ret == ESP_OK && !manufacturer_string.empty()) {
+    data.device.manufacturer = manufacturer_string;
+    ESP_LOGI(APC_HID_TAG, "Successfully read manufacturer from USB descriptor: \"%s\"", data.device.manufacturer.c_str());
+  } else {
+    data.device.manufacturer.clear();  // Set to unset state instead of hardcoded fallback
+    ESP_LOGW(APC_HID_TAG, "Failed to read USB Manufacturer descriptor: %s, leaving unset", esp_err_to_name(mfr_ret));
+  }
+  
+  // Read model from USB Product string descriptor (index 1)
+  // NUT shows: Product: "Back-UPS ES 700G" but need to parse out firmware info
+  std::string product_string;
+  esp_err_t prod_ret = parent_->usb_get_string_descriptor(1, product_string);
+  
+  if (prod_ret == ESP_OK && !product_string.empty()) {
+    // Parse out just the model name, removing firmware info like "FW:841.H1 .D USB FW:H1"
+    std::string model_name = product_string;
+    size_t fw_pos = model_name.find(" FW:");
+    if (fw_pos != std::string::npos) {
+      model_name = model_name.substr(0, fw_pos);
+    }
+    data.device.model = model_name;
+    ESP_LOGI(APC_HID_TAG, "Successfully read APC model from USB Product descriptor: \"%s\"", data.device.model.c_str());
+    
+    // Detect and set nominal power rating based on model name
+    detect_nominal_power_rating(data.device.model, data);
+  } else {
+    data.device.model.clear();  // Set to unset state instead of hardcoded fallback
+    ESP_LOGW(APC_HID_TAG, "Failed to read USB Product descriptor: %s, leaving model unset", esp_err_to_name(prod_ret));
+  }
+  
+  // Read additional device information (serial, firmware)
+  read_device_information(data);
+  
+  // Retry on the next poll if the device was not ready to answer descriptor requests
+  return mfr_ret == ESP_OK || prod_ret == ESP_OK;
+}
+
+void ApcHidProtocol::update_battery_status(UpsData &data) {
+  // Set battery status based on current battery level and charging state
+  if (!std::isnan(data.battery.level)) {
+    if (data.battery.level >= 90) {
+      data.battery.status = battery_status::FULL;
+    } else if (data.battery.level >= 20) {
+      data.battery.status = battery_status::GOOD;
+    } else if (data.battery.level >= 10) {
+      data.battery.status = battery_status::LOW;
+    } else {
+      data.battery.status = battery_status::CRITICAL;
+    }
+    UPS_HID_LOGV(APC_HID_TAG, "APC Battery status: %s (%.0f%%)", data.battery.status.c_str(), data.battery.level);
+  }
+}
+
+void ApcHidProtocol::update_idle_timers(UpsData &data) {
+  // Set timer values based on delay settings (negative indicates no active countdown)
+  // NUT shows these as derived from delay values when no countdown is active
+  if (data.config.delay_shutdown != -1) {
+    data.test.timer_shutdown = -static_cast<int16_t>(data.config.delay_shutdown);
+  }
+  if (data.config.delay_start != -1) {
+    data.test.timer_start = -static_cast<int16_t>(data.config.delay_start);
+  }
+  // timer_reboot is set in parse_ups_delay_reboot_report() if available
 }
 
 bool ApcHidProtocol::init_hid_communication() {
@@ -303,57 +487,49 @@ bool ApcHidProtocol::init_hid_communication() {
 bool ApcHidProtocol::read_hid_report(uint8_t report_id, HidReport &report) {
   // Check device connection before any HID communication
   if (!parent_->is_device_connected()) {
-    ESP_LOGV(APC_HID_TAG, "Device not connected, skipping HID report 0x%02X", report_id);
+    UPS_HID_LOGV(APC_HID_TAG, "Device not connected, skipping HID report 0x%02X", report_id);
     return false;
   }
   
-#ifdef USE_ESP32
-  uint8_t buffer[64]; // Maximum HID report size
-  size_t buffer_len = sizeof(buffer);
+  size_t buffer_len = report.data.capacity();
   esp_err_t ret;
   
   // CRITICAL FIX: Try Input Report first (HID_REPORT_TYPE_INPUT) - this is what NUT uses for real-time data
   // Based on NUT logs showing PowerSummary fields work with Input Reports
-  ESP_LOGV(APC_HID_TAG, "Trying Input report 0x%02X...", report_id);
-  ret = parent_->hid_get_report(HID_REPORT_TYPE_INPUT, report_id, buffer, &buffer_len, parent_->get_protocol_timeout());
+  UPS_HID_LOGV(APC_HID_TAG, "Trying Input report 0x%02X...", report_id);
+  ret = parent_->hid_get_report(HID_REPORT_TYPE_INPUT, report_id, report.data.data(), &buffer_len, parent_->get_protocol_timeout());
   if (ret == ESP_OK && buffer_len > 0) {
     report.report_id = report_id;
-    report.data.assign(buffer, buffer + buffer_len);
-    ESP_LOGD(APC_HID_TAG, "HID Input report 0x%02X: received %zu bytes", report_id, buffer_len);
-    log_raw_data(buffer, buffer_len);
+    report.data.set_size(buffer_len);
+    UPS_HID_LOGD(APC_HID_TAG, "HID Input report 0x%02X: received %zu bytes", report_id, buffer_len);
+    log_raw_data(report.data.data(), buffer_len);
     return true;
   }
   
   // Check connection again before trying Feature report
   if (!parent_->is_device_connected()) {
-    ESP_LOGV(APC_HID_TAG, "Device disconnected during HID communication for report 0x%02X", report_id);
+    UPS_HID_LOGV(APC_HID_TAG, "Device disconnected during HID communication for report 0x%02X", report_id);
     return false;
   }
   
   // Fall back to Feature Report (HID_REPORT_TYPE_FEATURE) for static/config data
-  buffer_len = sizeof(buffer); // Reset buffer length
-  ESP_LOGV(APC_HID_TAG, "Trying Feature report 0x%02X...", report_id);
-  ret = parent_->hid_get_report(HID_REPORT_TYPE_FEATURE, report_id, buffer, &buffer_len, parent_->get_protocol_timeout());
+  buffer_len = report.data.capacity(); // Reset buffer length
+  UPS_HID_LOGV(APC_HID_TAG, "Trying Feature report 0x%02X...", report_id);
+  ret = parent_->hid_get_report(HID_REPORT_TYPE_FEATURE, report_id, report.data.data(), &buffer_len, parent_->get_protocol_timeout());
   if (ret == ESP_OK && buffer_len > 0) {
     report.report_id = report_id;
-    report.data.assign(buffer, buffer + buffer_len);
-    ESP_LOGD(APC_HID_TAG, "HID Feature report 0x%02X: received %zu bytes", report_id, buffer_len);
-    log_raw_data(buffer, buffer_len);
+    report.data.set_size(buffer_len);
+    UPS_HID_LOGD(APC_HID_TAG, "HID Feature report 0x%02X: received %zu bytes", report_id, buffer_len);
+    log_raw_data(report.data.data(), buffer_len);
     return true;
   }
   
-  ESP_LOGD(APC_HID_TAG, "Both Input and Feature report 0x%02X failed", report_id);
+  report.data.clear();
+  UPS_HID_LOGD(APC_HID_TAG, "Both Input and Feature report 0x%02X failed", report_id);
   return false;
-#else
-  // Simulation mode - return simulated data
-  if (parent_->get_simulation_mode()) {
-    return parent_->simulate_hid_get_report(report_id, report);
-  }
-  ESP_LOGW(APC_HID_TAG, "HID communication not available on this platform");
-  return false;
-#endif
 }
 
+#if UPS_HID_LOG_DEBUG_ENABLED
 void ApcHidProtocol::log_raw_data(const uint8_t* buffer, size_t buffer_len) {
   if (buffer_len > 0) {
     std::string hex_data;
@@ -362,38 +538,29 @@ void ApcHidProtocol::log_raw_data(const uint8_t* buffer, size_t buffer_len) {
       snprintf(hex_byte, sizeof(hex_byte), "%02X ", buffer[i]);
       hex_data += hex_byte;
     }
-    ESP_LOGD(APC_HID_TAG, "Raw data (%zu bytes): %s", buffer_len, hex_data.c_str());
+    UPS_HID_LOGD(APC_HID_TAG, "Raw data (%zu bytes): %s", buffer_len, hex_data.c_str());
     
     // Detailed byte-by-byte analysis
     for (size_t i = 0; i < buffer_len; i++) {
-      ESP_LOGV(APC_HID_TAG, "  Byte[%zu]: 0x%02X (%d decimal)", i, buffer[i], buffer[i]);
+      UPS_HID_LOGV(APC_HID_TAG, "  Byte[%zu]: 0x%02X (%d decimal)", i, buffer[i], buffer[i]);
     }
   }
 }
+#endif
 
 bool ApcHidProtocol::write_hid_report(const HidReport &report) {
-#ifdef USE_ESP32
   // Use HID Feature Report for UPS control commands  
   const uint8_t report_type = HID_REPORT_TYPE_FEATURE; // Feature Report
   
   esp_err_t ret = parent_->hid_set_report(report_type, report.report_id, 
                                           report.data.data(), report.data.size(), parent_->get_protocol_timeout());
   if (ret != ESP_OK) {
-    ESP_LOGD(APC_HID_TAG, "HID SET_REPORT failed: %s", esp_err_to_name(ret));
+    UPS_HID_LOGD(APC_HID_TAG, "HID SET_REPORT failed: %s", esp_err_to_name(ret));
     return false;
   }
   
-  ESP_LOGD(APC_HID_TAG, "HID report 0x%02X: sent %zu bytes", report.report_id, report.data.size());
+  UPS_HID_LOGD(APC_HID_TAG, "HID report 0x%02X: sent %zu bytes", report.report_id, report.data.size());
   return true;
-#else
-  // Simulation mode - return simulated success
-  if (parent_->get_simulation_mode()) {
-    ESP_LOGD(APC_HID_TAG, "Simulated HID report 0x%02X: sent %zu bytes", report.report_id, report.data.size());
-    return true;
-  }
-  ESP_LOGW(APC_HID_TAG, "HID communication not available on this platform");
-  return false;
-#endif
 }
 
 // ============================================================================
@@ -448,7 +615,7 @@ public:
 
 void ApcReportParser::parse_device_info_report(const HidReport &report) {
   // Device info report parsing (implementation needed)
-  ESP_LOGD(TAG, "Device info report received");
+  UPS_HID_LOGD(TAG, "Device info report received");
 }
 
 void ApcReportParser::parse_power_summary_report(const HidReport &report, UpsData &data) {
@@ -462,7 +629,7 @@ void ApcReportParser::parse_power_summary_report(const HidReport &report, UpsDat
   // ESP32 data format: [APC_REPORT_ID_POWER_SUMMARY 63 67 02] where 0x63 = 99% battery
   // Battery percentage at byte 1 (NUT offset 0 within report payload)
   data.battery.level = static_cast<float>(report.data[1]);
-  ESP_LOGD(APC_HID_TAG, "Raw battery byte: 0x%02X = %d%%", report.data[1], report.data[1]);
+  UPS_HID_LOGD(APC_HID_TAG, "Raw battery byte: 0x%02X = %d%%", report.data[1], report.data[1]);
   ESP_LOGI(APC_HID_TAG, "PowerSummary: Battery %.0f%%", data.battery.level);
   
   // Runtime at bytes 2-3 (16-bit little-endian, NUT offset 8)
@@ -489,7 +656,7 @@ void ApcReportParser::parse_present_status_report(const HidReport &report, UpsDa
   // ESP32 receives packed data, but NUT shows individual bit fields at offsets
   // The HID descriptor defines how these bits are packed into the report
   uint8_t packed_status = report.data[1];
-  ESP_LOGD(APC_HID_TAG, "PresentStatus packed data: 0x%02X", packed_status);
+  UPS_HID_LOGD(APC_HID_TAG, "PresentStatus packed data: 0x%02X", packed_status);
   
   // Extract individual status bits based on NUT field offsets
   // NUT shows these are 1-bit fields at specific offsets within the report
@@ -507,18 +674,25 @@ void ApcReportParser::parse_present_status_report(const HidReport &report, UpsDa
   if (report.data.size() >= 3) {
     uint8_t second_byte = report.data[2];
     overload = (second_byte & APC_PRESENT_OVERLOAD) != 0;  // Offset 8 = bit 0 of second byte
-    ESP_LOGD(APC_HID_TAG, "Second status byte: 0x%02X, Overload: %d", second_byte, overload);
+    UPS_HID_LOGD(APC_HID_TAG, "Second status byte: 0x%02X, Overload: %d", second_byte, overload);
   }
   
   // Update power status based on AC presence and discharging
+  uint32_t flags = 0;
   if (ac_present && !discharging) {
     // Note: Can't access parent_->get_fallback_nominal_voltage() in static method
     // The voltage will be set by the actual voltage reports if available
-    data.power.status = status::ONLINE;
+    flags |= UPS_STATUS_OL;
   } else {
     data.power.input_voltage = NAN;     // No AC input
-    data.power.status = status::ON_BATTERY;
+    flags |= UPS_STATUS_OB;
   }
+  if (charging) flags |= UPS_STATUS_CHRG;
+  if (discharging) flags |= UPS_STATUS_DISCHRG;
+  if (below_capacity || shutdown_imminent || time_limit_expired) flags |= UPS_STATUS_LB;
+  if (need_replacement) flags |= UPS_STATUS_RB;
+  if (overload) flags |= UPS_STATUS_OVER;
+  data.power.status_flags = flags;
   
   // Update battery status
   if (charging) {
@@ -545,13 +719,9 @@ void ApcReportParser::parse_present_status_report(const HidReport &report, UpsDa
     data.battery.status = battery_status::NOT_PRESENT;
   }
   
-  if (overload) {
-    data.power.status += " - Overload";
-  }
-  
-  ESP_LOGI(APC_HID_TAG, "PresentStatus: 0x%02X AC:%d Discharge:%d Charge:%d Battery:%d → Power:\"%s\" Battery:\"%s\"", 
+  ESP_LOGI(APC_HID_TAG, "PresentStatus: 0x%02X AC:%d Discharge:%d Charge:%d Battery:%d → Power:0x%03X Battery:\"%s\"", 
            packed_status, ac_present, discharging, charging, battery_present, 
-           data.power.status.c_str(), data.battery.status.c_str());
+           static_cast<unsigned>(flags), data.battery.status.c_str());
 }
 
 void ApcReportParser::parse_apc_status_report(const HidReport &report, UpsData &data) {
@@ -564,7 +734,7 @@ void ApcReportParser::parse_apc_status_report(const HidReport &report, UpsData &
   
   // ESP32 data format: [APC_REPORT_ID_BATTERY 08] where 0x08 = AC present  
   uint8_t apc_status = report.data[1]; // Byte 1 contains the status value
-  ESP_LOGD(APC_HID_TAG, "Raw APCStatusFlag byte: 0x%02X", apc_status);
+  UPS_HID_LOGD(APC_HID_TAG, "Raw APCStatusFlag byte: 0x%02X", apc_status);
   ESP_LOGI(APC_HID_TAG, "APCStatusFlag: 0x%02X", apc_status);
   
   // Parse APC legacy status values from NUT logs:
@@ -576,9 +746,9 @@ void ApcReportParser::parse_apc_status_report(const HidReport &report, UpsData &
   // Use APCStatusFlag as backup/confirmation for PresentStatus
   // This provides additional validation of the UPS state
   if (apc_ac_present) {
-    ESP_LOGD(APC_HID_TAG, "APCStatusFlag confirms: UPS online (AC present)");
+    UPS_HID_LOGD(APC_HID_TAG, "APCStatusFlag confirms: UPS online (AC present)");
   } else if (apc_discharging) {
-    ESP_LOGD(APC_HID_TAG, "APCStatusFlag confirms: UPS on battery (discharging)");
+    UPS_HID_LOGD(APC_HID_TAG, "APCStatusFlag confirms: UPS on battery (discharging)");
   } else {
     ESP_LOGW(APC_HID_TAG, "APCStatusFlag unknown value: 0x%02X", apc_status);
   }
@@ -655,12 +825,12 @@ void ApcReportParser::parse_battery_report(const HidReport &report, UpsData &dat
     } else {
       // Set estimate based on battery level if raw value seems invalid
       data.battery.runtime_minutes = data.battery.level * 0.5f; 
-      ESP_LOGV(APC_HID_TAG, "Using estimated runtime: %.0f minutes", data.battery.runtime_minutes);
+      UPS_HID_LOGV(APC_HID_TAG, "Using estimated runtime: %.0f minutes", data.battery.runtime_minutes);
     }
   } else {
     // Set reasonable default if runtime not available
     data.battery.runtime_minutes = data.battery.level * 0.5f; // Rough estimate based on battery level
-    ESP_LOGV(APC_HID_TAG, "Using estimated runtime: %.0f minutes", data.battery.runtime_minutes);
+    UPS_HID_LOGV(APC_HID_TAG, "Using estimated runtime: %.0f minutes", data.battery.runtime_minutes);
   }
 }
 
@@ -676,7 +846,7 @@ void ApcReportParser::parse_status_report(const HidReport &report, UpsData &data
   // report.data[1] = status flags byte
   uint8_t status_byte = report.data[1];
   
-  ESP_LOGD(APC_HID_TAG, "Status byte: 0x%02X", status_byte);
+  UPS_HID_LOGD(APC_HID_TAG, "Status byte: 0x%02X", status_byte);
   
   // Parse status flags based on working NUT server implementation
   bool ac_present = status_byte & APC_STATUS_AC_PRESENT;           // Bit 0: AC present
@@ -687,14 +857,18 @@ void ApcReportParser::parse_status_report(const HidReport &report, UpsData &data
   bool need_replacement = status_byte & APC_STATUS_NEED_REPLACEMENT;     // Bit 7: Need replacement
   
   // Update power status based on AC presence and discharging
+  uint32_t flags = 0;
   if (ac_present && !discharging) {
     // Note: Can't access parent_->get_fallback_nominal_voltage() in static method
     // The voltage will be set by the actual voltage reports if available
-    data.power.status = status::ONLINE;
+    flags |= UPS_STATUS_OL;
   } else {
     data.power.input_voltage = NAN;     // No AC input
-    data.power.status = status::ON_BATTERY;
+    flags |= UPS_STATUS_OB;
   }
+  if (charging) flags |= UPS_STATUS_CHRG;
+  if (discharging) flags |= UPS_STATUS_DISCHRG;
+  if (need_replacement) flags |= UPS_STATUS_RB;
   
   // Update battery status
   if (charging) {
@@ -720,7 +894,7 @@ void ApcReportParser::parse_status_report(const HidReport &report, UpsData &data
   if (report.data.size() >= 3) {
     uint8_t overload_byte = report.data[2];
     if (overload_byte > 0) {
-      data.power.status += " - Overload";
+      flags |= UPS_STATUS_OVER;
     }
   }
   
@@ -728,15 +902,17 @@ void ApcReportParser::parse_status_report(const HidReport &report, UpsData &data
     uint8_t shutdown_byte = report.data[3];
     if (shutdown_byte > 0) {
       data.battery.charge_low = battery::LOW_THRESHOLD_PERCENT;  // Indicate low battery threshold
+      flags |= UPS_STATUS_LB;
     }
   }
+  data.power.status_flags = flags;
   
-  ESP_LOGI(APC_HID_TAG, "UPS Status - AC:%s, Charging:%s, Discharging:%s, Good:%s, Status:\"%s\"", 
+  ESP_LOGI(APC_HID_TAG, "UPS Status - AC:%s, Charging:%s, Discharging:%s, Good:%s, Flags:0x%03X", 
            ac_present ? "Yes" : "No", 
            charging ? "Yes" : "No",
            discharging ? "Yes" : "No",
            good ? "Yes" : "No",
-           data.power.status.c_str());
+           static_cast<unsigned>(flags));
 }
 
 // Voltage report parsing implementation
@@ -754,9 +930,9 @@ void ApcReportParser::parse_voltage_report(const HidReport &report, UpsData &dat
   // If we have a second byte, treat it as high byte for 16-bit value
   if (report.data.size() >= 3) {
     voltage_raw |= (report.data[2] << 8);
-    ESP_LOGV(APC_HID_TAG, "16-bit voltage: 0x%04X", voltage_raw);
+    UPS_HID_LOGV(APC_HID_TAG, "16-bit voltage: 0x%04X", voltage_raw);
   } else {
-    ESP_LOGV(APC_HID_TAG, "8-bit voltage: 0x%02X", voltage_raw);
+    UPS_HID_LOGV(APC_HID_TAG, "8-bit voltage: 0x%02X", voltage_raw);
   }
   
   // This report provides output voltage, apply proper scaling
@@ -862,7 +1038,7 @@ void ApcHidProtocol::parse_power_report(const HidReport &report, UpsData &data)
 void ApcHidProtocol::read_device_info() {
   // Skip reading device info if not connected
   if (!parent_->is_connected()) {
-    ESP_LOGD(APC_HID_TAG, "Skipping device info read - device not connected");
+    UPS_HID_LOGD(APC_HID_TAG, "Skipping device info read - device not connected");
     return;
   }
   
@@ -899,7 +1075,7 @@ void ApcHidProtocol::parse_load_report(const HidReport &report, UpsData &data) {
 }
 
 void ApcHidProtocol::read_device_information(UpsData &data) {
-  ESP_LOGD(APC_HID_TAG, "Reading APC device information...");
+  UPS_HID_LOGD(APC_HID_TAG, "Reading APC device information...");
   
   // Try to read USB string descriptors first (most reliable for APC devices)
   // Based on NUT apc_format_serial/apc_format_model implementation
@@ -917,19 +1093,23 @@ void ApcHidProtocol::read_device_information(UpsData &data) {
     parse_firmware_version_report(firmware_report, data);
   }
   
-  // Try reading beeper status
-  HidReport beeper_report;
-  if (read_hid_report(APC_REPORT_ID_AUDIBLE_ALARM, beeper_report)) {
-    parse_beeper_status_report(beeper_report, data);
-  }
+  UPS_HID_LOGD(APC_HID_TAG, "Device information reading completed");
+}
+
+void ApcHidProtocol::read_configuration(UpsData &data) {
+  // Settings that can change through controls or the front panel
+  HidReport reports[sizeof(APC_CONFIGURATION_REPORT_IDS)];
+  read_reports(APC_CONFIGURATION_REPORT_IDS, reports, sizeof(APC_CONFIGURATION_REPORT_IDS), HID_REPORT_TYPE_INPUT);
   
-  // Try reading input sensitivity
-  HidReport sensitivity_report;
-  if (read_hid_report(APC_REPORT_ID_SENSITIVITY, sensitivity_report)) {
-    parse_input_sensitivity_report(sensitivity_report, data);
+  // Beeper status
+  if (!reports[0].data.empty()) {
+    parse_beeper_status_report(reports[0], data);
   }
   
-  ESP_LOGD(APC_HID_TAG, "Device information reading completed");
+  // Input sensitivity
+  if (!reports[1].data.empty()) {
+    parse_input_sensitivity_report(reports[1], data);
+  }
 }
 
 void ApcHidProtocol::parse_serial_number_report(const HidReport &report, UpsData &data) {
@@ -942,7 +1122,7 @@ void ApcHidProtocol::parse_serial_number_report(const HidReport &report, UpsData
   // This is a USB string descriptor index, not the actual serial number
   uint8_t string_index = report.data[1];
   
-  ESP_LOGD(APC_HID_TAG, "Serial number string descriptor index: %d", string_index);
+  UPS_HID_LOGD(APC_HID_TAG, "Serial number string descriptor index: %d", string_index);
   
   // Use real USB string descriptor reading - this will get the actual APC serial number
   // NUT shows: APC real serial = "5B1738T47814"
@@ -966,7 +1146,7 @@ void ApcHidProtocol::parse_serial_number_report(const HidReport &report, UpsData
 
 void ApcHidProtocol::parse_firmware_version_report(const HidReport &report, UpsData &data) {
   if (report.data.size() < 2) {
-    ESP_LOGV(APC_HID_TAG, "Firmware version report too short: %zu bytes", report.data.size());
+    UPS_HID_LOGV(APC_HID_TAG, "Firmware version report too short: %zu bytes", report.data.size());
     return;
   }
   
@@ -977,7 +1157,7 @@ void ApcHidProtocol::parse_firmware_version_report(const HidReport &report, UpsD
   // CRITICAL FIX: Skip manufacturer string descriptor (index 3) which contains "APC"
   // From the log we see that index 3 = "APC" (manufacturer), not firmware
   if (first_byte > 0 && first_byte <= 15 && first_byte != 3) {
-    ESP_LOGD(APC_HID_TAG, "Trying firmware as USB string descriptor index: %d", first_byte);
+    UPS_HID_LOGD(APC_HID_TAG, "Trying firmware as USB string descriptor index: %d", first_byte);
     
     std::string firmware_from_usb;
     esp_err_t ret = parent_->usb_get_string_descriptor(first_byte, firmware_from_usb);
@@ -1003,17 +1183,17 @@ void ApcHidProtocol::parse_firmware_version_report(const HidReport &report, UpsD
                first_byte, data.device.firmware_version.c_str());
       return;
     } else {
-      ESP_LOGD(APC_HID_TAG, "USB string descriptor %d read failed or contains manufacturer info: %s, trying other methods", 
+      UPS_HID_LOGD(APC_HID_TAG, "USB string descriptor %d read failed or contains manufacturer info: %s, trying other methods", 
                first_byte, esp_err_to_name(ret));
     }
   } else if (first_byte == 3) {
-    ESP_LOGD(APC_HID_TAG, "Skipping manufacturer string descriptor index 3 for firmware");
+    UPS_HID_LOGD(APC_HID_TAG, "Skipping manufacturer string descriptor index 3 for firmware");
   }
   
   // FALLBACK 1 (PRIORITY): Parse firmware from the USB Product string descriptor (index 1)
   // This is the most reliable method for APC devices based on the log
   // Log shows: USB string descriptor 1: "Back-UPS ES 700G FW:871.O4 .I USB FW:O4"
-  ESP_LOGD(APC_HID_TAG, "Trying to read firmware from USB Product string descriptor (index 1)");
+  UPS_HID_LOGD(APC_HID_TAG, "Trying to read firmware from USB Product string descriptor (index 1)");
   std::string product_with_firmware;
   esp_err_t product_ret = parent_->usb_get_string_descriptor(1, product_with_firmware);
   
@@ -1046,7 +1226,7 @@ void ApcHidProtocol::parse_firmware_version_report(const HidReport &report, UpsD
       return;
     }
   } else {
-    ESP_LOGD(APC_HID_TAG, "Failed to read USB Product descriptor or no FW info found: %s", 
+    UPS_HID_LOGD(APC_HID_TAG, "Failed to read USB Product descriptor or no FW info found: %s", 
              esp_err_to_name(product_ret));
   }
   
@@ -1085,7 +1265,7 @@ void ApcHidProtocol::parse_firmware_version_report(const HidReport &report, UpsD
     snprintf(firmware_fallback, sizeof(firmware_fallback), "FW:%d.%d", 
              report.data[1], report.data[2]);
     data.device.firmware_version = firmware_fallback;
-    ESP_LOGD(APC_HID_TAG, "Using binary firmware version fallback: %s", data.device.firmware_version.c_str());
+    UPS_HID_LOGD(APC_HID_TAG, "Using binary firmware version fallback: %s", data.device.firmware_version.c_str());
   } else {
     // No firmware version could be determined
     data.device.firmware_version.clear();
@@ -1098,12 +1278,12 @@ void ApcHidProtocol::parse_beeper_status_report(const HidReport &report, UpsData
   // NUT debug shows: ReportID: APC_REPORT_ID_AUDIBLE_ALARM, Value: 2 (AudibleAlarmControl)
   // APC beeper mapping: 1=disabled, 2=enabled, 3=muted
   if (report.data.size() < 2) {
-    ESP_LOGV(APC_HID_TAG, "Beeper status report too short: %zu bytes", report.data.size());
+    UPS_HID_LOGV(APC_HID_TAG, "Beeper status report too short: %zu bytes", report.data.size());
     return;
   }
   
   uint8_t beeper_value = report.data[1];
-  ESP_LOGD(APC_HID_TAG, "Raw APC beeper from report 0x%02X: 0x%02X (%d)", APC_REPORT_ID_AUDIBLE_ALARM, beeper_value, beeper_value);
+  UPS_HID_LOGD(APC_HID_TAG, "Raw APC beeper from report 0x%02X: 0x%02X (%d)", APC_REPORT_ID_AUDIBLE_ALARM, beeper_value, beeper_value);
   
   // DYNAMIC BEEPER STATUS MAPPING: Handle known APC values with intelligent fallbacks
   switch (beeper_value) {
@@ -1133,7 +1313,7 @@ void ApcHidProtocol::parse_beeper_status_report(const HidReport &report, UpsData
         // Try alternative parsing - some APC models might use different byte
         if (report.data.size() >= 3) {
           uint8_t alt_value = report.data[2];
-          ESP_LOGD(APC_HID_TAG, "Trying alternative beeper parsing from byte[2]: %d", alt_value);
+          UPS_HID_LOGD(APC_HID_TAG, "Trying alternative beeper parsing from byte[2]: %d", alt_value);
           
           if (alt_value <= 3) {
             switch (alt_value) {
@@ -1173,12 +1353,12 @@ void ApcHidProtocol::parse_input_sensitivity_report(const HidReport &report, Ups
   // NUT debug shows: ReportID: APC_REPORT_ID_SENSITIVITY, Value: 1 (APCSensitivity)
   // APC sensitivity mapping: 0=high, 1=normal/medium, 2=low
   if (report.data.size() < 2) {
-    ESP_LOGV(APC_HID_TAG, "Input sensitivity report too short: %zu bytes", report.data.size());
+    UPS_HID_LOGV(APC_HID_TAG, "Input sensitivity report too short: %zu bytes", report.data.size());
     return;
   }
   
   uint8_t sensitivity_value = report.data[1];
-  ESP_LOGD(APC_HID_TAG, "Raw APC sensitivity from report 0x%02X: 0x%02X (%d)", APC_REPORT_ID_SENSITIVITY, sensitivity_value, sensitivity_value);
+  UPS_HID_LOGD(APC_HID_TAG, "Raw APC sensitivity from report 0x%02X: 0x%02X (%d)", APC_REPORT_ID_SENSITIVITY, sensitivity_value, sensitivity_value);
   
   // DYNAMIC SENSITIVITY MAPPING: Handle known APC values and provide intelligent fallbacks
   switch (sensitivity_value) {
@@ -1204,7 +1384,7 @@ void ApcHidProtocol::parse_input_sensitivity_report(const HidReport &report, Ups
         // Try alternative parsing - some APC models might use different byte
         if (report.data.size() >= 3) {
           uint8_t alt_value = report.data[2];
-          ESP_LOGD(APC_HID_TAG, "Trying alternative sensitivity parsing from byte[2]: %d", alt_value);
+          UPS_HID_LOGD(APC_HID_TAG, "Trying alternative sensitivity parsing from byte[2]: %d", alt_value);
           
           if (alt_value <= 2) {
             sensitivity_value = alt_value;
@@ -1238,114 +1418,70 @@ void ApcHidProtocol::parse_input_sensitivity_report(const HidReport &report, Ups
 }
 
 void ApcHidProtocol::read_missing_dynamic_values(UpsData &data) {
-  ESP_LOGD(APC_HID_TAG, "Reading APC missing dynamic values from NUT analysis...");
+  UPS_HID_LOGD(APC_HID_TAG, "Reading APC missing dynamic values from NUT analysis...");
   
-  // 1. Battery voltage nominal (Report APC_REPORT_ID_BATTERY_VOLTAGE_NOMINAL)
-  HidReport battery_voltage_nominal_report;
-  if (read_hid_report(APC_REPORT_ID_BATTERY_VOLTAGE_NOMINAL, battery_voltage_nominal_report)) {
-    parse_battery_voltage_nominal_report(battery_voltage_nominal_report, data);
-  }
+  HidReport reports[sizeof(APC_DYNAMIC_VALUE_REPORT_IDS)];
+  read_reports(APC_DYNAMIC_VALUE_REPORT_IDS, reports, sizeof(APC_DYNAMIC_VALUE_REPORT_IDS), HID_REPORT_TYPE_INPUT);
+  auto available = [&reports](size_t index) { return !reports[index].data.empty(); };
   
-  // 1b. Battery voltage actual (Report APC_REPORT_ID_BATTERY_VOLTAGE) - MISSING from original implementation
-  HidReport battery_voltage_report;
-  if (read_hid_report(APC_REPORT_ID_BATTERY_VOLTAGE, battery_voltage_report)) {
-    parse_battery_voltage_actual_report(battery_voltage_report, data);
+  // 1. Battery voltage nominal (Report APC_REPORT_ID_BATTERY_VOLTAGE_NOMINAL)
+  if (available(0)) {
+    parse_battery_voltage_nominal_report(reports[0], data);
   }
   
   // 2. Input voltage nominal (Report APC_REPORT_ID_INPUT_VOLTAGE_NOMINAL)
-  HidReport input_voltage_nominal_report;
-  if (read_hid_report(APC_REPORT_ID_INPUT_VOLTAGE_NOMINAL, input_voltage_nominal_report)) {
-    parse_input_voltage_nominal_report(input_voltage_nominal_report, data);
+  if (available(1)) {
+    parse_input_voltage_nominal_report(reports[1], data);
   }
   
   // 3. Input transfer limits (Reports APC_REPORT_ID_INPUT_TRANSFER_LOW, APC_REPORT_ID_INPUT_TRANSFER_HIGH)
-  HidReport input_transfer_low_report;
-  if (read_hid_report(APC_REPORT_ID_INPUT_TRANSFER_LOW, input_transfer_low_report)) {
-    parse_input_transfer_limits_report(input_transfer_low_report, data);
+  if (available(2)) {
+    parse_input_transfer_limits_report(reports[2], data);
   }
-  
-  HidReport input_transfer_high_report;
-  if (read_hid_report(APC_REPORT_ID_INPUT_TRANSFER_HIGH, input_transfer_high_report)) {
-    parse_input_transfer_limits_report(input_transfer_high_report, data);
+  if (available(3)) {
+    parse_input_transfer_limits_report(reports[3], data);
   }
   
   // 4. Battery runtime low threshold (Report APC_REPORT_ID_BATTERY_RUNTIME_LOW)
-  HidReport battery_runtime_low_report;
-  if (read_hid_report(APC_REPORT_ID_BATTERY_RUNTIME_LOW, battery_runtime_low_report)) {
-    parse_battery_runtime_low_report(battery_runtime_low_report, data);
+  if (available(4)) {
+    parse_battery_runtime_low_report(reports[4], data);
   }
   
-  // 5. Manufacturing dates (Reports APC_REPORT_ID_MFR_DATE_UPS, APC_REPORT_ID_MFR_DATE_BATTERY, 0x7b)
-  HidReport power_summary_mfr_date_report;
-  if (read_hid_report(APC_REPORT_ID_MFR_DATE_UPS, power_summary_mfr_date_report)) {
-    parse_manufacture_date_report(power_summary_mfr_date_report, data, false); // UPS mfr date
+  // 5. Manufacturing dates (Reports APC_REPORT_ID_MFR_DATE_UPS, APC_REPORT_ID_MFR_DATE_BATTERY)
+  if (available(5)) {
+    parse_manufacture_date_report(reports[5], data, false); // UPS mfr date
   }
-  
-  HidReport battery_mfr_date_report;
-  if (read_hid_report(APC_REPORT_ID_MFR_DATE_BATTERY, battery_mfr_date_report)) {
-    parse_manufacture_date_report(battery_mfr_date_report, data, true); // Battery mfr date
+  if (available(6)) {
+    parse_manufacture_date_report(reports[6], data, true); // Battery mfr date
   }
   
   // 6. UPS delay shutdown (Report APC_REPORT_ID_DELAY_SHUTDOWN)
-  HidReport ups_delay_shutdown_report;
-  if (read_hid_report(APC_REPORT_ID_DELAY_SHUTDOWN, ups_delay_shutdown_report)) {
-    parse_ups_delay_shutdown_report(ups_delay_shutdown_report, data);
+  if (available(7)) {
+    parse_ups_delay_shutdown_report(reports[7], data);
   }
 
   // 7. UPS delay reboot (Report APC_REPORT_ID_DELAY_REBOOT)  
-  HidReport ups_delay_reboot_report;
-  if (read_hid_report(APC_REPORT_ID_DELAY_REBOOT, ups_delay_reboot_report)) {
-    parse_ups_delay_reboot_report(ups_delay_reboot_report, data);
-  }
-  
-  // 7. Battery charge thresholds (Reports APC_REPORT_ID_CHARGE_WARNING, APC_REPORT_ID_CHARGE_LOW)
-  HidReport battery_charge_warning_report;
-  if (read_hid_report(APC_REPORT_ID_CHARGE_WARNING, battery_charge_warning_report)) {
-    parse_battery_charge_threshold_report(battery_charge_warning_report, data, false); // warning
+  if (available(8)) {
+    parse_ups_delay_reboot_report(reports[8], data);
   }
   
-  HidReport battery_charge_low_report;
-  if (read_hid_report(APC_REPORT_ID_CHARGE_LOW, battery_charge_low_report)) {
-    parse_battery_charge_threshold_report(battery_charge_low_report, data, true); // low
+  // 8. Battery charge thresholds (Reports APC_REPORT_ID_CHARGE_WARNING, APC_REPORT_ID_CHARGE_LOW)
+  if (available(9)) {
+    parse_battery_charge_threshold_report(reports[9], data, false); // warning
   }
-  
-  // 8. Battery chemistry/type (shared report ID)
-  HidReport battery_chemistry_report;
-  if (read_hid_report(battery_chemistry::REPORT_ID, battery_chemistry_report)) {
-    parse_battery_chemistry_report(battery_chemistry_report, data);
+  if (available(10)) {
+    parse_battery_charge_threshold_report(reports[10], data, true); // low
   }
   
-  // Set timer values based on delay settings (negative indicates no active countdown)
-  // NUT shows these as derived from delay values when no countdown is active
-  data.test.timer_shutdown = -static_cast<int16_t>(data.config.delay_shutdown);
-  data.test.timer_start = -static_cast<int16_t>(data.config.delay_start);
-  // timer_reboot is set in parse_ups_delay_reboot_report() if available
-  
-  // ups.firmware.aux needs to be extracted from firmware string
-  // This will be handled in the existing firmware parsing logic
-  
-  // Set battery status based on current battery level and charging state
-  if (!std::isnan(data.battery.level)) {
-    if (data.battery.level >= 90) {
-      data.battery.status = battery_status::FULL;
-    } else if (data.battery.level >= 20) {
-      data.battery.status = battery_status::GOOD;
-    } else if (data.battery.level >= 10) {
-      data.battery.status = battery_status::LOW;
-    } else {
-      data.battery.status = battery_status::CRITICAL;
-    }
-    ESP_LOGI(APC_HID_TAG, "APC Battery status: %s (%.0f%%)", data.battery.status.c_str(), data.battery.level);
+  // 9. Battery chemistry/type (shared report ID)
+  if (available(11)) {
+    parse_battery_chemistry_report(reports[11], data);
   }
   
-  // 8. Test result reading (Report APC_REPORT_ID_TEST_RESULT - same as test command)
-  // Based on NUT: "UPS.Battery.Test" maps to test result
-  HidReport test_result_report;
-  if (read_hid_report(APC_REPORT_ID_TEST_RESULT, test_result_report)) {
-    parse_test_result_report(test_result_report, data);
-  }
+  // Timers follow the delays just read
+  update_idle_timers(data);
   
-  ESP_LOGD(APC_HID_TAG, "Completed reading APC missing dynamic values");
+  UPS_HID_LOGD(APC_HID_TAG, "Completed reading APC missing dynamic values");
 }
 
 void ApcHidProtocol::parse_battery_voltage_nominal_report(const HidReport &report, UpsData &data) {
@@ -1519,7 +1655,7 @@ void ApcHidProtocol::parse_ups_delay_reboot_report(const HidReport &report, UpsD
 }
 
 std::string ApcHidProtocol::convert_apc_date(uint16_t date_value) {
-  ESP_LOGD(APC_HID_TAG, "Converting USB PDC date value: %u (0x%04X)", date_value, date_value);
+  UPS_HID_LOGD(APC_HID_TAG, "Converting USB PDC date value: %u (0x%04X)", date_value, date_value);
   
   if (date_value == 0) {
     return "not set";
@@ -1535,7 +1671,7 @@ std::string ApcHidProtocol::convert_apc_date(uint16_t date_value) {
   int month = (date_value >> 5) & 0x0F;  // Next 4 bits (0-15, but valid 1-12)  
   int year = 1980 + (date_value >> 9);   // Upper bits shifted right 9 positions + 1980
   
-  ESP_LOGD(APC_HID_TAG, "USB PDC date extraction: day=%d, month=%d, year=%d", day, month, year);
+  UPS_HID_LOGD(APC_HID_TAG, "USB PDC date extraction: day=%d, month=%d, year=%d", day, month, year);
   
   // Validate date components
   if (month < 1 || month > 12 || day < 1 || day > 31) {
@@ -1546,7 +1682,7 @@ std::string ApcHidProtocol::convert_apc_date(uint16_t date_value) {
   char date_str[16];
   snprintf(date_str, sizeof(date_str), "%04d/%02d/%02d", year, month, day);
   
-  ESP_LOGD(APC_HID_TAG, "Converted USB PDC date %u to %s", date_value, date_str);
+  UPS_HID_LOGD(APC_HID_TAG, "Converted USB PDC date %u to %s", date_value, date_str);
   return std::string(date_str);
 }
 
@@ -1593,7 +1729,7 @@ void ApcHidProtocol::parse_battery_chemistry_report(const HidReport &report, Ups
 }
 
 bool ApcHidProtocol::beeper_enable() {
-  ESP_LOGD(APC_HID_TAG, "Sending APC beeper enable command");
+  UPS_HID_LOGD(APC_HID_TAG, "Sending APC beeper enable command");
   
   // APC DEVICE SPECIFIC: From NUT debug, your device supports TWO beeper report IDs:
   // APC_REPORT_ID_AUDIBLE_ALARM: UPS.PowerSummary.AudibleAlarmControl
@@ -1602,27 +1738,17 @@ bool ApcHidProtocol::beeper_enable() {
   
   for (size_t i = 0; i < sizeof(report_ids_to_try); i++) {
     uint8_t report_id = report_ids_to_try[i];
-    ESP_LOGD(APC_HID_TAG, "Trying beeper enable with report ID 0x%02X", report_id);
+    UPS_HID_LOGD(APC_HID_TAG, "Trying beeper enable with report ID 0x%02X", report_id);
     
     uint8_t beeper_data[2] = {report_id, beeper::CONTROL_ENABLE};  // Report ID, Value=2 (enabled)
     
-#ifdef USE_ESP32
     esp_err_t ret = parent_->hid_set_report(HID_REPORT_TYPE_FEATURE, report_id, beeper_data, sizeof(beeper_data), parent_->get_protocol_timeout());
     if (ret == ESP_OK) {
       ESP_LOGI(APC_HID_TAG, "APC beeper enabled successfully with report ID 0x%02X", report_id);
       return true;
     } else {
-      ESP_LOGD(APC_HID_TAG, "Failed with report ID 0x%02X: %s", report_id, esp_err_to_name(ret));
+      UPS_HID_LOGD(APC_HID_TAG, "Failed with report ID 0x%02X: %s", report_id, esp_err_to_name(ret));
     }
-#else
-    // Simulation mode - always succeed
-    if (parent_->get_simulation_mode()) {
-      ESP_LOGI(APC_HID_TAG, "Simulated: APC beeper enabled successfully with report ID 0x%02X", report_id);
-      return true;
-    }
-    ESP_LOGW(APC_HID_TAG, "HID communication not available on this platform");
-    return false;
-#endif
   }
   
   ESP_LOGW(APC_HID_TAG, "Failed to enable APC beeper with all tested report IDs");
@@ -1630,7 +1756,7 @@ bool ApcHidProtocol::beeper_enable() {
 }
 
 bool ApcHidProtocol::beeper_disable() {
-  ESP_LOGD(APC_HID_TAG, "Sending APC beeper disable command");
+  UPS_HID_LOGD(APC_HID_TAG, "Sending APC beeper disable command");
   
   // APC DEVICE SPECIFIC: From NUT debug, your device supports TWO beeper report IDs:
   // APC_REPORT_ID_AUDIBLE_ALARM: UPS.PowerSummary.AudibleAlarmControl
@@ -1639,7 +1765,7 @@ bool ApcHidProtocol::beeper_disable() {
   
   for (size_t i = 0; i < sizeof(report_ids_to_try); i++) {
     uint8_t report_id = report_ids_to_try[i];
-    ESP_LOGD(APC_HID_TAG, "Trying beeper disable with report ID 0x%02X", report_id);
+    UPS_HID_LOGD(APC_HID_TAG, "Trying beeper disable with report ID 0x%02X", report_id);
     
     uint8_t beeper_data[2] = {report_id, beeper::CONTROL_DISABLE};  // Report ID, Value=1 (disabled)
     
@@ -1648,7 +1774,7 @@ bool ApcHidProtocol::beeper_disable() {
       ESP_LOGI(APC_HID_TAG, "APC beeper disabled successfully with report ID 0x%02X", report_id);
       return true;
     } else {
-      ESP_LOGD(APC_HID_TAG, "Failed with report ID 0x%02X: %s", report_id, esp_err_to_name(ret));
+      UPS_HID_LOGD(APC_HID_TAG, "Failed with report ID 0x%02X: %s", report_id, esp_err_to_name(ret));
     }
   }
   
@@ -1657,7 +1783,7 @@ bool ApcHidProtocol::beeper_disable() {
 }
 
 bool ApcHidProtocol::beeper_mute() {
-  ESP_LOGD(APC_HID_TAG, "Sending APC beeper mute command");
+  UPS_HID_LOGD(APC_HID_TAG, "Sending APC beeper mute command");
   
   // MUTE FUNCTIONALITY (Value 3):
   // - Acknowledges and silences current active alarms
@@ -1669,7 +1795,7 @@ bool ApcHidProtocol::beeper_mute() {
   
   for (size_t i = 0; i < sizeof(report_ids_to_try); i++) {
     uint8_t report_id = report_ids_to_try[i];
-    ESP_LOGD(APC_HID_TAG, "Trying beeper mute (acknowledge alarms) with report ID 0x%02X", report_id);
+    UPS_HID_LOGD(APC_HID_TAG, "Trying beeper mute (acknowledge alarms) with report ID 0x%02X", report_id);
     
     uint8_t beeper_data[2] = {report_id, beeper::CONTROL_MUTE};  // Report ID, Value=3 (muted/acknowledged)
     
@@ -1678,7 +1804,7 @@ bool ApcHidProtocol::beeper_mute() {
       ESP_LOGI(APC_HID_TAG, "APC beeper muted (current alarms acknowledged) with report ID 0x%02X", report_id);
       return true;
     } else {
-      ESP_LOGD(APC_HID_TAG, "Failed with report ID 0x%02X: %s", report_id, esp_err_to_name(ret));
+      UPS_HID_LOGD(APC_HID_TAG, "Failed with report ID 0x%02X: %s", report_id, esp_err_to_name(ret));
     }
   }
   
@@ -1687,7 +1813,7 @@ bool ApcHidProtocol::beeper_mute() {
 }
 
 bool ApcHidProtocol::beeper_test() {
-  ESP_LOGD(APC_HID_TAG, "Starting APC beeper test sequence");
+  UPS_HID_LOGD(APC_HID_TAG, "Starting APC beeper test sequence");
   
   // First, read current beeper status to restore later
   HidReport current_report;
@@ -1870,7 +1996,7 @@ void ApcHidProtocol::parse_test_result_report(const HidReport &report, UpsData &
   // 4 = "Aborted", 5 = "In progress", 6 = "No test initiated", 7 = "Test scheduled"
   uint8_t test_result_value = report.data[1];
   
-  ESP_LOGD(APC_HID_TAG, "Raw test result from report 0x%02X: 0x%02X (%d)", APC_REPORT_ID_TEST_RESULT, test_result_value, test_result_value);
+  UPS_HID_LOGD(APC_HID_TAG, "Raw test result from report 0x%02X: 0x%02X (%d)", APC_REPORT_ID_TEST_RESULT, test_result_value, test_result_value);
   
   switch (test_result_value) {
     case 1:
@@ -1903,45 +2029,35 @@ void ApcHidProtocol::parse_test_result_report(const HidReport &report, UpsData &
   ESP_LOGI(APC_HID_TAG, "APC Test result: %s (raw: %d)", data.test.ups_test_result.c_str(), test_result_value);
 }
 
-void ApcHidProtocol::read_frequency_data(UpsData &data) {
+void ApcHidProtocol::read_frequency_data(const HidReport *candidates, size_t count, UpsData &data) {
   // Initialize frequency to NaN
   data.power.frequency = NAN;
   
-  // Try to read frequency from various HID report IDs
-  // Based on NUT reference, frequency is typically in input/output measurement reports
-  
-  // Report IDs commonly used for frequency measurements:
-  const std::vector<uint8_t> frequency_report_ids = {
-    APC_REPORT_ID_FREQUENCY,     // APC-specific config report (apparent power and frequency) - PRIORITY
-    HID_USAGE_POW_FREQUENCY,     // Standard HID frequency usage
-    HID_USAGE_POW_VOLTAGE,       // Input measurements (may include frequency)  
-    HID_USAGE_POW_CURRENT,       // Output measurements (may include frequency)
-    HID_USAGE_POW_OUTPUT,        // Output collection (might contain frequency)
-    HID_USAGE_POW_INPUT,         // Input collection (might contain frequency)
-  };
-  
-  for (uint8_t report_id : frequency_report_ids) {
-    HidReport freq_report;
-    if (read_hid_report(report_id, freq_report)) {
-      float frequency_value = parse_frequency_from_report(freq_report);
-      if (!std::isnan(frequency_value)) {
-        data.power.frequency = frequency_value;
-        ESP_LOGD(APC_HID_TAG, "Found frequency %.1f Hz in report 0x%02X", frequency_value, report_id);
-        return;
-      }
+  // Candidates come from the fast poll batch in priority order
+  // (see APC_FAST_POLL_REPORT_IDS)
+  for (size_t i = 0; i < count; i++) {
+    const HidReport &freq_report = candidates[i];
+    if (freq_report.data.empty()) {
+      continue;
+    }
+    float frequency_value = parse_frequency_from_report(freq_report);
+    if (!std::isnan(frequency_value)) {
+      data.power.frequency = frequency_value;
+      UPS_HID_LOGD(APC_HID_TAG, "Found frequency %.1f Hz in report 0x%02X", frequency_value, freq_report.report_id);
+      return;
     }
   }
   
-  ESP_LOGV(APC_HID_TAG, "Frequency data not available from any HID report");
+  UPS_HID_LOGV(APC_HID_TAG, "Frequency data not available from any HID report");
 }
 
 float ApcHidProtocol::parse_frequency_from_report(const HidReport &report) {
   if (report.data.size() < 2) {
-    ESP_LOGV(APC_HID_TAG, "Frequency report 0x%02X too short: %zu bytes", report.data[0], report.data.size());
+    UPS_HID_LOGV(APC_HID_TAG, "Frequency report 0x%02X too short: %zu bytes", report.data[0], report.data.size());
     return NAN;
   }
   
-  ESP_LOGD(APC_HID_TAG, "Parsing frequency from report 0x%02X (%zu bytes): %02X %02X %02X %02X", 
+  UPS_HID_LOGD(APC_HID_TAG, "Parsing frequency from report 0x%02X (%zu bytes): %02X %02X %02X %02X", 
            report.data[0], report.data.size(), 
            report.data.size() > 0 ? report.data[0] : 0,
            report.data.size() > 1 ? report.data[1] : 0,
@@ -1950,10 +2066,10 @@ float ApcHidProtocol::parse_frequency_from_report(const HidReport &report) {
   
   // APC-specific method: Report APC_REPORT_ID_FREQUENCY frequency at byte[3] (based on ESP32 NUT server documentation)
   if (report.data[0] == APC_REPORT_ID_FREQUENCY) {
-    ESP_LOGD(APC_HID_TAG, "APC Method - Report 0x%02X analysis: size=%zu bytes", APC_REPORT_ID_FREQUENCY, report.data.size());
+    UPS_HID_LOGD(APC_HID_TAG, "APC Method - Report 0x%02X analysis: size=%zu bytes", APC_REPORT_ID_FREQUENCY, report.data.size());
     if (report.data.size() >= 4) {
       uint8_t freq_byte = report.data[3];
-      ESP_LOGV(APC_HID_TAG, "APC Method - Report 0x%02X byte[3]: %d (0x%02X) - Range check: %s", APC_REPORT_ID_FREQUENCY, 
+      UPS_HID_LOGV(APC_HID_TAG, "APC Method - Report 0x%02X byte[3]: %d (0x%02X) - Range check: %s", APC_REPORT_ID_FREQUENCY, 
                freq_byte, freq_byte,
                (freq_byte >= FREQUENCY_MIN_VALID && freq_byte <= FREQUENCY_MAX_VALID) ? "PASS" : "FAIL");
       if (freq_byte >= FREQUENCY_MIN_VALID && freq_byte <= FREQUENCY_MAX_VALID) {
@@ -1965,7 +2081,7 @@ float ApcHidProtocol::parse_frequency_from_report(const HidReport &report) {
       // Try alternative: byte[1] might contain frequency or frequency-derived value in some APC models
       if (report.data.size() >= 2) {
         uint8_t alt_freq = report.data[1];
-        ESP_LOGV(APC_HID_TAG, "APC Method - Report 0x%02X byte[1]: %d (0x%02X)", APC_REPORT_ID_FREQUENCY, alt_freq, alt_freq);
+        UPS_HID_LOGV(APC_HID_TAG, "APC Method - Report 0x%02X byte[1]: %d (0x%02X)", APC_REPORT_ID_FREQUENCY, alt_freq, alt_freq);
         
         // Check if this could be a frequency indicator (100 -> 50Hz, 120 -> 60Hz)
         if (alt_freq == 100) {
@@ -1985,7 +2101,7 @@ float ApcHidProtocol::parse_frequency_from_report(const HidReport &report) {
   // Method 1: Single byte at position 1 (common for simple frequency reports)
   if (report.data.size() >= 2) {
     uint8_t freq_byte = report.data[1];
-    ESP_LOGV(APC_HID_TAG, "Method 1 - Testing byte[1]: %d (0x%02X) - Range check: %s", 
+    UPS_HID_LOGV(APC_HID_TAG, "Method 1 - Testing byte[1]: %d (0x%02X) - Range check: %s", 
              freq_byte, freq_byte,
              (freq_byte >= FREQUENCY_MIN_VALID && freq_byte <= FREQUENCY_MAX_VALID) ? "PASS" : "FAIL");
     if (freq_byte >= FREQUENCY_MIN_VALID && freq_byte <= FREQUENCY_MAX_VALID) {
@@ -1997,7 +2113,7 @@ float ApcHidProtocol::parse_frequency_from_report(const HidReport &report) {
   // Method 2: 16-bit little-endian value at position 1-2
   if (report.data.size() >= 3) {
     uint16_t freq_word = report.data[1] | (report.data[2] << 8);
-    ESP_LOGV(APC_HID_TAG, "Method 2 - Testing little-endian word[1-2]: %d (0x%04X) - Range check: %s", 
+    UPS_HID_LOGV(APC_HID_TAG, "Method 2 - Testing little-endian word[1-2]: %d (0x%04X) - Range check: %s", 
              freq_word, freq_word,
              (freq_word >= FREQUENCY_MIN_VALID && freq_word <= FREQUENCY_MAX_VALID) ? "PASS" : "FAIL");
     if (freq_word >= FREQUENCY_MIN_VALID && freq_word <= FREQUENCY_MAX_VALID) {
@@ -2009,7 +2125,7 @@ float ApcHidProtocol::parse_frequency_from_report(const HidReport &report) {
   // Method 3: 16-bit big-endian value at position 1-2
   if (report.data.size() >= 3) {
     uint16_t freq_word = (report.data[1] << 8) | report.data[2];
-    ESP_LOGV(APC_HID_TAG, "Method 3 - Testing big-endian word[1-2]: %d (0x%04X) - Range check: %s", 
+    UPS_HID_LOGV(APC_HID_TAG, "Method 3 - Testing big-endian word[1-2]: %d (0x%04X) - Range check: %s", 
              freq_word, freq_word,
              (freq_word >= FREQUENCY_MIN_VALID && freq_word <= FREQUENCY_MAX_VALID) ? "PASS" : "FAIL");
     if (freq_word >= FREQUENCY_MIN_VALID && freq_word <= FREQUENCY_MAX_VALID) {
@@ -2022,7 +2138,7 @@ float ApcHidProtocol::parse_frequency_from_report(const HidReport &report) {
   if (report.data.size() >= 3) {
     uint16_t freq_scaled = report.data[1] | (report.data[2] << 8);
     float freq_value = static_cast<float>(freq_scaled) / battery::VOLTAGE_SCALE_FACTOR;
-    ESP_LOGV(APC_HID_TAG, "Method 4 - Testing scaled frequency: raw=%d, scaled=%.1f - Range check: %s", 
+    UPS_HID_LOGV(APC_HID_TAG, "Method 4 - Testing scaled frequency: raw=%d, scaled=%.1f - Range check: %s", 
              freq_scaled, freq_value,
              (freq_value >= FREQUENCY_MIN_VALID && freq_value <= FREQUENCY_MAX_VALID) ? "PASS" : "FAIL");
     if (freq_value >= FREQUENCY_MIN_VALID && freq_value <= FREQUENCY_MAX_VALID) {
@@ -2035,7 +2151,7 @@ float ApcHidProtocol::parse_frequency_from_report(const HidReport &report) {
   if (report.data.size() >= 3) {
     uint16_t freq_scaled = report.data[1] | (report.data[2] << 8);
     float freq_value = static_cast<float>(freq_scaled) / battery::MAX_LEVEL_PERCENT;
-    ESP_LOGV(APC_HID_TAG, "Method 5 - Testing APC centihz frequency: raw=%d, scaled=%.2f - Range check: %s", 
+    UPS_HID_LOGV(APC_HID_TAG, "Method 5 - Testing APC centihz frequency: raw=%d, scaled=%.2f - Range check: %s", 
              freq_scaled, freq_value,
              (freq_value >= FREQUENCY_MIN_VALID && freq_value <= FREQUENCY_MAX_VALID) ? "PASS" : "FAIL");
     if (freq_value >= FREQUENCY_MIN_VALID && freq_value <= FREQUENCY_MAX_VALID) {
@@ -2048,7 +2164,7 @@ float ApcHidProtocol::parse_frequency_from_report(const HidReport &report) {
   if (report.data.size() >= 3) {
     uint16_t freq_scaled = (report.data[1] << 8) | report.data[2];
     float freq_value = static_cast<float>(freq_scaled) / battery::MAX_LEVEL_PERCENT;
-    ESP_LOGV(APC_HID_TAG, "Method 6 - Testing APC big-endian centihz: raw=%d, scaled=%.2f - Range check: %s", 
+    UPS_HID_LOGV(APC_HID_TAG, "Method 6 - Testing APC big-endian centihz: raw=%d, scaled=%.2f - Range check: %s", 
              freq_scaled, freq_value,
              (freq_value >= FREQUENCY_MIN_VALID && freq_value <= FREQUENCY_MAX_VALID) ? "PASS" : "FAIL");
     if (freq_value >= FREQUENCY_MIN_VALID && freq_value <= FREQUENCY_MAX_VALID) {
@@ -2065,74 +2181,33 @@ float ApcHidProtocol::parse_frequency_from_report(const HidReport &report) {
     }
   }
   
-  ESP_LOGD(APC_HID_TAG, "No valid frequency found in report 0x%02X (tried 7 methods)", report.data[0]);
+  UPS_HID_LOGD(APC_HID_TAG, "No valid frequency found in report 0x%02X (tried 7 methods)", report.data[0]);
   return NAN;
 }
 
 void ApcHidProtocol::detect_nominal_power_rating(const std::string& model_name, UpsData &data) {
-  ESP_LOGD(APC_HID_TAG, "Detecting nominal power rating for model: \"%s\"", model_name.c_str());
-  
-  // APC Back-UPS ES Series Power Ratings (based on model identification)
-  // Reference: APC product specifications and actual device testing
-  
-  // Convert model name to lowercase for case-insensitive matching
-  std::string model_lower = model_name;
-  std::transform(model_lower.begin(), model_lower.end(), model_lower.begin(), ::tolower);
+  UPS_HID_LOGD(APC_HID_TAG, "Detecting nominal power rating for model: \"%s\"", model_name.c_str());
   
   float nominal_power_watts = 0.0f;
   
-  if (model_lower.find("back-ups es 350") != std::string::npos) {
-    nominal_power_watts = 200.0f;  // 350VA ≈ 200W
-  }
-  else if (model_lower.find("back-ups es 425") != std::string::npos) {
-    nominal_power_watts = 255.0f;  // 425VA ≈ 255W  
-  }
-  else if (model_lower.find("back-ups es 500") != std::string::npos) {
-    nominal_power_watts = 300.0f;  // 500VA ≈ 300W
-  }
-  else if (model_lower.find("back-ups es 550") != std::string::npos) {
-    nominal_power_watts = 330.0f;  // 550VA ≈ 330W
-  }
-  else if (model_lower.find("back-ups es 650") != std::string::npos) {
-    nominal_power_watts = 390.0f;  // 650VA ≈ 390W
-  }
-  else if (model_lower.find("back-ups es 700") != std::string::npos || 
-           model_lower.find("back-ups es 700g") != std::string::npos) {
-    nominal_power_watts = 405.0f;  // 700VA ≈ 405W (confirmed from config)
-  }
-  else if (model_lower.find("back-ups es 750") != std::string::npos) {
-    nominal_power_watts = 450.0f;  // 750VA ≈ 450W
-  }
-  else if (model_lower.find("back-ups es 850") != std::string::npos) {
-    nominal_power_watts = 510.0f;  // 850VA ≈ 510W
-  }
-  else if (model_lower.find("back-ups es 900") != std::string::npos) {
-    nominal_power_watts = 540.0f;  // 900VA ≈ 540W
-  }
-  else if (model_lower.find("back-ups es 1000") != std::string::npos) {
-    nominal_power_watts = 600.0f;  // 1000VA ≈ 600W
-  }
-  else if (model_lower.find("back-ups es 1200") != std::string::npos) {
-    nominal_power_watts = 720.0f;  // 1200VA ≈ 720W
-  }
-  else if (model_lower.find("back-ups es 1400") != std::string::npos) {
-    nominal_power_watts = 840.0f;  // 1400VA ≈ 840W
+  const ApcPowerRating *rating = std::find_if(std::begin(APC_POWER_RATINGS), std::end(APC_POWER_RATINGS),
+      [&model_name](const ApcPowerRating &entry) { return contains_ignore_case(model_name, entry.model); });
+  if (rating != std::end(APC_POWER_RATINGS)) {
+    nominal_power_watts = rating->watts;
   }
   
   // Generic fallback patterns for other APC Back-UPS models
-  else if (model_lower.find("back-ups") != std::string::npos) {
+  else if (contains_ignore_case(model_name, "back-ups")) {
     // Try to extract VA rating from model name (e.g., "Back-UPS 1500")
-    std::regex va_pattern(R"(\b(\d{3,4})\b)");  // Match 3-4 digit numbers
-    std::smatch match;
-    if (std::regex_search(model_lower, match, va_pattern)) {
-      int va_rating = std::stoi(match[1].str());
+    int va_rating = find_va_rating(model_name);
+    if (va_rating > 0) {
       // Typical APC power factor is ~0.6 for ES series, ~0.7 for higher-end
-      if (model_lower.find(" es ") != std::string::npos) {
+      if (contains_ignore_case(model_name, " es ")) {
         nominal_power_watts = va_rating * 0.6f;  // ES series: lower power factor
       } else {
         nominal_power_watts = va_rating * 0.7f;  // Pro/Smart series: higher power factor
       }
-      ESP_LOGD(APC_HID_TAG, "Extracted VA rating %d from model, calculated %0.1fW", va_rating, nominal_power_watts);
+      UPS_HID_LOGD(APC_HID_TAG, "Extracted VA rating %d from model, calculated %0.1fW", va_rating, nominal_power_watts);
     }
   }
   
@@ -2148,7 +2223,7 @@ void ApcHidProtocol::detect_nominal_power_rating(const std::string& model_name,
 }
 
 bool ApcHidProtocol::read_timer_data(UpsData &data) {
-  ESP_LOGD(APC_HID_TAG, "Reading APC timer countdown data");
+  UPS_HID_LOGD(APC_HID_TAG, "Reading APC timer countdown data");
   
   HidReport delay_shutdown_report;
   HidReport delay_reboot_report;
@@ -2166,13 +2241,13 @@ bool ApcHidProtocol::read_timer_data(UpsData &data) {
         delay_shutdown_report.data[1] | (delay_shutdown_report.data[2] << 8)
       );
       
-      ESP_LOGD(APC_HID_TAG, "Raw timer shutdown HID value: %d", raw_timer_value);
+      UPS_HID_LOGD(APC_HID_TAG, "Raw timer shutdown HID value: %d", raw_timer_value);
       
       // Follow NUT convention: negative = inactive, positive = active countdown
       if (raw_timer_value == -1) {
         // Timer is inactive (normal operation)
         data.test.timer_shutdown = -1;
-        ESP_LOGV(APC_HID_TAG, "Timer shutdown inactive (normal operation)");
+        UPS_HID_LOGV(APC_HID_TAG, "Timer shutdown inactive (normal operation)");
       } else if (raw_timer_value > 0) {
         // Timer is actively counting down
         data.test.timer_shutdown = raw_timer_value;
@@ -2180,7 +2255,7 @@ bool ApcHidProtocol::read_timer_data(UpsData &data) {
       } else {
         // Other negative values - treat as inactive but preserve the value
         data.test.timer_shutdown = raw_timer_value;
-        ESP_LOGV(APC_HID_TAG, "Timer shutdown inactive: %d", raw_timer_value);
+        UPS_HID_LOGV(APC_HID_TAG, "Timer shutdown inactive: %d", raw_timer_value);
       }
     } else {
       // Fallback if report is too short
@@ -2199,16 +2274,16 @@ bool ApcHidProtocol::read_timer_data(UpsData &data) {
     if (delay_reboot_report.data.size() >= 2) {
       uint8_t raw_reboot_value = delay_reboot_report.data[1];
       
-      ESP_LOGD(APC_HID_TAG, "Raw timer reboot HID value: %d", raw_reboot_value);
+      UPS_HID_LOGD(APC_HID_TAG, "Raw timer reboot HID value: %d", raw_reboot_value);
       
       // APC reboot timer: 0 typically means no reboot delay (immediate)
       if (raw_reboot_value == 0) {
         data.test.timer_reboot = -1; // Inactive (or immediate reboot)
-        ESP_LOGV(APC_HID_TAG, "Timer reboot inactive (immediate/no delay)");
+        UPS_HID_LOGV(APC_HID_TAG, "Timer reboot inactive (immediate/no delay)");
       } else {
         // Positive value indicates active reboot countdown
         data.test.timer_reboot = static_cast<int>(raw_reboot_value);
-        ESP_LOGD(APC_HID_TAG, "Timer reboot countdown: %d seconds", raw_reboot_value);
+        UPS_HID_LOGD(APC_HID_TAG, "Timer reboot countdown: %d seconds", raw_reboot_value);
       }
     } else {
       data.test.timer_reboot = -1;
@@ -2221,7 +2296,7 @@ bool ApcHidProtocol::read_timer_data(UpsData &data) {
   data.test.timer_start = data.test.timer_reboot;
   
   if (success) {
-    ESP_LOGD(APC_HID_TAG, "APC timer data updated - shutdown: %d, start: %d, reboot: %d",
+    UPS_HID_LOGD(APC_HID_TAG, "APC timer data updated - shutdown: %d, start: %d, reboot: %d",
              data.test.timer_shutdown, data.test.timer_start, data.test.timer_reboot);
   }
   
@@ -2255,7 +2330,7 @@ bool ApcHidProtocol::set_shutdown_delay(int seconds) {
   delay_data[0] = seconds & 0xFF;           // Low byte
   delay_data[1] = (seconds >> 8) & 0xFF;    // High byte
   
-  ESP_LOGD(APC_HID_TAG, "Writing shutdown delay: Report 0x%02X, Value: %d (0x%02X 0x%02X)", 
+  UPS_HID_LOGD(APC_HID_TAG, "Writing shutdown delay: Report 0x%02X, Value: %d (0x%02X 0x%02X)", 
            APC_REPORT_ID_DELAY_SHUTDOWN, seconds, delay_data[0], delay_data[1]);
   
   // Attempt SET_REPORT via control transfer (works even on INPUT-ONLY devices sometimes)
@@ -2295,7 +2370,7 @@ bool ApcHidProtocol::set_start_delay(int seconds) {
   uint8_t delay_data[1];
   delay_data[0] = std::min(seconds, 255);  // Limit to 255 for single byte
   
-  ESP_LOGD(APC_HID_TAG, "Writing start/reboot delay: Report 0x%02X, Value: %d (0x%02X)", 
+  UPS_HID_LOGD(APC_HID_TAG, "Writing start/reboot delay: Report 0x%02X, Value: %d (0x%02X)", 
            APC_REPORT_ID_DELAY_REBOOT, delay_data[0], delay_data[0]);
   
   // Attempt SET_REPORT via control transfer
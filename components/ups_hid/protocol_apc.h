@@ -1,6 +1,8 @@
 #pragma once
 
 #include "ups_hid.h"
+#include "hid_report.h"
+#include "log_ups.h"
 
 namespace esphome {
 namespace ups_hid {
@@ -8,21 +10,19 @@ namespace ups_hid {
 // APC HID Protocol implementation for modern APC UPS devices
 class ApcHidProtocol : public UpsProtocolBase {
 public:
-  // Public struct for use by report parsers
-  struct HidReport {
-    uint8_t report_id;
-    std::vector<uint8_t> data;
-    
-    HidReport() : report_id(0) {}
-  };
+  // Inline report storage shared by all protocols (see hid_report.h)
+  using HidReport = ups_hid::HidReport;
   
   explicit ApcHidProtocol(UpsHidComponent *parent);
   
   bool detect() override;
+  size_t get_probe_report_ids(const uint8_t **report_ids) const override;
   bool initialize() override;
   bool read_data(UpsData &data) override;
+  bool read_report_group(ReportGroup group, UpsData &data) override;
   DeviceInfo::DetectedProtocol get_protocol_type() const override { return DeviceInfo::PROTOCOL_APC_HID; }
   std::string get_protocol_name() const override { return "APC HID Protocol"; }
+  size_t get_memory_usage() const override { return sizeof(*this); }
   
   // Beeper control methods
   bool beeper_enable() override;
@@ -48,6 +48,13 @@ public:
 private:
 
   bool init_hid_communication();
+  
+  // Report groups
+  bool read_status_reports(UpsData &data);
+  bool read_identity(UpsData &data);
+  void read_configuration(UpsData &data);
+  void update_battery_status(UpsData &data);
+  void update_idle_timers(UpsData &data);
   bool read_hid_report(uint8_t report_id, HidReport &report);
   bool write_hid_report(const HidReport &report);
   
@@ -64,7 +71,11 @@ private:
   void parse_load_report(const HidReport &report, UpsData &data);
   void read_device_info();
   void parse_device_info_report(const HidReport &report);
+#if UPS_HID_LOG_DEBUG_ENABLED
   void log_raw_data(const uint8_t* buffer, size_t buffer_len);
+#else
+  void log_raw_data(const uint8_t* buffer, size_t buffer_len) {}  // Hex dumps compiled out by debug_level
+#endif
   
   // Device information parsing
   void read_device_information(UpsData &data);
@@ -92,7 +103,7 @@ private:
   void detect_nominal_power_rating(const std::string& model_name, UpsData &data);
   
   // Frequency reading methods
-  void read_frequency_data(UpsData &data);
+  void read_frequency_data(const HidReport *candidates, size_t count, UpsData &data);
   float parse_frequency_from_report(const HidReport &report);
 };
 
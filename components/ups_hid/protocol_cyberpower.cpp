@@ -6,47 +6,47 @@
 #include "freertos/task.h"
 #include "freertos/portmacro.h"
 #include "esp_err.h"
-#include "esphome/core/log.h"
+#include "log_ups.h"
 #include <algorithm>
 #include <cctype>
+#include <cmath>
 
 namespace esphome {
 namespace ups_hid {
 
 static const char *const CP_TAG = "ups_hid.cyberpower_hid";
 
+// Report IDs that are known to work with CyberPower devices, based on NUT debug logs
+static constexpr uint8_t CP_PROBE_REPORT_IDS[] = {
+  0x08, // Battery % + Runtime (primary data)
+  0x0b, // Status bitmap (PresentStatus)
+  0x0f, // Input voltage
+  0x13, // Load percentage
+  0x0a  // Battery voltage
+};
+
 bool CyberPowerProtocol::detect() {
-  ESP_LOGD(CP_TAG, "Detecting CyberPower HID protocol");
+  UPS_HID_LOGD(CP_TAG, "Detecting CyberPower HID protocol");
   
   // Check device connection status first
   if (!parent_->is_device_connected()) {
-    ESP_LOGD(CP_TAG, "Device not connected, skipping protocol detection");
+    UPS_HID_LOGD(CP_TAG, "Device not connected, skipping protocol detection");
     return false;
   }
   
   // Give device time to initialize after connection (same as APC)
   vTaskDelay(pdMS_TO_TICKS(timing::USB_INITIALIZATION_DELAY_MS));
   
-  // Test multiple report IDs that are known to work with CyberPower devices
-  // Based on NUT debug logs
-  const uint8_t test_report_ids[] = {
-    0x08, // Battery % + Runtime (primary data)
-    0x0b, // Status bitmap (PresentStatus)
-    0x0f, // Input voltage
-    0x13, // Load percentage
-    0x0a  // Battery voltage
-  };
-  
   HidReport test_report;
   
-  for (uint8_t report_id : test_report_ids) {
+  for (uint8_t report_id : CP_PROBE_REPORT_IDS) {
     // Check device connection before each report attempt
     if (!parent_->is_device_connected()) {
-      ESP_LOGD(CP_TAG, "Device disconnected during protocol detection");
+      UPS_HID_LOGD(CP_TAG, "Device disconnected during protocol detection");
       return false;
     }
     
-    ESP_LOGD(CP_TAG, "Testing report ID 0x%02X...", report_id);
+    UPS_HID_LOGD(CP_TAG, "Testing report ID 0x%02X...", report_id);
     
     if (read_hid_report(report_id, test_report)) {
       ESP_LOGI(CP_TAG, "CyberPower HID protocol detected via report 0x%02X (%zu bytes)", 
@@ -58,10 +58,15 @@ bool CyberPowerProtocol::detect() {
     vTaskDelay(pdMS_TO_TICKS(timing::REPORT_RETRY_DELAY_MS));
   }
   
-  ESP_LOGD(CP_TAG, "CyberPower HID protocol not detected");
+  UPS_HID_LOGD(CP_TAG, "CyberPower HID protocol not detected");
   return false;
 }
 
+size_t CyberPowerProtocol::get_probe_report_ids(const uint8_t **report_ids) const {
+  *report_ids = CP_PROBE_REPORT_IDS;
+  return sizeof(CP_PROBE_REPORT_IDS);
+}
+
 bool CyberPowerProtocol::initialize() {
   ESP_LOGI(CP_TAG, "Initializing CyberPower HID protocol");
   
@@ -72,114 +77,218 @@ bool CyberPowerProtocol::initialize() {
   return true;
 }
 
+bool CyberPowerProtocol::save_discovery(ProtocolDiscovery &discovery) const {
+  discovery.battery_voltage_scale = battery_scale_checked_ ? battery_voltage_scale_ : 0.0f;
+  return battery_scale_checked_;
+}
+
+bool CyberPowerProtocol::initialize_from_discovery(const ProtocolDiscovery &discovery) {
+  if (!initialize()) {
+    return false;
+  }
+  if (discovery.battery_voltage_scale > 0.0f) {
+    battery_voltage_scale_ = discovery.battery_voltage_scale;
+    battery_scale_checked_ = true;
+    UPS_HID_LOGD(CP_TAG, "Battery voltage scale %.3f restored from cache", battery_voltage_scale_);
+  }
+  return true;
+}
+
 bool CyberPowerProtocol::read_data(UpsData &data) {
-  ESP_LOGD(CP_TAG, "Reading CyberPower HID data");
+  // Full read of every group; the component normally schedules them separately
+  if (!read_report_group(ReportGroup::FAST, data)) {
+    // Leave manufacturer and model unset when HID communication fails
+    data.device.manufacturer.clear();
+    data.device.model.clear();
+    return false;
+  }
+  read_report_group(ReportGroup::STATIC, data);
+  read_report_group(ReportGroup::SLOW, data);
+  return true;
+}
+
+bool CyberPowerProtocol::read_report_group(ReportGroup group, UpsData &data) {
+  switch (group) {
+    case ReportGroup::FAST:
+      return read_status_reports(data);
+    case ReportGroup::SLOW:
+      read_configuration(data);
+      return true;
+    case ReportGroup::STATIC:
+      return read_identity(data);
+  }
+  return false;
+}
+
+bool CyberPowerProtocol::read_status_reports(UpsData &data) {
+  UPS_HID_LOGD(CP_TAG, "Reading CyberPower HID data");
+  
+  // The whole fast poll is one batch; the frequency candidates close the list
+  // in priority order
+  static constexpr uint8_t REPORT_IDS[] = {
+    BATTERY_CAPACITY_REPORT_ID,
+    BATTERY_RUNTIME_REPORT_ID,
+    PRESENT_STATUS_REPORT_ID,
+    INPUT_VOLTAGE_REPORT_ID,
+    OUTPUT_VOLTAGE_REPORT_ID,
+    LOAD_PERCENT_REPORT_ID,
+    BATTERY_VOLTAGE_REPORT_ID,
+    OVERLOAD_REPORT_ID,
+    TEST_RESULT_REPORT_ID,
+    HID_USAGE_POW_FREQUENCY,     // 0x32 - Standard HID frequency usage
+    HID_USAGE_POW_VOLTAGE,       // 0x30 - Input measurements (may include frequency)  
+    HID_USAGE_POW_CURRENT,       // 0x31 - Output measurements (may include frequency)
+    0x11,                        // CyberPower-specific frequency report (based on NUT analysis)
+    INPUT_VOLTAGE_REPORT_ID,     // 0x0F - might contain frequency data (read once, see read_reports)
+    OUTPUT_VOLTAGE_REPORT_ID,    // 0x12 - might contain frequency data
+  };
+  static constexpr size_t REPORT_COUNT = sizeof(REPORT_IDS);
+  static constexpr size_t FREQUENCY_FIRST = 9;
+  static_assert(REPORT_COUNT <= limits::MAX_REPORT_BATCH, "CyberPower fast poll exceeds one report batch");
+  
+  // CyberPower devices primarily use Feature Reports - based on NUT debug logs
+  HidReport reports[REPORT_COUNT];
+  read_reports(REPORT_IDS, reports, REPORT_COUNT, HID_REPORT_TYPE_FEATURE);
+  const HidReport &battery_capacity_report = reports[0];
+  const HidReport &battery_runtime_report = reports[1];
+  const HidReport &status_report = reports[2];
+  const HidReport &input_voltage_report = reports[3];
+  const HidReport &output_voltage_report = reports[4];
+  const HidReport &load_report = reports[5];
+  const HidReport &battery_voltage_report = reports[6];
+  const HidReport &overload_report = reports[7];
+  const HidReport &test_result_report = reports[8];
   
   bool success = false;
 
   // Core sensors (essential for operation)
-  // Read battery capacity limits (Report 0x07) - includes FullChargeCapacity for battery.status
-  HidReport battery_capacity_report;
-  if (read_hid_report(BATTERY_CAPACITY_REPORT_ID, battery_capacity_report)) {
+  // Battery capacity limits (Report 0x07) - includes FullChargeCapacity for battery.status
+  if (!battery_capacity_report.data.empty()) {
     parse_battery_capacity_report(battery_capacity_report, data);
     success = true;
   }
   
-  // Read battery level and runtime (Report 0x08)
-  HidReport battery_runtime_report;
-  if (read_hid_report(BATTERY_RUNTIME_REPORT_ID, battery_runtime_report)) {
+  // Battery level and runtime (Report 0x08)
+  if (!battery_runtime_report.data.empty()) {
     parse_battery_runtime_report(battery_runtime_report, data);
     success = true;
   }
 
-  // Read status flags (Report 0x0b)
-  HidReport status_report;
-  if (read_hid_report(PRESENT_STATUS_REPORT_ID, status_report)) {
+  // Status flags (Report 0x0b)
+  if (!status_report.data.empty()) {
     parse_present_status_report(status_report, data);
     success = true;
   }
 
-  // Read input voltage (Report 0x0f)
-  HidReport input_voltage_report;
-  if (read_hid_report(INPUT_VOLTAGE_REPORT_ID, input_voltage_report)) {
+  // Input voltage (Report 0x0f)
+  if (!input_voltage_report.data.empty()) {
     parse_input_voltage_report(input_voltage_report, data);
     success = true;
   }
 
-  // Read output voltage (Report 0x12)
-  HidReport output_voltage_report;
-  if (read_hid_report(OUTPUT_VOLTAGE_REPORT_ID, output_voltage_report)) {
+  // Output voltage (Report 0x12)
+  if (!output_voltage_report.data.empty()) {
     parse_output_voltage_report(output_voltage_report, data);
     success = true;
   }
 
-  // Read load percentage (Report 0x13)
-  HidReport load_report;
-  if (read_hid_report(LOAD_PERCENT_REPORT_ID, load_report)) {
+  // Load percentage (Report 0x13)
+  if (!load_report.data.empty()) {
     parse_load_percent_report(load_report, data);
     success = true;
   }
 
+  if (!success) {
+    ESP_LOGW(CP_TAG, "Failed to read any CyberPower HID reports");
+    return false;
+  }
+
   // Additional sensors (enhance functionality)
-  // Read battery voltage (Report 0x0a) 
-  HidReport battery_voltage_report;
-  if (read_hid_report(BATTERY_VOLTAGE_REPORT_ID, battery_voltage_report)) {
+  // Battery voltage (Report 0x0a) 
+  if (!battery_voltage_report.data.empty()) {
     parse_battery_voltage_report(battery_voltage_report, data);
   }
 
-  // Read battery voltage nominal (Report 0x09)
-  HidReport battery_voltage_nominal_report;
-  if (read_hid_report(BATTERY_VOLTAGE_NOMINAL_REPORT_ID, battery_voltage_nominal_report)) {
-    parse_battery_voltage_nominal_report(battery_voltage_nominal_report, data);
+  // Overload status (Report 0x17)
+  if (!overload_report.data.empty()) {
+    parse_overload_report(overload_report, data);
   }
 
-  // Read input voltage nominal (Report 0x0e)
-  HidReport input_voltage_nominal_report;
-  if (read_hid_report(INPUT_VOLTAGE_NOMINAL_REPORT_ID, input_voltage_nominal_report)) {
-    parse_input_voltage_nominal_report(input_voltage_nominal_report, data);
+  // Test result (Report 0x14) - same report ID used for test commands
+  if (!test_result_report.data.empty()) {
+    parse_test_result_report(test_result_report, data);
+  }
+  if (data.test.ups_test_result.empty()) {
+    data.test.ups_test_result = test::RESULT_NO_TEST;  // Default test result
   }
 
-  // Read input transfer limits (Report 0x10)
-  HidReport input_transfer_report;
-  if (read_hid_report(INPUT_TRANSFER_REPORT_ID, input_transfer_report)) {
-    parse_input_transfer_report(input_transfer_report, data);
+  // Frequency from the first candidate report that carries one
+  read_frequency_data(reports + FREQUENCY_FIRST, REPORT_COUNT - FREQUENCY_FIRST, data);
+  
+  update_idle_timers(data);
+  
+  UPS_HID_LOGD(CP_TAG, "CyberPower data read completed successfully");
+  return true;
+}
+
+void CyberPowerProtocol::read_configuration(UpsData &data) {
+  static constexpr uint8_t REPORT_IDS[] = {
+    BATTERY_VOLTAGE_NOMINAL_REPORT_ID,
+    INPUT_VOLTAGE_NOMINAL_REPORT_ID,
+    INPUT_TRANSFER_REPORT_ID,
+    DELAY_SHUTDOWN_REPORT_ID,
+    DELAY_START_REPORT_ID,
+    REALPOWER_NOMINAL_REPORT_ID,
+    INPUT_SENSITIVITY_REPORT_ID,
+    BEEPER_STATUS_REPORT_ID,
+  };
+  HidReport reports[sizeof(REPORT_IDS)];
+  read_reports(REPORT_IDS, reports, sizeof(REPORT_IDS), HID_REPORT_TYPE_FEATURE);
+  auto available = [&reports](size_t index) { return !reports[index].data.empty(); };
+
+  // Battery voltage nominal (Report 0x09)
+  if (available(0)) {
+    parse_battery_voltage_nominal_report(reports[0], data);
   }
 
-  // Read delay settings (Reports 0x15, 0x16)
-  HidReport delay_shutdown_report;
-  if (read_hid_report(DELAY_SHUTDOWN_REPORT_ID, delay_shutdown_report)) {
-    parse_delay_shutdown_report(delay_shutdown_report, data);
+  // Input voltage nominal (Report 0x0e)
+  if (available(1)) {
+    parse_input_voltage_nominal_report(reports[1], data);
   }
 
-  HidReport delay_start_report;
-  if (read_hid_report(DELAY_START_REPORT_ID, delay_start_report)) {
-    parse_delay_start_report(delay_start_report, data);
+  // Input transfer limits (Report 0x10)
+  if (available(2)) {
+    parse_input_transfer_report(reports[2], data);
   }
 
-  // Read nominal power (Report 0x18)
-  HidReport realpower_nominal_report;
-  if (read_hid_report(REALPOWER_NOMINAL_REPORT_ID, realpower_nominal_report)) {
-    parse_realpower_nominal_report(realpower_nominal_report, data);
+  // Delay settings (Reports 0x15, 0x16)
+  if (available(3)) {
+    parse_delay_shutdown_report(reports[3], data);
+  }
+  if (available(4)) {
+    parse_delay_start_report(reports[4], data);
   }
 
-  // Read input sensitivity (Report 0x1a)
-  HidReport input_sensitivity_report;
-  if (read_hid_report(INPUT_SENSITIVITY_REPORT_ID, input_sensitivity_report)) {
-    parse_input_sensitivity_report(input_sensitivity_report, data);
+  // Nominal power (Report 0x18)
+  if (available(5)) {
+    parse_realpower_nominal_report(reports[5], data);
   }
 
-  // Read overload status (Report 0x17)
-  HidReport overload_report;
-  if (read_hid_report(OVERLOAD_REPORT_ID, overload_report)) {
-    parse_overload_report(overload_report, data);
+  // Input sensitivity (Report 0x1a)
+  if (available(6)) {
+    parse_input_sensitivity_report(reports[6], data);
   }
 
-  // Read beeper status (Report 0x0c)
-  HidReport beeper_status_report;
-  if (read_hid_report(BEEPER_STATUS_REPORT_ID, beeper_status_report)) {
-    parse_beeper_status_report(beeper_status_report, data);
+  // Beeper status (Report 0x0c)
+  if (available(7)) {
+    parse_beeper_status_report(reports[7], data);
   }
 
+  // Read missing dynamic values identified from NUT analysis
+  read_missing_dynamic_values(data);
+}
+
+bool CyberPowerProtocol::read_identity(UpsData &data) {
   // Read device info (Reports 0x02, 0x1b) - these are string descriptors
   HidReport serial_number_report;
   if (read_hid_report(usb::REPORT_ID_SERIAL_NUMBER, serial_number_report)) {
@@ -191,106 +300,93 @@ bool CyberPowerProtocol::read_data(UpsData &data) {
     parse_firmware_version_report(firmware_version_report, data);
   }
 
-  // Read test result (Report 0x14) - same report ID used for test commands
-  HidReport test_result_report;
-  if (read_hid_report(TEST_RESULT_REPORT_ID, test_result_report)) {
-    parse_test_result_report(test_result_report, data);
+  // Read manufacturer from USB Manufacturer string descriptor (index 3)
+  // NUT shows: UPS.PowerSummary.iManufacturer, Value: 3 → Manufacturer: "CPS"
+  std::string manufacturer_string;
+  esp_err_t mfr_ret = parent_->usb_get_string_descriptor(3, manufacturer_string);
+  
+  if (mfr_ret == ESP_OK && !manufacturer_string.empty()) {
+    data.device.manufacturer = manufacturer_string;
+    ESP_LOGI(CP_TAG, "Successfully read manufacturer from USB descriptor: \"%s\"", data.device.manufacturer.c_str());
+  } else {
+    data.device.manufacturer.clear();  // Set to unset state instead of hardcoded fallback
+    ESP_LOGW(CP_TAG, "Failed to read USB Manufacturer descriptor: %s, leaving unset", esp_err_to_name(mfr_ret));
   }
-
-  // Set frequency to NaN - not available for CyberPower CP1500 model
-  // Try to read frequency from HID reports
-  read_frequency_data(data);
   
-  // TIMING FIX: Only read USB string descriptors after successful HID communication
-  // This ensures the device is ready and responsive before attempting descriptor access
-  if (success) {
-    ESP_LOGD(CP_TAG, "CyberPower HID data read successful, now reading device info...");
-    
-    // Read manufacturer from USB Manufacturer string descriptor (index 3)
-    // NUT shows: UPS.PowerSummary.iManufacturer, Value: 3 → Manufacturer: "CPS"
-    std::string manufacturer_string;
-    esp_err_t mfr_ret = parent_->usb_get_string_descriptor(3, manufacturer_string);
-    
-    if (mfr_ret == ESP_OK && !manufacturer_string.empty()) {
-      data.device.manufacturer = manufacturer_string;
-      ESP_LOGI(CP_TAG, "Successfully read manufacturer from USB descriptor: \"%s\"", data.device.manufacturer.c_str());
-    } else {
-      data.device.manufacturer.clear();  // Set to unset state instead of hardcoded fallback
-      ESP_LOGW(CP_TAG, "Failed to read USB Manufacturer descriptor: %s, leaving unset", esp_err_to_name(mfr_ret));
-    }
-    
-    // Read model from USB Product string descriptor (index 1)
-    // NUT shows: Product: "CP1500EPFCLCD"
-    std::string product_string;
-    esp_err_t prod_ret = parent_->usb_get_string_descriptor(1, product_string);
-    
-    if (prod_ret == ESP_OK && !product_string.empty()) {
-      data.device.model = product_string;
-      ESP_LOGI(CP_TAG, "Successfully read CyberPower model from USB Product descriptor: \"%s\"", data.device.model.c_str());
-    } else {
-      data.device.model.clear();  // Set to unset state instead of hardcoded fallback
-      ESP_LOGW(CP_TAG, "Failed to read USB Product descriptor: %s, leaving model unset", esp_err_to_name(prod_ret));
-    }
-    
-    // Read missing dynamic values identified from NUT analysis
-    read_missing_dynamic_values(data);
-    
-    ESP_LOGD(CP_TAG, "CyberPower data read completed successfully");
+  // Read model from USB Product string descriptor (index 1)
+  // NUT shows: Product: "CP1500EPFCLCD"
+  std::string product_string;
+  esp_err_t prod_ret = parent_->usb_get_string_descriptor(1, product_string);
+  
+  if (prod_ret == ESP_OK && !product_string.empty()) {
+    data.device.model = product_string;
+    ESP_LOGI(CP_TAG, "Successfully read CyberPower model from USB Product descriptor: \"%s\"", data.device.model.c_str());
   } else {
-    ESP_LOGW(CP_TAG, "Failed to read any CyberPower HID reports");
-    // Leave manufacturer and model unset when HID communication fails
-    data.device.manufacturer.clear();
-    data.device.model.clear();
+    data.device.model.clear();  // Set to unset state instead of hardcoded fallback
+    ESP_LOGW(CP_TAG, "Failed to read USB Product descriptor: %s, leaving model unset", esp_err_to_name(prod_ret));
   }
+  
+  // Retry on the next poll if the device was not ready to answer descriptor requests
+  return mfr_ret == ESP_OK || prod_ret == ESP_OK;
+}
 
-  return success;
+void CyberPowerProtocol::update_idle_timers(UpsData &data) {
+  // Timer values represent active countdown (negative when no countdown active)
+  // NUT shows: ups.timer.shutdown: -60, ups.timer.start: -60
+  if (data.config.delay_shutdown != -1) {
+    data.test.timer_shutdown = -data.config.delay_shutdown;
+  }
+  if (data.config.delay_start != -1) {
+    data.test.timer_start = -data.config.delay_start;
+  }
+  data.test.timer_reboot = defaults::REBOOT_TIMER_DEFAULT;  // CyberPower doesn't have separate reboot timer, use default
 }
 
 bool CyberPowerProtocol::read_hid_report(uint8_t report_id, HidReport &report) {
   // Check device connection before any HID communication
   if (!parent_->is_device_connected()) {
-    ESP_LOGV(CP_TAG, "Device not connected, skipping HID report 0x%02X", report_id);
+    UPS_HID_LOGV(CP_TAG, "Device not connected, skipping HID report 0x%02X", report_id);
     return false;
   }
   
-  uint8_t buffer[limits::MAX_HID_REPORT_SIZE]; // Maximum HID report size
-  size_t buffer_len = sizeof(buffer);
+  size_t buffer_len = report.data.capacity();
   esp_err_t ret;
   
   // Add debug info about parent device state
-  ESP_LOGD(CP_TAG, "Attempting to read report 0x%02X from parent device", report_id);
+  UPS_HID_LOGD(CP_TAG, "Attempting to read report 0x%02X from parent device", report_id);
   
   // CyberPower devices primarily use Feature Reports (0x03) - based on NUT debug logs
-  ret = parent_->hid_get_report(HID_REPORT_TYPE_FEATURE, report_id, buffer, &buffer_len, parent_->get_protocol_timeout());
+  ret = parent_->hid_get_report(HID_REPORT_TYPE_FEATURE, report_id, report.data.data(), &buffer_len, parent_->get_protocol_timeout());
   if (ret == ESP_OK && buffer_len > 0) {
     report.report_id = report_id;
-    report.data.assign(buffer, buffer + buffer_len);
-    ESP_LOGD(CP_TAG, "READ SUCCESS: Report 0x%02X (%zu bytes)", report_id, buffer_len);
+    report.data.set_size(buffer_len);
+    UPS_HID_LOGD(CP_TAG, "READ SUCCESS: Report 0x%02X (%zu bytes)", report_id, buffer_len);
     return true;
   }
   
   // Log the specific error for Feature Report
-  ESP_LOGD(CP_TAG, "Feature Report 0x%02X failed: %s", report_id, esp_err_to_name(ret));
+  UPS_HID_LOGD(CP_TAG, "Feature Report 0x%02X failed: %s", report_id, esp_err_to_name(ret));
   
   // Check connection again before trying Input report
   if (!parent_->is_device_connected()) {
-    ESP_LOGV(CP_TAG, "Device disconnected during HID communication for report 0x%02X", report_id);
+    UPS_HID_LOGV(CP_TAG, "Device disconnected during HID communication for report 0x%02X", report_id);
     return false;
   }
   
   // Fallback: try Input Report (0x01) for real-time data
-  buffer_len = sizeof(buffer);
-  ret = parent_->hid_get_report(HID_REPORT_TYPE_INPUT, report_id, buffer, &buffer_len, parent_->get_protocol_timeout());
+  buffer_len = report.data.capacity();
+  ret = parent_->hid_get_report(HID_REPORT_TYPE_INPUT, report_id, report.data.data(), &buffer_len, parent_->get_protocol_timeout());
   if (ret == ESP_OK && buffer_len > 0) {
     report.report_id = report_id;
-    report.data.assign(buffer, buffer + buffer_len);
-    ESP_LOGD(CP_TAG, "READ SUCCESS (Input): Report 0x%02X (%zu bytes)", report_id, buffer_len);
+    report.data.set_size(buffer_len);
+    UPS_HID_LOGD(CP_TAG, "READ SUCCESS (Input): Report 0x%02X (%zu bytes)", report_id, buffer_len);
     return true;
   }
   
   // Log the specific error for Input Report
-  ESP_LOGD(CP_TAG, "Input Report 0x%02X failed: %s", report_id, esp_err_to_name(ret));
-  ESP_LOGV(CP_TAG, "Failed to read report 0x%02X: %s", report_id, esp_err_to_name(ret));
+  UPS_HID_LOGD(CP_TAG, "Input Report 0x%02X failed: %s", report_id, esp_err_to_name(ret));
+  UPS_HID_LOGV(CP_TAG, "Failed to read report 0x%02X: %s", report_id, esp_err_to_name(ret));
+  report.data.clear();
   return false;
 }
 
@@ -318,10 +414,10 @@ void CyberPowerProtocol::parse_battery_runtime_report(const HidReport &report, U
   if (report.data.size() >= 6) {
     uint16_t runtime_low_seconds = report.data[4] | (report.data[5] << 8);
     data.battery.runtime_low = static_cast<float>(runtime_low_seconds) / 60.0f;  // Convert to minutes
-    ESP_LOGD(CP_TAG, "Battery: %.0f%%, Runtime: %.1f min (%.0f sec), Runtime Low: %.1f min", 
+    UPS_HID_LOGD(CP_TAG, "Battery: %.0f%%, Runtime: %.1f min (%.0f sec), Runtime Low: %.1f min", 
              data.battery.level, data.battery.runtime_minutes, static_cast<float>(runtime_seconds), data.battery.runtime_low);
   } else {
-    ESP_LOGD(CP_TAG, "Battery: %.0f%%, Runtime: %.1f min (%.0f sec raw: %02X %02X%02X)", 
+    UPS_HID_LOGD(CP_TAG, "Battery: %.0f%%, Runtime: %.1f min (%.0f sec raw: %02X %02X%02X)", 
              data.battery.level, data.battery.runtime_minutes, static_cast<float>(runtime_seconds), battery_percentage, report.data[3], report.data[2]);
   }
 }
@@ -338,7 +434,13 @@ void CyberPowerProtocol::parse_battery_voltage_report(const HidReport &report, U
   uint8_t voltage_raw = report.data[1];
   data.battery.voltage = static_cast<float>(voltage_raw) / battery::VOLTAGE_SCALE_FACTOR; // Scale by 0.1
   
-  ESP_LOGD(CP_TAG, "Battery voltage: %.1fV (raw: 0x%02X = %d)", 
+  // Decided once against the nominal voltage, then a plain multiply on every poll
+  if (!battery_scale_checked_ && !std::isnan(data.battery.voltage_nominal)) {
+    check_battery_voltage_scaling(data.battery.voltage, data.battery.voltage_nominal);
+  }
+  data.battery.voltage *= battery_voltage_scale_;
+  
+  UPS_HID_LOGD(CP_TAG, "Battery voltage: %.1fV (raw: 0x%02X = %d)", 
            data.battery.voltage, voltage_raw, voltage_raw);
 }
 
@@ -360,13 +462,19 @@ void CyberPowerProtocol::parse_present_status_report(const HidReport &report, Up
   bool time_limit_expired = (status_byte & 0x20) != 0;   // Offset 5
   
   // Update power status based on AC presence
+  uint32_t flags = 0;
   if (ac_present && !discharging) {
     data.power.input_voltage = parent_->get_fallback_nominal_voltage();  // Use configured fallback voltage when AC present
-    data.power.status = status::ONLINE;
+    flags |= UPS_STATUS_OL;
   } else {
     data.power.input_voltage = NAN;     // No AC input
-    data.power.status = status::ON_BATTERY;
+    flags |= UPS_STATUS_OB;
   }
+  if (charging) flags |= UPS_STATUS_CHRG;
+  if (discharging || !ac_present) flags |= UPS_STATUS_DISCHRG;
+  if (low_battery || time_limit_expired) flags |= UPS_STATUS_LB;
+  // Overload comes from its own report (0x17)
+  data.power.set_status(~UPS_STATUS_OVER, flags);
   
   // Set battery status based on charging/discharging state
   if (charging) {
@@ -387,7 +495,7 @@ void CyberPowerProtocol::parse_present_status_report(const HidReport &report, Up
     }
   }
   
-  ESP_LOGD(CP_TAG, "Status: AC:%s Charging:%s OnBatt:%s LowBatt:%s BattStatus:\"%s\"", 
+  UPS_HID_LOGD(CP_TAG, "Status: AC:%s Charging:%s OnBatt:%s LowBatt:%s BattStatus:\"%s\"", 
            ac_present ? "Yes" : "No",
            charging ? "Yes" : "No", 
            (!ac_present || discharging) ? "Yes" : "No",
@@ -407,7 +515,7 @@ void CyberPowerProtocol::parse_input_voltage_report(const HidReport &report, Ups
   // Input voltage is in volts directly, no scaling needed (unlike battery voltage)
   data.power.input_voltage = static_cast<float>(voltage_raw);
   
-  ESP_LOGD(CP_TAG, "Input voltage: %.1fV (raw: 0x%02X%02X = %d)", 
+  UPS_HID_LOGD(CP_TAG, "Input voltage: %.1fV (raw: 0x%02X%02X = %d)", 
            data.power.input_voltage, report.data[2], report.data[1], voltage_raw);
 }
 
@@ -423,7 +531,7 @@ void CyberPowerProtocol::parse_output_voltage_report(const HidReport &report, Up
   // Output voltage is in volts directly, no scaling needed (unlike battery voltage)
   data.power.output_voltage = static_cast<float>(voltage_raw);
   
-  ESP_LOGD(CP_TAG, "Output voltage: %.1fV (raw: 0x%02X%02X = %d)", 
+  UPS_HID_LOGD(CP_TAG, "Output voltage: %.1fV (raw: 0x%02X%02X = %d)", 
            data.power.output_voltage, report.data[2], report.data[1], voltage_raw);
 }
 
@@ -438,7 +546,7 @@ void CyberPowerProtocol::parse_load_percent_report(const HidReport &report, UpsD
   uint8_t load_percent = report.data[1];
   data.power.load_percent = static_cast<float>(load_percent);
   
-  ESP_LOGD(CP_TAG, "Load: %.0f%% (raw: 0x%02X = %d)", 
+  UPS_HID_LOGD(CP_TAG, "Load: %.0f%% (raw: 0x%02X = %d)", 
            data.power.load_percent, load_percent, load_percent);
 }
 
@@ -455,7 +563,7 @@ void CyberPowerProtocol::check_battery_voltage_scaling(float battery_voltage, fl
              battery_voltage, nominal_voltage, sanity_ratio);
     battery_voltage_scale_ = 2.0f / 3.0f;
   } else {
-    ESP_LOGD(CP_TAG, "Battery voltage %.1fV is within normal range, no scaling needed",
+    UPS_HID_LOGD(CP_TAG, "Battery voltage %.1fV is within normal range, no scaling needed",
              battery_voltage);
     battery_voltage_scale_ = 1.0f;
   }
@@ -474,7 +582,7 @@ void CyberPowerProtocol::parse_battery_voltage_nominal_report(const HidReport &r
   uint8_t voltage_raw = report.data[1];
   data.battery.voltage_nominal = static_cast<float>(voltage_raw) / battery::VOLTAGE_SCALE_FACTOR;
   
-  ESP_LOGD(CP_TAG, "Battery voltage nominal: %.0fV (raw: 0x%02X = %d)", 
+  UPS_HID_LOGD(CP_TAG, "Battery voltage nominal: %.0fV (raw: 0x%02X = %d)", 
            data.battery.voltage_nominal, voltage_raw, voltage_raw);
 }
 
@@ -503,7 +611,7 @@ void CyberPowerProtocol::parse_beeper_status_report(const HidReport &report, Ups
       break;
   }
   
-  ESP_LOGD(CP_TAG, "Beeper status: %s (raw: 0x%02X = %d)", 
+  UPS_HID_LOGD(CP_TAG, "Beeper status: %s (raw: 0x%02X = %d)", 
            data.config.beeper_status.c_str(), beeper_raw, beeper_raw);
 }
 
@@ -517,7 +625,7 @@ void CyberPowerProtocol::parse_input_voltage_nominal_report(const HidReport &rep
   uint8_t voltage_raw = report.data[1];
   data.power.input_voltage_nominal = static_cast<float>(voltage_raw);
   
-  ESP_LOGD(CP_TAG, "Input voltage nominal: %.0fV (raw: 0x%02X = %d)", 
+  UPS_HID_LOGD(CP_TAG, "Input voltage nominal: %.0fV (raw: 0x%02X = %d)", 
            data.power.input_voltage_nominal, voltage_raw, voltage_raw);
 }
 
@@ -536,7 +644,7 @@ void CyberPowerProtocol::parse_input_transfer_report(const HidReport &report, Up
   data.power.input_transfer_low = static_cast<float>(low_transfer);
   data.power.input_transfer_high = static_cast<float>(high_transfer);
   
-  ESP_LOGD(CP_TAG, "Input transfer limits: Low=%.0fV, High=%.0fV", 
+  UPS_HID_LOGD(CP_TAG, "Input transfer limits: Low=%.0fV, High=%.0fV", 
            data.power.input_transfer_low, data.power.input_transfer_high);
 }
 
@@ -552,11 +660,11 @@ void CyberPowerProtocol::parse_delay_shutdown_report(const HidReport &report, Up
   if (delay_raw_unsigned == 0xFFFF) {
     // When disabled, use NUT default for CyberPower (DEFAULT_OFFDELAY_CPS = 60)
     data.config.delay_shutdown = defaults::CYBERPOWER_SHUTDOWN_DELAY_SEC;  
-    ESP_LOGD(CP_TAG, "UPS delay shutdown: %d seconds (default, raw: 0xFFFF)", defaults::CYBERPOWER_SHUTDOWN_DELAY_SEC);
+    UPS_HID_LOGD(CP_TAG, "UPS delay shutdown: %d seconds (default, raw: 0xFFFF)", defaults::CYBERPOWER_SHUTDOWN_DELAY_SEC);
   } else {
     int16_t delay_raw = static_cast<int16_t>(delay_raw_unsigned);
     data.config.delay_shutdown = delay_raw;
-    ESP_LOGD(CP_TAG, "UPS delay shutdown: %d seconds", data.config.delay_shutdown);
+    UPS_HID_LOGD(CP_TAG, "UPS delay shutdown: %d seconds", data.config.delay_shutdown);
   }
 }
 
@@ -572,11 +680,11 @@ void CyberPowerProtocol::parse_delay_start_report(const HidReport &report, UpsDa
   if (delay_raw_unsigned == 0xFFFF) {
     // When disabled, use NUT default for CyberPower (DEFAULT_ONDELAY_CPS = 120)
     data.config.delay_start = defaults::CYBERPOWER_STARTUP_DELAY_SEC;
-    ESP_LOGD(CP_TAG, "UPS delay start: %d seconds (default, raw: 0xFFFF)", defaults::CYBERPOWER_STARTUP_DELAY_SEC);
+    UPS_HID_LOGD(CP_TAG, "UPS delay start: %d seconds (default, raw: 0xFFFF)", defaults::CYBERPOWER_STARTUP_DELAY_SEC);
   } else {
     int16_t delay_raw = static_cast<int16_t>(delay_raw_unsigned);
     data.config.delay_start = delay_raw;
-    ESP_LOGD(CP_TAG, "UPS delay start: %d seconds", data.config.delay_start);
+    UPS_HID_LOGD(CP_TAG, "UPS delay start: %d seconds", data.config.delay_start);
   }
 }
 
@@ -590,7 +698,7 @@ void CyberPowerProtocol::parse_realpower_nominal_report(const HidReport &report,
   uint16_t power_raw = report.data[1] | (report.data[2] << 8);
   data.power.realpower_nominal = static_cast<float>(power_raw);
   
-  ESP_LOGD(CP_TAG, "UPS nominal real power: %.0fW", data.power.realpower_nominal);
+  UPS_HID_LOGD(CP_TAG, "UPS nominal real power: %.0fW", data.power.realpower_nominal);
 }
 
 void CyberPowerProtocol::parse_input_sensitivity_report(const HidReport &report, UpsData &data) {
@@ -601,7 +709,7 @@ void CyberPowerProtocol::parse_input_sensitivity_report(const HidReport &report,
 
   // NUT debug shows: Report 0x1a, Value: 1 (CPSInputSensitivity)
   uint8_t sensitivity_raw = report.data[1];
-  ESP_LOGD(CP_TAG, "Raw CyberPower sensitivity from report 0x1a: 0x%02X (%d)", sensitivity_raw, sensitivity_raw);
+  UPS_HID_LOGD(CP_TAG, "Raw CyberPower sensitivity from report 0x1a: 0x%02X (%d)", sensitivity_raw, sensitivity_raw);
   
   // DYNAMIC SENSITIVITY MAPPING: Handle known CyberPower values with intelligent fallbacks
   switch (sensitivity_raw) {
@@ -627,7 +735,7 @@ void CyberPowerProtocol::parse_input_sensitivity_report(const HidReport &report,
         // Try alternative parsing - some models might use different byte
         if (report.data.size() >= 3) {
           uint8_t alt_value = report.data[2];
-          ESP_LOGD(CP_TAG, "Trying alternative sensitivity parsing from byte[2]: %d", alt_value);
+          UPS_HID_LOGD(CP_TAG, "Trying alternative sensitivity parsing from byte[2]: %d", alt_value);
           
           if (alt_value <= 2) {
             sensitivity_raw = alt_value;
@@ -672,7 +780,7 @@ void CyberPowerProtocol::parse_firmware_version_report(const HidReport &report,
   
   // Validate string index is reasonable (CyberPower typically uses indices 1-10)
   if (string_index > 0 && string_index <= 15) {
-    ESP_LOGD(CP_TAG, "Reading CyberPower firmware from USB string descriptor index: %d", string_index);
+    UPS_HID_LOGD(CP_TAG, "Reading CyberPower firmware from USB string descriptor index: %d", string_index);
     
     std::string actual_firmware;
     esp_err_t fw_ret = parent_->usb_get_string_descriptor(string_index, actual_firmware);
@@ -684,7 +792,7 @@ void CyberPowerProtocol::parse_firmware_version_report(const HidReport &report,
       ESP_LOGI(CP_TAG, "Successfully read CyberPower firmware from USB string descriptor %d: \"%s\"", 
                string_index, data.device.firmware_version.c_str());
       if (cleaned_firmware != actual_firmware) {
-        ESP_LOGD(CP_TAG, "Cleaned firmware string from \"%s\" to \"%s\"", 
+        UPS_HID_LOGD(CP_TAG, "Cleaned firmware string from \"%s\" to \"%s\"", 
                  actual_firmware.c_str(), cleaned_firmware.c_str());
       }
       return;
@@ -693,7 +801,7 @@ void CyberPowerProtocol::parse_firmware_version_report(const HidReport &report,
                string_index, esp_err_to_name(fw_ret));
     }
   } else {
-    ESP_LOGD(CP_TAG, "Invalid string index %d for firmware, trying direct HID parsing", string_index);
+    UPS_HID_LOGD(CP_TAG, "Invalid string index %d for firmware, trying direct HID parsing", string_index);
   }
   
   // FALLBACK 1: Try to parse firmware from raw HID report data
@@ -717,7 +825,7 @@ void CyberPowerProtocol::parse_firmware_version_report(const HidReport &report,
   for (uint8_t idx : common_fw_indices) {
     if (idx == string_index) continue; // Already tried this one
     
-    ESP_LOGD(CP_TAG, "Trying alternative firmware string descriptor index: %d", idx);
+    UPS_HID_LOGD(CP_TAG, "Trying alternative firmware string descriptor index: %d", idx);
     std::string fw_attempt;
     esp_err_t ret = parent_->usb_get_string_descriptor(idx, fw_attempt);
     
@@ -730,7 +838,7 @@ void CyberPowerProtocol::parse_firmware_version_report(const HidReport &report,
         ESP_LOGI(CP_TAG, "Found CyberPower firmware at alternative string descriptor %d: \"%s\"", 
                  idx, data.device.firmware_version.c_str());
         if (cleaned_fw != fw_attempt) {
-          ESP_LOGD(CP_TAG, "Cleaned alternative firmware string from \"%s\" to \"%s\"", 
+          UPS_HID_LOGD(CP_TAG, "Cleaned alternative firmware string from \"%s\" to \"%s\"", 
                    fw_attempt.c_str(), cleaned_fw.c_str());
         }
         return;
@@ -745,14 +853,14 @@ void CyberPowerProtocol::parse_firmware_version_report(const HidReport &report,
              report.data[1], report.data[2], 
              (report.data.size() > 3) ? report.data[3] : 0);
     data.device.firmware_version = firmware_fallback;
-    ESP_LOGD(CP_TAG, "Using binary firmware version fallback: %s", data.device.firmware_version.c_str());
+    UPS_HID_LOGD(CP_TAG, "Using binary firmware version fallback: %s", data.device.firmware_version.c_str());
   } else {
     // No firmware version could be determined
     data.device.firmware_version.clear();
     ESP_LOGW(CP_TAG, "Unable to determine CyberPower firmware version from any source");
   }
   
-  ESP_LOGD(CP_TAG, "Final firmware version: %s (original string index: %d)", 
+  UPS_HID_LOGD(CP_TAG, "Final firmware version: %s (original string index: %d)", 
            data.device.firmware_version.c_str(), string_index);
 }
 
@@ -767,16 +875,11 @@ void CyberPowerProtocol::parse_overload_report(const HidReport &report, UpsData
   uint8_t overload_byte = report.data[1];
   bool overload = (overload_byte & 0x01) != 0;  // Check bit 0 (Offset 1 in NUT = bit 0)
   
+  data.power.set_status(UPS_STATUS_OVER, overload ? UPS_STATUS_OVER : 0);
   if (overload) {
-    data.power.status += " - Overload";
     ESP_LOGW(CP_TAG, "CyberPower UPS OVERLOAD detected (raw: 0x%02X)", overload_byte);
   } else {
-    // Remove overload from status if it was there
-    size_t pos = data.power.status.find(" - Overload");
-    if (pos != std::string::npos) {
-      data.power.status.erase(pos, 11);  // Length of " - Overload"
-    }
-    ESP_LOGD(CP_TAG, "CyberPower UPS overload status: normal (raw: 0x%02X)", overload_byte);
+    UPS_HID_LOGD(CP_TAG, "CyberPower UPS overload status: normal (raw: 0x%02X)", overload_byte);
   }
 }
 
@@ -790,7 +893,7 @@ void CyberPowerProtocol::parse_serial_number_report(const HidReport &report, Ups
   // This is a USB string descriptor index, not the actual serial number
   uint8_t string_index = report.data[1];
   
-  ESP_LOGD(CP_TAG, "Serial number string descriptor index: %d", string_index);
+  UPS_HID_LOGD(CP_TAG, "Serial number string descriptor index: %d", string_index);
   
   // Use real USB string descriptor reading - this will get the actual CyberPower serial number
   // NUT shows: CyberPower real serial = "CRMLX2000234"
@@ -811,52 +914,49 @@ void CyberPowerProtocol::parse_serial_number_report(const HidReport &report, Ups
     ESP_LOGW(CP_TAG, "Leaving serial number unset due to USB string descriptor failure");
   }
   
-  ESP_LOGD(CP_TAG, "Serial number: %s (string index: %d)", 
+  UPS_HID_LOGD(CP_TAG, "Serial number: %s (string index: %d)", 
            data.device.serial_number.c_str(), string_index);
 }
 
 void CyberPowerProtocol::read_missing_dynamic_values(UpsData &data) {
-  ESP_LOGD(CP_TAG, "Reading CyberPower missing dynamic values from NUT analysis...");
+  UPS_HID_LOGD(CP_TAG, "Reading CyberPower missing dynamic values from NUT analysis...");
+  
+  // Manufacturing date candidates start at index 2 (based on NUT:
+  // UPS.PowerSummary.iOEMInformation; CyberPower may use any of these reports)
+  static constexpr uint8_t REPORT_IDS[] = {
+    0x07,                         // Battery capacity limits - contains multiple values
+    battery_chemistry::REPORT_ID, // Battery chemistry/type (shared report ID) - same as APC
+    0x04, 0x05, 0x06, 0x19, 0x1c, 0x1d, 0x1e, 0x1f, 0x20,
+  };
+  static constexpr size_t MFR_DATE_FIRST = 2;
+  HidReport reports[sizeof(REPORT_IDS)];
+  read_reports(REPORT_IDS, reports, sizeof(REPORT_IDS), HID_REPORT_TYPE_FEATURE);
   
-  // 1. Battery capacity limits (Report 0x07) - contains multiple values
-  HidReport battery_capacity_limits_report;
-  if (read_hid_report(0x07, battery_capacity_limits_report)) {
-    parse_battery_capacity_limits_report(battery_capacity_limits_report, data);
+  // 1. Battery capacity limits (Report 0x07)
+  if (!reports[0].data.empty()) {
+    parse_battery_capacity_limits_report(reports[0], data);
   }
   
-  // 2. Battery chemistry/type (shared report ID) - same as APC
-  HidReport battery_chemistry_report;
-  if (read_hid_report(battery_chemistry::REPORT_ID, battery_chemistry_report)) {
-    parse_battery_chemistry_report(battery_chemistry_report, data);
+  // 2. Battery chemistry/type
+  if (!reports[1].data.empty()) {
+    parse_battery_chemistry_report(reports[1], data);
   }
   
   // 3. Battery runtime low threshold is already available in existing Report 0x08
   // It's at offset 24 and already parsed in parse_battery_runtime_report
-  // Just need to extract it properly
-  
-  // 4. Try to read manufacturing date (based on NUT: UPS.PowerSummary.iOEMInformation)
-  // CyberPower manufacturing date might be in reports 0x04, 0x05, or similar to APC reports
-  std::vector<uint8_t> mfr_date_reports = {0x04, 0x05, 0x06, 0x19, 0x1c, 0x1d, 0x1e, 0x1f, 0x20};
-  for (uint8_t report_id : mfr_date_reports) {
-    HidReport mfr_date_report;
-    if (read_hid_report(report_id, mfr_date_report)) {
-      parse_manufacturing_date_report(mfr_date_report, data);
-      break; // Found manufacturing date, stop trying other reports
+  
+  // 4. Manufacturing date from the first candidate that answered
+  for (size_t i = MFR_DATE_FIRST; i < sizeof(REPORT_IDS); i++) {
+    if (!reports[i].data.empty()) {
+      parse_manufacturing_date_report(reports[i], data);
+      break;
     }
   }
   
-  // 5. Set static/derived values based on NUT behavior  
-  data.test.ups_test_result = test::RESULT_NO_TEST;  // Default test result
+  // Timers follow the delays just read
+  update_idle_timers(data);
   
-  // NOTE: battery_status is now properly set based on charging state in parse_present_status_report
-  
-  // 5. Timer values represent active countdown (negative when no countdown active)
-  // NUT shows: ups.timer.shutdown: -60, ups.timer.start: -60
-  data.test.timer_shutdown = -data.config.delay_shutdown;  // Negative indicates no active countdown
-  data.test.timer_start = -data.config.delay_start;        // Negative indicates no active countdown  
-  data.test.timer_reboot = defaults::REBOOT_TIMER_DEFAULT;  // CyberPower doesn't have separate reboot timer, use default
-  
-  ESP_LOGD(CP_TAG, "Completed reading CyberPower missing dynamic values");
+  UPS_HID_LOGD(CP_TAG, "Completed reading CyberPower missing dynamic values");
 }
 
 void CyberPowerProtocol::parse_battery_capacity_report(const HidReport &report, UpsData &data) {
@@ -895,7 +995,7 @@ void CyberPowerProtocol::parse_battery_capacity_limits_report(const HidReport &r
   // FullChargeCapacity represents maximum capacity (100%), not current status
   if (report.data.size() > 6) {
     uint8_t full_charge_capacity = report.data[6]; // Offset 40 bits = byte 5 + 1
-    ESP_LOGD(CP_TAG, "CyberPower FullChargeCapacity: %d%% (always 100%% for healthy battery)", full_charge_capacity);
+    UPS_HID_LOGD(CP_TAG, "CyberPower FullChargeCapacity: %d%% (always 100%% for healthy battery)", full_charge_capacity);
     // Note: battery_status is now set from charging state in parse_present_status_report
   }
 }
@@ -954,11 +1054,11 @@ std::string CyberPowerProtocol::clean_firmware_string(const std::string &raw_fir
 }
 
 bool CyberPowerProtocol::beeper_enable() {
-  ESP_LOGD(CP_TAG, "Sending CyberPower beeper enable command");
+  UPS_HID_LOGD(CP_TAG, "Sending CyberPower beeper enable command");
   
   // CYBERPOWER DEVICE SPECIFIC: From NUT debug, device uses report ID 0x0c
   // NUT shows: "UPS.PowerSummary.AudibleAlarmControl, Type: Feature, ReportID: 0x0c"
-  ESP_LOGD(CP_TAG, "Trying beeper enable with report ID 0x%02X", BEEPER_STATUS_REPORT_ID);
+  UPS_HID_LOGD(CP_TAG, "Trying beeper enable with report ID 0x%02X", BEEPER_STATUS_REPORT_ID);
   
   uint8_t beeper_data[2] = {BEEPER_STATUS_REPORT_ID, beeper::CONTROL_ENABLE};  // Report ID, Value=2 (enabled)
   
@@ -973,10 +1073,10 @@ bool CyberPowerProtocol::beeper_enable() {
 }
 
 bool CyberPowerProtocol::beeper_disable() {
-  ESP_LOGD(CP_TAG, "Sending CyberPower beeper disable command");
+  UPS_HID_LOGD(CP_TAG, "Sending CyberPower beeper disable command");
   
   // CYBERPOWER DEVICE SPECIFIC: From NUT debug, device uses report ID 0x0c
-  ESP_LOGD(CP_TAG, "Trying beeper disable with report ID 0x%02X", BEEPER_STATUS_REPORT_ID);
+  UPS_HID_LOGD(CP_TAG, "Trying beeper disable with report ID 0x%02X", BEEPER_STATUS_REPORT_ID);
   
   uint8_t beeper_data[2] = {BEEPER_STATUS_REPORT_ID, beeper::CONTROL_DISABLE};  // Report ID, Value=1 (disabled)
   
@@ -991,7 +1091,7 @@ bool CyberPowerProtocol::beeper_disable() {
 }
 
 bool CyberPowerProtocol::beeper_mute() {
-  ESP_LOGD(CP_TAG, "Sending CyberPower beeper mute command");
+  UPS_HID_LOGD(CP_TAG, "Sending CyberPower beeper mute command");
   
   // MUTE FUNCTIONALITY (Value 3):
   // - Acknowledges and silences current active alarms  
@@ -1010,7 +1110,7 @@ bool CyberPowerProtocol::beeper_mute() {
 }
 
 bool CyberPowerProtocol::beeper_test() {
-  ESP_LOGD(CP_TAG, "Starting CyberPower beeper test sequence");
+  UPS_HID_LOGD(CP_TAG, "Starting CyberPower beeper test sequence");
   
   // First, read current beeper status to restore later
   HidReport current_report;
@@ -1138,7 +1238,7 @@ void CyberPowerProtocol::parse_test_result_report(const HidReport &report, UpsDa
   // 4 = "Aborted", 5 = "In progress", 6 = "No test initiated", 7 = "Test scheduled"
   uint8_t test_result_value = report.data[1];
 
-  ESP_LOGD(CP_TAG, "Raw test result from report 0x14: 0x%02X (%d)", test_result_value, test_result_value);
+  UPS_HID_LOGD(CP_TAG, "Raw test result from report 0x14: 0x%02X (%d)", test_result_value, test_result_value);
 
   switch (test_result_value) {
     case 1:
@@ -1171,36 +1271,25 @@ void CyberPowerProtocol::parse_test_result_report(const HidReport &report, UpsDa
   ESP_LOGI(CP_TAG, "CyberPower Test result: %s (raw: %d)", data.test.ups_test_result.c_str(), test_result_value);
 }
 
-void CyberPowerProtocol::read_frequency_data(UpsData &data) {
+void CyberPowerProtocol::read_frequency_data(const HidReport *candidates, size_t count, UpsData &data) {
   // Initialize frequency to NaN
   data.power.frequency = NAN;
   
-  // Try to read frequency from various HID report IDs
-  // CyberPower devices may have frequency in input/output measurement reports
-  
-  // Report IDs commonly used for frequency measurements:
-  const std::vector<uint8_t> frequency_report_ids = {
-    HID_USAGE_POW_FREQUENCY,     // 0x32 - Standard HID frequency usage
-    HID_USAGE_POW_VOLTAGE,       // 0x30 - Input measurements (may include frequency)  
-    HID_USAGE_POW_CURRENT,       // 0x31 - Output measurements (may include frequency)
-    0x11, // CyberPower-specific frequency report (based on NUT analysis)
-    INPUT_VOLTAGE_REPORT_ID,     // 0x0F - might contain frequency data
-    OUTPUT_VOLTAGE_REPORT_ID,    // 0x12 - might contain frequency data
-  };
-  
-  for (uint8_t report_id : frequency_report_ids) {
-    HidReport freq_report;
-    if (read_hid_report(report_id, freq_report)) {
-      float frequency_value = parse_frequency_from_report(freq_report);
-      if (!std::isnan(frequency_value)) {
-        data.power.frequency = frequency_value;
-        ESP_LOGD(CP_TAG, "Found frequency %.1f Hz in report 0x%02X", frequency_value, report_id);
-        return;
-      }
+  // Candidates come from the fast poll batch in priority order
+  for (size_t i = 0; i < count; i++) {
+    const HidReport &freq_report = candidates[i];
+    if (freq_report.data.empty()) {
+      continue;
+    }
+    float frequency_value = parse_frequency_from_report(freq_report);
+    if (!std::isnan(frequency_value)) {
+      data.power.frequency = frequency_value;
+      UPS_HID_LOGD(CP_TAG, "Found frequency %.1f Hz in report 0x%02X", frequency_value, freq_report.report_id);
+      return;
     }
   }
   
-  ESP_LOGV(CP_TAG, "Frequency data not available from any HID report");
+  UPS_HID_LOGV(CP_TAG, "Frequency data not available from any HID report");
 }
 
 float CyberPowerProtocol::parse_frequency_from_report(const HidReport &report) {
@@ -1241,7 +1330,7 @@ float CyberPowerProtocol::parse_frequency_from_report(const HidReport &report) {
     uint16_t freq_scaled = report.data[1] | (report.data[2] << 8);
     float freq_value = static_cast<float>(freq_scaled) / 10.0f;
     if (freq_value >= FREQUENCY_MIN_VALID && freq_value <= FREQUENCY_MAX_VALID) {
-      ESP_LOGD(CP_TAG, "Applied CyberPower 0.1x frequency scaling: %d -> %.1f Hz", freq_scaled, freq_value);
+      UPS_HID_LOGD(CP_TAG, "Applied CyberPower 0.1x frequency scaling: %d -> %.1f Hz", freq_scaled, freq_value);
       return freq_value;
     }
   }
@@ -1251,7 +1340,7 @@ float CyberPowerProtocol::parse_frequency_from_report(const HidReport &report) {
     uint16_t freq_scaled = report.data[1] | (report.data[2] << 8);
     float freq_value = static_cast<float>(freq_scaled) / 100.0f;
     if (freq_value >= FREQUENCY_MIN_VALID && freq_value <= FREQUENCY_MAX_VALID) {
-      ESP_LOGD(CP_TAG, "Applied CyberPower 0.01x frequency scaling: %d -> %.1f Hz", freq_scaled, freq_value);
+      UPS_HID_LOGD(CP_TAG, "Applied CyberPower 0.01x frequency scaling: %d -> %.1f Hz", freq_scaled, freq_value);
       return freq_value;
     }
   }
@@ -1271,7 +1360,7 @@ namespace ups_hid {
 // Creator function for CyberPower protocol
 void CyberPowerProtocol::parse_manufacturing_date_report(const HidReport &report, UpsData &data) {
   if (report.data.size() < 4) {
-    ESP_LOGD(CP_TAG, "Manufacturing date report 0x%02X too short: %zu bytes", report.report_id, report.data.size());
+    UPS_HID_LOGD(CP_TAG, "Manufacturing date report 0x%02X too short: %zu bytes", report.report_id, report.data.size());
     return;
   }
   
@@ -1312,12 +1401,12 @@ void CyberPowerProtocol::parse_manufacturing_date_report(const HidReport &report
     }
   }
   
-  ESP_LOGD(CP_TAG, "Could not decode manufacturing date from report 0x%02X (%zu bytes)", 
+  UPS_HID_LOGD(CP_TAG, "Could not decode manufacturing date from report 0x%02X (%zu bytes)", 
            report.report_id, report.data.size());
 }
 
 bool CyberPowerProtocol::read_timer_data(UpsData &data) {
-  ESP_LOGD(CP_TAG, "Reading CyberPower timer countdown data");
+  UPS_HID_LOGD(CP_TAG, "Reading CyberPower timer countdown data");
   
   HidReport delay_shutdown_report;
   HidReport delay_start_report;
@@ -1336,12 +1425,12 @@ bool CyberPowerProtocol::read_timer_data(UpsData &data) {
     if (data.config.delay_shutdown > 0) {
       // Normal operation - timer is inactive, show negative of configuration value
       data.test.timer_shutdown = -data.config.delay_shutdown;
-      ESP_LOGV(CP_TAG, "Timer shutdown inactive: %d (config: %d)", 
+      UPS_HID_LOGV(CP_TAG, "Timer shutdown inactive: %d (config: %d)", 
                data.test.timer_shutdown, data.config.delay_shutdown);
     } else {
       // Use default if no configuration available
       data.test.timer_shutdown = -defaults::CYBERPOWER_SHUTDOWN_DELAY_SEC;
-      ESP_LOGV(CP_TAG, "Timer shutdown inactive (default): %d", data.test.timer_shutdown);
+      UPS_HID_LOGV(CP_TAG, "Timer shutdown inactive (default): %d", data.test.timer_shutdown);
     }
     
     // TODO: During actual UPS shutdown, we would need to detect the active countdown state
@@ -1360,12 +1449,12 @@ bool CyberPowerProtocol::read_timer_data(UpsData &data) {
     if (data.config.delay_start > 0) {
       // Normal operation - timer is inactive, show negative of configuration value
       data.test.timer_start = -data.config.delay_start;
-      ESP_LOGV(CP_TAG, "Timer start inactive: %d (config: %d)", 
+      UPS_HID_LOGV(CP_TAG, "Timer start inactive: %d (config: %d)", 
                data.test.timer_start, data.config.delay_start);
     } else {
       // Use default if no configuration available
       data.test.timer_start = -defaults::CYBERPOWER_STARTUP_DELAY_SEC;
-      ESP_LOGV(CP_TAG, "Timer start inactive (default): %d", data.test.timer_start);
+      UPS_HID_LOGV(CP_TAG, "Timer start inactive (default): %d", data.test.timer_start);
     }
     success = true;
   }
@@ -1374,7 +1463,7 @@ bool CyberPowerProtocol::read_timer_data(UpsData &data) {
   data.test.timer_reboot = data.test.timer_shutdown;
   
   if (success) {
-    ESP_LOGD(CP_TAG, "CyberPower timer data updated - shutdown: %d, start: %d, reboot: %d",
+    UPS_HID_LOGD(CP_TAG, "CyberPower timer data updated - shutdown: %d, start: %d, reboot: %d",
              data.test.timer_shutdown, data.test.timer_start, data.test.timer_reboot);
   }
   
@@ -1398,7 +1487,7 @@ bool CyberPowerProtocol::set_shutdown_delay(int seconds) {
   delay_data[1] = seconds & 0xFF;           // Low byte
   delay_data[2] = (seconds >> 8) & 0xFF;    // High byte
   
-  ESP_LOGD(CP_TAG, "Writing shutdown delay: Report 0x%02X, Value: %d (0x%02X 0x%02X)", 
+  UPS_HID_LOGD(CP_TAG, "Writing shutdown delay: Report 0x%02X, Value: %d (0x%02X 0x%02X)", 
            DELAY_SHUTDOWN_REPORT_ID, seconds, delay_data[1], delay_data[2]);
   
   esp_err_t ret = parent_->hid_set_report(HID_REPORT_TYPE_FEATURE, DELAY_SHUTDOWN_REPORT_ID, 
@@ -1429,7 +1518,7 @@ bool CyberPowerProtocol::set_start_delay(int seconds) {
   delay_data[1] = seconds & 0xFF;           // Low byte
   delay_data[2] = (seconds >> 8) & 0xFF;    // High byte
   
-  ESP_LOGD(CP_TAG, "Writing start delay: Report 0x%02X, Value: %d (0x%02X 0x%02X)", 
+  UPS_HID_LOGD(CP_TAG, "Writing start delay: Report 0x%02X, Value: %d (0x%02X 0x%02X)", 
            DELAY_START_REPORT_ID, seconds, delay_data[1], delay_data[2]);
   
   esp_err_t ret = parent_->hid_set_report(HID_REPORT_TYPE_FEATURE, DELAY_START_REPORT_ID, 
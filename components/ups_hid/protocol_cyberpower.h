@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ups_hid.h"
+#include "hid_report.h"
 
 namespace esphome {
 namespace ups_hid {
@@ -22,10 +23,16 @@ class CyberPowerProtocol : public UpsProtocolBase {
   CyberPowerProtocol(UpsHidComponent *parent) : UpsProtocolBase(parent) {}
 
   bool detect() override;
+  size_t get_probe_report_ids(const uint8_t **report_ids) const override;
   bool initialize() override;
   bool read_data(UpsData &data) override;
+  bool read_report_group(ReportGroup group, UpsData &data) override;
+  // Persists the battery voltage scale once it has been checked
+  bool save_discovery(ProtocolDiscovery &discovery) const override;
+  bool initialize_from_discovery(const ProtocolDiscovery &discovery) override;
   DeviceInfo::DetectedProtocol get_protocol_type() const override { return DeviceInfo::PROTOCOL_CYBERPOWER_HID; }
   std::string get_protocol_name() const override { return "CyberPower HID"; }
+  size_t get_memory_usage() const override { return sizeof(*this); }
   
   // Beeper control methods
   bool beeper_enable() override;
@@ -70,13 +77,8 @@ class CyberPowerProtocol : public UpsProtocolBase {
   // Note: Serial number report ID moved to shared constant usb::REPORT_ID_SERIAL_NUMBER
   static const uint8_t TEST_RESULT_REPORT_ID = 0x14;       // UPS test result (same as test command)
 
-  // HID Report structure
-  struct HidReport {
-    uint8_t report_id;
-    std::vector<uint8_t> data;
-    
-    HidReport() : report_id(0) {}
-  };
+  // Inline report storage shared by all protocols (see hid_report.h)
+  using HidReport = ups_hid::HidReport;
 
   // CyberPower-specific scaling factors
   float battery_voltage_scale_ = 1.0f;
@@ -106,6 +108,12 @@ class CyberPowerProtocol : public UpsProtocolBase {
   void parse_serial_number_report(const HidReport &report, UpsData &data);
   void parse_test_result_report(const HidReport &report, UpsData &data);
   
+  // Report groups
+  bool read_status_reports(UpsData &data);
+  void read_configuration(UpsData &data);
+  bool read_identity(UpsData &data);
+  void update_idle_timers(UpsData &data);
+  
   // Missing dynamic values from NUT analysis
   void read_missing_dynamic_values(UpsData &data);
   void parse_battery_capacity_limits_report(const HidReport &report, UpsData &data);
@@ -119,7 +127,7 @@ class CyberPowerProtocol : public UpsProtocolBase {
   void check_battery_voltage_scaling(float battery_voltage, float nominal_voltage);
   
   // Frequency reading methods
-  void read_frequency_data(UpsData &data);
+  void read_frequency_data(const HidReport *candidates, size_t count, UpsData &data);
   float parse_frequency_from_report(const HidReport &report);
 };
 
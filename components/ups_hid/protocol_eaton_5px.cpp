@@ -1,7 +1,7 @@
 #include "protocol_eaton_5px.h"
 #include "constants_hid.h"
 #include "constants_ups.h"
-#include "esphome/core/log.h"
+#include "log_ups.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <cstdio>
@@ -12,7 +12,8 @@ namespace ups_hid {
 
 static const char *const EATON_TAG = "ups_hid.eaton_5px";
 
-static std::string hex_dump(const std::vector<uint8_t> &v) {
+#if UPS_HID_LOG_DEBUG_ENABLED
+static std::string hex_dump(HidReportView v) {
   std::string s;
   char buf[6];
   for (size_t i = 0; i < v.size(); ++i) {
@@ -21,10 +22,11 @@ static std::string hex_dump(const std::vector<uint8_t> &v) {
   }
   return s;
 }
+#endif
 
 // Heuristic: scan a buffer for 16-bit LE values and try several scale factors
 // Return NAN if none found
-static float find_best_voltage_candidate(const std::vector<uint8_t> &buf, float nominal) {
+static float find_best_voltage_candidate(HidReportView buf, float nominal) {
   if (buf.size() < 2) return NAN;
   const float scales[] = {1.0f, 10.0f, 100.0f, 2.0f, 5.0f};
   bool found = false;
@@ -50,7 +52,7 @@ static float find_best_voltage_candidate(const std::vector<uint8_t> &buf, float
 }
 
 // Heuristic: find a load percent in the buffer (1..100) prefer values >5
-static int find_load_percent_in_buf(const std::vector<uint8_t> &buf) {
+static int find_load_percent_in_buf(HidReportView buf) {
   for (size_t i = 1; i < buf.size(); ++i) {
     uint8_t v = buf[i];
     if (v > 5 && v <= 100) return static_cast<int>(v);
@@ -64,13 +66,13 @@ static int find_load_percent_in_buf(const std::vector<uint8_t> &buf) {
 }
 
 // Candidate report IDs to probe for Eaton 5PX (in practice seen in NUT mge-hid mappings)
-static const uint8_t EATON_TEST_REPORT_IDS[] = { 0x0C, 0x16, 0x06, 0x30, 0x31 };
+static constexpr uint8_t EATON_TEST_REPORT_IDS[] = { 0x0C, 0x16, 0x06, 0x30, 0x31 };
 
 bool Eaton5PxProtocol::detect() {
-  ESP_LOGD(EATON_TAG, "Detecting Eaton 5PX protocol...");
+  UPS_HID_LOGD(EATON_TAG, "Detecting Eaton 5PX protocol...");
 
   if (!parent_->is_connected()) {
-    ESP_LOGD(EATON_TAG, "Device not connected, skipping Eaton detection");
+    UPS_HID_LOGD(EATON_TAG, "Device not connected, skipping Eaton detection");
     return false;
   }
 
@@ -80,10 +82,10 @@ bool Eaton5PxProtocol::detect() {
   // Allow device a short time to enumerate
   vTaskDelay(pdMS_TO_TICKS(timing::USB_INITIALIZATION_DELAY_MS));
 
-  std::vector<uint8_t> buf;
+  HidReportBuffer buf;
   for (uint8_t id : EATON_TEST_REPORT_IDS) {
     if (!parent_->is_connected()) return false;
-    ESP_LOGD(EATON_TAG, "Testing report 0x%02X", id);
+    UPS_HID_LOGD(EATON_TAG, "Testing report 0x%02X", id);
     if (read_hid_report(id, buf)) {
       ESP_LOGI(EATON_TAG, "Eaton 5PX detected via report 0x%02X (%zu bytes)", id, buf.size());
       return true;
@@ -91,43 +93,48 @@ bool Eaton5PxProtocol::detect() {
     vTaskDelay(pdMS_TO_TICKS(timing::REPORT_RETRY_DELAY_MS));
   }
 
-  ESP_LOGD(EATON_TAG, "Eaton 5PX not detected");
+  UPS_HID_LOGD(EATON_TAG, "Eaton 5PX not detected");
   return false;
 }
 
+size_t Eaton5PxProtocol::get_probe_report_ids(const uint8_t **report_ids) const {
+  *report_ids = EATON_TEST_REPORT_IDS;
+  return sizeof(EATON_TEST_REPORT_IDS);
+}
+
 bool Eaton5PxProtocol::initialize() {
-  ESP_LOGD(EATON_TAG, "Initializing Eaton 5PX protocol");
+  UPS_HID_LOGD(EATON_TAG, "Initializing Eaton 5PX protocol");
   // Nothing special needed for init in this minimal implementation
   return true;
 }
 
-bool Eaton5PxProtocol::read_hid_report(uint8_t report_id, std::vector<uint8_t> &out) {
+bool Eaton5PxProtocol::read_hid_report(uint8_t report_id, HidReportBuffer &out) {
   if (!parent_->is_connected()) return false;
 
-  uint8_t buffer[limits::MAX_HID_REPORT_SIZE];
-  size_t buffer_len = sizeof(buffer);
+  size_t buffer_len = out.capacity();
 
   // Prefer Input report for dynamic data
-  esp_err_t ret = parent_->hid_get_report(HID_REPORT_TYPE_INPUT, report_id, buffer, &buffer_len, parent_->get_protocol_timeout());
+  esp_err_t ret = parent_->hid_get_report(HID_REPORT_TYPE_INPUT, report_id, out.data(), &buffer_len, parent_->get_protocol_timeout());
   if (ret == ESP_OK && buffer_len > 0) {
-    out.assign(buffer, buffer + buffer_len);
-    ESP_LOGV(EATON_TAG, "Read Input report 0x%02X (%zu bytes)", report_id, buffer_len);
+    out.set_size(buffer_len);
+    UPS_HID_LOGV(EATON_TAG, "Read Input report 0x%02X (%zu bytes)", report_id, buffer_len);
     return true;
   }
 
   // Fallback to Feature report
-  buffer_len = sizeof(buffer);
-  ret = parent_->hid_get_report(HID_REPORT_TYPE_FEATURE, report_id, buffer, &buffer_len, parent_->get_protocol_timeout());
+  buffer_len = out.capacity();
+  ret = parent_->hid_get_report(HID_REPORT_TYPE_FEATURE, report_id, out.data(), &buffer_len, parent_->get_protocol_timeout());
   if (ret == ESP_OK && buffer_len > 0) {
-    out.assign(buffer, buffer + buffer_len);
-    ESP_LOGV(EATON_TAG, "Read Feature report 0x%02X (%zu bytes)", report_id, buffer_len);
+    out.set_size(buffer_len);
+    UPS_HID_LOGV(EATON_TAG, "Read Feature report 0x%02X (%zu bytes)", report_id, buffer_len);
     return true;
   }
 
+  out.clear();
   return false;
 }
 
-void Eaton5PxProtocol::parse_power_summary(const std::vector<uint8_t> &buf, UpsData &data) {
+void Eaton5PxProtocol::parse_power_summary(HidReportView buf, UpsData &data) {
   // Minimal heuristic parsing based on NUT mapping: RemainingCapacity (percent) and RunTimeToEmpty (seconds)
   if (buf.size() < 4) return;
 
@@ -140,10 +147,10 @@ void Eaton5PxProtocol::parse_power_summary(const std::vector<uint8_t> &buf, UpsD
   data.battery.level = static_cast<float>(std::min<uint8_t>(batt_percent, static_cast<uint8_t>(battery::MAX_LEVEL_PERCENT)));
   if (runtime_seconds > 0) data.battery.runtime_minutes = static_cast<float>(runtime_seconds) / 60.0f;
 
-  ESP_LOGD(EATON_TAG, "Parsed power summary: battery=%.0f%% runtime=%.1fmin", data.battery.level, data.battery.runtime_minutes);
+  UPS_HID_LOGD(EATON_TAG, "Parsed power summary: battery=%.0f%% runtime=%.1fmin", data.battery.level, data.battery.runtime_minutes);
 }
 
-void Eaton5PxProtocol::parse_present_status(const std::vector<uint8_t> &buf, UpsData &data) {
+void Eaton5PxProtocol::parse_present_status(HidReportView buf, UpsData &data) {
   if (buf.size() < 2) return;
   uint8_t status = buf[1];
 
@@ -152,37 +159,41 @@ void Eaton5PxProtocol::parse_present_status(const std::vector<uint8_t> &buf, Ups
   bool charging = (status & 0x02) != 0;
   bool discharging = (status & 0x04) != 0;
 
+  uint32_t flags = 0;
   if (ac_present && !discharging) {
-    data.power.status = status::ONLINE;
+    flags |= UPS_STATUS_OL;
     data.power.input_voltage = parent_->get_fallback_nominal_voltage();
   } else {
-    data.power.status = status::ON_BATTERY;
+    flags |= UPS_STATUS_OB;
     data.power.input_voltage = NAN;
   }
+  if (charging) flags |= UPS_STATUS_CHRG;
+  if (discharging) flags |= UPS_STATUS_DISCHRG;
+  data.power.status_flags = flags;
 
   if (charging) data.battery.status = battery_status::CHARGING;
   else if (discharging) data.battery.status = battery_status::DISCHARGING;
 
-  ESP_LOGD(EATON_TAG, "Parsed present status: AC=%s CHRG=%s DISCH=%s", ac_present?"Y":"N", charging?"Y":"N", discharging?"Y":"N");
+  UPS_HID_LOGD(EATON_TAG, "Parsed present status: AC=%s CHRG=%s DISCH=%s", ac_present?"Y":"N", charging?"Y":"N", discharging?"Y":"N");
 }
 
 bool Eaton5PxProtocol::read_data(UpsData &data) {
-  ESP_LOGV(EATON_TAG, "Reading Eaton 5PX data (minimal)");
+  UPS_HID_LOGV(EATON_TAG, "Reading Eaton 5PX data (minimal)");
 
   bool success = false;
   bool hardcoded_voltage = false;
-  std::vector<uint8_t> buf;
+  HidReportBuffer buf;
 
   // Try power summary
   if (read_hid_report(0x0C, buf)) {
-  ESP_LOGD(EATON_TAG, "Raw 0x0C: %s", hex_dump(buf).c_str());
+  UPS_HID_LOGD(EATON_TAG, "Raw 0x0C: %s", hex_dump(buf).c_str());
   parse_power_summary(buf, data);
     success = true;
   }
 
   // Try present/status
   if (read_hid_report(0x16, buf)) {
-  ESP_LOGD(EATON_TAG, "Raw 0x16: %s", hex_dump(buf).c_str());
+  UPS_HID_LOGD(EATON_TAG, "Raw 0x16: %s", hex_dump(buf).c_str());
   parse_present_status(buf, data);
     success = true;
   }
@@ -193,24 +204,24 @@ bool Eaton5PxProtocol::read_data(UpsData &data) {
   float fallback_nominal = parent_->get_fallback_nominal_voltage();
   if (!std::isnan(data.power.input_voltage) && data.power.input_voltage == fallback_nominal) {
     input_from_status = true;
-    ESP_LOGD(EATON_TAG, "Input voltage currently set from present status to fallback nominal %.1fV", fallback_nominal);
+    UPS_HID_LOGD(EATON_TAG, "Input voltage currently set from present status to fallback nominal %.1fV", fallback_nominal);
   }
 
   // Try battery alternative report
   if (read_hid_report(0x06, buf)) {
-  ESP_LOGD(EATON_TAG, "Raw 0x06: %s", hex_dump(buf).c_str());
+  UPS_HID_LOGD(EATON_TAG, "Raw 0x06: %s", hex_dump(buf).c_str());
   parse_power_summary(buf, data);
     success = true;
   }
 
   // Read input (0x30) and output (0x31) reports and use heuristics to pick best candidate
-  std::vector<uint8_t> buf30, buf31, buf35, buf06, buf0C;
+  HidReportBuffer buf30, buf31, buf35, buf06, buf0C;
   if (read_hid_report(0x30, buf30) && buf30.size() > 0) {
-    ESP_LOGD(EATON_TAG, "Raw 0x30: %s", hex_dump(buf30).c_str());
+    UPS_HID_LOGD(EATON_TAG, "Raw 0x30: %s", hex_dump(buf30).c_str());
     success = true;
   }
   if (read_hid_report(0x31, buf31) && buf31.size() > 0) {
-    ESP_LOGD(EATON_TAG, "Raw 0x31: %s", hex_dump(buf31).c_str());
+    UPS_HID_LOGD(EATON_TAG, "Raw 0x31: %s", hex_dump(buf31).c_str());
     success = true;
     // Eaton 5PX deterministic mapping: bytes [5..6] (LE) represent voltage in tenths of volts
     // e.g. raw 0x091D -> 233.3V
@@ -222,7 +233,7 @@ bool Eaton5PxProtocol::read_data(UpsData &data) {
           data.power.output_voltage = v;
           data.power.input_voltage = v; // on-grid these are identical; hardcode for 5PX
           hardcoded_voltage = true;
-          ESP_LOGD(EATON_TAG, "Eaton 5PX hardcoded voltage from 0x31[5..6]: %.1fV", v);
+          UPS_HID_LOGD(EATON_TAG, "Eaton 5PX hardcoded voltage from 0x31[5..6]: %.1fV", v);
           success = true;
         }
       }
@@ -233,7 +244,7 @@ bool Eaton5PxProtocol::read_data(UpsData &data) {
   float nominal = parent_->get_fallback_nominal_voltage();
   float best_candidate = NAN;
   // Try direct 16-bit little-endian at offsets [1,2] in each report first
-  auto try_direct = [&](const std::vector<uint8_t> &b) -> float {
+  auto try_direct = [&](HidReportView b) -> float {
     if (b.size() >= 3) {
       uint16_t vraw = static_cast<uint16_t>(b[1]) | (static_cast<uint16_t>(b[2]) << 8);
       if (vraw != 0xFFFF && vraw != 0x0000) {
@@ -258,7 +269,7 @@ bool Eaton5PxProtocol::read_data(UpsData &data) {
 
   // Determine best candidates per-report
   float chosen30 = NAN;
-  std::string src30;
+  const char *src30 = "";
   if (!std::isnan(d30) || !std::isnan(c30)) {
     chosen30 = !std::isnan(d30) ? d30 : c30;
     src30 = !std::isnan(d30) ? "direct_0x30" : "scan_0x30";
@@ -268,7 +279,7 @@ bool Eaton5PxProtocol::read_data(UpsData &data) {
   }
 
   float chosen31 = NAN;
-  std::string src31;
+  const char *src31 = "";
   if (!std::isnan(d31) || !std::isnan(c31)) {
     chosen31 = !std::isnan(d31) ? d31 : c31;
     src31 = !std::isnan(d31) ? "direct_0x31" : "scan_0x31";
@@ -281,7 +292,7 @@ bool Eaton5PxProtocol::read_data(UpsData &data) {
   // Bias toward 0x30 unless 0x31 is significantly closer to nominal.
   if (!std::isnan(chosen30) || !std::isnan(chosen31)) {
     float best_val = NAN;
-    std::string best_src;
+    const char *best_src = "";
     if (!std::isnan(chosen30) && std::isnan(chosen31)) {
       best_val = chosen30; best_src = src30;
     } else if (std::isnan(chosen30) && !std::isnan(chosen31)) {
@@ -301,16 +312,16 @@ bool Eaton5PxProtocol::read_data(UpsData &data) {
         const float OVERWRITE_THRESHOLD = 8.0f;
         if (!std::isnan(best_val) && std::fabs(best_val - fallback_nominal) <= OVERWRITE_THRESHOLD) {
           data.power.input_voltage = best_val;
-          ESP_LOGD(EATON_TAG, "Overwrote status nominal with candidate: %.1fV (source=%s)", data.power.input_voltage, best_src.c_str());
+          UPS_HID_LOGD(EATON_TAG, "Overwrote status nominal with candidate: %.1fV (source=%s)", data.power.input_voltage, best_src);
         } else {
-          ESP_LOGD(EATON_TAG, "Keeping status nominal input voltage %.1fV (candidate %s = %.1fV not within %.1fV)", fallback_nominal, best_src.c_str(), std::isnan(best_val)?NAN:best_val, OVERWRITE_THRESHOLD);
+          UPS_HID_LOGD(EATON_TAG, "Keeping status nominal input voltage %.1fV (candidate %s = %.1fV not within %.1fV)", fallback_nominal, best_src, std::isnan(best_val)?NAN:best_val, OVERWRITE_THRESHOLD);
         }
       } else {
         data.power.input_voltage = best_val;
-        ESP_LOGD(EATON_TAG, "Selected input voltage candidate: %.1fV (source=%s)", data.power.input_voltage, best_src.c_str());
+        UPS_HID_LOGD(EATON_TAG, "Selected input voltage candidate: %.1fV (source=%s)", data.power.input_voltage, best_src);
       }
     } else {
-      ESP_LOGD(EATON_TAG, "Skipped input heuristic because hardcoded 5PX voltage is used: %.1fV", data.power.input_voltage);
+      UPS_HID_LOGD(EATON_TAG, "Skipped input heuristic because hardcoded 5PX voltage is used: %.1fV", data.power.input_voltage);
     }
     success = true;
   }
@@ -318,12 +329,13 @@ bool Eaton5PxProtocol::read_data(UpsData &data) {
   // Output: prefer 0x31 candidates
   if (!hardcoded_voltage && !std::isnan(chosen31)) {
     data.power.output_voltage = chosen31;
-    ESP_LOGD(EATON_TAG, "Parsed output voltage: %.1fV (source=%s)", data.power.output_voltage, src31.c_str());
+    UPS_HID_LOGD(EATON_TAG, "Parsed output voltage: %.1fV (source=%s)", data.power.output_voltage, src31);
     success = true;
   } else if (hardcoded_voltage) {
-    ESP_LOGD(EATON_TAG, "Skipped output heuristic because hardcoded 5PX voltage is used: %.1fV", data.power.output_voltage);
+    UPS_HID_LOGD(EATON_TAG, "Skipped output heuristic because hardcoded 5PX voltage is used: %.1fV", data.power.output_voltage);
   }
 
+#if UPS_HID_LOG_DEBUG_ENABLED
   // Verbose candidate logging to help map bytes -> voltage on real hardware
   if (buf30.size() > 0 || buf31.size() > 0) {
     const float scales[] = {1.0f, 2.0f, 5.0f, 10.0f, 100.0f};
@@ -337,24 +349,25 @@ bool Eaton5PxProtocol::read_data(UpsData &data) {
         for (float s : scales) {
           float v = static_cast<float>(raw) / s;
           if (v >= 50.0f && v <= 300.0f) {
-            ESP_LOGD(EATON_TAG, "Candidate %s offset %zu raw=0x%04X scale=%.2f -> %.2fV", label.c_str(), i, raw, s, v);
+            UPS_HID_LOGD(EATON_TAG, "Candidate %s offset %zu raw=0x%04X scale=%.2f -> %.2fV", label.c_str(), i, raw, s, v);
           }
         }
       }
     }
   }
+#endif
 
   // For output voltage, prefer explicit parse from 0x31 (direct) then heuristic
   if (!hardcoded_voltage) {
     if (!std::isnan(d31)) {
       data.power.output_voltage = d31;
-      ESP_LOGD(EATON_TAG, "Parsed output voltage (direct): %.1fV", data.power.output_voltage);
+      UPS_HID_LOGD(EATON_TAG, "Parsed output voltage (direct): %.1fV", data.power.output_voltage);
       success = true;
     } else {
       float out_c = find_best_voltage_candidate(buf31, nominal);
       if (!std::isnan(out_c)) {
         data.power.output_voltage = out_c;
-        ESP_LOGD(EATON_TAG, "Parsed output voltage (heuristic): %.1fV", data.power.output_voltage);
+        UPS_HID_LOGD(EATON_TAG, "Parsed output voltage (heuristic): %.1fV", data.power.output_voltage);
         success = true;
       }
     }
@@ -362,12 +375,12 @@ bool Eaton5PxProtocol::read_data(UpsData &data) {
 
   // Try load percentage (report 0x35) first, then scan other reports (0x31, 0x06, 0x0C)
   if (read_hid_report(0x35, buf35) && buf35.size() >= 2) {
-    ESP_LOGD(EATON_TAG, "Raw 0x35: %s", hex_dump(buf35).c_str());
+    UPS_HID_LOGD(EATON_TAG, "Raw 0x35: %s", hex_dump(buf35).c_str());
     uint8_t load_raw = buf35[1];
     if (load_raw <= 100 && load_raw > 0) {
       data.power.load_percent = static_cast<float>(load_raw);
       success = true;
-      ESP_LOGD(EATON_TAG, "Parsed load percent: %d%% (raw=0x%02X)", load_raw, load_raw);
+      UPS_HID_LOGD(EATON_TAG, "Parsed load percent: %d%% (raw=0x%02X)", load_raw, load_raw);
     }
   }
   // fallback: scan 0x31 and known battery/summary buffers
@@ -382,14 +395,14 @@ bool Eaton5PxProtocol::read_data(UpsData &data) {
     if (cand > 0) {
       data.power.load_percent = static_cast<float>(cand);
       success = true;
-      ESP_LOGD(EATON_TAG, "Heuristic load percent: %d%%", cand);
+      UPS_HID_LOGD(EATON_TAG, "Heuristic load percent: %d%%", cand);
     }
   }
 
   // If still no load percent, try to derive from reported power (W or VA) in 0x31/0x06
   if (data.power.load_percent <= 0.0f) {
     // scan for 16-bit power candidates in 0x31 and 0x06
-    auto scan_power = [&](const std::vector<uint8_t> &b) -> float {
+    auto scan_power = [&](HidReportView b) -> float {
       if (b.size() < 3) return NAN;
       for (size_t i = 1; i + 1 < b.size(); ++i) {
         uint16_t raw = static_cast<uint16_t>(b[i]) | (static_cast<uint16_t>(b[i+1]) << 8);
@@ -418,7 +431,7 @@ bool Eaton5PxProtocol::read_data(UpsData &data) {
       if (load > 0.0f && load <= 200.0f) {
         data.power.load_percent = load;
         success = true;
-        ESP_LOGD(EATON_TAG, "Derived load from power: %.0fW nominal=%.0fW -> load=%.1f%% (power_raw=%.1f)", p, nominal_w, data.power.load_percent, p);
+        UPS_HID_LOGD(EATON_TAG, "Derived load from power: %.0fW nominal=%.0fW -> load=%.1f%% (power_raw=%.1f)", p, nominal_w, data.power.load_percent, p);
       }
     }
   }
@@ -3,6 +3,7 @@
 #include "ups_hid.h"
 #include "data_composite.h"
 #include "data_device.h"
+#include "hid_report.h"
 
 namespace esphome {
 namespace ups_hid {
@@ -14,17 +15,19 @@ class Eaton5PxProtocol : public UpsProtocolBase {
 
   DeviceInfo::DetectedProtocol get_protocol_type() const override { return DeviceInfo::PROTOCOL_GENERIC_HID; }
   std::string get_protocol_name() const override { return "Eaton 5PX"; }
+  size_t get_memory_usage() const override { return sizeof(*this); }
 
   bool detect() override;
+  size_t get_probe_report_ids(const uint8_t **report_ids) const override;
   bool initialize() override;
   bool read_data(UpsData &data) override;
 
   // Control/test/beeper not implemented for this minimal driver
 
  private:
-  bool read_hid_report(uint8_t report_id, std::vector<uint8_t> &out);
-  void parse_power_summary(const std::vector<uint8_t> &buf, UpsData &data);
-  void parse_present_status(const std::vector<uint8_t> &buf, UpsData &data);
+  bool read_hid_report(uint8_t report_id, HidReportBuffer &out);
+  void parse_power_summary(HidReportView buf, UpsData &data);
+  void parse_present_status(HidReportView buf, UpsData &data);
 };
 
 // Register for Eaton/MGE vendor ID
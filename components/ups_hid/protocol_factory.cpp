@@ -1,6 +1,10 @@
 #include "protocol_factory.h"
 #include "ups_hid.h"
-#include "esphome/core/log.h"
+#include "constants_ups.h"
+#include "hid_report.h"
+#include "log_ups.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include <algorithm>
 
 namespace esphome {
@@ -26,7 +30,7 @@ void ProtocolFactory::ensure_initialized() {
     // This function exists for explicit initialization if needed
     static bool initialized = false;
     if (!initialized) {
-        ESP_LOGD(FACTORY_TAG, "Protocol factory registries initialized");
+        UPS_HID_LOGD(FACTORY_TAG, "Protocol factory registries initialized");
         initialized = true;
     }
 }
@@ -73,45 +77,87 @@ ProtocolFactory::create_for_vendor(uint16_t vendor_id, UpsHidComponent* parent)
         return nullptr;
     }
     
+    // Give device time to initialize after connection, once for all candidates
+    vTaskDelay(pdMS_TO_TICKS(timing::USB_INITIALIZATION_DELAY_MS));
+    ProbeResults results;
+    
     // Try vendor-specific protocols first
     auto& vendor_registry = get_vendor_registry();
     auto vendor_it = vendor_registry.find(vendor_id);
     
     if (vendor_it != vendor_registry.end()) {
-        ESP_LOGD(FACTORY_TAG, "Found %zu vendor-specific protocols for 0x%04X", 
+        UPS_HID_LOGD(FACTORY_TAG, "Found %zu vendor-specific protocols for 0x%04X", 
                  vendor_it->second.size(), vendor_id);
-        
-        for (const auto& info : vendor_it->second) {
-            ESP_LOGD(FACTORY_TAG, "Trying vendor protocol '%s' for 0x%04X", 
-                     info.name.c_str(), vendor_id);
-            
-            auto protocol = info.creator(parent);
-            if (protocol && protocol->detect()) {
-                ESP_LOGI(FACTORY_TAG, "Successfully created protocol '%s' for vendor 0x%04X", 
-                         info.name.c_str(), vendor_id);
-                return protocol;
-            }
+        auto protocol = select_by_probe(vendor_it->second, parent, results);
+        if (protocol) {
+            ESP_LOGI(FACTORY_TAG, "Successfully created protocol '%s' for vendor 0x%04X", 
+                     protocol->get_protocol_name().c_str(), vendor_id);
+            return protocol;
         }
     }
     
-    // Try fallback protocols
+    // Try fallback protocols; IDs already read above are not probed again
     auto& fallback_registry = get_fallback_registry();
-    ESP_LOGD(FACTORY_TAG, "Trying %zu fallback protocols for vendor 0x%04X", 
+    UPS_HID_LOGD(FACTORY_TAG, "Trying %zu fallback protocols for vendor 0x%04X", 
              fallback_registry.size(), vendor_id);
+    auto protocol = select_by_probe(fallback_registry, parent, results);
+    if (protocol) {
+        ESP_LOGI(FACTORY_TAG, "Successfully created fallback protocol '%s' for vendor 0x%04X", 
+                 protocol->get_protocol_name().c_str(), vendor_id);
+        return protocol;
+    }
     
-    for (const auto& info : fallback_registry) {
-        ESP_LOGD(FACTORY_TAG, "Trying fallback protocol '%s' for 0x%04X", 
-                 info.name.c_str(), vendor_id);
-        
+    ESP_LOGW(FACTORY_TAG, "No suitable protocol found for vendor 0x%04X", vendor_id);
+    return nullptr;
+}
+
+std::unique_ptr<UpsProtocolBase>
+ProtocolFactory::select_by_probe(const std::vector<ProtocolInfo>& infos, UpsHidComponent* parent,
+                                 ProbeResults& results) {
+    // Union of every candidate's probe IDs, each read once
+    std::vector<std::unique_ptr<UpsProtocolBase>> candidates;
+    std::vector<uint8_t> report_ids;
+    for (const auto& info : infos) {
         auto protocol = info.creator(parent);
-        if (protocol && protocol->detect()) {
-            ESP_LOGI(FACTORY_TAG, "Successfully created fallback protocol '%s' for vendor 0x%04X", 
-                     info.name.c_str(), vendor_id);
-            return protocol;
+        if (!protocol) {
+            continue;
         }
+        const uint8_t* ids;
+        const size_t count = protocol->get_probe_report_ids(&ids);
+        report_ids.insert(report_ids.end(), ids, ids + count);
+        candidates.push_back(std::move(protocol));
+    }
+    if (!report_ids.empty()) {
+        parent->probe_reports(report_ids.data(), report_ids.size(), results);
     }
     
-    ESP_LOGW(FACTORY_TAG, "No suitable protocol found for vendor 0x%04X", vendor_id);
+    // Highest score wins; candidates are in priority order, so ties go to the higher priority
+    int best_score = 0;
+    size_t best = candidates.size();
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const uint8_t* ids;
+        if (candidates[i]->get_probe_report_ids(&ids) == 0) {
+            continue;
+        }
+        const int score = candidates[i]->score_probe(results);
+        UPS_HID_LOGD(FACTORY_TAG, "Protocol '%s' scored %d", candidates[i]->get_protocol_name().c_str(), score);
+        if (score > best_score) {
+            best_score = score;
+            best = i;
+        }
+    }
+    if (best < candidates.size()) {
+        candidates[best]->use_probe_results(results);
+        return std::move(candidates[best]);
+    }
+    
+    // Protocols without probe IDs run their own detection
+    for (auto& protocol : candidates) {
+        const uint8_t* ids;
+        if (protocol->get_probe_report_ids(&ids) == 0 && protocol->detect()) {
+            return std::move(protocol);
+        }
+    }
     return nullptr;
 }
 
@@ -186,7 +232,7 @@ ProtocolFactory::create_by_name(const std::string& protocol_name, UpsHidComponen
         return nullptr;
     }
     
-    ESP_LOGD(FACTORY_TAG, "Creating protocol by name: %s", protocol_name.c_str());
+    UPS_HID_LOGD(FACTORY_TAG, "Creating protocol by name: %s", protocol_name.c_str());
     
     // Search through all registered protocols to find one with matching name
     auto& vendor_registry = get_vendor_registry();
@@ -199,7 +245,7 @@ ProtocolFactory::create_by_name(const std::string& protocol_name, UpsHidComponen
             std::transform(protocol_name_lower.begin(), protocol_name_lower.end(), protocol_name_lower.begin(), ::tolower);
             
             if (info_name_lower.find(protocol_name_lower) != std::string::npos) {
-                ESP_LOGD(FACTORY_TAG, "Found matching protocol '%s' for name '%s'", 
+                UPS_HID_LOGD(FACTORY_TAG, "Found matching protocol '%s' for name '%s'", 
                          info.name.c_str(), protocol_name.c_str());
                 auto protocol = info.creator(parent);
                 if (protocol) {
@@ -220,7 +266,7 @@ ProtocolFactory::create_by_name(const std::string& protocol_name, UpsHidComponen
         std::transform(protocol_name_lower.begin(), protocol_name_lower.end(), protocol_name_lower.begin(), ::tolower);
         
         if (info_name_lower.find(protocol_name_lower) != std::string::npos) {
-            ESP_LOGD(FACTORY_TAG, "Found matching fallback protocol '%s' for name '%s'", 
+            UPS_HID_LOGD(FACTORY_TAG, "Found matching fallback protocol '%s' for name '%s'", 
                      info.name.c_str(), protocol_name.c_str());
             auto protocol = info.creator(parent);
             if (protocol) {
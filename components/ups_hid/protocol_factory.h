@@ -12,6 +12,7 @@ namespace ups_hid {
 // Forward declarations
 class UpsProtocolBase;
 class UpsHidComponent;
+class ProbeResults;
 
 /**
  * Protocol Factory with Self-Registration Support
@@ -49,6 +50,10 @@ public:
     
     /**
      * Create protocol instance for specific vendor
+     *
+     * The vendor-specific candidates' probe report IDs are read in one round
+     * and the best-scoring candidate wins; the fallbacks are only probed when
+     * none of them matches.
      */
     static std::unique_ptr<UpsProtocolBase> create_for_vendor(uint16_t vendor_id, 
                                                             UpsHidComponent* parent);
@@ -84,6 +89,10 @@ private:
     
     // Ensure registries are initialized
     static void ensure_initialized();
+    
+    // One probe round over the candidates in infos, answers accumulated in results
+    static std::unique_ptr<UpsProtocolBase> select_by_probe(const std::vector<ProtocolInfo>& infos,
+                                                            UpsHidComponent* parent, ProbeResults& results);
 };
 
 /**
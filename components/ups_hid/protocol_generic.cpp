@@ -2,12 +2,10 @@
 #include "ups_hid.h"
 #include "constants_hid.h"
 #include "constants_ups.h"
-#include "esphome/core/log.h"
+#include "log_ups.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/portmacro.h"
-#include <set>
-#include <map>
 #include <algorithm>
 #include <cmath>
 
@@ -18,7 +16,7 @@ static const char *const GEN_TAG = "ups_hid.generic";
 
 // Common HID Power Device report IDs based on NUT analysis
 // These are the most frequently used report IDs across different UPS vendors
-static const uint8_t COMMON_REPORT_IDS[] = {
+static constexpr uint8_t COMMON_REPORT_IDS[] = {
   0x01, // General status (widely used)
   0x06, // Battery status (APC and others)
   0x0C, // Power summary (battery % + runtime)
@@ -40,21 +38,29 @@ static const uint8_t EXTENDED_REPORT_IDS[] = {
 // HID report types are now defined in hid_constants.h
 
 bool GenericHidProtocol::detect() {
-  ESP_LOGD(GEN_TAG, "Detecting Generic HID Protocol...");
+  UPS_HID_LOGD(GEN_TAG, "Detecting Generic HID Protocol...");
   
   // Check device connection status first
   if (!parent_->is_connected()) {
-    ESP_LOGD(GEN_TAG, "Device not connected, skipping protocol detection");
+    UPS_HID_LOGD(GEN_TAG, "Device not connected, skipping protocol detection");
     return false;
   }
   
   // Check if this is a known vendor that should use a specific protocol
   uint16_t vid = parent_->get_vendor_id();
   if (vid == usb::VENDOR_ID_APC || vid == usb::VENDOR_ID_CYBERPOWER) { // APC or CyberPower
-    ESP_LOGD(GEN_TAG, "Known vendor 0x%04X should use specific protocol", vid);
+    UPS_HID_LOGD(GEN_TAG, "Known vendor 0x%04X should use specific protocol", vid);
     return false;
   }
   
+  // A report descriptor declaring Power Device or Battery System usages is conclusive
+  const HidReportDescriptor *descriptor = parent_->get_report_descriptor();
+  if (descriptor && (descriptor->has_usage_page(HID_USAGE_PAGE_POWER_DEVICE) ||
+                     descriptor->has_usage_page(HID_USAGE_PAGE_BATTERY_SYSTEM))) {
+    ESP_LOGI(GEN_TAG, "Report descriptor declares HID Power Device usages");
+    return true;
+  }
+  
   // Try common report IDs to detect HID Power Device
   uint8_t buffer[limits::MIN_HID_REPORT_SIZE];
   size_t buffer_len;
@@ -62,7 +68,7 @@ bool GenericHidProtocol::detect() {
   for (uint8_t report_id : COMMON_REPORT_IDS) {
     // Check connection status before each attempt
     if (!parent_->is_connected()) {
-      ESP_LOGD(GEN_TAG, "Device disconnected during protocol detection");
+      UPS_HID_LOGD(GEN_TAG, "Device disconnected during protocol detection");
       return false;
     }
     
@@ -70,15 +76,15 @@ bool GenericHidProtocol::detect() {
     buffer_len = sizeof(buffer);
     esp_err_t ret = parent_->hid_get_report(HID_REPORT_TYPE_INPUT, report_id, buffer, &buffer_len, parent_->get_protocol_timeout());
     if (ret == ESP_OK && buffer_len > 0) {
-      available_input_reports_.insert(report_id);
+      available_input_reports_.set(report_id);
       ESP_LOGI(GEN_TAG, "Found Input report 0x%02X (%zu bytes)", report_id, buffer_len);
-      report_sizes_[report_id] = buffer_len;
+      report_sizes_[report_id] = static_cast<uint8_t>(buffer_len);
       return true;
     }
     
     // Check connection again before trying Feature report
     if (!parent_->is_connected()) {
-      ESP_LOGD(GEN_TAG, "Device disconnected during protocol detection");
+      UPS_HID_LOGD(GEN_TAG, "Device disconnected during protocol detection");
       return false;
     }
     
@@ -86,9 +92,9 @@ bool GenericHidProtocol::detect() {
     buffer_len = sizeof(buffer);
     ret = parent_->hid_get_report(HID_REPORT_TYPE_FEATURE, report_id, buffer, &buffer_len, parent_->get_protocol_timeout());
     if (ret == ESP_OK && buffer_len > 0) {
-      available_feature_reports_.insert(report_id);
+      available_feature_reports_.set(report_id);
       ESP_LOGI(GEN_TAG, "Found Feature report 0x%02X (%zu bytes)", report_id, buffer_len);
-      report_sizes_[report_id] = buffer_len;
+      report_sizes_[report_id] = static_cast<uint8_t>(buffer_len);
       return true;
     }
     
@@ -96,45 +102,169 @@ bool GenericHidProtocol::detect() {
     vTaskDelay(pdMS_TO_TICKS(timing::EXTENDED_DISCOVERY_DELAY_MS));
   }
   
-  ESP_LOGD(GEN_TAG, "No standard HID Power Device reports found");
+  UPS_HID_LOGD(GEN_TAG, "No standard HID Power Device reports found");
   return false;
 }
 
+size_t GenericHidProtocol::get_probe_report_ids(const uint8_t **report_ids) const {
+  *report_ids = COMMON_REPORT_IDS;
+  return sizeof(COMMON_REPORT_IDS);
+}
+
+int GenericHidProtocol::score_probe(const ProbeResults &results) const {
+  // Known vendors should use their specific protocol
+  uint16_t vid = parent_->get_vendor_id();
+  if (vid == usb::VENDOR_ID_APC || vid == usb::VENDOR_ID_CYBERPOWER) {
+    return 0;
+  }
+  const HidReportDescriptor *descriptor = parent_->get_report_descriptor();
+  if (descriptor && (descriptor->has_usage_page(HID_USAGE_PAGE_POWER_DEVICE) ||
+                     descriptor->has_usage_page(HID_USAGE_PAGE_BATTERY_SYSTEM))) {
+    return static_cast<int>(sizeof(COMMON_REPORT_IDS)) + 1;
+  }
+  return static_cast<int>(results.count_answered(COMMON_REPORT_IDS, sizeof(COMMON_REPORT_IDS)));
+}
+
+void GenericHidProtocol::use_probe_results(const ProbeResults &results) {
+  probe_results_.reset(new ProbeResults(results));
+}
+
 bool GenericHidProtocol::initialize() {
-  ESP_LOGD(GEN_TAG, "Initializing Generic HID Protocol...");
+  UPS_HID_LOGD(GEN_TAG, "Initializing Generic HID Protocol...");
   
-  // Clear any previous state
-  available_input_reports_.clear();
-  available_feature_reports_.clear();
-  report_sizes_.clear();
+  clear_discovery();
+  
+  // The descriptor lists every report, so probing is only needed without one
+  const HidReportDescriptor *descriptor = parent_->get_report_descriptor();
+  if (descriptor && build_field_map(*descriptor)) {
+    ESP_LOGI(GEN_TAG, "Generic HID initialized from report descriptor: %zu fields in %zu reports",
+             field_bindings_.size(), mapped_reports_.size());
+    probe_results_.reset();
+    return true;
+  }
   
   // Enumerate available reports
   enumerate_reports();
+  probe_results_.reset();
   
-  if (available_input_reports_.empty() && available_feature_reports_.empty()) {
+  if (available_input_reports_.none() && available_feature_reports_.none()) {
     ESP_LOGE(GEN_TAG, "No HID reports found during initialization");
     return false;
   }
   
   ESP_LOGI(GEN_TAG, "Generic HID initialized with %zu input and %zu feature reports",
-           available_input_reports_.size(), available_feature_reports_.size());
+           available_input_reports_.count(), available_feature_reports_.count());
   
   // Log discovered reports for debugging
-  ESP_LOGD(GEN_TAG, "Input reports:");
-  for (uint8_t id : available_input_reports_) {
-    ESP_LOGD(GEN_TAG, "  0x%02X: %zu bytes", id, report_sizes_[id]);
+  UPS_HID_LOGD(GEN_TAG, "Input reports:");
+  for (unsigned id = 0; id < 256; id++) {
+    if (available_input_reports_.test(id)) {
+      UPS_HID_LOGD(GEN_TAG, "  0x%02X: %u bytes", id, report_sizes_[id]);
+    }
+  }
+  UPS_HID_LOGD(GEN_TAG, "Feature reports:");
+  for (unsigned id = 0; id < 256; id++) {
+    if (available_feature_reports_.test(id)) {
+      UPS_HID_LOGD(GEN_TAG, "  0x%02X: %u bytes", id, report_sizes_[id]);
+    }
+  }
+  
+  return true;
+}
+
+void GenericHidProtocol::clear_discovery() {
+  available_input_reports_.reset();
+  available_feature_reports_.reset();
+  std::fill(std::begin(report_sizes_), std::end(report_sizes_), 0);
+  field_bindings_.clear();
+  mapped_reports_.clear();
+}
+
+size_t GenericHidProtocol::get_memory_usage() const {
+  return sizeof(*this) + heap_bytes(field_bindings_) + heap_bytes(mapped_reports_) +
+         (probe_results_ ? sizeof(ProbeResults) : 0);
+}
+
+bool GenericHidProtocol::save_discovery(ProtocolDiscovery &discovery) const {
+  // A descriptor-driven field map is rebuilt from the descriptor; only probing results are kept
+  for (unsigned id = 0; id < 256; id++) {
+    if (available_input_reports_.test(id)) {
+      ProtocolDiscovery::set(discovery.input_reports, id);
+    }
+    if (available_feature_reports_.test(id)) {
+      ProtocolDiscovery::set(discovery.feature_reports, id);
+    }
+    if (report_sizes_[id] != 0 && discovery.report_size_count < limits::MAX_CACHED_REPORT_SIZES) {
+      discovery.report_sizes[discovery.report_size_count++] = {static_cast<uint8_t>(id), report_sizes_[id]};
+    }
   }
-  ESP_LOGD(GEN_TAG, "Feature reports:");
-  for (uint8_t id : available_feature_reports_) {
-    ESP_LOGD(GEN_TAG, "  0x%02X: %zu bytes", id, report_sizes_[id]);
+  return true;
+}
+
+bool GenericHidProtocol::initialize_from_discovery(const ProtocolDiscovery &discovery) {
+  clear_discovery();
+  
+  const HidReportDescriptor *descriptor = parent_->get_report_descriptor();
+  if (descriptor && build_field_map(*descriptor)) {
+    ESP_LOGI(GEN_TAG, "Generic HID initialized from report descriptor: %zu fields in %zu reports",
+             field_bindings_.size(), mapped_reports_.size());
+    return true;
   }
   
+  for (unsigned id = 0; id < 256; id++) {
+    if (ProtocolDiscovery::test(discovery.input_reports, id)) {
+      available_input_reports_.set(id);
+    }
+    if (ProtocolDiscovery::test(discovery.feature_reports, id)) {
+      available_feature_reports_.set(id);
+    }
+  }
+  for (uint8_t i = 0; i < discovery.report_size_count && i < limits::MAX_CACHED_REPORT_SIZES; i++) {
+    report_sizes_[discovery.report_sizes[i].report_id] = discovery.report_sizes[i].size;
+  }
+  if (available_input_reports_.none() && available_feature_reports_.none()) {
+    return initialize();
+  }
+  
+  ESP_LOGI(GEN_TAG, "Generic HID restored %zu input and %zu feature reports without probing",
+           available_input_reports_.count(), available_feature_reports_.count());
   return true;
 }
 
 bool GenericHidProtocol::read_data(UpsData &data) {
-  ESP_LOGV(GEN_TAG, "Reading Generic HID UPS data...");
+  UPS_HID_LOGV(GEN_TAG, "Reading Generic HID UPS data...");
   
+  bool success = field_bindings_.empty() ? read_probed_reports(data) : read_mapped_reports(data);
+
+  // Set generic manufacturer/model if not already set
+  if (data.device.manufacturer.empty())
+  {
+    data.device.manufacturer = protocol::GENERIC;
+  }
+  if (data.device.model.empty())
+  {
+    uint16_t vid = parent_->get_vendor_id();
+    uint16_t pid = parent_->get_product_id();
+    char model_str[32];
+    snprintf(model_str, sizeof(model_str), "HID UPS %04X:%04X", vid, pid);
+    data.device.model = model_str;
+  }
+
+  // Ensure we have at least basic power status
+  if (success && !data.power.has_status_flags())
+  {
+    // If we got data but no power status, assume online
+    data.power.set_status(UPS_STATUS_POWER_SOURCE, UPS_STATUS_OL);
+    data.power.input_voltage = parent_->get_fallback_nominal_voltage(); // Use configured fallback voltage
+  }
+
+  // Set default test result
+  data.test.ups_test_result = test::RESULT_NO_TEST;
+
+  return success;
+}
+
+bool GenericHidProtocol::read_probed_reports(UpsData &data) {
   bool success = false;
   uint8_t buffer[limits::MAX_HID_REPORT_SIZE];
   size_t buffer_len;
@@ -185,7 +315,7 @@ bool GenericHidProtocol::read_data(UpsData &data) {
   if (!std::isnan(data.power.load_percent))
   {
     // Check if load percentage was already set by previous parsing
-    ESP_LOGV(GEN_TAG, "Load percentage already set: %.1f%%", data.power.load_percent);
+    UPS_HID_LOGV(GEN_TAG, "Load percentage already set: %.1f%%", data.power.load_percent);
   }
   else
   {
@@ -235,8 +365,12 @@ bool GenericHidProtocol::read_data(UpsData &data) {
   // 11. Try any other discovered reports with heuristic parsing
   if (!success)
   {
-    for (uint8_t id : available_input_reports_)
+    for (unsigned id = 0; id < 256; id++)
     {
+      if (!available_input_reports_.test(id))
+      {
+        continue;
+      }
       if (id == 0x01 || id == 0x06 || id == 0x0C || id == 0x16 ||
           id == 0x30 || id == 0x31 || id == 0x50 || id == 0x1A || id == 0x35)
       {
@@ -245,7 +379,7 @@ bool GenericHidProtocol::read_data(UpsData &data) {
 
       if (read_report(id, buffer, buffer_len))
       {
-        ESP_LOGV(GEN_TAG, "Trying heuristic parsing for report 0x%02X", id);
+        UPS_HID_LOGV(GEN_TAG, "Trying heuristic parsing for report 0x%02X", id);
         if (parse_unknown_report(buffer, buffer_len, data))
         {
           success = true;
@@ -255,37 +389,280 @@ bool GenericHidProtocol::read_data(UpsData &data) {
     }
   }
 
-  // Set generic manufacturer/model if not already set
-  if (data.device.manufacturer.empty())
-  {
-    data.device.manufacturer = protocol::GENERIC;
+  return success;
+}
+
+bool GenericHidProtocol::build_field_map(const HidReportDescriptor &descriptor) {
+  bool bound[static_cast<size_t>(FieldTarget::COUNT)] = {};
+  descriptor_uses_report_ids_ = descriptor.uses_report_ids();
+
+  // Descriptor fields are ordered input reports first, so a value exposed as
+  // both input and feature is bound to the input report
+  for (const HidField &field : descriptor.fields()) {
+    if (field.report_type == HID_REPORT_TYPE_OUTPUT) {
+      continue;
+    }
+    FieldTarget target;
+    if (!classify_field(descriptor, field, target) || bound[static_cast<size_t>(target)]) {
+      continue;
+    }
+    bound[static_cast<size_t>(target)] = true;
+
+    if (mapped_reports_.empty() || mapped_reports_.back().report_type != field.report_type ||
+        mapped_reports_.back().report_id != field.report_id) {
+      mapped_reports_.push_back({field.report_type, field.report_id,
+                                 static_cast<uint16_t>(field_bindings_.size()), 0});
+    }
+    mapped_reports_.back().binding_count++;
+    field_bindings_.push_back({field, target});
+
+    UPS_HID_LOGV(GEN_TAG, "Usage 0x%08X -> %s report 0x%02X bit %u, %u bits, exp %d",
+             field.usage, field.report_type == HID_REPORT_TYPE_INPUT ? "input" : "feature",
+             field.report_id, field.bit_offset, field.bit_size, field.unit_exponent);
   }
-  if (data.device.model.empty())
-  {
-    uint16_t vid = parent_->get_vendor_id();
-    uint16_t pid = parent_->get_product_id();
-    char model_str[32];
-    snprintf(model_str, sizeof(model_str), "HID UPS %04X:%04X", vid, pid);
-    data.device.model = model_str;
+
+  for (const MappedReport &report : mapped_reports_) {
+    if (report.report_type == HID_REPORT_TYPE_INPUT) {
+      available_input_reports_.set(report.report_id);
+    } else {
+      available_feature_reports_.set(report.report_id);
+    }
+    const HidReportInfo *info = descriptor.find_report(report.report_type, report.report_id);
+    if (info) {
+      report_sizes_[report.report_id] =
+          static_cast<uint8_t>((info->bit_length + 7) / 8 + (descriptor_uses_report_ids_ ? 1 : 0));
+    }
   }
 
-  // Ensure we have at least basic power status
-  if (success && data.power.status.empty())
-  {
-    // If we got data but no power status, assume online
-    data.power.status = status::ONLINE;
-    data.power.input_voltage = parent_->get_fallback_nominal_voltage(); // Use configured fallback voltage
+  return !field_bindings_.empty();
+}
+
+bool GenericHidProtocol::classify_field(const HidReportDescriptor &descriptor, const HidField &field,
+                                        FieldTarget &target) {
+  const uint16_t page = field.usage >> 16;
+  const uint16_t id = field.usage & 0xFFFF;
+
+  if (page == HID_USAGE_PAGE_BATTERY_SYSTEM) {
+    switch (id) {
+      case HID_USAGE_BAT_REMAINING_CAPACITY: target = FieldTarget::BATTERY_LEVEL; return true;
+      case HID_USAGE_BAT_RUN_TIME_TO_EMPTY: target = FieldTarget::BATTERY_RUNTIME; return true;
+      case HID_USAGE_BAT_REMAINING_CAPACITY_LIMIT: target = FieldTarget::BATTERY_CHARGE_LOW; return true;
+      case HID_USAGE_BAT_WARNING_CAPACITY_LIMIT: target = FieldTarget::BATTERY_CHARGE_WARNING; return true;
+      case HID_USAGE_BAT_REMAINING_TIME_LIMIT: target = FieldTarget::BATTERY_RUNTIME_LOW; return true;
+      case HID_USAGE_BAT_AC_PRESENT: target = FieldTarget::FLAG_AC_PRESENT; return true;
+      case HID_USAGE_BAT_CHARGING: target = FieldTarget::FLAG_CHARGING; return true;
+      case HID_USAGE_BAT_DISCHARGING: target = FieldTarget::FLAG_DISCHARGING; return true;
+      case HID_USAGE_BAT_BELOW_CAPACITY_LIMIT: target = FieldTarget::FLAG_BELOW_CAPACITY_LIMIT; return true;
+      case HID_USAGE_BAT_NEED_REPLACEMENT: target = FieldTarget::FLAG_NEED_REPLACEMENT; return true;
+      default: return false;
+    }
   }
 
-  // Set default test result
-  data.test.ups_test_result = test::RESULT_NO_TEST;
+  if (page != HID_USAGE_PAGE_POWER_DEVICE) {
+    return false;
+  }
+
+  // Voltages are told apart by their enclosing Input, Output or Battery collection
+  const bool in_input = descriptor.in_collection(field, HID_USAGE_POW(HID_USAGE_POW_INPUT));
+  const bool in_output = descriptor.in_collection(field, HID_USAGE_POW(HID_USAGE_POW_OUTPUT));
+  const bool in_battery = descriptor.in_collection(field, HID_USAGE_POW(HID_USAGE_POW_BATTERY));
+
+  switch (id) {
+    case HID_USAGE_POW_VOLTAGE:
+      if (in_input) { target = FieldTarget::INPUT_VOLTAGE; return true; }
+      if (in_output) { target = FieldTarget::OUTPUT_VOLTAGE; return true; }
+      if (in_battery) { target = FieldTarget::BATTERY_VOLTAGE; return true; }
+      return false;
+    case HID_USAGE_POW_CONFIG_VOLTAGE:
+      if (in_input) { target = FieldTarget::INPUT_VOLTAGE_NOMINAL; return true; }
+      if (in_output) { target = FieldTarget::OUTPUT_VOLTAGE_NOMINAL; return true; }
+      if (in_battery) { target = FieldTarget::BATTERY_VOLTAGE_NOMINAL; return true; }
+      return false;
+    case HID_USAGE_POW_FREQUENCY:
+      if (in_output) return false;
+      target = FieldTarget::INPUT_FREQUENCY;
+      return true;
+    case HID_USAGE_POW_PERCENT_LOAD: target = FieldTarget::LOAD_PERCENT; return true;
+    case HID_USAGE_POW_LOW_VOLTAGE_TRANSFER: target = FieldTarget::INPUT_TRANSFER_LOW; return true;
+    case HID_USAGE_POW_HIGH_VOLTAGE_TRANSFER: target = FieldTarget::INPUT_TRANSFER_HIGH; return true;
+    case HID_USAGE_POW_CONFIG_ACTIVE_POWER: target = FieldTarget::REALPOWER_NOMINAL; return true;
+    case HID_USAGE_POW_CONFIG_APPARENT_POWER: target = FieldTarget::APPARENT_POWER_NOMINAL; return true;
+    case HID_USAGE_POW_DELAY_BEFORE_SHUTDOWN: target = FieldTarget::DELAY_SHUTDOWN; return true;
+    case HID_USAGE_POW_DELAY_BEFORE_STARTUP: target = FieldTarget::DELAY_START; return true;
+    case HID_USAGE_POW_DELAY_BEFORE_REBOOT: target = FieldTarget::DELAY_REBOOT; return true;
+    case HID_USAGE_POW_OVERLOAD: target = FieldTarget::FLAG_OVERLOAD; return true;
+    case HID_USAGE_POW_INTERNAL_FAILURE: target = FieldTarget::FLAG_INTERNAL_FAILURE; return true;
+    default: return false;
+  }
+}
+
+bool GenericHidProtocol::read_mapped_reports(UpsData &data) {
+  bool success = false;
+  StatusFlags flags;
+  uint8_t buffer[limits::MAX_HID_REPORT_SIZE];
+
+  for (const MappedReport &report : mapped_reports_) {
+    size_t buffer_len = sizeof(buffer);
+    esp_err_t ret = parent_->hid_get_report(report.report_type, report.report_id, buffer, &buffer_len,
+                                            parent_->get_protocol_timeout());
+    if (ret != ESP_OK || buffer_len == 0) {
+      UPS_HID_LOGV(GEN_TAG, "Mapped report 0x%02X unavailable: %s", report.report_id, esp_err_to_name(ret));
+      continue;
+    }
+    success = true;
 
+    for (uint16_t i = 0; i < report.binding_count; i++) {
+      const FieldBinding &binding = field_bindings_[report.first_binding + i];
+      int32_t raw;
+      if (!HidReportDescriptor::extract(binding.field, buffer, buffer_len, descriptor_uses_report_ids_, raw)) {
+        continue;
+      }
+      apply_field(binding.target, HidReportDescriptor::to_physical(binding.field, raw), raw, data, flags);
+    }
+  }
+
+  if (success) {
+    apply_status_flags(flags, data);
+  }
   return success;
 }
 
+void GenericHidProtocol::apply_field(FieldTarget target, float value, int32_t raw, UpsData &data,
+                                     StatusFlags &flags) {
+  auto positive = [](float v) { return !std::isnan(v) && v > 0.0f; };
+  auto percent = [](float v) { return !std::isnan(v) && v >= 0.0f && v <= battery::MAX_LEVEL_PERCENT; };
+
+  switch (target) {
+    case FieldTarget::BATTERY_LEVEL:
+      if (percent(value)) data.battery.level = value;
+      break;
+    case FieldTarget::BATTERY_RUNTIME:
+      if (value >= 0.0f) data.battery.runtime_minutes = value / 60.0f;  // HID reports seconds
+      break;
+    case FieldTarget::BATTERY_VOLTAGE:
+      if (positive(value)) data.battery.voltage = value;
+      break;
+    case FieldTarget::BATTERY_VOLTAGE_NOMINAL:
+      if (positive(value)) data.battery.voltage_nominal = value;
+      break;
+    case FieldTarget::BATTERY_CHARGE_LOW:
+      if (percent(value)) data.battery.charge_low = value;
+      break;
+    case FieldTarget::BATTERY_CHARGE_WARNING:
+      if (percent(value)) data.battery.charge_warning = value;
+      break;
+    case FieldTarget::BATTERY_RUNTIME_LOW:
+      if (value >= 0.0f) data.battery.runtime_low = value / 60.0f;
+      break;
+    case FieldTarget::INPUT_VOLTAGE:
+      if (value >= 0.0f) data.power.input_voltage = value;
+      break;
+    case FieldTarget::INPUT_VOLTAGE_NOMINAL:
+      if (positive(value)) data.power.input_voltage_nominal = value;
+      break;
+    case FieldTarget::INPUT_FREQUENCY:
+      if (value >= FREQUENCY_MIN_VALID && value <= FREQUENCY_MAX_VALID) data.power.frequency = value;
+      break;
+    case FieldTarget::INPUT_TRANSFER_LOW:
+      if (positive(value)) data.power.input_transfer_low = value;
+      break;
+    case FieldTarget::INPUT_TRANSFER_HIGH:
+      if (positive(value)) data.power.input_transfer_high = value;
+      break;
+    case FieldTarget::OUTPUT_VOLTAGE:
+      if (value >= 0.0f) data.power.output_voltage = value;
+      break;
+    case FieldTarget::OUTPUT_VOLTAGE_NOMINAL:
+      if (positive(value)) data.power.output_voltage_nominal = value;
+      break;
+    case FieldTarget::LOAD_PERCENT:
+      if (value >= 0.0f) data.power.load_percent = value;
+      break;
+    case FieldTarget::REALPOWER_NOMINAL:
+      if (positive(value)) data.power.realpower_nominal = value;
+      break;
+    case FieldTarget::APPARENT_POWER_NOMINAL:
+      if (positive(value)) data.power.apparent_power_nominal = value;
+      break;
+    // Delays stay in raw seconds; -1 means no countdown is running
+    case FieldTarget::DELAY_SHUTDOWN:
+      data.config.delay_shutdown = static_cast<int16_t>(raw);
+      break;
+    case FieldTarget::DELAY_START:
+      data.config.delay_start = static_cast<int16_t>(raw);
+      break;
+    case FieldTarget::DELAY_REBOOT:
+      data.config.delay_reboot = static_cast<int16_t>(raw);
+      break;
+    case FieldTarget::FLAG_AC_PRESENT: flags.ac_present = raw != 0; break;
+    case FieldTarget::FLAG_CHARGING: flags.charging = raw != 0; break;
+    case FieldTarget::FLAG_DISCHARGING: flags.discharging = raw != 0; break;
+    case FieldTarget::FLAG_BELOW_CAPACITY_LIMIT: flags.below_capacity_limit = raw != 0; break;
+    case FieldTarget::FLAG_NEED_REPLACEMENT: flags.need_replacement = raw != 0; break;
+    case FieldTarget::FLAG_OVERLOAD: flags.overload = raw != 0; break;
+    case FieldTarget::FLAG_INTERNAL_FAILURE: flags.internal_failure = raw != 0; break;
+    case FieldTarget::COUNT:
+      break;
+  }
+}
+
+void GenericHidProtocol::apply_status_flags(const StatusFlags &flags, UpsData &data) {
+  // AC Present is authoritative; Discharging is the fallback for devices without it
+  if (flags.ac_present >= 0 || flags.discharging >= 0) {
+    const bool on_battery = flags.ac_present >= 0 ? flags.ac_present == 0 : flags.discharging == 1;
+    data.power.set_status(UPS_STATUS_POWER_SOURCE, on_battery ? UPS_STATUS_OB : UPS_STATUS_OL);
+    if (on_battery) {
+      data.power.input_voltage = NAN;
+    } else if (!data.power.input_voltage_valid()) {
+      data.power.input_voltage = parent_->get_fallback_nominal_voltage();
+    }
+  }
+  // Only the bits this cycle's fields reported are replaced
+  if (flags.overload >= 0) {
+    data.power.set_status(UPS_STATUS_OVER, flags.overload == 1 ? UPS_STATUS_OVER : 0);
+    if (flags.overload == 1 && !data.power.has_status_flags()) {
+      data.power.set_status(UPS_STATUS_POWER_SOURCE, UPS_STATUS_OL);
+    }
+  }
+  if (flags.charging >= 0) {
+    data.power.set_status(UPS_STATUS_CHRG, flags.charging == 1 ? UPS_STATUS_CHRG : 0);
+  }
+  if (flags.discharging >= 0) {
+    data.power.set_status(UPS_STATUS_DISCHRG, flags.discharging == 1 ? UPS_STATUS_DISCHRG : 0);
+  }
+  if (flags.below_capacity_limit >= 0) {
+    data.power.set_status(UPS_STATUS_LB, flags.below_capacity_limit == 1 ? UPS_STATUS_LB : 0);
+  }
+  if (flags.need_replacement >= 0) {
+    data.power.set_status(UPS_STATUS_RB, flags.need_replacement == 1 ? UPS_STATUS_RB : 0);
+  }
+
+  // Rebuilt every cycle; previous suffixes must not accumulate
+  std::string battery;
+  if (flags.discharging == 1) {
+    battery = battery_status::DISCHARGING;
+  } else if (flags.charging == 1) {
+    battery = battery_status::CHARGING;
+  } else if (flags.charging == 0 || flags.discharging == 0) {
+    battery = battery_status::NORMAL;
+  }
+  if (flags.below_capacity_limit == 1) {
+    battery = battery.empty() ? battery_status::LOW : battery + " - " + battery_status::LOW;
+  }
+  if (flags.need_replacement == 1) {
+    battery = (battery.empty() ? std::string(battery_status::NORMAL) : battery) + battery_status::REPLACE_BATTERY_SUFFIX;
+  }
+  if (flags.internal_failure == 1) {
+    battery = (battery.empty() ? std::string(battery_status::FAULT) : battery) + battery_status::FAULT_SUFFIX;
+  }
+  if (!battery.empty()) {
+    data.battery.status = battery;
+  }
+}
+
 void GenericHidProtocol::enumerate_reports()
 {
-  ESP_LOGD(GEN_TAG, "Enumerating HID reports...");
+  UPS_HID_LOGD(GEN_TAG, "Enumerating HID reports...");
 
   uint8_t buffer[limits::MAX_HID_REPORT_SIZE];
   size_t buffer_len;
@@ -294,10 +671,32 @@ void GenericHidProtocol::enumerate_reports()
   // First try common report IDs
   for (uint8_t id : COMMON_REPORT_IDS)
   {
+    // Already answered (or not) in the detection round
+    if (probe_results_ && probe_results_->probed(id))
+    {
+      if (probe_results_->answered_input(id))
+      {
+        available_input_reports_.set(id);
+        report_sizes_[id] = static_cast<uint8_t>(probe_results_->length(id));
+        discovered_count++;
+      }
+      if (probe_results_->answered_feature(id))
+      {
+        available_feature_reports_.set(id);
+        if (report_sizes_[id] == 0)
+        {
+          report_sizes_[id] = static_cast<uint8_t>(probe_results_->length(id));
+        }
+        discovered_count++;
+      }
+      continue;
+    }
+
+
     // Check device connection before each report
     if (!parent_->is_connected())
     {
-      ESP_LOGD(GEN_TAG, "Device disconnected during report enumeration");
+      UPS_HID_LOGD(GEN_TAG, "Device disconnected during report enumeration");
       return;
     }
 
@@ -306,16 +705,16 @@ void GenericHidProtocol::enumerate_reports()
     esp_err_t ret = parent_->hid_get_report(HID_REPORT_TYPE_INPUT, id, buffer, &buffer_len, parent_->get_protocol_timeout());
     if (ret == ESP_OK && buffer_len > 0)
     {
-      available_input_reports_.insert(id);
-      report_sizes_[id] = buffer_len;
+      available_input_reports_.set(id);
+      report_sizes_[id] = static_cast<uint8_t>(buffer_len);
       discovered_count++;
-      ESP_LOGV(GEN_TAG, "Found Input report 0x%02X (%zu bytes)", id, buffer_len);
+      UPS_HID_LOGV(GEN_TAG, "Found Input report 0x%02X (%zu bytes)", id, buffer_len);
     }
 
     // Check connection again before Feature report
     if (!parent_->is_connected())
     {
-      ESP_LOGD(GEN_TAG, "Device disconnected during report enumeration");
+      UPS_HID_LOGD(GEN_TAG, "Device disconnected during report enumeration");
       return;
     }
 
@@ -324,13 +723,13 @@ void GenericHidProtocol::enumerate_reports()
     ret = parent_->hid_get_report(HID_REPORT_TYPE_FEATURE, id, buffer, &buffer_len, parent_->get_protocol_timeout());
     if (ret == ESP_OK && buffer_len > 0)
     {
-      available_feature_reports_.insert(id);
-      if (report_sizes_.find(id) == report_sizes_.end())
+      available_feature_reports_.set(id);
+      if (report_sizes_[id] == 0)
       {
-        report_sizes_[id] = buffer_len;
+        report_sizes_[id] = static_cast<uint8_t>(buffer_len);
       }
       discovered_count++;
-      ESP_LOGV(GEN_TAG, "Found Feature report 0x%02X (%zu bytes)", id, buffer_len);
+      UPS_HID_LOGV(GEN_TAG, "Found Feature report 0x%02X (%zu bytes)", id, buffer_len);
     }
 
     vTaskDelay(pdMS_TO_TICKS(timing::REPORT_DISCOVERY_DELAY_MS));
@@ -339,18 +738,18 @@ void GenericHidProtocol::enumerate_reports()
   // If we found enough reports, skip extended search
   if (discovered_count >= limits::MAX_DISCOVERY_ATTEMPTS)
   {
-    ESP_LOGD(GEN_TAG, "Found %d reports, skipping extended search", discovered_count);
+    UPS_HID_LOGD(GEN_TAG, "Found %d reports, skipping extended search", discovered_count);
     return;
   }
 
   // Extended search for less common report IDs
-  ESP_LOGD(GEN_TAG, "Performing extended report search...");
+  UPS_HID_LOGD(GEN_TAG, "Performing extended report search...");
   for (uint8_t id : EXTENDED_REPORT_IDS)
   {
     // Check device connection before each extended report
     if (!parent_->is_connected())
     {
-      ESP_LOGD(GEN_TAG, "Device disconnected during extended report search");
+      UPS_HID_LOGD(GEN_TAG, "Device disconnected during extended report search");
       return;
     }
 
@@ -364,40 +763,40 @@ void GenericHidProtocol::enumerate_reports()
     esp_err_t ret = parent_->hid_get_report(HID_REPORT_TYPE_INPUT, id, buffer, &buffer_len, parent_->get_protocol_timeout());
     if (ret == ESP_OK && buffer_len > 0)
     {
-      available_input_reports_.insert(id);
-      report_sizes_[id] = buffer_len;
+      available_input_reports_.set(id);
+      report_sizes_[id] = static_cast<uint8_t>(buffer_len);
       discovered_count++;
-      ESP_LOGV(GEN_TAG, "Found Input report 0x%02X (%zu bytes)", id, buffer_len);
+      UPS_HID_LOGV(GEN_TAG, "Found Input report 0x%02X (%zu bytes)", id, buffer_len);
     }
 
     vTaskDelay(pdMS_TO_TICKS(timing::REPORT_DISCOVERY_DELAY_MS));
   }
 
-  ESP_LOGD(GEN_TAG, "Enumeration complete: found %d reports", discovered_count);
+  UPS_HID_LOGD(GEN_TAG, "Enumeration complete: found %d reports", discovered_count);
 }
 
 bool GenericHidProtocol::read_report(uint8_t report_id, uint8_t *buffer, size_t &buffer_len)
 {
   // Try Input report first if available (real-time data)
-  if (available_input_reports_.count(report_id))
+  if (available_input_reports_.test(report_id))
   {
     buffer_len = limits::MAX_HID_REPORT_SIZE;
     esp_err_t ret = parent_->hid_get_report(HID_REPORT_TYPE_INPUT, report_id, buffer, &buffer_len, parent_->get_protocol_timeout());
     if (ret == ESP_OK && buffer_len > 0)
     {
-      ESP_LOGV(GEN_TAG, "Read Input report 0x%02X: %zu bytes", report_id, buffer_len);
+      UPS_HID_LOGV(GEN_TAG, "Read Input report 0x%02X: %zu bytes", report_id, buffer_len);
       return true;
     }
   }
 
   // Try Feature report (static/configuration data)
-  if (available_feature_reports_.count(report_id))
+  if (available_feature_reports_.test(report_id))
   {
     buffer_len = limits::MAX_HID_REPORT_SIZE;
     esp_err_t ret = parent_->hid_get_report(HID_REPORT_TYPE_FEATURE, report_id, buffer, &buffer_len, parent_->get_protocol_timeout());
     if (ret == ESP_OK && buffer_len > 0)
     {
-      ESP_LOGV(GEN_TAG, "Read Feature report 0x%02X: %zu bytes", report_id, buffer_len);
+      UPS_HID_LOGV(GEN_TAG, "Read Feature report 0x%02X: %zu bytes", report_id, buffer_len);
       return true;
     }
   }
@@ -417,13 +816,13 @@ void GenericHidProtocol::parse_power_summary(uint8_t *data, size_t len, UpsData
     if (battery <= 100)
     {
       ups_data.battery.level = static_cast<float>(battery);
-      ESP_LOGD(GEN_TAG, "Power summary: Battery %d%%", battery);
+      UPS_HID_LOGD(GEN_TAG, "Power summary: Battery %d%%", battery);
     }
     else if (battery <= battery::ALTERNATIVE_PERCENTAGE_SCALE && battery > 100)
     {
       // Some devices use 0-200 scale
       ups_data.battery.level = static_cast<float>(battery) / (battery::ALTERNATIVE_PERCENTAGE_SCALE / battery::MAX_LEVEL_PERCENT);
-      ESP_LOGD(GEN_TAG, "Power summary: Battery %.1f%% (scaled from %d)", ups_data.battery.level, battery);
+      UPS_HID_LOGD(GEN_TAG, "Power summary: Battery %.1f%% (scaled from %d)", ups_data.battery.level, battery);
     }
   }
 
@@ -441,14 +840,14 @@ void GenericHidProtocol::parse_power_summary(uint8_t *data, size_t len, UpsData
       {
         // Convert seconds to minutes for ESPHome sensor expectation
         ups_data.battery.runtime_minutes = static_cast<float>(runtime_raw) / 60.0f;
-        ESP_LOGD(GEN_TAG, "Power summary: Runtime %.1f minutes (from %d seconds)",
+        UPS_HID_LOGD(GEN_TAG, "Power summary: Runtime %.1f minutes (from %d seconds)",
                  ups_data.battery.runtime_minutes, runtime_raw);
       }
       else
       {
         // Assume value is already in minutes
         ups_data.battery.runtime_minutes = static_cast<float>(runtime_raw);
-        ESP_LOGD(GEN_TAG, "Power summary: Runtime %d minutes", runtime_raw);
+        UPS_HID_LOGD(GEN_TAG, "Power summary: Runtime %d minutes", runtime_raw);
       }
     }
   }
@@ -467,18 +866,23 @@ void GenericHidProtocol::parse_battery_status(uint8_t *data, size_t len, UpsData
       // Update power status
       if (status & 0x01)
       {
-        ups_data.power.status = status::ONLINE;
+        ups_data.power.set_status(UPS_STATUS_POWER_SOURCE, UPS_STATUS_OL);
         ups_data.power.input_voltage = parent_->get_fallback_nominal_voltage(); // Use configured fallback voltage
       }
       if (status & 0x02)
       {
-        ups_data.power.status = status::ON_BATTERY;
+        ups_data.power.set_status(UPS_STATUS_POWER_SOURCE, UPS_STATUS_OB);
         ups_data.power.input_voltage = NAN;
       }
 
       // Update battery status with improved logic
       // Check if battery is at 100% to determine if fully charged
       bool is_fully_charged = !std::isnan(ups_data.battery.level) && ups_data.battery.level >= 100.0f;
+      uint32_t flags = 0;
+      if ((status & 0x08) && !is_fully_charged) flags |= UPS_STATUS_CHRG;
+      if (status & 0x04) flags |= UPS_STATUS_LB;
+      if (status & 0x10) flags |= UPS_STATUS_RB;
+      ups_data.power.set_status(UPS_STATUS_CHRG | UPS_STATUS_LB | UPS_STATUS_RB, flags);
 
       if (status & 0x08)
       {
@@ -525,8 +929,8 @@ void GenericHidProtocol::parse_battery_status(uint8_t *data, size_t len, UpsData
         }
       }
 
-      ESP_LOGD(GEN_TAG, "Battery status: 0x%02X -> Power: \"%s\", Battery: \"%s\"",
-               status, ups_data.power.status.c_str(), ups_data.battery.status.c_str());
+      UPS_HID_LOGD(GEN_TAG, "Battery status: 0x%02X -> Power: 0x%03X, Battery: \"%s\"",
+               status, static_cast<unsigned>(ups_data.power.status_flags), ups_data.battery.status.c_str());
     }
   }
 
@@ -537,7 +941,7 @@ void GenericHidProtocol::parse_battery_status(uint8_t *data, size_t len, UpsData
     if (battery <= 100)
     {
       ups_data.battery.level = static_cast<float>(battery);
-      ESP_LOGD(GEN_TAG, "Battery status: Battery %d%%", battery);
+      UPS_HID_LOGD(GEN_TAG, "Battery status: Battery %d%%", battery);
     }
   }
 }
@@ -553,28 +957,40 @@ void GenericHidProtocol::parse_present_status(uint8_t *data, size_t len, UpsData
     // Validate status - 0xFF and 0x00 are often invalid/uninitialized values
     if (status == 0xFF || status == 0x00)
     {
-      ESP_LOGD(GEN_TAG, "Invalid present status: 0x%02X - ignoring", status);
+      UPS_HID_LOGD(GEN_TAG, "Invalid present status: 0x%02X - ignoring", status);
       return;
     }
 
     // Standard HID Power Device status bits - map to data structures
+    uint32_t flags = 0;
     if (status & 0x01)
     {
+      flags |= UPS_STATUS_CHRG;
       ups_data.battery.status = battery_status::CHARGING;
     }
 
     if (status & 0x02)
     {
-      ups_data.power.status = status::ON_BATTERY;
+      flags |= UPS_STATUS_OB | UPS_STATUS_DISCHRG;
       ups_data.power.input_voltage = NAN;
     }
 
     if (status & 0x04)
     {
-      ups_data.power.status = status::ONLINE;
+      flags = (flags & ~UPS_STATUS_OB) | UPS_STATUS_OL;
       ups_data.power.input_voltage = parent_->get_fallback_nominal_voltage(); // Use configured fallback voltage
     }
 
+    if (status & 0x08) flags |= UPS_STATUS_LB;
+    if (status & 0x10) flags |= UPS_STATUS_RB;
+    if (status & 0x20) flags |= UPS_STATUS_OVER;
+    if (!(flags & UPS_STATUS_POWER_SOURCE))
+    {
+      // No power source bit in this report: keep the previous one, or assume online
+      flags |= ups_data.power.has_status_flags() ? (ups_data.power.status_flags & UPS_STATUS_POWER_SOURCE) : UPS_STATUS_OL;
+    }
+    ups_data.power.status_flags = flags;
+
     if (status & 0x08)
     {
       ups_data.battery.charge_low = battery::LOW_THRESHOLD_PERCENT; // Low battery threshold
@@ -602,19 +1018,6 @@ void GenericHidProtocol::parse_present_status(uint8_t *data, size_t len, UpsData
       }
     }
 
-    if (status & 0x20)
-    {
-      // Append overload status to power status
-      if (ups_data.power.status.empty())
-      {
-        ups_data.power.status = std::string(status::ONLINE) + " - Overload";
-      }
-      else
-      {
-        ups_data.power.status += " - Overload";
-      }
-    }
-
     if (status & 0x40)
     {
       // Append fault suffix to battery status
@@ -628,8 +1031,8 @@ void GenericHidProtocol::parse_present_status(uint8_t *data, size_t len, UpsData
       }
     }
 
-    ESP_LOGD(GEN_TAG, "Present status: 0x%02X -> Power: \"%s\", Battery: \"%s\"",
-             status, ups_data.power.status.c_str(), ups_data.battery.status.c_str());
+    UPS_HID_LOGD(GEN_TAG, "Present status: 0x%02X -> Power: 0x%03X, Battery: \"%s\"",
+             status, static_cast<unsigned>(flags), ups_data.battery.status.c_str());
   }
 }
 
@@ -644,16 +1047,17 @@ void GenericHidProtocol::parse_general_status(uint8_t *data, size_t len, UpsData
     // Different vendors use different bit patterns, try common ones
     if (byte1 & 0x01)
     {
-      ups_data.power.status = status::ONLINE;
+      ups_data.power.set_status(UPS_STATUS_POWER_SOURCE, UPS_STATUS_OL);
       ups_data.power.input_voltage = parent_->get_fallback_nominal_voltage(); // Use configured fallback voltage
     }
     if (byte1 & 0x10)
     {
-      ups_data.power.status = status::ON_BATTERY;
+      ups_data.power.set_status(UPS_STATUS_POWER_SOURCE, UPS_STATUS_OB);
       ups_data.power.input_voltage = NAN;
     }
 
-    ESP_LOGV(GEN_TAG, "General status byte: 0x%02X -> Power: \"%s\"", byte1, ups_data.power.status.c_str());
+    UPS_HID_LOGV(GEN_TAG, "General status byte: 0x%02X -> Power: 0x%03X", byte1,
+             static_cast<unsigned>(ups_data.power.status_flags));
   }
 }
 
@@ -667,7 +1071,7 @@ void GenericHidProtocol::parse_voltage(uint8_t *data, size_t len, UpsData &ups_d
     // Validate against invalid values
     if (voltage_raw == 0xFFFF || voltage_raw == 0x0000)
     {
-      ESP_LOGV(GEN_TAG, "Invalid voltage value 0x%04X - ignoring", voltage_raw);
+      UPS_HID_LOGV(GEN_TAG, "Invalid voltage value 0x%04X - ignoring", voltage_raw);
       return;
     }
 
@@ -694,17 +1098,17 @@ void GenericHidProtocol::parse_voltage(uint8_t *data, size_t len, UpsData &ups_d
       if (is_input)
       {
         ups_data.power.input_voltage = voltage;
-        ESP_LOGD(GEN_TAG, "Input voltage: %.1fV (from raw 0x%04X)", voltage, voltage_raw);
+        UPS_HID_LOGD(GEN_TAG, "Input voltage: %.1fV (from raw 0x%04X)", voltage, voltage_raw);
       }
       else
       {
         ups_data.power.output_voltage = voltage;
-        ESP_LOGD(GEN_TAG, "Output voltage: %.1fV (from raw 0x%04X)", voltage, voltage_raw);
+        UPS_HID_LOGD(GEN_TAG, "Output voltage: %.1fV (from raw 0x%04X)", voltage, voltage_raw);
       }
     }
     else
     {
-      ESP_LOGV(GEN_TAG, "Voltage %.1fV out of valid range (%.1f-%.1fV) - ignoring",
+      UPS_HID_LOGV(GEN_TAG, "Voltage %.1fV out of valid range (%.1f-%.1fV) - ignoring",
                voltage, voltage::MIN_VALID_VOLTAGE, voltage::MAX_VALID_VOLTAGE);
     }
   }
@@ -723,13 +1127,13 @@ bool GenericHidProtocol::parse_unknown_report(uint8_t *data, size_t len, UpsData
       if (std::isnan(ups_data.battery.level))
       {
         ups_data.battery.level = static_cast<float>(data[i]);
-        ESP_LOGV(GEN_TAG, "Heuristic: Found possible battery level %d%% at byte %zu", data[i], i);
+        UPS_HID_LOGV(GEN_TAG, "Heuristic: Found possible battery level %d%% at byte %zu", data[i], i);
         found_data = true;
       }
       else if (std::isnan(ups_data.power.load_percent))
       {
         ups_data.power.load_percent = static_cast<float>(data[i]);
-        ESP_LOGV(GEN_TAG, "Heuristic: Found possible load %d%% at byte %zu", data[i], i);
+        UPS_HID_LOGV(GEN_TAG, "Heuristic: Found possible load %d%% at byte %zu", data[i], i);
         found_data = true;
       }
     }
@@ -750,7 +1154,7 @@ bool GenericHidProtocol::parse_unknown_report(uint8_t *data, size_t len, UpsData
       if (std::isnan(ups_data.power.input_voltage))
       {
         ups_data.power.input_voltage = voltage;
-        ESP_LOGV(GEN_TAG, "Heuristic: Found possible voltage %.1fV at bytes %zu-%zu",
+        UPS_HID_LOGV(GEN_TAG, "Heuristic: Found possible voltage %.1fV at bytes %zu-%zu",
                  voltage, i, i + 1);
         found_data = true;
       }
@@ -764,12 +1168,12 @@ void GenericHidProtocol::parse_input_sensitivity(uint8_t *data, size_t len, UpsD
 {
   if (len < 2)
   {
-    ESP_LOGV(GEN_TAG, "Input sensitivity report too short: %zu bytes", len);
+    UPS_HID_LOGV(GEN_TAG, "Input sensitivity report too short: %zu bytes", len);
     return;
   }
 
   uint8_t sensitivity_raw = data[1];
-  ESP_LOGD(GEN_TAG, "Raw input sensitivity (%s): 0x%02X (%d)", style, sensitivity_raw, sensitivity_raw);
+  UPS_HID_LOGD(GEN_TAG, "Raw input sensitivity (%s): 0x%02X (%d)", style, sensitivity_raw, sensitivity_raw);
 
   // DYNAMIC GENERIC SENSITIVITY MAPPING
   switch (sensitivity_raw)
@@ -875,7 +1279,7 @@ bool GenericHidProtocol::start_battery_test_quick()
     uint8_t report_id = test_report_ids[i];
     uint8_t test_data[2] = {report_id, test::COMMAND_QUICK}; // Command value 1 = Quick test
 
-    ESP_LOGD(GEN_TAG, "Trying quick battery test with report ID 0x%02X", report_id);
+    UPS_HID_LOGD(GEN_TAG, "Trying quick battery test with report ID 0x%02X", report_id);
     esp_err_t ret = parent_->hid_set_report(0x03, report_id, test_data, sizeof(test_data), parent_->get_protocol_timeout());
 
     if (ret == ESP_OK)
@@ -885,7 +1289,7 @@ bool GenericHidProtocol::start_battery_test_quick()
     }
     else
     {
-      ESP_LOGD(GEN_TAG, "Failed with report ID 0x%02X: %s", report_id, esp_err_to_name(ret));
+      UPS_HID_LOGD(GEN_TAG, "Failed with report ID 0x%02X: %s", report_id, esp_err_to_name(ret));
     }
   }
 
@@ -905,7 +1309,7 @@ bool GenericHidProtocol::start_battery_test_deep()
     uint8_t report_id = test_report_ids[i];
     uint8_t test_data[2] = {report_id, test::COMMAND_DEEP}; // Command value 2 = Deep test
 
-    ESP_LOGD(GEN_TAG, "Trying deep battery test with report ID 0x%02X", report_id);
+    UPS_HID_LOGD(GEN_TAG, "Trying deep battery test with report ID 0x%02X", report_id);
     esp_err_t ret = parent_->hid_set_report(0x03, report_id, test_data, sizeof(test_data), parent_->get_protocol_timeout());
 
     if (ret == ESP_OK)
@@ -915,7 +1319,7 @@ bool GenericHidProtocol::start_battery_test_deep()
     }
     else
     {
-      ESP_LOGD(GEN_TAG, "Failed with report ID 0x%02X: %s", report_id, esp_err_to_name(ret));
+      UPS_HID_LOGD(GEN_TAG, "Failed with report ID 0x%02X: %s", report_id, esp_err_to_name(ret));
     }
   }
 
@@ -935,7 +1339,7 @@ bool GenericHidProtocol::stop_battery_test()
     uint8_t report_id = test_report_ids[i];
     uint8_t test_data[2] = {report_id, test::COMMAND_ABORT}; // Command value 3 = Abort test
 
-    ESP_LOGD(GEN_TAG, "Trying battery test stop with report ID 0x%02X", report_id);
+    UPS_HID_LOGD(GEN_TAG, "Trying battery test stop with report ID 0x%02X", report_id);
     esp_err_t ret = parent_->hid_set_report(0x03, report_id, test_data, sizeof(test_data), parent_->get_protocol_timeout());
 
     if (ret == ESP_OK)
@@ -945,7 +1349,7 @@ bool GenericHidProtocol::stop_battery_test()
     }
     else
     {
-      ESP_LOGD(GEN_TAG, "Failed with report ID 0x%02X: %s", report_id, esp_err_to_name(ret));
+      UPS_HID_LOGD(GEN_TAG, "Failed with report ID 0x%02X: %s", report_id, esp_err_to_name(ret));
     }
   }
 
@@ -965,7 +1369,7 @@ bool GenericHidProtocol::start_ups_test()
     uint8_t report_id = test_report_ids[i];
     uint8_t test_data[2] = {report_id, 1}; // Command value 1 = Start test
 
-    ESP_LOGD(GEN_TAG, "Trying UPS test with report ID 0x%02X", report_id);
+    UPS_HID_LOGD(GEN_TAG, "Trying UPS test with report ID 0x%02X", report_id);
     esp_err_t ret = parent_->hid_set_report(0x03, report_id, test_data, sizeof(test_data), parent_->get_protocol_timeout());
 
     if (ret == ESP_OK)
@@ -975,7 +1379,7 @@ bool GenericHidProtocol::start_ups_test()
     }
     else
     {
-      ESP_LOGD(GEN_TAG, "Failed with report ID 0x%02X: %s", report_id, esp_err_to_name(ret));
+      UPS_HID_LOGD(GEN_TAG, "Failed with report ID 0x%02X: %s", report_id, esp_err_to_name(ret));
     }
   }
 
@@ -995,7 +1399,7 @@ bool GenericHidProtocol::stop_ups_test()
     uint8_t report_id = test_report_ids[i];
     uint8_t test_data[2] = {report_id, 0}; // Command value 0 = Stop test
 
-    ESP_LOGD(GEN_TAG, "Trying UPS test stop with report ID 0x%02X", report_id);
+    UPS_HID_LOGD(GEN_TAG, "Trying UPS test stop with report ID 0x%02X", report_id);
     esp_err_t ret = parent_->hid_set_report(0x03, report_id, test_data, sizeof(test_data), parent_->get_protocol_timeout());
 
     if (ret == ESP_OK)
@@ -1005,7 +1409,7 @@ bool GenericHidProtocol::stop_ups_test()
     }
     else
     {
-      ESP_LOGD(GEN_TAG, "Failed with report ID 0x%02X: %s", report_id, esp_err_to_name(ret));
+      UPS_HID_LOGD(GEN_TAG, "Failed with report ID 0x%02X: %s", report_id, esp_err_to_name(ret));
     }
   }
 
@@ -1040,13 +1444,13 @@ void GenericHidProtocol::read_frequency_data(UpsData &data)
       if (!std::isnan(frequency_value))
       {
         data.power.frequency = frequency_value;
-        ESP_LOGD(GEN_TAG, "Found frequency %.1f Hz in report 0x%02X", frequency_value, report_id);
+        UPS_HID_LOGD(GEN_TAG, "Found frequency %.1f Hz in report 0x%02X", frequency_value, report_id);
         return;
       }
     }
   }
 
-  ESP_LOGV(GEN_TAG, "Frequency data not available from any HID report");
+  UPS_HID_LOGV(GEN_TAG, "Frequency data not available from any HID report");
 }
 
 float GenericHidProtocol::parse_frequency_from_report(uint8_t *data, size_t len)
@@ -1065,7 +1469,7 @@ float GenericHidProtocol::parse_frequency_from_report(uint8_t *data, size_t len)
     uint8_t freq_byte = data[1];
     if (freq_byte >= static_cast<uint8_t>(FREQUENCY_MIN_VALID) && freq_byte <= static_cast<uint8_t>(FREQUENCY_MAX_VALID))
     {
-      ESP_LOGD(GEN_TAG, "Found frequency %d Hz (single byte)", freq_byte);
+      UPS_HID_LOGD(GEN_TAG, "Found frequency %d Hz (single byte)", freq_byte);
       return static_cast<float>(freq_byte);
     }
   }
@@ -1076,7 +1480,7 @@ float GenericHidProtocol::parse_frequency_from_report(uint8_t *data, size_t len)
     uint8_t freq_byte = data[i];
     if ((freq_byte == 50 || freq_byte == 60) && freq_byte <= static_cast<uint8_t>(FREQUENCY_MAX_VALID))
     {
-      ESP_LOGD(GEN_TAG, "Found standard frequency %d Hz at byte %zu", freq_byte, i);
+      UPS_HID_LOGD(GEN_TAG, "Found standard frequency %d Hz at byte %zu", freq_byte, i);
       return static_cast<float>(freq_byte);
     }
   }
@@ -1087,7 +1491,7 @@ float GenericHidProtocol::parse_frequency_from_report(uint8_t *data, size_t len)
     uint16_t freq_word = data[i] | (data[i + 1] << 8);
     if (freq_word >= static_cast<uint16_t>(FREQUENCY_MIN_VALID) && freq_word <= static_cast<uint16_t>(FREQUENCY_MAX_VALID))
     {
-      ESP_LOGD(GEN_TAG, "Found frequency %d Hz (16-bit LE) at bytes %zu-%zu", freq_word, i, i + 1);
+      UPS_HID_LOGD(GEN_TAG, "Found frequency %d Hz (16-bit LE) at bytes %zu-%zu", freq_word, i, i + 1);
       return static_cast<float>(freq_word);
     }
   }
@@ -1098,7 +1502,7 @@ float GenericHidProtocol::parse_frequency_from_report(uint8_t *data, size_t len)
     uint16_t freq_word = (data[i] << 8) | data[i + 1];
     if (freq_word >= static_cast<uint16_t>(FREQUENCY_MIN_VALID) && freq_word <= static_cast<uint16_t>(FREQUENCY_MAX_VALID))
     {
-      ESP_LOGD(GEN_TAG, "Found frequency %d Hz (16-bit BE) at bytes %zu-%zu", freq_word, i, i + 1);
+      UPS_HID_LOGD(GEN_TAG, "Found frequency %d Hz (16-bit BE) at bytes %zu-%zu", freq_word, i, i + 1);
       return static_cast<float>(freq_word);
     }
   }
@@ -1110,7 +1514,7 @@ float GenericHidProtocol::parse_frequency_from_report(uint8_t *data, size_t len)
     float freq_value = static_cast<float>(freq_scaled) / 10.0f;
     if (freq_value >= FREQUENCY_MIN_VALID && freq_value <= FREQUENCY_MAX_VALID)
     {
-      ESP_LOGD(GEN_TAG, "Found scaled frequency %.1f Hz (0.1x) at bytes %zu-%zu", freq_value, i, i + 1);
+      UPS_HID_LOGD(GEN_TAG, "Found scaled frequency %.1f Hz (0.1x) at bytes %zu-%zu", freq_value, i, i + 1);
       return freq_value;
     }
   }
@@ -1122,7 +1526,7 @@ float GenericHidProtocol::parse_frequency_from_report(uint8_t *data, size_t len)
     float freq_value = static_cast<float>(freq_scaled) / 100.0f;
     if (freq_value >= FREQUENCY_MIN_VALID && freq_value <= FREQUENCY_MAX_VALID)
     {
-      ESP_LOGD(GEN_TAG, "Found scaled frequency %.1f Hz (0.01x) at bytes %zu-%zu", freq_value, i, i + 1);
+      UPS_HID_LOGD(GEN_TAG, "Found scaled frequency %.1f Hz (0.01x) at bytes %zu-%zu", freq_value, i, i + 1);
       return freq_value;
     }
   }
@@ -1155,7 +1559,7 @@ bool GenericHidProtocol::set_shutdown_delay(int seconds)
     delay_data[0] = seconds & 0xFF;        // Low byte
     delay_data[1] = (seconds >> 8) & 0xFF; // High byte
 
-    ESP_LOGD(TAG, "Trying shutdown delay on report 0x%02X: %d seconds", report_id, seconds);
+    UPS_HID_LOGD(TAG, "Trying shutdown delay on report 0x%02X: %d seconds", report_id, seconds);
 
     esp_err_t ret = parent_->hid_set_report(HID_REPORT_TYPE_FEATURE, report_id,
                                             delay_data, 2, parent_->get_protocol_timeout());
@@ -1199,7 +1603,7 @@ bool GenericHidProtocol::set_start_delay(int seconds)
     delay_data[0] = seconds & 0xFF;        // Low byte
     delay_data[1] = (seconds >> 8) & 0xFF; // High byte
 
-    ESP_LOGD(TAG, "Trying start delay on report 0x%02X: %d seconds", report_id, seconds);
+    UPS_HID_LOGD(TAG, "Trying start delay on report 0x%02X: %d seconds", report_id, seconds);
 
     esp_err_t ret = parent_->hid_set_report(HID_REPORT_TYPE_FEATURE, report_id,
                                             delay_data, 2, parent_->get_protocol_timeout());
@@ -1300,7 +1704,7 @@ void GenericHidProtocol::read_delay_configuration(UpsData &data)
       if (value > 0)
       {
         *delay.target = value;
-        ESP_LOGD(GEN_TAG, "Found %s delay: %d seconds (report 0x%02X)", delay.name, value, delay.report_id);
+        UPS_HID_LOGD(GEN_TAG, "Found %s delay: %d seconds (report 0x%02X)", delay.name, value, delay.report_id);
       }
     }
   }
@@ -1308,12 +1712,12 @@ void GenericHidProtocol::read_delay_configuration(UpsData &data)
   // Log results
   if (data.config.delay_shutdown > 0 || data.config.delay_start > 0 || data.config.delay_reboot > 0)
   {
-    ESP_LOGD(GEN_TAG, "Delay configuration - Shutdown: %ds, Start: %ds, Reboot: %ds",
+    UPS_HID_LOGD(GEN_TAG, "Delay configuration - Shutdown: %ds, Start: %ds, Reboot: %ds",
              data.config.delay_shutdown, data.config.delay_start, data.config.delay_reboot);
   }
   else
   {
-    ESP_LOGV(GEN_TAG, "Delay configuration not available from HID reports");
+    UPS_HID_LOGV(GEN_TAG, "Delay configuration not available from HID reports");
   }
 }
 
@@ -1346,7 +1750,7 @@ void GenericHidProtocol::read_load_percentage(UpsData &data)
       // Validate against invalid values
       if (load_raw == 0xFF || load_raw == 0x00)
       {
-        ESP_LOGV(GEN_TAG, "Invalid load value 0x%02X in report 0x%02X - ignoring",
+        UPS_HID_LOGV(GEN_TAG, "Invalid load value 0x%02X in report 0x%02X - ignoring",
                  load_raw, load_report.report_id);
         continue;
       }
@@ -1357,7 +1761,7 @@ void GenericHidProtocol::read_load_percentage(UpsData &data)
       if (load_raw <= 100)
       {
         load_percent = static_cast<float>(load_raw);
-        ESP_LOGD(GEN_TAG, "Load: %.0f%% (%s report 0x%02X, byte %d)",
+        UPS_HID_LOGD(GEN_TAG, "Load: %.0f%% (%s report 0x%02X, byte %d)",
                  load_percent, load_report.name, load_report.report_id, load_report.byte_offset);
       }
       // Alternative scale (0-200 mapped to 0-100)
@@ -1368,18 +1772,18 @@ void GenericHidProtocol::read_load_percentage(UpsData &data)
         // Validate scaled result is reasonable
         if (load_percent <= battery::MAX_LEVEL_PERCENT)
         {
-          ESP_LOGD(GEN_TAG, "Load: %.1f%% (scaled from %d on %s report 0x%02X)",
+          UPS_HID_LOGD(GEN_TAG, "Load: %.1f%% (scaled from %d on %s report 0x%02X)",
                    load_percent, load_raw, load_report.name, load_report.report_id);
         }
         else
         {
-          ESP_LOGV(GEN_TAG, "Scaled load result %.1f%% exceeds maximum - ignoring", load_percent);
+          UPS_HID_LOGV(GEN_TAG, "Scaled load result %.1f%% exceeds maximum - ignoring", load_percent);
           continue;
         }
       }
       else
       {
-        ESP_LOGV(GEN_TAG, "Load value %d out of valid range in report 0x%02X",
+        UPS_HID_LOGV(GEN_TAG, "Load value %d out of valid range in report 0x%02X",
                  load_raw, load_report.report_id);
         continue;
       }
@@ -1405,7 +1809,7 @@ void GenericHidProtocol::read_load_percentage(UpsData &data)
       if (load_16 > 0 && load_16 <= 100)
       {
         data.power.load_percent = static_cast<float>(load_16);
-        ESP_LOGD(GEN_TAG, "Load: %.0f%% (16-bit from %s report 0x%02X)",
+        UPS_HID_LOGD(GEN_TAG, "Load: %.0f%% (16-bit from %s report 0x%02X)",
                  data.power.load_percent, load_report.name, load_report.report_id);
         return;
       }
@@ -1415,7 +1819,7 @@ void GenericHidProtocol::read_load_percentage(UpsData &data)
         if (load_percent <= battery::MAX_LEVEL_PERCENT)
         {
           data.power.load_percent = load_percent;
-          ESP_LOGD(GEN_TAG, "Load: %.1f%% (16-bit scaled from %d on %s report 0x%02X)",
+          UPS_HID_LOGD(GEN_TAG, "Load: %.1f%% (16-bit scaled from %d on %s report 0x%02X)",
                    load_percent, load_16, load_report.name, load_report.report_id);
           return;
         }
@@ -1423,7 +1827,7 @@ void GenericHidProtocol::read_load_percentage(UpsData &data)
     }
   }
 
-  ESP_LOGV(GEN_TAG, "Load percentage not available from any HID reports");
+  UPS_HID_LOGV(GEN_TAG, "Load percentage not available from any HID reports");
 }
 
 // Read beeper status from UPS
@@ -1449,19 +1853,19 @@ void GenericHidProtocol::read_beeper_status(UpsData &data)
       if (status_byte == 0x01 || status_byte == beeper::CONTROL_DISABLE)
       {
         data.config.beeper_status = "disabled";
-        ESP_LOGD(GEN_TAG, "Beeper status: disabled (report 0x%02X, value 0x%02X)", report_id, status_byte);
+        UPS_HID_LOGD(GEN_TAG, "Beeper status: disabled (report 0x%02X, value 0x%02X)", report_id, status_byte);
         return;
       }
       else if (status_byte == 0x02 || status_byte == beeper::CONTROL_ENABLE)
       {
         data.config.beeper_status = "enabled";
-        ESP_LOGD(GEN_TAG, "Beeper status: enabled (report 0x%02X, value 0x%02X)", report_id, status_byte);
+        UPS_HID_LOGD(GEN_TAG, "Beeper status: enabled (report 0x%02X, value 0x%02X)", report_id, status_byte);
         return;
       }
       else if (status_byte == 0x03 || status_byte == beeper::CONTROL_MUTE)
       {
         data.config.beeper_status = "muted";
-        ESP_LOGD(GEN_TAG, "Beeper status: muted (report 0x%02X, value 0x%02X)", report_id, status_byte);
+        UPS_HID_LOGD(GEN_TAG, "Beeper status: muted (report 0x%02X, value 0x%02X)", report_id, status_byte);
         return;
       }
 
@@ -1476,13 +1880,13 @@ void GenericHidProtocol::read_beeper_status(UpsData &data)
           if (beeper_byte & 0x01)
           {
             data.config.beeper_status = "enabled";
-            ESP_LOGD(GEN_TAG, "Beeper status: enabled (CyberPower power summary bit)");
+            UPS_HID_LOGD(GEN_TAG, "Beeper status: enabled (CyberPower power summary bit)");
             return;
           }
           else if (beeper_byte == 0x00)
           {
             data.config.beeper_status = "disabled";
-            ESP_LOGD(GEN_TAG, "Beeper status: disabled (CyberPower power summary bit)");
+            UPS_HID_LOGD(GEN_TAG, "Beeper status: disabled (CyberPower power summary bit)");
             return;
           }
         }
@@ -1491,7 +1895,7 @@ void GenericHidProtocol::read_beeper_status(UpsData &data)
   }
 
   // If we couldn't determine beeper status, leave it as unknown
-  ESP_LOGV(GEN_TAG, "Beeper status not available from HID reports");
+  UPS_HID_LOGV(GEN_TAG, "Beeper status not available from HID reports");
 }
 
 }  // namespace ups_hid
@@ -3,8 +3,8 @@
 #include "ups_hid.h"
 #include "data_composite.h"
 #include "data_device.h"
-#include <set>
-#include <map>
+#include "hid_descriptor.h"
+#include <bitset>
 
 namespace esphome {
 namespace ups_hid {
@@ -15,9 +15,11 @@ namespace ups_hid {
  * Provides fallback support for unknown UPS vendors by attempting to
  * discover and parse common HID Power Device report IDs.
  * 
- * This protocol uses a discovery-based approach, testing standard report IDs
- * that are commonly used across different UPS manufacturers based on NUT
- * (Network UPS Tools) analysis.
+ * When the device supplies its HID report descriptor, every Power Device and
+ * Battery System usage is located from it and decoded with the declared
+ * offsets, ranges and unit exponents. Devices without a readable descriptor
+ * fall back to probing standard report IDs commonly used across UPS
+ * manufacturers based on NUT (Network UPS Tools) analysis.
  */
 class GenericHidProtocol : public UpsProtocolBase {
 public:
@@ -31,11 +33,18 @@ public:
     std::string get_protocol_name() const override { 
         return "Generic HID"; 
     }
+    size_t get_memory_usage() const override;
 
     // Core protocol interface
     bool detect() override;
+    size_t get_probe_report_ids(const uint8_t **report_ids) const override;
+    // A descriptor declaring Power Device usages outranks any probe count
+    int score_probe(const ProbeResults &results) const override;
+    void use_probe_results(const ProbeResults &results) override;
     bool initialize() override;
     bool read_data(UpsData &data) override;
+    bool save_discovery(ProtocolDiscovery &discovery) const override;
+    bool initialize_from_discovery(const ProtocolDiscovery &discovery) override;
     
     // Delay configuration methods
     bool set_shutdown_delay(int seconds) override;
@@ -78,10 +87,85 @@ public:
     bool beeper_test() override { return false; }
 
 private:
-    // Report discovery state
-    std::set<uint8_t> available_input_reports_;
-    std::set<uint8_t> available_feature_reports_;
-    std::map<uint8_t, size_t> report_sizes_;
+    // UpsData value a descriptor field is decoded into
+    enum class FieldTarget : uint8_t {
+        BATTERY_LEVEL,
+        BATTERY_RUNTIME,
+        BATTERY_VOLTAGE,
+        BATTERY_VOLTAGE_NOMINAL,
+        BATTERY_CHARGE_LOW,
+        BATTERY_CHARGE_WARNING,
+        BATTERY_RUNTIME_LOW,
+        INPUT_VOLTAGE,
+        INPUT_VOLTAGE_NOMINAL,
+        INPUT_FREQUENCY,
+        INPUT_TRANSFER_LOW,
+        INPUT_TRANSFER_HIGH,
+        OUTPUT_VOLTAGE,
+        OUTPUT_VOLTAGE_NOMINAL,
+        LOAD_PERCENT,
+        REALPOWER_NOMINAL,
+        APPARENT_POWER_NOMINAL,
+        DELAY_SHUTDOWN,
+        DELAY_START,
+        DELAY_REBOOT,
+        FLAG_AC_PRESENT,
+        FLAG_CHARGING,
+        FLAG_DISCHARGING,
+        FLAG_BELOW_CAPACITY_LIMIT,
+        FLAG_NEED_REPLACEMENT,
+        FLAG_OVERLOAD,
+        FLAG_INTERNAL_FAILURE,
+        COUNT
+    };
+
+    // Copied out of the descriptor so the map outlives it
+    struct FieldBinding {
+        HidField field;
+        FieldTarget target;
+    };
+
+    // Reports holding at least one bound field, each read once per cycle
+    struct MappedReport {
+        uint8_t report_type;
+        uint8_t report_id;
+        uint16_t first_binding;
+        uint16_t binding_count;
+    };
+
+    // Present status bits: -1 unknown, else 0/1
+    struct StatusFlags {
+        int8_t ac_present{-1};
+        int8_t charging{-1};
+        int8_t discharging{-1};
+        int8_t below_capacity_limit{-1};
+        int8_t need_replacement{-1};
+        int8_t overload{-1};
+        int8_t internal_failure{-1};
+    };
+
+    void clear_discovery();
+    bool build_field_map(const HidReportDescriptor& descriptor);
+    static bool classify_field(const HidReportDescriptor& descriptor, const HidField& field,
+                               FieldTarget& target);
+    bool read_mapped_reports(UpsData& data);
+    bool read_probed_reports(UpsData& data);
+    void apply_field(FieldTarget target, float value, int32_t raw, UpsData& data, StatusFlags& flags);
+    void apply_status_flags(const StatusFlags& flags, UpsData& data);
+
+    // Report discovery state, indexed by report ID like ProbeResults so the
+    // per-poll lookups in read_report() are a bit test; a size of 0 is unknown
+    std::bitset<256> available_input_reports_;
+    std::bitset<256> available_feature_reports_;
+    uint8_t report_sizes_[256]{};
+
+    // Answers from the factory's probe round, consumed by enumerate_reports()
+    std::unique_ptr<ProbeResults> probe_results_;
+
+    // Descriptor-driven field map; empty when probing
+    std::vector<FieldBinding> field_bindings_;
+    std::vector<MappedReport> mapped_reports_;
+    bool descriptor_uses_report_ids_{false};
 };
 
 } // namespace ups_hid  
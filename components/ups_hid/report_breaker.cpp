@@ -0,0 +1,98 @@
+#include "report_breaker.h"
+#include "esphome/core/log.h"
+#include <algorithm>
+
+namespace esphome {
+namespace ups_hid {
+
+static const char *const BREAKER_TAG = "ups_hid.breaker";
+
+bool ReportCircuitBreaker::allow(uint8_t report_type, uint8_t report_id, uint32_t now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry *entry = find(report_type, report_id);
+  if (!entry || entry->open_until == 0) {
+    return true;
+  }
+  if (is_open(*entry, now)) {
+    short_circuits_++;
+    return false;
+  }
+  entry->open_until = 0;
+  entry->trial = true;
+  return true;
+}
+
+void ReportCircuitBreaker::record(uint8_t report_type, uint8_t report_id, esp_err_t result, uint32_t now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry *entry = find(report_type, report_id);
+
+  if (result != ESP_ERR_TIMEOUT) {
+    // The device answered, even if only to reject the report
+    if (entry) {
+      if (entry->trips > 0) {
+        ESP_LOGI(BREAKER_TAG, "Report 0x%02X (type %u) answers again", report_id, report_type);
+      }
+      *entry = Entry{};
+    }
+    return;
+  }
+
+  if (!entry) {
+    // Take a free slot, else evict the closed entry with the fewest timeouts
+    for (auto &candidate : entries_) {
+      if (!candidate.used) {
+        entry = &candidate;
+        break;
+      }
+      if (!is_open(candidate, now) && (!entry || candidate.timeouts < entry->timeouts)) {
+        entry = &candidate;
+      }
+    }
+    if (!entry) {
+      return;  // Every slot quarantined; nothing more to learn
+    }
+    *entry = Entry{};
+    entry->used = true;
+    entry->report_type = report_type;
+    entry->report_id = report_id;
+  }
+
+  entry->timeouts++;
+  if (!entry->trial && entry->timeouts < limits::REPORT_BREAKER_THRESHOLD) {
+    return;
+  }
+
+  const uint32_t backoff = std::min(timing::REPORT_BREAKER_BASE_BACKOFF_MS << std::min<uint8_t>(entry->trips, 6),
+                                    timing::REPORT_BREAKER_MAX_BACKOFF_MS);
+  entry->open_until = (now + backoff) | 1;  // 0 means closed
+  entry->trips = std::min<uint8_t>(entry->trips + 1, UINT8_MAX);
+  entry->timeouts = 0;
+  entry->trial = false;
+  ESP_LOGW(BREAKER_TAG, "Report 0x%02X (type %u) keeps timing out, skipping it for %u s", report_id, report_type,
+           backoff / 1000);
+}
+
+void ReportCircuitBreaker::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &entry : entries_) {
+    entry = Entry{};
+  }
+}
+
+size_t ReportCircuitBreaker::open_count(uint32_t now) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::count_if(std::begin(entries_), std::end(entries_),
+                       [now](const Entry &entry) { return entry.used && is_open(entry, now); });
+}
+
+ReportCircuitBreaker::Entry *ReportCircuitBreaker::find(uint8_t report_type, uint8_t report_id) {
+  for (auto &entry : entries_) {
+    if (entry.used && entry.report_type == report_type && entry.report_id == report_id) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace ups_hid
+}  // namespace esphome
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "constants_ups.h"
+#include "esp_err.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace esphome {
+namespace ups_hid {
+
+/**
+ * Per-report circuit breaker
+ *
+ * Many UPSes never answer some report IDs, and every such read waits out
+ * the full timeout. After limits::REPORT_BREAKER_THRESHOLD consecutive
+ * timeouts a (report type, report ID) pair is quarantined: requests for it
+ * fail at once with ESP_ERR_TIMEOUT until the backoff expires. Then one
+ * trial read either closes the breaker or reopens it for twice as long, up
+ * to timing::REPORT_BREAKER_MAX_BACKOFF_MS.
+ *
+ * Only timeouts count. A rejected report (ESP_FAIL) answers quickly and is
+ * remembered by the report cache instead.
+ */
+class ReportCircuitBreaker {
+ public:
+  // False while the report is quarantined; the caller must not send it
+  bool allow(uint8_t report_type, uint8_t report_id, uint32_t now);
+  void record(uint8_t report_type, uint8_t report_id, esp_err_t result, uint32_t now);
+  // Forget every report, e.g. when a different device may be attached
+  void clear();
+
+  size_t open_count(uint32_t now) const;
+  uint32_t short_circuits() const { return short_circuits_; }
+
+ protected:
+  struct Entry {
+    uint8_t report_type{0};
+    uint8_t report_id{0};
+    uint8_t timeouts{0};     // Consecutive; any answer frees the entry
+    uint8_t trips{0};        // Times opened, sets the backoff
+    bool used{false};
+    bool trial{false};       // Backoff expired, the next read decides
+    uint32_t open_until{0};  // millis() when the quarantine ends; 0 = closed
+  };
+
+  Entry *find(uint8_t report_type, uint8_t report_id);
+  static bool is_open(const Entry &entry, uint32_t now) {
+    return entry.open_until != 0 && static_cast<int32_t>(entry.open_until - now) > 0;
+  }
+
+  mutable std::mutex mutex_;
+  Entry entries_[limits::REPORT_BREAKER_SIZE];
+  uint32_t short_circuits_{0};
+};
+
+}  // namespace ups_hid
+}  // namespace esphome
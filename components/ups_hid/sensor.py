@@ -2,6 +2,8 @@ import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome.components import sensor
 from esphome.const import (
+    CONF_ENTITY_CATEGORY,
+    CONF_STATE_CLASS,
     CONF_TYPE,
     DEVICE_CLASS_BATTERY,
     DEVICE_CLASS_VOLTAGE,
@@ -15,6 +17,11 @@ from esphome.const import (
     UNIT_HERTZ,
     UNIT_WATT,
     UNIT_SECOND,
+    UNIT_MILLISECOND,
+    UNIT_BYTES,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_TOTAL_INCREASING,
+    STATE_CLASS_MEASUREMENT,
 )
 
 
@@ -24,6 +31,10 @@ DEPENDENCIES = ["ups_hid"]
 
 UpsHidSensor = ups_hid_ns.class_("UpsHidSensor", sensor.Sensor, cg.Component)
 
+CONF_DEADBAND = "deadband"
+CONF_MIN_INTERVAL = "min_interval"
+CONF_MAX_INTERVAL = "max_interval"
+
 SENSOR_TYPES = {
     "battery_level": {
         "unit": UNIT_PERCENT,
@@ -132,15 +143,116 @@ SENSOR_TYPES = {
     },
 }
 
+# Instrumentation; registering any of these turns instrumentation on
+DIAGNOSTIC_SENSOR_TYPES = {
+    "poll_duration": {
+        "unit": UNIT_MILLISECOND,
+        "device_class": DEVICE_CLASS_DURATION,
+        "state_class": STATE_CLASS_MEASUREMENT,
+        "accuracy_decimals": 1,
+    },
+    "poll_duration_max": {
+        "unit": UNIT_MILLISECOND,
+        "device_class": DEVICE_CLASS_DURATION,
+        "state_class": STATE_CLASS_MEASUREMENT,
+        "accuracy_decimals": 1,
+    },
+    "protocol_lock_wait": {
+        "unit": UNIT_MILLISECOND,
+        "device_class": DEVICE_CLASS_DURATION,
+        "state_class": STATE_CLASS_MEASUREMENT,
+        "accuracy_decimals": 2,
+    },
+    # Scheduling delay of the acquisition task; compare core and priority settings
+    "acquisition_wake_latency": {
+        "unit": UNIT_MILLISECOND,
+        "device_class": DEVICE_CLASS_DURATION,
+        "state_class": STATE_CLASS_MEASUREMENT,
+        "accuracy_decimals": 3,
+    },
+    "usb_transfers": {
+        "state_class": STATE_CLASS_TOTAL_INCREASING,
+        "accuracy_decimals": 0,
+    },
+    "usb_timeouts": {
+        "state_class": STATE_CLASS_TOTAL_INCREASING,
+        "accuracy_decimals": 0,
+    },
+    "usb_errors": {
+        "state_class": STATE_CLASS_TOTAL_INCREASING,
+        "accuracy_decimals": 0,
+    },
+    "usb_bytes": {
+        "unit": UNIT_BYTES,
+        "state_class": STATE_CLASS_TOTAL_INCREASING,
+        "accuracy_decimals": 0,
+    },
+    # Memory budget: component footprint, and the least stack each task has had left
+    "memory_usage": {
+        "unit": UNIT_BYTES,
+        "state_class": STATE_CLASS_MEASUREMENT,
+        "accuracy_decimals": 0,
+    },
+    "memory_usage_peak": {
+        "unit": UNIT_BYTES,
+        "state_class": STATE_CLASS_MEASUREMENT,
+        "accuracy_decimals": 0,
+    },
+    "acquisition_stack_free": {
+        "unit": UNIT_BYTES,
+        "state_class": STATE_CLASS_MEASUREMENT,
+        "accuracy_decimals": 0,
+    },
+    "usb_stack_free": {
+        "unit": UNIT_BYTES,
+        "state_class": STATE_CLASS_MEASUREMENT,
+        "accuracy_decimals": 0,
+    },
+}
+
+
+def validate_publish_intervals(config):
+    """A heartbeat shorter than the minimum spacing could never fire."""
+    min_interval = config.get(CONF_MIN_INTERVAL)
+    max_interval = config.get(CONF_MAX_INTERVAL)
+    if (
+        min_interval is not None
+        and max_interval is not None
+        and max_interval.total_milliseconds > 0
+        and max_interval.total_milliseconds < min_interval.total_milliseconds
+    ):
+        raise cv.Invalid(f"{CONF_MAX_INTERVAL} must not be shorter than {CONF_MIN_INTERVAL}")
+    return config
 
-CONFIG_SCHEMA = sensor.sensor_schema(
-    UpsHidSensor,
-    accuracy_decimals=1,
-).extend(
-    {
-        cv.GenerateID(CONF_UPS_HID_ID): cv.use_id(UpsHidComponent),
-        cv.Required(CONF_TYPE): cv.one_of(*SENSOR_TYPES, lower=True),
-    }
+
+def diagnostic_defaults(config):
+    """Diagnostic types default to the diagnostic entity category and their state class."""
+    if isinstance(config, dict):
+        sensor_type = str(config.get(CONF_TYPE, "")).lower()
+        if sensor_type in DIAGNOSTIC_SENSOR_TYPES:
+            config = dict(config)
+            config.setdefault(CONF_ENTITY_CATEGORY, ENTITY_CATEGORY_DIAGNOSTIC)
+            config.setdefault(CONF_STATE_CLASS, DIAGNOSTIC_SENSOR_TYPES[sensor_type]["state_class"])
+    return config
+
+
+CONFIG_SCHEMA = cv.All(
+    diagnostic_defaults,
+    sensor.sensor_schema(
+        UpsHidSensor,
+        accuracy_decimals=1,
+    ).extend(
+        {
+            cv.GenerateID(CONF_UPS_HID_ID): cv.use_id(UpsHidComponent),
+            cv.Required(CONF_TYPE): cv.one_of(*SENSOR_TYPES, *DIAGNOSTIC_SENSOR_TYPES, lower=True),
+            # Publish only changes of at least this much (0 = any change)
+            cv.Optional(CONF_DEADBAND, default=0.0): cv.positive_float,
+            # Minimum spacing between publishes, and heartbeat for unchanged values
+            cv.Optional(CONF_MIN_INTERVAL): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_MAX_INTERVAL): cv.positive_time_period_milliseconds,
+        }
+    ),
+    validate_publish_intervals,
 )
 
 
@@ -151,12 +263,16 @@ async def to_code(config):
 
     sensor_type = config[CONF_TYPE]
     cg.add(var.set_sensor_type(sensor_type))
+    cg.add(var.set_deadband(config[CONF_DEADBAND]))
+    if CONF_MIN_INTERVAL in config:
+        cg.add(var.set_min_interval(config[CONF_MIN_INTERVAL]))
+    if CONF_MAX_INTERVAL in config:
+        cg.add(var.set_max_interval(config[CONF_MAX_INTERVAL]))
     cg.add(parent.register_sensor(var, sensor_type))
 
     # Apply sensor type specific configuration
-    if sensor_type in SENSOR_TYPES:
-        sensor_config = SENSOR_TYPES[sensor_type]
-
+    sensor_config = SENSOR_TYPES.get(sensor_type) or DIAGNOSTIC_SENSOR_TYPES.get(sensor_type)
+    if sensor_config is not None:
         # Override config with sensor type defaults if not specified
         if "unit_of_measurement" not in config and "unit" in sensor_config:
             cg.add(var.set_unit_of_measurement(sensor_config["unit"]))
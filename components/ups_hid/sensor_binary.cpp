@@ -6,6 +6,18 @@ namespace ups_hid {
 
 static const char *const TAG_BINARY = "ups_hid.binary_sensor";
 
+bool UpsHidBinarySensor::publish_if_changed(const UpsHotData &data) {
+  if (state_source_ == nullptr) {
+    return false;
+  }
+  const bool value = state_source_(data);
+  if (has_state() && state == value) {
+    return false;
+  }
+  publish_state(value);
+  return true;
+}
+
 void UpsHidBinarySensor::dump_config() {
   ESP_LOGCONFIG(TAG_BINARY, "UPS HID Binary Sensor:");
   ESP_LOGCONFIG(TAG_BINARY, "  Type: %s", sensor_type_.c_str());
@@ -13,4 +25,4 @@ void UpsHidBinarySensor::dump_config() {
 }
 
 }  // namespace ups_hid
-}  // namespace esphome
\ No newline at end of file
+}  // namespace esphome
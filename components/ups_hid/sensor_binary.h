@@ -2,22 +2,32 @@
 
 #include "esphome/core/component.h"
 #include "esphome/components/binary_sensor/binary_sensor.h"
-#include "ups_hid.h"
+#include "data_hot.h"
 
 namespace esphome
 {
   namespace ups_hid
   {
 
+    // State a binary sensor publishes, resolved from its type at registration
+    using BinarySensorStateSource = bool (*)(const UpsHotData &);
+
     class UpsHidBinarySensor : public binary_sensor::BinarySensor, public Component
     {
     public:
       void set_sensor_type(const std::string &type) { sensor_type_ = type; }
+      const std::string &get_sensor_type() const { return sensor_type_; }
+      void set_state_source(BinarySensorStateSource source) { state_source_ = source; }
+      BinarySensorStateSource get_state_source() const { return state_source_; }
+
+      // Called for every snapshot; returns true if the state was published
+      bool publish_if_changed(const UpsHotData &data);
       void dump_config() override;
 
     protected:
       std::string sensor_type_;
+      BinarySensorStateSource state_source_{nullptr};
     };
 
   } // namespace ups_hid
-} // namespace esphome
\ No newline at end of file
+} // namespace esphome
@@ -1,5 +1,7 @@
 #include "sensor_numeric.h"
+#include "esphome/core/hal.h"
 #include "esphome/core/log.h"
+#include <cmath>
 
 namespace esphome
 {
@@ -8,12 +10,69 @@ namespace esphome
 
     static const char *const S_TAG = "ups_hid.sensor";
 
+    bool UpsHidSensor::publish_if_changed(const UpsData &data)
+    {
+      if (value_source_ == nullptr)
+      {
+        return false;
+      }
+      return publish_value(value_source_(data));
+    }
+
+    bool UpsHidSensor::publish_if_changed(const UpsHidComponent &parent)
+    {
+      if (diagnostic_source_ == nullptr)
+      {
+        return false;
+      }
+      return publish_value(diagnostic_source_(parent));
+    }
+
+    bool UpsHidSensor::publish_value(float value)
+    {
+      if (std::isnan(value))
+      {
+        return false;  // Unavailable values keep the last published state
+      }
+
+      const uint32_t now = millis();
+      if (published_)
+      {
+        const uint32_t elapsed = now - last_publish_ms_;
+        if (elapsed < min_interval_ms_)
+        {
+          return false;
+        }
+        const float delta = std::fabs(value - last_published_value_);
+        const bool changed = deadband_ > 0.0f ? delta >= deadband_ : delta > 0.0f;
+        const bool heartbeat = max_interval_ms_ > 0 && elapsed >= max_interval_ms_;
+        if (!changed && !heartbeat)
+        {
+          return false;
+        }
+      }
+
+      published_ = true;
+      last_published_value_ = value;
+      last_publish_ms_ = now;
+      publish_state(value);
+      return true;
+    }
+
     void UpsHidSensor::dump_config()
     {
       ESP_LOGCONFIG(S_TAG, "UPS HID Sensor:");
       ESP_LOGCONFIG(S_TAG, "  Type: %s", sensor_type_.c_str());
+      if (deadband_ > 0.0f)
+      {
+        ESP_LOGCONFIG(S_TAG, "  Deadband: %.2f", deadband_);
+      }
+      if (min_interval_ms_ > 0 || max_interval_ms_ > 0)
+      {
+        ESP_LOGCONFIG(S_TAG, "  Publish Interval: min %u ms, max %u ms", min_interval_ms_, max_interval_ms_);
+      }
       LOG_SENSOR("  ", "Sensor", this);
     }
 
   } // namespace ups_hid
-} // namespace esphome
\ No newline at end of file
+} // namespace esphome
@@ -2,22 +2,56 @@
 
 #include "esphome/core/component.h"
 #include "esphome/components/sensor/sensor.h"
-#include "ups_hid.h"
+#include "data_composite.h"
 
 namespace esphome
 {
   namespace ups_hid
   {
 
+    class UpsHidComponent;
+
+    // Field a sensor publishes, resolved from its type at registration; NAN when unavailable
+    using SensorValueSource = float (*)(const UpsData &);
+    // Instrumentation value of a diagnostic sensor, read from the component rather than the snapshot
+    using DiagnosticValueSource = float (*)(const UpsHidComponent &);
+
     class UpsHidSensor : public sensor::Sensor, public Component
     {
     public:
       void set_sensor_type(const std::string &type) { sensor_type_ = type; }
+      const std::string &get_sensor_type() const { return sensor_type_; }
+      void set_value_source(SensorValueSource source) { value_source_ = source; }
+      SensorValueSource get_value_source() const { return value_source_; }
+      void set_diagnostic_source(DiagnosticValueSource source) { diagnostic_source_ = source; }
+      bool is_diagnostic() const { return diagnostic_source_ != nullptr; }
+
+      // Publish policy: changes smaller than the deadband are held back, no two
+      // publishes are closer than min_interval, and an unchanged value is
+      // republished after max_interval (0 = never)
+      void set_deadband(float deadband) { deadband_ = deadband; }
+      void set_min_interval(uint32_t interval_ms) { min_interval_ms_ = interval_ms; }
+      void set_max_interval(uint32_t interval_ms) { max_interval_ms_ = interval_ms; }
+
+      // Called for every snapshot; returns true if the value was published
+      bool publish_if_changed(const UpsData &data);
+      bool publish_if_changed(const UpsHidComponent &parent);
       void dump_config() override;
 
     protected:
       std::string sensor_type_;
+      SensorValueSource value_source_{nullptr};
+      DiagnosticValueSource diagnostic_source_{nullptr};
+      float deadband_{0.0f};
+      uint32_t min_interval_ms_{0};
+      uint32_t max_interval_ms_{0};
+
+      bool published_{false};
+      float last_published_value_{NAN};
+      uint32_t last_publish_ms_{0};
+
+      bool publish_value(float value);
     };
 
   } // namespace ups_hid
-} // namespace esphome
\ No newline at end of file
+} // namespace esphome
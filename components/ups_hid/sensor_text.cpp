@@ -8,6 +8,21 @@ namespace esphome
 
     static const char *const TXT_TAG = "ups_hid.text_sensor";
 
+    bool UpsHidTextSensor::publish_if_changed(const UpsHidComponent &parent, const UpsData &data)
+    {
+      if (value_source_ == nullptr)
+      {
+        return false;
+      }
+      std::string value = value_source_(parent, data);
+      if (value.empty() || (has_state() && state == value))
+      {
+        return false;
+      }
+      publish_state(value);
+      return true;
+    }
+
     void UpsHidTextSensor::dump_config()
     {
       ESP_LOGCONFIG(TXT_TAG, "UPS HID Text Sensor:");
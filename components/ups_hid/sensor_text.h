@@ -2,22 +2,35 @@
 
 #include "esphome/core/component.h"
 #include "esphome/components/text_sensor/text_sensor.h"
-#include "ups_hid.h"
+#include "data_composite.h"
 
 namespace esphome
 {
   namespace ups_hid
   {
 
+    class UpsHidComponent;
+
+    // Text a sensor publishes, resolved from its type at registration; empty when unavailable.
+    // Takes the component too, for values kept outside UpsData (protocol name).
+    using TextSensorValueSource = std::string (*)(const UpsHidComponent &, const UpsData &);
+
     class UpsHidTextSensor : public text_sensor::TextSensor, public Component
     {
     public:
       void set_sensor_type(const std::string &type) { sensor_type_ = type; }
+      const std::string &get_sensor_type() const { return sensor_type_; }
+      void set_value_source(TextSensorValueSource source) { value_source_ = source; }
+      TextSensorValueSource get_value_source() const { return value_source_; }
+
+      // Called for every snapshot; returns true if the text was published
+      bool publish_if_changed(const UpsHidComponent &parent, const UpsData &data);
       void dump_config() override;
 
     protected:
       std::string sensor_type_;
+      TextSensorValueSource value_source_{nullptr};
     };
 
   } // namespace ups_hid
-} // namespace esphome
\ No newline at end of file
+} // namespace esphome
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#include <cstdint>
+
+#ifdef USE_ESP32
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+namespace esphome {
+namespace ups_hid {
+
+// Placement of one FreeRTOS task, set from the YAML tasks: options
+struct TaskConfig {
+    const char* name;
+    uint32_t stack_size;
+    uint8_t priority;
+    int8_t core{-1};  // -1: no affinity
+};
+
+// Tasks created by the ESP32 USB transport
+struct UsbTaskConfig {
+    TaskConfig host;    // USB Host Library task, shared by every transport
+    TaskConfig client;  // Per-transport client event task
+};
+
+#ifdef USE_ESP32
+// xTaskCreatePinnedToCore() honouring config.core; a core the chip does not
+// have falls back to no affinity
+inline BaseType_t create_task(TaskFunction_t function, const TaskConfig& config, void* arg, TaskHandle_t* handle) {
+    const BaseType_t core = config.core >= 0 && config.core < portNUM_PROCESSORS ? config.core : tskNO_AFFINITY;
+    return xTaskCreatePinnedToCore(function, config.name, config.stack_size, arg, config.priority, handle, core);
+}
+#endif
+
+} // namespace ups_hid
+} // namespace esphome
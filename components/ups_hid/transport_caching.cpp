@@ -0,0 +1,242 @@
+#include "transport_caching.h"
+#include "esphome/core/log.h"
+#include "esphome/core/hal.h"
+#include <algorithm>
+#include <cstring>
+
+namespace esphome {
+namespace ups_hid {
+
+static const char *const CACHE_TRANSPORT_TAG = "ups_hid.report_cache";
+
+CachingUsbTransport::CachingUsbTransport(std::unique_ptr<IUsbTransport> inner, uint32_t default_ttl_ms)
+    : inner_(std::move(inner)), default_ttl_ms_(default_ttl_ms) {}
+
+void CachingUsbTransport::set_report_ttl(uint8_t report_type, uint8_t report_id, uint32_t ttl_ms) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    for (auto &entry : ttl_overrides_) {
+        if (entry.report_type == report_type && entry.report_id == report_id) {
+            entry.ttl_ms = ttl_ms;
+            return;
+        }
+    }
+    ttl_overrides_.push_back({report_type, report_id, ttl_ms});
+}
+
+void CachingUsbTransport::invalidate_all() {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    for (auto &entry : entries_) {
+        entry.valid = false;
+    }
+}
+
+esp_err_t CachingUsbTransport::deinitialize() {
+    invalidate_all();
+    return inner_->deinitialize();
+}
+
+esp_err_t CachingUsbTransport::hid_get_report(uint8_t report_type, uint8_t report_id,
+                                             uint8_t* data, size_t* data_len,
+                                             uint32_t timeout_ms) {
+    if (!data || !data_len || *data_len == 0) {
+        return inner_->hid_get_report(report_type, report_id, data, data_len, timeout_ms);
+    }
+
+    const uint32_t ttl_ms = ttl_for(report_type, report_id);
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        sync_connection();
+
+        esp_err_t result;
+        if (lookup(report_type, report_id, ttl_ms, data, data_len, &result)) {
+            return result;
+        }
+    }
+
+    // Never hold the cache lock across a USB transfer
+    esp_err_t ret = inner_->hid_get_report(report_type, report_id, data, data_len, timeout_ms);
+
+    if (ttl_ms > 0 && (ret == ESP_OK || ret == ESP_FAIL)) {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        store(report_type, report_id, ret, data, ret == ESP_OK ? *data_len : 0);
+    }
+    return ret;
+}
+
+esp_err_t CachingUsbTransport::hid_get_reports(HidReportRequest* requests, size_t count,
+                                              uint32_t timeout_ms) {
+    if (count > limits::MAX_REPORT_BATCH) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint32_t ttls[limits::MAX_REPORT_BATCH];
+    for (size_t i = 0; i < count; i++) {
+        ttls[i] = ttl_for(requests[i].report_type, requests[i].report_id);
+    }
+
+    bool forwarded[limits::MAX_REPORT_BATCH] = {};
+    size_t misses = 0;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        sync_connection();
+
+        for (size_t i = 0; i < count; i++) {
+            HidReportRequest &request = requests[i];
+            if (request.done) {
+                continue;
+            }
+            request.length = request.expected_len;
+            if (request.data && request.expected_len > 0 &&
+                lookup(request.report_type, request.report_id, ttls[i], request.data, &request.length,
+                       &request.result)) {
+                if (request.result != ESP_OK) {
+                    request.length = 0;
+                }
+                request.done = true;
+                continue;
+            }
+            forwarded[i] = true;
+            misses++;
+        }
+    }
+
+    // Never hold the cache lock across a USB transfer
+    if (misses > 0) {
+        inner_->hid_get_reports(requests, count, timeout_ms);
+
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        for (size_t i = 0; i < count; i++) {
+            const HidReportRequest &request = requests[i];
+            if (forwarded[i] && ttls[i] > 0 && (request.result == ESP_OK || request.result == ESP_FAIL)) {
+                store(request.report_type, request.report_id, request.result, request.data, request.length);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (requests[i].result != ESP_OK) {
+            return requests[i].result;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t CachingUsbTransport::hid_set_report(uint8_t report_type, uint8_t report_id,
+                                             const uint8_t* data, size_t data_len,
+                                             uint32_t timeout_ms) {
+    {
+        // A write may change any report type sharing this ID (e.g. a feature
+        // write reflected in the input report)
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        for (auto &entry : entries_) {
+            if (entry.valid && entry.report_id == report_id) {
+                entry.valid = false;
+                stats_.invalidations++;
+            }
+        }
+    }
+    return inner_->hid_set_report(report_type, report_id, data, data_len, timeout_ms);
+}
+
+void CachingUsbTransport::dump_config() const {
+    inner_->dump_config();
+
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    size_t cached = 0;
+    for (const auto &entry : entries_) {
+        if (entry.valid) cached++;
+    }
+    const uint32_t lookups = stats_.hits + stats_.negative_hits + stats_.misses;
+    ESP_LOGCONFIG(CACHE_TRANSPORT_TAG, "  Report Cache: %u ms TTL, %zu/%zu entries, %zu overrides",
+                  default_ttl_ms_, cached, limits::REPORT_CACHE_SIZE, ttl_overrides_.size());
+    ESP_LOGCONFIG(CACHE_TRANSPORT_TAG, "    Hits: %u (%u negative), Misses: %u, Hit Rate: %.1f%%",
+                  stats_.hits + stats_.negative_hits, stats_.negative_hits, stats_.misses,
+                  lookups > 0 ? 100.0f * (stats_.hits + stats_.negative_hits) / lookups : 0.0f);
+    ESP_LOGCONFIG(CACHE_TRANSPORT_TAG, "    Invalidations: %u", stats_.invalidations);
+}
+
+uint32_t CachingUsbTransport::ttl_for(uint8_t report_type, uint8_t report_id) const {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    for (const auto &entry : ttl_overrides_) {
+        if (entry.report_type == report_type && entry.report_id == report_id) {
+            return entry.ttl_ms;
+        }
+    }
+    return default_ttl_ms_;
+}
+
+void CachingUsbTransport::sync_connection() {
+    // Cached reports belong to the device that produced them; a bounce
+    // between two reads only shows in the connection ID
+    const bool connected = inner_->is_connected();
+    const uint32_t connection_id = inner_->get_connection_id();
+    if (connected != was_connected_ || connection_id != connection_id_) {
+        for (auto &entry : entries_) {
+            entry.valid = false;
+        }
+        was_connected_ = connected;
+        connection_id_ = connection_id;
+    }
+}
+
+bool CachingUsbTransport::lookup(uint8_t report_type, uint8_t report_id, uint32_t ttl_ms,
+                                 uint8_t* data, size_t* data_len, esp_err_t* result) {
+    CacheEntry *entry = ttl_ms > 0 ? find_entry(report_type, report_id) : nullptr;
+    if (!entry || millis() - entry->stored_ms >= ttl_ms) {
+        stats_.misses++;
+        return false;
+    }
+    *result = entry->result;
+    if (entry->result != ESP_OK) {
+        stats_.negative_hits++;
+        return true;
+    }
+    stats_.hits++;
+    *data_len = std::min(*data_len, static_cast<size_t>(entry->length));
+    memcpy(data, entry->data, *data_len);
+    ESP_LOGVV(CACHE_TRANSPORT_TAG, "Cache hit: type=0x%02X, id=0x%02X", report_type, report_id);
+    return true;
+}
+
+CachingUsbTransport::CacheEntry* CachingUsbTransport::find_entry(uint8_t report_type, uint8_t report_id) {
+    for (auto &entry : entries_) {
+        if (entry.valid && entry.report_type == report_type && entry.report_id == report_id) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void CachingUsbTransport::store(uint8_t report_type, uint8_t report_id, esp_err_t result,
+                                const uint8_t* data, size_t data_len) {
+    // Reuse the entry for this report, else a free one, else the oldest
+    CacheEntry *target = find_entry(report_type, report_id);
+    if (!target) {
+        CacheEntry *oldest = &entries_[0];
+        for (auto &entry : entries_) {
+            if (!entry.valid) {
+                target = &entry;
+                break;
+            }
+            if (entry.stored_ms < oldest->stored_ms) {
+                oldest = &entry;
+            }
+        }
+        if (!target) {
+            target = oldest;
+        }
+    }
+
+    target->report_type = report_type;
+    target->report_id = report_id;
+    target->result = result;
+    target->length = std::min(data_len, limits::MAX_HID_REPORT_SIZE);
+    target->stored_ms = millis();
+    target->valid = true;
+    if (target->length > 0) {
+        memcpy(target->data, data, target->length);
+    }
+}
+
+} // namespace ups_hid
+} // namespace esphome
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "transport_interface.h"
+#include "constants_ups.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace ups_hid {
+
+/**
+ * Caching USB Transport Decorator
+ *
+ * Wraps another transport and serves repeated GET_REPORT requests for the
+ * same (report_type, report_id) from memory until a per-report TTL expires.
+ * Protocols probe overlapping reports several times per acquisition cycle;
+ * with the cache only the first read of each cycle reaches the device.
+ *
+ * Definitive failures (the device rejected the report) are cached as well,
+ * so probing a report the UPS does not implement costs one transfer per TTL.
+ * Timeouts are never cached.
+ *
+ * Design Pattern: Decorator over IUsbTransport
+ */
+class CachingUsbTransport : public IUsbTransport {
+public:
+    CachingUsbTransport(std::unique_ptr<IUsbTransport> inner, uint32_t default_ttl_ms);
+    ~CachingUsbTransport() override = default;
+
+    // TTL for one report; 0 disables caching for it
+    void set_report_ttl(uint8_t report_type, uint8_t report_id, uint32_t ttl_ms);
+    void invalidate_all();
+
+    // IUsbTransport implementation
+    esp_err_t initialize() override { return inner_->initialize(); }
+    esp_err_t deinitialize() override;
+
+    bool is_connected() const override { return inner_->is_connected(); }
+    uint16_t get_vendor_id() const override { return inner_->get_vendor_id(); }
+    uint16_t get_product_id() const override { return inner_->get_product_id(); }
+    uint32_t get_connection_id() const override { return inner_->get_connection_id(); }
+    void set_connection_callback(ConnectionCallback callback) override {
+        inner_->set_connection_callback(std::move(callback));
+    }
+
+    esp_err_t hid_get_report(uint8_t report_type, uint8_t report_id,
+                           uint8_t* data, size_t* data_len,
+                           uint32_t timeout_ms = 1000) override;
+
+    // Cache hits are answered here; only the misses reach the inner transport,
+    // still as one batch
+    esp_err_t hid_get_reports(HidReportRequest* requests, size_t count, uint32_t timeout_ms) override;
+
+    esp_err_t hid_set_report(uint8_t report_type, uint8_t report_id,
+                           const uint8_t* data, size_t data_len,
+                           uint32_t timeout_ms = 1000) override;
+
+    esp_err_t get_string_descriptor(uint8_t string_index,
+                                  std::string& result) override {
+        return inner_->get_string_descriptor(string_index, result);
+    }
+
+    uint8_t get_serial_number_index() const override { return inner_->get_serial_number_index(); }
+
+    esp_err_t get_report_descriptor(std::vector<uint8_t>& descriptor) override {
+        return inner_->get_report_descriptor(descriptor);
+    }
+
+    std::string get_last_error() const override { return inner_->get_last_error(); }
+
+    void dump_config() const override;
+    size_t get_memory_usage() const override {
+        return sizeof(*this) + heap_bytes(ttl_overrides_) + inner_->get_memory_usage();
+    }
+    uint32_t get_task_stack_free() const override { return inner_->get_task_stack_free(); }
+
+    esp_err_t start_input_streaming(InputReportCallback callback) override {
+        return inner_->start_input_streaming(std::move(callback));
+    }
+    void stop_input_streaming() override { inner_->stop_input_streaming(); }
+    bool get_cached_input_report(uint8_t report_id, uint8_t* data, size_t* data_len,
+                                 uint32_t max_age_ms) const override {
+        return inner_->get_cached_input_report(report_id, data, data_len, max_age_ms);
+    }
+
+private:
+    struct CacheEntry {
+        uint8_t report_type{0};
+        uint8_t report_id{0};
+        uint8_t length{0};
+        bool valid{false};
+        esp_err_t result{ESP_OK};     // ESP_FAIL entries record a rejected report
+        uint32_t stored_ms{0};
+        uint8_t data[limits::MAX_HID_REPORT_SIZE];
+    };
+
+    struct TtlOverride {
+        uint8_t report_type;
+        uint8_t report_id;
+        uint32_t ttl_ms;
+    };
+
+    struct CacheStats {
+        uint32_t hits{0};
+        uint32_t negative_hits{0};
+        uint32_t misses{0};
+        uint32_t invalidations{0};
+    };
+
+    std::unique_ptr<IUsbTransport> inner_;
+    uint32_t default_ttl_ms_;
+    std::vector<TtlOverride> ttl_overrides_;
+
+    CacheEntry entries_[limits::REPORT_CACHE_SIZE];
+    CacheStats stats_;
+    mutable std::mutex cache_mutex_;
+    bool was_connected_{false};
+    uint32_t connection_id_{0};  // Of the connection the entries came from
+
+    uint32_t ttl_for(uint8_t report_type, uint8_t report_id) const;
+    // Drop every entry when the device connects or disconnects; caller holds cache_mutex_
+    void sync_connection();
+    // Serve one report from the cache; caller holds cache_mutex_
+    bool lookup(uint8_t report_type, uint8_t report_id, uint32_t ttl_ms,
+                uint8_t* data, size_t* data_len, esp_err_t* result);
+    CacheEntry* find_entry(uint8_t report_type, uint8_t report_id);
+    void store(uint8_t report_type, uint8_t report_id, esp_err_t result,
+               const uint8_t* data, size_t data_len);
+};
+
+} // namespace ups_hid
+} // namespace esphome
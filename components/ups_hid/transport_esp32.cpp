@@ -1,7 +1,9 @@
 #include "transport_esp32.h"
 #include "constants_ups.h"
-#include "esphome/core/log.h"
+#include "constants_hid.h"
+#include "log_ups.h"
 #include "esphome/core/helpers.h"
+#include "esphome/core/hal.h"
 
 #ifdef USE_ESP32
 
@@ -15,7 +17,19 @@ static const char *const ESP32_USB_TAG = "ups_hid.esp32_usb";
 #define USB_CLASS_HID 0x03
 #endif
 
-Esp32UsbTransport::Esp32UsbTransport() {
+// Every pooled transfer is sized for the largest request we issue (string descriptors)
+static constexpr size_t CONTROL_TRANSFER_BUFFER_SIZE =
+    sizeof(usb_setup_packet_t) + limits::USB_STRING_DESCRIPTOR_REQUEST_LENGTH;
+
+std::mutex Esp32UsbTransport::host_mutex_;
+uint8_t Esp32UsbTransport::host_users_{0};
+std::atomic<bool> Esp32UsbTransport::host_running_{false};
+TaskHandle_t Esp32UsbTransport::host_task_handle_{nullptr};
+SemaphoreHandle_t Esp32UsbTransport::host_ready_{nullptr};
+std::set<uint8_t> Esp32UsbTransport::claimed_addresses_;
+
+Esp32UsbTransport::Esp32UsbTransport(uint16_t vendor_id_filter, uint16_t product_id_filter)
+    : vendor_id_filter_(vendor_id_filter), product_id_filter_(product_id_filter) {
     memset(&device_, 0, sizeof(device_));
 }
 
@@ -24,7 +38,7 @@ Esp32UsbTransport::~Esp32UsbTransport() {
 }
 
 esp_err_t Esp32UsbTransport::initialize() {
-    std::lock_guard<std::mutex> lock(device_mutex_);
+    std::unique_lock<std::mutex> lock(device_mutex_);
     
     if (initialized_.load()) {
         return ESP_OK;
@@ -41,7 +55,7 @@ esp_err_t Esp32UsbTransport::initialize() {
     // Register USB client for device events - connection will be asynchronous  
     ret = find_and_open_device();
     if (ret != ESP_OK) {
-        teardown_usb_host();
+        teardown_usb_host(lock);
         return ret;
     }
     
@@ -53,7 +67,7 @@ esp_err_t Esp32UsbTransport::initialize() {
 }
 
 esp_err_t Esp32UsbTransport::deinitialize() {
-    std::lock_guard<std::mutex> lock(device_mutex_);
+    std::unique_lock<std::mutex> lock(device_mutex_);
     
     if (!initialized_.load()) {
         return ESP_OK;
@@ -64,7 +78,7 @@ esp_err_t Esp32UsbTransport::deinitialize() {
     connected_ = false;
     initialized_ = false;
     
-    esp_err_t ret = teardown_usb_host();
+    esp_err_t ret = teardown_usb_host(lock);
     if (ret != ESP_OK) {
         ESP_LOGW(ESP32_USB_TAG, "USB teardown had issues: %s", esp_err_to_name(ret));
     }
@@ -98,93 +112,99 @@ esp_err_t Esp32UsbTransport::hid_get_report(uint8_t report_type, uint8_t report_
         return ESP_ERR_INVALID_ARG;
     }
 
-    ESP_LOGD(ESP32_USB_TAG, "HID GET_REPORT: type=0x%02X, id=0x%02X, max_len=%zu", 
+    UPS_HID_LOGD(ESP32_USB_TAG, "HID GET_REPORT: type=0x%02X, id=0x%02X, max_len=%zu", 
              report_type, report_id, *data_len);
     
-    // Use fixed buffer sizes like working implementation
-    uint8_t buffer[64] = {0}; // Fixed size buffer
-    size_t expected_len = std::min(*data_len, sizeof(buffer));
-    
-    // Create USB control transfer for HID GET_REPORT
     const uint8_t bmRequestType = USB_BM_REQUEST_TYPE_DIR_IN | 
                                  USB_BM_REQUEST_TYPE_TYPE_CLASS | 
                                  USB_BM_REQUEST_TYPE_RECIP_INTERFACE;
     const uint8_t bRequest = 0x01; // HID GET_REPORT
     const uint16_t wValue = (report_type << 8) | report_id;
     const uint16_t wIndex = device_.interface_num;
-    const uint16_t wLength = expected_len;
-    
-    usb_transfer_t *transfer = nullptr;
-    size_t transfer_size = sizeof(usb_setup_packet_t) + expected_len;
-    esp_err_t ret = usb_host_transfer_alloc(transfer_size, 0, &transfer);
-    if (ret != ESP_OK) {
-        ESP_LOGE(ESP32_USB_TAG, "Failed to allocate transfer: %s", esp_err_to_name(ret));
-        return ret;
+    size_t expected_len = std::min(*data_len, limits::MAX_HID_REPORT_SIZE);
+    
+    size_t received = 0;
+    esp_err_t ret = submit_control_transfer(bmRequestType, bRequest, wValue, wIndex,
+                                            data, expected_len, timeout_ms, &received);
+    if (ret == ESP_OK && received > 0) {
+        *data_len = received;
+        UPS_HID_LOGD(ESP32_USB_TAG, "HID GET_REPORT success: received %zu bytes", *data_len);
+    } else if (ret == ESP_OK) {
+        ESP_LOGW(ESP32_USB_TAG, "HID GET_REPORT: No data received");
+        *data_len = 0;
+        ret = ESP_FAIL;
+    } else if (ret == ESP_ERR_TIMEOUT) {
+        ESP_LOGW(ESP32_USB_TAG, "HID GET_REPORT timeout");
+    } else {
+        ESP_LOGW(ESP32_USB_TAG, "HID GET_REPORT failed: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+esp_err_t Esp32UsbTransport::hid_get_reports(HidReportRequest* requests, size_t count, uint32_t timeout_ms) {
+    if (count > limits::MAX_REPORT_BATCH) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (!device_.dev_hdl) {
+        for (size_t i = 0; i < count; i++) {
+            if (!requests[i].done) {
+                requests[i].length = 0;
+                requests[i].result = ESP_ERR_INVALID_STATE;
+                requests[i].done = true;
+            }
+        }
+        return ESP_ERR_INVALID_STATE;
     }
     
-    // Setup control transfer
-    transfer->device_handle = device_.dev_hdl;
-    transfer->bEndpointAddress = 0;
-    transfer->num_bytes = transfer_size;
-    transfer->timeout_ms = timeout_ms;
+    const uint8_t bmRequestType = USB_BM_REQUEST_TYPE_DIR_IN | 
+                                 USB_BM_REQUEST_TYPE_TYPE_CLASS | 
+                                 USB_BM_REQUEST_TYPE_RECIP_INTERFACE;
     
-    // Create setup packet
-    usb_setup_packet_t *setup = (usb_setup_packet_t*)transfer->data_buffer;
-    setup->bmRequestType = bmRequestType;
-    setup->bRequest = bRequest;
-    setup->wValue = wValue;
-    setup->wIndex = wIndex;
-    setup->wLength = wLength;
-    
-    // Use semaphore for synchronous operation
-    SemaphoreHandle_t done_sem = xSemaphoreCreateBinary();
-    if (!done_sem) {
-        usb_host_transfer_free(transfer);
-        return ESP_ERR_NO_MEM;
-    }
-    
-    // Simple context for completion
-    struct {
-        SemaphoreHandle_t sem;
-        esp_err_t result;
-        size_t actual_bytes;
-    } ctx = {done_sem, ESP_ERR_TIMEOUT, 0};
-    
-    transfer->context = &ctx;
-    transfer->callback = [](usb_transfer_t *t) {
-        auto *c = static_cast<decltype(ctx)*>(t->context);
-        c->result = (t->status == USB_TRANSFER_STATUS_COMPLETED) ? ESP_OK : ESP_FAIL;
-        c->actual_bytes = t->actual_num_bytes;
-        xSemaphoreGive(c->sem);
-    };
+    // Every outstanding GET_REPORT goes into one control request queue
+    ControlRequest queue[limits::MAX_REPORT_BATCH];
+    uint8_t origin[limits::MAX_REPORT_BATCH];
+    size_t queued = 0;
+    for (size_t i = 0; i < count; i++) {
+        HidReportRequest &request = requests[i];
+        if (request.done) {
+            continue;
+        }
+        ControlRequest &control = queue[queued];
+        control.bmRequestType = bmRequestType;
+        control.bRequest = 0x01; // HID GET_REPORT
+        control.wValue = (request.report_type << 8) | request.report_id;
+        control.wIndex = device_.interface_num;
+        control.data = request.data;
+        control.data_len = std::min(request.expected_len, limits::MAX_HID_REPORT_SIZE);
+        origin[queued++] = static_cast<uint8_t>(i);
+    }
     
-    ret = usb_host_transfer_submit_control(device_.client_hdl, transfer);
-    if (ret == ESP_OK) {
-        if (xSemaphoreTake(done_sem, pdMS_TO_TICKS(timeout_ms)) == pdTRUE) {
-            ret = ctx.result;
-            if (ret == ESP_OK && ctx.actual_bytes > sizeof(usb_setup_packet_t)) {
-                size_t data_received = ctx.actual_bytes - sizeof(usb_setup_packet_t);
-                size_t copy_len = std::min(data_received, *data_len);
-                memcpy(data, transfer->data_buffer + sizeof(usb_setup_packet_t), copy_len);
-                *data_len = copy_len;
-                
-                ESP_LOGD(ESP32_USB_TAG, "HID GET_REPORT success: received %zu bytes", *data_len);
-            } else {
-                ESP_LOGW(ESP32_USB_TAG, "HID GET_REPORT: No data received");
-                *data_len = 0;
-                ret = ESP_FAIL;
-            }
-        } else {
-            ESP_LOGW(ESP32_USB_TAG, "HID GET_REPORT timeout");
-            ret = ESP_ERR_TIMEOUT;
+    if (queued > 0) {
+        UPS_HID_LOGD(ESP32_USB_TAG, "HID GET_REPORT batch: %zu reports", queued);
+        submit_control_requests(queue, queued, timeout_ms);
+    }
+    
+    for (size_t q = 0; q < queued; q++) {
+        HidReportRequest &request = requests[origin[q]];
+        request.length = queue[q].actual_len;
+        request.result = queue[q].result;
+        if (request.result == ESP_OK && request.length == 0) {
+            request.result = ESP_FAIL;  // Same as hid_get_report(): an empty report is a failure
         }
-    } else {
-        ESP_LOGW(ESP32_USB_TAG, "Failed to submit HID GET_REPORT: %s", esp_err_to_name(ret));
+        if (request.result != ESP_OK) {
+            request.length = 0;
+            UPS_HID_LOGV(ESP32_USB_TAG, "HID GET_REPORT batch: type=0x%02X, id=0x%02X failed: %s",
+                     request.report_type, request.report_id, esp_err_to_name(request.result));
+        }
+        request.done = true;
     }
     
-    vSemaphoreDelete(done_sem);
-    usb_host_transfer_free(transfer);
-    return ret;
+    for (size_t i = 0; i < count; i++) {
+        if (requests[i].result != ESP_OK) {
+            return requests[i].result;
+        }
+    }
+    return ESP_OK;
 }
 
 esp_err_t Esp32UsbTransport::hid_set_report(uint8_t report_type, uint8_t report_id,
@@ -194,87 +214,30 @@ esp_err_t Esp32UsbTransport::hid_set_report(uint8_t report_type, uint8_t report_
         ESP_LOGE(ESP32_USB_TAG, "HID SET_REPORT: No device handle");
         return ESP_ERR_INVALID_ARG;
     }
-    if (!data || data_len == 0) {
+    if (!data || data_len == 0 || data_len > limits::MAX_HID_REPORT_SIZE) {
         ESP_LOGE(ESP32_USB_TAG, "HID SET_REPORT: Invalid parameters");
         return ESP_ERR_INVALID_ARG;
     }
 
-    ESP_LOGD(ESP32_USB_TAG, "HID SET_REPORT: type=0x%02X, id=0x%02X, len=%zu", 
+    UPS_HID_LOGD(ESP32_USB_TAG, "HID SET_REPORT: type=0x%02X, id=0x%02X, len=%zu", 
              report_type, report_id, data_len);
     
-    // Create USB control transfer for HID SET_REPORT
     const uint8_t bmRequestType = USB_BM_REQUEST_TYPE_DIR_OUT | 
                                  USB_BM_REQUEST_TYPE_TYPE_CLASS | 
                                  USB_BM_REQUEST_TYPE_RECIP_INTERFACE;
     const uint8_t bRequest = 0x09; // HID SET_REPORT
     const uint16_t wValue = (report_type << 8) | report_id;
     const uint16_t wIndex = device_.interface_num;
-    const uint16_t wLength = data_len;
-    
-    usb_transfer_t *transfer = nullptr;
-    size_t transfer_size = sizeof(usb_setup_packet_t) + data_len;
-    esp_err_t ret = usb_host_transfer_alloc(transfer_size, 0, &transfer);
-    if (ret != ESP_OK) {
-        ESP_LOGE(ESP32_USB_TAG, "Failed to allocate transfer: %s", esp_err_to_name(ret));
-        return ret;
-    }
-    
-    // Setup control transfer
-    transfer->device_handle = device_.dev_hdl;
-    transfer->bEndpointAddress = 0;
-    transfer->num_bytes = transfer_size;
-    transfer->timeout_ms = timeout_ms;
     
-    // Create setup packet
-    usb_setup_packet_t *setup = (usb_setup_packet_t*)transfer->data_buffer;
-    setup->bmRequestType = bmRequestType;
-    setup->bRequest = bRequest;
-    setup->wValue = wValue;
-    setup->wIndex = wIndex;
-    setup->wLength = wLength;
-    
-    // Copy data to transfer buffer
-    memcpy(transfer->data_buffer + sizeof(usb_setup_packet_t), data, data_len);
-    
-    // Use semaphore for synchronous operation
-    SemaphoreHandle_t done_sem = xSemaphoreCreateBinary();
-    if (!done_sem) {
-        usb_host_transfer_free(transfer);
-        return ESP_ERR_NO_MEM;
-    }
-    
-    // Simple context for completion
-    struct {
-        SemaphoreHandle_t sem;
-        esp_err_t result;
-    } ctx = {done_sem, ESP_ERR_TIMEOUT};
-    
-    transfer->context = &ctx;
-    transfer->callback = [](usb_transfer_t *t) {
-        auto *c = static_cast<decltype(ctx)*>(t->context);
-        c->result = (t->status == USB_TRANSFER_STATUS_COMPLETED) ? ESP_OK : ESP_FAIL;
-        xSemaphoreGive(c->sem);
-    };
-    
-    ret = usb_host_transfer_submit_control(device_.client_hdl, transfer);
+    esp_err_t ret = submit_control_transfer(bmRequestType, bRequest, wValue, wIndex,
+                                            const_cast<uint8_t*>(data), data_len, timeout_ms);
     if (ret == ESP_OK) {
-        if (xSemaphoreTake(done_sem, pdMS_TO_TICKS(timeout_ms)) == pdTRUE) {
-            ret = ctx.result;
-            if (ret == ESP_OK) {
-                ESP_LOGD(ESP32_USB_TAG, "HID SET_REPORT success");
-            } else {
-                ESP_LOGW(ESP32_USB_TAG, "HID SET_REPORT failed");
-            }
-        } else {
-            ESP_LOGW(ESP32_USB_TAG, "HID SET_REPORT timeout");
-            ret = ESP_ERR_TIMEOUT;
-        }
+        UPS_HID_LOGD(ESP32_USB_TAG, "HID SET_REPORT success");
+    } else if (ret == ESP_ERR_TIMEOUT) {
+        ESP_LOGW(ESP32_USB_TAG, "HID SET_REPORT timeout");
     } else {
-        ESP_LOGW(ESP32_USB_TAG, "Failed to submit HID SET_REPORT: %s", esp_err_to_name(ret));
+        ESP_LOGW(ESP32_USB_TAG, "HID SET_REPORT failed: %s", esp_err_to_name(ret));
     }
-    
-    vSemaphoreDelete(done_sem);
-    usb_host_transfer_free(transfer);
     return ret;
 }
 
@@ -287,10 +250,8 @@ esp_err_t Esp32UsbTransport::get_string_descriptor(uint8_t string_index,
         return ESP_ERR_INVALID_STATE;
     }
     
-    ESP_LOGD(ESP32_USB_TAG, "USB GET_STRING_DESCRIPTOR: index=%d, language_id=0x0409", string_index);
+    UPS_HID_LOGD(ESP32_USB_TAG, "USB GET_STRING_DESCRIPTOR: index=%d, language_id=0x0409", string_index);
     
-    // USB string descriptors can be up to 255 bytes, but typically much smaller
-    const size_t max_string_len = 255;
     const uint16_t language_id = 0x0409; // English US
     
     // USB string descriptor request parameters
@@ -300,112 +261,148 @@ esp_err_t Esp32UsbTransport::get_string_descriptor(uint8_t string_index,
     const uint8_t bRequest = USB_B_REQUEST_GET_DESCRIPTOR;
     const uint16_t wValue = (USB_B_DESCRIPTOR_TYPE_STRING << 8) | string_index;
     const uint16_t wIndex = language_id;
-    const uint16_t wLength = max_string_len;
     
-    usb_transfer_t *transfer = nullptr;
-    size_t transfer_size = sizeof(usb_setup_packet_t) + max_string_len;
-    esp_err_t ret = usb_host_transfer_alloc(transfer_size, 0, &transfer);
-    if (ret != ESP_OK) {
-        set_last_error("Failed to allocate string descriptor transfer: " + std::string(esp_err_to_name(ret)));
+    uint8_t desc_data[limits::USB_STRING_DESCRIPTOR_REQUEST_LENGTH];
+    size_t desc_len = 0;
+    esp_err_t ret = submit_control_transfer(bmRequestType, bRequest, wValue, wIndex,
+                                            desc_data, sizeof(desc_data),
+                                            timing::USB_SEMAPHORE_TIMEOUT_MS, &desc_len);
+    if (ret == ESP_ERR_TIMEOUT) {
+        ESP_LOGW(ESP32_USB_TAG, "USB string descriptor request timeout");
         return ret;
     }
+    if (ret != ESP_OK || desc_len == 0) {
+        ESP_LOGW(ESP32_USB_TAG, "USB string descriptor request failed or no data received");
+        return ESP_FAIL;
+    }
     
-    // Setup control transfer
-    transfer->device_handle = device_.dev_hdl;
-    transfer->bEndpointAddress = 0; // Control endpoint
-    transfer->num_bytes = transfer_size;
-    transfer->timeout_ms = timing::USB_CONTROL_TRANSFER_TIMEOUT_MS;
+    if (desc_len < 2) {
+        ESP_LOGW(ESP32_USB_TAG, "String descriptor too short: %zu bytes", desc_len);
+        return ESP_ERR_INVALID_SIZE;
+    }
     
-    // Create setup packet
-    usb_setup_packet_t *setup = (usb_setup_packet_t*)transfer->data_buffer;
-    setup->bmRequestType = bmRequestType;
-    setup->bRequest = bRequest;
-    setup->wValue = wValue;
-    setup->wIndex = wIndex;
-    setup->wLength = wLength;
-    
-    // Use semaphore for synchronous operation
-    SemaphoreHandle_t done_sem = xSemaphoreCreateBinary();
-    if (!done_sem) {
-        usb_host_transfer_free(transfer);
-        return ESP_ERR_NO_MEM;
-    }
-    
-    // Context for completion
-    struct {
-        SemaphoreHandle_t sem;
-        esp_err_t result;
-        size_t actual_bytes;
-    } ctx = {done_sem, ESP_ERR_TIMEOUT, 0};
-    
-    transfer->context = &ctx;
-    transfer->callback = [](usb_transfer_t *t) {
-        auto *c = static_cast<decltype(ctx)*>(t->context);
-        c->result = (t->status == USB_TRANSFER_STATUS_COMPLETED) ? ESP_OK : ESP_FAIL;
-        c->actual_bytes = t->actual_num_bytes;
-        xSemaphoreGive(c->sem);
-    };
+    uint8_t bLength = desc_data[0];        // Total length of descriptor
+    uint8_t bDescriptorType = desc_data[1]; // Should be USB_B_DESCRIPTOR_TYPE_STRING (0x03)
     
-    ret = usb_host_transfer_submit_control(device_.client_hdl, transfer);
-    if (ret == ESP_OK) {
-        if (xSemaphoreTake(done_sem, pdMS_TO_TICKS(timing::USB_SEMAPHORE_TIMEOUT_MS)) == pdTRUE) {
-            ret = ctx.result;
-            if (ret == ESP_OK && ctx.actual_bytes > sizeof(usb_setup_packet_t)) {
-                // Parse the USB string descriptor
-                uint8_t *desc_data = transfer->data_buffer + sizeof(usb_setup_packet_t);
-                size_t desc_len = ctx.actual_bytes - sizeof(usb_setup_packet_t);
-                
-                if (desc_len >= 2) {
-                    uint8_t bLength = desc_data[0];        // Total length of descriptor
-                    uint8_t bDescriptorType = desc_data[1]; // Should be USB_B_DESCRIPTOR_TYPE_STRING (0x03)
-                    
-                    if (bDescriptorType == USB_B_DESCRIPTOR_TYPE_STRING && bLength >= 2) {
-                        // USB string descriptors are UTF-16LE encoded, skip the 2-byte header
-                        size_t string_data_len = std::min(static_cast<size_t>(bLength - 2), desc_len - 2);
-                        uint8_t *string_data = desc_data + 2;
-                        
-                        // Convert UTF-16LE to ASCII (simplified, handles ASCII characters)
-                        result.reserve(string_data_len / 2);
-                        for (size_t i = 0; i < string_data_len; i += 2) {
-                            if (i + 1 < string_data_len) {
-                                uint16_t utf16_char = string_data[i] | (string_data[i + 1] << 8);
-                                if (utf16_char < 128 && utf16_char > 0) { // ASCII range, non-null
-                                    result += static_cast<char>(utf16_char);
-                                } else if (utf16_char >= 128) {
-                                    result += '?'; // Non-ASCII character placeholder
-                                }
-                            }
-                        }
-                        
-                        // Trim trailing whitespace
-                        while (!result.empty() && std::isspace(result.back())) {
-                            result.pop_back();
-                        }
-                        
-                        ESP_LOGI(ESP32_USB_TAG, "USB string descriptor %d: \"%s\"", string_index, result.c_str());
-                    } else {
-                        ESP_LOGW(ESP32_USB_TAG, "Invalid string descriptor: type=0x%02X, length=%d", bDescriptorType, bLength);
-                        ret = ESP_ERR_INVALID_RESPONSE;
-                    }
-                } else {
-                    ESP_LOGW(ESP32_USB_TAG, "String descriptor too short: %zu bytes", desc_len);
-                    ret = ESP_ERR_INVALID_SIZE;
-                }
-            } else {
-                ESP_LOGW(ESP32_USB_TAG, "USB string descriptor request failed or no data received");
-                ret = ESP_FAIL;
-            }
-        } else {
-            ESP_LOGW(ESP32_USB_TAG, "USB string descriptor request timeout");
-            ret = ESP_ERR_TIMEOUT;
+    if (bDescriptorType != USB_B_DESCRIPTOR_TYPE_STRING || bLength < 2) {
+        ESP_LOGW(ESP32_USB_TAG, "Invalid string descriptor: type=0x%02X, length=%d", bDescriptorType, bLength);
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    
+    // USB string descriptors are UTF-16LE encoded, skip the 2-byte header
+    size_t string_data_len = std::min(static_cast<size_t>(bLength - 2), desc_len - 2);
+    const uint8_t *string_data = desc_data + 2;
+    
+    // Convert UTF-16LE to ASCII (simplified, handles ASCII characters)
+    result.reserve(string_data_len / 2);
+    for (size_t i = 0; i + 1 < string_data_len; i += 2) {
+        uint16_t utf16_char = string_data[i] | (string_data[i + 1] << 8);
+        if (utf16_char < 128 && utf16_char > 0) { // ASCII range, non-null
+            result += static_cast<char>(utf16_char);
+        } else if (utf16_char >= 128) {
+            result += '?'; // Non-ASCII character placeholder
         }
-    } else {
-        ESP_LOGW(ESP32_USB_TAG, "Failed to submit string descriptor request: %s", esp_err_to_name(ret));
     }
     
-    vSemaphoreDelete(done_sem);
-    usb_host_transfer_free(transfer);
-    return ret;
+    // Trim trailing whitespace
+    while (!result.empty() && std::isspace(result.back())) {
+        result.pop_back();
+    }
+    
+    ESP_LOGI(ESP32_USB_TAG, "USB string descriptor %d: \"%s\"", string_index, result.c_str());
+    return ESP_OK;
+}
+
+esp_err_t Esp32UsbTransport::get_report_descriptor(std::vector<uint8_t>& descriptor) {
+    descriptor.clear();
+    
+    usb_host_client_handle_t client_hdl;
+    usb_device_handle_t dev_hdl;
+    uint8_t interface_num;
+    uint16_t length;
+    {
+        std::lock_guard<std::mutex> lock(device_mutex_);
+        if (!report_descriptor_.empty()) {
+            descriptor = report_descriptor_;
+            return ESP_OK;
+        }
+        client_hdl = device_.client_hdl;
+        dev_hdl = device_.dev_hdl;
+        interface_num = device_.interface_num;
+        length = device_.report_descriptor_length;
+    }
+    if (!client_hdl || !dev_hdl) {
+        set_last_error("USB device not ready");
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (length == 0) {
+        UPS_HID_LOGD(ESP32_USB_TAG, "Device has no HID class descriptor, report descriptor unavailable");
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (length > limits::MAX_REPORT_DESCRIPTOR_SIZE) {
+        ESP_LOGW(ESP32_USB_TAG, "Report descriptor too large: %u bytes", length);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    // A previous fetch timed out and its transfer is still owned by the stack
+    if (descriptor_slot_.in_flight) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    const size_t buffer_size = sizeof(usb_setup_packet_t) + length;
+    if (descriptor_slot_.transfer && descriptor_slot_.transfer->data_buffer_size < buffer_size) {
+        free_descriptor_slot();
+    }
+    if (!descriptor_slot_.transfer) {
+        esp_err_t ret = usb_host_transfer_alloc(buffer_size, 0, &descriptor_slot_.transfer);
+        if (ret != ESP_OK) {
+            set_last_error("Failed to allocate report descriptor transfer: " + std::string(esp_err_to_name(ret)));
+            return ret;
+        }
+        descriptor_slot_.transfer->context = &descriptor_slot_;
+        descriptor_slot_.transfer->callback = control_transfer_callback;
+        descriptor_slot_.transfer->bEndpointAddress = 0;
+    }
+    if (!descriptor_slot_.done) {
+        descriptor_slot_.done = xSemaphoreCreateBinary();
+        if (!descriptor_slot_.done) {
+            free_descriptor_slot();
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    xSemaphoreTake(descriptor_slot_.done, 0);
+    
+    // Report descriptors are requested from the interface (HID 1.11 section 7.1.1)
+    const uint8_t bmRequestType = USB_BM_REQUEST_TYPE_DIR_IN |
+                                 USB_BM_REQUEST_TYPE_TYPE_STANDARD |
+                                 USB_BM_REQUEST_TYPE_RECIP_INTERFACE;
+    const uint16_t wValue = HID_DESCRIPTOR_TYPE_REPORT << 8;
+    
+    descriptor.resize(length);
+    size_t received = 0;
+    set_descriptor_slot_in_use(true);
+    esp_err_t ret = execute_control_transfer(&descriptor_slot_, client_hdl, dev_hdl, bmRequestType,
+                                             USB_B_REQUEST_GET_DESCRIPTOR, wValue, interface_num,
+                                             descriptor.data(), length,
+                                             timing::USB_SEMAPHORE_TIMEOUT_MS, &received);
+    set_descriptor_slot_in_use(false);
+    if (ret != ESP_OK || received == 0) {
+        ESP_LOGW(ESP32_USB_TAG, "Report descriptor request failed: %s", esp_err_to_name(ret));
+        descriptor.clear();
+        return ret != ESP_OK ? ret : ESP_FAIL;
+    }
+    descriptor.resize(received);
+    
+    // Fetched once per connection; the buffer is not needed again
+    free_descriptor_slot();
+    
+    {
+        std::lock_guard<std::mutex> lock(device_mutex_);
+        if (device_.dev_hdl == dev_hdl) {
+            report_descriptor_ = descriptor;
+        }
+    }
+    ESP_LOGI(ESP32_USB_TAG, "Read HID report descriptor: %zu bytes", received);
+    return ESP_OK;
 }
 
 std::string Esp32UsbTransport::get_last_error() const {
@@ -413,6 +410,102 @@ std::string Esp32UsbTransport::get_last_error() const {
     return last_error_;
 }
 
+void Esp32UsbTransport::dump_config() const {
+    {
+        std::lock_guard<std::mutex> device_lock(device_mutex_);
+        if (vendor_id_filter_ != 0 || product_id_filter_ != 0) {
+            ESP_LOGCONFIG(ESP32_USB_TAG, "  Device Filter: %04X:%04X", vendor_id_filter_, product_id_filter_);
+        }
+        ESP_LOGCONFIG(ESP32_USB_TAG, "  Bound USB Address: %u", device_.address);
+    }
+    
+    std::lock_guard<std::mutex> lock(control_pool_mutex_);
+    ESP_LOGCONFIG(ESP32_USB_TAG, "  Control Transfer Pool: %zu x %zu bytes (%s)",
+                  limits::CONTROL_TRANSFER_POOL_SIZE, CONTROL_TRANSFER_BUFFER_SIZE,
+                  control_pool_allocated_ ? "allocated" : "not allocated");
+    ESP_LOGCONFIG(ESP32_USB_TAG, "    In Use: %u (high water %u)",
+                  control_pool_stats_.in_use, control_pool_stats_.high_water);
+    ESP_LOGCONFIG(ESP32_USB_TAG, "    Transfers: %u, Pipelined Batches: %u, Exhausted: %u, Abandoned: %u",
+                  control_pool_stats_.acquired, control_pool_stats_.batches,
+                  control_pool_stats_.exhausted, control_pool_stats_.abandoned);
+    
+    // A pinned high-water mark near zero means the stack_size option is too small
+    ESP_LOGCONFIG(ESP32_USB_TAG, "  Task Stack Free: client %u of %u bytes, host library %u of %u bytes",
+                  task_stack_free(usb_client_task_handle_), task_config_.client.stack_size,
+                  task_stack_free(host_task_handle_), task_config_.host.stack_size);
+    
+    if (streaming_enabled_.load()) {
+        std::lock_guard<std::mutex> cache_lock(input_cache_mutex_);
+        size_t cached = 0;
+        for (const auto &entry : input_report_cache_) {
+            if (entry.valid) cached++;
+        }
+        ESP_LOGCONFIG(ESP32_USB_TAG, "  Interrupt Streaming: %s (%zu report IDs cached)",
+                      interrupt_in_flight_.load() ? "active" : "idle", cached);
+        ESP_LOGCONFIG(ESP32_USB_TAG, "    Reports Received: %u, Evicted: %u",
+                      interrupt_reports_received_, interrupt_reports_evicted_);
+    }
+}
+
+size_t Esp32UsbTransport::get_memory_usage() const {
+    size_t bytes = sizeof(*this);
+    {
+        std::lock_guard<std::mutex> lock(control_pool_mutex_);
+        for (const auto &slot : control_pool_) {
+            if (slot.transfer) {
+                bytes += sizeof(usb_transfer_t) + slot.transfer->data_buffer_size;
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(device_mutex_);
+    if (descriptor_slot_.transfer) {
+        bytes += sizeof(usb_transfer_t) + descriptor_slot_.transfer->data_buffer_size;
+    }
+    if (interrupt_transfer_) {
+        bytes += sizeof(usb_transfer_t) + interrupt_transfer_->data_buffer_size;
+    }
+    return bytes + heap_bytes(report_descriptor_) + heap_bytes(last_error_);
+}
+
+esp_err_t Esp32UsbTransport::start_input_streaming(InputReportCallback callback) {
+    std::lock_guard<std::mutex> lock(device_mutex_);
+    input_report_callback_ = std::move(callback);
+    streaming_enabled_ = true;
+    
+    // A device that is not yet attached starts streaming from handle_new_device()
+    if (connected_.load() && device_.dev_hdl) {
+        return submit_interrupt_in();
+    }
+    return ESP_OK;
+}
+
+void Esp32UsbTransport::stop_input_streaming() {
+    std::lock_guard<std::mutex> lock(device_mutex_);
+    streaming_enabled_ = false;
+    cancel_interrupt_in();
+}
+
+bool Esp32UsbTransport::get_cached_input_report(uint8_t report_id, uint8_t* data, size_t* data_len,
+                                                uint32_t max_age_ms) const {
+    if (!streaming_enabled_.load() || !data || !data_len || *data_len == 0) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(input_cache_mutex_);
+    for (const auto &entry : input_report_cache_) {
+        if (!entry.valid || entry.report_id != report_id) {
+            continue;
+        }
+        if (millis() - entry.received_ms > max_age_ms) {
+            return false;
+        }
+        *data_len = std::min(*data_len, static_cast<size_t>(entry.length));
+        memcpy(data, entry.data, *data_len);
+        return true;
+    }
+    return false;
+}
+
 // Private methods implementation
 
 void Esp32UsbTransport::set_last_error(const std::string& error) {
@@ -422,46 +515,103 @@ void Esp32UsbTransport::set_last_error(const std::string& error) {
 }
 
 esp_err_t Esp32UsbTransport::setup_usb_host() {
-    // Create USB library task - USB Host installation happens inside the task
-    if (!usb_tasks_running_.load()) {
-        usb_tasks_running_ = true;
-        
-        // Create USB Host Library task first
-        BaseType_t task_created = xTaskCreate(usb_lib_task, "usb_lib_task", 4096, this, 2, &usb_lib_task_handle_);
-        if (task_created != pdTRUE) {
-            ESP_LOGE(ESP32_USB_TAG, "Failed to create USB Host Library task");
-            usb_tasks_running_ = false;
-            return ESP_FAIL;
+    if (usb_tasks_running_.load()) {
+        return ESP_OK;
+    }
+    
+    {
+        // USB Host installation happens inside the shared library task
+        std::lock_guard<std::mutex> lock(host_mutex_);
+        if (host_users_ == 0) {
+            if (host_ready_ == nullptr) {
+                host_ready_ = xSemaphoreCreateBinary();
+                if (host_ready_ == nullptr) {
+                    return ESP_ERR_NO_MEM;
+                }
+            }
+            xSemaphoreTake(host_ready_, 0);  // Drop a signal left by a previous run
+            
+            host_running_ = true;
+            BaseType_t task_created = create_task(usb_lib_task, task_config_.host, nullptr, &host_task_handle_);
+            if (task_created != pdTRUE) {
+                ESP_LOGE(ESP32_USB_TAG, "Failed to create USB Host Library task");
+                host_running_ = false;
+                return ESP_FAIL;
+            }
+            
+            // Clients can only register once the library is installed
+            if (xSemaphoreTake(host_ready_, pdMS_TO_TICKS(usb_tasks::HOST_INSTALL_TIMEOUT_MS)) != pdTRUE) {
+                ESP_LOGE(ESP32_USB_TAG, "USB Host Library not installed within %u ms", usb_tasks::HOST_INSTALL_TIMEOUT_MS);
+                host_running_ = false;
+                return ESP_ERR_TIMEOUT;
+            }
+            if (!host_running_.load()) {
+                return ESP_FAIL;  // usb_host_install() failed; already logged
+            }
         }
-        
-        // Give USB Host Library task time to initialize
-        vTaskDelay(pdMS_TO_TICKS(100));
-        
-        // Create USB client task
-        task_created = xTaskCreate(usb_client_task, "usb_client_task", 6144, this, 3, &usb_client_task_handle_);
-        if (task_created != pdTRUE) {
-            ESP_LOGE(ESP32_USB_TAG, "Failed to create USB client task");
-            usb_tasks_running_ = false;
-            return ESP_FAIL;
+        host_users_++;
+    }
+    
+    usb_tasks_running_ = true;
+    usb_client_task_exited_ = false;
+    BaseType_t task_created = create_task(usb_client_task, task_config_.client, this, &usb_client_task_handle_);
+    if (task_created != pdTRUE) {
+        ESP_LOGE(ESP32_USB_TAG, "Failed to create USB client task");
+        usb_tasks_running_ = false;
+        std::lock_guard<std::mutex> lock(host_mutex_);
+        if (--host_users_ == 0) {
+            host_running_ = false;
         }
-        
-        ESP_LOGI(ESP32_USB_TAG, "USB Host tasks created successfully");
+        return ESP_FAIL;
     }
     
+    ESP_LOGI(ESP32_USB_TAG, "USB Host tasks created successfully");
     return ESP_OK;
 }
 
-esp_err_t Esp32UsbTransport::teardown_usb_host() {
-    // Signal tasks to stop (they will self-terminate and handle USB cleanup)
-    if (usb_tasks_running_.load()) {
+esp_err_t Esp32UsbTransport::teardown_usb_host(std::unique_lock<std::mutex>& lock) {
+    const bool was_running = usb_tasks_running_.load();
+    
+    // Signal the client task to stop (it self-terminates)
+    if (was_running) {
+        // Transfers the stack still owns complete or time out through callbacks
+        // that only the client task delivers, so let them settle first
+        cancel_interrupt_in();
+        usb_host_client_handle_t client_hdl = device_.client_hdl;
+        TaskHandle_t client_task = usb_client_task_handle_;
+        
+        // The client task's device event handlers take device_mutex_; holding it
+        // here would stall the task we are waiting on
+        lock.unlock();
+        for (uint32_t waited_ms = 0; !transfers_idle() && waited_ms < usb_tasks::TRANSFER_DRAIN_TIMEOUT_MS;
+             waited_ms += usb_tasks::CLIENT_STOP_POLL_INTERVAL_MS) {
+            vTaskDelay(pdMS_TO_TICKS(usb_tasks::CLIENT_STOP_POLL_INTERVAL_MS));
+        }
+        if (!transfers_idle()) {
+            ESP_LOGW(ESP32_USB_TAG, "Transfers still in flight after %u ms, keeping their buffers",
+                     usb_tasks::TRANSFER_DRAIN_TIMEOUT_MS);
+        }
+        
         ESP_LOGI(ESP32_USB_TAG, "Stopping USB Host tasks...");
         usb_tasks_running_ = false;
         
-        // Wait for tasks to self-terminate
-        vTaskDelay(pdMS_TO_TICKS(500)); // Give tasks time to exit cleanly
+        // The client task blocks without a timeout; wake it wherever it waits
+        if (client_hdl) {
+            usb_host_client_unblock(client_hdl);
+        }
+        if (client_task) {
+            xTaskNotifyGive(client_task);
+        }
+        for (uint32_t waited_ms = 0; !usb_client_task_exited_.load() && waited_ms < usb_tasks::CLIENT_STOP_TIMEOUT_MS;
+             waited_ms += usb_tasks::CLIENT_STOP_POLL_INTERVAL_MS) {
+            vTaskDelay(pdMS_TO_TICKS(usb_tasks::CLIENT_STOP_POLL_INTERVAL_MS));
+        }
+        if (!usb_client_task_exited_.load()) {
+            ESP_LOGW(ESP32_USB_TAG, "USB client task did not stop within %u ms", usb_tasks::CLIENT_STOP_TIMEOUT_MS);
+        }
+        lock.lock();
         
         usb_client_task_handle_ = nullptr;
-        usb_lib_task_handle_ = nullptr;
         
         ESP_LOGI(ESP32_USB_TAG, "USB Host tasks stopped");
     }
@@ -469,9 +619,17 @@ esp_err_t Esp32UsbTransport::teardown_usb_host() {
     // Release interface and device
     if (device_.dev_hdl) {
         ESP_LOGI(ESP32_USB_TAG, "Cleaning up device resources");
-        usb_host_interface_release(device_.client_hdl, device_.dev_hdl, device_.interface_num);
-        usb_host_device_close(device_.client_hdl, device_.dev_hdl);
-        device_.dev_hdl = nullptr;
+        close_device();
+    }
+    
+    free_control_pool();
+    free_descriptor_slot();
+    report_descriptor_.clear();
+    
+    // A transfer the stack never returned is kept; submit_interrupt_in() will not reuse it while in flight
+    if (interrupt_transfer_ && !interrupt_in_flight_.load()) {
+        usb_host_transfer_free(interrupt_transfer_);
+        interrupt_transfer_ = nullptr;
     }
     
     if (device_.client_hdl) {
@@ -480,7 +638,13 @@ esp_err_t Esp32UsbTransport::teardown_usb_host() {
         device_.client_hdl = nullptr;
     }
     
-    // USB Host uninstallation happens inside usb_lib_task now
+    // USB Host uninstallation happens inside usb_lib_task once the last client is gone
+    if (was_running) {
+        std::lock_guard<std::mutex> lock(host_mutex_);
+        if (host_users_ > 0 && --host_users_ == 0) {
+            host_running_ = false;
+        }
+    }
     return ESP_OK;
 }
 
@@ -503,10 +667,15 @@ esp_err_t Esp32UsbTransport::find_and_open_device() {
     
     ESP_LOGI(ESP32_USB_TAG, "USB client registered (handle=0x%p), waiting for device connection events...", 
              device_.client_hdl);
+    // The client task sleeps until there is a client to service
+    if (usb_client_task_handle_) {
+        xTaskNotifyGive(usb_client_task_handle_);
+    }
     
-    // Force immediate device enumeration check in addition to event-driven detection
+    // Devices enumerated before the client registered get no NEW_DEV event, so
+    // open them here. One that finishes enumerating meanwhile is reported both
+    // ways; handle_new_device_locked() ignores the second.
     ESP_LOGI(ESP32_USB_TAG, "Performing immediate device enumeration check...");
-    vTaskDelay(pdMS_TO_TICKS(100)); // Small delay for USB stack to stabilize
     
     int num_dev = 10;
     uint8_t dev_addr_list[10];
@@ -515,7 +684,7 @@ esp_err_t Esp32UsbTransport::find_and_open_device() {
         ESP_LOGI(ESP32_USB_TAG, "Found %d existing USB devices during initial enumeration:", num_dev);
         for (int i = 0; i < num_dev; i++) {
             ESP_LOGI(ESP32_USB_TAG, "  Attempting to handle existing device at address %d", dev_addr_list[i]);
-            handle_new_device(dev_addr_list[i]);
+            handle_new_device_locked(dev_addr_list[i]);
         }
     } else {
         ESP_LOGI(ESP32_USB_TAG, "No existing USB devices found - waiting for connection events");
@@ -532,20 +701,23 @@ esp_err_t Esp32UsbTransport::claim_interface() {
         return ret;
     }
     
-    // Find HID interface
+    // Find the HID interface; boot keyboards and mice on the same hub are
+    // never power devices, so leave them for other hosts
     const usb_intf_desc_t *intf_desc = nullptr;
-    int offset = 0;
+    bool found = false;
     
-    for (int i = 0; i < config_desc->bNumInterfaces; i++) {
+    for (int i = 0; i < config_desc->bNumInterfaces && !found; i++) {
+        int offset = 0;
         intf_desc = usb_parse_interface_descriptor(config_desc, i, 0, &offset);
-        if (intf_desc && intf_desc->bInterfaceClass == USB_CLASS_HID) {
+        if (intf_desc && intf_desc->bInterfaceClass == USB_CLASS_HID &&
+            intf_desc->bInterfaceProtocol == 0) {
             device_.interface_num = intf_desc->bInterfaceNumber;
-            break;
+            found = true;
         }
     }
     
-    if (!intf_desc || intf_desc->bInterfaceClass != USB_CLASS_HID) {
-        set_last_error("No HID interface found");
+    if (!found) {
+        set_last_error("No HID power device interface found");
         return ESP_ERR_NOT_FOUND;
     }
     
@@ -556,6 +728,14 @@ esp_err_t Esp32UsbTransport::claim_interface() {
         return ret;
     }
     
+    // Transfers are not bound to a device handle, so the pool survives reconnects
+    ret = allocate_control_pool();
+    if (ret != ESP_OK) {
+        usb_host_interface_release(device_.client_hdl, device_.dev_hdl, device_.interface_num);
+        return ret;
+    }
+    device_.interface_claimed = true;
+    
     return ESP_OK;
 }
 
@@ -575,11 +755,37 @@ esp_err_t Esp32UsbTransport::find_endpoints() {
         return ESP_ERR_NOT_FOUND;
     }
     
+    // The HID class descriptor follows the interface descriptor and gives the
+    // report descriptor length needed for GET_DESCRIPTOR
+    device_.report_descriptor_length = 0;
+    const uint8_t *raw = reinterpret_cast<const uint8_t*>(config_desc);
+    for (int pos = offset + intf_desc->bLength; pos + 2 <= config_desc->wTotalLength;) {
+        const uint8_t length = raw[pos];
+        const uint8_t type = raw[pos + 1];
+        if (length < 2 || type == USB_B_DESCRIPTOR_TYPE_INTERFACE) {
+            break;
+        }
+        if (type == HID_DESCRIPTOR_TYPE_HID && length >= 9 && pos + length <= config_desc->wTotalLength) {
+            // bNumDescriptors at byte 5, then (bDescriptorType, wDescriptorLength) triples
+            const uint8_t num_descriptors = raw[pos + 5];
+            for (uint8_t d = 0; d < num_descriptors && 6 + d * 3 + 3 <= length; d++) {
+                const uint8_t *entry = raw + pos + 6 + d * 3;
+                if (entry[0] == HID_DESCRIPTOR_TYPE_REPORT) {
+                    device_.report_descriptor_length = entry[1] | (entry[2] << 8);
+                    break;
+                }
+            }
+            UPS_HID_LOGD(ESP32_USB_TAG, "HID report descriptor length: %u", device_.report_descriptor_length);
+            break;
+        }
+        pos += length;
+    }
+    
     // Parse endpoints correctly using ESP-IDF approach
     const usb_ep_desc_t *ep_desc = nullptr;
     int ep_offset = offset;
     
-    ESP_LOGD(ESP32_USB_TAG, "Interface has %d endpoints", intf_desc->bNumEndpoints);
+    UPS_HID_LOGD(ESP32_USB_TAG, "Interface has %d endpoints", intf_desc->bNumEndpoints);
     
     for (int i = 0; i < intf_desc->bNumEndpoints; i++) {
         ep_desc = usb_parse_endpoint_descriptor_by_index(intf_desc, i, config_desc->wTotalLength, &ep_offset);
@@ -588,13 +794,13 @@ esp_err_t Esp32UsbTransport::find_endpoints() {
                 // IN endpoint (device to host)
                 device_.ep_in = ep_desc->bEndpointAddress;
                 device_.max_packet_size_in = ep_desc->wMaxPacketSize;
-                ESP_LOGD(ESP32_USB_TAG, "Found IN endpoint: 0x%02X (max packet size: %d)",
+                UPS_HID_LOGD(ESP32_USB_TAG, "Found IN endpoint: 0x%02X (max packet size: %d)",
                          device_.ep_in, device_.max_packet_size_in);
             } else {
                 // OUT endpoint (host to device)
                 device_.ep_out = ep_desc->bEndpointAddress;
                 device_.max_packet_size_out = ep_desc->wMaxPacketSize;
-                ESP_LOGD(ESP32_USB_TAG, "Found OUT endpoint: 0x%02X (max packet size: %d)",
+                UPS_HID_LOGD(ESP32_USB_TAG, "Found OUT endpoint: 0x%02X (max packet size: %d)",
                          device_.ep_out, device_.max_packet_size_out);
             }
         } else {
@@ -612,70 +818,489 @@ esp_err_t Esp32UsbTransport::find_endpoints() {
         ESP_LOGW(ESP32_USB_TAG, "INPUT-ONLY HID device detected - no OUT endpoint available");
         ESP_LOGI(ESP32_USB_TAG, "Device supports HID GET_REPORT only (no SET_REPORT)");
     } else {
-        ESP_LOGD(ESP32_USB_TAG, "Bidirectional device detected - has both IN and OUT endpoints");
+        UPS_HID_LOGD(ESP32_USB_TAG, "Bidirectional device detected - has both IN and OUT endpoints");
     }
     
     return ESP_OK;
 }
 
+esp_err_t Esp32UsbTransport::allocate_control_pool() {
+    {
+        std::lock_guard<std::mutex> lock(control_pool_mutex_);
+        if (control_pool_allocated_) {
+            return ESP_OK;
+        }
+        
+        esp_err_t ret = ESP_OK;
+        for (auto &slot : control_pool_) {
+            // Kept by free_control_pool() because it was still busy at teardown
+            if (slot.transfer && slot.done) {
+                continue;
+            }
+            ret = usb_host_transfer_alloc(CONTROL_TRANSFER_BUFFER_SIZE, 0, &slot.transfer);
+            if (ret != ESP_OK) {
+                break;
+            }
+            slot.done = xSemaphoreCreateBinary();
+            if (!slot.done) {
+                ret = ESP_ERR_NO_MEM;
+                break;
+            }
+            slot.transfer->context = &slot;
+            slot.transfer->callback = control_transfer_callback;
+            slot.transfer->bEndpointAddress = 0; // Control endpoint
+            slot.in_flight = false;
+            slot.in_use = false;
+        }
+        
+        // Mark allocated even on partial failure so free_control_pool() cleans up
+        control_pool_allocated_ = true;
+        if (ret == ESP_OK) {
+            UPS_HID_LOGD(ESP32_USB_TAG, "Allocated %zu control transfers of %zu bytes",
+                     limits::CONTROL_TRANSFER_POOL_SIZE, CONTROL_TRANSFER_BUFFER_SIZE);
+            return ESP_OK;
+        }
+        set_last_error("Failed to allocate control transfer pool: " + std::string(esp_err_to_name(ret)));
+    }
+    
+    free_control_pool();
+    return ESP_ERR_NO_MEM;
+}
+
+void Esp32UsbTransport::free_control_pool() {
+    std::lock_guard<std::mutex> lock(control_pool_mutex_);
+    if (!control_pool_allocated_) {
+        return;
+    }
+    
+    for (auto &slot : control_pool_) {
+        // The stack refuses to free a transfer it still owns, and a caller may
+        // still be waiting on done: leak the slot rather than pull it away.
+        // It becomes usable again once it settles.
+        if (slot.in_flight || slot.in_use) {
+            ESP_LOGW(ESP32_USB_TAG, "Control transfer still %s at teardown, keeping it",
+                     slot.in_flight ? "in flight" : "in use");
+            continue;
+        }
+        if (slot.transfer) {
+            usb_host_transfer_free(slot.transfer);
+            slot.transfer = nullptr;
+        }
+        if (slot.done) {
+            vSemaphoreDelete(slot.done);
+            slot.done = nullptr;
+        }
+    }
+    
+    control_pool_allocated_ = false;
+}
+
+bool Esp32UsbTransport::transfers_idle() const {
+    if (interrupt_in_flight_.load() || descriptor_slot_.in_flight.load()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(control_pool_mutex_);
+    if (descriptor_slot_.in_use) {
+        return false;
+    }
+    for (const auto &slot : control_pool_) {
+        if (slot.in_use || slot.in_flight) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Esp32UsbTransport::free_descriptor_slot() {
+    std::lock_guard<std::mutex> lock(control_pool_mutex_);
+    // Same as free_control_pool(): a busy transfer is kept, not freed under its owner
+    if (descriptor_slot_.in_flight || descriptor_slot_.in_use) {
+        ESP_LOGW(ESP32_USB_TAG, "Report descriptor transfer still busy at teardown, keeping it");
+        return;
+    }
+    if (descriptor_slot_.transfer) {
+        usb_host_transfer_free(descriptor_slot_.transfer);
+        descriptor_slot_.transfer = nullptr;
+    }
+    if (descriptor_slot_.done) {
+        vSemaphoreDelete(descriptor_slot_.done);
+        descriptor_slot_.done = nullptr;
+    }
+}
+
+void Esp32UsbTransport::set_descriptor_slot_in_use(bool in_use) {
+    std::lock_guard<std::mutex> lock(control_pool_mutex_);
+    descriptor_slot_.in_use = in_use;
+}
+
+Esp32UsbTransport::ControlTransferSlot* Esp32UsbTransport::acquire_control_slot() {
+    std::lock_guard<std::mutex> lock(control_pool_mutex_);
+    if (!control_pool_allocated_) {
+        return nullptr;
+    }
+    
+    for (auto &slot : control_pool_) {
+        // A slot abandoned on timeout stays in flight until its callback fires
+        if (slot.in_use || slot.in_flight || !slot.transfer || !slot.done) {
+            continue;
+        }
+        // Drop a completion that arrived after its waiter gave up
+        xSemaphoreTake(slot.done, 0);
+        slot.in_use = true;
+        control_pool_stats_.acquired++;
+        control_pool_stats_.in_use++;
+        if (control_pool_stats_.in_use > control_pool_stats_.high_water) {
+            control_pool_stats_.high_water = control_pool_stats_.in_use;
+        }
+        return &slot;
+    }
+    
+    control_pool_stats_.exhausted++;
+    return nullptr;
+}
+
+void Esp32UsbTransport::release_control_slot(ControlTransferSlot* slot) {
+    std::lock_guard<std::mutex> lock(control_pool_mutex_);
+    slot->in_use = false;
+    control_pool_stats_.in_use--;
+}
+
+void Esp32UsbTransport::control_transfer_callback(usb_transfer_t* transfer) {
+    auto *slot = static_cast<ControlTransferSlot*>(transfer->context);
+    slot->in_flight = false;
+    xSemaphoreGive(slot->done);
+}
+
 esp_err_t Esp32UsbTransport::submit_control_transfer(uint8_t bmRequestType, uint8_t bRequest,
-                                                   uint16_t wValue, uint16_t wIndex,
-                                                   uint8_t* data, size_t data_len,
-                                                   uint32_t timeout_ms) {
-    std::lock_guard<std::mutex> lock(device_mutex_);
+                                                     uint16_t wValue, uint16_t wIndex,
+                                                     uint8_t* data, size_t data_len,
+                                                     uint32_t timeout_ms, size_t* actual_len) {
+    ControlRequest request;
+    request.bmRequestType = bmRequestType;
+    request.bRequest = bRequest;
+    request.wValue = wValue;
+    request.wIndex = wIndex;
+    request.data = data;
+    request.data_len = data_len;
+    
+    esp_err_t ret = submit_control_requests(&request, 1, timeout_ms);
+    if (actual_len) {
+        *actual_len = request.actual_len;
+    }
+    return ret;
+}
+
+esp_err_t Esp32UsbTransport::submit_control_requests(ControlRequest* requests, size_t count,
+                                                     uint32_t timeout_ms) {
+    for (size_t i = 0; i < count; i++) {
+        requests[i].actual_len = 0;
+        requests[i].result = requests[i].data_len > CONTROL_TRANSFER_BUFFER_SIZE - sizeof(usb_setup_packet_t)
+                                 ? ESP_ERR_INVALID_SIZE
+                                 : ESP_ERR_TIMEOUT;
+    }
     
-    if (!device_.dev_hdl) {
+    usb_host_client_handle_t client_hdl;
+    usb_device_handle_t dev_hdl;
+    {
+        std::lock_guard<std::mutex> lock(device_mutex_);
+        client_hdl = device_.client_hdl;
+        dev_hdl = device_.dev_hdl;
+    }
+    if (!client_hdl || !dev_hdl) {
+        for (size_t i = 0; i < count; i++) {
+            requests[i].result = ESP_ERR_INVALID_STATE;
+        }
         return ESP_ERR_INVALID_STATE;
     }
     
-    usb_transfer_t *transfer;
-    esp_err_t ret = usb_host_transfer_alloc(sizeof(usb_setup_packet_t) + data_len, 0, &transfer);
-    if (ret != ESP_OK) {
-        set_last_error("Transfer alloc failed: " + std::string(esp_err_to_name(ret)));
-        return ret;
+    // In-flight requests in submission order; EP0 completes them in that order,
+    // so waiting on the oldest never delays gathering a later completion
+    struct InFlight {
+        ControlTransferSlot *slot;
+        ControlRequest *request;
+    };
+    InFlight window[limits::CONTROL_TRANSFER_POOL_SIZE];
+    size_t head = 0;
+    size_t in_flight = 0;
+    size_t next = 0;
+    bool pipelined = false;
+    const TickType_t budget = std::max<TickType_t>(pdMS_TO_TICKS(timeout_ms), 1);
+    const TickType_t started = xTaskGetTickCount();
+    
+    while (next < count || in_flight > 0) {
+        const TickType_t elapsed = xTaskGetTickCount() - started;
+        const TickType_t remaining = elapsed < budget ? budget - elapsed : 0;
+        
+        // Keep the control pipe queued while budget remains
+        while (next < count && in_flight < limits::CONTROL_TRANSFER_POOL_SIZE && remaining > 0) {
+            ControlRequest &request = requests[next];
+            if (request.result == ESP_ERR_INVALID_SIZE) {
+                next++;
+                continue;
+            }
+            ControlTransferSlot *slot = acquire_control_slot();
+            if (!slot) {
+                break;
+            }
+            request.result = start_control_transfer(slot, client_hdl, dev_hdl, request.bmRequestType,
+                                                    request.bRequest, request.wValue, request.wIndex,
+                                                    request.data, request.data_len, timeout_ms);
+            next++;
+            if (request.result != ESP_OK) {
+                release_control_slot(slot);
+                continue;
+            }
+            window[(head + in_flight) % limits::CONTROL_TRANSFER_POOL_SIZE] = {slot, &request};
+            in_flight++;
+            pipelined |= in_flight > 1;
+        }
+        
+        if (in_flight == 0) {
+            if (next < count && remaining > 0) {
+                // Every slot is held by abandoned transfers the stack still owns
+                ESP_LOGW(ESP32_USB_TAG, "No control transfer available (pool exhausted or not allocated)");
+                for (; next < count; next++) {
+                    if (requests[next].result != ESP_ERR_INVALID_SIZE) {
+                        requests[next].result = ESP_ERR_NO_MEM;
+                    }
+                }
+            }
+            // Requests never started because the budget ran out keep ESP_ERR_TIMEOUT
+            break;
+        }
+        
+        InFlight &oldest = window[head];
+        oldest.request->result = finish_control_transfer(oldest.slot, remaining, oldest.request->bmRequestType,
+                                                         oldest.request->data, oldest.request->data_len,
+                                                         &oldest.request->actual_len);
+        if (oldest.request->result == ESP_ERR_TIMEOUT) {
+            std::lock_guard<std::mutex> lock(control_pool_mutex_);
+            control_pool_stats_.abandoned++;
+        }
+        release_control_slot(oldest.slot);
+        head = (head + 1) % limits::CONTROL_TRANSFER_POOL_SIZE;
+        in_flight--;
+    }
+    
+    if (pipelined) {
+        std::lock_guard<std::mutex> lock(control_pool_mutex_);
+        control_pool_stats_.batches++;
     }
     
-    // Setup packet
-    usb_setup_packet_t *setup = (usb_setup_packet_t *)transfer->data_buffer;
+    for (size_t i = 0; i < count; i++) {
+        if (requests[i].result != ESP_OK) {
+            return requests[i].result;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t Esp32UsbTransport::start_control_transfer(ControlTransferSlot* slot,
+                                                    usb_host_client_handle_t client_hdl,
+                                                    usb_device_handle_t dev_hdl,
+                                                    uint8_t bmRequestType, uint8_t bRequest,
+                                                    uint16_t wValue, uint16_t wIndex,
+                                                    const uint8_t* data, size_t data_len,
+                                                    uint32_t timeout_ms) {
+    const bool is_in = (bmRequestType & USB_BM_REQUEST_TYPE_DIR_IN) != 0;
+    usb_transfer_t *transfer = slot->transfer;
+    if (sizeof(usb_setup_packet_t) + data_len > transfer->data_buffer_size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    usb_setup_packet_t *setup = reinterpret_cast<usb_setup_packet_t*>(transfer->data_buffer);
     setup->bmRequestType = bmRequestType;
     setup->bRequest = bRequest;
     setup->wValue = wValue;
     setup->wIndex = wIndex;
     setup->wLength = data_len;
     
-    if (data_len > 0 && data) {
-        if (bmRequestType & USB_BM_REQUEST_TYPE_DIR_IN) {
-            // IN transfer - device to host
-            memset(transfer->data_buffer + sizeof(usb_setup_packet_t), 0, data_len);
-        } else {
-            // OUT transfer - host to device
-            memcpy(transfer->data_buffer + sizeof(usb_setup_packet_t), data, data_len);
-        }
+    if (!is_in && data && data_len > 0) {
+        memcpy(transfer->data_buffer + sizeof(usb_setup_packet_t), data, data_len);
     }
     
-    transfer->device_handle = device_.dev_hdl;
-    transfer->bEndpointAddress = 0; // Control endpoint
-    transfer->callback = nullptr;
-    transfer->context = nullptr;
+    transfer->device_handle = dev_hdl;
     transfer->num_bytes = sizeof(usb_setup_packet_t) + data_len;
     transfer->timeout_ms = timeout_ms;
     
-    ret = usb_host_transfer_submit_control(device_.client_hdl, transfer);
+    slot->in_flight = true;
+    esp_err_t ret = usb_host_transfer_submit_control(client_hdl, transfer);
+    if (ret != ESP_OK) {
+        slot->in_flight = false;
+        ESP_LOGW(ESP32_USB_TAG, "Failed to submit control transfer: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+esp_err_t Esp32UsbTransport::finish_control_transfer(ControlTransferSlot* slot, TickType_t wait,
+                                                     uint8_t bmRequestType, uint8_t* data, size_t data_len,
+                                                     size_t* actual_len) {
+    if (xSemaphoreTake(slot->done, wait) != pdTRUE) {
+        // Leave the slot in flight; it becomes reusable once the stack completes it
+        return ESP_ERR_TIMEOUT;
+    }
+    
+    usb_transfer_t *transfer = slot->transfer;
+    if (transfer->status != USB_TRANSFER_STATUS_COMPLETED) {
+        UPS_HID_LOGD(ESP32_USB_TAG, "Control transfer status: %d", transfer->status);
+        return ESP_FAIL;
+    }
+    
+    size_t payload_len = transfer->actual_num_bytes > static_cast<int>(sizeof(usb_setup_packet_t))
+                             ? transfer->actual_num_bytes - sizeof(usb_setup_packet_t)
+                             : 0;
+    payload_len = std::min(payload_len, data_len);
+    if ((bmRequestType & USB_BM_REQUEST_TYPE_DIR_IN) && data && payload_len > 0) {
+        memcpy(data, transfer->data_buffer + sizeof(usb_setup_packet_t), payload_len);
+    }
+    if (actual_len) {
+        *actual_len = payload_len;
+    }
+    return ESP_OK;
+}
+
+esp_err_t Esp32UsbTransport::execute_control_transfer(ControlTransferSlot* slot,
+                                                      usb_host_client_handle_t client_hdl,
+                                                      usb_device_handle_t dev_hdl,
+                                                      uint8_t bmRequestType, uint8_t bRequest,
+                                                      uint16_t wValue, uint16_t wIndex,
+                                                      uint8_t* data, size_t data_len,
+                                                      uint32_t timeout_ms, size_t* actual_len) {
+    esp_err_t ret = start_control_transfer(slot, client_hdl, dev_hdl, bmRequestType, bRequest,
+                                           wValue, wIndex, data, data_len, timeout_ms);
     if (ret != ESP_OK) {
-        usb_host_transfer_free(transfer);
-        set_last_error("Control transfer submit failed: " + std::string(esp_err_to_name(ret)));
         return ret;
     }
+    return finish_control_transfer(slot, pdMS_TO_TICKS(timeout_ms), bmRequestType, data, data_len, actual_len);
+}
+
+esp_err_t Esp32UsbTransport::submit_interrupt_in() {
+    if (interrupt_in_flight_.load() || !device_.dev_hdl || device_.ep_in == 0) {
+        return ESP_OK;
+    }
+    
+    if (!interrupt_transfer_) {
+        esp_err_t ret = usb_host_transfer_alloc(limits::MAX_HID_REPORT_SIZE, 0, &interrupt_transfer_);
+        if (ret != ESP_OK) {
+            ESP_LOGW(ESP32_USB_TAG, "Failed to allocate interrupt transfer: %s", esp_err_to_name(ret));
+            interrupt_transfer_ = nullptr;
+            return ret;
+        }
+        interrupt_transfer_->callback = interrupt_transfer_callback;
+        interrupt_transfer_->context = this;
+    }
     
-    // Copy response data back
-    if (data_len > 0 && data && (bmRequestType & USB_BM_REQUEST_TYPE_DIR_IN)) {
-        memcpy(data, transfer->data_buffer + sizeof(usb_setup_packet_t), data_len);
+    // IN transfers must be a multiple of wMaxPacketSize; HID reports fit in one packet
+    size_t packet_size = device_.max_packet_size_in;
+    if (packet_size == 0 || packet_size > limits::MAX_HID_REPORT_SIZE) {
+        packet_size = limits::MAX_HID_REPORT_SIZE;
     }
     
-    usb_host_transfer_free(transfer);
+    interrupt_transfer_->device_handle = device_.dev_hdl;
+    interrupt_transfer_->bEndpointAddress = device_.ep_in;
+    interrupt_transfer_->num_bytes = packet_size;
+    interrupt_transfer_->timeout_ms = 0;  // Interrupt transfers wait for the device
+    
+    interrupt_in_flight_ = true;
+    esp_err_t ret = usb_host_transfer_submit(interrupt_transfer_);
+    if (ret != ESP_OK) {
+        interrupt_in_flight_ = false;
+        ESP_LOGW(ESP32_USB_TAG, "Failed to submit interrupt IN transfer: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    UPS_HID_LOGV(ESP32_USB_TAG, "Interrupt IN transfer submitted on EP 0x%02X", device_.ep_in);
     return ESP_OK;
 }
 
+void Esp32UsbTransport::cancel_interrupt_in() {
+    if (!interrupt_in_flight_.load() || !device_.dev_hdl) {
+        return;
+    }
+    // Halting and flushing returns the pending transfer through its callback
+    // with a cancelled status; clearing makes the endpoint usable again
+    usb_host_endpoint_halt(device_.dev_hdl, device_.ep_in);
+    usb_host_endpoint_flush(device_.dev_hdl, device_.ep_in);
+    usb_host_endpoint_clear(device_.dev_hdl, device_.ep_in);
+}
+
+void Esp32UsbTransport::interrupt_transfer_callback(usb_transfer_t* transfer) {
+    auto *transport = static_cast<Esp32UsbTransport*>(transfer->context);
+    transport->interrupt_in_flight_ = false;
+    
+    switch (transfer->status) {
+        case USB_TRANSFER_STATUS_COMPLETED:
+            if (transfer->actual_num_bytes > 0) {
+                transport->handle_input_report(transfer);
+            }
+            break;
+        case USB_TRANSFER_STATUS_TIMED_OUT:
+            break;
+        case USB_TRANSFER_STATUS_CANCELED:
+        case USB_TRANSFER_STATUS_NO_DEVICE:
+            UPS_HID_LOGD(ESP32_USB_TAG, "Interrupt IN transfer ended (status %d)", transfer->status);
+            return;
+        default:
+            // Leave recovery to GET_REPORT polling; streaming restarts on reconnect
+            ESP_LOGW(ESP32_USB_TAG, "Interrupt IN transfer failed (status %d), streaming paused",
+                     transfer->status);
+            return;
+    }
+    
+    if (transport->streaming_enabled_.load() && transport->connected_.load()) {
+        std::lock_guard<std::mutex> lock(transport->device_mutex_);
+        transport->submit_interrupt_in();
+    }
+}
+
+void Esp32UsbTransport::handle_input_report(const usb_transfer_t* transfer) {
+    // Multi-report HID devices (all HID PDC UPSes) prefix each report with its ID
+    const uint8_t report_id = transfer->data_buffer[0];
+    const size_t length = std::min(static_cast<size_t>(transfer->actual_num_bytes),
+                                   limits::MAX_HID_REPORT_SIZE);
+    
+    {
+        std::lock_guard<std::mutex> lock(input_cache_mutex_);
+        // Reuse the entry for this ID, else a free one, else evict the oldest
+        InputReportEntry *target = nullptr;
+        InputReportEntry *free_entry = nullptr;
+        InputReportEntry *oldest = &input_report_cache_[0];
+        for (auto &entry : input_report_cache_) {
+            if (!entry.valid) {
+                if (!free_entry) free_entry = &entry;
+                continue;
+            }
+            if (entry.report_id == report_id) {
+                target = &entry;
+                break;
+            }
+            if (entry.received_ms < oldest->received_ms) {
+                oldest = &entry;
+            }
+        }
+        if (!target) {
+            target = free_entry;
+        }
+        if (!target) {
+            target = oldest;
+            interrupt_reports_evicted_++;
+        }
+        
+        target->report_id = report_id;
+        target->length = length;
+        target->received_ms = millis();
+        target->valid = true;
+        memcpy(target->data, transfer->data_buffer, length);
+        interrupt_reports_received_++;
+    }
+    
+    UPS_HID_LOGV(ESP32_USB_TAG, "Interrupt IN report 0x%02X: %zu bytes", report_id, length);
+    
+    if (input_report_callback_) {
+        input_report_callback_(report_id);
+    }
+}
+
 void Esp32UsbTransport::usb_client_event_callback(const usb_host_client_event_msg_t* event_msg, void* arg) {
     Esp32UsbTransport* transport = static_cast<Esp32UsbTransport*>(arg);
     
@@ -697,20 +1322,33 @@ void Esp32UsbTransport::usb_client_event_callback(const usb_host_client_event_ms
 }
 
 void Esp32UsbTransport::handle_new_device(uint8_t dev_addr) {
-    ESP_LOGI(ESP32_USB_TAG, "Handling new USB device at address %d", dev_addr);
-    
     std::lock_guard<std::mutex> lock(device_mutex_);
+    handle_new_device_locked(dev_addr);
+}
+
+void Esp32UsbTransport::handle_new_device_locked(uint8_t dev_addr) {
+    ESP_LOGI(ESP32_USB_TAG, "Handling new USB device at address %d", dev_addr);
     
     // Check if we already have a device connected
     if (device_.dev_hdl != nullptr) {
-        ESP_LOGW(ESP32_USB_TAG, "Device already connected - skipping new device at address %d", dev_addr);
+        UPS_HID_LOGD(ESP32_USB_TAG, "Device already connected - skipping new device at address %d", dev_addr);
+        return;
+    }
+    
+    // Every instance sees every new device; only one may bind it
+    if (!claim_address(dev_addr)) {
+        UPS_HID_LOGD(ESP32_USB_TAG, "Device at address %d is bound to another UPS", dev_addr);
         return;
     }
+    device_.address = dev_addr;
     
     // Open the device
     esp_err_t ret = usb_host_device_open(device_.client_hdl, dev_addr, &device_.dev_hdl);
     if (ret != ESP_OK) {
         ESP_LOGE(ESP32_USB_TAG, "Failed to open device at address %d: %s", dev_addr, esp_err_to_name(ret));
+        device_.dev_hdl = nullptr;
+        release_address(dev_addr);
+        device_.address = 0;
         return;
     }
     
@@ -721,12 +1359,10 @@ void Esp32UsbTransport::handle_new_device(uint8_t dev_addr) {
     ret = usb_host_device_info(device_.dev_hdl, &dev_info);
     if (ret != ESP_OK) {
         ESP_LOGE(ESP32_USB_TAG, "Failed to get device info: %s", esp_err_to_name(ret));
-        usb_host_device_close(device_.client_hdl, device_.dev_hdl);
-        device_.dev_hdl = nullptr;
+        close_device();
         return;
     }
     
-    device_.address = dev_addr;
     device_.speed = dev_info.speed;
     
     // Get device descriptor to extract VID/PID
@@ -735,12 +1371,16 @@ void Esp32UsbTransport::handle_new_device(uint8_t dev_addr) {
     if (ret == ESP_OK) {
         device_.vendor_id = device_desc->idVendor;
         device_.product_id = device_desc->idProduct;
+        device_.serial_index = device_desc->iSerialNumber;
         
         ESP_LOGI(ESP32_USB_TAG, "USB device opened: VID=0x%04X, PID=0x%04X, Speed=%d", 
                  device_.vendor_id, device_.product_id, dev_info.speed);
         
-        // Check if this is a UPS device (HID class)
-        if (device_desc->bDeviceClass == USB_CLASS_HID || 
+        if ((vendor_id_filter_ != 0 && device_.vendor_id != vendor_id_filter_) ||
+            (product_id_filter_ != 0 && device_.product_id != product_id_filter_)) {
+            UPS_HID_LOGD(ESP32_USB_TAG, "Device does not match filter %04X:%04X, leaving it for another UPS",
+                     vendor_id_filter_, product_id_filter_);
+        } else if (device_desc->bDeviceClass == USB_CLASS_HID || 
             device_desc->bDeviceClass == 0x00) { // Device class defined at interface level
             
             // Try to claim HID interface and find endpoints
@@ -748,8 +1388,15 @@ void Esp32UsbTransport::handle_new_device(uint8_t dev_addr) {
             if (ret == ESP_OK) {
                 ret = find_endpoints();
                 if (ret == ESP_OK) {
+                    connection_id_++;
                     connected_ = true;
                     ESP_LOGI(ESP32_USB_TAG, "UPS device successfully configured and ready");
+                    if (streaming_enabled_.load()) {
+                        submit_interrupt_in();
+                    }
+                    if (connection_callback_) {
+                        connection_callback_(true);
+                    }
                     return;
                 }
             }
@@ -759,8 +1406,38 @@ void Esp32UsbTransport::handle_new_device(uint8_t dev_addr) {
     }
     
     // Clean up on failure
-    usb_host_device_close(device_.client_hdl, device_.dev_hdl);
-    device_.dev_hdl = nullptr;
+    close_device();
+}
+
+void Esp32UsbTransport::close_device() {
+    if (device_.dev_hdl) {
+        cancel_interrupt_in();
+        if (device_.interface_claimed) {
+            usb_host_interface_release(device_.client_hdl, device_.dev_hdl, device_.interface_num);
+            device_.interface_claimed = false;
+        }
+        usb_host_device_close(device_.client_hdl, device_.dev_hdl);
+        device_.dev_hdl = nullptr;
+    }
+    connected_ = false;
+    if (device_.address != 0) {
+        release_address(device_.address);
+    }
+    device_.address = 0;
+    device_.vendor_id = 0;
+    device_.product_id = 0;
+    device_.serial_index = 0;
+    device_.report_descriptor_length = 0;
+}
+
+bool Esp32UsbTransport::claim_address(uint8_t dev_addr) {
+    std::lock_guard<std::mutex> lock(host_mutex_);
+    return claimed_addresses_.insert(dev_addr).second;
+}
+
+void Esp32UsbTransport::release_address(uint8_t dev_addr) {
+    std::lock_guard<std::mutex> lock(host_mutex_);
+    claimed_addresses_.erase(dev_addr);
 }
 
 void Esp32UsbTransport::handle_device_gone(usb_device_handle_t dev_hdl) {
@@ -768,28 +1445,19 @@ void Esp32UsbTransport::handle_device_gone(usb_device_handle_t dev_hdl) {
     
     std::lock_guard<std::mutex> lock(device_mutex_);
     
-    if (device_.dev_hdl == dev_hdl) {
-        connected_ = false;
-        
-        // Clean up device resources
-        if (device_.dev_hdl) {
-            usb_host_interface_release(device_.client_hdl, device_.dev_hdl, device_.interface_num);
-            usb_host_device_close(device_.client_hdl, device_.dev_hdl);
-            device_.dev_hdl = nullptr;
-        }
-        
-        // Reset device info
-        device_.address = 0;
-        device_.vendor_id = 0;
-        device_.product_id = 0;
+    if (device_.dev_hdl && device_.dev_hdl == dev_hdl) {
+        // Clean up device resources and free the address for other instances
+        close_device();
+        report_descriptor_.clear();
         
         ESP_LOGI(ESP32_USB_TAG, "USB device disconnected and cleaned up");
+        if (connection_callback_) {
+            connection_callback_(false);
+        }
     }
 }
 
 void Esp32UsbTransport::usb_lib_task(void* arg) {
-    Esp32UsbTransport* transport = static_cast<Esp32UsbTransport*>(arg);
-    
     ESP_LOGI(ESP32_USB_TAG, "USB Host Library task starting...");
     
     // Initialize USB Host library inside task (following working prototype)
@@ -801,10 +1469,12 @@ void Esp32UsbTransport::usb_lib_task(void* arg) {
     esp_err_t ret = usb_host_install(&host_config);
     if (ret != ESP_OK) {
         ESP_LOGE(ESP32_USB_TAG, "USB Host install failed: %s", esp_err_to_name(ret));
-        transport->usb_tasks_running_ = false; // Stop other tasks
+        host_running_ = false;
+        xSemaphoreGive(host_ready_);
         vTaskDelete(nullptr);
         return;
     }
+    xSemaphoreGive(host_ready_);
 
     ESP_LOGI(ESP32_USB_TAG, "USB Host library installed successfully");
     
@@ -812,7 +1482,7 @@ void Esp32UsbTransport::usb_lib_task(void* arg) {
     bool has_clients = true;
     bool has_devices = false;
     
-    while (has_clients && transport->usb_tasks_running_.load()) {
+    while (has_clients && host_running_.load()) {
         uint32_t event_flags;
         ret = usb_host_lib_handle_events(portMAX_DELAY, &event_flags);
         
@@ -844,6 +1514,7 @@ void Esp32UsbTransport::usb_lib_task(void* arg) {
     usb_host_uninstall();
     
     ESP_LOGI(ESP32_USB_TAG, "USB Host Library task ending");
+    host_task_handle_ = nullptr;
     vTaskDelete(nullptr);
 }
 
@@ -853,26 +1524,24 @@ void Esp32UsbTransport::usb_client_task(void* arg) {
     ESP_LOGI(ESP32_USB_TAG, "USB client task started");
     
     while (transport->usb_tasks_running_.load()) {
-        if (transport->device_.client_hdl) {
-            // Use shorter timeout for more responsive event processing
-            esp_err_t ret = usb_host_client_handle_events(transport->device_.client_hdl, timing::USB_CLIENT_EVENT_TIMEOUT_MS);
-            
-            if (ret == ESP_ERR_TIMEOUT) {
-                // Timeout is normal - continue processing
-            } else if (ret != ESP_OK) {
-                ESP_LOGW(ESP32_USB_TAG, "USB client event handling failed: %s", esp_err_to_name(ret));
-                vTaskDelay(pdMS_TO_TICKS(100)); // Brief delay on error
-            }
-        } else {
-            ESP_LOGD(ESP32_USB_TAG, "No USB client handle available");
-            vTaskDelay(pdMS_TO_TICKS(100));
+        usb_host_client_handle_t client_hdl = transport->device_.client_hdl;
+        if (!client_hdl) {
+            // Notified by find_and_open_device() once registered, or by teardown_usb_host()
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
         }
         
-        // Small delay to prevent busy-waiting
-        vTaskDelay(pdMS_TO_TICKS(10));
+        // Sleeps until a device event or transfer completion; every queued control
+        // completion is dispatched from here. teardown_usb_host() unblocks it.
+        esp_err_t ret = usb_host_client_handle_events(client_hdl, portMAX_DELAY);
+        if (ret != ESP_OK && ret != ESP_ERR_TIMEOUT) {
+            ESP_LOGW(ESP32_USB_TAG, "USB client event handling failed: %s", esp_err_to_name(ret));
+            vTaskDelay(pdMS_TO_TICKS(100)); // Brief delay on error
+        }
     }
     
     ESP_LOGI(ESP32_USB_TAG, "USB client task stopping");
+    transport->usb_client_task_exited_ = true;
     vTaskDelete(nullptr);
 }
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "transport_interface.h"
+#include "constants_ups.h"
+#include "task_config.h"
 
 #ifdef USE_ESP32
 #include "usb/usb_host.h"
@@ -20,12 +22,19 @@ namespace ups_hid {
  * 
  * Concrete implementation using ESP-IDF USB Host API
  * Handles all ESP32-specific USB communication details
+ *
+ * Several instances may share one USB host port (e.g. behind a hub). Each
+ * registers its own host client and binds to the first HID power device that
+ * matches its VID/PID filter and is not yet bound to another instance.
  */
 class Esp32UsbTransport : public IUsbTransport {
 public:
-    Esp32UsbTransport();
+    Esp32UsbTransport(uint16_t vendor_id_filter = 0, uint16_t product_id_filter = 0);
     ~Esp32UsbTransport() override;
     
+    // Before initialize(); the host task config only applies if this instance starts the library
+    void set_task_config(const UsbTaskConfig& config) { task_config_ = config; }
+    
     // IUsbTransport implementation
     esp_err_t initialize() override;
     esp_err_t deinitialize() override;
@@ -33,11 +42,15 @@ public:
     bool is_connected() const override;
     uint16_t get_vendor_id() const override;
     uint16_t get_product_id() const override;
+    uint32_t get_connection_id() const override { return connection_id_.load(); }
+    void set_connection_callback(ConnectionCallback callback) override { connection_callback_ = std::move(callback); }
     
     esp_err_t hid_get_report(uint8_t report_type, uint8_t report_id, 
                            uint8_t* data, size_t* data_len, 
                            uint32_t timeout_ms = 1000) override;
     
+    esp_err_t hid_get_reports(HidReportRequest* requests, size_t count, uint32_t timeout_ms) override;
+    
     esp_err_t hid_set_report(uint8_t report_type, uint8_t report_id,
                            const uint8_t* data, size_t data_len,
                            uint32_t timeout_ms = 1000) override;
@@ -45,7 +58,20 @@ public:
     esp_err_t get_string_descriptor(uint8_t string_index, 
                                   std::string& result) override;
     
+    uint8_t get_serial_number_index() const override { return device_.serial_index; }
+    
+    esp_err_t get_report_descriptor(std::vector<uint8_t>& descriptor) override;
+    
     std::string get_last_error() const override;
+    
+    void dump_config() const override;
+    size_t get_memory_usage() const override;
+    uint32_t get_task_stack_free() const override { return task_stack_free(usb_client_task_handle_); }
+    
+    esp_err_t start_input_streaming(InputReportCallback callback) override;
+    void stop_input_streaming() override;
+    bool get_cached_input_report(uint8_t report_id, uint8_t* data, size_t* data_len,
+                                 uint32_t max_age_ms) const override;
 
 private:
     // USB device structure
@@ -58,44 +84,173 @@ private:
         uint8_t ep_out{0};
         uint16_t vendor_id{0};
         uint16_t product_id{0};
+        uint8_t serial_index{0};                // iSerialNumber
         uint16_t max_packet_size_in{0};
         uint16_t max_packet_size_out{0};
+        uint16_t report_descriptor_length{0};   // wDescriptorLength from the HID class descriptor
+        bool interface_claimed{false};
         usb_speed_t speed{USB_SPEED_LOW};
     };
     
     UsbDevice device_;
+    uint16_t vendor_id_filter_{0};   // 0 = any
+    uint16_t product_id_filter_{0};  // 0 = any
     mutable std::mutex device_mutex_;
     std::atomic<bool> connected_{false};
     std::atomic<bool> initialized_{false};
+    std::atomic<uint32_t> connection_id_{0};
+    ConnectionCallback connection_callback_;
+    
+    // USB Host Library management. The library is installed once for every
+    // instance: the first to start creates its task, the last to stop ends it.
+    static std::mutex host_mutex_;
+    static uint8_t host_users_;
+    static std::atomic<bool> host_running_;
+    static TaskHandle_t host_task_handle_;
+    static SemaphoreHandle_t host_ready_;         // Given by usb_lib_task once usb_host_install() returned
+    static std::set<uint8_t> claimed_addresses_;  // Devices bound to an instance, guarded by host_mutex_
     
-    // USB Host Library management
-    TaskHandle_t usb_lib_task_handle_{nullptr};
     TaskHandle_t usb_client_task_handle_{nullptr};
-    std::atomic<bool> usb_tasks_running_{false};
+    std::atomic<bool> usb_tasks_running_{false};   // This instance's client task
+    std::atomic<bool> usb_client_task_exited_{false};
+    UsbTaskConfig task_config_{
+        {usb_tasks::HOST_TASK_NAME, usb_tasks::HOST_TASK_STACK_SIZE, usb_tasks::HOST_TASK_PRIORITY},
+        {usb_tasks::CLIENT_TASK_NAME, usb_tasks::CLIENT_TASK_STACK_SIZE, usb_tasks::CLIENT_TASK_PRIORITY},
+    };
     
     // Error handling
     mutable std::mutex error_mutex_;
     std::string last_error_;
     
+    // Preallocated control transfers with reusable completion semaphores.
+    // A slot stays in_flight until the host stack calls back, even if the
+    // waiter has already given up, so its buffer is never reused early.
+    struct ControlTransferSlot {
+        usb_transfer_t *transfer{nullptr};
+        SemaphoreHandle_t done{nullptr};
+        std::atomic<bool> in_flight{false};
+        bool in_use{false};
+    };
+    
+    struct ControlPoolStats {
+        uint32_t acquired{0};
+        uint32_t batches{0};       // Request queues that kept more than one transfer in flight
+        uint32_t exhausted{0};
+        uint32_t abandoned{0};     // Waiter timed out before the callback fired
+        uint8_t in_use{0};
+        uint8_t high_water{0};
+    };
+    
+    ControlTransferSlot control_pool_[limits::CONTROL_TRANSFER_POOL_SIZE];
+    mutable std::mutex control_pool_mutex_;
+    ControlPoolStats control_pool_stats_;
+    bool control_pool_allocated_{false};
+    
+    // Interrupt-IN streaming: a single transfer kept in flight on ep_in and
+    // resubmitted from its own callback. Reports are cached by report ID.
+    struct InputReportEntry {
+        uint8_t report_id{0};
+        uint8_t length{0};
+        bool valid{false};
+        uint32_t received_ms{0};
+        uint8_t data[limits::MAX_HID_REPORT_SIZE];
+    };
+    
+    usb_transfer_t *interrupt_transfer_{nullptr};
+    std::atomic<bool> streaming_enabled_{false};
+    std::atomic<bool> interrupt_in_flight_{false};
+    InputReportCallback input_report_callback_;
+    InputReportEntry input_report_cache_[limits::INPUT_REPORT_CACHE_SIZE];
+    mutable std::mutex input_cache_mutex_;
+    uint32_t interrupt_reports_received_{0};
+    uint32_t interrupt_reports_evicted_{0};
+    
+    // Report descriptors exceed the pooled buffer size, so they are fetched
+    // once per connection on a transfer allocated for that purpose
+    ControlTransferSlot descriptor_slot_;
+    std::vector<uint8_t> report_descriptor_;
+    
     // Private methods
     static void usb_lib_task(void* arg);
     static void usb_client_task(void* arg);
     static void usb_client_event_callback(const usb_host_client_event_msg_t* event_msg, void* arg);
     
     void handle_new_device(uint8_t dev_addr);
+    void handle_new_device_locked(uint8_t dev_addr);  // Caller holds device_mutex_
     void handle_device_gone(usb_device_handle_t dev_hdl);
+    static bool claim_address(uint8_t dev_addr);
+    static void release_address(uint8_t dev_addr);
+    void close_device();  // Caller holds device_mutex_
     
     esp_err_t setup_usb_host();
-    esp_err_t teardown_usb_host();
-    esp_err_t find_and_open_device();
+    // Called with device_mutex_ held through lock; drops it while waiting on the client task
+    esp_err_t teardown_usb_host(std::unique_lock<std::mutex>& lock);
+    esp_err_t find_and_open_device();  // Caller holds device_mutex_
     esp_err_t claim_interface();
     esp_err_t find_endpoints();
     
     void set_last_error(const std::string& error);
+    
+    esp_err_t allocate_control_pool();
+    void free_control_pool();
+    ControlTransferSlot* acquire_control_slot();
+    void release_control_slot(ControlTransferSlot* slot);
+    void free_descriptor_slot();
+    void set_descriptor_slot_in_use(bool in_use);
+    // No transfer is in flight on the stack and no caller waits on a slot
+    bool transfers_idle() const;
+    static void control_transfer_callback(usb_transfer_t* transfer);
+    
+    // Callers hold device_mutex_
+    esp_err_t submit_interrupt_in();
+    void cancel_interrupt_in();
+    static void interrupt_transfer_callback(usb_transfer_t* transfer);
+    void handle_input_report(const usb_transfer_t* transfer);
+    
+    // One entry of a control request queue. For IN requests, data receives
+    // up to data_len bytes and actual_len the received length.
+    struct ControlRequest {
+        uint8_t bmRequestType{0};
+        uint8_t bRequest{0};
+        uint16_t wValue{0};
+        uint16_t wIndex{0};
+        uint8_t *data{nullptr};
+        size_t data_len{0};
+        size_t actual_len{0};
+        esp_err_t result{ESP_ERR_TIMEOUT};
+    };
+    
+    // Run a queue of control requests on this device. Up to the pool size are
+    // submitted back-to-back and the host stack completes them in order while
+    // later ones are queued, all within one timeout budget. Returns the first
+    // failing request's result, or ESP_OK.
+    esp_err_t submit_control_requests(ControlRequest* requests, size_t count, uint32_t timeout_ms);
+    
+    // Single synchronous control transfer (a queue of one)
     esp_err_t submit_control_transfer(uint8_t bmRequestType, uint8_t bRequest,
                                     uint16_t wValue, uint16_t wIndex,
                                     uint8_t* data, size_t data_len,
-                                    uint32_t timeout_ms);
+                                    uint32_t timeout_ms, size_t* actual_len = nullptr);
+    
+    // Fill and submit a control transfer on an acquired slot
+    esp_err_t start_control_transfer(ControlTransferSlot* slot,
+                                   usb_host_client_handle_t client_hdl, usb_device_handle_t dev_hdl,
+                                   uint8_t bmRequestType, uint8_t bRequest,
+                                   uint16_t wValue, uint16_t wIndex,
+                                   const uint8_t* data, size_t data_len, uint32_t timeout_ms);
+    
+    // Wait up to wait ticks for a started transfer and copy out IN data
+    esp_err_t finish_control_transfer(ControlTransferSlot* slot, TickType_t wait,
+                                    uint8_t bmRequestType, uint8_t* data, size_t data_len,
+                                    size_t* actual_len);
+    
+    // Runs one control transfer on an acquired slot; the caller releases it
+    esp_err_t execute_control_transfer(ControlTransferSlot* slot,
+                                     usb_host_client_handle_t client_hdl, usb_device_handle_t dev_hdl,
+                                     uint8_t bmRequestType, uint8_t bRequest,
+                                     uint16_t wValue, uint16_t wIndex,
+                                     uint8_t* data, size_t data_len,
+                                     uint32_t timeout_ms, size_t* actual_len);
 };
 
 } // namespace ups_hid
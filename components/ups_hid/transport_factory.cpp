@@ -8,14 +8,22 @@
 namespace esphome {
 namespace ups_hid {
 
-std::unique_ptr<IUsbTransport> UsbTransportFactory::create(TransportType type, bool simulation_mode) {
+std::unique_ptr<IUsbTransport> UsbTransportFactory::create(TransportType type, bool simulation_mode,
+                                                          uint16_t vendor_id, uint16_t product_id,
+                                                          const SimulationConfig *simulation,
+                                                          const UsbTaskConfig *tasks) {
     if (simulation_mode || type == SIMULATION) {
-        return std::make_unique<SimulatedTransport>();
+        return simulation != nullptr ? std::make_unique<SimulatedTransport>(*simulation)
+                                     : std::make_unique<SimulatedTransport>();
     }
     
 #ifdef USE_ESP32
     if (type == ESP32_HARDWARE) {
-        return std::make_unique<Esp32UsbTransport>();
+        auto transport = std::make_unique<Esp32UsbTransport>(vendor_id, product_id);
+        if (tasks != nullptr) {
+            transport->set_task_config(*tasks);
+        }
+        return transport;
     }
 #endif
 
@@ -1,10 +1,13 @@
 #pragma once
 
 #include "transport_interface.h"
+#include "task_config.h"
 
 namespace esphome {
 namespace ups_hid {
 
+struct SimulationConfig;
+
 /**
  * Factory for creating USB transport instances
  */
@@ -15,8 +18,14 @@ public:
         SIMULATION
     };
     
+    // vendor_id/product_id of 0 accept any HID power device. When given,
+    // simulation configures the simulated transport and tasks places the
+    // FreeRTOS tasks of the hardware one
     static std::unique_ptr<IUsbTransport> create(TransportType type, 
-                                               bool simulation_mode = false);
+                                               bool simulation_mode = false,
+                                               uint16_t vendor_id = 0, uint16_t product_id = 0,
+                                               const SimulationConfig *simulation = nullptr,
+                                               const UsbTaskConfig *tasks = nullptr);
 };
 
 } // namespace ups_hid
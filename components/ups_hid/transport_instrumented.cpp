@@ -0,0 +1,175 @@
+#include "transport_instrumented.h"
+#include "esphome/core/log.h"
+#include "esphome/core/hal.h"
+#include <algorithm>
+
+namespace esphome {
+namespace ups_hid {
+
+static const char *const INSTRUMENTED_TRANSPORT_TAG = "ups_hid.instrumentation";
+
+void LatencyHistogram::record(uint32_t elapsed_us) {
+    const uint32_t elapsed_ms = elapsed_us / 1000;
+    size_t bucket = 0;
+    while (bucket < LATENCY_BUCKET_COUNT - 1 && elapsed_ms >= LATENCY_BUCKET_BOUNDS_MS[bucket]) {
+        bucket++;
+    }
+    buckets[bucket]++;
+    max_us = std::max(max_us, elapsed_us);
+}
+
+uint32_t LatencyHistogram::count() const {
+    uint32_t total = 0;
+    for (uint32_t samples : buckets) {
+        total += samples;
+    }
+    return total;
+}
+
+uint32_t LatencyHistogram::percentile_ms(float fraction) const {
+    const uint32_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    const uint32_t target = std::max<uint32_t>(1, static_cast<uint32_t>(fraction * total + 0.5f));
+    uint32_t seen = 0;
+    for (size_t bucket = 0; bucket < LATENCY_BUCKET_COUNT - 1; bucket++) {
+        seen += buckets[bucket];
+        if (seen >= target) {
+            return LATENCY_BUCKET_BOUNDS_MS[bucket];
+        }
+    }
+    // Open bucket: the largest sample is the only bound known
+    return (max_us + 999) / 1000;
+}
+
+TransferTotals InstrumentedUsbTransport::get_totals() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return totals_;
+}
+
+bool InstrumentedUsbTransport::get_report_stats(uint8_t report_type, uint8_t report_id,
+                                                ReportTransferStats &stats) const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    const ReportTransferStats *entry = find_report(report_type, report_id);
+    if (entry == nullptr) {
+        return false;
+    }
+    stats = *entry;
+    return true;
+}
+
+size_t InstrumentedUsbTransport::get_tracked_reports(ReportTransferStats *stats, size_t max_count) const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    const size_t count = std::min(report_count_, max_count);
+    std::copy(reports_, reports_ + count, stats);
+    return count;
+}
+
+esp_err_t InstrumentedUsbTransport::hid_get_report(uint8_t report_type, uint8_t report_id,
+                                                  uint8_t* data, size_t* data_len,
+                                                  uint32_t timeout_ms) {
+    const uint32_t started = micros();
+    esp_err_t ret = inner_->hid_get_report(report_type, report_id, data, data_len, timeout_ms);
+    const uint32_t elapsed_us = micros() - started;
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    record(report_type, report_id, ret, ret == ESP_OK && data_len ? *data_len : 0, elapsed_us);
+    return ret;
+}
+
+esp_err_t InstrumentedUsbTransport::hid_get_reports(HidReportRequest* requests, size_t count, uint32_t timeout_ms) {
+    bool forwarded[limits::MAX_REPORT_BATCH] = {};
+    size_t pending = 0;
+    for (size_t i = 0; i < count && i < limits::MAX_REPORT_BATCH; i++) {
+        forwarded[i] = !requests[i].done;
+        pending += forwarded[i] ? 1 : 0;
+    }
+
+    const uint32_t started = micros();
+    esp_err_t ret = inner_->hid_get_reports(requests, count, timeout_ms);
+    const uint32_t elapsed_us = micros() - started;
+    if (pending == 0) {
+        return ret;
+    }
+
+    // Transfers of a batch are queued back to back, so individual times are
+    // not observable; each one is charged an equal share
+    const uint32_t share_us = elapsed_us / pending;
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    for (size_t i = 0; i < count && i < limits::MAX_REPORT_BATCH; i++) {
+        if (forwarded[i]) {
+            const HidReportRequest &request = requests[i];
+            record(request.report_type, request.report_id, request.result,
+                   request.result == ESP_OK ? request.length : 0, share_us);
+        }
+    }
+    return ret;
+}
+
+esp_err_t InstrumentedUsbTransport::hid_set_report(uint8_t report_type, uint8_t report_id,
+                                                  const uint8_t* data, size_t data_len,
+                                                  uint32_t timeout_ms) {
+    const uint32_t started = micros();
+    esp_err_t ret = inner_->hid_set_report(report_type, report_id, data, data_len, timeout_ms);
+    const uint32_t elapsed_us = micros() - started;
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    record(report_type, report_id, ret, ret == ESP_OK ? data_len : 0, elapsed_us);
+    return ret;
+}
+
+void InstrumentedUsbTransport::dump_config() const {
+    inner_->dump_config();
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    ESP_LOGCONFIG(INSTRUMENTED_TRANSPORT_TAG, "  Transfers: %u (%u timed out, %u failed), %u bytes",
+                  totals_.transfers, totals_.timeouts, totals_.errors, totals_.bytes);
+    for (size_t i = 0; i < report_count_; i++) {
+        const ReportTransferStats &report = reports_[i];
+        ESP_LOGCONFIG(INSTRUMENTED_TRANSPORT_TAG,
+                      "    Report 0x%02X (type %u): %u transfers, %u timeouts, %u errors, p50 %u ms, p99 %u ms, max %u us",
+                      report.report_id, report.report_type, report.transfers, report.timeouts, report.errors,
+                      report.latency.percentile_ms(0.5f), report.latency.percentile_ms(0.99f), report.latency.max_us);
+    }
+}
+
+void InstrumentedUsbTransport::record(uint8_t report_type, uint8_t report_id, esp_err_t result, size_t bytes,
+                                      uint32_t elapsed_us) {
+    totals_.transfers++;
+    totals_.bytes += bytes;
+    if (result == ESP_ERR_TIMEOUT) {
+        totals_.timeouts++;
+    } else if (result != ESP_OK) {
+        totals_.errors++;
+    }
+
+    auto *entry = const_cast<ReportTransferStats *>(find_report(report_type, report_id));
+    if (entry == nullptr) {
+        if (report_count_ == limits::INSTRUMENTED_REPORTS) {
+            return;  // Counted in the totals only
+        }
+        entry = &reports_[report_count_++];
+        entry->report_type = report_type;
+        entry->report_id = report_id;
+    }
+    entry->transfers++;
+    if (result == ESP_ERR_TIMEOUT) {
+        entry->timeouts++;
+    } else if (result != ESP_OK) {
+        entry->errors++;
+    }
+    entry->latency.record(elapsed_us);
+}
+
+const ReportTransferStats* InstrumentedUsbTransport::find_report(uint8_t report_type, uint8_t report_id) const {
+    for (size_t i = 0; i < report_count_; i++) {
+        if (reports_[i].report_type == report_type && reports_[i].report_id == report_id) {
+            return &reports_[i];
+        }
+    }
+    return nullptr;
+}
+
+} // namespace ups_hid
+} // namespace esphome
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "transport_interface.h"
+#include "constants_ups.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace ups_hid {
+
+// Upper bounds of the latency histogram buckets in ms; one more open bucket follows
+static constexpr uint16_t LATENCY_BUCKET_BOUNDS_MS[] = {1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024};
+static constexpr size_t LATENCY_BUCKET_COUNT = sizeof(LATENCY_BUCKET_BOUNDS_MS) / sizeof(LATENCY_BUCKET_BOUNDS_MS[0]) + 1;
+
+// Power-of-two latency histogram, 4 bytes per bucket
+struct LatencyHistogram {
+    uint32_t buckets[LATENCY_BUCKET_COUNT]{};
+    uint32_t max_us{0};
+
+    void record(uint32_t elapsed_us);
+    uint32_t count() const;
+    // Upper bound of the bucket reaching fraction of the samples, in ms; 0 when empty
+    uint32_t percentile_ms(float fraction) const;
+};
+
+// GET_REPORT and SET_REPORT traffic of one report
+struct ReportTransferStats {
+    uint8_t report_type{0};
+    uint8_t report_id{0};
+    uint32_t transfers{0};
+    uint32_t timeouts{0};
+    uint32_t errors{0};  // STALLs and other failures
+    LatencyHistogram latency;
+};
+
+// Totals over every report, including those beyond the per-report table
+struct TransferTotals {
+    uint32_t transfers{0};
+    uint32_t timeouts{0};
+    uint32_t errors{0};
+    uint32_t bytes{0};  // Report payload moved in both directions
+};
+
+/**
+ * Instrumented USB Transport Decorator
+ *
+ * Wraps the device transport and records transfer counts, bytes and a latency
+ * histogram per report. It sits below the report cache, so only transfers
+ * that reached the device are counted. Only installed when instrumentation is
+ * enabled; otherwise the transport chain is unchanged.
+ *
+ * Design Pattern: Decorator over IUsbTransport
+ */
+class InstrumentedUsbTransport : public IUsbTransport {
+public:
+    explicit InstrumentedUsbTransport(std::unique_ptr<IUsbTransport> inner) : inner_(std::move(inner)) {}
+    ~InstrumentedUsbTransport() override = default;
+
+    TransferTotals get_totals() const;
+    // Copies the stats of one report; false if it was never transferred
+    bool get_report_stats(uint8_t report_type, uint8_t report_id, ReportTransferStats &stats) const;
+    // Copies the stats of up to max_count tracked reports, in first-seen order; returns how many
+    size_t get_tracked_reports(ReportTransferStats *stats, size_t max_count) const;
+
+    // IUsbTransport implementation
+    esp_err_t initialize() override { return inner_->initialize(); }
+    esp_err_t deinitialize() override { return inner_->deinitialize(); }
+
+    bool is_connected() const override { return inner_->is_connected(); }
+    uint16_t get_vendor_id() const override { return inner_->get_vendor_id(); }
+    uint16_t get_product_id() const override { return inner_->get_product_id(); }
+    uint32_t get_connection_id() const override { return inner_->get_connection_id(); }
+    void set_connection_callback(ConnectionCallback callback) override {
+        inner_->set_connection_callback(std::move(callback));
+    }
+
+    esp_err_t hid_get_report(uint8_t report_type, uint8_t report_id,
+                           uint8_t* data, size_t* data_len,
+                           uint32_t timeout_ms = 1000) override;
+
+    // A batch is timed as a whole and each request is charged its share
+    esp_err_t hid_get_reports(HidReportRequest* requests, size_t count, uint32_t timeout_ms) override;
+
+    esp_err_t hid_set_report(uint8_t report_type, uint8_t report_id,
+                           const uint8_t* data, size_t data_len,
+                           uint32_t timeout_ms = 1000) override;
+
+    esp_err_t get_string_descriptor(uint8_t string_index,
+                                  std::string& result) override {
+        return inner_->get_string_descriptor(string_index, result);
+    }
+
+    uint8_t get_serial_number_index() const override { return inner_->get_serial_number_index(); }
+
+    esp_err_t get_report_descriptor(std::vector<uint8_t>& descriptor) override {
+        return inner_->get_report_descriptor(descriptor);
+    }
+
+    std::string get_last_error() const override { return inner_->get_last_error(); }
+
+    void dump_config() const override;
+    size_t get_memory_usage() const override { return sizeof(*this) + inner_->get_memory_usage(); }
+    uint32_t get_task_stack_free() const override { return inner_->get_task_stack_free(); }
+
+    esp_err_t start_input_streaming(InputReportCallback callback) override {
+        return inner_->start_input_streaming(std::move(callback));
+    }
+    void stop_input_streaming() override { inner_->stop_input_streaming(); }
+    bool get_cached_input_report(uint8_t report_id, uint8_t* data, size_t* data_len,
+                                 uint32_t max_age_ms) const override {
+        return inner_->get_cached_input_report(report_id, data, data_len, max_age_ms);
+    }
+
+private:
+    std::unique_ptr<IUsbTransport> inner_;
+
+    TransferTotals totals_;
+    ReportTransferStats reports_[limits::INSTRUMENTED_REPORTS];
+    size_t report_count_{0};
+    mutable std::mutex stats_mutex_;
+
+    // Caller holds stats_mutex_
+    void record(uint8_t report_type, uint8_t report_id, esp_err_t result, size_t bytes, uint32_t elapsed_us);
+    const ReportTransferStats* find_report(uint8_t report_type, uint8_t report_id) const;
+};
+
+} // namespace ups_hid
+} // namespace esphome
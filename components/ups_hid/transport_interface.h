@@ -1,13 +1,32 @@
 #pragma once
 
 #include "esp_err.h"
+#include "memory_usage.h"
+#include <cstddef>
 #include <vector>
 #include <cstdint>
 #include <memory>
+#include <functional>
 
 namespace esphome {
 namespace ups_hid {
 
+/**
+ * One GET_REPORT of a batch. The caller fills the descriptor fields;
+ * hid_get_reports() fills length and result and sets done. Layers that can
+ * answer a request themselves (caches) mark it done, and lower layers skip
+ * requests that are already done.
+ */
+struct HidReportRequest {
+    uint8_t report_type{0};
+    uint8_t report_id{0};
+    size_t expected_len{0};      // Capacity of data, requested as wLength
+    uint8_t *data{nullptr};      // Report ID in byte 0, as with hid_get_report()
+    size_t length{0};            // Bytes received
+    esp_err_t result{ESP_ERR_TIMEOUT};
+    bool done{false};
+};
+
 /**
  * Abstract USB Transport Interface
  * 
@@ -29,6 +48,15 @@ public:
     virtual uint16_t get_vendor_id() const = 0;
     virtual uint16_t get_product_id() const = 0;
     
+    // Incremented each time a device is opened, so a reconnect shows up even
+    // when no poll saw the device gone; 0 if the transport does not track it
+    virtual uint32_t get_connection_id() const { return 0; }
+    
+    // Device attach/detach notifications (optional). Like the input report
+    // callback, this runs on the transport's USB task; set it before initialize().
+    using ConnectionCallback = std::function<void(bool connected)>;
+    virtual void set_connection_callback(ConnectionCallback callback) {}
+    
     // HID communication
     virtual esp_err_t hid_get_report(uint8_t report_type, uint8_t report_id, 
                                    uint8_t* data, size_t* data_len, 
@@ -38,12 +66,62 @@ public:
                                    const uint8_t* data, size_t data_len,
                                    uint32_t timeout_ms = 1000) = 0;
     
+    // Read up to limits::MAX_REPORT_BATCH reports in one transaction sharing
+    // timeout_ms. Returns ESP_OK when every request succeeded, else the first
+    // failing request's result; per-request outcomes are in each result.
+    // The default issues the reads one at a time.
+    virtual esp_err_t hid_get_reports(HidReportRequest* requests, size_t count, uint32_t timeout_ms) {
+        esp_err_t first_error = ESP_OK;
+        for (size_t i = 0; i < count; i++) {
+            HidReportRequest &request = requests[i];
+            if (!request.done) {
+                request.length = request.expected_len;
+                request.result = hid_get_report(request.report_type, request.report_id, request.data,
+                                                &request.length, timeout_ms);
+                if (request.result != ESP_OK) {
+                    request.length = 0;
+                }
+                request.done = true;
+            }
+            if (request.result != ESP_OK && first_error == ESP_OK) {
+                first_error = request.result;
+            }
+        }
+        return first_error;
+    }
+    
     // String descriptors
     virtual esp_err_t get_string_descriptor(uint8_t string_index, 
                                           std::string& result) = 0;
     
+    // iSerialNumber string index from the device descriptor; 0 when there is none
+    virtual uint8_t get_serial_number_index() const { return 0; }
+    
+    // Raw HID report descriptor of the claimed interface (optional)
+    virtual esp_err_t get_report_descriptor(std::vector<uint8_t>& descriptor) { return ESP_ERR_NOT_SUPPORTED; }
+    
     // Error information
     virtual std::string get_last_error() const = 0;
+    
+    // Diagnostics - log transport-specific configuration and statistics
+    virtual void dump_config() const {}
+    
+    // Heap held by the transport, its own object included (decorators add the
+    // transport they wrap), and the stack left on its USB task (0 without one)
+    virtual size_t get_memory_usage() const = 0;
+    virtual uint32_t get_task_stack_free() const { return 0; }
+    
+    // Interrupt-IN streaming (optional). The callback runs on the transport's
+    // USB task, so it must only record the event and defer the real work.
+    using InputReportCallback = std::function<void(uint8_t report_id)>;
+    
+    virtual esp_err_t start_input_streaming(InputReportCallback callback) { return ESP_ERR_NOT_SUPPORTED; }
+    virtual void stop_input_streaming() {}
+    
+    // Copy the latest streamed input report (report ID in byte 0, as with
+    // GET_REPORT) if one arrived within max_age_ms
+    virtual bool get_cached_input_report(uint8_t report_id, uint8_t* data, size_t* data_len,
+                                         uint32_t max_age_ms) const { return false; }
 };
 
 // Forward declaration - implementation in usb_transport_factory.h
@@ -1,28 +1,90 @@
 #include "transport_simulation.h"
-#include "esphome/core/log.h"
-#include <cstring>
+#include "constants_hid.h"
+#include "constants_ups.h"
+#include "esphome/core/hal.h"
+#include "log_ups.h"
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
 namespace esphome {
 namespace ups_hid {
 
 static const char *const SIM_TRANSPORT_TAG = "ups_hid.simulation";
 
-SimulatedTransport::SimulatedTransport() {
-    start_time_ = std::chrono::steady_clock::now();
+// Identity of each emulated device, indexed by SimulationVendor. String
+// descriptor indices follow the real units, since the protocols read them by
+// index.
+struct SimulatedDevice {
+    const char *name;
+    uint16_t vendor_id;
+    uint16_t product_id;
+    uint8_t manufacturer_index;
+    uint8_t product_index;
+    uint8_t serial_index;
+    const char *manufacturer;
+    const char *product;
+    const char *serial;
+    float battery_voltage_nominal;
+};
+
+static constexpr SimulatedDevice SIMULATED_DEVICES[] = {
+    {"APC Back-UPS ES 700G", 0x051D, 0x0002, 3, 1, 2, "American Power Conversion",
+     "Back-UPS ES 700G FW:871.O4 .I USB FW:O4", "5B1738T47814", 12.0f},
+    {"CyberPower CP1500EPFCLCD", 0x0764, 0x0501, 3, 1, 2, "CPS", "CP1500EPFCLCD", "CTHGS2000041", 24.0f},
+    {"Eaton 5PX 1500", 0x0463, 0xFFFF, 1, 3, 2, "EATON", "5PX 1500", "G106K45032", 48.0f},
+};
+
+static const SimulatedDevice &simulated_device(SimulationVendor vendor) {
+    return SIMULATED_DEVICES[static_cast<size_t>(vendor)];
+}
+
+static constexpr float SIM_NOMINAL_VOLTAGE = 230.0f;
+static constexpr float SIM_MAX_RUNTIME_SECONDS = 2700.0f;  // Full battery at 25% load
+static constexpr float SIM_DISCHARGE_PERCENT_PER_S = 0.2f;
+static constexpr float SIM_CHARGE_PERCENT_PER_S = 0.05f;
+static constexpr uint32_t SIM_TEST_DURATION_MS = 10000;
+
+// HID test result codes (PDC Test usage)
+static constexpr uint8_t SIM_TEST_PASSED = 1;
+static constexpr uint8_t SIM_TEST_ABORTED = 4;
+static constexpr uint8_t SIM_TEST_IN_PROGRESS = 5;
+
+static void put_u16(uint8_t *data, uint16_t value) {
+    data[0] = value & 0xFF;
+    data[1] = (value >> 8) & 0xFF;
+}
+
+static uint16_t to_u16(float value) {
+    return static_cast<uint16_t>(std::max(0.0f, std::min(65535.0f, std::round(value))));
+}
+
+static uint8_t to_u8(float value) {
+    return static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, std::round(value))));
 }
 
 esp_err_t SimulatedTransport::initialize() {
     if (initialized_) {
         return ESP_OK;
     }
-    
+
+    const SimulatedDevice &device = simulated_device(config_.vendor);
     ESP_LOGI(SIM_TRANSPORT_TAG, "Initializing simulated USB transport");
-    ESP_LOGI(SIM_TRANSPORT_TAG, "Simulating APC Back-UPS ES (VID=0x051D, PID=0x0002)");
-    
+    if (config_.replay) {
+        ESP_LOGI(SIM_TRANSPORT_TAG, "Replaying capture of VID=0x%04X, PID=0x%04X (%zu frames)", get_vendor_id(),
+                 get_product_id(), config_.trace.size());
+    } else {
+        ESP_LOGI(SIM_TRANSPORT_TAG, "Simulating %s (VID=0x%04X, PID=0x%04X)", device.name, device.vendor_id,
+                 device.product_id);
+    }
+
+    start_ms_ = millis();
+    last_update_ms_ = 0;
+    rng_state_ = config_.seed | 1;
+    battery_voltage_ = device.battery_voltage_nominal * 1.13f;
     initialized_ = true;
     connected_ = true;
-    
+
     return ESP_OK;
 }
 
@@ -30,12 +92,12 @@ esp_err_t SimulatedTransport::deinitialize() {
     if (!initialized_) {
         return ESP_OK;
     }
-    
+
     ESP_LOGI(SIM_TRANSPORT_TAG, "Deinitializing simulated USB transport");
-    
+
     initialized_ = false;
     connected_ = false;
-    
+
     return ESP_OK;
 }
 
@@ -44,76 +106,109 @@ bool SimulatedTransport::is_connected() const {
 }
 
 uint16_t SimulatedTransport::get_vendor_id() const {
-    return vendor_id_;
+    return config_.replay ? config_.vendor_id : simulated_device(config_.vendor).vendor_id;
 }
 
 uint16_t SimulatedTransport::get_product_id() const {
-    return product_id_;
+    return config_.replay ? config_.product_id : simulated_device(config_.vendor).product_id;
+}
+
+uint8_t SimulatedTransport::get_serial_number_index() const {
+    return config_.replay ? config_.serial_index : simulated_device(config_.vendor).serial_index;
+}
+
+esp_err_t SimulatedTransport::get_report_descriptor(std::vector<uint8_t>& descriptor) {
+    if (config_.report_descriptor.empty()) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    descriptor = config_.report_descriptor;
+    return ESP_OK;
 }
 
-esp_err_t SimulatedTransport::hid_get_report(uint8_t report_type, uint8_t report_id, 
-                                           uint8_t* data, size_t* data_len, 
+esp_err_t SimulatedTransport::hid_get_report(uint8_t report_type, uint8_t report_id,
+                                           uint8_t* data, size_t* data_len,
                                            uint32_t timeout_ms) {
+    HidReportRequest request;
+    request.report_type = report_type;
+    request.report_id = report_id;
+    request.expected_len = *data_len;
+    request.data = data;
+    hid_get_reports(&request, 1, timeout_ms);
+    *data_len = request.length;
+    return request.result;
+}
+
+esp_err_t SimulatedTransport::hid_get_reports(HidReportRequest* requests, size_t count, uint32_t timeout_ms) {
     if (!is_connected()) {
         last_error_ = "Simulated transport not connected";
+        for (size_t i = 0; i < count; i++) {
+            if (!requests[i].done) {
+                requests[i].length = 0;
+                requests[i].result = ESP_ERR_INVALID_STATE;
+                requests[i].done = true;
+            }
+        }
         return ESP_ERR_INVALID_STATE;
     }
-    
-    // Update dynamic simulation data
+
+    // One simulation step per batch, so every report describes the same instant
     update_simulation_data();
-    
-    ESP_LOGV(SIM_TRANSPORT_TAG, "Simulating HID GET_REPORT: type=0x%02X, id=0x%02X", 
-             report_type, report_id);
-    
-    // Clear the buffer first
-    memset(data, 0, *data_len);
-    data[0] = report_id; // First byte is always report ID
-    
-    // Generate simulated data based on report ID
-    switch (report_id) {
-        case 0x01: // Status report
-            generate_status_report(report_id, data, data_len);
-            break;
-            
-        case 0x06: // Battery report
-            generate_battery_report(report_id, data, data_len);
-            break;
-            
-        case 0x07: // Load report
-            generate_power_report(report_id, data, data_len);
-            break;
-            
-        case 0x0C: // Power summary
-            generate_battery_report(report_id, data, data_len);
-            break;
-            
-        case 0x0E: // Voltage report
-            generate_power_report(report_id, data, data_len);
-            break;
-            
-        case 0x1F: // Beeper control
-        case 0x18: // Audible alarm
-            generate_beeper_report(report_id, data, data_len);
-            break;
-            
-        case 0x03: // Device info
-        case 0x04: // Firmware
-            generate_device_info_report(report_id, data, data_len);
-            break;
-            
-        case 0x35: // Sensitivity
-            *data_len = 2;
-            data[1] = 1; // Normal sensitivity
-            break;
-            
-        default:
-            // Return zeros for unknown reports
-            *data_len = 6; // Standard HID report size
-            ESP_LOGV(SIM_TRANSPORT_TAG, "Unknown report ID 0x%02X, returning zeros", report_id);
-            break;
+
+    // Transfers are answered in order; one that never completes holds up the
+    // rest of the batch until timeout_ms, like a control pipe
+    uint32_t spent_ms = 0;
+    bool stalled_pipe = false;
+    esp_err_t first_error = ESP_OK;
+    for (size_t i = 0; i < count; i++) {
+        HidReportRequest &request = requests[i];
+        if (request.done) {
+            if (request.result != ESP_OK && first_error == ESP_OK) {
+                first_error = request.result;
+            }
+            continue;
+        }
+        request.length = 0;
+        request.done = true;
+        transfers_++;
+
+        Fault fault = stalled_pipe ? Fault::TIMEOUT : draw_fault(request.report_id);
+        const uint32_t latency_ms = draw_latency();
+        if (fault != Fault::TIMEOUT && spent_ms + latency_ms > timeout_ms) {
+            fault = Fault::TIMEOUT;
+        }
+
+        if (fault == Fault::TIMEOUT) {
+            timeouts_++;
+            stalled_pipe = true;
+            spent_ms = timeout_ms;
+            request.result = ESP_ERR_TIMEOUT;
+        } else {
+            spent_ms += latency_ms;
+            if (fault == Fault::STALL) {
+                stalls_++;
+                request.result = ESP_FAIL;
+            } else {
+                request.length = request.expected_len;
+                request.result = generate_report(request.report_type, request.report_id, request.data, &request.length)
+                                     ? ESP_OK
+                                     : ESP_FAIL;  // Not a report of this device: STALL
+                if (request.result != ESP_OK) {
+                    request.length = 0;
+                }
+            }
+        }
+
+        UPS_HID_LOGV(SIM_TRANSPORT_TAG, "GET_REPORT type=0x%02X id=0x%02X: %s (%zu bytes)", request.report_type,
+                 request.report_id, esp_err_to_name(request.result), request.length);
+        if (request.result != ESP_OK && first_error == ESP_OK) {
+            first_error = request.result;
+        }
     }
-    
-    return ESP_OK;
+
+    if (spent_ms > 0) {
+        delay(spent_ms);
+    }
+    return first_error;
 }
 
 esp_err_t SimulatedTransport::hid_set_report(uint8_t report_type, uint8_t report_id,
@@ -123,85 +218,128 @@ esp_err_t SimulatedTransport::hid_set_report(uint8_t report_type, uint8_t report
         last_error_ = "Simulated transport not connected";
         return ESP_ERR_INVALID_STATE;
     }
-    
-    ESP_LOGV(SIM_TRANSPORT_TAG, "Simulating HID SET_REPORT: type=0x%02X, id=0x%02X, len=%zu", 
-             report_type, report_id, data_len);
-    
-    // Simulate beeper control
-    if (report_id == 0x1F || report_id == 0x18) {
-        if (data_len >= 2) {
-            uint8_t beeper_value = data[1];
-            switch (beeper_value) {
-                case 1:
-                    beeper_status_ = "disabled";
-                    ESP_LOGI(SIM_TRANSPORT_TAG, "Simulated beeper disabled");
-                    break;
-                case 2:
-                    beeper_status_ = "enabled";
-                    ESP_LOGI(SIM_TRANSPORT_TAG, "Simulated beeper enabled");
-                    break;
-                case 3:
-                    beeper_status_ = "muted";
-                    ESP_LOGI(SIM_TRANSPORT_TAG, "Simulated beeper muted");
-                    break;
-                case 4:
-                    beeper_status_ = "test";
-                    ESP_LOGI(SIM_TRANSPORT_TAG, "Simulated beeper test");
-                    break;
-                default:
-                    ESP_LOGW(SIM_TRANSPORT_TAG, "Unknown beeper command: %d", beeper_value);
-                    break;
-            }
-        }
+
+    update_simulation_data();
+    transfers_++;
+    const Fault fault = draw_fault(report_id);
+    const uint32_t latency_ms = draw_latency();
+    if (fault == Fault::TIMEOUT || latency_ms > timeout_ms) {
+        timeouts_++;
+        delay(timeout_ms);
+        return ESP_ERR_TIMEOUT;
     }
-    
-    // Simulate test commands
-    if (report_id == 0x20 || report_id == 0x21) { // Battery test commands
-        if (data_len >= 2) {
-            uint8_t test_cmd = data[1];
-            if (test_cmd == 1) {
-                test_running_ = true;
-                test_result_ = "Battery test in progress";
-                ESP_LOGI(SIM_TRANSPORT_TAG, "Simulated battery test started");
-            } else if (test_cmd == 0) {
-                test_running_ = false;
-                test_result_ = "Battery test completed - Good";
-                ESP_LOGI(SIM_TRANSPORT_TAG, "Simulated battery test stopped");
-            }
+    delay(latency_ms);
+    if (fault == Fault::STALL) {
+        stalls_++;
+        return ESP_FAIL;
+    }
+    if (data_len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    UPS_HID_LOGV(SIM_TRANSPORT_TAG, "SET_REPORT type=0x%02X id=0x%02X len=%zu", report_type, report_id, data_len);
+    if (config_.replay) {
+        // The captured device is not modelled; writes are accepted and change nothing
+        return ESP_OK;
+    }
+
+    // Protocols differ on whether the report ID prefixes the value, so values are taken from the end
+    const uint8_t value8 = data[data_len - 1];
+    const uint16_t value16 = data_len >= 2 ? static_cast<uint16_t>(data[data_len - 2] | (data[data_len - 1] << 8))
+                                           : value8;
+    const uint32_t now = elapsed_ms();
+    auto write_test = [this, value8, now]() {
+        if (value8 == test::COMMAND_ABORT) {
+            test_result_ = test_result_ == SIM_TEST_IN_PROGRESS ? SIM_TEST_ABORTED : test_result_;
+        } else {
+            test_result_ = SIM_TEST_IN_PROGRESS;
+            test_end_ms_ = now + SIM_TEST_DURATION_MS;
+        }
+        ESP_LOGI(SIM_TRANSPORT_TAG, "Simulated test command %u", value8);
+        return ESP_OK;
+    };
+    auto write_beeper = [this, value8]() {
+        if (value8 < beeper::CONTROL_DISABLE || value8 > beeper::CONTROL_MUTE + 1) {
+            return ESP_ERR_INVALID_ARG;
         }
+        // 4 sounds the beeper once, the setting stays
+        if (value8 != beeper::CONTROL_MUTE + 1) {
+            beeper_control_ = value8;
+        }
+        ESP_LOGI(SIM_TRANSPORT_TAG, "Simulated beeper control %u", value8);
+        return ESP_OK;
+    };
+
+    switch (config_.vendor) {
+        case SimulationVendor::APC:
+            switch (report_id) {
+                case 0x18:
+                case 0x78:
+                case 0x1F:
+                    return write_beeper();
+                case 0x52:
+                case 0x79:
+                    return write_test();
+                case 0x41:
+                    delay_shutdown_s_ = value16;
+                    return ESP_OK;
+                case 0x40:
+                    delay_reboot_s_ = value16;
+                    return ESP_OK;
+            }
+            break;
+        case SimulationVendor::CYBERPOWER:
+            switch (report_id) {
+                case 0x0C:
+                    return write_beeper();
+                case 0x14:
+                    return write_test();
+                case 0x15:
+                    delay_shutdown_s_ = value16;
+                    return ESP_OK;
+                case 0x16:
+                    delay_start_s_ = value16;
+                    return ESP_OK;
+            }
+            break;
+        case SimulationVendor::EATON:
+            break;
     }
-    
-    return ESP_OK;
+
+    // Not writable on this device
+    return ESP_FAIL;
 }
 
-esp_err_t SimulatedTransport::get_string_descriptor(uint8_t string_index, 
+esp_err_t SimulatedTransport::get_string_descriptor(uint8_t string_index,
                                                   std::string& result) {
     if (!is_connected()) {
         last_error_ = "Simulated transport not connected";
         return ESP_ERR_INVALID_STATE;
     }
-    
-    // Simulate string descriptors
-    switch (string_index) {
-        case 1: // Manufacturer
-            result = "American Power Conversion";
-            break;
-        case 2: // Product
-            result = "Back-UPS ES 700 FW:866.L4.I USB FW:L4";
-            break;
-        case 3: // Serial number
-            result = "4B2037P30628";
-            break;
-        case 4: // Firmware (custom)
-            result = "866.L4.I";
-            break;
-        default:
-            result = "Unknown";
-            ESP_LOGW(SIM_TRANSPORT_TAG, "Unknown string index: %d", string_index);
-            return ESP_ERR_NOT_FOUND;
+
+    for (const auto &string : config_.strings) {
+        if (string.index == string_index) {
+            result = string.value;
+            return ESP_OK;
+        }
+    }
+    const SimulatedDevice &device = simulated_device(config_.vendor);
+    if (config_.replay) {
+        UPS_HID_LOGD(SIM_TRANSPORT_TAG, "No string descriptor %d in the capture", string_index);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (string_index == device.manufacturer_index) {
+        result = device.manufacturer;
+    } else if (string_index == device.product_index) {
+        result = device.product;
+    } else if (string_index == device.serial_index) {
+        result = device.serial;
+    } else {
+        UPS_HID_LOGD(SIM_TRANSPORT_TAG, "No string descriptor %d", string_index);
+        return ESP_ERR_NOT_FOUND;
     }
-    
-    ESP_LOGV(SIM_TRANSPORT_TAG, "Simulated string descriptor %d: '%s'", 
+
+    UPS_HID_LOGV(SIM_TRANSPORT_TAG, "Simulated string descriptor %d: '%s'",
              string_index, result.c_str());
     return ESP_OK;
 }
@@ -210,173 +348,372 @@ std::string SimulatedTransport::get_last_error() const {
     return last_error_;
 }
 
-// Private methods
+size_t SimulatedTransport::get_memory_usage() const {
+    size_t bytes = sizeof(*this) + heap_bytes(config_.unresponsive_reports) + heap_bytes(config_.trace) +
+                   heap_bytes(config_.strings) + heap_bytes(config_.report_descriptor) + heap_bytes(last_error_);
+    for (const auto &frame : config_.trace) {
+        bytes += heap_bytes(frame.data);
+    }
+    for (const auto &string : config_.strings) {
+        bytes += heap_bytes(string.value);
+    }
+    return bytes;
+}
 
-void SimulatedTransport::update_simulation_data() {
-    float elapsed = get_elapsed_seconds();
-    
-    // Simulate battery level slowly decreasing when on battery
-    if (input_voltage_ < 100.0f) { // On battery
-        battery_level_ = std::max(10.0f, 95.0f - (elapsed * 0.5f)); // Decrease over time
-        runtime_minutes_ = static_cast<uint16_t>(battery_level_ * 0.6f); // Runtime based on battery
+void SimulatedTransport::dump_config() const {
+    if (config_.replay) {
+        ESP_LOGCONFIG(SIM_TRANSPORT_TAG, "  Replayed Device: VID=0x%04X, PID=0x%04X (seed %u)", config_.vendor_id,
+                      config_.product_id, config_.seed);
+        ESP_LOGCONFIG(SIM_TRANSPORT_TAG, "    Report Descriptor: %zu bytes, Strings: %zu",
+                      config_.report_descriptor.size(), config_.strings.size());
     } else {
-        // On mains - slowly charge if below 100%
-        if (battery_level_ < 100.0f) {
-            battery_level_ = std::min(100.0f, battery_level_ + (elapsed * 0.1f));
-        }
-        runtime_minutes_ = static_cast<uint16_t>(battery_level_ * 0.8f);
-    }
-    
-    // Simulate periodic power fluctuations
-    input_voltage_ = 120.0f + sin(elapsed * 0.1f) * 2.0f; // Slight voltage variation
-    output_voltage_ = 120.0f + sin(elapsed * 0.05f) * 1.0f;
-    
-    // Simulate load variations
-    load_percent_ = 25.0f + sin(elapsed * 0.2f) * 5.0f; // 20-30% load
-    
-    // Simulate brief battery switch every 5 minutes for testing
-    if (fmod(elapsed, 300.0f) < 30.0f) { // 30 seconds on battery every 5 minutes
-        input_voltage_ = 0.0f; // Simulate power outage
+        ESP_LOGCONFIG(SIM_TRANSPORT_TAG, "  Simulated Device: %s (seed %u)", simulated_device(config_.vendor).name,
+                      config_.seed);
     }
+    ESP_LOGCONFIG(SIM_TRANSPORT_TAG, "    Latency: %u ms + up to %u ms, Stalls: %.2f%%, Timeouts: %.2f%%",
+                  config_.latency_ms, config_.latency_jitter_ms, config_.stall_rate * 100.0f,
+                  config_.timeout_rate * 100.0f);
+    if (!config_.unresponsive_reports.empty()) {
+        ESP_LOGCONFIG(SIM_TRANSPORT_TAG, "    Unresponsive Reports: %zu", config_.unresponsive_reports.size());
+    }
+    if (!config_.trace.empty()) {
+        ESP_LOGCONFIG(SIM_TRANSPORT_TAG, "    Trace: %zu frames, period %u ms, speed %.1fx", config_.trace.size(),
+                      config_.trace_period_ms, config_.trace_speed);
+    }
+    ESP_LOGCONFIG(SIM_TRANSPORT_TAG, "    Transfers: %u (%u stalled, %u timed out, %u from trace)", transfers_,
+                  stalls_, timeouts_, traced_);
 }
 
-float SimulatedTransport::get_elapsed_seconds() const {
-    auto now = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::seconds>(now - start_time_);
-    return static_cast<float>(duration.count());
+// Private methods
+
+uint32_t SimulatedTransport::elapsed_ms() const {
+    return millis() - start_ms_;
 }
 
-void SimulatedTransport::generate_battery_report(uint8_t report_id, uint8_t* data, size_t* data_len) {
-    *data_len = 6;
-    
-    if (report_id == 0x06) {
-        // Battery status report: [06 level runtime_low runtime_high 00 00]
-        data[1] = static_cast<uint8_t>(battery_level_);
-        data[2] = runtime_minutes_ & 0xFF;
-        data[3] = (runtime_minutes_ >> 8) & 0xFF;
-        data[4] = 0x00;
-        data[5] = 0x00;
-    } else if (report_id == 0x0C) {
-        // Power summary: [0C level runtime_low runtime_high]
-        data[1] = static_cast<uint8_t>(battery_level_);
-        data[2] = runtime_minutes_ & 0xFF;
-        data[3] = (runtime_minutes_ >> 8) & 0xFF;
-    }
-    
-    ESP_LOGV(SIM_TRANSPORT_TAG, "Generated battery report 0x%02X: level=%.0f%%, runtime=%d min", 
-             report_id, battery_level_, runtime_minutes_);
+uint32_t SimulatedTransport::trace_elapsed_ms() const {
+    return static_cast<uint32_t>(static_cast<float>(elapsed_ms()) * config_.trace_speed);
 }
 
-void SimulatedTransport::generate_power_report(uint8_t report_id, uint8_t* data, size_t* data_len) {
-    *data_len = 6;
-    
-    if (report_id == 0x07) {
-        // Load report: [07 load 00 00 00 00]
-        data[1] = static_cast<uint8_t>(load_percent_);
-        data[2] = 0x00;
-        data[3] = 0x00;
-        data[4] = 0x00;
-        data[5] = 0x00;
-    } else if (report_id == 0x0E) {
-        // Voltage report: [0E voltage_low voltage_high 00 00 00]
-        uint16_t voltage = static_cast<uint16_t>(input_voltage_);
-        data[1] = voltage & 0xFF;
-        data[2] = (voltage >> 8) & 0xFF;
-        data[3] = 0x00;
-        data[4] = 0x00;
-        data[5] = 0x00;
-    }
-    
-    ESP_LOGV(SIM_TRANSPORT_TAG, "Generated power report 0x%02X: load=%.0f%%, voltage=%.1fV", 
-             report_id, load_percent_, input_voltage_);
+uint32_t SimulatedTransport::next_random() {
+    // xorshift32: cheap, and identical on every target for the same seed
+    uint32_t x = rng_state_;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state_ = x;
+    return x;
 }
 
-void SimulatedTransport::generate_status_report(uint8_t report_id, uint8_t* data, size_t* data_len) {
-    *data_len = 6;
-    
-    // Status bitmap: online, on_battery, low_battery, etc.
-    uint8_t status = 0x00;
-    if (input_voltage_ > 100.0f) {
-        status |= 0x01; // Online
-    } else {
-        status |= 0x02; // On battery
-    }
-    
-    if (battery_level_ < 20.0f) {
-        status |= 0x04; // Low battery
-    }
-    
-    if (load_percent_ > 80.0f) {
-        status |= 0x08; // Overload
-    }
-    
-    data[1] = status;
-    data[2] = 0x00;
-    data[3] = 0x00;
-    data[4] = 0x00;
-    data[5] = 0x00;
-    
-    ESP_LOGV(SIM_TRANSPORT_TAG, "Generated status report: 0x%02X", status);
+SimulatedTransport::Fault SimulatedTransport::draw_fault(uint8_t report_id) {
+    // Always draw, so adding a fault rate does not shift the rest of the sequence
+    const float roll = static_cast<float>(next_random() >> 8) * (1.0f / 16777216.0f);
+    if (std::find(config_.unresponsive_reports.begin(), config_.unresponsive_reports.end(), report_id) !=
+        config_.unresponsive_reports.end()) {
+        return Fault::TIMEOUT;
+    }
+    if (roll < config_.timeout_rate) {
+        return Fault::TIMEOUT;
+    }
+    if (roll < config_.timeout_rate + config_.stall_rate) {
+        return Fault::STALL;
+    }
+    return Fault::NONE;
 }
 
-void SimulatedTransport::generate_beeper_report(uint8_t report_id, uint8_t* data, size_t* data_len) {
-    *data_len = 2;
-    
-    // Beeper status: 1=disabled, 2=enabled, 3=muted
-    if (beeper_status_ == "disabled") {
-        data[1] = 1;
-    } else if (beeper_status_ == "enabled") {
-        data[1] = 2;
-    } else if (beeper_status_ == "muted") {
-        data[1] = 3;
-    } else {
-        data[1] = 2; // Default enabled
+uint32_t SimulatedTransport::draw_latency() {
+    const uint32_t jitter = next_random();
+    return config_.latency_ms + (config_.latency_jitter_ms > 0 ? jitter % (config_.latency_jitter_ms + 1) : 0);
+}
+
+const SimulationTraceFrame *SimulatedTransport::find_trace_frame(uint8_t report_type, uint8_t report_id) const {
+    if (config_.trace.empty()) {
+        return nullptr;
+    }
+    uint32_t now = trace_elapsed_ms();
+    if (config_.trace_period_ms > 0) {
+        now %= config_.trace_period_ms;
+    }
+
+    // Latest frame of this report at or before now; the trace is sorted by time.
+    // A capture answers with its first frame of the report until that is due,
+    // as the device had the report all along.
+    const SimulationTraceFrame *match = nullptr;
+    for (const auto &frame : config_.trace) {
+        if (frame.at_ms > now && (match != nullptr || !config_.replay)) {
+            break;
+        }
+        if (frame.report_id == report_id && (frame.report_type == 0 || frame.report_type == report_type)) {
+            match = &frame;
+            if (frame.at_ms > now) {
+                break;
+            }
+        }
     }
-    
-    ESP_LOGV(SIM_TRANSPORT_TAG, "Generated beeper report: status=%s (value=%d)", 
-             beeper_status_.c_str(), data[1]);
+    return match;
 }
 
-void SimulatedTransport::generate_test_report(uint8_t report_id, uint8_t* data, size_t* data_len) {
-    *data_len = 6;
-    
-    if (test_running_) {
-        data[1] = 0x01; // Test in progress
-        data[2] = 0x50; // 80% progress (example)
-    } else {
-        data[1] = 0x00; // No test
-        data[2] = 0x00;
-    }
-    
-    data[3] = 0x00;
-    data[4] = 0x00;
-    data[5] = 0x00;
-    
-    ESP_LOGV(SIM_TRANSPORT_TAG, "Generated test report: running=%s", 
-             test_running_ ? "true" : "false");
+bool SimulatedTransport::generate_report(uint8_t report_type, uint8_t report_id, uint8_t* data, size_t* data_len) {
+    const size_t capacity = *data_len;
+    if (capacity == 0) {
+        return false;
+    }
+
+    const SimulationTraceFrame *frame = find_trace_frame(report_type, report_id);
+    if (frame != nullptr) {
+        *data_len = std::min(capacity, frame->data.size());
+        memcpy(data, frame->data.data(), *data_len);
+        traced_++;
+        return true;
+    }
+    if (config_.replay) {
+        return false;  // Never answered during the capture
+    }
+
+    uint8_t report[limits::MAX_HID_REPORT_SIZE] = {report_id};
+    size_t length = 0;
+    bool known = false;
+    switch (config_.vendor) {
+        case SimulationVendor::APC:
+            known = generate_apc_report(report_id, report, &length);
+            break;
+        case SimulationVendor::CYBERPOWER:
+            known = generate_cyberpower_report(report_id, report, &length);
+            break;
+        case SimulationVendor::EATON:
+            known = generate_eaton_report(report_id, report, &length);
+            break;
+    }
+    if (!known) {
+        return false;
+    }
+    *data_len = std::min(capacity, length);
+    memcpy(data, report, *data_len);
+    return true;
+}
+
+bool SimulatedTransport::generate_apc_report(uint8_t report_id, uint8_t* data, size_t* data_len) const {
+    const bool charging = !on_battery_ && battery_level_ < battery::MAX_LEVEL_PERCENT;
+    switch (report_id) {
+        case 0x0C:  // PowerSummary: RemainingCapacity, RunTimeToEmpty (s)
+            data[1] = to_u8(battery_level_);
+            put_u16(data + 2, static_cast<uint16_t>(runtime_seconds_));
+            *data_len = 4;
+            return true;
+        case 0x16: {  // PowerSummary.PresentStatus
+            uint8_t status = 0x08;  // BatteryPresent
+            if (charging) status |= 0x01;
+            if (on_battery_) status |= 0x02;
+            else status |= 0x04;  // ACPresent
+            if (battery_level_ < battery::LOW_THRESHOLD_PERCENT) status |= 0x10;  // BelowRemainingCapacityLimit
+            data[1] = status;
+            data[2] = load_percent_ > 100.0f ? 0x01 : 0x00;  // Overload
+            *data_len = 3;
+            return true;
+        }
+        case 0x06:  // APCStatusFlag: 8 online, 16 discharging
+            data[1] = on_battery_ ? 16 : 8;
+            *data_len = 2;
+            return true;
+        case 0x31:  // Input.Voltage
+            put_u16(data + 1, to_u16(input_voltage_));
+            *data_len = 3;
+            return true;
+        case 0x50:  // PowerConverter.PercentLoad
+            data[1] = to_u8(load_percent_);
+            *data_len = 2;
+            return true;
+        case 0x09:  // PowerSummary.Voltage (output)
+            put_u16(data + 1, to_u16(output_voltage_));
+            *data_len = 3;
+            return true;
+        case 0x26:  // Battery.Voltage, centivolts
+            put_u16(data + 1, to_u16(battery_voltage_ * 100.0f));
+            *data_len = 3;
+            return true;
+        case 0x52:  // Battery.Test
+            data[1] = test_result_;
+            *data_len = 2;
+            return true;
+        case 0x0D:  // Apparent power and frequency
+            data[3] = to_u8(frequency_);
+            *data_len = 4;
+            return true;
+        case 0x18:  // AudibleAlarmControl
+            data[1] = beeper_control_;
+            *data_len = 2;
+            return true;
+        case 0x35:  // APCSensitivity: normal
+            data[1] = 1;
+            *data_len = 2;
+            return true;
+        case usb::REPORT_ID_SERIAL_NUMBER:  // iSerialNumber
+            data[1] = simulated_device(config_.vendor).serial_index;
+            *data_len = 2;
+            return true;
+        case 0x25:  // Battery.ConfigVoltage, centivolts
+            put_u16(data + 1, to_u16(simulated_device(config_.vendor).battery_voltage_nominal * 100.0f));
+            *data_len = 3;
+            return true;
+        case 0x30:  // Input.ConfigVoltage
+            put_u16(data + 1, to_u16(SIM_NOMINAL_VOLTAGE));
+            *data_len = 3;
+            return true;
+        case 0x41:  // DelayBeforeShutdown
+            put_u16(data + 1, delay_shutdown_s_);
+            *data_len = 3;
+            return true;
+        case 0x40:  // DelayBeforeReboot
+            data[1] = to_u8(delay_reboot_s_);
+            *data_len = 2;
+            return true;
+    }
+    return false;
 }
 
-void SimulatedTransport::generate_device_info_report(uint8_t report_id, uint8_t* data, size_t* data_len) {
-    *data_len = 6;
-    
-    if (report_id == 0x03) {
-        // Device info - simulate some device characteristics
-        data[1] = 0x86; // Major version
-        data[2] = 0x6C; // Minor version  
-        data[3] = 0x04; // Revision
-        data[4] = 0x00;
-        data[5] = 0x00;
-    } else if (report_id == 0x04) {
-        // Firmware version
-        data[1] = 0x08; // 866 (hex)
-        data[2] = 0x66;
-        data[3] = 0x4C; // L4 (hex)
-        data[4] = 0x34;
-        data[5] = 0x00;
-    }
-    
-    ESP_LOGV(SIM_TRANSPORT_TAG, "Generated device info report 0x%02X", report_id);
+bool SimulatedTransport::generate_cyberpower_report(uint8_t report_id, uint8_t* data, size_t* data_len) const {
+    switch (report_id) {
+        case 0x07:  // Capacity limits: warning, low, full charge
+            data[4] = 20;
+            data[5] = 10;
+            data[6] = 100;
+            *data_len = 7;
+            return true;
+        case 0x08:  // RemainingCapacity, RunTimeToEmpty (s), RemainingTimeLimit (s)
+            data[1] = to_u8(battery_level_);
+            put_u16(data + 2, static_cast<uint16_t>(runtime_seconds_));
+            put_u16(data + 4, 300);
+            *data_len = 6;
+            return true;
+        case 0x0B: {  // PresentStatus
+            uint8_t status = 0;
+            if (!on_battery_) status |= 0x01;
+            if (!on_battery_ && battery_level_ < battery::MAX_LEVEL_PERCENT) status |= 0x02;
+            if (on_battery_) status |= 0x04;
+            if (battery_level_ < battery::LOW_THRESHOLD_PERCENT) status |= 0x08;
+            if (battery_level_ >= battery::MAX_LEVEL_PERCENT) status |= 0x10;
+            data[1] = status;
+            *data_len = 2;
+            return true;
+        }
+        case 0x0F:  // Input.Voltage
+            put_u16(data + 1, to_u16(input_voltage_));
+            *data_len = 3;
+            return true;
+        case 0x12:  // Output.Voltage
+            put_u16(data + 1, to_u16(output_voltage_));
+            *data_len = 3;
+            return true;
+        case 0x13:  // PercentLoad
+            data[1] = to_u8(load_percent_);
+            *data_len = 2;
+            return true;
+        case 0x0A:  // Battery.Voltage, decivolts
+            data[1] = to_u8(battery_voltage_ * 10.0f);
+            *data_len = 2;
+            return true;
+        case 0x17:  // Output.Overload
+            data[1] = load_percent_ > 100.0f ? 0x01 : 0x00;
+            *data_len = 2;
+            return true;
+        case 0x14:  // Output.Test
+            data[1] = test_result_;
+            *data_len = 2;
+            return true;
+        case 0x09:  // Battery.ConfigVoltage, decivolts
+            data[1] = to_u8(simulated_device(config_.vendor).battery_voltage_nominal * 10.0f);
+            *data_len = 2;
+            return true;
+        case 0x0E:  // Input.ConfigVoltage
+            data[1] = to_u8(SIM_NOMINAL_VOLTAGE);
+            *data_len = 2;
+            return true;
+        case 0x0C:  // AudibleAlarmControl
+            data[1] = beeper_control_;
+            *data_len = 2;
+            return true;
+        case 0x15:  // DelayBeforeShutdown
+            put_u16(data + 1, delay_shutdown_s_);
+            *data_len = 3;
+            return true;
+        case 0x16:  // DelayBeforeStartup
+            put_u16(data + 1, delay_start_s_);
+            *data_len = 3;
+            return true;
+        case usb::REPORT_ID_SERIAL_NUMBER:  // iSerialNumber
+            data[1] = simulated_device(config_.vendor).serial_index;
+            *data_len = 2;
+            return true;
+    }
+    return false;
+}
+
+bool SimulatedTransport::generate_eaton_report(uint8_t report_id, uint8_t* data, size_t* data_len) const {
+    switch (report_id) {
+        case 0x0C:  // PowerSummary: RemainingCapacity, RunTimeToEmpty (s)
+        case 0x06:
+            data[1] = to_u8(battery_level_);
+            put_u16(data + 2, static_cast<uint16_t>(runtime_seconds_));
+            *data_len = 4;
+            return true;
+        case 0x16: {  // PresentStatus: ACPresent, Charging, Discharging
+            uint8_t status = 0;
+            if (!on_battery_) status |= 0x01;
+            if (!on_battery_ && battery_level_ < battery::MAX_LEVEL_PERCENT) status |= 0x02;
+            if (on_battery_) status |= 0x04;
+            data[1] = status;
+            *data_len = 2;
+            return true;
+        }
+        case 0x30:  // Input.Voltage
+            put_u16(data + 1, to_u16(input_voltage_));
+            *data_len = 3;
+            return true;
+        case 0x31:  // Output: voltage in decivolts at bytes 5-6
+            put_u16(data + 5, to_u16(output_voltage_ * 10.0f));
+            *data_len = 7;
+            return true;
+        case 0x35:  // PercentLoad
+            data[1] = to_u8(load_percent_);
+            *data_len = 2;
+            return true;
+    }
+    return false;
+}
+
+void SimulatedTransport::update_simulation_data() {
+    const uint32_t now = elapsed_ms();
+    const float dt = static_cast<float>(now - last_update_ms_) / 1000.0f;
+    last_update_ms_ = now;
+    const float t = static_cast<float>(now) / 1000.0f;
+
+    // Mains lost at the start of every outage interval
+    on_battery_ = config_.outage_interval_ms > 0 && now % config_.outage_interval_ms < config_.outage_duration_ms;
+
+    if (on_battery_) {
+        battery_level_ = std::max(0.0f, battery_level_ - dt * SIM_DISCHARGE_PERCENT_PER_S);
+        input_voltage_ = 0.0f;
+    } else {
+        battery_level_ = std::min(battery::MAX_LEVEL_PERCENT, battery_level_ + dt * SIM_CHARGE_PERCENT_PER_S);
+        input_voltage_ = SIM_NOMINAL_VOLTAGE + std::sin(t * 0.1f) * 2.0f;  // Slight voltage variation
+    }
+    output_voltage_ = SIM_NOMINAL_VOLTAGE + std::sin(t * 0.05f) * 1.0f;
+    load_percent_ = 25.0f + std::sin(t * 0.2f) * 5.0f;  // 20-30% load
+    frequency_ = 50.0f + std::sin(t * 0.03f) * 0.2f;
+
+    runtime_seconds_ = static_cast<uint32_t>(SIM_MAX_RUNTIME_SECONDS * battery_level_ / battery::MAX_LEVEL_PERCENT *
+                                             25.0f / std::max(load_percent_, 1.0f));
+    runtime_seconds_ = std::min<uint32_t>(runtime_seconds_, 65534);
+
+    // Float voltage on mains, sagging with the charge on battery
+    const float nominal = simulated_device(config_.vendor).battery_voltage_nominal;
+    battery_voltage_ = on_battery_ ? nominal * (0.9f + 0.15f * battery_level_ / battery::MAX_LEVEL_PERCENT)
+                                   : nominal * 1.13f;
+
+    if (test_result_ == SIM_TEST_IN_PROGRESS && static_cast<int32_t>(now - test_end_ms_) >= 0) {
+        test_result_ = SIM_TEST_PASSED;
+        ESP_LOGI(SIM_TRANSPORT_TAG, "Simulated test completed");
+    }
 }
 
 } // namespace ups_hid
-} // namespace esphome
\ No newline at end of file
+} // namespace esphome
@@ -1,74 +1,157 @@
 #pragma once
 
 #include "transport_interface.h"
-#include <map>
-#include <chrono>
+#include <string>
+#include <vector>
 
 namespace esphome {
 namespace ups_hid {
 
+// Device the simulated transport presents itself as
+enum class SimulationVendor : uint8_t {
+    APC = 0,     // Back-UPS ES, Input reports as parsed by the APC protocol
+    CYBERPOWER,  // CP1500, Feature reports as parsed by the CyberPower protocol
+    EATON,       // 5PX, as parsed by the Eaton 5PX protocol
+};
+
+// One recorded report, served verbatim from at_ms after the transport came up
+struct SimulationTraceFrame {
+    uint32_t at_ms{0};
+    uint8_t report_type{0};
+    uint8_t report_id{0};
+    std::vector<uint8_t> data;  // Report ID in byte 0
+};
+
+// String descriptor of a replayed capture
+struct SimulationString {
+    uint8_t index{0};
+    std::string value;
+};
+
+/**
+ * Simulation settings
+ *
+ * Faults are drawn from a PRNG seeded with seed, so a given configuration and
+ * request sequence always produces the same latencies, stalls and timeouts.
+ */
+struct SimulationConfig {
+    SimulationVendor vendor{SimulationVendor::APC};
+    uint32_t seed{1};
+    uint32_t latency_ms{0};         // Per transfer
+    uint32_t latency_jitter_ms{0};  // Uniform, added to latency_ms
+    float stall_rate{0.0f};         // 0-1, transfer answered with a STALL
+    float timeout_rate{0.0f};       // 0-1, transfer never answered
+    std::vector<uint8_t> unresponsive_reports;  // Report IDs that always time out
+    uint32_t outage_interval_ms{300000};  // Mains lost at the start of every interval (0 disables)
+    uint32_t outage_duration_ms{30000};
+    std::vector<SimulationTraceFrame> trace;  // Sorted by at_ms
+    uint32_t trace_period_ms{0};              // Replay trace in a loop (0 plays it once)
+    float trace_speed{1.0f};                  // Trace time per real time
+
+    // Replay of a report trace captured on hardware: the identity, strings
+    // and report descriptor are the captured device's, and reports missing
+    // from the trace are STALLed instead of generated
+    bool replay{false};
+    uint16_t vendor_id{0};
+    uint16_t product_id{0};
+    uint8_t serial_index{0};
+    std::vector<SimulationString> strings;
+    std::vector<uint8_t> report_descriptor;
+};
+
 /**
  * Simulated USB Transport Implementation
- * 
- * Provides realistic UPS data simulation for testing and development
- * without requiring physical hardware
+ *
+ * Emulates one of the supported vendors report by report, so the real
+ * protocol detection and parsers run against it. A traced report replaces
+ * the generated one for its type and ID; a replayed capture replaces the
+ * emulated device altogether. Each transfer can be delayed, stalled or left
+ * unanswered; a transfer that does not complete holds up the rest of its
+ * batch, as on EP0.
  */
 class SimulatedTransport : public IUsbTransport {
 public:
-    SimulatedTransport();
+    SimulatedTransport() = default;
+    explicit SimulatedTransport(const SimulationConfig &config) : config_(config), rng_state_(config.seed | 1) {}
     ~SimulatedTransport() override = default;
-    
+
     // IUsbTransport implementation
     esp_err_t initialize() override;
     esp_err_t deinitialize() override;
-    
+
     bool is_connected() const override;
     uint16_t get_vendor_id() const override;
     uint16_t get_product_id() const override;
-    
-    esp_err_t hid_get_report(uint8_t report_type, uint8_t report_id, 
-                           uint8_t* data, size_t* data_len, 
+
+    esp_err_t hid_get_report(uint8_t report_type, uint8_t report_id,
+                           uint8_t* data, size_t* data_len,
                            uint32_t timeout_ms = 1000) override;
-    
+
+    esp_err_t hid_get_reports(HidReportRequest* requests, size_t count, uint32_t timeout_ms) override;
+
     esp_err_t hid_set_report(uint8_t report_type, uint8_t report_id,
                            const uint8_t* data, size_t data_len,
                            uint32_t timeout_ms = 1000) override;
-    
-    esp_err_t get_string_descriptor(uint8_t string_index, 
+
+    esp_err_t get_string_descriptor(uint8_t string_index,
                                   std::string& result) override;
-    
+    uint8_t get_serial_number_index() const override;
+    esp_err_t get_report_descriptor(std::vector<uint8_t>& descriptor) override;
+
     std::string get_last_error() const override;
+    void dump_config() const override;
+    size_t get_memory_usage() const override;
 
 private:
+    // Fault drawn for one transfer
+    enum class Fault : uint8_t { NONE, STALL, TIMEOUT };
+
+    SimulationConfig config_;
+    uint32_t rng_state_{1};
     bool connected_{false};
     bool initialized_{false};
-    uint16_t vendor_id_{0x051D}; // Default to APC
-    uint16_t product_id_{0x0002}; // APC Back-UPS ES
     std::string last_error_;
-    
-    // Simulation state
-    std::chrono::steady_clock::time_point start_time_;
-    float battery_level_{85.0f};
-    float input_voltage_{120.0f};
-    float output_voltage_{120.0f};
+    uint32_t start_ms_{0};
+    uint32_t last_update_ms_{0};
+
+    // Simulated device state, advanced once per transfer or batch
+    float battery_level_{100.0f};
+    float battery_voltage_{13.6f};
+    float input_voltage_{230.0f};
+    float output_voltage_{230.0f};
     float load_percent_{25.0f};
-    uint16_t runtime_minutes_{45};
-    std::string beeper_status_{"enabled"};
-    std::string test_result_{"No test initiated"};
-    bool test_running_{false};
-    
-    // Simulated report generation
-    void generate_battery_report(uint8_t report_id, uint8_t* data, size_t* data_len);
-    void generate_power_report(uint8_t report_id, uint8_t* data, size_t* data_len);
-    void generate_status_report(uint8_t report_id, uint8_t* data, size_t* data_len);
-    void generate_beeper_report(uint8_t report_id, uint8_t* data, size_t* data_len);
-    void generate_test_report(uint8_t report_id, uint8_t* data, size_t* data_len);
-    void generate_device_info_report(uint8_t report_id, uint8_t* data, size_t* data_len);
-    
+    float frequency_{50.0f};
+    uint32_t runtime_seconds_{2700};
+    bool on_battery_{false};
+    uint8_t beeper_control_{2};  // 1 disabled, 2 enabled, 3 muted
+    uint16_t delay_shutdown_s_{20};
+    uint16_t delay_start_s_{120};
+    uint16_t delay_reboot_s_{20};
+    uint8_t test_result_{6};     // HID test result: 1 passed, 4 aborted, 5 in progress, 6 none
+    uint32_t test_end_ms_{0};
+
+    // Counters for dump_config
+    uint32_t transfers_{0};
+    uint32_t stalls_{0};
+    uint32_t timeouts_{0};
+    uint32_t traced_{0};
+
+    uint32_t elapsed_ms() const;
+    uint32_t trace_elapsed_ms() const;
+    uint32_t next_random();
+    Fault draw_fault(uint8_t report_id);
+    uint32_t draw_latency();
+
+    // Fills data with the report as the emulated device would send it; false if it has no such report
+    bool generate_report(uint8_t report_type, uint8_t report_id, uint8_t* data, size_t* data_len);
+    bool generate_apc_report(uint8_t report_id, uint8_t* data, size_t* data_len) const;
+    bool generate_cyberpower_report(uint8_t report_id, uint8_t* data, size_t* data_len) const;
+    bool generate_eaton_report(uint8_t report_id, uint8_t* data, size_t* data_len) const;
+    const SimulationTraceFrame* find_trace_frame(uint8_t report_type, uint8_t report_id) const;
+
     // Dynamic data simulation
     void update_simulation_data();
-    float get_elapsed_seconds() const;
 };
 
 } // namespace ups_hid
-} // namespace esphome
\ No newline at end of file
+} // namespace esphome
@@ -0,0 +1,302 @@
+#include "transport_tracing.h"
+#include "constants_hid.h"
+#include "esphome/core/log.h"
+#include "esphome/core/hal.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef USE_ESP32
+#include "esp_heap_caps.h"
+#endif
+
+namespace esphome {
+namespace ups_hid {
+
+static const char *const TRACING_TRANSPORT_TAG = "ups_hid.capture";
+
+// Largest data a record can hold; its length is one byte
+static constexpr size_t TRACE_MAX_RECORD_DATA = 255;
+
+static void *allocate_trace_buffer(size_t size, bool *in_psram) {
+#ifdef USE_ESP32
+    void *buffer = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    *in_psram = buffer != nullptr;
+    if (buffer == nullptr) {
+        buffer = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    return buffer;
+#else
+    *in_psram = false;
+    return malloc(size);
+#endif
+}
+
+static void free_trace_buffer(void *buffer) {
+#ifdef USE_ESP32
+    heap_caps_free(buffer);
+#else
+    free(buffer);
+#endif
+}
+
+static void put_le16(uint8_t *data, uint16_t value) {
+    data[0] = value & 0xFF;
+    data[1] = (value >> 8) & 0xFF;
+}
+
+static void put_le32(uint8_t *data, uint32_t value) {
+    for (size_t i = 0; i < 4; i++) {
+        data[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+static TraceRecordStatus trace_status(esp_err_t result) {
+    if (result == ESP_OK) {
+        return TraceRecordStatus::OK;
+    }
+    return result == ESP_ERR_TIMEOUT ? TraceRecordStatus::TIMEOUT : TraceRecordStatus::FAILED;
+}
+
+ReportTrace::~ReportTrace() {
+    if (buffer_ != nullptr) {
+        free_trace_buffer(buffer_);
+    }
+}
+
+bool ReportTrace::allocate(size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (buffer_ != nullptr) {
+        return true;
+    }
+    buffer_ = static_cast<uint8_t *>(allocate_trace_buffer(capacity, &in_psram_));
+    if (buffer_ == nullptr) {
+        return false;
+    }
+    capacity_ = capacity;
+    head_ = 0;
+    used_ = 0;
+    return true;
+}
+
+void ReportTrace::set_device(uint16_t vendor_id, uint16_t product_id, uint8_t serial_index) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    vendor_id_ = vendor_id;
+    product_id_ = product_id;
+    serial_index_ = serial_index;
+}
+
+void ReportTrace::set_report_descriptor(const std::vector<uint8_t> &descriptor) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    report_descriptor_.assign(descriptor.begin(),
+                              descriptor.begin() + std::min(descriptor.size(), limits::MAX_REPORT_DESCRIPTOR_SIZE));
+}
+
+void ReportTrace::record(TraceRecordKind kind, uint8_t report_type, uint8_t report_id, esp_err_t result,
+                         const uint8_t *data, size_t length) {
+    length = data != nullptr ? std::min(length, TRACE_MAX_RECORD_DATA) : 0;
+    const size_t size = TRACE_RECORD_HEADER_SIZE + length;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (buffer_ == nullptr || size > capacity_) {
+        return;
+    }
+    while (capacity_ - used_ < size) {
+        drop_oldest();
+    }
+
+    uint8_t header[TRACE_RECORD_HEADER_SIZE];
+    put_le32(header, millis());
+    header[4] = static_cast<uint8_t>(kind);
+    header[5] = report_type;
+    header[6] = report_id;
+    header[7] = static_cast<uint8_t>(trace_status(result));
+    header[8] = static_cast<uint8_t>(length);
+    put(header, sizeof(header));
+    if (length > 0) {
+        put(data, length);
+    }
+    records_++;
+}
+
+uint8_t *ReportTrace::snapshot(size_t *length) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t size = TRACE_HEADER_SIZE + report_descriptor_.size() + used_;
+    bool in_psram = false;
+    auto *out = static_cast<uint8_t *>(allocate_trace_buffer(size, &in_psram));
+    if (out == nullptr) {
+        return nullptr;
+    }
+
+    memcpy(out, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    out[4] = TRACE_VERSION;
+    out[5] = dropped_ > 0 ? TRACE_FLAG_DROPPED : 0;
+    put_le16(out + 6, vendor_id_);
+    put_le16(out + 8, product_id_);
+    put_le16(out + 10, static_cast<uint16_t>(report_descriptor_.size()));
+    put_le32(out + 12, millis());
+    put_le32(out + 16, dropped_);
+    out[20] = serial_index_;
+    memset(out + 21, 0, 3);
+    uint8_t *cursor = out + TRACE_HEADER_SIZE;
+    if (!report_descriptor_.empty()) {
+        memcpy(cursor, report_descriptor_.data(), report_descriptor_.size());
+        cursor += report_descriptor_.size();
+    }
+
+    // Unwrap the ring, oldest record first
+    const size_t first = std::min(used_, capacity_ - head_);
+    if (used_ > 0) {
+        memcpy(cursor, buffer_ + head_, first);
+        memcpy(cursor + first, buffer_, used_ - first);
+    }
+    *length = size;
+    return out;
+}
+
+void ReportTrace::free_snapshot(uint8_t *snapshot) {
+    free_trace_buffer(snapshot);
+}
+
+uint32_t ReportTrace::get_record_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_;
+}
+
+uint32_t ReportTrace::get_dropped_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+size_t ReportTrace::get_used_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return used_;
+}
+
+size_t ReportTrace::get_memory_usage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // The ring is left out when it lives in PSRAM, which the internal budget does not share
+    return heap_bytes(report_descriptor_) + (in_psram_ ? 0 : capacity_);
+}
+
+void ReportTrace::put(const uint8_t *data, size_t length) {
+    size_t tail = (head_ + used_) % capacity_;
+    const size_t first = std::min(length, capacity_ - tail);
+    memcpy(buffer_ + tail, data, first);
+    memcpy(buffer_, data + first, length - first);
+    used_ += length;
+}
+
+void ReportTrace::drop_oldest() {
+    const size_t length = buffer_[(head_ + TRACE_RECORD_HEADER_SIZE - 1) % capacity_];
+    const size_t size = TRACE_RECORD_HEADER_SIZE + length;
+    head_ = (head_ + size) % capacity_;
+    used_ -= size;
+    records_--;
+    dropped_++;
+}
+
+void TracingUsbTransport::set_connection_callback(ConnectionCallback callback) {
+    inner_->set_connection_callback([this, callback = std::move(callback)](bool connected) {
+        if (connected) {
+            trace_.set_device(inner_->get_vendor_id(), inner_->get_product_id(), inner_->get_serial_number_index());
+        }
+        if (callback) {
+            callback(connected);
+        }
+    });
+}
+
+esp_err_t TracingUsbTransport::hid_get_report(uint8_t report_type, uint8_t report_id,
+                                             uint8_t* data, size_t* data_len,
+                                             uint32_t timeout_ms) {
+    esp_err_t ret = inner_->hid_get_report(report_type, report_id, data, data_len, timeout_ms);
+    trace_.record(TraceRecordKind::GET_REPORT, report_type, report_id, ret, data,
+                  ret == ESP_OK && data_len ? *data_len : 0);
+    return ret;
+}
+
+esp_err_t TracingUsbTransport::hid_get_reports(HidReportRequest* requests, size_t count, uint32_t timeout_ms) {
+    bool forwarded[limits::MAX_REPORT_BATCH] = {};
+    for (size_t i = 0; i < count && i < limits::MAX_REPORT_BATCH; i++) {
+        forwarded[i] = !requests[i].done;
+    }
+
+    esp_err_t ret = inner_->hid_get_reports(requests, count, timeout_ms);
+    for (size_t i = 0; i < count && i < limits::MAX_REPORT_BATCH; i++) {
+        if (forwarded[i]) {
+            const HidReportRequest &request = requests[i];
+            trace_.record(TraceRecordKind::GET_REPORT, request.report_type, request.report_id, request.result,
+                          request.data, request.result == ESP_OK ? request.length : 0);
+        }
+    }
+    return ret;
+}
+
+esp_err_t TracingUsbTransport::hid_set_report(uint8_t report_type, uint8_t report_id,
+                                             const uint8_t* data, size_t data_len,
+                                             uint32_t timeout_ms) {
+    esp_err_t ret = inner_->hid_set_report(report_type, report_id, data, data_len, timeout_ms);
+    // The data written is recorded whatever the outcome
+    trace_.record(TraceRecordKind::SET_REPORT, report_type, report_id, ret, data, data_len);
+    return ret;
+}
+
+esp_err_t TracingUsbTransport::get_string_descriptor(uint8_t string_index, std::string& result) {
+    esp_err_t ret = inner_->get_string_descriptor(string_index, result);
+    trace_.record(TraceRecordKind::STRING, string_index, 0, ret, reinterpret_cast<const uint8_t *>(result.data()),
+                  ret == ESP_OK ? result.size() : 0);
+    return ret;
+}
+
+esp_err_t TracingUsbTransport::get_report_descriptor(std::vector<uint8_t>& descriptor) {
+    esp_err_t ret = inner_->get_report_descriptor(descriptor);
+    if (ret == ESP_OK) {
+        trace_.set_device(inner_->get_vendor_id(), inner_->get_product_id(), inner_->get_serial_number_index());
+        trace_.set_report_descriptor(descriptor);
+    }
+    return ret;
+}
+
+esp_err_t TracingUsbTransport::start_input_streaming(InputReportCallback callback) {
+    return inner_->start_input_streaming([this, callback = std::move(callback)](uint8_t report_id) {
+        uint8_t report[limits::MAX_HID_REPORT_SIZE];
+        size_t length = sizeof(report);
+        if (inner_->get_cached_input_report(report_id, report, &length, UINT32_MAX)) {
+            trace_.record(TraceRecordKind::INPUT_REPORT, HID_REPORT_TYPE_INPUT, report_id, ESP_OK, report, length);
+        }
+        if (callback) {
+            callback(report_id);
+        }
+    });
+}
+
+void TracingUsbTransport::dump_config() const {
+    inner_->dump_config();
+    ESP_LOGCONFIG(TRACING_TRANSPORT_TAG, "  Capture: %u records, %zu of %zu bytes in %s, %u overwritten",
+                  trace_.get_record_count(), trace_.get_used_bytes(), trace_.capacity(),
+                  trace_.in_psram() ? "PSRAM" : "internal RAM", trace_.get_dropped_count());
+}
+
+#ifdef USE_UPS_HID_CAPTURE
+bool ReportTraceHandler::canHandle(AsyncWebServerRequest *request) const {
+    return request->method() == HTTP_GET && request->url() == path_.c_str();
+}
+
+void ReportTraceHandler::handleRequest(AsyncWebServerRequest *request) {
+    size_t length = 0;
+    uint8_t *snapshot = trace_.snapshot(&length);
+    if (snapshot == nullptr) {
+        request->send(503, "text/plain", "Not enough memory to copy the trace");
+        return;
+    }
+    // The response is sent before send() returns, so the copy can go right after
+    AsyncWebServerResponse *response = request->beginResponse(200, "application/octet-stream", snapshot, length);
+    response->addHeader("Content-Disposition", "attachment; filename=\"trace.bin\"");
+    request->send(response);
+    ReportTrace::free_snapshot(snapshot);
+}
+#endif
+
+} // namespace ups_hid
+} // namespace esphome
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#include "transport_interface.h"
+#include "constants_ups.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef USE_UPS_HID_CAPTURE
+#include "esphome/components/web_server_base/web_server_base.h"
+#endif
+
+namespace esphome {
+namespace ups_hid {
+
+/*
+ * Report trace format, little-endian. A download is one header, the report
+ * descriptor and then the records oldest first:
+ *
+ *   header (24 bytes)  magic "UHTR", u8 version, u8 flags, u16 vendor_id,
+ *                      u16 product_id, u16 descriptor_length,
+ *                      u32 captured_ms (millis() at download), u32 dropped,
+ *                      u8 serial_index (iSerialNumber), 3 bytes reserved
+ *   descriptor         descriptor_length bytes, as read from the device
+ *   record (9 bytes)   u32 at_ms, u8 kind, u8 report_type (string index for
+ *                      strings), u8 report_id, u8 status, u8 length,
+ *                      followed by length data bytes, report ID first
+ */
+static constexpr char TRACE_MAGIC[4] = {'U', 'H', 'T', 'R'};
+static constexpr uint8_t TRACE_VERSION = 1;
+static constexpr size_t TRACE_HEADER_SIZE = 24;
+static constexpr size_t TRACE_RECORD_HEADER_SIZE = 9;
+static constexpr uint8_t TRACE_FLAG_DROPPED = 0x01;  // The ring overwrote its oldest records
+
+enum class TraceRecordKind : uint8_t {
+    GET_REPORT = 1,
+    SET_REPORT = 2,
+    INPUT_REPORT = 3,  // Interrupt IN
+    STRING = 4,        // String descriptor, UTF-8
+};
+
+enum class TraceRecordStatus : uint8_t {
+    OK = 0,
+    TIMEOUT = 1,
+    FAILED = 2,  // STALL or any other error
+};
+
+/**
+ * Ring of raw report exchanges
+ *
+ * Records are packed back to back in one buffer allocated from PSRAM where
+ * the chip has it; when full, the oldest records are overwritten. Written
+ * from the acquisition and USB tasks, read by the web server, so every
+ * access holds the mutex.
+ */
+class ReportTrace {
+public:
+    ReportTrace() = default;
+    ~ReportTrace();
+    ReportTrace(const ReportTrace &) = delete;
+    ReportTrace &operator=(const ReportTrace &) = delete;
+
+    // False if the buffer could not be allocated
+    bool allocate(size_t capacity);
+    bool is_allocated() const { return buffer_ != nullptr; }
+    bool in_psram() const { return in_psram_; }
+    size_t capacity() const { return capacity_; }
+
+    void set_device(uint16_t vendor_id, uint16_t product_id, uint8_t serial_index);
+    void set_report_descriptor(const std::vector<uint8_t> &descriptor);
+    // Data beyond 255 bytes is cut off
+    void record(TraceRecordKind kind, uint8_t report_type, uint8_t report_id, esp_err_t result,
+                const uint8_t *data, size_t length);
+
+    // The whole trace in download format, in a buffer the caller releases
+    // with free_snapshot(); nullptr if it cannot be allocated
+    uint8_t *snapshot(size_t *length) const;
+    static void free_snapshot(uint8_t *snapshot);
+
+    uint32_t get_record_count() const;
+    uint32_t get_dropped_count() const;
+    size_t get_used_bytes() const;
+    // Heap held in internal RAM
+    size_t get_memory_usage() const;
+
+protected:
+    // Caller holds mutex_
+    void put(const uint8_t *data, size_t length);
+    void drop_oldest();
+
+    uint8_t *buffer_{nullptr};
+    size_t capacity_{0};
+    size_t head_{0};  // Start of the oldest record
+    size_t used_{0};
+    bool in_psram_{false};
+    uint32_t records_{0};  // Records in the ring
+    uint32_t dropped_{0};
+    uint16_t vendor_id_{0};
+    uint16_t product_id_{0};
+    uint8_t serial_index_{0};
+    std::vector<uint8_t> report_descriptor_;
+    mutable std::mutex mutex_;
+};
+
+/**
+ * Tracing USB Transport Decorator
+ *
+ * Records every report exchanged with the device, with its outcome, into a
+ * ReportTrace: GET_REPORT and SET_REPORT transfers, interrupt IN reports,
+ * string descriptors and the report descriptor. It sits directly on the
+ * device transport, below instrumentation and the report cache, so the trace
+ * holds exactly the traffic the device saw. Only installed when capture is
+ * configured.
+ *
+ * Design Pattern: Decorator over IUsbTransport
+ */
+class TracingUsbTransport : public IUsbTransport {
+public:
+    TracingUsbTransport(std::unique_ptr<IUsbTransport> inner, ReportTrace &trace)
+        : inner_(std::move(inner)), trace_(trace) {}
+    ~TracingUsbTransport() override = default;
+
+    // IUsbTransport implementation
+    esp_err_t initialize() override { return inner_->initialize(); }
+    esp_err_t deinitialize() override { return inner_->deinitialize(); }
+
+    bool is_connected() const override { return inner_->is_connected(); }
+    uint16_t get_vendor_id() const override { return inner_->get_vendor_id(); }
+    uint16_t get_product_id() const override { return inner_->get_product_id(); }
+    uint32_t get_connection_id() const override { return inner_->get_connection_id(); }
+    // Notes the identity of each device that is opened in the trace header
+    void set_connection_callback(ConnectionCallback callback) override;
+
+    esp_err_t hid_get_report(uint8_t report_type, uint8_t report_id,
+                           uint8_t* data, size_t* data_len,
+                           uint32_t timeout_ms = 1000) override;
+
+    esp_err_t hid_get_reports(HidReportRequest* requests, size_t count, uint32_t timeout_ms) override;
+
+    esp_err_t hid_set_report(uint8_t report_type, uint8_t report_id,
+                           const uint8_t* data, size_t data_len,
+                           uint32_t timeout_ms = 1000) override;
+
+    esp_err_t get_string_descriptor(uint8_t string_index,
+                                  std::string& result) override;
+
+    uint8_t get_serial_number_index() const override { return inner_->get_serial_number_index(); }
+
+    esp_err_t get_report_descriptor(std::vector<uint8_t>& descriptor) override;
+
+    std::string get_last_error() const override { return inner_->get_last_error(); }
+
+    void dump_config() const override;
+    size_t get_memory_usage() const override { return sizeof(*this) + inner_->get_memory_usage(); }
+    uint32_t get_task_stack_free() const override { return inner_->get_task_stack_free(); }
+
+    // Each streamed report is copied into the trace before the callback runs
+    esp_err_t start_input_streaming(InputReportCallback callback) override;
+    void stop_input_streaming() override { inner_->stop_input_streaming(); }
+    bool get_cached_input_report(uint8_t report_id, uint8_t* data, size_t* data_len,
+                                 uint32_t max_age_ms) const override {
+        return inner_->get_cached_input_report(report_id, data, data_len, max_age_ms);
+    }
+
+private:
+    std::unique_ptr<IUsbTransport> inner_;
+    ReportTrace &trace_;
+};
+
+#ifdef USE_UPS_HID_CAPTURE
+/**
+ * Serves the report trace as a binary download on GET path
+ *
+ * The ring is copied out under its lock, so capture continues while the
+ * download is sent.
+ */
+class ReportTraceHandler : public AsyncWebHandler {
+public:
+    ReportTraceHandler(const ReportTrace &trace, std::string path) : trace_(trace), path_(std::move(path)) {}
+
+    bool canHandle(AsyncWebServerRequest *request) const override;
+    void handleRequest(AsyncWebServerRequest *request) override;
+
+private:
+    const ReportTrace &trace_;
+    std::string path_;
+};
+#endif
+
+} // namespace ups_hid
+} // namespace esphome
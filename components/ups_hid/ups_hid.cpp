@@ -2,6 +2,8 @@
 #include "constants_ups.h"
 #include "transport_factory.h"
 #include "transport_simulation.h"
+#include "transport_caching.h"
+#include "transport_tracing.h"
 #ifdef USE_ESP32
 #include "transport_esp32.h"
 #endif
@@ -10,14 +12,36 @@
 #include "protocol_cyberpower.h"
  
 #include "protocol_generic.h"
-#include "esphome/core/log.h"
+#include "log_ups.h"
 #include "esphome/core/application.h"
 #include <functional>
 #include <cmath>
+#include <cstring>
 
 namespace esphome {
 namespace ups_hid {
 
+// Indexed by UpsCommand; NUT instant command names, used in logs
+static constexpr const char *COMMAND_NAMES[] = {
+  "beeper.enable",
+  "beeper.disable",
+  "beeper.mute",
+  "beeper.test",
+  "test.battery.start.quick",
+  "test.battery.start.deep",
+  "test.battery.stop",
+  "test.panel.start",
+  "test.panel.stop",
+  "shutdown.delay",
+  "start.delay",
+  "reboot.delay",
+};
+static_assert(sizeof(COMMAND_NAMES) / sizeof(COMMAND_NAMES[0]) ==
+                  static_cast<size_t>(UpsCommand::SET_REBOOT_DELAY) + 1,
+              "COMMAND_NAMES out of sync with UpsCommand");
+
+const char *command_name(UpsCommand command) { return COMMAND_NAMES[static_cast<size_t>(command)]; }
+
 void UpsHidComponent::setup() {
   ESP_LOGCONFIG(TAG, log_messages::SETTING_UP);
   
@@ -27,15 +51,202 @@ void UpsHidComponent::setup() {
     return;
   }
   
+#ifdef USE_ESP32
+  if (acquisition_task_enabled_ && !start_acquisition_task()) {
+    ESP_LOGW(TAG, log_messages::ACQUISITION_TASK_FAILED);
+  }
+#endif
+  
+  if (interrupt_streaming_enabled_) {
+    esp_err_t ret = transport_->start_input_streaming([this](uint8_t report_id) { on_input_report(report_id); });
+    if (ret != ESP_OK) {
+      ESP_LOGW(TAG, log_messages::INTERRUPT_STREAMING_UNAVAILABLE, esp_err_to_name(ret));
+      interrupt_streaming_enabled_ = false;
+    }
+  }
+  
+  if (!history_.allocate(history_size_)) {
+    ESP_LOGW(TAG, log_messages::HISTORY_ALLOCATION_FAILED, history_size_);
+  }
+  
+#ifdef USE_UPS_HID_CAPTURE
+  if (capture_web_server_ != nullptr && capture_.is_allocated()) {
+    capture_web_server_->init();
+    capture_web_server_->add_handler(new ReportTraceHandler(capture_, capture_path_));
+  }
+#endif
+  
+  // update_interval is the active rate; idle and critical rates are derived from it
+  poll_intervals_ms_[static_cast<size_t>(PollRate::ACTIVE)] = get_update_interval();
+  applied_poll_rate_ = PollRate::ACTIVE;
+  
   // Protocol detection is deferred to update() method to handle asynchronous USB enumeration
   ESP_LOGCONFIG(TAG, log_messages::SETUP_COMPLETE);
 }
 
 void UpsHidComponent::update() {
+#ifdef USE_ESP32
+  if (acquisition_task_handle_.load() != nullptr) {
+    // USB traffic is owned by the acquisition task; just schedule the next full poll
+    if (instrumentation_enabled_) {
+      poll_requested_us_ = micros() | 1;
+    }
+    notify_acquisition_task();
+    return;
+  }
+#endif
+  
+  if (poll_device()) {
+    update_sensors();
+  }
+}
+
+void UpsHidComponent::loop() {
+  if (detection_exhausted_.load()) {
+#ifdef USE_ESP32
+    // The task finishes its last poll on its own; check again on the next loop
+    if (!stop_acquisition_task(0)) {
+      return;
+    }
+#endif
+    mark_failed();
+    return;
+  }
+  
+  // Without the acquisition task, streamed reports are turned into a poll here,
+  // and so are queued commands, followed by a poll that reads their effect back.
+  // Input reports come from the cache, but the FAST group's feature reports and
+  // the timers are still read over USB, blocking the loop; so a streamed report
+  // polls at most once per INPUT_REPORT_POLL_MIN_INTERVAL_MS and the rest wait.
+  bool poll_now = false;
+  const uint32_t now = millis();
+  if (input_report_pending_.load() &&
+      now - last_input_report_poll_ms_ >= timing::INPUT_REPORT_POLL_MIN_INTERVAL_MS) {
+    input_report_pending_ = false;
+    last_input_report_poll_ms_ = now;
+    poll_now = true;
+  }
+  poll_now |= connection_changed_.exchange(false);
+#ifdef USE_ESP32
+  if (acquisition_task_handle_.load() == nullptr)
+#endif
+  {
+    poll_now |= execute_pending_commands();
+  }
+  dispatch_completed_commands();
+  if (poll_now && poll_device()) {
+    update_sensors();
+  }
+  
+  // Publish snapshots completed by the acquisition task
+  if (snapshot_pending_.exchange(false)) {
+    update_sensors();
+  }
+  
+  // The poller is owned by the main loop, so rate changes picked by the polling context land here
+  const PollRate rate = poll_rate_.load();
+  if (rate != applied_poll_rate_) {
+    apply_poll_rate(rate);
+  }
+}
+
+void UpsHidComponent::record_poll_timing(uint32_t lock_wait_us, uint32_t poll_us) {
+  std::lock_guard<std::mutex> lock(instrumentation_mutex_);
+  poll_timing_.polls++;
+  poll_timing_.last_us = poll_us;
+  poll_timing_.max_us = std::max(poll_timing_.max_us, poll_us);
+  poll_timing_.total_us += poll_us;
+  poll_timing_.lock_waits++;
+  poll_timing_.lock_wait_max_us = std::max(poll_timing_.lock_wait_max_us, lock_wait_us);
+  poll_timing_.lock_wait_total_us += lock_wait_us;
+}
+
+void UpsHidComponent::record_wake_latency(uint32_t wake_us) {
+  std::lock_guard<std::mutex> lock(instrumentation_mutex_);
+  poll_timing_.wakes++;
+  poll_timing_.wake_last_us = wake_us;
+  poll_timing_.wake_max_us = std::max(poll_timing_.wake_max_us, wake_us);
+  poll_timing_.wake_total_us += wake_us;
+}
+
+// Called on the transport's USB task: only flag the event, never touch the protocol here
+void UpsHidComponent::on_input_report(uint8_t report_id) {
+  UPS_HID_LOGV(TAG, "Input report 0x%02X streamed", report_id);
+#ifdef USE_ESP32
+  if (notify_acquisition_task()) {
+    return;
+  }
+#endif
+  input_report_pending_ = true;
+}
+
+// Counts what the component allocated after setup: transport buffers, the
+// protocol with its report map, the parsed descriptor, history and snapshots.
+// Container sizes are estimates (see memory_usage.h), not allocator figures.
+void UpsHidComponent::update_memory_usage() {
+  size_t bytes = history_.memory_usage() + report_descriptor_.memory_usage() + heap_bytes(device_identity_.serial);
+  bytes += sizeof(UpsData);  // The published snapshot
+  bytes += capture_.get_memory_usage();
+  if (transport_) {
+    bytes += transport_->get_memory_usage();
+  }
+  if (active_protocol_) {
+    bytes += active_protocol_->get_memory_usage();
+  }
+  memory_dynamic_.store(bytes, std::memory_order_relaxed);
+  if (bytes > memory_peak_.load(std::memory_order_relaxed)) {
+    memory_peak_.store(bytes, std::memory_order_relaxed);
+  }
+}
+
+uint32_t UpsHidComponent::get_acquisition_stack_free() const {
+#ifdef USE_ESP32
+  return task_stack_free(acquisition_task_handle_.load());
+#else
+  return 0;
+#endif
+}
+
+// Called on the transport's USB task: an attach or detach is handled by a poll right away
+void UpsHidComponent::on_connection_changed(bool connected) {
+  (connected ? attached_at_ms_ : detached_at_ms_) = millis() | 1;
+#ifdef USE_ESP32
+  if (notify_acquisition_task()) {
+    return;
+  }
+#endif
+  connection_changed_ = true;
+}
+
+void UpsHidComponent::on_shutdown() {
+#ifdef USE_ESP32
+  // Let an in-flight poll finish so the transport is not left mid-transfer
+  if (!stop_acquisition_task(acquisition::STOP_TIMEOUT_MS)) {
+    ESP_LOGW(TAG, "Acquisition task did not stop within %u ms", acquisition::STOP_TIMEOUT_MS);
+  }
+#endif
+}
+
+// Runs detection and a full read cycle; returns true when a fresh snapshot has been published.
+// Never publishes to entities, so it is safe to call from the acquisition task.
+bool UpsHidComponent::poll_device() {
+  const uint32_t lock_requested = instrumentation_enabled_ ? micros() : 0;
+  std::lock_guard<std::mutex> lock(protocol_mutex_);
+  const uint32_t lock_acquired = instrumentation_enabled_ ? micros() : 0;
+  update_memory_usage();
+  
   if (!transport_ || !transport_->is_connected()) {
     // Device not connected yet - normal during startup or after disconnection
-    ESP_LOGD(TAG, log_messages::WAITING_FOR_DEVICE);
-    return;
+    UPS_HID_LOGD(TAG, log_messages::WAITING_FOR_DEVICE);
+    invalidate_report_groups();  // Everything is read again once the device is back
+    report_breaker_.clear();
+    poll_rate_ = PollRate::ACTIVE;
+    return false;
+  }
+  
+  const uint32_t connection_id = transport_->get_connection_id();
+  if (connection_id != connection_id_) {
+    handle_new_connection(connection_id);
   }
   
   // Check if protocol detection is needed
@@ -50,31 +261,190 @@ void UpsHidComponent::update() {
       
       if (consecutive_failures_ > max_consecutive_failures_) {
         ESP_LOGE(TAG, log_messages::TOO_MANY_FAILURES);
-        mark_failed();
+        detection_exhausted_ = true;
       }
-      return;
+      return false;
     }
   }
   
-  // Normal data reading with active protocol
-  if (read_ups_data()) {
-    update_sensors();
+  // Normal data reading with active protocol; every read of the cycle,
+  // timers included, shares one protocol timeout
+  poll_deadline_ms_ = (millis() + protocol_timeout_ms_) | 1;
+  const bool read = read_ups_data();
+  poll_deadline_ms_ = 0;
+  if (instrumentation_enabled_) {
+    record_poll_timing(lock_acquired - lock_requested, micros() - lock_acquired);
+  }
+  
+  if (read) {
     consecutive_failures_ = 0;
     last_successful_read_ = millis();
+    if (recovery_started_ms_ != 0) {
+      last_recovery_ms_ = last_successful_read_ - recovery_started_ms_;
+      ESP_LOGI(TAG, log_messages::DATA_RESUMED, last_recovery_ms_.load());
+      recovery_started_ms_ = 0;
+    }
     
-    // Check for timer updates (fast polling during countdowns)
-    check_and_update_timers();
-  } else {
-    consecutive_failures_++;
-    ESP_LOGW(TAG, log_messages::READ_FAILED, consecutive_failures_);
+    if (!discovery_cache_current_) {
+      store_discovery_cache();
+    }
+    poll_rate_ = select_poll_rate();
+    return true;
+  }
+  
+  poll_rate_ = PollRate::ACTIVE;
+  consecutive_failures_++;
+  ESP_LOGW(TAG, log_messages::READ_FAILED, consecutive_failures_);
+  
+  if (consecutive_failures_ > max_consecutive_failures_) {
+    ESP_LOGW(TAG, log_messages::RESETTING_PROTOCOL);
+    if (discovery_from_cache_) {
+      // The restored discovery may be what is failing; probe from scratch next time
+      device_cache_.erase();
+    }
+    reset_protocol();  // Force protocol re-detection on next update
+    consecutive_failures_ = 0;
+  }
+  return false;
+}
+
+// First poll on a new USB connection. When the same unit (VID, PID and serial)
+// comes back within reconnect_window, the protocol instance keeps its report map
+// and the poll that follows reads all groups; otherwise detection starts over,
+// still helped by the discovery cache.
+void UpsHidComponent::handle_new_connection(uint32_t connection_id) {
+  const bool reconnect = connection_id_ != 0;
+  connection_id_ = connection_id;
+  consecutive_failures_ = 0;
+  
+  DeviceIdentity identity{transport_->get_vendor_id(), transport_->get_product_id(), read_serial_number()};
+  const bool same_device = identity == device_identity_;
+  device_identity_ = std::move(identity);
+  
+  const uint32_t now = millis();
+  const uint32_t detached_ms = detached_at_ms_.exchange(0);
+  const uint32_t attached_ms = attached_at_ms_.exchange(0);
+  // A bounce no poll saw has no detach stamp; treat it as instantaneous
+  const uint32_t offline_ms = detached_ms != 0 && attached_ms != 0 ? attached_ms - detached_ms : 0;
+  if (!reconnect) {
+    return;
+  }
+  recovery_started_ms_ = attached_ms != 0 ? attached_ms : now | 1;
+  
+  if (!active_protocol_) {
+    invalidate_report_descriptor();
+    return;
+  }
+  if (same_device && reconnect_window_ms_ > 0 && offline_ms <= reconnect_window_ms_) {
+    ESP_LOGI(TAG, log_messages::FAST_RECONNECT, offline_ms, active_protocol_->get_protocol_name().c_str());
+    fast_reconnects_++;
+    invalidate_report_groups();
+    return;
+  }
+  ESP_LOGI(TAG, log_messages::DEVICE_CHANGED, offline_ms);
+  full_reconnects_++;
+  reset_protocol();
+}
+
+void UpsHidComponent::reset_protocol() {
+  active_protocol_.reset();
+  invalidate_report_groups();
+  invalidate_report_descriptor();
+  report_breaker_.clear();
+  
+  // Values retained across polls are no longer trustworthy
+  ups_data_ = UpsData{};
+  history_.clear();
+  publish_snapshot();
+  
+  std::lock_guard<std::mutex> lock(data_mutex_);
+  active_protocol_name_.clear();
+}
+
+#ifdef USE_ESP32
+bool UpsHidComponent::start_acquisition_task() {
+  if (acquisition_stopped_ == nullptr) {
+    acquisition_stopped_ = xSemaphoreCreateBinary();
+    if (acquisition_stopped_ == nullptr) {
+      return false;
+    }
+  }
+  
+  acquisition_running_ = true;
+  TaskHandle_t task = nullptr;
+  BaseType_t result = create_task(acquisition_task, acquisition_task_config_, this, &task);
+  if (result != pdPASS) {
+    acquisition_running_ = false;
+    return false;
+  }
+  acquisition_task_handle_ = task;
+  
+  UPS_HID_LOGD(TAG, "Acquisition task started");
+  return true;
+}
+
+bool UpsHidComponent::notify_acquisition_task() {
+  // Held so the task cannot be deleted between reading the handle and notifying it
+  std::lock_guard<std::mutex> lock(acquisition_task_mutex_);
+  TaskHandle_t task = acquisition_task_handle_.load();
+  if (task == nullptr) {
+    return false;
+  }
+  xTaskNotifyGive(task);
+  return true;
+}
+
+bool UpsHidComponent::stop_acquisition_task(uint32_t timeout_ms) {
+  if (acquisition_task_handle_.load() == nullptr) {
+    return true;
+  }
+  
+  acquisition_running_ = false;
+  notify_acquisition_task();
+  
+  // The task signals once it has left its loop and parked itself
+  if (xSemaphoreTake(acquisition_stopped_, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+    return false;
+  }
+  
+  std::lock_guard<std::mutex> lock(acquisition_task_mutex_);
+  vTaskDelete(acquisition_task_handle_.exchange(nullptr));
+  UPS_HID_LOGD(TAG, "Acquisition task stopped");
+  return true;
+}
+
+void UpsHidComponent::acquisition_task(void *param) {
+  auto *self = static_cast<UpsHidComponent *>(param);
+  
+  while (self->acquisition_running_.load()) {
+    // update() and streamed input reports notify; the poller sets the pace
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    const uint32_t requested_us = self->poll_requested_us_.exchange(0);
+    if (requested_us != 0) {
+      self->record_wake_latency(micros() - requested_us);
+    }
     
-    if (consecutive_failures_ > max_consecutive_failures_) {
-      ESP_LOGW(TAG, log_messages::RESETTING_PROTOCOL);
-      active_protocol_.reset();  // Force protocol re-detection on next update
-      consecutive_failures_ = 0;
+    if (!self->acquisition_running_.load()) {
+      break;
+    }
+    
+    // Commands run between polls; the poll that follows reads them back
+    self->execute_pending_commands();
+    if (self->poll_device()) {
+      self->snapshot_pending_ = true;
+    }
+    
+    if (self->detection_exhausted_.load()) {
+      self->acquisition_running_ = false;
     }
   }
+  
+  // Parked instead of deleting itself: another task may still be about to
+  // notify it, so only the main loop deletes it, under acquisition_task_mutex_
+  xSemaphoreGive(self->acquisition_stopped_);
+  vTaskSuspend(nullptr);
 }
+#endif
 
 void UpsHidComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "UPS HID Component:");
@@ -87,13 +457,43 @@ void UpsHidComponent::dump_config() {
   
   ESP_LOGCONFIG(TAG, "  Protocol Timeout: %u ms", protocol_timeout_ms_);
   ESP_LOGCONFIG(TAG, "  Protocol Selection: %s", protocol_selection_.c_str());
-  ESP_LOGCONFIG(TAG, "  Update Interval: %u ms", get_update_interval());
+  ESP_LOGCONFIG(TAG, "  Update Interval: %u ms (idle %u ms, critical %u ms)", get_poll_interval(PollRate::ACTIVE),
+                get_poll_interval(PollRate::IDLE), get_poll_interval(PollRate::CRITICAL));
+#ifdef USE_ESP32
+  ESP_LOGCONFIG(TAG, "  Acquisition Task: %s", acquisition_task_handle_.load() != nullptr ? status::YES : status::NO);
+  if (acquisition_task_handle_.load() != nullptr) {
+    ESP_LOGCONFIG(TAG, "    Core: %d, priority %u, stack %u bytes (%u free)", acquisition_task_config_.core,
+                  acquisition_task_config_.priority, acquisition_task_config_.stack_size,
+                  get_acquisition_stack_free());
+  }
+  ESP_LOGCONFIG(TAG, "  USB Client Task: core %d, priority %u, stack %u bytes", usb_task_config_.client.core,
+                usb_task_config_.client.priority, usb_task_config_.client.stack_size);
+#endif
+  ESP_LOGCONFIG(TAG, "  Interrupt Streaming: %s", interrupt_streaming_enabled_ ? status::YES : status::NO);
+  ESP_LOGCONFIG(TAG, "  Discovery Cache: %s", discovery_cache_enabled_ && !simulation_mode_ ? status::YES : status::NO);
+  ESP_LOGCONFIG(TAG, "  Reconnect Window: %u ms", reconnect_window_ms_);
+  const MemoryUsage memory = get_memory_usage();
+  ESP_LOGCONFIG(TAG, "  Memory: %zu bytes static, %zu bytes dynamic (peak %zu)", memory.static_bytes,
+                memory.dynamic_bytes, memory.dynamic_peak);
+  if (fast_reconnects_ + full_reconnects_ > 0) {
+    ESP_LOGCONFIG(TAG, "    Reconnects: %u fast, %u full, last data resumed after %u ms", fast_reconnects_.load(),
+                  full_reconnects_.load(), last_recovery_ms_.load());
+  }
+  if (history_.capacity() > 0) {
+    ESP_LOGCONFIG(TAG, "  History: %zu samples (%zu bytes), summary window %u ms", history_.capacity(),
+                  history_.memory_usage(), history_window_ms_);
+  }
+#ifdef USE_UPS_HID_CAPTURE
+  if (capture_web_server_ != nullptr && capture_.is_allocated()) {
+    ESP_LOGCONFIG(TAG, "  Capture Download: %s", capture_path_.c_str());
+  }
+#endif
 
   if (transport_ && transport_->is_connected()) {
     ESP_LOGCONFIG(TAG, "  Status: %s", status::CONNECTED);
-    if (active_protocol_) {
-      ESP_LOGCONFIG(TAG, "  Active Protocol: %s", 
-                   active_protocol_->get_protocol_name().c_str());
+    std::string protocol_name = get_protocol_name();
+    if (protocol_name != protocol::NONE) {
+      ESP_LOGCONFIG(TAG, "  Active Protocol: %s", protocol_name.c_str());
     } else {
       ESP_LOGCONFIG(TAG, "  Protocol Status: %s", status::DETECTION_PENDING);
     }
@@ -101,6 +501,23 @@ void UpsHidComponent::dump_config() {
     ESP_LOGCONFIG(TAG, "  Status: %s", status::DISCONNECTED);
   }
 
+  if (transport_) {
+    transport_->dump_config();
+  }
+  ESP_LOGCONFIG(TAG, "  Quarantined Reports: %zu (%u reads skipped)", report_breaker_.open_count(millis()),
+                report_breaker_.short_circuits());
+  if (instrumentation_enabled_) {
+    const PollTimingStats timing = get_poll_timing();
+    ESP_LOGCONFIG(TAG, "  Polls: %u, last %.1f ms, max %.1f ms, mean %.1f ms", timing.polls, timing.last_us / 1000.0f,
+                  timing.max_us / 1000.0f, timing.polls > 0 ? timing.total_us / 1000.0f / timing.polls : 0.0f);
+    ESP_LOGCONFIG(TAG, "  Protocol Lock Wait: max %.1f ms, mean %.2f ms", timing.lock_wait_max_us / 1000.0f,
+                  timing.lock_waits > 0 ? timing.lock_wait_total_us / 1000.0f / timing.lock_waits : 0.0f);
+    if (timing.wakes > 0) {
+      ESP_LOGCONFIG(TAG, "  Acquisition Wake Latency: last %u us, max %u us, mean %u us", timing.wake_last_us,
+                    timing.wake_max_us, static_cast<uint32_t>(timing.wake_total_us / timing.wakes));
+    }
+  }
+
 #ifdef USE_SENSOR
   ESP_LOGCONFIG(TAG, "  Registered Sensors: %zu", sensors_.size());
 #endif
@@ -119,7 +536,99 @@ esp_err_t UpsHidComponent::hid_get_report(uint8_t report_type, uint8_t report_id
   if (!transport_) {
     return ESP_ERR_INVALID_STATE;
   }
-  return transport_->hid_get_report(report_type, report_id, data, data_len, timeout_ms);
+  // Streamed input reports are fresher than anything GET_REPORT would return
+  if (interrupt_streaming_enabled_ && report_type == HID_REPORT_TYPE_INPUT &&
+      transport_->get_cached_input_report(report_id, data, data_len, timing::INPUT_REPORT_CACHE_MAX_AGE_MS)) {
+    return ESP_OK;
+  }
+  const uint32_t now = millis();
+  bool clamped;
+  timeout_ms = clamp_to_poll_deadline(timeout_ms, now, clamped);
+  if (timeout_ms == 0 || !report_breaker_.allow(report_type, report_id, now)) {
+    return ESP_ERR_TIMEOUT;
+  }
+  esp_err_t ret = transport_->hid_get_report(report_type, report_id, data, data_len, timeout_ms);
+  // A read cut short by the deadline says nothing about the report itself
+  if (ret != ESP_ERR_TIMEOUT || !clamped) {
+    report_breaker_.record(report_type, report_id, ret, millis());
+  }
+  return ret;
+}
+
+esp_err_t UpsHidComponent::hid_get_reports(HidReportRequest* requests, size_t count, uint32_t timeout_ms) {
+  if (!transport_) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  // Longer lists go through in batch-sized chunks, each past the breaker and deadline
+  if (count > limits::MAX_REPORT_BATCH) {
+    esp_err_t first_error = ESP_OK;
+    for (size_t offset = 0; offset < count; offset += limits::MAX_REPORT_BATCH) {
+      const esp_err_t ret = hid_get_reports(requests + offset, std::min(count - offset, limits::MAX_REPORT_BATCH),
+                                            timeout_ms);
+      if (ret != ESP_OK && first_error == ESP_OK) {
+        first_error = ret;
+      }
+    }
+    return first_error;
+  }
+  if (interrupt_streaming_enabled_) {
+    for (size_t i = 0; i < count; i++) {
+      HidReportRequest &request = requests[i];
+      if (request.done || request.report_type != HID_REPORT_TYPE_INPUT) {
+        continue;
+      }
+      request.length = request.expected_len;
+      if (transport_->get_cached_input_report(request.report_id, request.data, &request.length,
+                                              timing::INPUT_REPORT_CACHE_MAX_AGE_MS)) {
+        request.result = ESP_OK;
+        request.done = true;
+      }
+    }
+  }
+  const uint32_t now = millis();
+  bool clamped;
+  timeout_ms = clamp_to_poll_deadline(timeout_ms, now, clamped);
+  bool forwarded[limits::MAX_REPORT_BATCH] = {};
+  size_t pending = 0;
+  for (size_t i = 0; i < count; i++) {
+    HidReportRequest &request = requests[i];
+    if (request.done) {
+      continue;
+    }
+    if (timeout_ms == 0 || !report_breaker_.allow(request.report_type, request.report_id, now)) {
+      request.length = 0;
+      request.result = ESP_ERR_TIMEOUT;
+      request.done = true;
+      continue;
+    }
+    forwarded[i] = true;
+    pending++;
+  }
+  if (pending == 0) {
+    return ESP_ERR_TIMEOUT;
+  }
+  
+  esp_err_t ret = transport_->hid_get_reports(requests, count, timeout_ms);
+  const uint32_t finished = millis();
+  for (size_t i = 0; i < count; i++) {
+    if (forwarded[i] && (requests[i].result != ESP_ERR_TIMEOUT || !clamped)) {
+      report_breaker_.record(requests[i].report_type, requests[i].report_id, requests[i].result, finished);
+    }
+  }
+  return ret;
+}
+
+uint32_t UpsHidComponent::clamp_to_poll_deadline(uint32_t timeout_ms, uint32_t now, bool &clamped) const {
+  clamped = false;
+  if (poll_deadline_ms_ == 0) {
+    return timeout_ms;
+  }
+  const int32_t remaining = static_cast<int32_t>(poll_deadline_ms_ - now);
+  if (remaining <= 0 || static_cast<uint32_t>(remaining) < timeout_ms) {
+    clamped = true;
+    return remaining <= 0 ? 0 : static_cast<uint32_t>(remaining);
+  }
+  return timeout_ms;
 }
 
 esp_err_t UpsHidComponent::hid_set_report(uint8_t report_type, uint8_t report_id,
@@ -138,6 +647,159 @@ esp_err_t UpsHidComponent::get_string_descriptor(uint8_t string_index, std::stri
   return transport_->get_string_descriptor(string_index, result);
 }
 
+size_t UpsProtocolBase::read_reports(const uint8_t *report_ids, HidReport *reports, size_t count,
+                                     uint8_t preferred_type) {
+  count = std::min(count, limits::MAX_REPORT_BATCH);
+  const uint8_t other_type = preferred_type == HID_REPORT_TYPE_INPUT ? HID_REPORT_TYPE_FEATURE : HID_REPORT_TYPE_INPUT;
+  
+  HidReportRequest requests[limits::MAX_REPORT_BATCH];
+  int8_t duplicate_of[limits::MAX_REPORT_BATCH];
+  for (size_t i = 0; i < count; i++) {
+    const uint8_t report_id = report_ids[i];
+    reports[i].report_id = report_id;
+    reports[i].data.clear();
+    requests[i].report_type = alternate_type_[report_id] ? other_type : preferred_type;
+    requests[i].report_id = report_id;
+    requests[i].expected_len = reports[i].data.capacity();
+    requests[i].data = reports[i].data.data();
+    
+    // A report listed twice is read once and copied afterwards
+    duplicate_of[i] = -1;
+    for (size_t j = 0; j < i; j++) {
+      if (report_ids[j] == report_id) {
+        duplicate_of[i] = static_cast<int8_t>(j);
+        requests[i].done = true;
+        break;
+      }
+    }
+  }
+  
+  const uint32_t budget = parent_->get_protocol_timeout();
+  const uint32_t started = millis();
+  parent_->hid_get_reports(requests, count, budget);
+  
+  // Retry the failures with the other report type on what is left of the budget
+  bool retried[limits::MAX_REPORT_BATCH] = {};
+  bool any_retry = false;
+  for (size_t i = 0; i < count; i++) {
+    HidReportRequest &request = requests[i];
+    if (duplicate_of[i] >= 0 || request.result == ESP_OK) {
+      continue;
+    }
+    request.report_type = request.report_type == preferred_type ? other_type : preferred_type;
+    request.length = 0;
+    request.result = ESP_ERR_TIMEOUT;
+    request.done = false;
+    retried[i] = true;
+    any_retry = true;
+  }
+  const uint32_t elapsed = millis() - started;
+  if (any_retry && elapsed < budget && parent_->is_device_connected()) {
+    parent_->hid_get_reports(requests, count, budget - elapsed);
+    for (size_t i = 0; i < count; i++) {
+      if (retried[i] && requests[i].result == ESP_OK) {
+        alternate_type_.flip(report_ids[i]);
+      }
+    }
+  }
+  
+  size_t read = 0;
+  for (size_t i = 0; i < count; i++) {
+    const int8_t source = duplicate_of[i];
+    const HidReportRequest &request = requests[source >= 0 ? source : i];
+    if (request.result != ESP_OK || request.length == 0) {
+      continue;
+    }
+    if (source >= 0) {
+      reports[i].data.assign(reports[source].data.begin(), reports[source].data.end());
+    } else {
+      reports[i].data.set_size(request.length);
+    }
+    read++;
+  }
+  
+  UPS_HID_LOGV(TAG, "Batch read %zu/%zu reports in %u ms", read, count, millis() - started);
+  return read;
+}
+
+void UpsHidComponent::probe_reports(const uint8_t* report_ids, size_t count, ProbeResults& results) {
+  const uint32_t budget = protocol_timeout_ms_;
+  const uint32_t started = millis();
+  HidReportBuffer buffers[limits::MAX_REPORT_BATCH];
+  HidReportRequest requests[limits::MAX_REPORT_BATCH];
+  
+  size_t next = 0;
+  while (next < count && is_connected()) {
+    // Fill one batch with IDs no earlier round has asked for
+    size_t batch = 0;
+    for (; next < count && batch < limits::MAX_REPORT_BATCH; next++) {
+      const uint8_t report_id = report_ids[next];
+      if (results.probed(report_id)) {
+        continue;
+      }
+      results.mark_probed(report_id);
+      requests[batch] = HidReportRequest{};
+      requests[batch].report_type = HID_REPORT_TYPE_INPUT;
+      requests[batch].report_id = report_id;
+      requests[batch].expected_len = buffers[batch].capacity();
+      requests[batch].data = buffers[batch].data();
+      batch++;
+    }
+    if (batch == 0) {
+      break;
+    }
+    
+    // Each batch gets the full protocol timeout, shared by its Input and Feature passes
+    const uint32_t batch_started = millis();
+    bool answered[limits::MAX_REPORT_BATCH] = {};
+    for (uint8_t report_type : {HID_REPORT_TYPE_INPUT, HID_REPORT_TYPE_FEATURE}) {
+      const uint32_t elapsed = millis() - batch_started;
+      if (elapsed >= budget) {
+        break;
+      }
+      bool pending = false;
+      for (size_t i = 0; i < batch; i++) {
+        requests[i].done = answered[i];  // Only the IDs still unanswered go out again
+        if (!answered[i]) {
+          requests[i].report_type = report_type;
+          requests[i].length = 0;
+          requests[i].result = ESP_ERR_TIMEOUT;
+          pending = true;
+        }
+      }
+      if (!pending) {
+        break;
+      }
+      hid_get_reports(requests, batch, budget - elapsed);
+      for (size_t i = 0; i < batch; i++) {
+        if (!answered[i] && requests[i].result == ESP_OK && requests[i].length > 0) {
+          results.record(requests[i].report_id, report_type, requests[i].length);
+          answered[i] = true;
+        }
+      }
+    }
+  }
+  UPS_HID_LOGD(TAG, "Probed %zu report IDs in %u ms", count, millis() - started);
+}
+
+const HidReportDescriptor* UpsHidComponent::get_report_descriptor() {
+  if (!report_descriptor_loaded_ && transport_ && transport_->is_connected()) {
+    std::vector<uint8_t> raw;
+    esp_err_t ret = transport_->get_report_descriptor(raw);
+    if (ret == ESP_OK) {
+      report_descriptor_.parse(raw.data(), raw.size());
+    }
+    // Retry after a timeout; any other outcome is final for this connection
+    report_descriptor_loaded_ = ret != ESP_ERR_TIMEOUT;
+  }
+  return report_descriptor_.empty() ? nullptr : &report_descriptor_;
+}
+
+void UpsHidComponent::invalidate_report_descriptor() {
+  report_descriptor_.clear();
+  report_descriptor_loaded_ = false;
+}
+
 bool UpsHidComponent::is_connected() const {
   return transport_ && transport_->is_connected();
 }
@@ -152,20 +814,51 @@ uint16_t UpsHidComponent::get_product_id() const {
 
 // Core implementation methods
 bool UpsHidComponent::initialize_transport() {
-  ESP_LOGD(TAG, "Initializing transport layer");
+  UPS_HID_LOGD(TAG, "Initializing transport layer");
   
   // Create appropriate transport
   auto transport_type = simulation_mode_ ? 
     UsbTransportFactory::SIMULATION : 
     UsbTransportFactory::ESP32_HARDWARE;
     
-  transport_ = UsbTransportFactory::create(transport_type, simulation_mode_);
+  transport_ = UsbTransportFactory::create(transport_type, simulation_mode_, usb_vendor_id_, usb_product_id_,
+                                          &simulation_config_, &usb_task_config_);
   
   if (!transport_) {
     ESP_LOGE(TAG, "Failed to create transport instance");
     return false;
   }
   
+  // Directly on the device transport, so the trace holds exactly what the device saw
+  if (capture_buffer_size_ > 0) {
+    if (capture_.allocate(capture_buffer_size_)) {
+      if (!capture_.in_psram()) {
+        ESP_LOGW(TAG, log_messages::CAPTURE_IN_INTERNAL_RAM, capture_buffer_size_);
+      }
+      transport_ = std::make_unique<TracingUsbTransport>(std::move(transport_), capture_);
+    } else {
+      ESP_LOGW(TAG, log_messages::CAPTURE_ALLOCATION_FAILED, capture_buffer_size_);
+    }
+  }
+  
+  // Below the cache, so only transfers that reach the device are measured
+  if (instrumentation_enabled_) {
+    auto instrumented = std::make_unique<InstrumentedUsbTransport>(std::move(transport_));
+    instrumented_transport_ = instrumented.get();
+    transport_ = std::move(instrumented);
+  }
+  
+  if (report_cache_ttl_ms_ > 0 || !report_cache_overrides_.empty()) {
+    auto cache = std::make_unique<CachingUsbTransport>(std::move(transport_), report_cache_ttl_ms_);
+    for (const auto &override_ttl : report_cache_overrides_) {
+      cache->set_report_ttl(override_ttl.report_type, override_ttl.report_id, override_ttl.ttl_ms);
+    }
+    transport_ = std::move(cache);
+  }
+  
+  // Attach and detach are handled by a poll right away instead of at the next update()
+  transport_->set_connection_callback([this](bool connected) { on_connection_changed(connected); });
+  
   esp_err_t ret = transport_->initialize();
   if (ret != ESP_OK) {
     ESP_LOGE(TAG, "Transport initialization failed: %s", transport_->get_last_error().c_str());
@@ -189,13 +882,16 @@ bool UpsHidComponent::detect_protocol() {
   
   uint16_t vendor_id = transport_->get_vendor_id();
   
-  if (protocol_selection_ == "auto") {
+  select_device_cache();
+  if (restore_protocol_from_cache()) {
+    UPS_HID_LOGD(TAG, "Skipping protocol detection for vendor 0x%04X", vendor_id);
+  } else if (protocol_selection_ == "auto") {
     // Automatic protocol detection based on vendor ID
-    ESP_LOGD(TAG, "Auto-detecting protocol for vendor 0x%04X using factory", vendor_id);
+    UPS_HID_LOGD(TAG, "Auto-detecting protocol for vendor 0x%04X using factory", vendor_id);
     active_protocol_ = ProtocolFactory::create_for_vendor(vendor_id, this);
   } else {
     // Manual protocol selection via factory
-    ESP_LOGD(TAG, "Using manually selected protocol: %s", protocol_selection_.c_str());
+    UPS_HID_LOGD(TAG, "Using manually selected protocol: %s", protocol_selection_.c_str());
     active_protocol_ = ProtocolFactory::create_by_name(protocol_selection_, this);
   }
   
@@ -205,58 +901,207 @@ bool UpsHidComponent::detect_protocol() {
     return false;
   }
   
-  ESP_LOGI(TAG, "Successfully created protocol: %s", active_protocol_->get_protocol_name().c_str());
-  
-  // Initialize the protocol (detection already done by factory)
-  if (!active_protocol_->initialize()) {
-    ESP_LOGE(TAG, "Protocol initialization failed");
-    active_protocol_.reset();
-    return false;
+  if (!discovery_from_cache_) {
+    ESP_LOGI(TAG, "Successfully created protocol: %s", active_protocol_->get_protocol_name().c_str());
+    
+    // Initialize the protocol (detection already done by factory)
+    if (!active_protocol_->initialize()) {
+      ESP_LOGE(TAG, "Protocol initialization failed");
+      active_protocol_.reset();
+      return false;
+    }
   }
   
   ESP_LOGI(TAG, "Protocol initialized: %s", 
            active_protocol_->get_protocol_name().c_str());
   
   // Set the detected protocol in ups_data_ after successful detection
+  invalidate_report_groups();
+  ups_data_.device.detected_protocol = active_protocol_->get_protocol_type();
   {
     std::lock_guard<std::mutex> lock(data_mutex_);
-    ups_data_.device.detected_protocol = active_protocol_->get_protocol_type();
+    active_protocol_name_ = active_protocol_->get_protocol_name();
+  }
+  publish_snapshot();
+  
+  return true;
+}
+
+void UpsHidComponent::select_device_cache() {
+  discovery_from_cache_ = false;
+  discovery_cache_current_ = !discovery_cache_enabled_ || simulation_mode_;
+  if (discovery_cache_current_) {
+    return;
+  }
+  // Units of the same model keep separate records
+  device_cache_.select(transport_->get_vendor_id(), transport_->get_product_id(), read_serial_number());
+  std::memset(&stored_discovery_, 0, sizeof(stored_discovery_));
+}
+
+// One short control transfer; empty when the device has no serial string
+std::string UpsHidComponent::read_serial_number() {
+  std::string serial;
+  const uint8_t serial_index = transport_->get_serial_number_index();
+  if (serial_index != 0 && transport_->get_string_descriptor(serial_index, serial) != ESP_OK) {
+    serial.clear();
+  }
+  return serial;
+}
+
+bool UpsHidComponent::restore_protocol_from_cache() {
+  // Manual selection always goes through its own protocol's initialize()
+  if (discovery_cache_current_ || protocol_selection_ != "auto") {
+    return false;
+  }
+  DeviceCacheRecord record;
+  if (!device_cache_.load(record)) {
+    return false;
+  }
+  if (record.vendor_id != transport_->get_vendor_id() || record.product_id != transport_->get_product_id()) {
+    ESP_LOGW(TAG, log_messages::DISCOVERY_CACHE_DROPPED, device_cache_.key());
+    device_cache_.erase();
+    return false;
+  }
+  
+  record.protocol_name[sizeof(record.protocol_name) - 1] = '\0';
+  auto protocol = ProtocolFactory::create_by_name(record.protocol_name, this);
+  if (!protocol || protocol->get_protocol_type() != record.protocol ||
+      !protocol->initialize_from_discovery(record.discovery)) {
+    ESP_LOGW(TAG, log_messages::DISCOVERY_CACHE_DROPPED, device_cache_.key());
+    device_cache_.erase();
+    return false;
   }
   
+  // Seed the nominal ratings; the slow group overwrites them on its first read
+  ups_data_.power.input_voltage_nominal = record.input_voltage_nominal;
+  ups_data_.power.output_voltage_nominal = record.output_voltage_nominal;
+  ups_data_.battery.voltage_nominal = record.battery_voltage_nominal;
+  ups_data_.power.realpower_nominal = record.realpower_nominal;
+  ups_data_.power.apparent_power_nominal = record.apparent_power_nominal;
+  
+  ESP_LOGI(TAG, log_messages::DISCOVERY_RESTORED, record.protocol_name, device_cache_.key());
+  active_protocol_ = std::move(protocol);
+  stored_discovery_ = record;
+  discovery_from_cache_ = true;
   return true;
 }
 
+void UpsHidComponent::store_discovery_cache() {
+  DeviceCacheRecord record;
+  std::memset(&record, 0, sizeof(record));  // Padding included, so records compare with memcmp
+  record.version = DeviceCacheRecord::VERSION;
+  record.vendor_id = transport_->get_vendor_id();
+  record.product_id = transport_->get_product_id();
+  record.protocol = static_cast<uint8_t>(active_protocol_->get_protocol_type());
+  strncpy(record.protocol_name, active_protocol_->get_protocol_name().c_str(), sizeof(record.protocol_name) - 1);
+  const bool complete = active_protocol_->save_discovery(record.discovery);
+  record.input_voltage_nominal = ups_data_.power.input_voltage_nominal;
+  record.output_voltage_nominal = ups_data_.power.output_voltage_nominal;
+  record.battery_voltage_nominal = ups_data_.battery.voltage_nominal;
+  record.realpower_nominal = ups_data_.power.realpower_nominal;
+  record.apparent_power_nominal = ups_data_.power.apparent_power_nominal;
+  
+  // NVS writes wear flash; only rewrite when something changed
+  if (std::memcmp(&record, &stored_discovery_, sizeof(record)) != 0 && device_cache_.store(record)) {
+    stored_discovery_ = record;
+  }
+  discovery_cache_current_ = complete;
+}
+
 bool UpsHidComponent::read_ups_data() {
   if (!active_protocol_) {
     ESP_LOGW(TAG, "No active protocol for reading data");
     return false;
   }
   
-  std::lock_guard<std::mutex> lock(data_mutex_);
+  // Continue from the previous poll so groups that are not due keep their
+  // values; the fast group is re-read every poll and starts out unset
+  UpsData next = ups_data_;
+  next.reset_fast_values();
   
-  // Preserve the detected protocol before reset
-  DeviceInfo::DetectedProtocol current_protocol = ups_data_.device.detected_protocol;
+  // Fast group first: it doubles as the liveness check before the slower groups
+  if (!active_protocol_->read_report_group(ReportGroup::FAST, next)) {
+    ESP_LOGW(TAG, "Failed to read UPS data via protocol");
+    return false;
+  }
   
-  // Reset data before reading
-  ups_data_.reset();
+  const uint32_t now = millis();
+  report_group_last_read_[static_cast<size_t>(ReportGroup::FAST)] = now;
+  report_group_valid_[static_cast<size_t>(ReportGroup::FAST)] = true;
   
-  // Restore the detected protocol after reset
-  ups_data_.device.detected_protocol = current_protocol;
+  for (ReportGroup group : {ReportGroup::STATIC, ReportGroup::SLOW}) {
+    if (!is_report_group_due(group, now)) {
+      continue;
+    }
+    const size_t index = static_cast<size_t>(group);
+    UPS_HID_LOGD(TAG, "Refreshing %s report group", group == ReportGroup::STATIC ? "static" : "slow");
+    if (active_protocol_->read_report_group(group, next)) {
+      report_group_last_read_[index] = now;
+      report_group_valid_[index] = true;
+    }
+  }
   
-  // Read data through protocol
-  bool success = active_protocol_->read_data(ups_data_);
+  // Read on every poll, into the same snapshot; the critical poll rate keeps countdowns fresh
+  active_protocol_->read_timer_data(next);
   
-  if (success) {
-    ESP_LOGV(TAG, "Successfully read UPS data");
-  } else {
-    ESP_LOGW(TAG, "Failed to read UPS data via protocol");
+  ups_data_ = std::move(next);
+  history_.record(now, ups_data_);
+  // The history is not part of UpsData, so its change is reported alongside the diff
+  publish_snapshot(history_.capacity() > 0 ? UPS_CHANGE_HISTORY : 0);
+  
+  UPS_HID_LOGV(TAG, "Successfully read UPS data");
+  return true;
+}
+
+bool UpsHidComponent::is_report_group_due(ReportGroup group, uint32_t now) const {
+  const size_t index = static_cast<size_t>(group);
+  if (!report_group_valid_[index]) {
+    return true;
+  }
+  switch (group) {
+    case ReportGroup::STATIC:
+      return false;  // Only re-read after reconnect or protocol reset
+    case ReportGroup::SLOW:
+      return now - report_group_last_read_[index] >= timing::SLOW_REPORT_GROUP_INTERVAL_MS;
+    case ReportGroup::FAST:
+    default:
+      return true;
+  }
+}
+
+void UpsHidComponent::invalidate_report_groups() {
+  for (bool &valid : report_group_valid_) {
+    valid = false;
+  }
+}
+
+void UpsHidComponent::publish_snapshot(uint32_t extra_changes) {
+  UpsDataSnapshot previous = std::atomic_load(&snapshot_);
+  std::atomic_store(&snapshot_, std::make_shared<const UpsData>(ups_data_));
+  const uint32_t generation = snapshot_generation_.fetch_add(1, std::memory_order_release) + 1;
+  {
+    const UpsHotData hot = make_hot_data(ups_data_, generation);
+    std::lock_guard<std::mutex> lock(hot_data_mutex_);
+    hot_data_ = hot;
   }
   
-  return success;
+  const uint32_t changes = diff_ups_data(*previous, ups_data_) | extra_changes;
+  if (changes & UPS_CHANGE_DEVICE) {
+    device_generation_.fetch_add(1, std::memory_order_release);
+  }
+  if (changes != 0) {
+    UPS_HID_LOGV(TAG, "Snapshot changes: 0x%02X", changes);
+    std::lock_guard<std::mutex> lock(snapshot_listeners_mutex_);
+    for (auto &listener : snapshot_listeners_) {
+      listener(changes);
+    }
+  }
 }
 
 void UpsHidComponent::update_sensors() {
-  std::lock_guard<std::mutex> lock(data_mutex_);
+  // Hold one snapshot so every entity publishes from the same poll
+  UpsDataSnapshot snapshot = get_ups_snapshot();
+  const UpsData &data = *snapshot;
   
   // Check if any sensors are registered - if not, skip sensor updates
   size_t total_sensors = 0;
@@ -278,122 +1123,22 @@ void UpsHidComponent::update_sensors() {
   
   ESP_LOGVV(TAG, "Updating %zu registered sensor entities", total_sensors);
   
-  // Update all registered sensors with current data
+  // Each entity decides whether the value changed enough to publish
+  size_t published = 0;
 #ifdef USE_SENSOR  
-  for (auto& sensor_pair : sensors_) {
-    const std::string& type = sensor_pair.first;
-    sensor::Sensor* sensor = sensor_pair.second;
-    
-    // Extract appropriate value based on sensor type
-    float value = NAN;
-    
-    if (type == sensor_type::BATTERY_LEVEL && ups_data_.battery.is_valid()) {
-      value = ups_data_.battery.level;
-    } else if (type == sensor_type::BATTERY_VOLTAGE && !std::isnan(ups_data_.battery.voltage)) {
-      value = ups_data_.battery.voltage;
-    } else if (type == sensor_type::BATTERY_VOLTAGE_NOMINAL && !std::isnan(ups_data_.battery.voltage_nominal)) {
-      value = ups_data_.battery.voltage_nominal;
-    } else if (type == sensor_type::RUNTIME && !std::isnan(ups_data_.battery.runtime_minutes)) {
-      value = ups_data_.battery.runtime_minutes;
-    } else if (type == sensor_type::INPUT_VOLTAGE && !std::isnan(ups_data_.power.input_voltage)) {
-      value = ups_data_.power.input_voltage;
-    } else if (type == sensor_type::INPUT_VOLTAGE_NOMINAL && !std::isnan(ups_data_.power.input_voltage_nominal)) {
-      value = ups_data_.power.input_voltage_nominal;
-    } else if (type == sensor_type::OUTPUT_VOLTAGE && !std::isnan(ups_data_.power.output_voltage)) {
-      value = ups_data_.power.output_voltage;
-    } else if (type == sensor_type::LOAD_PERCENT && !std::isnan(ups_data_.power.load_percent)) {
-      value = ups_data_.power.load_percent;
-    } else if (type == sensor_type::FREQUENCY && !std::isnan(ups_data_.power.frequency)) {
-      value = ups_data_.power.frequency;
-    } else if (type == sensor_type::INPUT_TRANSFER_LOW && !std::isnan(ups_data_.power.input_transfer_low)) {
-      value = ups_data_.power.input_transfer_low;
-    } else if (type == sensor_type::INPUT_TRANSFER_HIGH && !std::isnan(ups_data_.power.input_transfer_high)) {
-      value = ups_data_.power.input_transfer_high;
-    } else if (type == sensor_type::BATTERY_RUNTIME_LOW && !std::isnan(ups_data_.battery.runtime_low)) {
-      value = ups_data_.battery.runtime_low;
-    } else if (type == sensor_type::UPS_REALPOWER_NOMINAL && !std::isnan(ups_data_.power.realpower_nominal)) {
-      value = ups_data_.power.realpower_nominal;
-    } else if (type == sensor_type::UPS_DELAY_SHUTDOWN && !std::isnan(ups_data_.config.delay_shutdown)) {
-      value = ups_data_.config.delay_shutdown;
-    } else if (type == sensor_type::UPS_DELAY_START && !std::isnan(ups_data_.config.delay_start)) {
-      value = ups_data_.config.delay_start;
-    } else if (type == sensor_type::UPS_DELAY_REBOOT && !std::isnan(ups_data_.config.delay_reboot)) {
-      value = ups_data_.config.delay_reboot;
-    } else if (type == sensor_type::UPS_TIMER_REBOOT && ups_data_.test.timer_reboot != -1) {
-      value = ups_data_.test.timer_reboot;
-    } else if (type == sensor_type::UPS_TIMER_SHUTDOWN && ups_data_.test.timer_shutdown != -1) {
-      value = ups_data_.test.timer_shutdown;
-    } else if (type == sensor_type::UPS_TIMER_START && ups_data_.test.timer_start != -1) {
-      value = ups_data_.test.timer_start;
-    }
-    
-    if (!std::isnan(value)) {
-      sensor->publish_state(value);
-    }
+  for (auto *sensor : sensors_) {
+    published += sensor->is_diagnostic() ? sensor->publish_if_changed(*this) : sensor->publish_if_changed(data);
   }
 #endif
-  
-  // Update binary sensors
 #ifdef USE_BINARY_SENSOR
-  for (auto& sensor_pair : binary_sensors_) {
-    const std::string& type = sensor_pair.first;
-    binary_sensor::BinarySensor* sensor = sensor_pair.second;
-    
-    bool state = false;
-    
-    if (type == binary_sensor_type::ONLINE && ups_data_.power.input_voltage_valid()) {
-      state = true;
-    } else if (type == binary_sensor_type::ON_BATTERY && ups_data_.power.input_voltage_valid()) {
-      state = false; // Opposite of online
-    } else if (type == binary_sensor_type::LOW_BATTERY) {
-      state = ups_data_.battery.is_low();
-    }
-    
-    sensor->publish_state(state);
+  const UpsHotData hot = get_hot_data();
+  for (auto *sensor : binary_sensors_) {
+    published += sensor->publish_if_changed(hot);
   }
 #endif
-  
-  // Update text sensors
 #ifdef USE_TEXT_SENSOR  
-  for (auto& sensor_pair : text_sensors_) {
-    const std::string& type = sensor_pair.first;
-    text_sensor::TextSensor* sensor = sensor_pair.second;
-    
-    std::string value = "";
-    
-    if (type == text_sensor_type::MODEL && !ups_data_.device.model.empty()) {
-      value = ups_data_.device.model;
-    } else if (type == text_sensor_type::MANUFACTURER && !ups_data_.device.manufacturer.empty()) {
-      value = ups_data_.device.manufacturer;
-    } else if (type == text_sensor_type::SERIAL_NUMBER && !ups_data_.device.serial_number.empty()) {
-      value = ups_data_.device.serial_number;
-    } else if (type == text_sensor_type::FIRMWARE_VERSION && !ups_data_.device.firmware_version.empty()) {
-      value = ups_data_.device.firmware_version;
-    } else if (type == text_sensor_type::BATTERY_STATUS && !ups_data_.battery.status.empty()) {
-      value = ups_data_.battery.status;
-    } else if (type == text_sensor_type::UPS_TEST_RESULT && !ups_data_.test.ups_test_result.empty()) {
-      value = ups_data_.test.ups_test_result;
-    } else if (type == text_sensor_type::UPS_BEEPER_STATUS && !ups_data_.config.beeper_status.empty()) {
-      value = ups_data_.config.beeper_status;
-    } else if (type == text_sensor_type::INPUT_SENSITIVITY && !ups_data_.config.input_sensitivity.empty()) {
-      value = ups_data_.config.input_sensitivity;
-    } else if (type == text_sensor_type::STATUS && !ups_data_.power.status.empty()) {
-      value = ups_data_.power.status;
-    } else if (type == text_sensor_type::PROTOCOL) {
-      value = get_protocol_name();
-    } else if (type == text_sensor_type::BATTERY_MFR_DATE && !ups_data_.battery.mfr_date.empty()) {
-      value = ups_data_.battery.mfr_date;
-    } else if (type == text_sensor_type::UPS_MFR_DATE && !ups_data_.device.mfr_date.empty()) {
-      value = ups_data_.device.mfr_date;
-    } else if (type == text_sensor_type::BATTERY_TYPE && !ups_data_.battery.type.empty()) {
-      value = ups_data_.battery.type;
-    } else if (type == text_sensor_type::UPS_FIRMWARE_AUX && !ups_data_.device.firmware_aux.empty()) {
-      value = ups_data_.device.firmware_aux;
-    }
-    
-    if (!value.empty()) {
-      sensor->publish_state(value);
-    }
+  for (auto *sensor : text_sensors_) {
+    published += sensor->publish_if_changed(*this, data);
   }
 #endif
   
@@ -407,6 +1152,7 @@ void UpsHidComponent::update_sensors() {
     }
   }
   
+#if UPS_HID_LOG_VERBOSE_ENABLED
   // Log sensor counts (conditional on platform availability)
 #ifdef USE_SENSOR
   size_t sensor_count = sensors_.size();
@@ -424,55 +1170,303 @@ void UpsHidComponent::update_sensors() {
   size_t text_sensor_count = 0;
 #endif
   
-  ESP_LOGV(TAG, "Updated %zu sensors, %zu binary sensors, %zu text sensors", 
-           sensor_count, binary_sensor_count, text_sensor_count);
+  UPS_HID_LOGV(TAG, "Published %zu changes across %zu sensors, %zu binary sensors, %zu text sensors", 
+           published, sensor_count, binary_sensor_count, text_sensor_count);
+#endif
 }
 
-// Sensor registration methods (conditional on platform availability)
+// Sensor registration methods (conditional on platform availability).
+// Types are resolved to accessors once here; an unknown type registers but never publishes.
 #ifdef USE_SENSOR
-void UpsHidComponent::register_sensor(sensor::Sensor *sens, const std::string &type) {
-  sensors_[type] = sens;
-  ESP_LOGD(TAG, "Registered sensor: %s", type.c_str());
+// Delays and timers use -1 for "not set"
+static float seconds_or_nan(int16_t seconds) { return seconds != -1 ? static_cast<float>(seconds) : NAN; }
+
+struct SensorSourceDef {
+  const char *type;
+  SensorValueSource source;
+};
+
+static constexpr SensorSourceDef SENSOR_SOURCES[] = {
+  {sensor_type::BATTERY_LEVEL, [](const UpsData &d) { return d.battery.is_valid() ? d.battery.level : NAN; }},
+  {sensor_type::BATTERY_VOLTAGE, [](const UpsData &d) { return d.battery.voltage; }},
+  {sensor_type::BATTERY_VOLTAGE_NOMINAL, [](const UpsData &d) { return d.battery.voltage_nominal; }},
+  {sensor_type::RUNTIME, [](const UpsData &d) { return d.battery.runtime_minutes; }},
+  {sensor_type::BATTERY_CHARGE_LOW, [](const UpsData &d) { return d.battery.charge_low; }},
+  {sensor_type::BATTERY_CHARGE_WARNING, [](const UpsData &d) { return d.battery.charge_warning; }},
+  {sensor_type::BATTERY_RUNTIME_LOW, [](const UpsData &d) { return d.battery.runtime_low; }},
+  {sensor_type::INPUT_VOLTAGE, [](const UpsData &d) { return d.power.input_voltage; }},
+  {sensor_type::INPUT_VOLTAGE_NOMINAL, [](const UpsData &d) { return d.power.input_voltage_nominal; }},
+  {sensor_type::OUTPUT_VOLTAGE, [](const UpsData &d) { return d.power.output_voltage; }},
+  {sensor_type::LOAD_PERCENT, [](const UpsData &d) { return d.power.load_percent; }},
+  {sensor_type::FREQUENCY, [](const UpsData &d) { return d.power.frequency; }},
+  {sensor_type::INPUT_TRANSFER_LOW, [](const UpsData &d) { return d.power.input_transfer_low; }},
+  {sensor_type::INPUT_TRANSFER_HIGH, [](const UpsData &d) { return d.power.input_transfer_high; }},
+  {sensor_type::UPS_REALPOWER_NOMINAL, [](const UpsData &d) { return d.power.realpower_nominal; }},
+  {sensor_type::UPS_DELAY_SHUTDOWN, [](const UpsData &d) { return seconds_or_nan(d.config.delay_shutdown); }},
+  {sensor_type::UPS_DELAY_START, [](const UpsData &d) { return seconds_or_nan(d.config.delay_start); }},
+  {sensor_type::UPS_DELAY_REBOOT, [](const UpsData &d) { return seconds_or_nan(d.config.delay_reboot); }},
+  {sensor_type::UPS_TIMER_REBOOT, [](const UpsData &d) { return seconds_or_nan(d.test.timer_reboot); }},
+  {sensor_type::UPS_TIMER_SHUTDOWN, [](const UpsData &d) { return seconds_or_nan(d.test.timer_shutdown); }},
+  {sensor_type::UPS_TIMER_START, [](const UpsData &d) { return seconds_or_nan(d.test.timer_start); }},
+};
+
+struct DiagnosticSourceDef {
+  const char *type;
+  DiagnosticValueSource source;
+};
+
+static constexpr DiagnosticSourceDef DIAGNOSTIC_SOURCES[] = {
+  {sensor_type::POLL_DURATION, [](const UpsHidComponent &c) { return c.get_poll_timing().last_us / 1000.0f; }},
+  {sensor_type::POLL_DURATION_MAX, [](const UpsHidComponent &c) { return c.get_poll_timing().max_us / 1000.0f; }},
+  {sensor_type::PROTOCOL_LOCK_WAIT, [](const UpsHidComponent &c) {
+     const PollTimingStats timing = c.get_poll_timing();
+     return timing.lock_waits > 0 ? timing.lock_wait_total_us / 1000.0f / timing.lock_waits : NAN;
+   }},
+  {sensor_type::ACQUISITION_WAKE_LATENCY, [](const UpsHidComponent &c) {
+     const PollTimingStats timing = c.get_poll_timing();
+     return timing.wakes > 0 ? timing.wake_last_us / 1000.0f : NAN;
+   }},
+  {sensor_type::USB_TRANSFERS, [](const UpsHidComponent &c) { return static_cast<float>(c.get_transfer_totals().transfers); }},
+  {sensor_type::USB_TIMEOUTS, [](const UpsHidComponent &c) { return static_cast<float>(c.get_transfer_totals().timeouts); }},
+  {sensor_type::USB_ERRORS, [](const UpsHidComponent &c) { return static_cast<float>(c.get_transfer_totals().errors); }},
+  {sensor_type::USB_BYTES, [](const UpsHidComponent &c) { return static_cast<float>(c.get_transfer_totals().bytes); }},
+  {sensor_type::MEMORY_USAGE, [](const UpsHidComponent &c) {
+     const MemoryUsage memory = c.get_memory_usage();
+     return static_cast<float>(memory.static_bytes + memory.dynamic_bytes);
+   }},
+  {sensor_type::MEMORY_USAGE_PEAK, [](const UpsHidComponent &c) {
+     const MemoryUsage memory = c.get_memory_usage();
+     return static_cast<float>(memory.static_bytes + memory.dynamic_peak);
+   }},
+  {sensor_type::ACQUISITION_STACK_FREE, [](const UpsHidComponent &c) {
+     const uint32_t free_bytes = c.get_acquisition_stack_free();
+     return free_bytes > 0 ? static_cast<float>(free_bytes) : NAN;
+   }},
+  {sensor_type::USB_STACK_FREE, [](const UpsHidComponent &c) {
+     const uint32_t free_bytes = c.get_usb_stack_free();
+     return free_bytes > 0 ? static_cast<float>(free_bytes) : NAN;
+   }},
+};
+
+void UpsHidComponent::register_sensor(UpsHidSensor *sens, const std::string &type) {
+  for (const auto &def : SENSOR_SOURCES) {
+    if (type == def.type) {
+      sens->set_value_source(def.source);
+      break;
+    }
+  }
+  for (const auto &def : DIAGNOSTIC_SOURCES) {
+    if (type == def.type) {
+      sens->set_diagnostic_source(def.source);
+      instrumentation_enabled_ = true;
+      break;
+    }
+  }
+  if (sens->get_value_source() == nullptr && !sens->is_diagnostic()) {
+    ESP_LOGW(TAG, "No data source for sensor type: %s", type.c_str());
+  }
+  sensors_.push_back(sens);
+  UPS_HID_LOGD(TAG, "Registered sensor: %s", type.c_str());
 }
 #endif
 
 #ifdef USE_BINARY_SENSOR
-void UpsHidComponent::register_binary_sensor(binary_sensor::BinarySensor *sens, const std::string &type) {
-  binary_sensors_[type] = sens;
-  ESP_LOGD(TAG, "Registered binary sensor: %s", type.c_str());
+struct BinarySensorSourceDef {
+  const char *type;
+  BinarySensorStateSource source;
+};
+
+static constexpr BinarySensorSourceDef BINARY_SENSOR_SOURCES[] = {
+  {binary_sensor_type::ONLINE, [](const UpsHotData &d) { return d.is_online(); }},
+  {binary_sensor_type::ON_BATTERY, [](const UpsHotData &d) { return d.is_on_battery(); }},
+  {binary_sensor_type::LOW_BATTERY, [](const UpsHotData &d) { return d.is_low_battery(); }},
+  {binary_sensor_type::CHARGING, [](const UpsHotData &d) { return d.is_charging(); }},
+  {binary_sensor_type::FAULT, [](const UpsHotData &d) { return d.has_fault(); }},
+  {binary_sensor_type::OVERLOAD, [](const UpsHotData &d) { return d.is_overloaded(); }},
+};
+
+void UpsHidComponent::register_binary_sensor(UpsHidBinarySensor *sens, const std::string &type) {
+  for (const auto &def : BINARY_SENSOR_SOURCES) {
+    if (type == def.type) {
+      sens->set_state_source(def.source);
+      break;
+    }
+  }
+  if (sens->get_state_source() == nullptr) {
+    ESP_LOGW(TAG, "No data source for binary sensor type: %s", type.c_str());
+  }
+  binary_sensors_.push_back(sens);
+  UPS_HID_LOGD(TAG, "Registered binary sensor: %s", type.c_str());
 }
 #endif
 
 #ifdef USE_TEXT_SENSOR
-void UpsHidComponent::register_text_sensor(text_sensor::TextSensor *sens, const std::string &type) {
-  text_sensors_[type] = sens;
-  ESP_LOGD(TAG, "Registered text sensor: %s", type.c_str());
+struct TextSensorSourceDef {
+  const char *type;
+  TextSensorValueSource source;
+};
+
+static constexpr TextSensorSourceDef TEXT_SENSOR_SOURCES[] = {
+  {text_sensor_type::MODEL, [](const UpsHidComponent &, const UpsData &d) { return d.device.model; }},
+  {text_sensor_type::MANUFACTURER, [](const UpsHidComponent &, const UpsData &d) { return d.device.manufacturer; }},
+  {text_sensor_type::SERIAL_NUMBER, [](const UpsHidComponent &, const UpsData &d) { return d.device.serial_number; }},
+  {text_sensor_type::FIRMWARE_VERSION, [](const UpsHidComponent &, const UpsData &d) { return d.device.firmware_version; }},
+  {text_sensor_type::BATTERY_STATUS, [](const UpsHidComponent &, const UpsData &d) { return d.battery.status; }},
+  {text_sensor_type::UPS_TEST_RESULT, [](const UpsHidComponent &, const UpsData &d) { return d.test.ups_test_result; }},
+  {text_sensor_type::UPS_BEEPER_STATUS, [](const UpsHidComponent &, const UpsData &d) { return d.config.beeper_status; }},
+  {text_sensor_type::INPUT_SENSITIVITY, [](const UpsHidComponent &, const UpsData &d) { return d.config.input_sensitivity; }},
+  {text_sensor_type::STATUS, [](const UpsHidComponent &, const UpsData &d) { return d.power.status_text(); }},
+  {text_sensor_type::PROTOCOL, [](const UpsHidComponent &parent, const UpsData &) { return parent.get_protocol_name(); }},
+  {text_sensor_type::BATTERY_MFR_DATE, [](const UpsHidComponent &, const UpsData &d) { return d.battery.mfr_date; }},
+  {text_sensor_type::UPS_MFR_DATE, [](const UpsHidComponent &, const UpsData &d) { return d.device.mfr_date; }},
+  {text_sensor_type::BATTERY_TYPE, [](const UpsHidComponent &, const UpsData &d) { return d.battery.type; }},
+  {text_sensor_type::UPS_FIRMWARE_AUX, [](const UpsHidComponent &, const UpsData &d) { return d.device.firmware_aux; }},
+};
+
+void UpsHidComponent::register_text_sensor(UpsHidTextSensor *sens, const std::string &type) {
+  for (const auto &def : TEXT_SENSOR_SOURCES) {
+    if (type == def.type) {
+      sens->set_value_source(def.source);
+      break;
+    }
+  }
+  if (sens->get_value_source() == nullptr) {
+    ESP_LOGW(TAG, "No data source for text sensor type: %s", type.c_str());
+  }
+  text_sensors_.push_back(sens);
+  UPS_HID_LOGD(TAG, "Registered text sensor: %s", type.c_str());
 }
 #endif
 
 void UpsHidComponent::register_delay_number(UpsDelayNumber *number) {
   delay_numbers_.push_back(number);
-  ESP_LOGD(TAG, "Registered delay number component");
+  UPS_HID_LOGD(TAG, "Registered delay number component");
+}
+
+bool UpsHidComponent::submit_command(UpsCommand command, int value, CommandCallback &&callback) {
+  {
+    std::lock_guard<std::mutex> lock(command_mutex_);
+    if (command_queue_count_ == limits::COMMAND_QUEUE_SIZE) {
+      ESP_LOGW(TAG, log_messages::COMMAND_QUEUE_FULL, command_name(command));
+      return false;
+    }
+    PendingCommand &slot = command_queue_[(command_queue_head_ + command_queue_count_) % limits::COMMAND_QUEUE_SIZE];
+    slot.command = command;
+    slot.value = value;
+    slot.callback = std::move(callback);
+    slot.success = false;
+    command_queue_count_++;
+  }
+  UPS_HID_LOGD(TAG, "Queued %s", command_name(command));
+  
+#ifdef USE_ESP32
+  notify_acquisition_task();
+#endif
+  return true;
+}
+
+bool UpsHidComponent::execute_pending_commands() {
+  bool executed = false;
+  while (true) {
+    PendingCommand pending;
+    {
+      std::lock_guard<std::mutex> lock(command_mutex_);
+      if (command_queue_count_ == 0) {
+        break;
+      }
+      pending = std::move(command_queue_[command_queue_head_]);
+      command_queue_head_ = (command_queue_head_ + 1) % limits::COMMAND_QUEUE_SIZE;
+      command_queue_count_--;
+    }
+    
+    pending.success = execute_command(pending.command, pending.value);
+    if (!pending.success) {
+      ESP_LOGW(TAG, log_messages::COMMAND_FAILED, command_name(pending.command));
+    }
+    executed = true;
+    
+    if (pending.callback) {
+      std::lock_guard<std::mutex> lock(command_mutex_);
+      completed_commands_.push_back(std::move(pending));
+      commands_completed_ = true;
+    }
+  }
+  return executed;
+}
+
+void UpsHidComponent::dispatch_completed_commands() {
+  if (!commands_completed_.exchange(false)) {
+    return;
+  }
+  std::vector<PendingCommand> completed;
+  {
+    std::lock_guard<std::mutex> lock(command_mutex_);
+    completed.swap(completed_commands_);
+  }
+  for (auto &command : completed) {
+    command.callback(command.success);
+  }
+}
+
+bool UpsHidComponent::execute_command(UpsCommand command, int value) {
+  switch (command) {
+    case UpsCommand::BEEPER_ENABLE:
+      return beeper_enable();
+    case UpsCommand::BEEPER_DISABLE:
+      return beeper_disable();
+    case UpsCommand::BEEPER_MUTE:
+      return beeper_mute();
+    case UpsCommand::BEEPER_TEST:
+      return beeper_test();
+    case UpsCommand::BATTERY_TEST_QUICK:
+      return start_battery_test_quick();
+    case UpsCommand::BATTERY_TEST_DEEP:
+      return start_battery_test_deep();
+    case UpsCommand::BATTERY_TEST_STOP:
+      return stop_battery_test();
+    case UpsCommand::UPS_TEST_START:
+      return start_ups_test();
+    case UpsCommand::UPS_TEST_STOP:
+      return stop_ups_test();
+    case UpsCommand::SET_SHUTDOWN_DELAY:
+      return set_shutdown_delay(value);
+    case UpsCommand::SET_START_DELAY:
+      return set_start_delay(value);
+    case UpsCommand::SET_REBOOT_DELAY:
+      return set_reboot_delay(value);
+  }
+  return false;
 }
 
 // Test control methods
 bool UpsHidComponent::start_battery_test_quick() {
+  std::lock_guard<std::mutex> lock(protocol_mutex_);
   if (!active_protocol_) {
     ESP_LOGW(TAG, "No active protocol for battery test");
     return false;
   }
-  return active_protocol_->start_battery_test_quick();
+  if (!active_protocol_->start_battery_test_quick()) {
+    return false;
+  }
+  poll_rate_ = PollRate::ACTIVE;  // Follow the test until a poll sees it finished
+  return true;
 }
 
 bool UpsHidComponent::start_battery_test_deep() {
+  std::lock_guard<std::mutex> lock(protocol_mutex_);
   if (!active_protocol_) {
     ESP_LOGW(TAG, "No active protocol for battery test");
     return false;
   }
-  return active_protocol_->start_battery_test_deep();
+  if (!active_protocol_->start_battery_test_deep()) {
+    return false;
+  }
+  poll_rate_ = PollRate::ACTIVE;  // Follow the test until a poll sees it finished
+  return true;
 }
 
 bool UpsHidComponent::stop_battery_test() {
+  std::lock_guard<std::mutex> lock(protocol_mutex_);
   if (!active_protocol_) {
     ESP_LOGW(TAG, "No active protocol for battery test");
     return false;
@@ -481,14 +1475,20 @@ bool UpsHidComponent::stop_battery_test() {
 }
 
 bool UpsHidComponent::start_ups_test() {
+  std::lock_guard<std::mutex> lock(protocol_mutex_);
   if (!active_protocol_) {
     ESP_LOGW(TAG, "No active protocol for UPS test");
     return false;
   }
-  return active_protocol_->start_ups_test();
+  if (!active_protocol_->start_ups_test()) {
+    return false;
+  }
+  poll_rate_ = PollRate::ACTIVE;  // Follow the test until a poll sees it finished
+  return true;
 }
 
 bool UpsHidComponent::stop_ups_test() {
+  std::lock_guard<std::mutex> lock(protocol_mutex_);
   if (!active_protocol_) {
     ESP_LOGW(TAG, "No active protocol for UPS test");
     return false;
@@ -498,30 +1498,46 @@ bool UpsHidComponent::stop_ups_test() {
 
 // Beeper control methods
 bool UpsHidComponent::beeper_enable() {
+  std::lock_guard<std::mutex> lock(protocol_mutex_);
   if (!active_protocol_) {
     ESP_LOGW(TAG, "No active protocol for beeper control");
     return false;
   }
-  return active_protocol_->beeper_enable();
+  if (!active_protocol_->beeper_enable()) {
+    return false;
+  }
+  invalidate_report_group(ReportGroup::SLOW);  // Read the new setting back on the next poll
+  return true;
 }
 
 bool UpsHidComponent::beeper_disable() {
+  std::lock_guard<std::mutex> lock(protocol_mutex_);
   if (!active_protocol_) {
     ESP_LOGW(TAG, "No active protocol for beeper control");
     return false;
   }
-  return active_protocol_->beeper_disable();
+  if (!active_protocol_->beeper_disable()) {
+    return false;
+  }
+  invalidate_report_group(ReportGroup::SLOW);
+  return true;
 }
 
 bool UpsHidComponent::beeper_mute() {
+  std::lock_guard<std::mutex> lock(protocol_mutex_);
   if (!active_protocol_) {
     ESP_LOGW(TAG, "No active protocol for beeper control");
     return false;
   }
-  return active_protocol_->beeper_mute();
+  if (!active_protocol_->beeper_mute()) {
+    return false;
+  }
+  invalidate_report_group(ReportGroup::SLOW);
+  return true;
 }
 
 bool UpsHidComponent::beeper_test() {
+  std::lock_guard<std::mutex> lock(protocol_mutex_);
   if (!active_protocol_) {
     ESP_LOGW(TAG, "No active protocol for beeper control");
     return false;
@@ -531,33 +1547,49 @@ bool UpsHidComponent::beeper_test() {
 
 // Delay configuration methods
 bool UpsHidComponent::set_shutdown_delay(int seconds) {
+  std::lock_guard<std::mutex> lock(protocol_mutex_);
   if (!active_protocol_) {
     ESP_LOGW(TAG, "No active protocol for delay configuration");
     return false;
   }
-  return active_protocol_->set_shutdown_delay(seconds);
+  if (!active_protocol_->set_shutdown_delay(seconds)) {
+    return false;
+  }
+  invalidate_report_group(ReportGroup::SLOW);
+  return true;
 }
 
 bool UpsHidComponent::set_start_delay(int seconds) {
+  std::lock_guard<std::mutex> lock(protocol_mutex_);
   if (!active_protocol_) {
     ESP_LOGW(TAG, "No active protocol for delay configuration");
     return false;
   }
-  return active_protocol_->set_start_delay(seconds);
+  if (!active_protocol_->set_start_delay(seconds)) {
+    return false;
+  }
+  invalidate_report_group(ReportGroup::SLOW);
+  return true;
 }
 
 bool UpsHidComponent::set_reboot_delay(int seconds) {
+  std::lock_guard<std::mutex> lock(protocol_mutex_);
   if (!active_protocol_) {
     ESP_LOGW(TAG, "No active protocol for delay configuration");
     return false;
   }
-  return active_protocol_->set_reboot_delay(seconds);
+  if (!active_protocol_->set_reboot_delay(seconds)) {
+    return false;
+  }
+  invalidate_report_group(ReportGroup::SLOW);
+  return true;
 }
 
 // Additional protocol access method
 std::string UpsHidComponent::get_protocol_name() const {
-  if (active_protocol_) {
-    return active_protocol_->get_protocol_name();
+  std::lock_guard<std::mutex> lock(data_mutex_);
+  if (!active_protocol_name_.empty()) {
+    return active_protocol_name_;
   }
   return protocol::NONE;
 }
@@ -598,141 +1630,82 @@ void UpsHidComponent::cleanup() {
     transport_.reset();
   }
   
-  active_protocol_.reset();
+  reset_protocol();
   connected_ = false;
   
-  ESP_LOGD(TAG, "Component cleanup completed");
+  UPS_HID_LOGD(TAG, "Component cleanup completed");
 }
 
-// Timer polling implementation
-void UpsHidComponent::check_and_update_timers() {
-  if (!active_protocol_) return;
-  
-  uint32_t now = millis();
-  
-  // Check if we need to poll timers
-  bool should_poll_timers = false;
-  
-  if (fast_polling_mode_) {
-    // In fast polling mode, check every 2 seconds
-    if (now - last_timer_poll_ >= FAST_POLL_INTERVAL_MS) {
-      should_poll_timers = true;
-    }
-  } else {
-    // Check if any timers might be active (less frequent check)
-    if (now - last_timer_poll_ >= get_update_interval()) {
-      should_poll_timers = true;
-    }
+// Adaptive poll rate implementation
+PollRate UpsHidComponent::select_poll_rate() const {
+  const uint32_t flags = derive_state_flags(ups_data_);
+  if (flags & UPS_STATE_TIMER_ACTIVE) {
+    return PollRate::CRITICAL;
   }
   
-  if (should_poll_timers) {
-    last_timer_poll_ = now;
-    
-    // Try to read timer data
-    UpsData timer_data = ups_data_;  // Copy current data
-    if (active_protocol_->read_timer_data(timer_data)) {
-      // Update only timer-related fields
-      {
-        std::lock_guard<std::mutex> lock(data_mutex_);
-        ups_data_.test.timer_shutdown = timer_data.test.timer_shutdown;
-        ups_data_.test.timer_start = timer_data.test.timer_start;
-        ups_data_.test.timer_reboot = timer_data.test.timer_reboot;
-      }
-      
-      // Update fast polling mode based on timer activity
-      bool timers_active = has_active_timers();
-      if (timers_active != fast_polling_mode_) {
-        set_fast_polling_mode(timers_active);
-      }
-      
-      // Update timer sensors immediately when values change
-      update_sensors();
-    }
+  constexpr uint32_t ACTIVE_STATES = UPS_STATE_LOW_BATTERY | UPS_STATE_CHARGING | UPS_STATE_FAULT |
+                                     UPS_STATE_OVERLOAD | UPS_STATE_TEST_RUNNING;
+  if (!(flags & UPS_STATE_ONLINE) || (flags & ACTIVE_STATES)) {
+    return PollRate::ACTIVE;
   }
+  return PollRate::IDLE;
 }
 
-bool UpsHidComponent::has_active_timers() const {
-  std::lock_guard<std::mutex> lock(data_mutex_);
-  return (ups_data_.test.timer_shutdown > 0 || 
-          ups_data_.test.timer_start > 0 || 
-          ups_data_.test.timer_reboot > 0);
-}
-
-void UpsHidComponent::set_fast_polling_mode(bool enable) {
-  if (enable != fast_polling_mode_) {
-    fast_polling_mode_ = enable;
-    if (enable) {
-      ESP_LOGI(TAG, "Enabled fast polling for timer countdown");
-    } else {
-      ESP_LOGI(TAG, "Disabled fast polling, returning to normal interval");
-    }
-  }
+void UpsHidComponent::apply_poll_rate(PollRate rate) {
+  static const char *const RATE_NAMES[POLL_RATE_COUNT] = {"idle", "active", "critical"};
+  const uint32_t interval_ms = get_poll_interval(rate);
+  ESP_LOGI(TAG, "Poll rate %s -> %s (%u ms)", RATE_NAMES[static_cast<size_t>(applied_poll_rate_)],
+           RATE_NAMES[static_cast<size_t>(rate)], interval_ms);
+  applied_poll_rate_ = rate;
+  
+  // Re-arms the "update" interval; the poll that picked this rate has just run
+  set_update_interval(interval_ms);
+  start_poller();
 }
 
 // Convenient state getters for lambda expressions (no sensor entities required)
 bool UpsHidComponent::is_online() const {
-  std::lock_guard<std::mutex> lock(data_mutex_);
-  // UPS is online when input voltage is valid (same logic as binary sensor update)
-  return ups_data_.power.input_voltage_valid();
+  return get_hot_data().is_online();
 }
 
 bool UpsHidComponent::is_on_battery() const {
-  std::lock_guard<std::mutex> lock(data_mutex_);
-  // UPS is on battery when NOT online (opposite of online state)
-  return !ups_data_.power.input_voltage_valid();
+  return get_hot_data().is_on_battery();
 }
 
 bool UpsHidComponent::is_low_battery() const {
-  std::lock_guard<std::mutex> lock(data_mutex_);
-  // Use battery's built-in low battery detection
-  return ups_data_.battery.is_low();
+  return get_hot_data().is_low_battery();
 }
 
 bool UpsHidComponent::is_charging() const {
-  std::lock_guard<std::mutex> lock(data_mutex_);
-  // Charging when online AND battery level is not 100%
-  return ups_data_.power.input_voltage_valid() && 
-         ups_data_.battery.is_valid() && 
-         !std::isnan(ups_data_.battery.level) && 
-         ups_data_.battery.level < 100.0f;
+  return get_hot_data().is_charging();
 }
 
 bool UpsHidComponent::has_fault() const {
-  std::lock_guard<std::mutex> lock(data_mutex_);
-  // Check for various fault conditions based on available data
-  return ups_data_.power.is_input_out_of_range() || 
-         (!ups_data_.power.is_valid() && !ups_data_.battery.is_valid());
+  return get_hot_data().has_fault();
 }
 
 bool UpsHidComponent::is_overloaded() const {
-  std::lock_guard<std::mutex> lock(data_mutex_);
-  // Use power's built-in overload detection
-  return ups_data_.power.is_overloaded();
+  return get_hot_data().is_overloaded();
 }
 
 float UpsHidComponent::get_battery_level() const {
-  std::lock_guard<std::mutex> lock(data_mutex_);
-  return ups_data_.battery.is_valid() ? ups_data_.battery.level : NAN;
+  return get_hot_data().battery_level;
 }
 
 float UpsHidComponent::get_input_voltage() const {
-  std::lock_guard<std::mutex> lock(data_mutex_);
-  return ups_data_.power.input_voltage;
+  return get_hot_data().input_voltage;
 }
 
 float UpsHidComponent::get_output_voltage() const {
-  std::lock_guard<std::mutex> lock(data_mutex_);
-  return ups_data_.power.output_voltage;
+  return get_hot_data().output_voltage;
 }
 
 float UpsHidComponent::get_load_percent() const {
-  std::lock_guard<std::mutex> lock(data_mutex_);
-  return ups_data_.power.load_percent;
+  return get_hot_data().load_percent;
 }
 
 float UpsHidComponent::get_runtime_minutes() const {
-  std::lock_guard<std::mutex> lock(data_mutex_);
-  return ups_data_.battery.runtime_minutes;
+  return get_hot_data().runtime_minutes;
 }
 
 
@@ -4,6 +4,7 @@
 #include "esphome/core/defines.h"
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
+#include "esphome/core/hal.h"
 
 // Forward declarations for optional sensor platforms
 #ifdef USE_SENSOR
@@ -26,6 +27,9 @@ namespace esphome { namespace text_sensor { class TextSensor; } }
 #include <unordered_map>
 #include <string>
 #include <mutex>
+#include <atomic>
+#include <functional>
+#include <bitset>
 
 #ifdef USE_ESP32
 #include "esp_err.h"
@@ -47,8 +51,18 @@ namespace esphome { namespace text_sensor { class TextSensor; } }
 // Include the clean refactored architecture
 #include "data_composite.h"
 #include "transport_interface.h"
+#include "transport_simulation.h"
+#include "transport_instrumented.h"
+#include "transport_tracing.h"
 #include "protocol_factory.h"
 #include "constants_hid.h"
+#include "hid_report.h"
+#include "data_history.h"
+#include "data_hot.h"
+#include "device_cache.h"
+#include "report_breaker.h"
+#include "hid_descriptor.h"
+#include "task_config.h"
 
 namespace esphome
 {
@@ -61,6 +75,58 @@ namespace esphome
     class UpsProtocolBase;
     class IUsbTransport;
 
+    // Protocol report groups, each refreshed on its own schedule
+    enum class ReportGroup : uint8_t {
+      FAST = 0,  // Every poll: status, battery level, voltages, load
+      SLOW,      // Every few minutes: nominal ratings, thresholds, configuration
+      STATIC,    // Once per connection: identity strings, serial, firmware
+    };
+    static constexpr size_t REPORT_GROUP_COUNT = 3;
+
+    // Poll rates, picked from the UPS state after every poll
+    enum class PollRate : uint8_t {
+      IDLE = 0,  // Online, battery full, nothing in progress
+      ACTIVE,    // On battery, low battery, charging, fault or test running; also while detecting
+      CRITICAL,  // Shutdown, start or reboot countdown running
+    };
+    static constexpr size_t POLL_RATE_COUNT = 3;
+
+    // Control commands, executed by the polling context between reads
+    enum class UpsCommand : uint8_t {
+      BEEPER_ENABLE = 0,
+      BEEPER_DISABLE,
+      BEEPER_MUTE,
+      BEEPER_TEST,
+      BATTERY_TEST_QUICK,
+      BATTERY_TEST_DEEP,
+      BATTERY_TEST_STOP,
+      UPS_TEST_START,
+      UPS_TEST_STOP,
+      SET_SHUTDOWN_DELAY,  // value: seconds
+      SET_START_DELAY,
+      SET_REBOOT_DELAY,
+    };
+    const char *command_name(UpsCommand command);
+
+    // Invoked from the main loop once a command has run
+    using CommandCallback = std::function<void(bool success)>;
+
+    // Poll cycle and protocol lock timing, recorded when instrumentation is enabled
+    struct PollTimingStats {
+      uint32_t polls{0};
+      uint32_t last_us{0};
+      uint32_t max_us{0};
+      uint64_t total_us{0};
+      uint32_t lock_waits{0};  // Acquisitions of the protocol lock by the poller
+      uint32_t lock_wait_max_us{0};
+      uint64_t lock_wait_total_us{0};
+      // From update() notifying the acquisition task to the task running: scheduling jitter
+      uint32_t wakes{0};
+      uint32_t wake_last_us{0};
+      uint32_t wake_max_us{0};
+      uint64_t wake_total_us{0};
+    };
+
     class UpsHidComponent : public PollingComponent
     {
     public:
@@ -69,11 +135,50 @@ namespace esphome
 
       void setup() override;
       void update() override;
+      void loop() override;
       void dump_config() override;
+      void on_shutdown() override;
       float get_setup_priority() const override { return setup_priority::DATA; }
 
       // Configuration setters with validation
       void set_simulation_mode(bool simulation_mode) { simulation_mode_ = simulation_mode; }
+      void set_simulation_vendor(SimulationVendor vendor) { simulation_config_.vendor = vendor; }
+      void set_simulation_seed(uint32_t seed) { simulation_config_.seed = seed; }
+      void set_simulation_latency(uint32_t latency_ms, uint32_t jitter_ms) {
+        simulation_config_.latency_ms = latency_ms;
+        simulation_config_.latency_jitter_ms = jitter_ms;
+      }
+      void set_simulation_fault_rates(float stall_rate, float timeout_rate) {
+        simulation_config_.stall_rate = stall_rate;
+        simulation_config_.timeout_rate = timeout_rate;
+      }
+      void add_simulation_unresponsive_report(uint8_t report_id) {
+        simulation_config_.unresponsive_reports.push_back(report_id);
+      }
+      void set_simulation_outage(uint32_t interval_ms, uint32_t duration_ms) {
+        simulation_config_.outage_interval_ms = interval_ms;
+        simulation_config_.outage_duration_ms = duration_ms;
+      }
+      // Frames must be added in time order
+      void add_simulation_trace_frame(uint32_t at_ms, uint8_t report_type, uint8_t report_id,
+                                      std::vector<uint8_t> data) {
+        simulation_config_.trace.push_back({at_ms, report_type, report_id, std::move(data)});
+      }
+      void set_simulation_trace_period(uint32_t period_ms) { simulation_config_.trace_period_ms = period_ms; }
+      void set_simulation_trace_speed(float speed) { simulation_config_.trace_speed = speed; }
+      // Replay of a capture: presents the captured device instead of an emulated one
+      void set_simulation_replay(uint16_t vendor_id, uint16_t product_id, uint8_t serial_index) {
+        simulation_config_.replay = true;
+        simulation_config_.vendor_id = vendor_id;
+        simulation_config_.product_id = product_id;
+        simulation_config_.serial_index = serial_index;
+      }
+      void add_simulation_string(uint8_t index, const std::string &value) {
+        simulation_config_.strings.push_back({index, value});
+      }
+      void set_simulation_report_descriptor(std::vector<uint8_t> descriptor) {
+        simulation_config_.report_descriptor = std::move(descriptor);
+      }
       void set_usb_vendor_id(uint16_t vendor_id) { 
         usb_vendor_id_ = vendor_id; 
       }
@@ -87,16 +192,101 @@ namespace esphome
       }
       void set_protocol_selection(const std::string &protocol) { protocol_selection_ = protocol; }
       void set_fallback_nominal_voltage(float voltage) { fallback_nominal_voltage_ = voltage; }
+      void set_acquisition_task(bool enabled) { acquisition_task_enabled_ = enabled; }
+      // Core (-1 for none), priority and stack of the FreeRTOS tasks
+      void set_acquisition_task_config(int8_t core, uint8_t priority, uint32_t stack_size) {
+        acquisition_task_config_ = {acquisition::TASK_NAME, stack_size, priority, core};
+      }
+      void set_usb_host_task_config(int8_t core, uint8_t priority, uint32_t stack_size) {
+        usb_task_config_.host = {usb_tasks::HOST_TASK_NAME, stack_size, priority, core};
+      }
+      void set_usb_client_task_config(int8_t core, uint8_t priority, uint32_t stack_size) {
+        usb_task_config_.client = {usb_tasks::CLIENT_TASK_NAME, stack_size, priority, core};
+      }
+      void set_interrupt_streaming(bool enabled) { interrupt_streaming_enabled_ = enabled; }
+      void set_idle_update_interval(uint32_t interval_ms) {
+        poll_intervals_ms_[static_cast<size_t>(PollRate::IDLE)] = interval_ms;
+      }
+      void set_critical_update_interval(uint32_t interval_ms) {
+        poll_intervals_ms_[static_cast<size_t>(PollRate::CRITICAL)] = interval_ms;
+      }
+      void set_report_cache_ttl(uint32_t ttl_ms) { report_cache_ttl_ms_ = ttl_ms; }
+      void set_history_size(size_t samples) { history_size_ = std::min(samples, limits::MAX_HISTORY_SIZE); }
+      void set_history_window(uint32_t window_ms) { history_window_ms_ = window_ms; }
+      void set_discovery_cache(bool enabled) { discovery_cache_enabled_ = enabled; }
+      // 0 always re-detects after a reconnect
+      void set_reconnect_window(uint32_t window_ms) { reconnect_window_ms_ = window_ms; }
+      // Also turned on by registering a diagnostic sensor; must be set before setup()
+      void set_instrumentation(bool enabled) { instrumentation_enabled_ |= enabled; }
+      void add_report_cache_override(uint8_t report_type, uint8_t report_id, uint32_t ttl_ms) {
+        report_cache_overrides_.push_back({report_type, report_id, ttl_ms});
+      }
+      // Report trace ring in bytes; 0 disables capture
+      void set_capture_buffer_size(size_t bytes) { capture_buffer_size_ = bytes; }
+#ifdef USE_UPS_HID_CAPTURE
+      void set_capture_download(web_server_base::WebServerBase *web_server, const std::string &path) {
+        capture_web_server_ = web_server;
+        capture_path_ = path;
+      }
+#endif
 
-      // Data getters for sensors (thread-safe)
-      UpsData get_ups_data() const { 
-        std::lock_guard<std::mutex> lock(data_mutex_);
-        return ups_data_; 
+      // Data getters for sensors (thread-safe, never block on the poller)
+      UpsDataSnapshot get_ups_snapshot() const { return std::atomic_load(&snapshot_); }
+      UpsData get_ups_data() const { return *get_ups_snapshot(); }
+      // Incremented on every published snapshot; lets consumers cache derived data
+      uint32_t get_snapshot_generation() const { return snapshot_generation_.load(std::memory_order_acquire); }
+      // Numbers and state flags of the latest snapshot, without the strings
+      UpsHotData get_hot_data() const {
+        std::lock_guard<std::mutex> lock(hot_data_mutex_);
+        return hot_data_;
+      }
+      // Incremented only when identity strings (manufacturer, model, serial, firmware) change
+      uint32_t get_device_generation() const { return device_generation_.load(std::memory_order_acquire); }
+      // Called from the polling context with the UPS_CHANGE_* bits whenever a
+      // published snapshot differs from the previous one; keep it short
+      void add_on_snapshot_change_callback(std::function<void(uint32_t)> &&callback) {
+        std::lock_guard<std::mutex> lock(snapshot_listeners_mutex_);
+        snapshot_listeners_.push_back(std::move(callback));
       }
       std::string get_protocol_name() const;
+      
+      // Per-poll history (empty unless history_size is set); safe from any task
+      const UpsHistory &get_history() const { return history_; }
+      UpsHistoryStats get_history_stats(HistoryField field, uint32_t window_ms) const {
+        return history_.stats(field, window_ms, millis());
+      }
+      // Over the configured history_window
+      UpsHistoryStats get_history_stats(HistoryField field) const {
+        return get_history_stats(field, history_window_ms_);
+      }
       uint32_t get_protocol_timeout() const { return protocol_timeout_ms_; }
+      
+      // Instrumentation (zeros unless enabled); safe from any task
+      bool is_instrumentation_enabled() const { return instrumentation_enabled_; }
+      PollTimingStats get_poll_timing() const {
+        std::lock_guard<std::mutex> lock(instrumentation_mutex_);
+        return poll_timing_;
+      }
+      TransferTotals get_transfer_totals() const {
+        return instrumented_transport_ ? instrumented_transport_->get_totals() : TransferTotals{};
+      }
+      bool get_report_transfer_stats(uint8_t report_type, uint8_t report_id, ReportTransferStats &stats) const {
+        return instrumented_transport_ && instrumented_transport_->get_report_stats(report_type, report_id, stats);
+      }
+      size_t get_report_transfer_stats(ReportTransferStats *stats, size_t max_count) const {
+        return instrumented_transport_ ? instrumented_transport_->get_tracked_reports(stats, max_count) : 0;
+      }
       float get_fallback_nominal_voltage() const { return fallback_nominal_voltage_; }
       
+      // Memory accounting, refreshed on every poll; safe from any task
+      MemoryUsage get_memory_usage() const {
+        return {sizeof(*this), memory_dynamic_.load(std::memory_order_relaxed),
+                memory_peak_.load(std::memory_order_relaxed)};
+      }
+      // Stack left on the acquisition and USB client tasks in bytes; 0 without them
+      uint32_t get_acquisition_stack_free() const;
+      uint32_t get_usb_stack_free() const { return transport_ ? transport_->get_task_stack_free() : 0; }
+      
       // Convenient state getters for lambda expressions (no sensor entities required)
       bool is_online() const;
       bool is_on_battery() const;  
@@ -110,6 +300,13 @@ namespace esphome
       float get_load_percent() const;
       float get_runtime_minutes() const;
       
+      // Queues a command for the polling context and returns immediately; false
+      // if the queue is full. The callback runs on the main loop, after which a
+      // poll reads the affected reports back. Safe from any task.
+      bool submit_command(UpsCommand command, int value = 0, CommandCallback &&callback = nullptr);
+      
+      // Direct control methods: block on the USB transfer and wait for any
+      // poll in progress. Entities and network handlers use submit_command().
       // Test control methods
       bool start_battery_test_quick();
       bool start_battery_test_deep();
@@ -127,17 +324,16 @@ namespace esphome
       bool set_shutdown_delay(int seconds);
       bool set_start_delay(int seconds);
       bool set_reboot_delay(int seconds);
-      void request_delay_refresh() { /* No-op for now - could trigger update if needed */ }
 
       // Sensor registration methods (conditional on platform availability)
 #ifdef USE_SENSOR      
-      void register_sensor(sensor::Sensor *sens, const std::string &type);
+      void register_sensor(UpsHidSensor *sens, const std::string &type);
 #endif
 #ifdef USE_BINARY_SENSOR
-      void register_binary_sensor(binary_sensor::BinarySensor *sens, const std::string &type);
+      void register_binary_sensor(UpsHidBinarySensor *sens, const std::string &type);
 #endif
 #ifdef USE_TEXT_SENSOR
-      void register_text_sensor(text_sensor::TextSensor *sens, const std::string &type);
+      void register_text_sensor(UpsHidTextSensor *sens, const std::string &type);
 #endif
       void register_delay_number(class UpsDelayNumber *number);
       
@@ -146,23 +342,74 @@ namespace esphome
 
     protected:
       bool simulation_mode_{false};
+      SimulationConfig simulation_config_;
       uint16_t usb_vendor_id_{0};  // 0 means auto-detect
       uint16_t usb_product_id_{0}; // 0 means auto-detect
       uint32_t protocol_timeout_ms_{10000};
       std::string protocol_selection_{"auto"};
       float fallback_nominal_voltage_{230.0f};  // European standard (230V) for international compatibility
+      bool acquisition_task_enabled_{false};
+      TaskConfig acquisition_task_config_{acquisition::TASK_NAME, acquisition::TASK_STACK_SIZE,
+                                          acquisition::TASK_PRIORITY};
+      UsbTaskConfig usb_task_config_{
+          {usb_tasks::HOST_TASK_NAME, usb_tasks::HOST_TASK_STACK_SIZE, usb_tasks::HOST_TASK_PRIORITY},
+          {usb_tasks::CLIENT_TASK_NAME, usb_tasks::CLIENT_TASK_STACK_SIZE, usb_tasks::CLIENT_TASK_PRIORITY},
+      };
+      std::atomic<uint32_t> poll_requested_us_{0};  // micros() | 1 of the pending update() notify, for wake latency
+      bool interrupt_streaming_enabled_{false};
+      uint32_t report_cache_ttl_ms_{1000};  // 0 disables the caching transport
+      size_t history_size_{0};               // 0 disables the history
+      bool instrumentation_enabled_{false};
+      uint32_t history_window_ms_{timing::DEFAULT_HISTORY_WINDOW_MS};
+      struct ReportCacheOverride {
+        uint8_t report_type;
+        uint8_t report_id;
+        uint32_t ttl_ms;
+      };
+      std::vector<ReportCacheOverride> report_cache_overrides_;
 
       bool connected_{false};
       uint32_t last_successful_read_{0};
       uint32_t consecutive_failures_{0};
       uint32_t max_consecutive_failures_{5};  // Limit re-detection attempts
-      UpsData ups_data_;
-      mutable std::mutex data_mutex_;  // Protect ups_data_ access
+      UpsData ups_data_;  // Working copy, only touched by the polling context
+      UpsDataSnapshot snapshot_{std::make_shared<const UpsData>()};  // Published via atomic_load/atomic_store
+      std::atomic<uint32_t> snapshot_generation_{0};
+      UpsHotData hot_data_;  // Copied out under hot_data_mutex_, never holds strings
+      mutable std::mutex hot_data_mutex_;
+      std::atomic<uint32_t> device_generation_{0};
+      std::vector<std::function<void(uint32_t)>> snapshot_listeners_;
+      std::mutex snapshot_listeners_mutex_;  // Listeners may register after the acquisition task starts
+      std::string active_protocol_name_;  // Cached for readers outside the polling context
+      mutable std::mutex data_mutex_;  // Protect active_protocol_name_ access
+      std::mutex protocol_mutex_;      // Serialize protocol/USB access between polling and controls
       
-      // Fast polling for timer countdown
-      bool fast_polling_mode_{false};
-      uint32_t last_timer_poll_{0};
-      static constexpr uint32_t FAST_POLL_INTERVAL_MS = 2000;  // 2 seconds during countdown
+      // Acquisition state shared between the polling context and the main loop
+      std::atomic<bool> snapshot_pending_{false};
+      std::atomic<bool> detection_exhausted_{false};
+      std::atomic<bool> input_report_pending_{false};  // Set from the USB task on streamed reports
+      uint32_t last_input_report_poll_ms_{0};  // Main loop only
+      
+      // One sample per successful poll, recorded by the polling context
+      UpsHistory history_;
+      
+      // Report group schedule, owned by the polling context
+      uint32_t report_group_last_read_[REPORT_GROUP_COUNT]{};
+      bool report_group_valid_[REPORT_GROUP_COUNT]{};
+#ifdef USE_ESP32
+      // Set and cleared on the main loop only; read from the USB and NUT tasks too
+      std::atomic<TaskHandle_t> acquisition_task_handle_{nullptr};
+      std::mutex acquisition_task_mutex_;  // Notifying vs deleting the task
+      SemaphoreHandle_t acquisition_stopped_{nullptr};  // Given by the task once it has parked
+      std::atomic<bool> acquisition_running_{false};
+#endif
+      
+      // Adaptive poll rate: chosen by the polling context, applied to the poller by the main loop.
+      // The ACTIVE entry is filled from update_interval in setup().
+      uint32_t poll_intervals_ms_[POLL_RATE_COUNT]{timing::DEFAULT_IDLE_POLL_INTERVAL_MS, 0,
+                                                   timing::DEFAULT_CRITICAL_POLL_INTERVAL_MS};
+      std::atomic<PollRate> poll_rate_{PollRate::ACTIVE};
+      PollRate applied_poll_rate_{PollRate::ACTIVE};
       
       // Error rate limiting to prevent log spam
       struct ErrorRateLimit {
@@ -179,28 +426,130 @@ namespace esphome
       std::unique_ptr<IUsbTransport> transport_;
       std::unique_ptr<UpsProtocolBase> active_protocol_;
       
-      // Sensor storage (conditional on platform availability)
+      // Parsed report descriptor of the connected device, loaded on first use
+      HidReportDescriptor report_descriptor_;
+      bool report_descriptor_loaded_{false};
+      
+      // Report IDs that keep timing out are skipped; reads of one poll share a deadline
+      ReportCircuitBreaker report_breaker_;
+      uint32_t poll_deadline_ms_{0};  // millis(); 0 outside a poll cycle
+      
+      // Raw report capture, recorded by a transport decorator on the device
+      size_t capture_buffer_size_{0};
+      ReportTrace capture_;
+#ifdef USE_UPS_HID_CAPTURE
+      web_server_base::WebServerBase *capture_web_server_{nullptr};
+      std::string capture_path_;
+#endif
+      
+      // Instrumentation; the transport decorator is owned by the transport_ chain
+      InstrumentedUsbTransport *instrumented_transport_{nullptr};
+      PollTimingStats poll_timing_;
+      mutable std::mutex instrumentation_mutex_;
+      void record_poll_timing(uint32_t lock_wait_us, uint32_t poll_us);
+      void record_wake_latency(uint32_t wake_us);
+      
+      // Heap held through this component, estimated by the polling context
+      std::atomic<size_t> memory_dynamic_{0};
+      std::atomic<size_t> memory_peak_{0};
+      void update_memory_usage();
+      
+      // Persisted discovery results, owned by the polling context
+      bool discovery_cache_enabled_{true};
+      DeviceCache device_cache_;
+      DeviceCacheRecord stored_discovery_{};  // As last loaded or stored, for change detection
+      bool discovery_from_cache_{false};      // Active protocol was restored rather than detected
+      bool discovery_cache_current_{false};   // Nothing left to store for this connection
+      
+      // Reconnect handling. The connection fields are owned by the polling context;
+      // the *_at_ms_ stamps (millis() | 1, 0 for none) come from the USB task.
+      struct DeviceIdentity {
+        uint16_t vendor_id{0};
+        uint16_t product_id{0};
+        std::string serial;
+        bool operator==(const DeviceIdentity &other) const {
+          return vendor_id == other.vendor_id && product_id == other.product_id && serial == other.serial;
+        }
+      };
+      uint32_t reconnect_window_ms_{timing::DEFAULT_RECONNECT_WINDOW_MS};
+      uint32_t connection_id_{0};      // Transport connection the protocol state belongs to
+      DeviceIdentity device_identity_;  // Of that connection
+      uint32_t recovery_started_ms_{0};  // Attach whose first successful read is still pending
+      std::atomic<uint32_t> detached_at_ms_{0};
+      std::atomic<uint32_t> attached_at_ms_{0};
+      std::atomic<bool> connection_changed_{false};  // Wakes a main loop poll without the acquisition task
+      std::atomic<uint32_t> fast_reconnects_{0};
+      std::atomic<uint32_t> full_reconnects_{0};
+      std::atomic<uint32_t> last_recovery_ms_{0};
+      
+      // Commands waiting for the polling context, and results waiting for the main loop
+      struct PendingCommand {
+        UpsCommand command{UpsCommand::BEEPER_ENABLE};
+        int value{0};
+        CommandCallback callback;
+        bool success{false};
+      };
+      PendingCommand command_queue_[limits::COMMAND_QUEUE_SIZE];
+      size_t command_queue_head_{0};
+      size_t command_queue_count_{0};
+      std::vector<PendingCommand> completed_commands_;
+      std::mutex command_mutex_;  // Guards the queue and completed_commands_
+      std::atomic<bool> commands_completed_{false};
+      
+      // Sensor storage (conditional on platform availability); each entity carries
+      // the accessor resolved from its type, so publishing never compares strings
 #ifdef USE_SENSOR      
-      std::unordered_map<std::string, sensor::Sensor *> sensors_;
+      std::vector<UpsHidSensor *> sensors_;
 #endif
 #ifdef USE_BINARY_SENSOR
-      std::unordered_map<std::string, binary_sensor::BinarySensor *> binary_sensors_;
+      std::vector<UpsHidBinarySensor *> binary_sensors_;
 #endif
 #ifdef USE_TEXT_SENSOR
-      std::unordered_map<std::string, text_sensor::TextSensor *> text_sensors_;
+      std::vector<UpsHidTextSensor *> text_sensors_;
 #endif
       std::vector<class UpsDelayNumber *> delay_numbers_;
 
       // Core methods
       bool initialize_transport();
       bool detect_protocol();
+      void select_device_cache();
+      std::string read_serial_number();
+      void handle_new_connection(uint32_t connection_id);
+      bool restore_protocol_from_cache();
+      void store_discovery_cache();
       bool read_ups_data();
       void update_sensors();
+      // extra_changes: UPS_CHANGE_* bits for state outside UpsData
+      void publish_snapshot(uint32_t extra_changes = 0);
+      bool poll_device();
+      void reset_protocol();
+      bool execute_command(UpsCommand command, int value);
+      // Runs the queued commands; true if any ran, so a poll should read them back
+      bool execute_pending_commands();
+      void dispatch_completed_commands();
+      void on_input_report(uint8_t report_id);
+      void on_connection_changed(bool connected);
+      bool is_report_group_due(ReportGroup group, uint32_t now) const;
+      void invalidate_report_groups();
+      void invalidate_report_group(ReportGroup group) { report_group_valid_[static_cast<size_t>(group)] = false; }
+      void invalidate_report_descriptor();
+      // Limits timeout_ms to what is left of the poll deadline; 0 once it has passed
+      uint32_t clamp_to_poll_deadline(uint32_t timeout_ms, uint32_t now, bool &clamped) const;
       
-      // Timer polling methods
-      void check_and_update_timers();
-      bool has_active_timers() const;
-      void set_fast_polling_mode(bool enable);
+      // Background acquisition task
+#ifdef USE_ESP32
+      bool start_acquisition_task();
+      // False while the task is still busy after timeout_ms; 0 only checks
+      bool stop_acquisition_task(uint32_t timeout_ms);
+      // False when there is no task to wake
+      bool notify_acquisition_task();
+      static void acquisition_task(void *param);
+#endif
+      
+      // Adaptive poll rate
+      PollRate select_poll_rate() const;
+      void apply_poll_rate(PollRate rate);
+      uint32_t get_poll_interval(PollRate rate) const { return poll_intervals_ms_[static_cast<size_t>(rate)]; }
       
       // Error rate limiting helpers
       bool should_log_error(ErrorRateLimit& limiter);
@@ -214,8 +563,16 @@ namespace esphome
       esp_err_t hid_set_report(uint8_t report_type, uint8_t report_id,
                              const uint8_t* data, size_t data_len,
                              uint32_t timeout_ms = 1000);
+      // Batched GET_REPORT, see IUsbTransport::hid_get_reports()
+      esp_err_t hid_get_reports(HidReportRequest* requests, size_t count, uint32_t timeout_ms);
+      // Detection round: reads each ID not yet in results once, as Input and then
+      // as Feature for those that fail, in batches of limits::MAX_REPORT_BATCH
+      void probe_reports(const uint8_t* report_ids, size_t count, ProbeResults& results);
       esp_err_t get_string_descriptor(uint8_t string_index, std::string& result);
       
+      // Parsed HID report descriptor, or nullptr if the transport cannot supply one
+      const HidReportDescriptor* get_report_descriptor();
+      
       // Transport information
       bool is_connected() const;
       uint16_t get_vendor_id() const; 
@@ -242,9 +599,42 @@ namespace esphome
 
       virtual bool detect() = 0;
       virtual bool initialize() = 0;
+      
+      // Detection through the factory's shared probe round: the report IDs this
+      // protocol would probe and a score for the answers (0 = not this protocol).
+      // Protocols without probe IDs are detected with detect() instead.
+      virtual size_t get_probe_report_ids(const uint8_t **report_ids) const {
+        *report_ids = nullptr;
+        return 0;
+      }
+      virtual int score_probe(const ProbeResults &results) const {
+        const uint8_t *report_ids;
+        const size_t count = get_probe_report_ids(&report_ids);
+        return static_cast<int>(results.count_answered(report_ids, count));
+      }
+      // Called on the winner before initialize() so it can reuse the answers
+      virtual void use_probe_results(const ProbeResults &results) {}
       virtual bool read_data(UpsData &data) = 0;
+      
+      // Read a single report group into data, which still holds the values from
+      // earlier polls. Protocols that do not split their reads keep the old
+      // behaviour: a full read_data() into a fresh UpsData on every poll.
+      virtual bool read_report_group(ReportGroup group, UpsData &data) {
+        if (group != ReportGroup::FAST) {
+          return true;
+        }
+        UpsData fresh;
+        fresh.device.detected_protocol = data.device.detected_protocol;
+        if (!read_data(fresh)) {
+          return false;
+        }
+        data = std::move(fresh);
+        return true;
+      }
       virtual DeviceInfo::DetectedProtocol get_protocol_type() const = 0;
       virtual std::string get_protocol_name() const = 0;
+      // Heap held by the protocol, its own object included
+      virtual size_t get_memory_usage() const = 0;
       
       // Beeper control methods
       virtual bool beeper_enable() { return false; }
@@ -262,6 +652,12 @@ namespace esphome
       // Timer polling method for real-time countdown
       virtual bool read_timer_data(UpsData &data) { return false; }
       
+      // Discovery state persisted across reconnects (DeviceCache). save_discovery()
+      // returns false while there is more to learn; initialize_from_discovery()
+      // replaces initialize() when the protocol is restored from the cache.
+      virtual bool save_discovery(ProtocolDiscovery &discovery) const { return true; }
+      virtual bool initialize_from_discovery(const ProtocolDiscovery &discovery) { return initialize(); }
+      
       // Delay configuration methods
       virtual bool set_shutdown_delay(int seconds) { return false; }
       virtual bool set_start_delay(int seconds) { return false; }
@@ -270,8 +666,19 @@ namespace esphome
     protected:
       UpsHidComponent *parent_;
 
+      // Read up to limits::MAX_REPORT_BATCH reports as one transport batch
+      // sharing the protocol timeout. Each ID is first requested with the type
+      // that last answered for it (initially preferred_type); IDs that fail are
+      // retried with the other type in the same budget. Reports that could not
+      // be read are left empty. Returns the number of reports read.
+      size_t read_reports(const uint8_t *report_ids, HidReport *reports, size_t count, uint8_t preferred_type);
+
       bool send_command(const std::vector<uint8_t> &cmd, std::vector<uint8_t> &response, uint32_t timeout_ms = 1000);
       std::string bytes_to_string(const std::vector<uint8_t> &data);
+
+    private:
+      // Report IDs that answer with the type other than the caller's preferred one
+      std::bitset<256> alternate_type_;
     };
 
 
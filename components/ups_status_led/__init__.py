@@ -5,6 +5,7 @@ from esphome.const import (
     CONF_ID,
     CONF_BRIGHTNESS,
     CONF_TIME_ID,
+    CONF_TRANSITION_LENGTH,
 )
 
 CONF_ENABLED = "enabled"
@@ -29,6 +30,8 @@ CONF_END_TIME = "end_time"
 CONF_BATTERY_COLOR_MODE = "battery_color_mode"
 CONF_BATTERY_LOW_THRESHOLD = "battery_low_threshold"
 CONF_BATTERY_WARNING_THRESHOLD = "battery_warning_threshold"
+CONF_CRITICAL_BREATHING = "critical_breathing"
+CONF_BREATHING_PERIOD = "breathing_period"
 
 def validate_time(value):
     """Validate time format HH:MM"""
@@ -69,6 +72,15 @@ CONFIG_SCHEMA = cv.Schema({
     
     cv.Optional(CONF_NIGHT_MODE): NIGHT_MODE_SCHEMA,
     
+    # Fade between patterns (default: the light's default_transition_length)
+    cv.Optional(CONF_TRANSITION_LENGTH): cv.positive_time_period_milliseconds,
+    # Slow brightness breathing while in the critical pattern
+    cv.Optional(CONF_CRITICAL_BREATHING, default=False): cv.boolean,
+    cv.Optional(CONF_BREATHING_PERIOD, default="2s"): cv.All(
+        cv.positive_time_period_milliseconds,
+        cv.Range(min=cv.TimePeriod(milliseconds=500)),
+    ),
+    
     cv.Optional(CONF_BATTERY_LOW_THRESHOLD, default=20.0): cv.float_range(
         min=0, max=100
     ),
@@ -99,6 +111,12 @@ async def to_code(config):
     cg.add(var.set_brightness(config[CONF_BRIGHTNESS]))
     cg.add(var.set_battery_color_mode(config[CONF_BATTERY_COLOR_MODE]))
     
+    # Animations
+    if CONF_TRANSITION_LENGTH in config:
+        cg.add(var.set_transition_length(config[CONF_TRANSITION_LENGTH]))
+    cg.add(var.set_critical_breathing(config[CONF_CRITICAL_BREATHING]))
+    cg.add(var.set_breathing_period(config[CONF_BREATHING_PERIOD]))
+    
     # Battery thresholds
     cg.add(var.set_battery_low_threshold(config[CONF_BATTERY_LOW_THRESHOLD]))
     cg.add(var.set_battery_warning_threshold(config[CONF_BATTERY_WARNING_THRESHOLD]))
@@ -7,6 +7,56 @@ namespace ups_status_led {
 
 static const char *const TAG = "ups_status_led";
 
+// Color tables, built at compile time so applying a pattern is a lookup
+static constexpr size_t PATTERN_COUNT = static_cast<size_t>(LedPattern::COMPONENT_ERROR) + 1;
+static constexpr size_t GRADIENT_STEPS = 17;  // Red, through yellow at the midpoint, to green
+
+template<size_t N> struct LedColorTable {
+  LedColor colors[N];
+};
+
+// Indexed by LedPattern
+static constexpr LedColorTable<PATTERN_COUNT> DAY_PATTERN_COLORS = {{
+    {0, 0, 0},        // OFF
+    {255, 0, 0},      // CRITICAL_SOLID: red
+    {255, 128, 0},    // BATTERY_WARNING: orange
+    {255, 255, 0},    // CHARGING_SOLID: yellow
+    {0, 255, 0},      // NORMAL_SOLID: green
+    {0, 0, 255},      // OFFLINE_SOLID: blue
+    {204, 0, 255},    // NO_DATA_SOLID: purple
+    {255, 255, 255},  // COMPONENT_ERROR: white
+}};
+
+// A dimmed WS2812 drifts towards red, so night mode boosts green by 60%
+// (orange 0.5 -> 0.8, as the old per-call compensation settled at for any
+// brightness above the 20% floor)
+static constexpr LedColor night_compensate(LedColor color) {
+  const unsigned green = color.g * 8u / 5u;
+  return LedColor{color.r, static_cast<uint8_t>(green > 255 ? 255 : green), color.b};
+}
+
+template<size_t N> static constexpr LedColorTable<N> night_table(const LedColorTable<N> &day) {
+  LedColorTable<N> night{};
+  for (size_t i = 0; i < N; i++) {
+    night.colors[i] = night_compensate(day.colors[i]);
+  }
+  return night;
+}
+
+static constexpr LedColorTable<GRADIENT_STEPS> make_gradient() {
+  constexpr size_t half = (GRADIENT_STEPS - 1) / 2;
+  LedColorTable<GRADIENT_STEPS> gradient{};
+  for (size_t i = 0; i < GRADIENT_STEPS; i++) {
+    gradient.colors[i] = i <= half ? LedColor{255, static_cast<uint8_t>(255 * i / half), 0}
+                                   : LedColor{static_cast<uint8_t>(255 * (GRADIENT_STEPS - 1 - i) / half), 255, 0};
+  }
+  return gradient;
+}
+
+static constexpr LedColorTable<PATTERN_COUNT> NIGHT_PATTERN_COLORS = night_table(DAY_PATTERN_COLORS);
+static constexpr LedColorTable<GRADIENT_STEPS> DAY_GRADIENT = make_gradient();
+static constexpr LedColorTable<GRADIENT_STEPS> NIGHT_GRADIENT = night_table(DAY_GRADIENT);
+
 void UpsStatusLedComponent::setup() {
   ESP_LOGI(TAG, "*** UPS STATUS LED SETUP STARTING ***");
   ESP_LOGCONFIG(TAG, "Setting up UPS Status LED...");
@@ -30,6 +80,24 @@ void UpsStatusLedComponent::setup() {
   // This ensures the light component is working and ready
   initialize_light_component();
   
+  // The LED only changes with the UPS status, so it is re-evaluated on status
+  // changes instead of on every loop pass. Runs in the polling context: only flag it
+  ups_hid_->add_on_snapshot_change_callback([this](uint32_t changes) {
+    // The gradient also follows the charge
+    if ((changes & ups_hid::UPS_CHANGE_STATUS) ||
+        ((changes & ups_hid::UPS_CHANGE_BATTERY) && battery_color_mode_ == BatteryColorMode::GRADIENT)) {
+      evaluation_pending_.store(true, std::memory_order_relaxed);
+    }
+  });
+  // A disconnect is not a snapshot change, and night mode follows the clock
+  set_interval(STATE_CHECK_INTERVAL_MS, [this]() { check_state(); });
+  set_timeout(STARTUP_DELAY_MS, [this]() {
+    ESP_LOGI(TAG, "LED startup delay complete - forcing initial pattern evaluation");
+    check_state();
+    started_ = true;
+    force_update_ = true;
+  });
+  
   // Initialize Home Assistant entities with SAFE callbacks
 #ifdef USE_SWITCH
   if (enabled_switch_) {
@@ -60,98 +128,88 @@ void UpsStatusLedComponent::setup() {
 }
 
 void UpsStatusLedComponent::loop() {
-  static bool first_evaluation = true;
-  static uint32_t startup_delay = 0;
-  
-  if (first_evaluation) {
-    ESP_LOGI(TAG, "*** UPS STATUS LED FIRST LOOP - COMPONENT IS RUNNING ***");
-    startup_delay = millis() + 2000;  // 2 second startup delay for UPS initialization
-    first_evaluation = false;
+  // Idle cost is two flag loads; everything that can change the LED raises one
+  if (!started_ || (!force_update_.load(std::memory_order_relaxed) &&
+                    !evaluation_pending_.load(std::memory_order_relaxed))) {
+    return;
   }
-  
-  uint32_t now = millis();
+  const bool forced = force_update_.exchange(false);
+  evaluation_pending_.store(false, std::memory_order_relaxed);
   
   // Thread-safe state access
   std::lock_guard<std::mutex> lock(state_mutex_);
   
-  // Handle disabled state properly (don't interfere with startup delay)
   if (!enabled_) {
-    // Only turn off LED if we're past startup or if we've already started
-    if (startup_delay == 0 || now >= startup_delay) {
-      ESP_LOGD(TAG, "LED disabled - turning off");
-      set_led_color(0, 0, 0, 0);
-      startup_delay = 0;  // Clear startup delay
-      force_update_ = false;  // Clear flag
-    }
+    ESP_LOGD(TAG, "LED disabled - turning off");
+    update_breathing(false);
+    set_led_color(0, 0, 0, 0);
     return;
   }
   
-  // Wait for startup delay to complete
-  if (startup_delay > 0 && now < startup_delay) {
-    return;
+  // Evaluate and apply pattern; a status change that keeps the color leaves the LED alone
+  LedPattern new_pattern = evaluate_pattern();
+  if (new_pattern != current_pattern_ || calculate_color(new_pattern) != applied_color_ || forced) {
+    ESP_LOGD(TAG, "Pattern update: reason=%s, pattern=%d", 
+             new_pattern != current_pattern_ ? "PATTERN_CHANGE" : "FORCED", (int)new_pattern);
+    
+    current_pattern_ = new_pattern;
+    pattern_start_time_ = millis();
+    apply_pattern(current_pattern_);
+    publish_status();
   }
-  
-  // Clear startup delay after waiting
-  bool startup_complete = false;
-  if (startup_delay > 0) {
-    startup_complete = true;
-    startup_delay = 0;
-    force_update_ = true;  // Force first update after startup delay
-    ESP_LOGI(TAG, "LED startup delay complete - forcing initial pattern evaluation");
+}
+
+void UpsStatusLedComponent::check_state() {
+  const bool connected = ups_hid_->is_connected();
+  if (connected != connected_) {
+    connected_ = connected;
+    evaluation_pending_.store(true, std::memory_order_relaxed);
   }
   
-  bool should_update = (now - last_update_ >= UPDATE_INTERVAL_MS) || force_update_;
-  
-  if (should_update) {
-    // Evaluate and apply pattern
-    LedPattern new_pattern = evaluate_pattern();
-    
-    // Update on startup completion, pattern changes, or forced updates
-    if (startup_complete || new_pattern != current_pattern_ || force_update_) {
-      ESP_LOGD(TAG, "Pattern update: reason=%s, pattern=%d, forced=%s", 
-               startup_complete ? "STARTUP_COMPLETE" : (new_pattern != current_pattern_ ? "PATTERN_CHANGE" : "FORCED"),
-               (int)new_pattern,
-               force_update_ ? "true" : "false");
-      
-      current_pattern_ = new_pattern;
-      pattern_start_time_ = now;
-      apply_pattern(current_pattern_);
-      force_update_ = false;  // Clear flag after update
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  const bool night_time = is_night_time();
+  if (night_time != night_time_) {
+    night_time_ = night_time;
+    if (night_mode_enabled_) {
+      force_update_ = true;  // Same pattern, new brightness
     }
-    last_update_ = now;
   }
-  
-  // Update Home Assistant entities periodically
-  static uint32_t last_ha_update = 0;
-  if (now - last_ha_update > 1000) {  // Update every second
+}
+
+void UpsStatusLedComponent::publish_status() {
 #ifdef USE_TEXT_SENSOR
-    if (status_text_sensor_) {
-      std::string pattern_name;
-      switch (current_pattern_) {
-        case LedPattern::NORMAL_SOLID: pattern_name = "Normal"; break;
-        case LedPattern::CHARGING_SOLID: pattern_name = "Charging"; break;
-        case LedPattern::BATTERY_WARNING: pattern_name = "Battery Warning"; break;
-        case LedPattern::CRITICAL_SOLID: pattern_name = "Critical"; break;
-        case LedPattern::OFFLINE_SOLID: pattern_name = "Offline"; break;
-        case LedPattern::NO_DATA_SOLID: pattern_name = "No Data"; break;
-        case LedPattern::COMPONENT_ERROR: pattern_name = "Component Error"; break;
-        default: pattern_name = "Off"; break;
-      }
-      if (status_text_sensor_->state != pattern_name) {
-        status_text_sensor_->publish_state(pattern_name);
-      }
+  if (status_text_sensor_) {
+    const char *pattern_name;
+    switch (current_pattern_) {
+      case LedPattern::NORMAL_SOLID: pattern_name = "Normal"; break;
+      case LedPattern::CHARGING_SOLID: pattern_name = "Charging"; break;
+      case LedPattern::BATTERY_WARNING: pattern_name = "Battery Warning"; break;
+      case LedPattern::CRITICAL_SOLID: pattern_name = "Critical"; break;
+      case LedPattern::OFFLINE_SOLID: pattern_name = "Offline"; break;
+      case LedPattern::NO_DATA_SOLID: pattern_name = "No Data"; break;
+      case LedPattern::COMPONENT_ERROR: pattern_name = "Component Error"; break;
+      default: pattern_name = "Off"; break;
+    }
+    if (status_text_sensor_->state != pattern_name) {
+      status_text_sensor_->publish_state(pattern_name);
     }
-#endif
-    last_ha_update = now;
   }
+#endif
 }
 
 void UpsStatusLedComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "UPS Status LED:");
   ESP_LOGCONFIG(TAG, "  Enabled: %s", enabled_ ? "YES" : "NO");
+  ESP_LOGCONFIG(TAG, "  Memory: %zu bytes static, no heap or task", sizeof(*this));
   ESP_LOGCONFIG(TAG, "  Brightness: %.1f%%", brightness_ * 100);
   ESP_LOGCONFIG(TAG, "  Battery Color Mode: %s", 
     battery_color_mode_ == BatteryColorMode::DISCRETE ? "Discrete" : "Gradient");
+  if (transition_length_set_) {
+    ESP_LOGCONFIG(TAG, "  Transition Length: %u ms", transition_length_ms_);
+  }
+  if (critical_breathing_) {
+    ESP_LOGCONFIG(TAG, "  Critical Breathing: %u ms period", breathing_period_ms_);
+  }
   ESP_LOGCONFIG(TAG, "  Night Mode: %s", night_mode_enabled_ ? "YES" : "NO");
   if (night_mode_enabled_) {
     ESP_LOGCONFIG(TAG, "    Time: %02d:%02d - %02d:%02d", 
@@ -175,19 +233,23 @@ LedPattern UpsStatusLedComponent::evaluate_pattern() {
     return LedPattern::OFFLINE_SOLID;
   }
   
-  if (ups_hid_->is_low_battery() || ups_hid_->has_fault() || ups_hid_->is_overloaded()) {
+  // State flags of one consistent poll, copied without touching the snapshot strings
+  const ups_hid::UpsHotData data = ups_hid_->get_hot_data();
+  battery_level_ = data.battery_level;
+  
+  if (data.is_low_battery() || data.has_fault() || data.is_overloaded()) {
     return LedPattern::CRITICAL_SOLID;
   }
   
-  if (ups_hid_->is_on_battery()) {
+  if (data.is_on_battery()) {
     return LedPattern::BATTERY_WARNING;
   }
   
-  if (ups_hid_->is_charging()) {
+  if (data.is_charging()) {
     return LedPattern::CHARGING_SOLID;
   }
   
-  if (ups_hid_->is_online()) {
+  if (data.is_online()) {
     return LedPattern::NORMAL_SOLID;
   }
   
@@ -195,124 +257,79 @@ LedPattern UpsStatusLedComponent::evaluate_pattern() {
 }
 
 void UpsStatusLedComponent::apply_pattern(LedPattern pattern) {
-  float brightness = calculate_brightness(); // Calculate once
-  float r, g, b;
-  calculate_color(r, g, b, pattern, brightness); // Pass brightness as parameter
-  
-  // Simple solid color display - no animations
-  switch (pattern) {
-    case LedPattern::CRITICAL_SOLID:
-      // Critical: Solid red
-      set_led_color(r, g, b, brightness);
-      break;
-    case LedPattern::BATTERY_WARNING:
-      // Battery warning: Solid orange
-      set_led_color(r, g, b, brightness);
-      break;
-    case LedPattern::CHARGING_SOLID:
-      // Charging: Solid yellow
-      set_led_color(r, g, b, brightness);
-      break;
-    case LedPattern::NORMAL_SOLID:
-      // Normal: Solid green
-      set_led_color(r, g, b, brightness);
-      break;
-    case LedPattern::OFFLINE_SOLID:
-      // Offline: Solid blue
-      set_led_color(r, g, b, brightness);
-      break;
-    case LedPattern::NO_DATA_SOLID:
-      // No data: Solid purple
-      set_led_color(r, g, b, brightness);
-      break;
-    case LedPattern::COMPONENT_ERROR:
-      // Error: Solid white
-      set_led_color(r, g, b, brightness);
-      break;
-    default:
-      // Off
-      set_led_color(0, 0, 0, 0);
-      break;
+  if (pattern == LedPattern::OFF) {
+    update_breathing(false);
+    set_led_color(0, 0, 0, 0);
+    applied_color_ = LedColor{};
+    return;
   }
   
-  ESP_LOGD(TAG, "Applying solid pattern: R=%.2f G=%.2f B=%.2f calculated_brightness=%.2f", r, g, b, brightness);
+  const float brightness = calculate_brightness();
+  const LedColor color = calculate_color(pattern);
+  set_led_color(color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, brightness);
+  applied_color_ = color;
+  update_breathing(critical_breathing_ && pattern == LedPattern::CRITICAL_SOLID);
+  
+  ESP_LOGD(TAG, "Applying solid pattern: R=%u G=%u B=%u calculated_brightness=%.2f", color.r, color.g, color.b,
+           brightness);
 }
 
 // SOLID principle: Single Responsibility - focused color calculation
-void UpsStatusLedComponent::calculate_color(float &r, float &g, float &b, LedPattern pattern, float brightness) {
-  // Check if night mode is active for color compensation
-  bool night_active = night_mode_enabled_ && is_night_time();
-  
-  // Default colors for patterns with night mode color compensation
-  switch (pattern) {
-    case LedPattern::CRITICAL_SOLID:
-      r = 1.0f; g = 0.0f; b = 0.0f; // Red
-      break;
-    case LedPattern::BATTERY_WARNING:
-      // Orange: Boost green channel in night mode to maintain orange appearance
-      r = 1.0f;
-      if (night_active) {
-        // Scale green boost based on how dim it is
-        float boost_factor = 1.4f - brightness; // More boost when dimmer
-        g = std::min(0.8f, 0.5f + boost_factor);
-      } else {
-        g = 0.5f;  // Normal orange
-      }
-      b = 0.0f;
-      break;
-    case LedPattern::CHARGING_SOLID:
-      // Yellow: Boost green channel in night mode to prevent red appearance
-      r = 1.0f;
-      if (night_active) {
-        // Scale green boost based on how dim it is
-        float boost_factor = 1.5f - brightness; // More boost when dimmer
-        g = std::min(1.3f, 1.0f + boost_factor);
-      } else {
-        g = 1.0f;  // Normal yellow
-      }
-      b = 0.0f;
-      break;
-    case LedPattern::NORMAL_SOLID:
-      // Normal operation should always be solid green
-      r = 0.0f; g = 1.0f; b = 0.0f; // Green
-      break;
-    case LedPattern::OFFLINE_SOLID:
-      r = 0.0f; g = 0.0f; b = 1.0f; // Blue
-      break;
-    case LedPattern::NO_DATA_SOLID:
-      r = 0.8f; g = 0.0f; b = 1.0f; // Purple
-      break;
-    case LedPattern::COMPONENT_ERROR:
-      r = 1.0f; g = 1.0f; b = 1.0f; // White
-      break;
-    default:
-      r = 0.0f; g = 0.0f; b = 0.0f; // Off
-      break;
+LedColor UpsStatusLedComponent::calculate_color(LedPattern pattern) const {
+  const bool night_active = night_mode_enabled_ && night_time_;
+  
+  // On battery, the gradient follows the charge from the warning threshold (green)
+  // down to the low threshold (red)
+  if (pattern == LedPattern::BATTERY_WARNING && battery_color_mode_ == BatteryColorMode::GRADIENT &&
+      !std::isnan(battery_level_) && battery_warning_threshold_ > battery_low_threshold_) {
+    const float position = (battery_level_ - battery_low_threshold_) / (battery_warning_threshold_ - battery_low_threshold_);
+    const int step = static_cast<int>(std::lround(std::min(1.0f, std::max(0.0f, position)) * (GRADIENT_STEPS - 1)));
+    return (night_active ? NIGHT_GRADIENT : DAY_GRADIENT).colors[step];
   }
+  
+  const size_t index = static_cast<size_t>(pattern);
+  return index < PATTERN_COUNT ? (night_active ? NIGHT_PATTERN_COLORS : DAY_PATTERN_COLORS).colors[index]
+                                : LedColor{};
 }
 
-float UpsStatusLedComponent::calculate_brightness() {
+float UpsStatusLedComponent::calculate_brightness() const {
   float base_brightness = brightness_;
-  bool night_active = night_mode_enabled_ && is_night_time();
-  
-  ESP_LOGD(TAG, "Brightness calc: base=%.2f, night_mode=%s, is_night=%s", 
-           base_brightness, night_mode_enabled_ ? "ON" : "OFF", night_active ? "YES" : "NO");
   
   // Apply night mode
-  if (night_active) {
+  if (night_mode_enabled_ && night_time_) {
     base_brightness *= night_mode_brightness_;
-    ESP_LOGD(TAG, "Night mode applied: %.2f * %.2f = %.2f", 
-             brightness_, night_mode_brightness_, base_brightness);
   }
   
   // Enforce minimum hardware brightness to make enabled switch meaningful
-  float final_brightness = std::max(base_brightness, MIN_HARDWARE_BRIGHTNESS);
-  
-  if (final_brightness != base_brightness) {
-    ESP_LOGD(TAG, "Applied minimum brightness: %.2f → %.2f", base_brightness, final_brightness);
+  return std::max(base_brightness, MIN_HARDWARE_BRIGHTNESS);
+}
+
+// Breathing is two light calls per period: the light's transition fades between them
+void UpsStatusLedComponent::update_breathing(bool active) {
+  if (active == breathing_active_) {
+    return;
   }
-  
-  return final_brightness;
+  breathing_active_ = active;
+  if (!active) {
+    cancel_interval("breathing");
+    return;
+  }
+  breathing_low_ = false;
+  set_interval("breathing", breathing_period_ms_ / 2, [this]() { breathe(); });
+}
+
+void UpsStatusLedComponent::breathe() {
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  if (!enabled_ || !light_) {
+    return;  // Turned off by the API; loop() stops the breathing
+  }
+  breathing_low_ = !breathing_low_;
+  const float brightness = calculate_brightness();
+  auto call = light_->make_call();
+  call.set_state(true);
+  call.set_brightness(breathing_low_ ? brightness * BREATHING_FLOOR : brightness);
+  call.set_transition_length(breathing_period_ms_ / 2);
+  call.perform();
 }
 
 bool UpsStatusLedComponent::is_night_time() const {
@@ -351,6 +368,9 @@ void UpsStatusLedComponent::set_led_color(float r, float g, float b, float brigh
   call.set_state(true);
   call.set_rgb(r, g, b);           // Set color
   call.set_brightness(brightness); // Set brightness separately  
+  if (transition_length_set_) {
+    call.set_transition_length(transition_length_ms_);  // Fade between patterns
+  }
   call.perform();
 }
 
@@ -9,6 +9,8 @@
 #include "esphome/components/light/light_state.h"
 
 // Thread safety
+#include <atomic>
+#include <cmath>
 #include <mutex>
 
 #ifdef USE_SWITCH
@@ -38,6 +40,16 @@ enum class LedPattern : uint8_t {
   COMPONENT_ERROR       // Solid white - component error
 };
 
+// 8-bit color of a pattern; scaled to the light's 0-1 range when applied
+struct LedColor {
+  uint8_t r{0};
+  uint8_t g{0};
+  uint8_t b{0};
+  
+  constexpr bool operator==(const LedColor &other) const { return r == other.r && g == other.g && b == other.b; }
+  constexpr bool operator!=(const LedColor &other) const { return !(*this == other); }
+};
+
 // Battery color mode configuration
 enum class BatteryColorMode : uint8_t {
   DISCRETE,     // Green > 50%, Orange 20-50%, Red < 20%
@@ -67,6 +79,14 @@ class UpsStatusLedComponent : public Component {
   void set_brightness(float brightness) { brightness_ = brightness; }
   void set_battery_color_mode(BatteryColorMode mode) { battery_color_mode_ = mode; }
   
+  // Animations (both done by the light's own transitions)
+  void set_transition_length(uint32_t transition_length_ms) {
+    transition_length_ms_ = transition_length_ms;
+    transition_length_set_ = true;
+  }
+  void set_critical_breathing(bool enabled) { critical_breathing_ = enabled; }
+  void set_breathing_period(uint32_t period_ms) { breathing_period_ms_ = period_ms; }
+  
   // Night mode configuration (for YAML config)
   void set_night_mode_enabled(bool enabled) { night_mode_enabled_ = enabled; }
   void set_night_mode_brightness(float brightness) { night_mode_brightness_ = brightness; }
@@ -150,9 +170,15 @@ class UpsStatusLedComponent : public Component {
   // SOLID principle: Single Responsibility - each method has one focused task
   LedPattern evaluate_pattern();
   void apply_pattern(LedPattern pattern);
-  void calculate_color(float &r, float &g, float &b, LedPattern pattern, float brightness);
-  float calculate_brightness();
+  // Table lookups; no floating point beyond the final 0-1 scaling
+  LedColor calculate_color(LedPattern pattern) const;
+  float calculate_brightness() const;
+  void update_breathing(bool active);
+  void breathe();
   bool is_night_time() const;
+  // Raises the update flags when the connection or the night-mode state changed
+  void check_state();
+  void publish_status();
   
   // Pattern implementation - simplified solid colors only
   
@@ -186,9 +212,25 @@ class UpsStatusLedComponent : public Component {
   // Pattern state tracking
   LedPattern current_pattern_{LedPattern::OFF};
   uint32_t pattern_start_time_{0};
-  uint32_t last_update_{0};
-  bool force_update_{false};  // Flag for immediate updates from API calls
-  static constexpr uint32_t UPDATE_INTERVAL_MS = 50;   // 20Hz update rate for faster response
+  bool started_{false};        // Set once the startup delay has passed
+  bool connected_{false};      // Connection state of the last check_state()
+  bool night_time_{false};     // Clock inside the night window at the last check_state()
+  float battery_level_{NAN};   // Charge of the last evaluate_pattern(), for the gradient
+  LedColor applied_color_;
+  // loop() does nothing until one of these is raised
+  std::atomic<bool> force_update_{false};         // Re-apply: API calls, night-mode boundary
+  std::atomic<bool> evaluation_pending_{false};   // Re-evaluate: status change, set from the polling context
+  static constexpr uint32_t STARTUP_DELAY_MS = 2000;        // Lets the UPS component detect its device first
+  static constexpr uint32_t STATE_CHECK_INTERVAL_MS = 1000;  // Connection and night-mode boundary checks
+  
+  // Animations
+  uint32_t transition_length_ms_{0};
+  bool transition_length_set_{false};  // Unset keeps the light's default_transition_length
+  bool critical_breathing_{false};
+  uint32_t breathing_period_ms_{2000};
+  bool breathing_active_{false};
+  bool breathing_low_{false};
+  static constexpr float BREATHING_FLOOR = 0.3f;  // Low point of a breath, relative to the brightness
   
   // Hardware brightness constraints
   static constexpr float MIN_HARDWARE_BRIGHTNESS = 0.2f;  // 20% minimum for switch meaning
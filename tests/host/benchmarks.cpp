@@ -0,0 +1,425 @@
+// Microbenchmarks of the component hot paths, reported as ns/op and heap
+// allocations/op. Numbers are for comparing revisions on one machine; they do
+// not predict ESP32 timings. The protocols, sensor publishing and NUT command
+// handlers run against a UpsHidComponent in simulation mode.
+//
+//   ups_benchmarks           full run
+//   ups_benchmarks --quick   a few iterations of each, as a smoke test (ctest)
+
+#include "ups_hid/constants_hid.h"
+#include "ups_hid/data_history.h"
+#include "ups_hid/hid_descriptor.h"
+#include "ups_hid/protocol_apc.h"
+#include "ups_hid/protocol_cyberpower.h"
+#include "ups_hid/protocol_eaton_5px.h"
+#include "ups_hid/protocol_generic.h"
+#include "ups_hid/ups_hid.h"
+#include "nut_server/nut_args.h"
+#include "nut_server/nut_output_buffer.h"
+#include "nut_server/nut_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+
+using namespace esphome;
+
+// Every heap allocation of the process goes through these
+static size_t allocations = 0;
+
+void *operator new(size_t size) {
+  allocations++;
+  if (void *p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+void *operator new[](size_t size) { return operator new(size); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  allocations++;
+  return std::malloc(size ? size : 1);
+}
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept { return operator new(size, tag); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+// Keeps a result alive so the measured work is not optimised away
+template<typename T> static void keep(const T &value) { asm volatile("" : : "r,m"(value) : "memory"); }
+// Hides a value from the optimiser so work on constant input is not folded
+template<typename T> static T opaque(T value) {
+  asm volatile("" : "+m"(value) : : "memory");
+  return value;
+}
+
+static size_t iteration_scale = 1;
+static bool all_passed = true;
+
+template<typename F> static void run(const char *name, size_t iterations, F &&body) {
+  iterations = iteration_scale == 1 ? iterations : std::max<size_t>(iterations / iteration_scale, 1);
+  for (size_t i = 0; i < iterations / 10 + 1; i++) {
+    body(i);
+  }
+  const size_t allocations_before = allocations;
+  const auto started = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; i++) {
+    body(i);
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - started;
+  const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+  printf("%-36s %10.1f ns/op %8.2f allocs/op\n", name, ns / iterations,
+         static_cast<double>(allocations - allocations_before) / iterations);
+}
+
+static void check(bool condition, const char *what) {
+  if (!condition) {
+    fprintf(stderr, "FAILED: %s\n", what);
+    all_passed = false;
+  }
+}
+
+// Power device descriptor in the shape UPSes report: a power summary with
+// charge, runtime and status bits as input reports, and input/output
+// collections with voltages, frequency and load as feature reports
+static const uint8_t UPS_REPORT_DESCRIPTOR[] = {
+    0x05, 0x84,                    // Usage Page (Power Device)
+    0x09, 0x04,                    // Usage (UPS)
+    0xA1, 0x01,                    // Collection (Application)
+    0x09, 0x24,                    //   Usage (Power Summary)
+    0xA1, 0x02,                    //   Collection (Logical)
+    0x85, 0x0C,                    //     Report ID (0x0C)
+    0x05, 0x85,                    //     Usage Page (Battery System)
+    0x09, 0x66,                    //     Usage (RemainingCapacity)
+    0x15, 0x00,                    //     Logical Minimum (0)
+    0x25, 0x64,                    //     Logical Maximum (100)
+    0x75, 0x08,                    //     Report Size (8)
+    0x95, 0x01,                    //     Report Count (1)
+    0x81, 0x02,                    //     Input (Data, Variable, Absolute)
+    0x09, 0x68,                    //     Usage (RunTimeToEmpty)
+    0x27, 0xFF, 0xFF, 0x00, 0x00,  //     Logical Maximum (65535)
+    0x66, 0x01, 0x10,              //     Unit (Seconds)
+    0x75, 0x10,                    //     Report Size (16)
+    0x81, 0x02,                    //     Input (Data, Variable, Absolute)
+    0x65, 0x00,                    //     Unit (None)
+    0x85, 0x16,                    //     Report ID (0x16)
+    0x09, 0x44,                    //     Usage (Charging)
+    0x09, 0x45,                    //     Usage (Discharging)
+    0x09, 0xD0,                    //     Usage (ACPresent)
+    0x09, 0x42,                    //     Usage (BelowRemainingCapacityLimit)
+    0x25, 0x01,                    //     Logical Maximum (1)
+    0x75, 0x01,                    //     Report Size (1)
+    0x95, 0x04,                    //     Report Count (4)
+    0x81, 0x02,                    //     Input (Data, Variable, Absolute)
+    0x81, 0x03,                    //     Input (Constant), padding to a byte
+    0xC0,                          //   End Collection
+    0x05, 0x84,                    //   Usage Page (Power Device)
+    0x09, 0x1A,                    //   Usage (Input)
+    0xA1, 0x02,                    //   Collection (Logical)
+    0x85, 0x30,                    //     Report ID (0x30)
+    0x09, 0x30,                    //     Usage (Voltage)
+    0x09, 0x32,                    //     Usage (Frequency)
+    0x26, 0xFF, 0x7F,              //     Logical Maximum (32767)
+    0x55, 0x0F,                    //     Unit Exponent (-1)
+    0x75, 0x10,                    //     Report Size (16)
+    0x95, 0x02,                    //     Report Count (2)
+    0xB1, 0x02,                    //     Feature (Data, Variable, Absolute)
+    0xC0,                          //   End Collection
+    0x09, 0x1C,                    //   Usage (Output)
+    0xA1, 0x02,                    //   Collection (Logical)
+    0x85, 0x31,                    //     Report ID (0x31)
+    0x09, 0x30,                    //     Usage (Voltage)
+    0x95, 0x01,                    //     Report Count (1)
+    0xB1, 0x02,                    //     Feature (Data, Variable, Absolute)
+    0x09, 0x35,                    //     Usage (PercentLoad)
+    0x55, 0x00,                    //     Unit Exponent (0)
+    0x25, 0x64,                    //     Logical Maximum (100)
+    0x75, 0x08,                    //     Report Size (8)
+    0xB1, 0x02,                    //     Feature (Data, Variable, Absolute)
+    0xC0,                          //   End Collection
+    0xC0,                          // End Collection
+};
+
+// Sums every field of one report, as a descriptor-driven protocol does per poll
+static float decode_report(const ups_hid::HidReportDescriptor &descriptor, uint8_t report_type, const uint8_t *report,
+                           size_t len) {
+  const ups_hid::HidReportInfo *info = descriptor.find_report(report_type, report[0]);
+  if (!info) {
+    return NAN;
+  }
+  float sum = 0.0f;
+  for (uint16_t i = 0; i < info->field_count; i++) {
+    const ups_hid::HidField &field = descriptor.fields()[info->first_field + i];
+    int32_t raw;
+    if (ups_hid::HidReportDescriptor::extract(field, report, len, descriptor.uses_report_ids(), raw)) {
+      sum += ups_hid::HidReportDescriptor::to_physical(field, raw);
+    }
+  }
+  return sum;
+}
+
+static void benchmark_hid_descriptor() {
+  ups_hid::HidReportDescriptor descriptor;
+  run("hid_descriptor.parse", 200000, [&](size_t) {
+    keep(descriptor.parse(UPS_REPORT_DESCRIPTOR, sizeof(UPS_REPORT_DESCRIPTOR)));
+  });
+  check(descriptor.parse(UPS_REPORT_DESCRIPTOR, sizeof(UPS_REPORT_DESCRIPTOR)), "descriptor parses");
+  check(descriptor.fields().size() == 10, "descriptor has 10 variable fields");
+  check(descriptor.uses_report_ids(), "descriptor uses report IDs");
+
+  // 87 % charge, 3600 s runtime
+  static const uint8_t BATTERY_REPORT[] = {0x0C, 87, 0x10, 0x0E};
+  // 230.0 V, 50.0 Hz
+  static const uint8_t INPUT_REPORT[] = {0x30, 0xFC, 0x08, 0xF4, 0x01};
+  check(std::fabs(decode_report(descriptor, HID_REPORT_TYPE_INPUT, BATTERY_REPORT, sizeof(BATTERY_REPORT)) - 3687.0f) <
+            0.01f,
+        "battery report decodes to 87 % and 3600 s");
+  check(std::fabs(decode_report(descriptor, HID_REPORT_TYPE_FEATURE, INPUT_REPORT, sizeof(INPUT_REPORT)) - 280.0f) <
+            0.01f,
+        "input report decodes to 230 V and 50 Hz");
+
+  run("hid_descriptor.decode_input_report", 5000000, [&](size_t) {
+    keep(decode_report(descriptor, HID_REPORT_TYPE_INPUT, BATTERY_REPORT, sizeof(BATTERY_REPORT)));
+  });
+  run("hid_descriptor.decode_feature_report", 5000000, [&](size_t) {
+    keep(decode_report(descriptor, HID_REPORT_TYPE_FEATURE, INPUT_REPORT, sizeof(INPUT_REPORT)));
+  });
+}
+
+static void benchmark_history() {
+  // An hour of 10 s polls
+  static constexpr size_t CAPACITY = 360;
+  static constexpr uint32_t POLL_MS = 10000;
+  ups_hid::UpsHistory history;
+  check(history.allocate(CAPACITY), "history allocates");
+
+  ups_hid::UpsData data;
+  data.battery.level = 87.0f;
+  data.battery.voltage = 27.1f;
+  data.battery.runtime_minutes = 60.0f;
+  data.power.input_voltage = 230.0f;
+  data.power.output_voltage = 229.5f;
+  data.power.load_percent = 23.0f;
+  data.power.frequency = 50.0f;
+
+  uint32_t now = 0;
+  run("history.record", 5000000, [&](size_t i) {
+    data.power.load_percent = 20.0f + static_cast<float>(i % 10);
+    now += POLL_MS;
+    history.record(now, data);
+  });
+  check(history.size() == CAPACITY, "history wraps at capacity");
+
+  run("history.stats (whole buffer)", 1000000, [&](size_t) {
+    keep(history.stats(ups_hid::HistoryField::LOAD_PERCENT, 0, now));
+  });
+  run("history.stats (5 min window)", 5000000, [&](size_t) {
+    keep(history.stats(ups_hid::HistoryField::LOAD_PERCENT, 5 * 60 * 1000, now));
+  });
+  run("history.value_at", 10000000, [&](size_t i) {
+    keep(history.value_at(ups_hid::HistoryField::INPUT_VOLTAGE, i % CAPACITY));
+  });
+  const ups_hid::UpsHistoryStats stats = history.stats(ups_hid::HistoryField::LOAD_PERCENT, 0, now);
+  check(stats.count == CAPACITY && stats.min == 20.0f && stats.max == 29.0f, "history stats cover the window");
+}
+
+static void benchmark_output_buffer() {
+  nut_server::NutOutputBuffer out;
+  const std::string ups_name = "ups";
+  run("output_buffer.var_line (fixed)", 10000000, [&](size_t i) {
+    out.clear();
+    out.append("VAR ").append(ups_name).append(' ').append("input.voltage").append(" \"")
+        .append_fixed(229.0f + static_cast<float>(i % 20) * 0.1f, 1).append("\"\n");
+    keep(out.pending());
+  });
+  run("output_buffer.var_line (uint)", 10000000, [&](size_t i) {
+    out.clear();
+    out.append("VAR ").append(ups_name).append(' ').append("battery.runtime").append(" \"")
+        .append_uint(static_cast<uint32_t>(3600 + i % 100)).append("\"\n");
+    keep(out.pending());
+  });
+  out.clear();
+  out.append_fixed(229.95f, 1).append(' ').append_int(-42);
+  check(std::string(out.pending_data(), out.pending()) == "230.0 -42", "output buffer formats numbers");
+}
+
+static void benchmark_nut_args() {
+  static constexpr std::string_view GET_VAR = "GET VAR ups battery.charge";
+  static constexpr std::string_view INSTCMD = "INSTCMD ups \"beeper.toggle\"";
+  static constexpr std::string_view SUBSCRIBE =
+      "SUBSCRIBE ups ups.status battery.charge battery.runtime input.voltage output.voltage ups.load";
+  run("split_nut_args (GET VAR)", 20000000,
+      [&](size_t) { keep(nut_server::split_nut_args(opaque(GET_VAR)).count); });
+  run("split_nut_args (INSTCMD, quoted)", 20000000,
+      [&](size_t) { keep(nut_server::split_nut_args(opaque(INSTCMD)).count); });
+  run("split_nut_args (SUBSCRIBE, 8 words)", 10000000,
+      [&](size_t) { keep(nut_server::split_nut_args(opaque(SUBSCRIBE)).count); });
+  run("split_nut_head + nut_iequals", 20000000, [&](size_t) {
+    std::string_view args;
+    keep(nut_server::nut_iequals(nut_server::split_nut_head(opaque(GET_VAR), args), "GET"));
+    keep(args.size());
+  });
+  const nut_server::NutArgs parts = nut_server::split_nut_args(INSTCMD);
+  check(parts.size() == 3 && parts[2] == "beeper.toggle", "quoted word is one argument");
+}
+
+// Exposes the polling and publishing steps that update() and loop() run
+class BenchUpsHidComponent : public ups_hid::UpsHidComponent {
+ public:
+  using UpsHidComponent::poll_device;
+  using UpsHidComponent::update_sensors;
+};
+
+// Simulated UPS without outages, polled once so its snapshot is populated
+static void start_simulated_ups(BenchUpsHidComponent &ups, ups_hid::SimulationVendor vendor) {
+  ups.set_simulation_mode(true);
+  ups.set_simulation_vendor(vendor);
+  ups.set_simulation_outage(0, 0);
+  ups.set_update_interval(10000);
+  ups.setup();
+  check(ups.poll_device(), "simulated UPS polls");
+}
+
+// One protocol's fast report group on a simulated device: the batched read,
+// every parse_*_report of the group and the derived status
+template<typename Protocol>
+static void benchmark_protocol(const char *name, ups_hid::SimulationVendor vendor,
+                               std::vector<uint8_t> report_descriptor = {}) {
+  BenchUpsHidComponent ups;
+  if (!report_descriptor.empty()) {
+    ups.set_simulation_report_descriptor(std::move(report_descriptor));
+  }
+  start_simulated_ups(ups, vendor);
+  Protocol protocol(&ups);
+  check(protocol.initialize(), "protocol initializes on the simulated device");
+
+  ups_hid::UpsData data;
+  check(protocol.read_report_group(ups_hid::ReportGroup::FAST, data), "fast report group reads");
+  check(!std::isnan(data.battery.level), "fast report group yields the battery level");
+  run(name, 20000, [&](size_t) {
+    data.reset_fast_values();
+    keep(protocol.read_report_group(ups_hid::ReportGroup::FAST, data));
+  });
+}
+
+static void benchmark_protocols() {
+  benchmark_protocol<ups_hid::ApcHidProtocol>("protocol.apc (fast group)", ups_hid::SimulationVendor::APC);
+  benchmark_protocol<ups_hid::CyberPowerProtocol>("protocol.cyberpower (fast group)",
+                                                  ups_hid::SimulationVendor::CYBERPOWER);
+  benchmark_protocol<ups_hid::Eaton5PxProtocol>("protocol.eaton_5px (read_data)", ups_hid::SimulationVendor::EATON);
+  // Descriptor-driven decoding of the APC device's power summary report
+  benchmark_protocol<ups_hid::GenericHidProtocol>(
+      "protocol.generic (descriptor)", ups_hid::SimulationVendor::APC,
+      std::vector<uint8_t>(UPS_REPORT_DESCRIPTOR, UPS_REPORT_DESCRIPTOR + sizeof(UPS_REPORT_DESCRIPTOR)));
+}
+
+// A typical configuration's entities, published from one unchanging snapshot:
+// the steady state between polls, where each entity only compares its value
+static void benchmark_update_sensors() {
+  using namespace ups_hid;
+  static const char *const SENSOR_TYPES[] = {
+      sensor_type::BATTERY_LEVEL, sensor_type::BATTERY_VOLTAGE, sensor_type::RUNTIME,
+      sensor_type::INPUT_VOLTAGE, sensor_type::OUTPUT_VOLTAGE,  sensor_type::LOAD_PERCENT,
+      sensor_type::FREQUENCY,     sensor_type::UPS_DELAY_SHUTDOWN,
+  };
+  static const char *const BINARY_SENSOR_TYPES[] = {
+      binary_sensor_type::ONLINE, binary_sensor_type::ON_BATTERY, binary_sensor_type::LOW_BATTERY,
+      binary_sensor_type::CHARGING, binary_sensor_type::OVERLOAD,
+  };
+  static const char *const TEXT_SENSOR_TYPES[] = {
+      text_sensor_type::STATUS, text_sensor_type::MODEL, text_sensor_type::MANUFACTURER,
+      text_sensor_type::BATTERY_STATUS, text_sensor_type::UPS_TEST_RESULT,
+  };
+  static constexpr size_t SENSOR_COUNT = sizeof(SENSOR_TYPES) / sizeof(SENSOR_TYPES[0]);
+  static constexpr size_t BINARY_SENSOR_COUNT = sizeof(BINARY_SENSOR_TYPES) / sizeof(BINARY_SENSOR_TYPES[0]);
+  static constexpr size_t TEXT_SENSOR_COUNT = sizeof(TEXT_SENSOR_TYPES) / sizeof(TEXT_SENSOR_TYPES[0]);
+
+  BenchUpsHidComponent ups;
+  UpsHidSensor sensors[SENSOR_COUNT];
+  UpsHidBinarySensor binary_sensors[BINARY_SENSOR_COUNT];
+  UpsHidTextSensor text_sensors[TEXT_SENSOR_COUNT];
+  for (size_t i = 0; i < SENSOR_COUNT; i++) {
+    ups.register_sensor(&sensors[i], SENSOR_TYPES[i]);
+  }
+  for (size_t i = 0; i < BINARY_SENSOR_COUNT; i++) {
+    ups.register_binary_sensor(&binary_sensors[i], BINARY_SENSOR_TYPES[i]);
+  }
+  for (size_t i = 0; i < TEXT_SENSOR_COUNT; i++) {
+    ups.register_text_sensor(&text_sensors[i], TEXT_SENSOR_TYPES[i]);
+  }
+  start_simulated_ups(ups, SimulationVendor::APC);
+
+  ups.update_sensors();
+  check(sensors[0].has_state() && binary_sensors[0].has_state() && text_sensors[0].has_state(),
+        "first update publishes every entity type");
+  check(binary_sensors[0].state, "simulated UPS publishes online");
+  run("update_sensors (18 entities)", 200000, [&](size_t) { ups.update_sensors(); });
+}
+
+// Exposes the request handler the server task calls per received line
+class BenchNutServerComponent : public nut_server::NutServerComponent {
+ public:
+  using NutServerComponent::process_command;
+};
+
+// One request per verb against a simulated UPS, as a logged-in client sends it
+static void benchmark_process_command() {
+  BenchUpsHidComponent ups;
+  start_simulated_ups(ups, ups_hid::SimulationVendor::APC);
+  BenchNutServerComponent server;
+  server.set_password("");  // The verbs below are timed without LOGIN
+  server.add_ups(&ups, "ups");
+  static nut_server::NutClient client;
+  client.socket_fd = 0;
+  client.state = nut_server::ClientState::CONNECTED;
+
+  struct VerbCase {
+    const char *name;
+    const char *command;
+    const char *expected;  // Start of the reply
+  };
+  static const VerbCase CASES[] = {
+      {"nut.VER", "VER", "VERSION"},
+      {"nut.NETVER", "NETVER", "1."},
+      {"nut.HELP", "HELP", "Commands"},
+      {"nut.LIST UPS", "LIST UPS", "BEGIN LIST UPS"},
+      {"nut.LIST VAR", "LIST VAR ups", "BEGIN LIST VAR ups"},
+      {"nut.LIST CMD", "LIST CMD ups", "BEGIN LIST CMD ups"},
+      {"nut.LIST RW", "LIST RW ups", "BEGIN LIST RW ups"},
+      {"nut.GET VAR (number)", "GET VAR ups battery.charge", "VAR ups battery.charge"},
+      {"nut.GET VAR (status)", "GET VAR ups ups.status", "VAR ups ups.status \"OL"},
+      {"nut.GET VAR (unknown)", "GET VAR ups no.such.var", "ERR VAR-NOT-SUPPORTED"},
+      {"nut.UNKNOWN", "FROBNICATE", "ERR UNKNOWN-COMMAND"},
+  };
+  for (const VerbCase &verb : CASES) {
+    client.tx.clear();
+    server.process_command(client, verb.command);
+    const std::string_view reply(client.tx.pending_data(), client.tx.pending());
+    check(reply.substr(0, strlen(verb.expected)) == verb.expected, verb.name);
+    run(verb.name, 200000, [&](size_t) {
+      client.tx.clear();
+      server.process_command(client, opaque(std::string_view(verb.command)));
+      keep(client.tx.pending());
+    });
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc > 1 && strcmp(argv[1], "--quick") == 0) {
+    iteration_scale = 1000;
+  }
+  benchmark_hid_descriptor();
+  benchmark_history();
+  benchmark_output_buffer();
+  benchmark_nut_args();
+  benchmark_protocols();
+  benchmark_update_sensors();
+  benchmark_process_command();
+  return all_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+// Host stand-in for ESPHome's BinarySensor: keeps the last published state
+namespace esphome {
+namespace binary_sensor {
+
+class BinarySensor {
+ public:
+  explicit BinarySensor(const std::string &name = "") : name_(name) {}
+  void publish_state(bool state) {
+    this->state = state;
+    has_state_ = true;
+  }
+  bool has_state() const { return has_state_; }
+  const std::string &get_name() const { return name_; }
+  bool state{false};
+
+ protected:
+  std::string name_;
+  bool has_state_{false};
+};
+
+}  // namespace binary_sensor
+}  // namespace esphome
+
+#define LOG_BINARY_SENSOR(prefix, type, obj) ((void) (obj))
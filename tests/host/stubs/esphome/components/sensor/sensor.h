@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cmath>
+#include <string>
+
+// Host stand-in for ESPHome's Sensor: keeps the last published state
+namespace esphome {
+namespace sensor {
+
+class Sensor {
+ public:
+  explicit Sensor(const std::string &name = "") : name_(name) {}
+  void publish_state(float state) {
+    this->state = state;
+    has_state_ = true;
+  }
+  bool has_state() const { return has_state_; }
+  const std::string &get_name() const { return name_; }
+  float state{NAN};
+
+ protected:
+  std::string name_;
+  bool has_state_{false};
+};
+
+}  // namespace sensor
+}  // namespace esphome
+
+#define LOG_SENSOR(prefix, type, obj) ((void) (obj))
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+// Host stand-in for ESPHome's TextSensor: keeps the last published state
+namespace esphome {
+namespace text_sensor {
+
+class TextSensor {
+ public:
+  explicit TextSensor(const std::string &name = "") : name_(name) {}
+  void publish_state(const std::string &state) {
+    this->state = state;
+    has_state_ = true;
+  }
+  bool has_state() const { return has_state_; }
+  const std::string &get_name() const { return name_; }
+  std::string state;
+
+ protected:
+  std::string name_;
+  bool has_state_{false};
+};
+
+}  // namespace text_sensor
+}  // namespace esphome
+
+#define LOG_TEXT_SENSOR(prefix, type, obj) ((void) (obj))
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+// Host stand-in for ESPHome's Component: lifecycle hooks only, deferred work
+// runs immediately
+namespace esphome {
+
+namespace setup_priority {
+static constexpr float DATA = 600.0f;
+static constexpr float AFTER_CONNECTION = 100.0f;
+}  // namespace setup_priority
+
+class Component {
+ public:
+  virtual ~Component() = default;
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual float get_setup_priority() const { return 0.0f; }
+  virtual void on_shutdown() {}
+  void mark_failed() { failed_ = true; }
+  bool is_failed() const { return failed_; }
+
+ protected:
+  void defer(std::function<void()> &&f) { f(); }
+  bool failed_{false};
+};
+
+class PollingComponent : public Component {
+ public:
+  PollingComponent() = default;
+  explicit PollingComponent(uint32_t update_interval) : update_interval_(update_interval) {}
+  virtual void update() = 0;
+  virtual void set_update_interval(uint32_t update_interval) { update_interval_ = update_interval; }
+  virtual uint32_t get_update_interval() const { return update_interval_; }
+  void start_poller() {}
+
+ protected:
+  uint32_t update_interval_{0};
+};
+
+}  // namespace esphome
@@ -0,0 +1,6 @@
+#pragma once
+
+// Host stand-in for the generated defines: every entity platform, no ESP32
+#define USE_SENSOR
+#define USE_BINARY_SENSOR
+#define USE_TEXT_SENSOR
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Host stand-in for ESPHome's HAL on the steady clock
+namespace esphome {
+
+inline uint32_t micros() {
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+inline uint32_t millis() { return micros() / 1000; }
+inline void delay(uint32_t) {}
+
+}  // namespace esphome
@@ -0,0 +1,3 @@
+#pragma once
+
+// Host stand-in: the components include it but use nothing from it on the host
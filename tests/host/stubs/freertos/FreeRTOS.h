@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+// Host stand-in for the FreeRTOS types and macros the protocols use
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef void *TaskHandle_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(ms))
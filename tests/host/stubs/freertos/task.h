@@ -0,0 +1,6 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+// Host stand-in: the benchmarks run on one thread, so delays return at once
+inline void vTaskDelay(TickType_t) {}
@@ -0,0 +1,286 @@
+#!/usr/bin/env python3
+"""
+Load generator for the NUT Server Component
+Opens N concurrent clients against one ESPHome NUT server, runs a weighted
+mix of requests at a target rate and reports latency, errors and
+MAX-CLIENTS rejections, next to the server's own counters.
+"""
+
+import argparse
+import random
+import socket
+import sys
+import threading
+import time
+from collections import Counter, defaultdict
+
+
+SERVER_STATS = [
+    "server.connections.accepted",
+    "server.connections.rejected",
+    "server.clients.peak",
+    "server.clients.max",
+    "server.commands",
+    "server.errors",
+    "server.bytes.sent",
+]
+
+
+class ServerRejected(Exception):
+    """Connection closed with ERR MAX-CLIENTS."""
+
+
+class NutConnection:
+    """Line-oriented NUT client that reads exactly one reply per request."""
+
+    def __init__(self, host, port, timeout):
+        self.sock = socket.create_connection((host, port), timeout=timeout)
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self.buffer = b""
+
+    def close(self):
+        try:
+            self.sock.close()
+        except OSError:
+            pass
+
+    def read_line(self):
+        while b"\n" not in self.buffer:
+            data = self.sock.recv(4096)
+            if not data:
+                raise ConnectionError("connection closed by server")
+            self.buffer += data
+        line, self.buffer = self.buffer.split(b"\n", 1)
+        return line.decode(errors="replace")
+
+    def request(self, command):
+        """Send one command; returns the reply lines (LIST replies up to END LIST)."""
+        self.sock.sendall(f"{command}\n".encode())
+        line = self.read_line()
+        if line.startswith("ERR MAX-CLIENTS"):
+            raise ServerRejected()
+        lines = [line]
+        if line.startswith("BEGIN LIST"):
+            while not line.startswith("END LIST"):
+                line = self.read_line()
+                lines.append(line)
+        return lines
+
+
+def error_code(lines):
+    """NUT error code of a reply, or None on success."""
+    if lines and lines[0].startswith("ERR "):
+        return lines[0].split()[1]
+    return None
+
+
+def percentile(samples, fraction):
+    if not samples:
+        return float("nan")
+    ordered = sorted(samples)
+    index = min(len(ordered) - 1, int(round(fraction * (len(ordered) - 1))))
+    return ordered[index]
+
+
+class Results:
+    """Latencies and errors, merged from every worker."""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.latencies = defaultdict(list)
+        self.errors = defaultdict(Counter)
+        self.rejected = 0
+        self.connect_failures = 0
+        self.disconnects = 0
+
+    def record(self, verb, seconds, code):
+        with self.lock:
+            self.latencies[verb].append(seconds)
+            if code:
+                self.errors[verb][code] += 1
+
+    def count(self, field):
+        with self.lock:
+            setattr(self, field, getattr(self, field) + 1)
+
+
+def connect(args, results):
+    """Open and authenticate a client; None when refused."""
+    try:
+        conn = NutConnection(args.host, args.port, args.timeout)
+    except OSError:
+        results.count("connect_failures")
+        return None
+    try:
+        if args.password:
+            conn.request(f"USERNAME {args.username}")
+            if error_code(conn.request(f"PASSWORD {args.password}")):
+                raise ConnectionError("authentication failed")
+        # The server only sends MAX-CLIENTS once the connection is accepted, so
+        # the first scripted reply tells a rejection from a served client
+        conn.request("VER")
+        return conn
+    except ServerRejected:
+        results.count("rejected")
+    except (OSError, ConnectionError):
+        results.count("connect_failures")
+    conn.close()
+    return None
+
+
+def run_operation(conn, verb, args, rng, results):
+    """Time one request of the mix; returns the connection to use next."""
+    if verb == "login":
+        # Connection churn: connect, authenticate, log out
+        start = time.perf_counter()
+        fresh = connect(args, results)
+        if fresh is None:
+            return conn
+        code = error_code(fresh.request(f"LOGIN {args.username} {args.password}")) if args.password else None
+        try:
+            fresh.request("LOGOUT")
+        except (OSError, ConnectionError):
+            pass
+        fresh.close()
+        results.record(verb, time.perf_counter() - start, code)
+        return conn
+
+    commands = {
+        "list_var": f"LIST VAR {args.ups}",
+        "get_var": f"GET VAR {args.ups} {rng.choice(args.variables)}",
+        "instcmd": f"INSTCMD {args.ups} {args.instcmd}",
+    }
+    start = time.perf_counter()
+    lines = conn.request(commands[verb])
+    results.record(verb, time.perf_counter() - start, error_code(lines))
+    return conn
+
+
+def worker(index, args, mix, deadline, results):
+    conn = connect(args, results)
+    if conn is None:
+        return
+    rng = random.Random(args.seed + index)
+    verbs, weights = zip(*mix)
+    interval = 1.0 / args.rate if args.rate > 0 else 0.0
+    next_send = time.perf_counter() + rng.uniform(0, interval)
+    try:
+        while time.perf_counter() < deadline:
+            if interval:
+                delay = next_send - time.perf_counter()
+                if delay > 0:
+                    time.sleep(delay)
+                next_send += interval
+            conn = run_operation(conn, rng.choices(verbs, weights)[0], args, rng, results)
+    except (OSError, ConnectionError):
+        results.count("disconnects")
+    finally:
+        conn.close()
+
+
+def read_server_stats(args):
+    """Server counters via GET VAR server.*; None if the server has none or is full."""
+    results = Results()
+    conn = connect(args, results)
+    if conn is None:
+        return None
+    stats = {}
+    try:
+        for name in SERVER_STATS:
+            lines = conn.request(f"GET VAR {args.ups} {name}")
+            if error_code(lines):
+                return None
+            stats[name] = int(lines[0].split('"')[1])
+    except (OSError, ConnectionError, IndexError, ValueError):
+        return None
+    finally:
+        conn.close()
+    return stats
+
+
+def parse_mix(text):
+    """'list_var=1,get_var=8' -> [("list_var", 1.0), ("get_var", 8.0)]"""
+    mix = []
+    for part in text.split(","):
+        verb, _, weight = part.partition("=")
+        verb = verb.strip().lower()
+        if verb not in ("list_var", "get_var", "login", "instcmd"):
+            raise argparse.ArgumentTypeError(f"unknown operation '{verb}'")
+        mix.append((verb, float(weight or 1)))
+    if not any(weight > 0 for _, weight in mix):
+        raise argparse.ArgumentTypeError("mix needs at least one positive weight")
+    return mix
+
+
+def print_report(args, results, elapsed, before, after):
+    total = sum(len(samples) for samples in results.latencies.values())
+    print(f"\n{args.clients} clients, {elapsed:.1f}s, {total} requests ({total / elapsed:.1f}/s)")
+    print(f"{'operation':<10} {'count':>7} {'p50 ms':>8} {'p99 ms':>8} {'max ms':>8}  errors")
+    for verb, samples in sorted(results.latencies.items()):
+        errors = ", ".join(f"{code} x{count}" for code, count in results.errors[verb].most_common()) or "-"
+        print(f"{verb:<10} {len(samples):>7} {percentile(samples, 0.5) * 1000:>8.1f} "
+              f"{percentile(samples, 0.99) * 1000:>8.1f} {max(samples) * 1000:>8.1f}  {errors}")
+    print(f"MAX-CLIENTS rejections: {results.rejected}")
+    print(f"Connect failures: {results.connect_failures}, dropped connections: {results.disconnects}")
+
+    if before is None or after is None:
+        print("Server counters unavailable (older firmware, or no free client slot)")
+        return
+    print("\nServer counters (delta over the run):")
+    for name in SERVER_STATS:
+        if name in ("server.clients.peak", "server.clients.max"):
+            print(f"  {name:<29} {after[name]}")
+        else:
+            print(f"  {name:<29} {after[name] - before[name]}")
+    if results.rejected and after["server.clients.max"] < args.clients:
+        print(f"\n{args.clients} clients exceed max_clients ({after['server.clients.max']}); "
+              f"raise it in the nut_server config (at most 10)")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark the NUT Server Component")
+    parser.add_argument("host", help="ESP32 IP address")
+    parser.add_argument("--port", type=int, default=3493, help="NUT server port")
+    parser.add_argument("--username", default="nutmon", help="Username for auth")
+    parser.add_argument("--password", default="nutsecret", help="Password for auth (empty if disabled)")
+    parser.add_argument("--ups", default="test_ups", help="UPS name")
+    parser.add_argument("--clients", type=int, default=4, help="Concurrent connections")
+    parser.add_argument("--duration", type=float, default=30.0, help="Run time in seconds")
+    parser.add_argument("--rate", type=float, default=2.0,
+                        help="Requests per second per client (0 sends back to back)")
+    parser.add_argument("--mix", type=parse_mix, default=parse_mix("list_var=1,get_var=8,login=1"),
+                        help="Weighted operations: list_var, get_var, login, instcmd")
+    parser.add_argument("--variables", default="battery.charge,ups.status,input.voltage,ups.load",
+                        type=lambda text: text.split(","), help="Variables picked by get_var")
+    parser.add_argument("--instcmd", default="beeper.mute", help="Command sent by instcmd")
+    parser.add_argument("--timeout", type=float, default=5.0, help="Socket timeout in seconds")
+    parser.add_argument("--seed", type=int, default=1, help="Seed for the request sequence")
+    args = parser.parse_args()
+
+    print(f"Benchmarking NUT Server at {args.host}:{args.port}")
+    print("Mix: " + ", ".join(f"{verb}={weight:g}" for verb, weight in args.mix))
+
+    before = read_server_stats(args)
+    results = Results()
+    start = time.perf_counter()
+    deadline = start + args.duration
+    threads = [threading.Thread(target=worker, args=(i, args, args.mix, deadline, results), daemon=True)
+               for i in range(args.clients)]
+    try:
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+    except KeyboardInterrupt:
+        print("\nInterrupted")
+    elapsed = time.perf_counter() - start
+    # Let the server notice the closed sockets before its counters are read
+    time.sleep(0.5)
+    after = read_server_stats(args)
+
+    print_report(args, results, elapsed, before, after)
+    sys.exit(1 if results.connect_failures or not results.latencies else 0)
+
+
+if __name__ == "__main__":
+    main()
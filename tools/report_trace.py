@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""
+Download and inspect ups_hid report traces
+Fetches the trace a device records with `capture:` enabled and prints it
+record by record or as per-report totals. The same file can be replayed by
+the simulated transport with `simulation: replay_file:`.
+"""
+
+import argparse
+import struct
+import sys
+import urllib.request
+from collections import defaultdict
+
+# Layout written by ReportTrace::snapshot() (components/ups_hid/transport_tracing.h)
+TRACE_MAGIC = b"UHTR"
+TRACE_VERSION = 1
+TRACE_HEADER = struct.Struct("<4sBBHHHIIB3x")
+TRACE_RECORD = struct.Struct("<IBBBBB")
+TRACE_FLAG_DROPPED = 0x01
+
+KINDS = {1: "GET", 2: "SET", 3: "INPUT", 4: "STRING"}
+STATUSES = {0: "ok", 1: "timeout", 2: "failed"}
+REPORT_TYPES = {1: "input", 2: "output", 3: "feature"}
+
+
+class TraceError(Exception):
+    """The file is not a complete report trace."""
+
+
+def parse_trace(blob):
+    if len(blob) < TRACE_HEADER.size:
+        raise TraceError("too short for a report trace")
+    (magic, version, flags, vendor_id, product_id, descriptor_length, captured_ms, dropped,
+     serial_index) = TRACE_HEADER.unpack_from(blob)
+    if magic != TRACE_MAGIC:
+        raise TraceError("not a ups_hid report trace")
+    if version != TRACE_VERSION:
+        raise TraceError(f"format version {version}, expected {TRACE_VERSION}")
+    offset = TRACE_HEADER.size + descriptor_length
+    if offset > len(blob):
+        raise TraceError("truncated in the report descriptor")
+
+    header = {
+        "vendor_id": vendor_id,
+        "product_id": product_id,
+        "serial_index": serial_index,
+        "captured_ms": captured_ms,
+        "dropped": dropped if flags & TRACE_FLAG_DROPPED else 0,
+        "descriptor": blob[TRACE_HEADER.size:offset],
+    }
+    records = []
+    while offset < len(blob):
+        if offset + TRACE_RECORD.size > len(blob):
+            raise TraceError(f"truncated at byte {offset}")
+        at_ms, kind, report_type, report_id, status, length = TRACE_RECORD.unpack_from(blob, offset)
+        offset += TRACE_RECORD.size
+        data = blob[offset:offset + length]
+        if len(data) != length:
+            raise TraceError(f"truncated at byte {offset}")
+        offset += length
+        records.append((at_ms, kind, report_type, report_id, status, data))
+    return header, records
+
+
+def describe(kind, report_type, report_id, data):
+    if kind == 4:
+        return f"string {report_type}: {data.decode('utf-8', errors='replace')!r}"
+    type_name = REPORT_TYPES.get(report_type, f"type {report_type}")
+    return f"{type_name} 0x{report_id:02X}: {data.hex(' ').upper()}"
+
+
+def print_header(header, records):
+    print(f"Device: VID=0x{header['vendor_id']:04X} PID=0x{header['product_id']:04X}, "
+          f"serial string {header['serial_index']}")
+    print(f"Report descriptor: {len(header['descriptor'])} bytes")
+    span_s = (records[-1][0] - records[0][0]) / 1000.0 if records else 0.0
+    print(f"Records: {len(records)} over {span_s:.1f} s")
+    if header["dropped"]:
+        print(f"Overwritten by the ring: {header['dropped']} records (raise capture: buffer_size)")
+
+
+def cmd_fetch(args):
+    with urllib.request.urlopen(args.url, timeout=args.timeout) as response:
+        blob = response.read()
+    header, records = parse_trace(blob)
+    with open(args.output, "wb") as file:
+        file.write(blob)
+    print(f"Saved {len(blob)} bytes to {args.output}")
+    print_header(header, records)
+
+
+def cmd_dump(args):
+    header, records = parse_trace(open(args.file, "rb").read())
+    print_header(header, records)
+    if args.descriptor:
+        print(header["descriptor"].hex(" ").upper())
+    start_ms = records[0][0] if records else 0
+    for at_ms, kind, report_type, report_id, status, data in records:
+        if args.report is not None and (kind == 4 or report_id != args.report):
+            continue
+        elapsed_ms = (at_ms - start_ms) & 0xFFFFFFFF
+        line = f"{elapsed_ms:>9} ms  {KINDS.get(kind, kind):<6} {describe(kind, report_type, report_id, data)}"
+        if status != 0:
+            line += f"  [{STATUSES.get(status, status)}]"
+        print(line)
+
+
+def cmd_stats(args):
+    header, records = parse_trace(open(args.file, "rb").read())
+    print_header(header, records)
+    totals = defaultdict(lambda: {"count": 0, "changes": 0, "timeouts": 0, "failed": 0, "last": None})
+    for _at_ms, kind, report_type, report_id, status, data in records:
+        if kind == 4:
+            continue
+        entry = totals[(KINDS.get(kind, kind), report_type, report_id)]
+        entry["count"] += 1
+        if status == 1:
+            entry["timeouts"] += 1
+        elif status == 2:
+            entry["failed"] += 1
+        elif data != entry["last"]:
+            entry["changes"] += 1
+            entry["last"] = data
+    print(f"{'kind':<6} {'report':<14} {'count':>7} {'changes':>8} {'timeouts':>9} {'failed':>7}")
+    for (kind, report_type, report_id), entry in sorted(totals.items(), key=lambda item: (item[0][2], item[0][0])):
+        name = f"{REPORT_TYPES.get(report_type, report_type)} 0x{report_id:02X}"
+        print(f"{kind:<6} {name:<14} {entry['count']:>7} {entry['changes']:>8} "
+              f"{entry['timeouts']:>9} {entry['failed']:>7}")
+
+
+def report_id(text):
+    return int(text, 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Download and inspect ups_hid report traces")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    fetch = commands.add_parser("fetch", help="Download a trace from a device")
+    fetch.add_argument("url", help="e.g. http://192.168.1.200/ups_hid/ups_monitor/trace.bin")
+    fetch.add_argument("-o", "--output", default="trace.bin", help="File to write")
+    fetch.add_argument("--timeout", type=float, default=30.0, help="HTTP timeout in seconds")
+    fetch.set_defaults(handler=cmd_fetch)
+
+    dump = commands.add_parser("dump", help="Print every record")
+    dump.add_argument("file")
+    dump.add_argument("--report", type=report_id, help="Only this report ID, e.g. 0x0C")
+    dump.add_argument("--descriptor", action="store_true", help="Also print the report descriptor")
+    dump.set_defaults(handler=cmd_dump)
+
+    stats = commands.add_parser("stats", help="Per-report transfers, value changes and failures")
+    stats.add_argument("file")
+    stats.set_defaults(handler=cmd_stats)
+
+    args = parser.parse_args()
+    try:
+        args.handler(args)
+    except TraceError as err:
+        print(f"Invalid trace: {err}", file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()